@@ -225,7 +225,7 @@ class System:
 
     pm = mlir.passmanager.PassManager.parse(self._passes(partition))
     self._op_cache.release_ops()
-    pm.run(self.mod)
+    circt.run_pass_manager(pm, self.mod)
     self.passed = True
 
   def emit_outputs(self):
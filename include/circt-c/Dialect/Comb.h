@@ -19,6 +19,25 @@ extern "C" {
 
 MLIR_DECLARE_CAPI_DIALECT_REGISTRATION(Combinational, comb);
 
+/// Builds a graph of `numNodes` Comb operations in a single call, which saves
+/// the per-operation overhead of language bindings. Node `i` is an operation
+/// named `opNames[opcodes[i]]`, whose operands are the next `numOperands[i]`
+/// entries of `operands`. An operand index below `numInputs` refers to
+/// `inputs`, and the index `numInputs + j` refers to the result of node `j`,
+/// which has to precede node `i`. The result types are inferred from the
+/// operands, hence only the variadic and binary arithmetic and logic
+/// operations, `comb.concat`, `comb.mux` and `comb.parity` are supported.
+///
+/// The operations are inserted before `insertBefore` if it is not null, and at
+/// the end of `block` otherwise, and are written to `results`. If any node is
+/// malformed, an error is emitted at `loc` and no operation is created.
+MLIR_CAPI_EXPORTED MlirLogicalResult
+combBuildGraph(MlirBlock block, MlirOperation insertBefore, MlirLocation loc,
+               intptr_t numOpNames, const MlirStringRef *opNames,
+               intptr_t numInputs, const MlirValue *inputs, intptr_t numNodes,
+               const int32_t *opcodes, const int32_t *numOperands,
+               const int32_t *operands, MlirOperation *results);
+
 #ifdef __cplusplus
 }
 #endif
@@ -140,6 +140,25 @@ MLIR_CAPI_EXPORTED MlirType hwParamDeclRefAttrGetType(MlirAttribute decl);
 MLIR_CAPI_EXPORTED bool hwAttrIsAParamVerbatimAttr(MlirAttribute);
 MLIR_CAPI_EXPORTED MlirAttribute hwParamVerbatimAttrGet(MlirAttribute text);
 
+//===----------------------------------------------------------------------===//
+// Operation API.
+//===----------------------------------------------------------------------===//
+
+/// Creates `numInstances` instances of the HW module `module` in a single call.
+/// Instance `i` is named `names[i]`, and its inputs are the `i`-th run of as
+/// many consecutive entries of `inputs` as the module has inputs. `numInputs`
+/// is the total number of entries of `inputs`. Parametric modules are not
+/// supported.
+///
+/// The instances are inserted before `insertBefore` if it is not null, and at
+/// the end of `block` otherwise, and are written to `instances`. If the inputs
+/// don't match the module, an error is emitted at `loc` and no instance is
+/// created.
+MLIR_CAPI_EXPORTED MlirLogicalResult hwInstanceOpCreateBatch(
+    MlirBlock block, MlirOperation insertBefore, MlirLocation loc,
+    MlirOperation module, intptr_t numInstances, const MlirStringRef *names,
+    intptr_t numInputs, const MlirValue *inputs, MlirOperation *instances);
+
 #ifdef __cplusplus
 }
 #endif
@@ -107,6 +107,14 @@ MLIR_CAPI_EXPORTED
 MLIR_CAPI_EXPORTED MlirOperation circtMSFTPlacementDBPlace(
     CirctMSFTPlacementDB, MlirOperation inst, MlirAttribute loc,
     MlirStringRef subpath, MlirLocation srcLoc);
+/// Place 'numPlacements' instances at once. 'insts', 'locs' and 'subpaths'
+/// describe one placement per element, like `circtMSFTPlacementDBPlace`. The
+/// placement ops are written to 'results', with null ops for the placements
+/// which failed.
+MLIR_CAPI_EXPORTED void circtMSFTPlacementDBPlaceAll(
+    CirctMSFTPlacementDB, intptr_t numPlacements, const MlirOperation *insts,
+    const MlirAttribute *locs, const MlirStringRef *subpaths,
+    MlirLocation srcLoc, MlirOperation *results);
 MLIR_CAPI_EXPORTED void
 circtMSFTPlacementDBRemovePlacement(CirctMSFTPlacementDB, MlirOperation locOp);
 MLIR_CAPI_EXPORTED MlirLogicalResult circtMSFTPlacementDBMovePlacement(
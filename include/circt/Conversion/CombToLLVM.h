@@ -23,9 +23,12 @@ class LLVMTypeConverter;
 
 namespace circt {
 
-/// Get the Comb to LLVM conversion patterns.
+/// Get the Comb to LLVM conversion patterns. If 'vectorizeWidth' is not zero,
+/// bitwise, concat and extract operations on integers wider than it, which are
+/// made of whole 64-bit words, are lowered to operations on vectors of words.
 void populateCombToLLVMConversionPatterns(mlir::LLVMTypeConverter &converter,
-                                          RewritePatternSet &patterns);
+                                          RewritePatternSet &patterns,
+                                          unsigned vectorizeWidth = 0);
 
 /// Create an Comb to LLVM conversion pass.
 std::unique_ptr<OperationPass<ModuleOp>> createConvertCombToLLVMPass();
@@ -27,8 +27,12 @@ std::unique_ptr<mlir::Pass> createPrepareForEmissionPass();
 std::unique_ptr<mlir::Pass> createExportVerilogPass(llvm::raw_ostream &os);
 std::unique_ptr<mlir::Pass> createExportVerilogPass();
 
+/// Create a pass emitting one file per module into `directory`.  If
+/// `skipUnchangedFiles` is set, files whose contents are identical to the ones
+/// already on disk are not rewritten.
 std::unique_ptr<mlir::Pass>
-createExportSplitVerilogPass(llvm::StringRef directory = "./");
+createExportSplitVerilogPass(llvm::StringRef directory = "./",
+                             bool skipUnchangedFiles = false);
 
 /// Export a module containing HW, and SV dialect code. Requires that the SV
 /// dialect is loaded in to the context.
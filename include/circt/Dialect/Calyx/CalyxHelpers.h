@@ -33,6 +33,15 @@ hw::ConstantOp createConstant(Location loc, OpBuilder &builder,
                               ComponentOp component, size_t width,
                               size_t value);
 
+/// Returns the number of cycles 'group' takes from being enabled to being
+/// done, as recorded by its "static" attribute, or None if it is unknown.
+Optional<uint64_t> getStaticLatency(GroupOp group);
+
+/// Records that 'group' takes exactly 'latency' cycles from being enabled to
+/// being done, which allows the control compilation to schedule it without
+/// waiting for its done signal.
+void setStaticLatency(GroupOp group, uint64_t latency);
+
 // Returns whether this operation is a leaf node in the Calyx control.
 // TODO(github.com/llvm/circt/issues/1679): Add Invoke.
 bool isControlLeafNode(Operation *op);
@@ -58,6 +58,11 @@ bool singleLoadFromMemory(Value memoryReference);
 // memory.
 bool noStoresToMemory(Value memoryReference);
 
+// Returns true if 'value' is not driven through combinational logic evaluated
+// by a group, e.g., a component input, a constant, or the output of a register,
+// memory or sequential primitive.
+bool breaksCombinationalPath(Value value);
+
 // Get the index'th output port of compOp.
 Value getComponentOutput(calyx::ComponentOp compOp, unsigned outPortIdx);
 
@@ -252,6 +257,8 @@ public:
     std::string groupName = "assign_" + uniqueSuffix.str();
     auto groupOp = calyx::createGroup<calyx::GroupOp>(builder, componentOp,
                                                       op.getLoc(), groupName);
+    /// The registers are all written in a single cycle.
+    calyx::setStaticLatency(groupOp, 1);
     /// Create register assignment for each iter_arg. a calyx::GroupDone signal
     /// is created for each register. These will be &'ed together in
     /// MultipleGroupDonePattern.
@@ -27,6 +27,8 @@ std::unique_ptr<mlir::Pass> createRemoveGroupsPass();
 std::unique_ptr<mlir::Pass> createClkInsertionPass();
 std::unique_ptr<mlir::Pass> createResetInsertionPass();
 std::unique_ptr<mlir::Pass> createGroupInvariantCodeMotionPass();
+std::unique_ptr<mlir::Pass> createRegisterSharingPass();
+std::unique_ptr<mlir::Pass> createCellSharingPass();
 
 /// Generate the code for registering passes.
 #define GEN_PASS_REGISTRATION
@@ -118,3 +118,62 @@ module ESI_PipelineStage # (
     end
   end
 endmodule
+
+// A circular FIFO holding up to DEPTH tokens in a RAM. A token written in one
+// cycle can be read in the next, so this adds one cycle of latency regardless
+// of the depth while only costing the pointer registers on top of the RAM.
+module ESI_FIFO # (
+  int WIDTH = 8,
+  int DEPTH = 8
+) (
+  input logic clk,
+  input logic rst,
+
+  // Input LI channel.
+  input logic a_valid,
+  input logic [WIDTH-1:0] a,
+  output logic a_ready,
+
+  // Output LI channel.
+  output logic x_valid,
+  output logic [WIDTH-1:0] x,
+  input logic x_ready
+);
+
+  localparam PTR_WIDTH = DEPTH > 1 ? $clog2(DEPTH) : 1;
+  localparam COUNT_WIDTH = $clog2(DEPTH + 1);
+
+  logic [WIDTH-1:0] mem [DEPTH-1:0];
+  logic [PTR_WIDTH-1:0] rd_ptr, wr_ptr;
+  logic [COUNT_WIDTH-1:0] count;
+
+  assign a_ready = count != DEPTH;
+  assign x_valid = count != 0;
+  assign x = mem[rd_ptr];
+
+  // Did we accept a token this cycle?
+  wire a_rcv = a_ready && a_valid;
+  // We are transmitting a token on this cycle.
+  wire xmit = x_valid && x_ready;
+
+  always_ff @(posedge clk)
+    if (a_rcv)
+      mem[wr_ptr] <= a;
+
+  always_ff @(posedge clk) begin
+    if (rst) begin
+      rd_ptr <= '0;
+      wr_ptr <= '0;
+      count <= '0;
+    end else begin
+      if (a_rcv)
+        wr_ptr <= wr_ptr == DEPTH - 1 ? '0 : wr_ptr + 1'b1;
+      if (xmit)
+        rd_ptr <= rd_ptr == DEPTH - 1 ? '0 : rd_ptr + 1'b1;
+      if (a_rcv && !xmit)
+        count <= count + 1'b1;
+      else if (xmit && !a_rcv)
+        count <= count - 1'b1;
+    end
+  end
+endmodule
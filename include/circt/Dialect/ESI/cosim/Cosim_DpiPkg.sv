@@ -74,4 +74,35 @@ import "DPI-C" sv2cCosimserverEpTryGet =
     inout  int unsigned data_size
     );
 
+// Attempt to send several messages to a client in one call. Amortizes the DPI
+// crossing for high-rate channels.
+// - return the number of messages queued, negative on failure.
+import "DPI-C" sv2cCosimserverEpTryPutBatch =
+  function int cosim_ep_tryput_batch(
+    // The ID of the endpoint to which the data should be sent.
+    input string endpoint_id,
+    // The messages, packed back to back.
+    input byte unsigned data[],
+    // The size of each message, in bytes.
+    input int msg_size,
+    // The number of messages in data[].
+    input int num_msgs
+    );
+
+// Attempt to recieve several messages from a client in one call.
+//   - Returns negative when call failed (e.g. EP not registered).
+//   - Messages are packed back to back, each zero-padded to msg_size bytes.
+import "DPI-C" sv2cCosimserverEpTryGetBatch =
+  function int cosim_ep_tryget_batch(
+    // The ID of the endpoint from which data should be recieved.
+    input string endpoint_id,
+    // The buffer in which to put the messages.
+    inout byte unsigned data[],
+    // The size of each message slot in data[], in bytes.
+    input int unsigned msg_size,
+    // Input: the maximum number of messages to recieve.
+    // Output: the number of messages recieved.
+    inout int unsigned num_msgs
+    );
+
 endpackage // Cosim_DpiPkg
@@ -13,34 +13,232 @@
 #ifndef CIRCT_DIALECT_ESI_COSIM_ENDPOINT_H
 #define CIRCT_DIALECT_ESI_COSIM_ENDPOINT_H
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <string>
+#include <vector>
 
 namespace circt {
 namespace esi {
 namespace cosim {
 
+/// A lock-free queue of messages between exactly one producer thread and one
+/// consumer thread. The messages are stored in a fixed number of slots, which
+/// are allocated up front with room for the largest message of the endpoint.
+/// Hence neither side ever takes a lock or allocates memory to exchange a
+/// message. The slots are aligned to 8 bytes, such that they can be handed to
+/// capnp as words.
+///
+/// The ring lives in a single region of memory, which may be shared with a
+/// client process. The region starts with a Header, followed by the size of the
+/// message in each slot as a uint64_t, followed by the slots.
+class MessageRing {
+public:
+  /// The number of messages which can be queued in each direction. A producer
+  /// finding the ring full has to retry later or drop the message.
+  static constexpr size_t defaultNumSlots = 64;
+
+  /// The start of the region of a ring.
+  struct Header {
+    /// The number of messages ever consumed and produced, respectively. Their
+    /// difference is the number of queued messages. They are only ever written
+    /// by one side each and live on separate cache lines to avoid false
+    /// sharing.
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    /// The geometry of the ring, which never changes.
+    alignas(64) uint64_t numSlots;
+    uint64_t slotWords;
+  };
+
+  /// The number of buckets of the latency histogram. Bucket i counts the
+  /// messages which were queued for [2^i, 2^(i+1)) nanoseconds, the last one
+  /// all messages which took longer.
+  static constexpr size_t numLatencyBuckets = 32;
+
+  /// A snapshot of the traffic through a ring.
+  struct Stats {
+    uint64_t numMessages;
+    uint64_t numBytes;
+    /// The largest number of messages which were queued at once.
+    uint64_t maxDepth;
+    std::array<uint64_t, numLatencyBuckets> latencyHistogram;
+  };
+
+  /// Returns the size of the region of a ring in bytes, which is a multiple
+  /// of the alignment of the Header.
+  static size_t getRegionSize(size_t maxMessageSize,
+                              size_t numSlots = defaultNumSlots);
+
+  /// Place the ring into 'region', which has to be aligned like the Header,
+  /// hold getRegionSize() bytes, and outlive the ring. If 'region' is null,
+  /// the ring allocates it on the heap.
+  MessageRing(size_t maxMessageSize, size_t numSlots = defaultNumSlots,
+              void *region = nullptr);
+  MessageRing(const MessageRing &) = delete;
+
+  /// Returns the size of the largest message which fits into a slot.
+  size_t getMaxMessageSize() const { return slotWords * sizeof(uint64_t); }
+
+  /// Producer side: returns the buffer of the next free slot, or nullptr if the
+  /// ring is full. The message becomes visible to the consumer once it is
+  /// committed.
+  uint8_t *reserve() {
+    uint64_t t = header->tail.load(std::memory_order_relaxed);
+    if (t - header->head.load(std::memory_order_acquire) == numSlots)
+      return nullptr;
+    return getSlot(t);
+  }
+
+  /// Producer side: publishes the message of 'size' bytes written into the
+  /// buffer last returned by reserve().
+  void commit(size_t size) {
+    uint64_t t = header->tail.load(std::memory_order_relaxed);
+    sizes[t % numSlots] = size;
+    pushTimes[t % numSlots] = now();
+    // The statistics below are only written by the producer.
+    numBytes.store(numBytes.load(std::memory_order_relaxed) + size,
+                   std::memory_order_relaxed);
+    uint64_t depth = t + 1 - header->head.load(std::memory_order_relaxed);
+    if (depth > maxDepth.load(std::memory_order_relaxed))
+      maxDepth.store(depth, std::memory_order_relaxed);
+    header->tail.store(t + 1, std::memory_order_release);
+  }
+
+  /// Producer side: copies a message into the ring. Returns false if the ring
+  /// is full or the message does not fit into a slot.
+  bool push(const uint8_t *data, size_t size) {
+    if (size > getMaxMessageSize())
+      return false;
+    uint8_t *slot = reserve();
+    if (!slot)
+      return false;
+    std::memcpy(slot, data, size);
+    commit(size);
+    return true;
+  }
+
+  /// Consumer side: returns the number of queued messages. More messages may
+  /// be added concurrently, but none removed.
+  size_t getNumMessages() const {
+    return header->tail.load(std::memory_order_acquire) -
+           header->head.load(std::memory_order_relaxed);
+  }
+
+  /// Consumer side: returns the oldest message and sets 'size' to its length,
+  /// or returns nullptr if the ring is empty. The message stays valid until it
+  /// is released with pop().
+  const uint8_t *front(size_t &size) {
+    uint64_t h = header->head.load(std::memory_order_relaxed);
+    if (h == header->tail.load(std::memory_order_acquire))
+      return nullptr;
+    size = sizes[h % numSlots];
+    return getSlot(h);
+  }
+
+  /// Consumer side: releases the message returned by front(), making its slot
+  /// available to the producer again.
+  void pop() {
+    uint64_t h = header->head.load(std::memory_order_relaxed);
+    uint64_t latency = now() - pushTimes[h % numSlots];
+    size_t bucket = 0;
+    while (latency >>= 1)
+      ++bucket;
+    auto &count = latencyHistogram[std::min(bucket, numLatencyBuckets - 1)];
+    count.store(count.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+    header->head.store(h + 1, std::memory_order_release);
+  }
+
+  /// Returns the statistics of the ring. May be called from any thread. The
+  /// counters are sampled one by one, hence may be slightly out of sync.
+  Stats getStats() const;
+
+private:
+  /// Returns a monotonic timestamp in nanoseconds.
+  static uint64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  uint8_t *getSlot(uint64_t index) {
+    return reinterpret_cast<uint8_t *>(&slots[(index % numSlots) * slotWords]);
+  }
+
+  /// The region allocated for rings living on the heap.
+  std::unique_ptr<void, void (*)(void *)> ownedRegion;
+  /// The copies of the geometry in the header, for fast access.
+  const size_t numSlots;
+  const size_t slotWords;
+  Header *header;
+  uint64_t *sizes;
+  uint64_t *slots;
+  /// The time at which the message in each slot was committed. Messages which
+  /// a shared memory client exchanges directly are not timed.
+  std::unique_ptr<uint64_t[]> pushTimes;
+
+  /// Written by the producer only.
+  std::atomic<uint64_t> numBytes;
+  std::atomic<uint64_t> maxDepth;
+  /// Written by the consumer only.
+  std::array<std::atomic<uint64_t>, numLatencyBuckets> latencyHistogram;
+};
+
+/// A named POSIX shared memory object mapped into this process. Cosim clients
+/// on the same host map it as well to access the queues of an endpoint without
+/// going through RPC.
+class SharedMemory {
+public:
+  /// Create and map a shared memory object of 'size' bytes. Check isValid()
+  /// to find out whether this succeeded.
+  SharedMemory(std::string name, size_t size);
+  /// Unmap and remove the object.
+  ~SharedMemory();
+  SharedMemory(const SharedMemory &) = delete;
+
+  bool isValid() const { return base != nullptr; }
+  const std::string &getName() const { return name; }
+  void *getBase() const { return base; }
+
+private:
+  const std::string name;
+  const size_t size;
+  void *base;
+};
+
 /// Implements a bi-directional, thread-safe bridge between the RPC server and
 /// DPI functions.
 ///
+/// Each direction is a MessageRing, such that polling an endpoint from the
+/// simulator never blocks on the RPC server. This relies on the RPC server
+/// handling all requests on one thread, and the simulator polling all
+/// endpoints on another one.
+///
+/// With shared memory, both rings live in one shared memory object, the ring
+/// to the simulation first. A client which opened the endpoint then may
+/// access the rings directly in place of the RPC server.
+///
 /// Several of the methods below are inline with the declaration to make them
 /// candidates for inlining during compilation. This is particularly important
 /// on the simulation side since polling happens at each clock and we do not
 /// want to slow down the simulation any more than necessary.
 class Endpoint {
 public:
-  /// Representing messages as shared pointers to vectors may be a performance
-  /// issue in the future but it is the easiest way to ensure memory
-  /// correctness.
-  using Blob = std::vector<uint8_t>;
-  using BlobPtr = std::shared_ptr<Blob>;
-
   /// Construct an endpoint which knows and the type IDs in both directions.
+  /// The sizes bound the messages in either direction in bytes. If 'shmName'
+  /// is non-empty, the queues are placed into a shared memory object of that
+  /// name.
   Endpoint(uint64_t sendTypeId, int sendTypeMaxSize, uint64_t recvTypeId,
-           int recvTypeMaxSize);
+           int recvTypeMaxSize, const std::string &shmName = "");
   ~Endpoint();
   /// Disallow copying. There is only ONE endpoint object per logical endpoint
   /// so copying is almost always a bug.
@@ -48,45 +246,26 @@ public:
 
   uint64_t getSendTypeId() const { return sendTypeId; }
   uint64_t getRecvTypeId() const { return recvTypeId; }
+  /// Returns the name of the shared memory object holding the queues, or an
+  /// empty string if they are private to this process.
+  std::string getShmName() const { return shm ? shm->getName() : ""; }
 
   /// These two are used to set and unset the inUse flag, to ensure that an open
   /// endpoint is not opened again.
   bool setInUse();
   void returnForUse();
 
-  /// Queue message to the simulation.
-  void pushMessageToSim(BlobPtr msg) {
-    Lock g(m);
-    toCosim.push(msg);
-  }
-
-  /// Pop from the to-simulator queue. Return true if there was a message in the
-  /// queue.
-  bool getMessageToSim(BlobPtr &msg) {
-    Lock g(m);
-    if (toCosim.empty())
-      return false;
-    msg = toCosim.front();
-    toCosim.pop();
-    return true;
-  }
+  /// Message queue from RPC client to the simulation. Produced by the RPC
+  /// server and consumed by the simulator.
+  MessageRing &getToSim() { return toCosim; }
 
-  /// Queue message to the RPC client.
-  void pushMessageToClient(BlobPtr msg) {
-    Lock g(m);
-    toClient.push(msg);
-  }
+  /// Message queue to RPC client from the simulation. Produced by the simulator
+  /// and consumed by the RPC server.
+  MessageRing &getToClient() { return toClient; }
 
-  /// Pop from the to-RPC-client queue. Return true if there was a message in
-  /// the queue.
-  bool getMessageToClient(BlobPtr &msg) {
-    Lock g(m);
-    if (toClient.empty())
-      return false;
-    msg = toClient.front();
-    toClient.pop();
-    return true;
-  }
+  /// Returns the traffic statistics of both message queues.
+  MessageRing::Stats getToSimStats() const { return toCosim.getStats(); }
+  MessageRing::Stats getToClientStats() const { return toClient.getStats(); }
 
 private:
   const uint64_t sendTypeId;
@@ -95,14 +274,13 @@ private:
 
   using Lock = std::lock_guard<std::mutex>;
 
-  /// This class needs to be thread-safe. All of the mutable member variables
-  /// are protected with this object-wide lock. This may be a performance issue
-  /// in the future.
+  /// Protects the inUse flag. The message queues are lock-free and do not need
+  /// it.
   std::mutex m;
-  /// Message queue from RPC client to the simulation.
-  std::queue<BlobPtr> toCosim;
-  /// Message queue to RPC client from the simulation.
-  std::queue<BlobPtr> toClient;
+  /// The shared memory object backing the queues, if any. Has to outlive them.
+  std::unique_ptr<SharedMemory> shm;
+  MessageRing toCosim;
+  MessageRing toClient;
 };
 
 /// The Endpoint registry is where Endpoints report their existence (register)
@@ -115,6 +293,10 @@ public:
                         int sendTypeMaxSize, uint64_t recvTypeId,
                         int recvTypeMaxSize);
 
+  /// Place the queues of the endpoints registered from now on into shared
+  /// memory objects, named by 'prefix' and the endpoint ID.
+  void enableSharedMemory(std::string prefix);
+
   /// Get the specified endpoint. Return nullptr if it does not exist. This
   /// method is defined inline so it can be inlined at compile time. Performance
   /// is important here since this method is used in the polling call from the
@@ -142,6 +324,9 @@ private:
 
   /// Endpoint ID to object pointer mapping.
   std::map<std::string, Endpoint> endpoints;
+  /// The name prefix of the shared memory objects of the endpoints. Empty if
+  /// shared memory is disabled.
+  std::string shmPrefix;
 };
 
 } // namespace cosim
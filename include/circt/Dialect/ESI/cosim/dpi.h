@@ -39,6 +39,17 @@ extern int sv2cCosimserverEpTryGet(char *endpointId,
 extern int sv2cCosimserverEpTryPut(char *endpointId,
                                    // NOLINTNEXTLINE(misc-misplaced-const)
                                    const svOpenArrayHandle data, int dataLimit);
+/// Try to get several messages from a client at once.
+extern int sv2cCosimserverEpTryGetBatch(char *endpointId,
+                                        // NOLINTNEXTLINE(misc-misplaced-const)
+                                        const svOpenArrayHandle data,
+                                        unsigned int msgSize,
+                                        unsigned int *numMsgs);
+/// Send several messages to a client at once.
+extern int sv2cCosimserverEpTryPutBatch(char *endpointId,
+                                        // NOLINTNEXTLINE(misc-misplaced-const)
+                                        const svOpenArrayHandle data,
+                                        int msgSize, int numMsgs);
 
 /// Start the server. Not required as the first endpoint registration will do
 /// this. Provided if one wants to start the server early.
@@ -15,6 +15,7 @@
 #define CIRCT_DIALECT_FIRRTL_FIRPARSER_H
 
 #include "circt/Support/LLVM.h"
+#include <functional>
 
 namespace llvm {
 class SourceMgr;
@@ -28,14 +29,25 @@ class TimingScope;
 namespace circt {
 namespace firrtl {
 
+class FModuleOp;
+
 struct FIRParserOptions {
   /// If this is set to true, the @info locators are ignored, and the locations
   /// are set to the location in the .fir file.
   bool ignoreInfoLocators = false;
+  /// If this is set to true, the @info locators are reduced to a single file
+  /// and line, dropping the column and any further locators of compound
+  /// records. This makes many operations share the same location attribute.
+  bool compactInfoLocators = false;
   /// The number of annotation files that were specified on the command line.
   /// This, along with numOMIRFiles provides structure to the buffers in the
   /// source manager.
   unsigned numAnnotationFiles;
+  /// If set, this is called on each module as soon as its body has been
+  /// parsed, while the bodies of other modules may still be parsed in
+  /// parallel.  It must only touch the module it is given.  Returning failure
+  /// aborts parsing.
+  std::function<LogicalResult(FModuleOp)> moduleBodyCallback;
 };
 
 mlir::OwningOpRef<mlir::ModuleOp> importFIRFile(llvm::SourceMgr &sourceMgr,
@@ -48,7 +60,8 @@ mlir::OwningOpRef<mlir::ModuleOp> importFIRFile(llvm::SourceMgr &sourceMgr,
 // `skipParsing` option can be used to short-circuit parsing and just do
 // validation of the `spelling`.  This require both an Identifier and a
 // FileLineColLoc to use for caching purposes and context as the cache may be
-// updated with a new identifier.
+// updated with a new identifier.  If `compact` is set, only the line of the
+// first locator of a compound locator is kept.
 //
 // This utility exists because source locators can exist outside of normal
 // "parsing".  E.g., these can show up in annotations or in Object Model 2.0
@@ -60,7 +73,7 @@ std::pair<bool, llvm::Optional<mlir::LocationAttr>>
 maybeStringToLocation(llvm::StringRef spelling, bool skipParsing,
                       mlir::StringAttr &locatorFilenameCache,
                       FileLineColLoc &fileLineColLocCache,
-                      MLIRContext *context);
+                      MLIRContext *context, bool compact);
 
 void registerFromFIRFileTranslation();
 
@@ -130,6 +130,10 @@ struct CircuitTargetCache {
     return it->second;
   }
 
+  /// Eagerly create the caches for all modules in the circuit which do not
+  /// have one yet.  The module bodies are walked in parallel.
+  void populateAll(CircuitOp circuit);
+
   /// Lookup the target for 'name' in 'module'.
   AnnoTarget lookup(FModuleLike module, StringRef name) {
     return getOrCreateCacheFor(module).getTargetForName(name);
@@ -209,6 +213,10 @@ struct ApplyState {
   DenseMap<Attribute, FlatSymbolRefAttr> instPathToNLAMap;
   size_t numReusedHierPaths = 0;
 
+  /// Annotations added to operations and ports by the standard appliers.
+  /// These are written back to the IR once all annotations have been applied.
+  PendingAnnotations pendingAnnotations;
+
   ModuleNamespace &getNamespace(FModuleLike module) {
     auto &ptr = namespaces[module];
     if (!ptr)
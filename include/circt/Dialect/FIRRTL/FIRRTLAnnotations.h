@@ -15,6 +15,8 @@
 
 #include "circt/Support/LLVM.h"
 #include "mlir/IR/BuiltinAttributes.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/PointerLikeTypeTraits.h"
 
@@ -351,6 +353,53 @@ inline auto AnnotationSet::end() const -> iterator {
   return iterator(*this, annotations.size());
 }
 
+//===----------------------------------------------------------------------===//
+// PendingAnnotations
+//===----------------------------------------------------------------------===//
+
+/// A side table of annotations which are yet to be added to operations and
+/// their ports.  Adding annotations to the IR one at a time rebuilds and
+/// re-uniques the annotation array of the target on every addition, which is
+/// quadratic when many annotations land on the same operation.  This collects
+/// them instead, and writes the annotations of each operation back at once
+/// when `applyToIR` is called.
+///
+/// Annotations are written back after any annotations already present on the
+/// operation, in the order in which they were added to the table.
+class PendingAnnotations {
+public:
+  /// Queue an annotation to be added to an operation.
+  void addAnnotation(Operation *op, Attribute anno);
+
+  /// Queue an annotation to be added to a port of a module or memory.
+  void addPortAnnotation(Operation *op, unsigned portNo, Attribute anno);
+
+  /// Return true if an annotation with the specified class has been queued for
+  /// an operation or port.  This does not look at the annotations already
+  /// present in the IR.
+  bool hasAnnotation(Operation *op, StringAttr className) const;
+  bool hasPortAnnotation(Operation *op, unsigned portNo,
+                         StringAttr className) const;
+
+  /// Return true if no annotations are queued.
+  bool empty() const { return entries.empty(); }
+
+  /// Write all queued annotations back to the IR and clear the table.
+  void applyToIR();
+
+private:
+  struct Annotations {
+    SmallVector<Attribute> annos;
+    llvm::SmallDenseSet<Attribute, 4> classes;
+    void add(Attribute anno);
+  };
+  struct Entry {
+    Annotations opAnnos;
+    llvm::MapVector<unsigned, Annotations> portAnnos;
+  };
+  llvm::MapVector<Operation *, Entry> entries;
+};
+
 //===----------------------------------------------------------------------===//
 // AnnoTarget
 //===----------------------------------------------------------------------===//
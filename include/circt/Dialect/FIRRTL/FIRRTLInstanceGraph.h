@@ -25,6 +25,7 @@ namespace firrtl {
 using InstanceRecord = hw::InstanceRecord;
 using InstanceGraphNode = hw::InstanceGraphNode;
 using InstancePathCache = hw::InstancePathCache;
+using CompactInstancePath = hw::CompactInstancePath;
 
 /// This graph tracks modules and where they are instantiated. This is intended
 /// to be used as a cached analysis on FIRRTL circuits.  This class can be used
@@ -139,10 +139,11 @@ inline FIRRTLType mapBaseType(FIRRTLType type,
 // where there is FIRRTL stuff that needs to be parsed out of an annotation.
 //===----------------------------------------------------------------------===//
 
-/// Parse a string that may encode a FIRRTL location into a LocationAttr.
+/// Parse a string that may encode a FIRRTL location into a LocationAttr. If
+/// `compact` is set, only the line of the first locator is kept.
 std::pair<bool, Optional<mlir::LocationAttr>> maybeStringToLocation(
     StringRef spelling, bool skipParsing, StringAttr &locatorFilenameCache,
-    FileLineColLoc &fileLineColLocCache, MLIRContext *context);
+    FileLineColLoc &fileLineColLocCache, MLIRContext *context, bool compact);
 
 //===----------------------------------------------------------------------===//
 // Parallel utilities
@@ -200,11 +200,24 @@ public:
   /// Get or create the InnerSymbolTable for the specified operation.
   InnerSymbolTable &getInnerSymbolTable(Operation *op);
 
+  /// Return the already built InnerSymbolTable of the operation with the
+  /// specified symbol name, or null if there is none.  This is cheaper than
+  /// resolving the operation through a SymbolTable first.
+  InnerSymbolTable *lookupInnerSymbolTable(StringAttr name) const {
+    return tablesByName.lookup(name);
+  }
+
   /// Populate tables in parallel for all InnerSymbolTable operations in the
   /// given InnerRefNamespace operation, verifying each and returning
-  /// the verification result.
+  /// the verification result.  Tables that already exist are kept, so after
+  /// invalidating a few operations this only rebuilds those.
   LogicalResult populateAndVerifyTables(Operation *innerRefNSOp);
 
+  /// Drop the table of the specified operation, e.g. because inner symbols
+  /// were added to or removed from it, or because it is about to be erased or
+  /// renamed.  The table is rebuilt on the next query or population.
+  void invalidate(Operation *op);
+
   explicit InnerSymbolTableCollection() = default;
   explicit InnerSymbolTableCollection(Operation *innerRefNSOp) {
     // Caller is not interested in verification, no way to report it upwards.
@@ -217,8 +230,14 @@ public:
   operator=(const InnerSymbolTableCollection &) = delete;
 
 private:
+  /// Record a newly built table under the symbol name of its operation.
+  void addTableByName(Operation *op, InnerSymbolTable *table);
+
   /// This maps Operations to their InnnerSymbolTable's.
   DenseMap<Operation *, std::unique_ptr<InnerSymbolTable>> symbolTables;
+
+  /// This maps the symbol names of Operations to their built tables.
+  DenseMap<StringAttr, InnerSymbolTable *> tablesByName;
 };
 
 /// This class represents the namespace in which InnerRef's can be resolved.
@@ -119,6 +119,11 @@ public:
   /// 'lookup'.
   void erase(HierPathOp nlaOp, SymbolTable *symbolTable = nullptr);
 
+  /// Remove a batch of NLAs from the analysis. This is equivalent to calling
+  /// `erase` on each of them, but the list of NLAs of every module in their
+  /// namepaths is only filtered once, instead of once per NLA.
+  void eraseNLAs(ArrayRef<HierPathOp> nlas, SymbolTable *symbolTable = nullptr);
+
   /// Record a new FModuleLike operation. This updates the Module name to Module
   /// operation map.
   void addModule(FModuleLike mod) { symToOp[mod.moduleNameAttr()] = mod; }
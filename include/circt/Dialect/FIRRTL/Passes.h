@@ -72,7 +72,14 @@ std::unique_ptr<mlir::Pass> createWireDFTPass();
 
 std::unique_ptr<mlir::Pass> createAddSeqMemPortsPass();
 
-std::unique_ptr<mlir::Pass> createDedupPass();
+std::unique_ptr<mlir::Pass> createDedupPass(mlir::StringRef cacheFile = "",
+                                            mlir::StringRef cacheKey = "",
+                                            unsigned maxMergedLocs = 0,
+                                            bool fastHash = false);
+
+std::unique_ptr<mlir::Pass>
+createModuleFingerprintsPass(mlir::StringRef outputFilename = "",
+                             mlir::StringRef salt = "");
 
 std::unique_ptr<mlir::Pass>
 createEmitOMIRPass(mlir::StringRef outputFilename = "");
@@ -88,7 +95,8 @@ std::unique_ptr<mlir::Pass> createInferResetsPass();
 std::unique_ptr<mlir::Pass> createLowerMemoryPass();
 
 std::unique_ptr<mlir::Pass>
-createMemToRegOfVecPass(bool replSeqMem = false, bool ignoreReadEnable = false);
+createMemToRegOfVecPass(bool replSeqMem = false, bool ignoreReadEnable = false,
+                        uint64_t maxMemorySize = 0);
 
 std::unique_ptr<mlir::Pass> createPrefixModulesPass();
 
@@ -97,7 +105,8 @@ std::unique_ptr<mlir::Pass> createPrintInstanceGraphPass();
 std::unique_ptr<mlir::Pass> createPrintNLATablePass();
 
 std::unique_ptr<mlir::Pass>
-createBlackBoxReaderPass(llvm::Optional<mlir::StringRef> inputPrefix = {});
+createBlackBoxReaderPass(llvm::Optional<mlir::StringRef> inputPrefix = {},
+                         bool referenceFiles = false);
 
 std::unique_ptr<mlir::Pass> createGrandCentralPass();
 
@@ -135,6 +144,10 @@ createDropNamesPass(PreserveValues::PreserveMode mode = PreserveValues::None);
 
 std::unique_ptr<mlir::Pass> createExtractInstancesPass();
 
+std::unique_ptr<mlir::Pass>
+createExtractPartitionPass(mlir::StringRef root = "",
+                           llvm::ArrayRef<std::string> blackBoxes = {});
+
 std::unique_ptr<mlir::Pass> createIMDeadCodeElimPass();
 
 std::unique_ptr<mlir::Pass> createRandomizeRegisterInitPass();
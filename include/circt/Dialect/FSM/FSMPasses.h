@@ -22,6 +22,8 @@ namespace circt {
 namespace fsm {
 
 std::unique_ptr<mlir::Pass> createPrintFSMGraphPass();
+std::unique_ptr<mlir::Pass> createMinimizeStatesPass();
+std::unique_ptr<mlir::Pass> createSimplifyMachinesPass();
 
 /// Generate the code for registering passes.
 #define GEN_PASS_REGISTRATION
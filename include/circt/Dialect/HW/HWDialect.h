@@ -16,6 +16,8 @@
 #include "circt/Support/LLVM.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/Dialect.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/RWMutex.h"
 
 // Pull in the dialect definition.
 #include "circt/Dialect/HW/HWDialect.h.inc"
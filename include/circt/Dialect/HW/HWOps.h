@@ -105,6 +105,37 @@ PortInfo getModuleInOrInoutPort(Operation *op, size_t idx);
 /// Return the PortInfo for the specified output port.
 PortInfo getModuleOutputPort(Operation *op, size_t idx);
 
+/// This holds the decoded ports of a module or instance, along with maps from
+/// the port names to their indices, for repeated lookups of ports by name. It
+/// is a snapshot of the ports and has to be rebuilt after they are modified.
+struct ModulePortLookupInfo {
+  explicit ModulePortLookupInfo(ModulePortInfo ports);
+  explicit ModulePortLookupInfo(Operation *op)
+      : ModulePortLookupInfo(getModulePortInfo(op)) {}
+
+  /// Return the index of the input or inout port named 'name', or failure if
+  /// there is none.
+  FailureOr<unsigned> getInputPortIndex(StringAttr name) const;
+
+  /// Return the index of the output port named 'name', or failure if there is
+  /// none.
+  FailureOr<unsigned> getOutputPortIndex(StringAttr name) const;
+
+  /// Return the input or inout port named 'name', or failure if there is none.
+  FailureOr<PortInfo> getInputPort(StringAttr name) const;
+
+  /// Return the output port named 'name', or failure if there is none.
+  FailureOr<PortInfo> getOutputPort(StringAttr name) const;
+
+  /// The ports of the module or instance.
+  const ModulePortInfo &getPorts() const { return ports; }
+
+private:
+  ModulePortInfo ports;
+  llvm::DenseMap<StringAttr, unsigned> inputPortMap;
+  llvm::DenseMap<StringAttr, unsigned> outputPortMap;
+};
+
 /// Insert and remove ports of a module. The insertion and removal indices must
 /// be in ascending order. The indices refer to the port positions before any
 /// insertion or removal occurs. Ports inserted at the same index will appear in
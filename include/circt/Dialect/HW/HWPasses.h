@@ -24,6 +24,9 @@ namespace hw {
 std::unique_ptr<mlir::Pass> createPrintInstanceGraphPass();
 std::unique_ptr<mlir::Pass> createHWSpecializePass();
 std::unique_ptr<mlir::Pass> createPrintHWModuleGraphPass();
+std::unique_ptr<mlir::Pass> createHWNarrowWidthsPass();
+std::unique_ptr<mlir::Pass> createHWBalanceMuxChainsPass();
+std::unique_ptr<mlir::Pass> createHWCheckCombCyclesPass();
 
 /// Generate the code for registering passes.
 #define GEN_PASS_REGISTRATION
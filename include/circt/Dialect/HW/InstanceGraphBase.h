@@ -206,6 +206,27 @@ public:
   /// circuit.
   FailureOr<llvm::ArrayRef<InstanceGraphNode *>> getInferredTopLevelNodes();
 
+  /// Group the modules reachable from the top-level node into levels, such
+  /// that the modules of a level do not depend on each other and can be
+  /// processed in parallel, one level after the other. With `bottomUp`, a
+  /// module only instantiates modules of earlier levels. Otherwise, a module is
+  /// only instantiated by modules of earlier levels. The modules of a level are
+  /// in post order.
+  SmallVector<SmallVector<InstanceGraphNode *, 0>> getLevels(bool bottomUp);
+
+  /// Call `fn` on the modules of every level returned by `getLevels`, one
+  /// level after the other and on the modules of a level in parallel. `fn`
+  /// may only modify the module it is called on, and read the results of
+  /// earlier levels. All levels are processed even if `fn` fails, such that
+  /// all errors are reported; failure is returned if any call failed.
+  LogicalResult failableParallelForEachModule(
+      bool bottomUp, llvm::function_ref<LogicalResult(InstanceGraphNode *)> fn);
+
+  /// Call `fn` on the modules of every level returned by `getLevels`, like
+  /// `failableParallelForEachModule`.
+  void parallelForEachModule(bool bottomUp,
+                             llvm::function_ref<void(InstanceGraphNode *)> fn);
+
   /// Return the parent under which all nodes are nested.
   Operation *getParent() { return parent; }
 
@@ -240,6 +261,15 @@ public:
   /// of both InstanceOps must be the same.
   virtual void replaceInstance(HWInstanceLike inst, HWInstanceLike newInst);
 
+  /// Add a newly created instance to the instance graph.  The instance must
+  /// already be inserted into its parent module, and both the parent module
+  /// and the instantiated module must be in the graph.
+  virtual InstanceRecord *addInstance(HWInstanceLike inst);
+
+  /// Remove an instance from the instance graph, e.g. before erasing it or
+  /// moving it to a different module.  This does not modify the IR.
+  virtual void eraseInstance(HWInstanceLike inst);
+
 protected:
   /// Create a new module graph of a circuit.  Must be called on the parent
   /// operation of HWModuleLike ops.
@@ -279,6 +309,92 @@ static T &operator<<(T &os, const InstancePath &path) {
   return formatInstancePath(os, path);
 }
 
+/// A node in a trie of absolute instance paths.  Each node holds the last
+/// instance of a path and points to the node of the path without that
+/// instance, such that paths with a common prefix share the nodes of it.
+struct InstancePathNode {
+  HWInstanceLike instance;
+  const InstancePathNode *parent;
+  /// The number of instances in the path ending at this node.
+  unsigned size;
+};
+
+/// An absolute instance path which shares its prefix with other paths.  This
+/// is a pointer to the last node of the path in a trie of instance paths, or
+/// null for the empty path, and is cheap to copy.
+class CompactInstancePath {
+public:
+  CompactInstancePath() = default;
+  explicit CompactInstancePath(const InstancePathNode *node) : node(node) {}
+
+  bool empty() const { return !node; }
+  size_t size() const { return node ? node->size : 0; }
+  const InstancePathNode *getNode() const { return node; }
+
+  /// Return the last instance of the path.
+  HWInstanceLike back() const {
+    assert(node && "empty path");
+    return node->instance;
+  }
+
+  /// Return the path without its last instance.
+  CompactInstancePath dropBack() const {
+    assert(node && "empty path");
+    return CompactInstancePath(node->parent);
+  }
+
+  /// An iterator over the instances of a path, from the last to the first.
+  class reverse_iterator
+      : public llvm::iterator_facade_base<reverse_iterator,
+                                          std::forward_iterator_tag,
+                                          HWInstanceLike, std::ptrdiff_t,
+                                          HWInstanceLike *, HWInstanceLike> {
+  public:
+    reverse_iterator() = default;
+    explicit reverse_iterator(const InstancePathNode *node) : node(node) {}
+
+    HWInstanceLike operator*() const { return node->instance; }
+    reverse_iterator &operator++() {
+      node = node->parent;
+      return *this;
+    }
+    bool operator==(const reverse_iterator &other) const {
+      return node == other.node;
+    }
+
+  private:
+    const InstancePathNode *node = nullptr;
+  };
+
+  reverse_iterator rbegin() const { return reverse_iterator(node); }
+  reverse_iterator rend() const { return reverse_iterator(); }
+
+  /// Append the instances of the path, from the first to the last, to `path`.
+  void toVector(SmallVectorImpl<HWInstanceLike> &path) const {
+    path.resize(path.size() + size());
+    auto *it = path.end();
+    for (auto inst : llvm::make_range(rbegin(), rend()))
+      *--it = inst;
+  }
+
+  bool operator==(const CompactInstancePath &other) const {
+    return node == other.node;
+  }
+  bool operator!=(const CompactInstancePath &other) const {
+    return node != other.node;
+  }
+
+private:
+  const InstancePathNode *node = nullptr;
+};
+
+template <typename T>
+inline static T &formatInstancePath(T &into, CompactInstancePath path) {
+  SmallVector<HWInstanceLike, 8> instances;
+  path.toVector(instances);
+  return formatInstancePath(into, InstancePath(instances));
+}
+
 /// A data structure that caches and provides absolute paths to module instances
 /// in the IR.
 struct InstancePathCache {
@@ -289,6 +405,18 @@ struct InstancePathCache {
       : instanceGraph(instanceGraph) {}
   ArrayRef<InstancePath> getAbsolutePaths(HWModuleLike op);
 
+  /// Return the absolute paths to a module as compact paths.  These share
+  /// their prefixes with each other and with the paths of all parent
+  /// modules, such that each path only costs a single trie node.  This is
+  /// cached separately from `getAbsolutePaths`.
+  ArrayRef<CompactInstancePath> getCompactAbsolutePaths(HWModuleLike op);
+
+  /// Append an instance to a compact path.  The new path is owned by this
+  /// cache, but is not updated by `replaceInstance` unless it was returned by
+  /// `getCompactAbsolutePaths`.
+  CompactInstancePath appendInstance(CompactInstancePath path,
+                                     HWInstanceLike inst);
+
   /// Replace an InstanceOp. This is required to keep the cache updated.
   void replaceInstance(HWInstanceLike oldOp, HWInstanceLike newOp);
 
@@ -299,6 +427,9 @@ private:
   /// Cached absolute instance paths.
   DenseMap<Operation *, ArrayRef<InstancePath>> absolutePathsCache;
 
+  /// Cached absolute instance paths in compact form.
+  DenseMap<Operation *, ArrayRef<CompactInstancePath>> compactPathsCache;
+
   /// Append an instance to a path.
   InstancePath appendInstance(InstancePath path, HWInstanceLike inst);
 };
@@ -36,8 +36,10 @@ createHandshakeLowerExtmemToHWPass(std::optional<bool> createESIWrapper = {});
 std::unique_ptr<mlir::Pass> createHandshakeLegalizeMemrefsPass();
 std::unique_ptr<mlir::OperationPass<handshake::FuncOp>>
 createHandshakeInsertBuffersPass(const std::string &strategy = "all",
-                                 unsigned bufferSize = 2);
+                                 unsigned bufferSize = 2,
+                                 unsigned targetII = 1);
 std::unique_ptr<mlir::Pass> createHandshakeLockFunctionsPass();
+std::unique_ptr<mlir::Pass> createHandshakeShareOperatorsPass();
 
 /// Iterates over the handshake::FuncOp's in the program to build an instance
 /// graph. In doing so, we detect whether there are any cycles in this graph, as
@@ -65,7 +67,11 @@ LogicalResult lockRegion(Region &r, OpBuilder &rewriter);
 
 // Applies the spcified buffering strategy on the region r.
 LogicalResult bufferRegion(Region &r, OpBuilder &rewriter, StringRef strategy,
-                           unsigned bufferSize);
+                           unsigned bufferSize, unsigned targetII = 1);
+
+// Returns the largest number of cycles a token takes to pass through any cycle
+// of the dataflow graph in region r. Only sequential buffers add latency.
+unsigned getCriticalCycleLatency(Region &r);
 
 /// Generate the code for registering passes.
 #define GEN_PASS_REGISTRATION
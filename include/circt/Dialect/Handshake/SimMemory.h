@@ -0,0 +1,75 @@
+//===- SimMemory.h - Memories of the handshake simulator --------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the typed memories which back memrefs and memory
+// operations in the handshake simulator.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef CIRCT_DIALECT_HANDSHAKE_SIMMEMORY_H
+#define CIRCT_DIALECT_HANDSHAKE_SIMMEMORY_H
+
+#include "circt/Support/LLVM.h"
+#include "mlir/IR/Types.h"
+#include "llvm/ADT/Any.h"
+#include "llvm/Support/Error.h"
+
+#include <vector>
+
+namespace circt {
+namespace handshake {
+
+/// A memory of the simulator.  The elements are stored contiguously in
+/// little-endian byte order, each one taking its bit width rounded up to whole
+/// bytes.  This is also the layout of the binary files a memory is read from
+/// and written to.
+class SimMemory {
+public:
+  /// Create a zero-initialized memory of `size` elements of `elementType`,
+  /// which must be an integer or a float type.
+  SimMemory(mlir::Type elementType, size_t size);
+
+  mlir::Type getElementType() const { return elementType; }
+  size_t size() const { return numElements; }
+  /// Return the raw contents of the memory.
+  ArrayRef<uint8_t> getData() const { return data; }
+
+  /// Return the element at `index` as an APInt or APFloat.
+  llvm::Any load(size_t index) const;
+  /// Set the element at `index` to an APInt or APFloat, which is truncated or
+  /// converted to the element type.
+  void store(size_t index, const llvm::Any &value);
+
+  /// Return the bits of the element at `index`.  The element type must be at
+  /// most 64 bits wide.
+  uint64_t loadBits(size_t index) const;
+  /// Set the bits of the element at `index`.  The element type must be at
+  /// most 64 bits wide, and bits above its width are ignored.
+  void storeBits(size_t index, uint64_t bits);
+
+  /// Read the whole memory from a binary file, which must be exactly as large
+  /// as the memory.
+  llvm::Error readFromFile(StringRef path);
+  /// Write the whole memory to a binary file.
+  llvm::Error writeToFile(StringRef path) const;
+
+private:
+  APInt loadAPInt(size_t index) const;
+  void storeAPInt(size_t index, const APInt &bits);
+
+  mlir::Type elementType;
+  unsigned width;
+  unsigned elementBytes;
+  size_t numElements;
+  std::vector<uint8_t> data;
+};
+
+} // namespace handshake
+} // namespace circt
+
+#endif // CIRCT_DIALECT_HANDSHAKE_SIMMEMORY_H
@@ -17,13 +17,48 @@
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/MLIRContext.h"
 #include <string>
+#include <vector>
 
 namespace circt {
 namespace handshake {
+
+/// The formats results of a batch of simulations can be written in.
+enum class OutputFormat {
+  /// One line per input vector with space-separated results, followed by the
+  /// comma-separated contents of every memref argument.
+  Text,
+  /// One line per input vector with the index of the vector, the results and
+  /// the quoted contents of every memref argument.
+  CSV,
+  /// For every input vector, the results followed by the contents of every
+  /// memref argument, in little-endian order and without separators.
+  Binary
+};
+
+/// Execute `toplevelFunction` on the given arguments and print its results.
+/// Memref arguments are given as comma-separated lists of values, or as
+/// `@<path>` to read them from a binary file.  If `memrefDumpPrefix` is not
+/// empty, the final contents of the memref argument with index `i` are
+/// written to `<memrefDumpPrefix><i>.bin` rather than printed.  If
+/// `profileFile` is not empty, a JSON profile of the tokens processed by each
+/// operation and waiting on each channel of a handshake function is written
+/// to it.
 bool simulate(llvm::StringRef toplevelFunction,
               llvm::ArrayRef<std::string> inputArgs,
               mlir::OwningOpRef<mlir::ModuleOp> &module,
-              mlir::MLIRContext &context);
+              mlir::MLIRContext &context,
+              llvm::StringRef memrefDumpPrefix = {},
+              llvm::StringRef profileFile = {});
+
+/// Execute `toplevelFunction` on every vector of arguments in `inputVectors`
+/// and write the results to `os` in `format`, in the order of the vectors.
+/// If `parallel` is set, the vectors are executed in parallel on the thread
+/// pool of `context`.  Returns true if the execution of any vector failed.
+bool simulateBatch(llvm::StringRef toplevelFunction,
+                   llvm::ArrayRef<std::vector<std::string>> inputVectors,
+                   mlir::OwningOpRef<mlir::ModuleOp> &module,
+                   mlir::MLIRContext &context, llvm::raw_ostream &os,
+                   OutputFormat format, bool parallel);
 } // namespace handshake
 } // namespace circt
 
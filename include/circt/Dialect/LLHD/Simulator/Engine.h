@@ -18,6 +18,7 @@
 
 #include "circt/Dialect/LLHD/IR/LLHDOps.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "llvm/Support/Error.h"
 
 namespace mlir {
 class ExecutionEngine;
@@ -26,6 +27,9 @@ class ExecutionEngine;
 namespace llvm {
 class Error;
 class Module;
+namespace orc {
+class LLJIT;
+} // namespace orc
 } // namespace llvm
 
 namespace circt {
@@ -34,20 +38,44 @@ namespace sim {
 
 class Engine {
 public:
+  /// Counters describing the work done by the last call to `simulate`.
+  struct Statistics {
+    /// The number of delta cycles, i.e. of event queue slots processed.
+    uint64_t deltaCycles = 0;
+    /// The number of signal drives and process wakeups processed.
+    uint64_t events = 0;
+    /// The number of times an instance was evaluated.
+    uint64_t instanceRuns = 0;
+    /// The wall time spent in the simulation loop, in seconds.
+    double seconds = 0;
+  };
+
   /// Initialize an LLHD simulation engine. This initializes the state, as well
-  /// as the mlir::ExecutionEngine with the given module.
+  /// as the mlir::ExecutionEngine with the given module. If `objectFile` is
+  /// set, the compiled design is written to it, or loaded from it instead of
+  /// being compiled again if it already exists.
   Engine(
       llvm::raw_ostream &out, ModuleOp module,
       llvm::function_ref<mlir::LogicalResult(mlir::ModuleOp)> mlirTransformer,
       llvm::function_ref<llvm::Error(llvm::Module *)> llvmTransformer,
-      std::string root, TraceMode tm, ArrayRef<StringRef> sharedLibPaths);
+      std::string root, TraceMode tm, ArrayRef<StringRef> sharedLibPaths,
+      StringRef objectFile = {});
 
   /// Default destructor
   ~Engine();
 
   /// Run simulation up to n steps or maxTime picoseconds of simulation time.
-  /// n=0 and T=0 make the simulation run indefinitely.
-  int simulate(int n, uint64_t maxTime);
+  /// n=0 and T=0 make the simulation run indefinitely. If `parallel` is set,
+  /// the instances woken up at the same step are evaluated concurrently. If
+  /// `checkpointIn` is set, the simulation resumes from the checkpoint stored
+  /// in that file rather than starting at time zero. If `checkpointOut` is
+  /// set, a checkpoint of the state the simulation stopped in is written to
+  /// that file. If `activityOut` is set, the toggles of every signal bit and
+  /// the time it spent high are counted, and written to that file in SAIF
+  /// format once the simulation stops.
+  int simulate(int n, uint64_t maxTime, bool parallel = false,
+               StringRef checkpointIn = {}, StringRef checkpointOut = {},
+               StringRef activityOut = {});
 
   /// Build the instance layout of the design.
   void buildLayout(ModuleOp module);
@@ -58,6 +86,9 @@ public:
   /// Get the simulation state.
   const State *getState() const { return state.get(); }
 
+  /// Get the statistics of the last simulation run.
+  const Statistics &getStatistics() const { return statistics; }
+
   /// Dump the instance layout stored in the State.
   void dumpStateLayout();
 
@@ -67,12 +98,24 @@ public:
 private:
   void walkEntity(EntityOp entity, Instance &child);
 
+  /// Load a design compiled by a previous run from `objectFile`.
+  llvm::Error loadObjectFile(StringRef objectFile,
+                             ArrayRef<StringRef> sharedLibPaths);
+
+  /// Look up the packed wrapper of the function `name` in the compiled design.
+  llvm::Expected<void (*)(void **)> lookupPacked(StringRef name);
+
   llvm::raw_ostream &out;
   std::string root;
   std::unique_ptr<State> state;
   std::unique_ptr<mlir::ExecutionEngine> engine;
+  // The JIT holding the design if it was loaded from an object file.
+  std::unique_ptr<llvm::orc::LLJIT> objectJIT;
+  // The object file to write the compiled design to, if any.
+  std::string objectFileToWrite;
   ModuleOp module;
   TraceMode traceMode;
+  Statistics statistics;
 };
 
 } // namespace sim
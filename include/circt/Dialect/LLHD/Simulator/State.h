@@ -17,6 +17,7 @@
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Error.h"
 
 #include <map>
 #include <queue>
@@ -57,6 +58,10 @@ public:
 
   uint64_t getTime() const { return time; }
 
+  uint64_t getDelta() const { return delta; }
+
+  uint64_t getEps() const { return eps; }
+
 private:
   /// Simulation real time.
   uint64_t time;
@@ -77,19 +82,15 @@ class Signal {
 public:
   /// Construct an "empty" signal.
   Signal(std::string name, std::string owner)
-      : name(name), owner(owner), size(0), value(nullptr) {}
+      : size(0), value(nullptr), name(name), owner(owner) {}
 
   /// Construct a signal with the given name, owner and initial value.
   Signal(std::string name, std::string owner, uint8_t *value, uint64_t size)
-      : name(name), owner(owner), size(size), value(value) {}
+      : size(size), value(value), name(name), owner(owner) {}
 
   /// Default move constructor.
   Signal(Signal &&) = default;
 
-  /// Free 'value' since it is allocated using 'malloc' in the LLVM code
-  /// generated by LLHDToLLVM.
-  ~Signal();
-
   /// Returns true if the signals match in name, owner, size and value.
   bool operator==(const Signal &rhs) const {
     if (owner != rhs.owner || name != rhs.name || size != rhs.size)
@@ -116,13 +117,31 @@ public:
 
   uint64_t getSize() const { return size; }
 
+  /// Set the number of significant bits of the signal value, if the signal is
+  /// of integer type.
+  void setBitWidth(uint64_t width) { bitWidth = width; }
+
+  /// Return the number of significant bits of the signal value.
+  uint64_t getBitWidth() const { return bitWidth ? bitWidth : size * 8; }
+
   uint8_t *getValue() const { return value; }
 
   const std::vector<unsigned> &getTriggeredInstanceIndices() const {
     return instanceIndices;
   }
 
-  void pushInstanceIndex(unsigned i) { instanceIndices.push_back(i); }
+  /// Return, for each triggered instance, the position of this signal in the
+  /// sensitivity list of that instance.
+  const std::vector<unsigned> &getTriggeredSensitivityIndices() const {
+    return sensitivityIndices;
+  }
+
+  /// Add instance `i` to the instances triggered by this signal, where the
+  /// signal is at position `sensIndex` in the instance's sensitivity list.
+  void pushInstanceIndex(unsigned i, unsigned sensIndex) {
+    instanceIndices.push_back(i);
+    sensitivityIndices.push_back(sensIndex);
+  }
 
   bool hasElement() const { return elements.size() > 0; }
 
@@ -192,13 +211,22 @@ public:
   std::string toHexString(unsigned) const;
 
 private:
-  std::string name;
-  std::string owner;
-  // The list of instances this signal triggers.
-  std::vector<unsigned> instanceIndices;
+  // The members accessed on every change of the signal come first, such that
+  // they share a cache line. The value itself is stored in the state's signal
+  // arena once the state is packed, see `State::packSignals`.
   uint64_t size;
   uint8_t *value;
+  // The list of instances this signal triggers.
+  std::vector<unsigned> instanceIndices;
+  // The position of the signal in the sensitivity list of each instance it
+  // triggers.
+  std::vector<unsigned> sensitivityIndices;
+  // Metadata only used for tracing.
+  std::string name;
+  std::string owner;
   std::vector<std::pair<unsigned, unsigned>> elements;
+  // The number of significant bits of the value, or zero if all are.
+  uint64_t bitWidth = 0;
 };
 
 /// The simulator's internal representation of one queue slot.
@@ -218,11 +246,22 @@ struct Slot {
   /// Insert a scheduled process wakeup.
   void insertChange(unsigned inst);
 
+  /// A drive of `width` bits at `bitOffset` within a signal. The driven value
+  /// is stored in the slot's `driveBytes`, starting at `byteOffset`.
+  struct Drive {
+    unsigned bitOffset;
+    unsigned width;
+    unsigned byteOffset;
+  };
+
   // A map from signal indexes to change buffers. Makes it easy to sort the
   // changes such that we can process one signal at a time.
   llvm::SmallVector<std::pair<unsigned, unsigned>, 32> changes;
   // Buffers for the signal changes.
-  llvm::SmallVector<std::pair<unsigned, llvm::APInt>, 32> buffers;
+  llvm::SmallVector<Drive, 32> buffers;
+  // The values of all the drives in the slot. Kept allocated when the slot is
+  // reused, such that inserting changes does not allocate in steady state.
+  llvm::SmallVector<uint8_t, 128> driveBytes;
   // The number of used change buffers in the slot.
   size_t changesSize = 0;
 
@@ -233,9 +272,14 @@ struct Slot {
 };
 
 /// This is equivalent to and std::priorityQueue<Slot> ordered using the greater
-/// operator, which adds an insertion method to add changes to a slot.
+/// operator, which adds an insertion method to add changes to a slot. The
+/// slots are stored in the vector and reused once popped, while an ordered
+/// index maps the time of each pending slot to its position, such that both
+/// finding the slot of a given time and finding the earliest slot take
+/// logarithmic time in the number of pending slots.
 class UpdateQueue : public llvm::SmallVector<Slot, 8> {
-  unsigned topSlot = 0;
+  /// The pending slots, ordered by their time.
+  std::map<Time, unsigned> slotsByTime;
   llvm::SmallVector<unsigned, 4> unused;
 
 public:
@@ -265,6 +309,25 @@ public:
   unsigned events = 0;
 };
 
+/// The drives and scheduled wakeups of one instance evaluated in parallel with
+/// others. They are added to the event queue once all instances are done, in
+/// the order the instances would have run in sequentially.
+struct EventBuffer {
+  struct Event {
+    Time time;
+    // The signal driven, or the instance to wake up.
+    unsigned index;
+    int bitOffset;
+    unsigned width;
+    // The offset of the driven value in `bytes`.
+    unsigned byteOffset;
+    bool isWakeup;
+  };
+
+  llvm::SmallVector<Event, 4> events;
+  llvm::SmallVector<uint8_t, 32> bytes;
+};
+
 /// State structure for process persistence across suspension.
 struct ProcState {
   unsigned inst;
@@ -290,8 +353,16 @@ struct Instance {
   size_t nArgs = 0;
   // The arguments and signals of this instance.
   llvm::SmallVector<SignalDetail, 0> sensitivityList;
+  // For entities, whether the entity reads each signal of the sensitivity list
+  // and thus needs to be evaluated again when it changes. Entities are not
+  // triggered by the signals they only drive or pass on to child instances.
+  llvm::SmallVector<bool, 0> readsSignal;
   ProcState *procState;
   uint8_t *entityState;
+  // The size in bytes of the process or entity state.
+  uint64_t stateSize = 0;
+  // The byte offsets of the signal structs persisted in the process state.
+  llvm::SmallVector<uint64_t, 0> persistedSignalOffsets;
   Time expectedWakeup;
   // A pointer to the base unit jitted function.
   void (*unitFPtr)(void **);
@@ -317,6 +388,17 @@ struct State {
   /// Push a new scheduled wakeup event in the event queue.
   void pushQueue(Time time, unsigned inst);
 
+  /// Push a new signal drive in the event queue.
+  void pushDrive(Time time, unsigned index, int bitOffset, uint8_t *bytes,
+                 unsigned width);
+
+  /// Record the events pushed by the current thread in `buffer` instead of
+  /// adding them to the event queue, or stop doing so if `buffer` is null.
+  static void setThreadEventBuffer(EventBuffer *buffer);
+
+  /// Add the events recorded in `buffer` to the event queue, and clear it.
+  void flushEventBuffer(EventBuffer &buffer);
+
   /// Find an instance in the instances list by name and return an
   /// iterator for it.
   llvm::SmallVectorTemplateCommon<Instance>::iterator
@@ -330,8 +412,35 @@ struct State {
 
   void addSignalElement(unsigned, unsigned, unsigned);
 
-  /// Add a pointer to the process persistence state to a process instance.
-  void addProcPtr(std::string name, ProcState *procStatePtr);
+  /// Move the values of all signals into one contiguous arena, laid out in
+  /// the order the instances access them, and free the buffers the values
+  /// were allocated in by the LLVM code generated in LLHDToLLVM. Must be
+  /// called once all signals have been added, before the simulation starts.
+  void packSignals();
+
+  /// Add a pointer to the process persistence state of `size` bytes to a
+  /// process instance.
+  void addProcPtr(std::string name, ProcState *procStatePtr, uint64_t size);
+
+  /// Write the current time, signal values, pending events and the states of
+  /// all instances to `out`, in a compact binary format.
+  void saveCheckpoint(llvm::raw_ostream &out) const;
+
+  /// Restore a checkpoint written by `saveCheckpoint`. The state must be of
+  /// the same design, and its signals must be packed already.
+  llvm::Error restoreCheckpoint(llvm::StringRef data);
+
+  /// Start recording the switching activity of every signal bit from the
+  /// current time on. Must be called once the signals are packed.
+  void enableActivity();
+
+  /// Record the switching activity of the signal `index` about to change to
+  /// `newValue` at the current time. Does nothing if the value is unchanged.
+  void recordActivity(unsigned index, const uint8_t *newValue);
+
+  /// Write the switching activity recorded up to the current time to `out`,
+  /// in the Switching Activity Interchange Format (SAIF).
+  void dumpActivity(llvm::raw_ostream &out) const;
 
   /// Dump a signal to the out stream. One entry is added for every instance
   /// the signal appears in.
@@ -347,7 +456,27 @@ struct State {
   std::string root;
   llvm::SmallVector<Instance, 0> instances;
   llvm::SmallVector<Signal, 0> signals;
+  // The values of all signals, see `packSignals`. Stored as words to keep
+  // every value 8-byte aligned.
+  std::vector<uint64_t> signalArena;
   UpdateQueue queue;
+
+  /// The switching activity of one signal bit.
+  struct BitActivity {
+    // The number of transitions of the bit.
+    uint64_t toggles = 0;
+    // The time the bit spent high until the last change of its signal.
+    uint64_t highTime = 0;
+  };
+
+  // The switching activity of every signal bit, see `enableActivity`. The bits
+  // of signal i start at `activityOffsets[i]`. Empty if no activity is
+  // recorded.
+  std::vector<BitActivity> activity;
+  std::vector<uint64_t> activityOffsets;
+  // The time of the last change of each signal.
+  std::vector<uint64_t> lastChangeTimes;
+  uint64_t activityStartTime = 0;
 };
 
 } // namespace sim
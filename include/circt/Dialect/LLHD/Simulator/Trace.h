@@ -16,7 +16,11 @@
 
 #include "State.h"
 
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace llvm {
@@ -27,7 +31,15 @@ namespace circt {
 namespace llhd {
 namespace sim {
 
-enum class TraceMode { Full, Reduced, Merged, MergedReduce, NamedOnly, None };
+enum class TraceMode {
+  Full,
+  Reduced,
+  Merged,
+  MergedReduce,
+  NamedOnly,
+  VCD,
+  None
+};
 
 class Trace {
   llvm::raw_ostream &out;
@@ -60,10 +72,48 @@ class Trace {
   // Flush the changes buffer to the output stream with merged format.
   void flushMerged();
 
+  /// The values of the signals that changed during one real-time step, as
+  /// recorded for the VCD format.
+  struct VCDStep {
+    uint64_t time;
+    // The changed signals, along with the offset of their value in `bytes`.
+    std::vector<std::pair<unsigned, size_t>> changes;
+    std::vector<uint8_t> bytes;
+  };
+
+  // The signals changed since the last VCD step, and whether each signal is
+  // among them.
+  std::vector<unsigned> vcdChanged;
+  std::vector<bool> isVCDChanged;
+  // The VCD identifier code of each signal.
+  std::vector<std::string> vcdIds;
+  // The last value written for each signal, or no value before the first.
+  std::vector<std::vector<uint8_t>> vcdLastValue;
+  // The steps recorded but not yet written, and the thread writing them.
+  std::deque<VCDStep> vcdSteps;
+  std::mutex vcdMutex;
+  std::condition_variable vcdCondition;
+  bool vcdDone = false;
+  std::thread vcdWriter;
+
+  /// Mark a signal as changed in the current VCD step.
+  void addChangeVCD(unsigned sigIndex);
+  /// Write the VCD header, declaring a variable for each traced signal in the
+  /// scope of each instance it is connected to.
+  void writeVCDHeader();
+  /// Record the values of the signals changed during the current step, and
+  /// hand them over to the writer thread.
+  void flushVCD();
+  /// Write the recorded steps to the output stream until the trace is done.
+  void runVCDWriter();
+
 public:
   Trace(std::unique_ptr<State> const &state, llvm::raw_ostream &out,
         TraceMode mode);
 
+  /// Wait for any pending output to be written.
+  ~Trace();
+
   /// Add a value change to the trace changes buffer.
   void addChange(unsigned);
 
@@ -29,6 +29,8 @@ std::unique_ptr<OperationPass<ProcOp>> createMemoryToBlockArgumentPass();
 
 std::unique_ptr<OperationPass<ProcOp>> createEarlyCodeMotionPass();
 
+std::unique_ptr<OperationPass<ModuleOp>> createInlineEntitiesPass();
+
 /// Register the LLHD Transformation passes.
 void initLLHDTransformationPasses();
 
@@ -18,6 +18,10 @@
 
 #include "mlir/IR/Operation.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+
+#include <map>
+#include <set>
 
 namespace circt {
 namespace msft {
@@ -26,31 +30,21 @@ namespace msft {
 /// device.
 class PrimitiveDB {
 public:
-  /// Create a DB treating 'top' as the root module.
+  /// Create an empty DB.
   PrimitiveDB(MLIRContext *);
 
   /// Place a primitive at a location.
   LogicalResult addPrimitive(PhysLocationAttr);
   /// Check to see if a primitive exists.
-  bool isValidLocation(PhysLocationAttr);
+  bool isValidLocation(PhysLocationAttr) const;
 
   /// Iterate over all the primitive locations, executing 'callback' on each
   /// one.
   void foreach (function_ref<void(PhysLocationAttr)> callback) const;
 
 private:
-  using DimPrimitiveType = DenseSet<PrimitiveType>;
-  using DimNumMap = DenseMap<size_t, DimPrimitiveType>;
-  using DimYMap = DenseMap<size_t, DimNumMap>;
-  using DimXMap = DenseMap<size_t, DimYMap>;
-
-  /// Get the leaf node. Abstract this out to make it easier to change the
-  /// underlying data structure.
-  DimPrimitiveType &getLeaf(PhysLocationAttr);
-  // TODO: Create read-only version of getLeaf.
-
-  DimXMap placements;
-  MLIRContext *ctxt;
+  /// Location attributes are uniqued, hence identify a primitive location.
+  DenseSet<PhysLocationAttr> locations;
 };
 
 /// A data structure to contain both the locations of the primitives on the
@@ -82,6 +76,19 @@ public:
                          StringRef subpath, Location srcLoc);
   PDRegPhysLocationOp place(DynamicInstanceOp inst, LocationVectorAttr,
                             Location srcLoc);
+
+  /// One placement of a bulk placement. 'loc' is either a PhysLocationAttr or
+  /// a LocationVectorAttr. The subpath only applies to the former.
+  struct PlacementRequest {
+    DynamicInstanceOp inst;
+    Attribute loc;
+    StringRef subPath;
+  };
+  /// Assign many instances at once. Returns the placement op of every request,
+  /// which is null if a location is invalid or already occupied. No ops are
+  /// created for failing requests.
+  SmallVector<DynInstDataOpInterface>
+  placeAll(ArrayRef<PlacementRequest> requests, Location srcLoc);
   /// Assign an operation to a physical region. Return false on failure.
   PDPhysRegionOp placeIn(DynamicInstanceOp inst, DeclPhysicalRegionOp,
                          StringRef subPath, Location srcLoc);
@@ -99,10 +106,10 @@ public:
   LogicalResult movePlacement(PDRegPhysLocationOp, LocationVectorAttr);
 
   /// Lookup the instance at a particular location.
-  DynInstDataOpInterface getInstanceAt(PhysLocationAttr);
+  DynInstDataOpInterface getInstanceAt(PhysLocationAttr) const;
 
   /// Find the nearest unoccupied primitive location to 'nearestToY' in
-  /// 'column'.
+  /// 'column'. Of two equally near locations, the lower one is returned.
   PhysLocationAttr getNearestFreeInColumn(PrimitiveType prim, uint64_t column,
                                           uint64_t nearestToY);
 
@@ -123,23 +130,37 @@ private:
   /// A memory slot. Useful to distinguish the memory location from the
   /// reference stored there.
   struct PlacementCell {
+    PhysLocationAttr loc;
     DynInstDataOpInterface locOp;
   };
 
   MLIRContext *ctxt;
   mlir::ModuleOp topMod;
 
-  using DimDevType = DenseMap<PrimitiveType, PlacementCell>;
-  using DimNumMap = DenseMap<size_t, DimDevType>;
-  using DimYMap = DenseMap<size_t, DimNumMap>;
-  using DimXMap = DenseMap<size_t, DimYMap>;
+  /// The cells of a column, sorted by row, then number, then primitive type,
+  /// which is the order they are walked in.
+  using ColumnPos = std::tuple<uint64_t, uint64_t, PrimitiveType>;
+  using Column = std::map<ColumnPos, PlacementCell>;
+  /// The rows and numbers of the unoccupied cells of one primitive type in a
+  /// column.
+  using FreeCells = std::set<std::pair<uint64_t, uint64_t>>;
   using RegionPlacements = SmallVector<PDPhysRegionOp>;
 
-  /// Get the leaf node. Abstract this out to make it easier to change the
-  /// underlying data structure.
+  /// Get the leaf node. Returns null if the location isn't part of a seeded
+  /// database, and creates the cell if the database isn't seeded.
   PlacementCell *getLeaf(PhysLocationAttr);
-
-  DimXMap placements;
+  /// Create an unoccupied cell for 'loc'.
+  PlacementCell *addCell(PhysLocationAttr loc);
+  /// Set the occupant of 'cell', keeping the free cell sets up to date.
+  void setOccupant(PlacementCell *cell, DynInstDataOpInterface op);
+
+  /// All the cells, by column. The walks iterate these in order.
+  std::map<uint64_t, Column> placements;
+  /// The cell of every location, for constant time lookups.
+  DenseMap<PhysLocationAttr, PlacementCell *> cells;
+  /// The unoccupied cells by column and primitive type, such that the nearest
+  /// free cell is found with a single search.
+  DenseMap<std::pair<uint64_t, PrimitiveType>, FreeCells> freeCells;
   RegionPlacements regionPlacements;
   bool seeded;
 
@@ -625,6 +625,7 @@ class UnpackedRefType;
 
 namespace detail {
 UnpackedType getIndirectTypeInner(const TypeStorage *impl);
+UnpackedType getIndirectTypeFullyResolved(const TypeStorage *impl);
 Location getIndirectTypeLoc(const TypeStorage *impl);
 StringAttr getIndirectTypeName(const TypeStorage *impl);
 } // namespace detail
@@ -669,7 +670,10 @@ public:
   /// Resolve all name or type reference indirections. This always returns the
   /// fully resolved inner type. See `PackedType::fullyResolved` and
   /// `UnpackedType::fullyResolved`.
-  BaseTy fullyResolved() const { return getInner().fullyResolved(); }
+  BaseTy fullyResolved() const {
+    return detail::getIndirectTypeFullyResolved(this->impl)
+        .template cast<BaseTy>();
+  }
 };
 
 /// A named type.
@@ -151,6 +151,13 @@ LogicalResult verifyInProceduralRegion(Operation *op);
 /// Return true if the specified operation is not in a procedural region.
 LogicalResult verifyInNonProceduralRegion(Operation *op);
 
+/// Return the name of the attribute which makes an `sv.verbatim` refer to a
+/// source file. The contents of the file are emitted in place of the format
+/// string, as is and without substitutions.
+inline StringRef getVerbatimSourceFileAttrName() {
+  return "sv.verbatim.source_file";
+}
+
 /// Signals that an operations regions are procedural.
 template <typename ConcreteType>
 class ProceduralRegion
@@ -21,8 +21,10 @@ namespace seq {
 
 std::unique_ptr<mlir::Pass> createSeqLowerToSVPass();
 std::unique_ptr<mlir::Pass>
-createSeqFIRRTLLowerToSVPass(bool disableRegRandomization = false);
+createSeqFIRRTLLowerToSVPass(bool disableRegRandomization = false,
+                             bool randomInitLoop = false);
 std::unique_ptr<mlir::Pass> createLowerSeqHLMemPass();
+std::unique_ptr<mlir::Pass> createInferClockEnablesPass();
 
 /// Generate the code for registering passes.
 #define GEN_PASS_REGISTRATION
@@ -24,6 +24,21 @@ namespace scheduling {
 /// name). Fails if the dependence graph contains cycles.
 LogicalResult scheduleASAP(Problem &prob);
 
+/// Solve the acyclic problem with shared operators using a list scheduler.
+/// Operations are scheduled in the order of their earliest start times, and
+/// operations with less mobility (i.e. on longer paths to the end of the
+/// schedule) take precedence when they compete for an operator type. The
+/// runtime is O(n log n) in the size of the dependence graph, which makes this
+/// suitable for large problems, or as a starting point for the exact
+/// schedulers. Fails if the dependence graph contains cycles.
+LogicalResult scheduleList(SharedOperatorsProblem &prob);
+
+/// Solve the acyclic, chaining-enabled problem using a list scheduler. This
+/// approach strictly adheres to the given maximum \p cycleTime. Fails if the
+/// dependence graph contains cycles, or individual operator types have delays
+/// larger than \p cycleTime.
+LogicalResult scheduleList(ChainingProblem &prob, float cycleTime);
+
 /// Solve the basic problem using linear programming and a handwritten
 /// implementation of the simplex algorithm. The objective is to minimize the
 /// start time of the given \p lastOp. Fails if the dependence graph contains
@@ -52,6 +67,15 @@ LogicalResult scheduleSimplex(SharedOperatorsProblem &prob, Operation *lastOp);
 /// does not include \p lastOp.
 LogicalResult scheduleSimplex(ModuloProblem &prob, Operation *lastOp);
 
+/// Solve the modulo scheduling problem using the heuristic above, but search
+/// for the smallest initiation interval by running \p numCandidates instances
+/// of it concurrently, each starting at a different II. The candidate IIs
+/// narrow down the range between the resource-constrained lower bound and the
+/// best II found so far in every round. Behaves like the serial variant if
+/// \p numCandidates is less than two.
+LogicalResult scheduleSimplex(ModuloProblem &prob, Operation *lastOp,
+                              unsigned numCandidates);
+
 /// Solve the acyclic, chaining-enabled problem using linear programming and a
 /// handwritten implementation of the simplex algorithm. This approach strictly
 /// adheres to the given maximum \p cycleTime. The objective is to minimize the
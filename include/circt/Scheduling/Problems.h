@@ -113,12 +113,54 @@ protected:
   using AuxDependenceMap =
       llvm::DenseMap<Operation *, llvm::SmallSetVector<Operation *, 4>>;
 
+  /// Assigns dense numbers to problem components, in the order in which they
+  /// are registered or first given a property.
+  template <typename KeyT>
+  class ComponentNumbering {
+  public:
+    Optional<unsigned> lookup(KeyT key) const {
+      auto it = numbers.find(key);
+      if (it == numbers.end())
+        return llvm::None;
+      return it->second;
+    }
+    unsigned getOrInsert(KeyT key) {
+      return numbers.try_emplace(key, numbers.size()).first->second;
+    }
+
+  private:
+    llvm::DenseMap<KeyT, unsigned> numbers;
+  };
+
+  /// Stores a property of numbered problem components in a flat vector, such
+  /// that all properties of a kind of component share a single hash table.
+  template <typename KeyT, typename T>
+  class ComponentProperty {
+  public:
+    Optional<T> lookup(const ComponentNumbering<KeyT> &numbering,
+                       KeyT key) const {
+      auto number = numbering.lookup(key);
+      if (!number || *number >= values.size())
+        return llvm::None;
+      return values[*number];
+    }
+    void set(ComponentNumbering<KeyT> &numbering, KeyT key, T value) {
+      unsigned number = numbering.getOrInsert(key);
+      if (number >= values.size())
+        values.resize(number + 1);
+      values[number] = value;
+    }
+
+  private:
+    SmallVector<Optional<T>> values;
+  };
+
   template <typename T>
-  using OperationProperty = llvm::DenseMap<Operation *, Optional<T>>;
+  using OperationProperty = ComponentProperty<Operation *, T>;
   template <typename T>
-  using DependenceProperty = llvm::DenseMap<Dependence, Optional<T>>;
+  using DependenceProperty = ComponentProperty<Dependence, T>;
   template <typename T>
-  using OperatorTypeProperty = llvm::DenseMap<OperatorType, Optional<T>>;
+  using OperatorTypeProperty = ComponentProperty<OperatorType, T>;
   template <typename T>
   using InstanceProperty = Optional<T>;
 
@@ -135,6 +177,13 @@ private:
   AuxDependenceMap auxDependences;
   OperatorTypeSet operatorTypes;
 
+protected:
+  // Numbering of the problem components, for the property storage
+  ComponentNumbering<Operation *> operationNumbering;
+  ComponentNumbering<Dependence> dependenceNumbering;
+  ComponentNumbering<OperatorType> operatorTypeNumbering;
+
+private:
   // Operation properties
   OperationProperty<OperatorType> linkedOperatorType;
   OperationProperty<unsigned> startTime;
@@ -147,7 +196,10 @@ private:
   //===--------------------------------------------------------------------===//
 public:
   /// Include \p op in this scheduling problem.
-  void insertOperation(Operation *op) { operations.insert(op); }
+  void insertOperation(Operation *op) {
+    operations.insert(op);
+    operationNumbering.getOrInsert(op);
+  }
 
   /// Include \p dep in the scheduling problem. Return failure if \p dep does
   /// not represent a valid def-use or auxiliary dependence between operations.
@@ -155,7 +207,10 @@ public:
   LogicalResult insertDependence(Dependence dep);
 
   /// Include \p opr in this scheduling problem.
-  void insertOperatorType(OperatorType opr) { operatorTypes.insert(opr); }
+  void insertOperatorType(OperatorType opr) {
+    operatorTypes.insert(opr);
+    operatorTypeNumbering.getOrInsert(opr);
+  }
 
   /// Retrieves the operator type identified by the client-specific \p name. The
   /// operator type is automatically registered in the scheduling problem.
@@ -198,25 +253,29 @@ public:
 public:
   /// The linked operator type provides the runtime characteristics for \p op.
   Optional<OperatorType> getLinkedOperatorType(Operation *op) {
-    return linkedOperatorType.lookup(op);
+    return linkedOperatorType.lookup(operationNumbering, op);
   }
   void setLinkedOperatorType(Operation *op, OperatorType opr) {
-    linkedOperatorType[op] = opr;
+    linkedOperatorType.set(operationNumbering, op, opr);
   }
 
   /// The latency is the number of cycles \p opr needs to compute its result.
   Optional<unsigned> getLatency(OperatorType opr) {
-    return latency.lookup(opr);
+    return latency.lookup(operatorTypeNumbering, opr);
+  }
+  void setLatency(OperatorType opr, unsigned val) {
+    latency.set(operatorTypeNumbering, opr, val);
   }
-  void setLatency(OperatorType opr, unsigned val) { latency[opr] = val; }
 
   /// Return the start time for \p op, as computed by the scheduler.
   /// These start times comprise the basic problem's solution, i.e. the
   /// *schedule*.
   Optional<unsigned> getStartTime(Operation *op) {
-    return startTime.lookup(op);
+    return startTime.lookup(operationNumbering, op);
+  }
+  void setStartTime(Operation *op, unsigned val) {
+    startTime.set(operationNumbering, op, val);
   }
-  void setStartTime(Operation *op, unsigned val) { startTime[op] = val; }
 
   //===--------------------------------------------------------------------===//
   // Properties as string key-value pairs (e.g. for DOT graphs)
@@ -268,9 +327,11 @@ public:
   /// The distance determines whether a dependence has to be satisfied in the
   /// same iteration (distance=0 or not set), or distance-many iterations later.
   Optional<unsigned> getDistance(Dependence dep) {
-    return distance.lookup(dep);
+    return distance.lookup(dependenceNumbering, dep);
+  }
+  void setDistance(Dependence dep, unsigned val) {
+    distance.set(dependenceNumbering, dep, val);
   }
-  void setDistance(Dependence dep, unsigned val) { distance[dep] = val; }
 
   /// The initiation interval (II) is the number of time steps between
   /// subsequent iterations, i.e. a new iteration is started every II time
@@ -317,29 +378,29 @@ public:
   /// either the result outputs (combinational operators) or the first internal
   /// register stage.
   Optional<float> getIncomingDelay(OperatorType opr) {
-    return incomingDelay.lookup(opr);
+    return incomingDelay.lookup(operatorTypeNumbering, opr);
   }
   void setIncomingDelay(OperatorType opr, float delay) {
-    incomingDelay[opr] = delay;
+    incomingDelay.set(operatorTypeNumbering, opr, delay);
   }
 
   /// The outgoing delay denotes the propagation time from either the operand
   /// inputs (combinational operators) or the last internal register stage to
   /// the result outputs.
   Optional<float> getOutgoingDelay(OperatorType opr) {
-    return outgoingDelay.lookup(opr);
+    return outgoingDelay.lookup(operatorTypeNumbering, opr);
   }
   void setOutgoingDelay(OperatorType opr, float delay) {
-    outgoingDelay[opr] = delay;
+    outgoingDelay.set(operatorTypeNumbering, opr, delay);
   }
 
   /// Computed by the scheduler, this start time is relative to the beginning of
   /// the cycle that \p op starts in.
   Optional<float> getStartTimeInCycle(Operation *op) {
-    return startTimeInCycle.lookup(op);
+    return startTimeInCycle.lookup(operationNumbering, op);
   }
   void setStartTimeInCycle(Operation *op, float time) {
-    startTimeInCycle[op] = time;
+    startTimeInCycle.set(operationNumbering, op, time);
   }
 
   virtual PropertyStringVector getProperties(Operation *op) override;
@@ -382,8 +443,12 @@ private:
 public:
   /// The limit is the maximum number of operations using \p opr that are
   /// allowed to start in the same time step.
-  Optional<unsigned> getLimit(OperatorType opr) { return limit.lookup(opr); }
-  void setLimit(OperatorType opr, unsigned val) { limit[opr] = val; }
+  Optional<unsigned> getLimit(OperatorType opr) {
+    return limit.lookup(operatorTypeNumbering, opr);
+  }
+  void setLimit(OperatorType opr, unsigned val) {
+    limit.set(operatorTypeNumbering, opr, val);
+  }
 
   virtual PropertyStringVector getProperties(OperatorType opr) override;
 
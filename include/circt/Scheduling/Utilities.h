@@ -47,6 +47,38 @@ computeChainBreakingDependences(ChainingProblem &prob, float cycleTime,
 /// Fails if the dependence graph contains cycles.
 LogicalResult computeStartTimesInCycle(ChainingProblem &prob);
 
+/// Maintains the start times in cycle of a scheduled \p prob, i.e. the
+/// accumulated delays of the longest combinational chains incoming at each
+/// operation. After the initial computation, a change to the (integer) start
+/// time of a single operation is propagated only to the operations reachable
+/// from it whose start times in cycle actually change.
+class StartTimesInCycleTracker {
+public:
+  explicit StartTimesInCycleTracker(ChainingProblem &prob) : prob(prob) {}
+
+  /// Fill in the start times in cycle of all operations in an ASAP fashion.
+  ///
+  /// Fails if the dependence graph contains cycles.
+  LogicalResult compute();
+
+  /// Update the start times in cycle after the start time of \p op changed.
+  /// Requires a successful invocation of `compute()` beforehand, and that the
+  /// dependence graph has not been modified since.
+  void update(Operation *op);
+
+private:
+  /// Derive \p op's start time in cycle from its predecessors.
+  float computeStartTimeInCycle(Operation *op);
+
+  ChainingProblem &prob;
+  /// The operations in a topological order w.r.t. the def-use dependences.
+  SmallVector<Operation *> order;
+  DenseMap<Operation *, unsigned> positions;
+  /// The destinations of the def-use dependences originating at each
+  /// operation.
+  DenseMap<Operation *, SmallVector<Operation *, 4>> successors;
+};
+
 /// Export \p prob as a DOT graph into \p fileName.
 void dumpAsDOT(Problem &prob, StringRef fileName);
 
@@ -122,6 +122,9 @@ struct LoweringOptions {
     SpillLargeTermsWithNamehints = 1, // Spill wires for expressions with
                                       // namehints if the term size is greater
                                       // than `wireSpillingNamehintTermLimit`.
+    SpillDeepExpressions = 2,         // Spill wires for expressions which are
+                                      // nested deeper than
+                                      // `wireSpillingDepthLimit`.
   };
 
   unsigned wireSpillingHeuristicSet = 0;
@@ -133,10 +136,19 @@ struct LoweringOptions {
   enum { DEFAULT_NAMEHINT_TERM_LIMIT = 3 };
   unsigned wireSpillingNamehintTermLimit = DEFAULT_NAMEHINT_TERM_LIMIT;
 
+  /// This is the maximum number of nested operators in an expression before
+  /// that expression spills a wire under `SpillDeepExpressions`.
+  enum { DEFAULT_DEPTH_LIMIT = 16 };
+  unsigned wireSpillingDepthLimit = DEFAULT_DEPTH_LIMIT;
+
   /// If true, every expression passed to an instance port is driven by a wire.
   /// Some lint tools dislike expressions being inlined into input ports so this
   /// option avoids such warnings.
   bool disallowExpressionInliningInPorts = false;
+
+  /// If true, `seq.hlmem` operations are lowered to instances of FIRRTL memory
+  /// generator modules, which are turned into behavioral simulation models.
+  bool lowerHLMemToSimModels = false;
 };
 } // namespace circt
 
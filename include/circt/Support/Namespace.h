@@ -19,6 +19,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Twine.h"
+#include "llvm/Support/Allocator.h"
 
 namespace circt {
 
@@ -29,10 +30,19 @@ namespace circt {
 class Namespace {
 public:
   Namespace() {}
-  Namespace(const Namespace &other) = default;
+  Namespace(const Namespace &other) { *this = other; }
   Namespace(Namespace &&other) : nextIndex(std::move(other.nextIndex)) {}
 
-  Namespace &operator=(const Namespace &other) = default;
+  /// Copy the names of another namespace.  The entries are re-inserted since
+  /// the bump allocator holding the names cannot be shared.
+  Namespace &operator=(const Namespace &other) {
+    if (this == &other)
+      return *this;
+    clear();
+    for (auto &entry : other.nextIndex)
+      nextIndex.insert({entry.getKey(), entry.getValue()});
+    return *this;
+  }
   Namespace &operator=(Namespace &&other) {
     nextIndex = std::move(other.nextIndex);
     return *this;
@@ -46,8 +56,8 @@ public:
         nextIndex.insert({strAttr.getValue(), 0});
   }
 
-  /// Empty the namespace.
-  void clear() { nextIndex.clear(); }
+  /// Empty the namespace, and release the memory used by its names.
+  void clear() { nextIndex = decltype(nextIndex)(); }
 
   /// Return a unique name, derived from the input `name`, and add the new name
   /// to the internal namespace.  There are two possible outcomes for the
@@ -68,9 +78,11 @@ public:
     if (tryName.empty())
       name.toVector(tryName); // toStringRef may leave tryName unfilled
 
-    // Indexes less than nextIndex[tryName] are lready used, so skip them.
+    // Indexes less than nextIndex[tryName] are already used, so skip them.
     // Indexes larger than nextIndex[tryName] may be used in another name.
-    size_t &i = nextIndex[tryName];
+    // This is the entry we just failed to insert, and entries never move, so
+    // hold on to it rather than looking it up again.
+    size_t &i = inserted.first->second;
     tryName.push_back('_');
     size_t baseLength = tryName.size();
     do {
@@ -127,8 +139,9 @@ public:
 protected:
   // The "next index" that will be tried when trying to unique a string within a
   // namespace.  It follows that all values less than the "next index" value are
-  // already used.
-  llvm::StringMap<size_t> nextIndex;
+  // already used.  Namespaces only ever grow until they are cleared, so the
+  // names are bump allocated rather than each getting a heap allocation.
+  llvm::StringMap<size_t, llvm::BumpPtrAllocator> nextIndex;
 };
 
 } // namespace circt
@@ -0,0 +1,65 @@
+//===- PatternProfiler.h - Rewrite pattern profiling ------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a profiler which counts how often rewrite patterns are
+// tried and succeed, and how much time is spent in them.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef CIRCT_SUPPORT_PATTERNPROFILER_H
+#define CIRCT_SUPPORT_PATTERNPROFILER_H
+
+#include "mlir/IR/PatternMatch.h"
+#include "llvm/ADT/StringMap.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace circt {
+
+/// Collects the number of match attempts, successful rewrites and the time
+/// spent per rewrite pattern. Patterns record into the profiler once they have
+/// been instrumented, which may happen for any number of pattern sets that are
+/// applied concurrently.
+class PatternProfiler {
+public:
+  /// The statistics of a single pattern.
+  struct Entry {
+    std::string pattern;
+    std::string rootName;
+    std::atomic<uint64_t> numAttempts{0};
+    std::atomic<uint64_t> numSuccesses{0};
+    std::atomic<uint64_t> nanoseconds{0};
+  };
+
+  /// Replace every native pattern in `patterns` with one that forwards to it
+  /// and records its invocations in this profiler. Patterns are identified by
+  /// their debug name and root operation, such that instrumenting the same
+  /// patterns again accumulates into the same entries.
+  void instrument(mlir::RewritePatternSet &patterns);
+
+  /// Print the statistics of all patterns that have been tried, sorted by
+  /// decreasing time spent in them.
+  void print(llvm::raw_ostream &os);
+
+  /// Return true if no instrumented pattern has been tried yet.
+  bool empty();
+
+  /// Return the profiler shared by the whole process.
+  static PatternProfiler &getGlobal();
+
+private:
+  Entry &getEntry(llvm::StringRef pattern, llvm::StringRef rootName);
+
+  std::mutex mutex;
+  llvm::StringMap<std::unique_ptr<Entry>> entries;
+};
+
+} // namespace circt
+
+#endif // CIRCT_SUPPORT_PATTERNPROFILER_H
@@ -26,7 +26,6 @@
 #include "llvm/Support/SaveAndRestore.h"
 
 #include <cstdint>
-#include <deque>
 #include <limits>
 
 namespace circt {
@@ -211,6 +210,61 @@ public:
   static constexpr uint32_t kInfinity = (1U << 15) - 1;
 
 private:
+  /// A double-ended queue over a single power-of-two sized circular buffer.
+  /// Unlike std::deque, which allocates and frees a chunk every few hundred
+  /// elements as the queue slides forward, this only allocates when the number
+  /// of live elements exceeds anything seen before.  The printer's lookahead
+  /// is bounded by the line width, so steady-state use does not allocate.
+  template <typename T>
+  class RingBuffer {
+  public:
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    T &operator[](size_t i) {
+      assert(i < count && "index out of range");
+      return storage[(head + i) & (storage.size() - 1)];
+    }
+    T &front() { return (*this)[0]; }
+    T &back() { return (*this)[count - 1]; }
+
+    void push_back(const T &value) {
+      if (count == storage.size())
+        grow(value);
+      storage[(head + count) & (storage.size() - 1)] = value;
+      ++count;
+    }
+    void pop_front() {
+      assert(!empty());
+      head = (head + 1) & (storage.size() - 1);
+      --count;
+    }
+    void pop_back() {
+      assert(!empty());
+      --count;
+    }
+    void clear() { head = count = 0; }
+
+  private:
+    /// Double the capacity, unwrapping the live elements to the start.  The
+    /// new slots are filled with `fill`, since T need not be default
+    /// constructible.
+    void grow(const T &fill) {
+      size_t newSize = std::max<size_t>(storage.size() * 2, 16);
+      SmallVector<T, 0> newStorage;
+      newStorage.reserve(newSize);
+      for (size_t i = 0; i != count; ++i)
+        newStorage.push_back((*this)[i]);
+      newStorage.resize(newSize, fill);
+      storage = std::move(newStorage);
+      head = 0;
+    }
+
+    SmallVector<T, 0> storage;
+    size_t head = 0;
+    size_t count = 0;
+  };
+
   /// Format token with tracked size.
   struct FormattedToken {
     Token token;  /// underlying token
@@ -260,12 +314,12 @@ private:
   int32_t rightTotal;
 
   /// Unprinted tokens, combination of 'token' and 'size' in Oppen.
-  std::deque<FormattedToken> tokens;
+  RingBuffer<FormattedToken> tokens;
   /// index of first token, for resolving scanStack entries.
   uint32_t tokenOffset = 0;
 
   /// Stack of begin/break tokens, adjust by tokenOffset to index into tokens.
-  std::deque<uint32_t> scanStack;
+  RingBuffer<uint32_t> scanStack;
 
   /// Stack of printing contexts (indentation + breaking behavior).
   SmallVector<PrintEntry> printStack;
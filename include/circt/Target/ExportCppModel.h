@@ -0,0 +1,34 @@
+//===- ExportCppModel.h - Cycle-based C++ model emitter ---------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Defines the interface to the cycle-based C++ model emitter.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef CIRCT_TARGET_EXPORTCPPMODEL_H
+#define CIRCT_TARGET_EXPORTCPPMODEL_H
+
+#include "circt/Support/LLVM.h"
+
+namespace circt {
+namespace ExportCppModel {
+
+/// Emits the flattened HW module 'top' of 'module' as a cycle-based C++ model.
+/// The model is a struct which holds the ports and registers of the module as
+/// members. Its `eval` method computes the combinational logic in topological
+/// order, and its `step` method advances the registers by one clock cycle. If
+/// 'top' is empty, 'module' has to contain a single HW module.
+LogicalResult exportCppModel(ModuleOp module, llvm::raw_ostream &os,
+                             StringRef top = {});
+
+void registerExportCppModelTranslation();
+
+} // namespace ExportCppModel
+} // namespace circt
+
+#endif // CIRCT_TARGET_EXPORTCPPMODEL_H
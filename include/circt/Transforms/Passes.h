@@ -15,6 +15,7 @@
 
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include <limits>
 
 namespace circt {
@@ -25,6 +26,10 @@ namespace circt {
 
 std::unique_ptr<mlir::Pass> createFlattenMemRefPass();
 std::unique_ptr<mlir::Pass> createFlattenMemRefCallsPass();
+std::unique_ptr<mlir::Pass> createPartitionMemRefPass();
+std::unique_ptr<mlir::Pass> createProfileCanonicalizePass();
+std::unique_ptr<mlir::Pass>
+createProfileCanonicalizePass(const mlir::GreedyRewriteConfig &config);
 std::unique_ptr<mlir::Pass> createStripDebugInfoWithPredPass(
     const std::function<bool(mlir::Location)> &pred);
 
@@ -173,6 +173,25 @@ with Context() as ctx, Location.unknown():
       # CHECK: comb.mux %[[BIT]], %[[CONST]], %[[CONST]]
       comb.MuxOp.create(bit.result, const.result, const.result)
 
+      # CHECK: %[[ADD:.+]] = comb.add %[[CONST]], %[[CONST]] : i32
+      # CHECK: %[[XOR:.+]] = comb.xor %[[ADD]], %[[CONST]] : i32
+      # CHECK: comb.concat %[[XOR]], %[[BIT]] : i32, i1
+      graph = comb.build_graph([const.result, bit.result],
+                               ["comb.add", "comb.xor", "comb.concat"],
+                               opcodes=[0, 1, 2],
+                               num_operands=[2, 2, 2],
+                               operands=[0, 0, 2, 0, 3, 1],
+                               outputs=[2])
+      assert len(graph) == 1
+
     hw.HWModuleOp(name="test", body_builder=build)
 
   print(m)
+
+  # CHECK: invalid graph
+  with InsertionPoint(m.body):
+    const = hw.ConstantOp(IntegerAttr.get(i32, 1))
+    try:
+      comb.build_graph([const.result], ["comb.icmp"], [0], [2], [0, 0])
+    except ValueError as e:
+      print(e)
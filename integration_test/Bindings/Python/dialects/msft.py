@@ -239,6 +239,19 @@ with ir.Context() as ctx, ir.Location.unknown():
   assert should_be_none is None
   assert pdb.get_instance_at(new_location) == old_loc_repl
 
+  bulk_loc0 = msft.PhysLocationAttr.get(msft.M20K, x=0, y=1, num=0)
+  bulk_loc1 = msft.PhysLocationAttr.get(msft.M20K, x=0, y=1, num=1)
+  bulk_ops = pdb.place_all([(dyn_inst, bulk_loc0, ""),
+                            (dyn_inst, bulk_loc1, "|bulk"),
+                            (dyn_inst, bulk_loc0, "")], ir.Location.current)
+  assert len(bulk_ops) == 3
+  assert bulk_ops[2] is None
+  assert pdb.get_instance_at(bulk_loc0) == bulk_ops[0]
+  assert pdb.get_instance_at(bulk_loc1) == bulk_ops[1]
+  pdb.remove_placement(bulk_ops[0])
+  pdb.remove_placement(bulk_ops[1])
+  assert pdb.get_instance_at(bulk_loc0) is None
+
   print("=== Errors:", file=sys.stderr)
   # TODO: Python's sys.stderr doesn't seem to be shared with C++ errors.
   # See https://github.com/llvm/circt/issues/1983 for more info.
@@ -98,6 +98,13 @@ with Context() as ctx, Location.unknown():
                             a=inst1.a,
                             parameters={"BANKS": IntegerAttr.get(i32, 2)})
 
+      # CHECK: hw.instance "bulk0" @MyWidget(my_input: %[[INST1_RESULT]]: i32)
+      # CHECK: hw.instance "bulk1" @MyWidget(my_input: %[[INST5_RESULT]]: i32)
+      bulk = hw.create_instances(op.operation, ["bulk0", "bulk1"],
+                                 [inst1.a, inst5.my_output])
+      # CHECK: 2
+      print(len(bulk))
+
     instance_builder_tests = hw.HWModuleOp(name="instance_builder_tests",
                                            body_builder=instance_builder_body)
 
@@ -7,8 +7,11 @@ from circt.dialects import hw
 
 from mlir.ir import (Context, Location, InsertionPoint, IntegerType, Module)
 
+from mlir.passmanager import PassManager
+
 import io
 import os
+import threading
 
 with Context() as ctx, Location.unknown():
   circt.register_dialects(ctx)
@@ -35,3 +38,17 @@ with Context() as ctx, Location.unknown():
   # DIRECTORY:   output out);
   # DIRECTORY:   assign out = 1'h1;
   # DIRECTORY: endmodule
+
+  # The export releases the GIL, and its output callback reacquires it, also
+  # when running on another thread.
+  buffer = io.StringIO()
+  worker = threading.Thread(target=circt.export_verilog, args=(m, buffer))
+  worker.start()
+  worker.join()
+  print(buffer.getvalue())
+  # INMEMORY: module test(
+  # INMEMORY:   assign out = 1'h1;
+
+  circt.run_pass_manager(PassManager.parse("canonicalize"), m)
+  # INMEMORY: hw.module @test
+  print(m)
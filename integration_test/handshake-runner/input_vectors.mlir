@@ -0,0 +1,20 @@
+// RUN: echo "3 4" > %t.vectors
+// RUN: echo "# a comment" >> %t.vectors
+// RUN: echo "10 -2" >> %t.vectors
+// RUN: handshake-runner %s --input-vectors=%t.vectors | FileCheck %s
+// RUN: handshake-runner %s --input-vectors=%t.vectors --output-format=csv --parallel | FileCheck %s --check-prefix=CSV
+// RUN: circt-opt -lower-std-to-handshake %s | handshake-runner --input-vectors=%t.vectors | FileCheck %s
+
+// CHECK: 7 12
+// CHECK-NEXT: 8 -20
+
+// CSV: 0,7,12
+// CSV-NEXT: 1,8,-20
+
+module {
+  func.func @main(%a: i32, %b: i32) -> (i32, i32) {
+    %0 = arith.addi %a, %b : i32
+    %1 = arith.muli %a, %b : i32
+    return %0, %1 : i32, i32
+  }
+}
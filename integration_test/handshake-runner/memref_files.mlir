@@ -0,0 +1,15 @@
+// RUN: handshake-runner %s 1,2,3,4 --dump-memrefs=%t. | FileCheck %s --check-prefix=DUMP
+// RUN: handshake-runner %s @%t.0.bin | FileCheck %s --check-prefix=LOAD
+// DUMP: {{^}}2 {{$}}
+// LOAD: 7 1,12,3,4
+
+module {
+  func.func @main(%m: memref<4xi32>) -> i32 {
+    %c1 = arith.constant 1 : index
+    %c5 = arith.constant 5 : i32
+    %0 = memref.load %m[%c1] : memref<4xi32>
+    %1 = arith.addi %0, %c5 : i32
+    memref.store %1, %m[%c1] : memref<4xi32>
+    return %0 : i32
+  }
+}
@@ -0,0 +1,15 @@
+// RUN: handshake-runner %s -7 2 5.5 2.0 | FileCheck %s
+// CHECK: -3 -128 1 3.5{{0*}}e+00
+
+module {
+  func.func @main(%a: i8, %b: i8, %x: f64, %y: f64) -> (i8, i8, i8, f64) {
+    %0 = arith.divsi %a, %b : i8
+    %c127 = arith.constant 127 : i8
+    %c1 = arith.constant 1 : i8
+    %1 = arith.addi %c127, %c1 : i8
+    %2 = arith.cmpi slt, %a, %b : i8
+    %3 = arith.extui %2 : i1 to i8
+    %4 = arith.subf %x, %y : f64
+    return %0, %1, %3, %4 : i8, i8, i8, f64
+  }
+}
@@ -0,0 +1,23 @@
+// RUN: circt-opt -lower-std-to-handshake %s | handshake-runner --profile=%t.json 3 4 | FileCheck %s
+// RUN: cat %t.json | FileCheck %s --check-prefix=PROFILE
+// CHECK: 18
+
+// PROFILE: "time":
+// PROFILE: "operations": [
+// PROFILE: "name": "arith.muli"
+// PROFILE-NEXT: "location":
+// PROFILE-NEXT: "firings": 1
+// PROFILE: "channels": [
+// PROFILE: "tokens":
+// PROFILE-NEXT: "waitTime":
+// PROFILE-NEXT: "maxWaitTime":
+// PROFILE-NEXT: "averageOccupancy":
+
+module {
+  func.func @main(%a: i32, %b: i32) -> i32 {
+    %0 = arith.muli %a, %b : i32
+    %1 = arith.addi %0, %a : i32
+    %2 = arith.addi %1, %a : i32
+    return %2 : i32
+  }
+}
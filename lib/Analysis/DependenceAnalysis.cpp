@@ -20,33 +20,51 @@
 #include "mlir/Dialect/Affine/LoopUtils.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Threading.h"
 
 using namespace mlir;
 using namespace circt::analysis;
 
+namespace {
+/// The properties of a memory operation that are needed to check it against
+/// all other memory operations, computed once per operation.
+struct MemoryOpInfo {
+  explicit MemoryOpInfo(Operation *op) : op(op), access(op) {
+    getLoopIVs(*op, &enclosingLoops);
+    getEnclosingAffineOps(*op, &enclosingAffineOps);
+  }
+
+  Operation *op;
+  MemRefAccess access;
+  SmallVector<AffineForOp> enclosingLoops;
+  SmallVector<Operation *> enclosingAffineOps;
+};
+} // namespace
+
+using DependenceList = SmallVector<std::pair<Operation *, MemoryDependence>>;
+
 /// Helper to iterate through memory operation pairs and check for dependences
-/// at a given loop nesting depth.
-static void checkMemrefDependence(SmallVectorImpl<Operation *> &memoryOps,
-                                  unsigned depth,
-                                  MemoryDependenceResult &results) {
-  for (auto *source : memoryOps) {
-    for (auto *destination : memoryOps) {
-      if (source == destination)
+/// at a given loop nesting depth. Only operations accessing the same memref
+/// can depend on each other, so \p memoryOps is one bucket of operations with
+/// a common memref. The dependences are appended to \p results as pairs of
+/// the destination operation and the dependence.
+static void checkMemrefDependence(ArrayRef<MemoryOpInfo> memoryOps,
+                                  unsigned depth, DependenceList &results) {
+  for (auto &source : memoryOps) {
+    for (auto &destination : memoryOps) {
+      if (source.op == destination.op)
         continue;
-
-      // Initialize the dependence list for this destination.
-      if (results.count(destination) == 0)
-        results[destination] = SmallVector<MemoryDependence>();
+      auto &src = source.access;
+      auto &dst = destination.access;
 
       // Look for inter-iteration dependences on the same memory location.
-      MemRefAccess src(source);
-      MemRefAccess dst(destination);
       FlatAffineValueConstraints dependenceConstraints;
       SmallVector<DependenceComponent, 2> depComps;
       DependenceResult result = checkMemrefAccessDependence(
           src, dst, depth, &dependenceConstraints, &depComps, true);
 
-      results[destination].emplace_back(source, result.value, depComps);
+      results.emplace_back(destination.op,
+                           MemoryDependence(source.op, result.value, depComps));
 
       // Also consider intra-iteration dependences on the same memory location.
       // This currently does not consider aliasing.
@@ -55,17 +73,14 @@ static void checkMemrefDependence(SmallVectorImpl<Operation *> &memoryOps,
 
       // Collect surrounding loops to use in dependence components. Only proceed
       // if we are in the innermost loop.
-      SmallVector<AffineForOp> enclosingLoops;
-      getLoopIVs(*destination, &enclosingLoops);
+      auto &enclosingLoops = destination.enclosingLoops;
       if (enclosingLoops.size() != depth)
         continue;
 
       // Look for the common parent that src and dst share. If there is none,
       // there is nothing more to do.
-      SmallVector<Operation *> srcParents;
-      getEnclosingAffineOps(*source, &srcParents);
-      SmallVector<Operation *> dstParents;
-      getEnclosingAffineOps(*destination, &dstParents);
+      auto &srcParents = source.enclosingAffineOps;
+      auto &dstParents = destination.enclosingAffineOps;
 
       Operation *commonParent = nullptr;
       for (auto *srcParent : llvm::reverse(srcParents)) {
@@ -94,9 +109,10 @@ static void checkMemrefDependence(SmallVectorImpl<Operation *> &memoryOps,
         Block &commonBlock = commonRegion.front();
 
         // Find the src and dst ancestor in the common block, if any.
-        Operation *srcOrAncestor = commonBlock.findAncestorOpInBlock(*source);
+        Operation *srcOrAncestor =
+            commonBlock.findAncestorOpInBlock(*source.op);
         Operation *dstOrAncestor =
-            commonBlock.findAncestorOpInBlock(*destination);
+            commonBlock.findAncestorOpInBlock(*destination.op);
         if (srcOrAncestor == nullptr || dstOrAncestor == nullptr)
           continue;
 
@@ -112,8 +128,10 @@ static void checkMemrefDependence(SmallVectorImpl<Operation *> &memoryOps,
             intraDeps.push_back(depComp);
           }
 
-          results[destination].emplace_back(
-              source, DependenceResult::HasDependence, intraDeps);
+          results.emplace_back(
+              destination.op,
+              MemoryDependence(source.op, DependenceResult::HasDependence,
+                               intraDeps));
         }
       }
     }
@@ -131,16 +149,33 @@ circt::analysis::MemoryDependenceAnalysis::MemoryDependenceAnalysis(
   std::vector<SmallVector<AffineForOp, 2>> depthToLoops;
   mlir::gatherLoops(funcOp, depthToLoops);
 
-  // Collect load and store operations to check.
-  SmallVector<Operation *> memoryOps;
+  // Collect load and store operations to check, bucketed by the memref they
+  // access.
+  SmallVector<SmallVector<MemoryOpInfo>> buckets;
+  DenseMap<Value, unsigned> bucketIndices;
   funcOp.walk([&](Operation *op) {
-    if (isa<AffineReadOpInterface, AffineWriteOpInterface>(op))
-      memoryOps.push_back(op);
+    if (!isa<AffineReadOpInterface, AffineWriteOpInterface>(op))
+      return;
+    // Every memory operation has a (possibly empty) list of dependences.
+    results[op];
+    MemoryOpInfo info(op);
+    auto it = bucketIndices.try_emplace(info.access.memref, buckets.size());
+    if (it.second)
+      buckets.emplace_back();
+    buckets[it.first->second].push_back(std::move(info));
+  });
+
+  // For each depth, check memref accesses. The buckets are independent of each
+  // other, so they are analyzed concurrently.
+  SmallVector<DependenceList> bucketResults(buckets.size());
+  mlir::parallelFor(op->getContext(), 0, buckets.size(), [&](size_t i) {
+    for (unsigned depth = 1, e = depthToLoops.size(); depth <= e; ++depth)
+      checkMemrefDependence(buckets[i], depth, bucketResults[i]);
   });
 
-  // For each depth, check memref accesses.
-  for (unsigned depth = 1, e = depthToLoops.size(); depth <= e; ++depth)
-    checkMemrefDependence(memoryOps, depth, results);
+  for (auto &bucketResult : bucketResults)
+    for (auto &result : bucketResult)
+      results[result.first].push_back(std::move(result.second));
 }
 
 /// Returns the dependences, if any, that the given Operation depends on.
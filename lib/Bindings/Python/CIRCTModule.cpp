@@ -85,17 +85,39 @@ PYBIND11_MODULE(_circt, m) {
       },
       "Register CIRCT dialects on a PyMlirContext.");
 
+  // The long-running entry points below release the GIL, such that other
+  // Python threads make progress in the meantime. Callbacks into Python have to
+  // reacquire it.
   m.def("export_verilog", [](MlirModule mod, py::object fileObject) {
     circt::python::PyFileAccumulator accum(fileObject, false);
-    py::gil_scoped_release();
+    py::gil_scoped_release release;
     mlirExportVerilog(mod, accum.getCallback(), accum.getUserData());
   });
 
   m.def("export_split_verilog", [](MlirModule mod, std::string directory) {
     auto cDirectory = mlirStringRefCreateFromCString(directory.c_str());
+    py::gil_scoped_release release;
     mlirExportSplitVerilog(mod, cDirectory);
   });
 
+  m.def(
+      "run_pass_manager",
+      [](MlirPassManager pm, MlirModule mod) {
+        MlirLogicalResult result;
+        {
+          py::gil_scoped_release release;
+          result = mlirPassManagerRun(pm, mod);
+        }
+        if (mlirLogicalResultIsFailure(result))
+          throw std::runtime_error("Failure while executing pass pipeline.");
+      },
+      "Run the pass manager 'pm' on the module 'mod' without holding the GIL. "
+      "Unlike PassManager.run, this lets other Python threads run in the "
+      "meantime.",
+      py::arg("pm"), py::arg("mod"));
+
+  py::module comb = m.def_submodule("_comb", "Comb API");
+  circt::python::populateDialectCombSubmodule(comb);
   py::module esi = m.def_submodule("_esi", "ESI API");
   circt::python::populateDialectESISubmodule(esi);
   py::module msft = m.def_submodule("_msft", "MSFT API");
@@ -0,0 +1,84 @@
+//===- CombModule.cpp - Comb API pybind module ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "DialectModules.h"
+
+#include "circt-c/Dialect/Comb.h"
+
+#include "mlir/Bindings/Python/PybindAdaptors.h"
+
+#include "PybindUtils.h"
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+namespace py = pybind11;
+
+using namespace circt;
+using namespace mlir::python::adaptors;
+
+/// Populate the comb python module.
+void circt::python::populateDialectCombSubmodule(py::module &m) {
+  m.doc() = "Comb dialect Python native extension";
+
+  m.def(
+      "build_graph",
+      [](std::vector<MlirValue> inputs, std::vector<std::string> opNames,
+         py::object opcodes, py::object numOperands, py::object operands,
+         py::object outputs, MlirLocation loc, py::object ip) {
+        auto [block, insertBefore] = getInsertionPoint(ip);
+        std::vector<MlirStringRef> cOpNames;
+        cOpNames.reserve(opNames.size());
+        for (auto &name : opNames)
+          cOpNames.push_back(mlirStringRefCreate(name.data(), name.size()));
+
+        PyInt32Array cOpcodes(opcodes), cNumOperands(numOperands),
+            cOperands(operands);
+        size_t numNodes = cOpcodes.get().size();
+        if (cNumOperands.get().size() != numNodes)
+          throw py::value_error("expected an operand count for every node");
+        int64_t totalOperands = 0;
+        for (auto count : cNumOperands.get())
+          totalOperands += count;
+        if (totalOperands != static_cast<int64_t>(cOperands.get().size()))
+          throw py::value_error("operand counts don't match the operands");
+
+        std::vector<MlirOperation> ops(numNodes);
+        if (mlirLogicalResultIsFailure(combBuildGraph(
+                block, insertBefore, loc, cOpNames.size(), cOpNames.data(),
+                inputs.size(), inputs.data(), numNodes, cOpcodes.get().data(),
+                cNumOperands.get().data(), cOperands.get().data(),
+                ops.data())))
+          throw py::value_error("invalid graph, see diagnostics");
+
+        std::vector<MlirValue> results;
+        if (outputs.is_none()) {
+          results.reserve(numNodes);
+          for (auto op : ops)
+            results.push_back(mlirOperationGetResult(op, 0));
+          return results;
+        }
+        PyInt32Array cOutputs(outputs);
+        results.reserve(cOutputs.get().size());
+        for (auto node : cOutputs.get()) {
+          if (node < 0 || static_cast<size_t>(node) >= numNodes)
+            throw py::index_error("output node out of range");
+          results.push_back(mlirOperationGetResult(ops[node], 0));
+        }
+        return results;
+      },
+      "Build a graph of Comb operations at the insertion point 'ip', or the "
+      "current one. Node 'i' is an operation named 'op_names[opcodes[i]]' "
+      "whose operands are the next 'num_operands[i]' entries of 'operands'. "
+      "Operand indices below 'len(inputs)' refer to 'inputs', the index "
+      "'len(inputs) + j' to the result of node 'j'. The integer arrays may be "
+      "numpy arrays of int32, which are used without a copy. Returns the "
+      "results of the 'outputs' nodes, or of all nodes.",
+      py::arg("inputs"), py::arg("op_names"), py::arg("opcodes"),
+      py::arg("num_operands"), py::arg("operands"),
+      py::arg("outputs") = py::none(), py::arg("loc") = py::none(),
+      py::arg("ip") = py::none());
+}
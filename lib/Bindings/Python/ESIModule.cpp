@@ -32,9 +32,11 @@ namespace py = pybind11;
 llvm::DenseMap<std::string *, PyObject *> serviceGenFuncLookup;
 static MlirLogicalResult serviceGenFunc(MlirOperation reqOp,
                                         MlirOperation declOp, void *userData) {
+  // Service generators run within pass pipelines, which may be executed
+  // without holding the GIL.
+  py::gil_scoped_acquire gil;
   std::string *name = static_cast<std::string *>(userData);
   py::handle genFunc(serviceGenFuncLookup[name]);
-  py::gil_scoped_acquire();
   py::object rc = genFunc(reqOp);
   return rc.cast<bool>() ? mlirLogicalResultSuccess()
                          : mlirLogicalResultFailure();
@@ -31,6 +31,28 @@ void circt::python::populateDialectHWSubmodule(py::module &m) {
 
   m.def("get_bitwidth", &hwGetBitWidth);
 
+  m.def(
+      "create_instances",
+      [](MlirOperation module, std::vector<std::string> names,
+         std::vector<MlirValue> inputs, MlirLocation loc, py::object ip) {
+        auto [block, insertBefore] = circt::python::getInsertionPoint(ip);
+        std::vector<MlirStringRef> cNames;
+        cNames.reserve(names.size());
+        for (auto &name : names)
+          cNames.push_back(mlirStringRefCreate(name.data(), name.size()));
+        std::vector<MlirOperation> instances(names.size());
+        if (mlirLogicalResultIsFailure(hwInstanceOpCreateBatch(
+                block, insertBefore, loc, module, cNames.size(), cNames.data(),
+                inputs.size(), inputs.data(), instances.data())))
+          throw py::value_error("invalid instances, see diagnostics");
+        return instances;
+      },
+      "Create an instance of 'module' for every name in 'names' at the "
+      "insertion point 'ip', or the current one. The inputs of all instances "
+      "are passed as one flat list.",
+      py::arg("module"), py::arg("names"), py::arg("inputs"),
+      py::arg("loc") = py::none(), py::arg("ip") = py::none());
+
   mlir_type_subclass(m, "InOutType", hwTypeIsAInOut)
       .def_classmethod("get",
                        [](py::object cls, MlirType innerType) {
@@ -59,6 +59,27 @@ public:
     auto cSubpath = mlirStringRefCreate(subpath.c_str(), subpath.size());
     return circtMSFTPlacementDBPlace(db, instOp, loc, cSubpath, srcLoc);
   }
+  std::vector<MlirOperation> placeAll(
+      const std::vector<std::tuple<MlirOperation, MlirAttribute, std::string>>
+          &placements,
+      MlirLocation srcLoc) {
+    std::vector<MlirOperation> insts;
+    std::vector<MlirAttribute> locs;
+    std::vector<MlirStringRef> subpaths;
+    insts.reserve(placements.size());
+    locs.reserve(placements.size());
+    subpaths.reserve(placements.size());
+    for (auto &[inst, loc, subpath] : placements) {
+      insts.push_back(inst);
+      locs.push_back(loc);
+      subpaths.push_back(mlirStringRefCreate(subpath.c_str(), subpath.size()));
+    }
+    std::vector<MlirOperation> results(placements.size());
+    circtMSFTPlacementDBPlaceAll(db, placements.size(), insts.data(),
+                                 locs.data(), subpaths.data(), srcLoc,
+                                 results.data());
+    return results;
+  }
   void removePlacement(MlirOperation locOp) {
     circtMSFTPlacementDBRemovePlacement(db, locOp);
   }
@@ -253,6 +274,11 @@ void circt::python::populateDialectMSFTSubmodule(py::module &m) {
       .def("place", &PlacementDB::place, "Place a dynamic instance.",
            py::arg("dyn_inst"), py::arg("location"), py::arg("subpath"),
            py::arg("src_location") = py::none())
+      .def("place_all", &PlacementDB::placeAll,
+           "Place many dynamic instances at once. Takes a list of "
+           "(dyn_inst, location, subpath) tuples and returns the placement "
+           "op of each, or None if it failed.",
+           py::arg("placements"), py::arg("src_location") = py::none())
       .def("remove_placement", &PlacementDB::removePlacement,
            "Remove a placement.", py::arg("location"))
       .def("move_placement", &PlacementDB::movePlacement,
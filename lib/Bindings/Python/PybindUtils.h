@@ -14,6 +14,8 @@
 #define CIRCT_BINDINGS_PYTHON_PYBINDUTILS_H
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <pybind11/pybind11.h>
 #include <pybind11/pytypes.h>
@@ -22,6 +24,7 @@
 #include "mlir-c/Bindings/Python/Interop.h"
 #include "mlir-c/IR.h"
 #include "mlir-c/Pass.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
 
 namespace py = pybind11;
@@ -41,7 +44,7 @@ public:
 
   MlirStringCallback getCallback() {
     return [](MlirStringRef part, void *userData) {
-      pybind11::gil_scoped_acquire();
+      pybind11::gil_scoped_acquire gil;
       PyFileAccumulator *accum = static_cast<PyFileAccumulator *>(userData);
       if (accum->binary) {
         // Note: Still has to copy and not avoidable with this API.
@@ -59,6 +62,73 @@ private:
   pybind11::object pyWriteFunction;
   bool binary;
 };
+
+/// A read-only view of a Python sequence of 32-bit integers. One-dimensional
+/// contiguous buffers of 32-bit integers, e.g. numpy arrays of `int32`, are
+/// used in place, any other sequence is copied.
+class PyInt32Array {
+public:
+  PyInt32Array(pybind11::handle array) {
+    if (PyObject_CheckBuffer(array.ptr())) {
+      auto info = pybind11::reinterpret_borrow<pybind11::buffer>(array)
+                      .request();
+      if (info.ndim == 1 && info.itemsize == sizeof(int32_t) &&
+          !info.format.empty() && info.format.back() == 'i' &&
+          (info.size < 2 || info.strides[0] == sizeof(int32_t))) {
+        data = llvm::makeArrayRef(static_cast<const int32_t *>(info.ptr),
+                                  info.size);
+        buffer = std::move(info);
+        return;
+      }
+    }
+    for (auto element : array)
+      storage.push_back(element.cast<int32_t>());
+    data = storage;
+  }
+
+  llvm::ArrayRef<int32_t> get() const { return data; }
+
+private:
+  llvm::ArrayRef<int32_t> data;
+  pybind11::buffer_info buffer;
+  std::vector<int32_t> storage;
+};
+
+/// Returns the block and the operation before which operations are inserted
+/// at the insertion point 'ip', or at the current insertion point if 'ip' is
+/// None. The operation is null if operations are appended to the block.
+inline std::pair<MlirBlock, MlirOperation>
+getInsertionPoint(pybind11::object ip) {
+  if (ip.is_none())
+    ip = pybind11::module::import("mlir.ir")
+             .attr("InsertionPoint")
+             .attr("current");
+  pybind11::object refOp = ip.attr("ref_operation");
+  if (!refOp.is_none()) {
+    auto op = refOp.attr("operation").cast<MlirOperation>();
+    return {mlirOperationGetBlock(op), op};
+  }
+
+  // Python blocks don't expose their C API object, hence look the block up by
+  // its position within its parent operation.
+  pybind11::object block = ip.attr("block");
+  pybind11::object owner = block.attr("owner");
+  if (owner.is_none())
+    throw pybind11::value_error("cannot insert into a detached block");
+  owner = owner.attr("operation");
+  auto cOwner = owner.cast<MlirOperation>();
+  intptr_t regionIdx = 0;
+  for (auto region : owner.attr("regions")) {
+    MlirBlock cBlock =
+        mlirRegionGetFirstBlock(mlirOperationGetRegion(cOwner, regionIdx++));
+    for (auto candidate : region.attr("blocks")) {
+      if (candidate.equal(block))
+        return {cBlock, MlirOperation{nullptr}};
+      cBlock = mlirBlockGetNextInRegion(cBlock);
+    }
+  }
+  throw pybind11::value_error("insertion block not found in its parent");
+}
 } // namespace python
 } // namespace circt
 
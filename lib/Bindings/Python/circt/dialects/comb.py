@@ -3,6 +3,7 @@
 #  SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 from ._comb_ops_gen import *
+from mlir._mlir_libs._circt._comb import *
 
 from circt.support import NamedValueOpView
 
@@ -4,9 +4,109 @@
 
 #include "circt-c/Dialect/Comb.h"
 #include "circt/Dialect/Comb/CombDialect.h"
+#include "circt/Dialect/Comb/CombOps.h"
 #include "mlir/CAPI/IR.h"
 #include "mlir/CAPI/Registration.h"
 #include "mlir/CAPI/Support.h"
 
+using namespace circt;
+using namespace circt::comb;
+
 MLIR_DEFINE_CAPI_DIALECT_REGISTRATION(Combinational, comb,
                                       circt::comb::CombDialect)
+
+/// Returns the result type of a Comb operation named 'name' with operands of
+/// 'operandTypes', or a null type if it can't be inferred.
+static Type inferResultType(OperationName name, ArrayRef<Type> operandTypes) {
+  if (operandTypes.empty())
+    return {};
+  MLIRContext *context = name.getContext();
+  if (name.getStringRef() == MuxOp::getOperationName())
+    return operandTypes.size() == 3 ? operandTypes[1] : Type();
+  if (name.getStringRef() == ParityOp::getOperationName())
+    return operandTypes.size() == 1 ? IntegerType::get(context, 1) : Type();
+  if (name.getStringRef() == ConcatOp::getOperationName()) {
+    unsigned width = 0;
+    for (auto type : operandTypes) {
+      auto intType = type.dyn_cast<IntegerType>();
+      if (!intType)
+        return {};
+      width += intType.getWidth();
+    }
+    return IntegerType::get(context, width);
+  }
+  if (name.hasTrait<OpTrait::SameOperandsAndResultType>())
+    return operandTypes[0];
+  return {};
+}
+
+MlirLogicalResult
+combBuildGraph(MlirBlock block, MlirOperation insertBefore, MlirLocation cLoc,
+               intptr_t numOpNames, const MlirStringRef *opNames,
+               intptr_t numInputs, const MlirValue *inputs, intptr_t numNodes,
+               const int32_t *opcodes, const int32_t *numOperands,
+               const int32_t *operands, MlirOperation *results) {
+  Location loc = unwrap(cLoc);
+  MLIRContext *context = loc.getContext();
+
+  SmallVector<OperationName> names;
+  names.reserve(numOpNames);
+  for (intptr_t i = 0; i < numOpNames; ++i) {
+    auto name = RegisteredOperationName::lookup(unwrap(opNames[i]), context);
+    if (!name || !isa<CombDialect>(name->getDialect()))
+      return wrap(emitError(loc)
+                  << "'" << unwrap(opNames[i]) << "' is not a Comb operation");
+    names.push_back(*name);
+  }
+
+  // Infer all result types up front, such that nothing is created if the graph
+  // is malformed.
+  SmallVector<Type> types;
+  types.reserve(numInputs + numNodes);
+  for (intptr_t i = 0; i < numInputs; ++i)
+    types.push_back(unwrap(inputs[i]).getType());
+  SmallVector<Type> operandTypes;
+  for (intptr_t i = 0, operandIdx = 0; i < numNodes; ++i) {
+    if (opcodes[i] < 0 || opcodes[i] >= numOpNames)
+      return wrap(emitError(loc) << "node " << i << " has invalid opcode "
+                                 << opcodes[i]);
+    operandTypes.clear();
+    for (int32_t j = 0; j < numOperands[i]; ++j) {
+      int32_t operand = operands[operandIdx++];
+      if (operand < 0 || operand >= numInputs + i)
+        return wrap(emitError(loc) << "node " << i << " uses undefined value "
+                                   << operand);
+      operandTypes.push_back(types[operand]);
+    }
+    auto type = inferResultType(names[opcodes[i]], operandTypes);
+    if (!type)
+      return wrap(emitError(loc)
+                  << "cannot infer the result type of node " << i << " ('"
+                  << names[opcodes[i]] << "' with " << numOperands[i]
+                  << " operands)");
+    types.push_back(type);
+  }
+
+  OpBuilder builder(context);
+  if (insertBefore.ptr)
+    builder.setInsertionPoint(unwrap(insertBefore));
+  else
+    builder.setInsertionPointToEnd(unwrap(block));
+  SmallVector<Value> values;
+  values.reserve(numInputs + numNodes);
+  for (intptr_t i = 0; i < numInputs; ++i)
+    values.push_back(unwrap(inputs[i]));
+  SmallVector<Value> nodeOperands;
+  for (intptr_t i = 0, operandIdx = 0; i < numNodes; ++i) {
+    nodeOperands.clear();
+    for (int32_t j = 0; j < numOperands[i]; ++j)
+      nodeOperands.push_back(values[operands[operandIdx++]]);
+    OperationState state(loc, names[opcodes[i]]);
+    state.addOperands(nodeOperands);
+    state.addTypes(types[numInputs + i]);
+    Operation *op = builder.create(state);
+    values.push_back(op->getResult(0));
+    results[i] = wrap(op);
+  }
+  return wrap(success());
+}
@@ -220,3 +220,52 @@ MLIR_CAPI_EXPORTED MlirAttribute hwParamVerbatimAttrGet(MlirAttribute text) {
   auto type = NoneType::get(ctx);
   return wrap(ParamVerbatimAttr::get(ctx, textAttr, type));
 }
+
+//===----------------------------------------------------------------------===//
+// Operation API.
+//===----------------------------------------------------------------------===//
+
+MLIR_CAPI_EXPORTED MlirLogicalResult hwInstanceOpCreateBatch(
+    MlirBlock block, MlirOperation insertBefore, MlirLocation cLoc,
+    MlirOperation cModule, intptr_t numInstances, const MlirStringRef *names,
+    intptr_t numInputs, const MlirValue *inputs, MlirOperation *instances) {
+  Location loc = unwrap(cLoc);
+  Operation *module = unwrap(cModule);
+  if (!isAnyModule(module))
+    return wrap(emitError(loc) << "instantiated operation is not a module");
+  auto parameters = module->getAttrOfType<ArrayAttr>("parameters");
+  if (parameters && !parameters.empty())
+    return wrap(emitError(loc) << "parametric modules are not supported");
+
+  FunctionType moduleType = getModuleType(module);
+  auto inputTypes = moduleType.getInputs();
+  if (numInputs != numInstances * static_cast<intptr_t>(inputTypes.size()))
+    return wrap(emitError(loc)
+                << "expected " << numInstances * inputTypes.size()
+                << " inputs for " << numInstances << " instances, but got "
+                << numInputs);
+  for (intptr_t i = 0; i < numInputs; ++i) {
+    auto type = unwrap(inputs[i]).getType();
+    auto expected = inputTypes[i % inputTypes.size()];
+    if (type != expected)
+      return wrap(emitError(loc) << "input " << i << " has type " << type
+                                 << ", but the module expects " << expected);
+  }
+
+  OpBuilder builder(loc.getContext());
+  if (insertBefore.ptr)
+    builder.setInsertionPoint(unwrap(insertBefore));
+  else
+    builder.setInsertionPointToEnd(unwrap(block));
+  SmallVector<Value> instanceInputs;
+  for (intptr_t i = 0; i < numInstances; ++i) {
+    instanceInputs.clear();
+    for (size_t j = 0, e = inputTypes.size(); j < e; ++j)
+      instanceInputs.push_back(unwrap(inputs[i * e + j]));
+    auto name = builder.getStringAttr(unwrap(names[i]));
+    instances[i] =
+        wrap(builder.create<InstanceOp>(loc, module, name, instanceInputs)
+                 .getOperation());
+  }
+  return wrap(success());
+}
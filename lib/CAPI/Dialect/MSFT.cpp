@@ -87,6 +87,21 @@ MlirOperation circtMSFTPlacementDBPlace(CirctMSFTPlacementDB db,
     return wrap(unwrap(db)->place(inst, locVec, srcLoc));
   llvm_unreachable("Can only place PDPhysLocationOp and PDRegPhysLocationOp");
 }
+void circtMSFTPlacementDBPlaceAll(CirctMSFTPlacementDB db,
+                                  intptr_t numPlacements,
+                                  const MlirOperation *insts,
+                                  const MlirAttribute *locs,
+                                  const MlirStringRef *subpaths,
+                                  MlirLocation srcLoc, MlirOperation *results) {
+  SmallVector<PlacementDB::PlacementRequest> requests;
+  requests.reserve(numPlacements);
+  for (intptr_t i = 0; i < numPlacements; ++i)
+    requests.push_back({cast<DynamicInstanceOp>(unwrap(insts[i])),
+                        unwrap(locs[i]), unwrap(subpaths[i])});
+  auto placed = unwrap(db)->placeAll(requests, unwrap(srcLoc));
+  for (intptr_t i = 0; i < numPlacements; ++i)
+    results[i] = wrap(placed[i].getOperation());
+}
 void circtMSFTPlacementDBRemovePlacement(CirctMSFTPlacementDB db,
                                          MlirOperation clocOp) {
   Operation *locOp = unwrap(clocOp);
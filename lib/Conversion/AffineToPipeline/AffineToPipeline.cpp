@@ -63,7 +63,68 @@ private:
 
 } // namespace
 
+/// Flatten the perfectly nested loops in 'loopNest' into a single loop, which
+/// recovers the original induction variables from its own through divisions
+/// and modulos. Fails if the nest has non-constant bounds or carries values
+/// across iterations.
+static LogicalResult flattenLoopNest(ArrayRef<AffineForOp> loopNest) {
+  SmallVector<int64_t> tripCounts;
+  int64_t flatTripCount = 1;
+  for (auto loop : loopNest) {
+    auto tripCount = getConstantTripCount(loop);
+    if (!loop.hasConstantBounds() || loop.getNumIterOperands() != 0 ||
+        !tripCount || *tripCount == 0)
+      return failure();
+    tripCounts.push_back(*tripCount);
+    flatTripCount *= *tripCount;
+  }
+
+  AffineForOp outerLoop = loopNest.front();
+  AffineForOp innerLoop = loopNest.back();
+  OpBuilder builder(outerLoop);
+  auto flatLoop =
+      builder.create<AffineForOp>(outerLoop.getLoc(), 0, flatTripCount);
+
+  // The innermost loop varies fastest, so the stride of each loop is the
+  // product of the trip counts of the loops nested within it.
+  builder.setInsertionPointToStart(flatLoop.getBody());
+  AffineExpr flatIV = builder.getAffineDimExpr(0);
+  int64_t stride = 1;
+  for (unsigned i = loopNest.size(); i-- > 0;) {
+    AffineForOp loop = loopNest[i];
+    int64_t tripCount = tripCounts[i];
+    // The outermost loop never wraps around.
+    AffineExpr iv = flatIV.floorDiv(stride);
+    if (i > 0)
+      iv = iv % tripCount;
+    iv = iv * loop.getStep() + loop.getConstantLowerBound();
+    auto apply = builder.create<AffineApplyOp>(
+        loop.getLoc(), AffineMap::get(1, 0, iv), flatLoop.getInductionVar());
+    loop.getInductionVar().replaceAllUsesWith(apply);
+    stride *= tripCount;
+  }
+
+  // Move the body of the innermost loop over, except for its terminator.
+  auto &innerOps = innerLoop.getBody()->getOperations();
+  auto &flatOps = flatLoop.getBody()->getOperations();
+  flatOps.splice(std::prev(flatOps.end()), innerOps, innerOps.begin(),
+                 std::prev(innerOps.end()));
+  outerLoop.erase();
+  return success();
+}
+
 void AffineToPipeline::runOnOperation() {
+  // Flatten loop nests before any analysis sees them.
+  if (flattenLoopNests) {
+    for (auto root : llvm::make_early_inc_range(
+             getOperation().getOps<AffineForOp>())) {
+      SmallVector<AffineForOp> nestedLoops;
+      getPerfectlyNestedLoops(nestedLoops, root);
+      if (nestedLoops.size() > 1)
+        (void)flattenLoopNest(nestedLoops);
+    }
+  }
+
   // Get dependence analysis for the whole function.
   auto dependenceAnalysis = getAnalysis<MemoryDependenceAnalysis>();
 
@@ -258,12 +319,13 @@ LogicalResult AffineToPipeline::populateOperatorTypes(
   Operation *unsupported;
   WalkResult result = forOp.getBody()->walk([&](Operation *op) {
     return TypeSwitch<Operation *, WalkResult>(op)
-        .Case<AddIOp, IfOp, AffineYieldOp, arith::ConstantOp, CmpIOp,
-              IndexCastOp, memref::AllocaOp, YieldOp>([&](Operation *combOp) {
-          // Some known combinational ops.
-          problem.setLinkedOperatorType(combOp, combOpr);
-          return WalkResult::advance();
-        })
+        .Case<AddIOp, SubIOp, IfOp, AffineYieldOp, arith::ConstantOp, CmpIOp,
+              IndexCastOp, memref::AllocaOp, arith::SelectOp, YieldOp>(
+            [&](Operation *combOp) {
+              // Some known combinational ops.
+              problem.setLinkedOperatorType(combOp, combOpr);
+              return WalkResult::advance();
+            })
         .Case<AffineLoadOp, AffineStoreOp, memref::LoadOp, memref::StoreOp>(
             [&](Operation *seqOp) {
               // Some known sequential ops. In certain cases, reads may be
@@ -272,8 +334,9 @@ LogicalResult AffineToPipeline::populateOperatorTypes(
               problem.setLinkedOperatorType(seqOp, seqOpr);
               return WalkResult::advance();
             })
-        .Case<MulIOp>([&](Operation *mcOp) {
-          // Some known multi-cycle ops.
+        .Case<MulIOp, DivSIOp, RemSIOp>([&](Operation *mcOp) {
+          // Some known multi-cycle ops. Divisions and remainders recover the
+          // induction variables of flattened loop nests.
           problem.setLinkedOperatorType(mcOp, mcOpr);
           return WalkResult::advance();
         })
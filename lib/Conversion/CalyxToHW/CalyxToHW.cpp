@@ -22,6 +22,7 @@
 #include "circt/Dialect/SV/SVOps.h"
 #include "circt/Dialect/Seq/SeqOps.h"
 #include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "llvm/ADT/TypeSwitch.h"
 
@@ -424,24 +425,50 @@ void CalyxToHWPass::runOnOperation() {
     return signalPassFailure();
 }
 
-LogicalResult CalyxToHWPass::runOnModule(ModuleOp module) {
-  MLIRContext &context = getContext();
-
-  ConversionTarget target(context);
+/// Marks the Calyx dialect as illegal, and the dialects it is lowered to as
+/// legal.
+static void populateLegality(ConversionTarget &target) {
   target.addIllegalDialect<CalyxDialect>();
   target.addLegalDialect<HWDialect>();
   target.addLegalDialect<CombDialect>();
   target.addLegalDialect<SeqDialect>();
   target.addLegalDialect<SVDialect>();
+}
 
-  RewritePatternSet patterns(&context);
-  patterns.add<ConvertComponentOp>(&context);
-  patterns.add<ConvertWiresOp>(&context);
-  patterns.add<ConvertControlOp>(&context);
-  patterns.add<ConvertCellOp>(&context);
-  patterns.add<ConvertAssignOp>(&context);
+LogicalResult CalyxToHWPass::runOnModule(ModuleOp module) {
+  MLIRContext &context = getContext();
 
-  return applyPartialConversion(module, target, std::move(patterns));
+  // First, turn the components into HW modules. This only restructures the
+  // top level of the program, so it is done sequentially.
+  ConversionTarget componentTarget(context);
+  componentTarget.addIllegalOp<ComponentOp>();
+  RewritePatternSet componentPatterns(&context);
+  componentPatterns.add<ConvertComponentOp>(&context);
+  if (failed(applyPartialConversion(module, componentTarget,
+                                    std::move(componentPatterns))))
+    return failure();
+
+  // The bodies of the HW modules are isolated from each other, hence their
+  // cells, wires and assignments are lowered in parallel.
+  RewritePatternSet patternList(&context);
+  patternList.add<ConvertWiresOp>(&context);
+  patternList.add<ConvertControlOp>(&context);
+  patternList.add<ConvertCellOp>(&context);
+  patternList.add<ConvertAssignOp>(&context);
+  FrozenRewritePatternSet patterns(std::move(patternList));
+
+  auto hwModules = llvm::to_vector(module.getOps<HWModuleOp>());
+  if (failed(failableParallelForEach(&context, hwModules, [&](HWModuleOp mod) {
+        ConversionTarget target(context);
+        populateLegality(target);
+        return applyPartialConversion(mod, target, patterns);
+      })))
+    return failure();
+
+  // Anything from the Calyx dialect left outside of the components is illegal.
+  ConversionTarget target(context);
+  populateLegality(target);
+  return applyPartialConversion(module, target, FrozenRewritePatternSet());
 }
 
 std::unique_ptr<mlir::Pass> circt::createCalyxToHWPass() {
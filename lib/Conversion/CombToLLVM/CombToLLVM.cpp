@@ -219,6 +219,158 @@ struct CombParityOpConversion : public ConvertToLLVMPattern {
 
 } // namespace
 
+//===----------------------------------------------------------------------===//
+// Word vector conversions
+//===----------------------------------------------------------------------===//
+
+// LLVM legalizes wide integers into long chains of scalar operations. Wide
+// bitwise, concat and extract operations whose operands are made of whole
+// 64-bit words are instead lowered into operations on vectors of words, which
+// map onto SIMD instructions. The vectors are bitcast from and to the integers,
+// such that their lowering is transparent to the users of the values. The
+// mapping of the words to the bits of the integers assumes a little-endian
+// target, where the first word holds the least significant bits.
+
+/// Returns the type of the vector of 64-bit words which holds the bits of
+/// 'type', if 'type' is an integer wider than 'minWidth' made of whole words.
+static VectorType getWordVectorType(Type type, unsigned minWidth) {
+  auto intType = type.dyn_cast<IntegerType>();
+  if (!intType || intType.getWidth() <= minWidth ||
+      intType.getWidth() % 64 != 0)
+    return {};
+  return VectorType::get(intType.getWidth() / 64,
+                         IntegerType::get(type.getContext(), 64));
+}
+
+/// Appends the words 'begin' to 'end' of the integer 'value', which is made of
+/// whole words, to 'words', the least significant first.
+static void unpackWords(OpBuilder &builder, Location loc, Value value,
+                        unsigned begin, unsigned end,
+                        SmallVectorImpl<Value> &words) {
+  unsigned width = value.getType().getIntOrFloatBitWidth();
+  if (width == 64) {
+    words.push_back(value);
+    return;
+  }
+  auto vectorType = VectorType::get(width / 64, builder.getI64Type());
+  Value vector = builder.create<LLVM::BitcastOp>(loc, vectorType, value);
+  for (unsigned i = begin; i < end; ++i) {
+    Value idx = builder.create<LLVM::ConstantOp>(
+        loc, builder.getI32Type(), builder.getI32IntegerAttr(i));
+    words.push_back(builder.create<LLVM::ExtractElementOp>(
+        loc, builder.getI64Type(), vector, idx));
+  }
+}
+
+/// Returns the integer of type 'type' made of 'words', the least significant
+/// first.
+static Value packWords(OpBuilder &builder, Location loc, ArrayRef<Value> words,
+                       Type type) {
+  if (words.size() == 1)
+    return words.front();
+  auto vectorType = VectorType::get(words.size(), builder.getI64Type());
+  Value vector = builder.create<LLVM::UndefOp>(loc, vectorType);
+  for (auto [i, word] : llvm::enumerate(words)) {
+    Value idx = builder.create<LLVM::ConstantOp>(
+        loc, builder.getI32Type(), builder.getI32IntegerAttr(i));
+    vector = builder.create<LLVM::InsertElementOp>(loc, vectorType, vector,
+                                                   word, idx);
+  }
+  return builder.create<LLVM::BitcastOp>(loc, type, vector);
+}
+
+namespace {
+/// Lower a wide bitwise operation to the same operation on word vectors.
+template <typename SourceOp, typename TargetOp>
+struct WordVectorBitwiseConversion : public ConvertOpToLLVMPattern<SourceOp> {
+  using OpAdaptor = typename SourceOp::Adaptor;
+
+  WordVectorBitwiseConversion(LLVMTypeConverter &converter, unsigned minWidth)
+      : ConvertOpToLLVMPattern<SourceOp>(converter, /*benefit=*/2),
+        minWidth(minWidth) {}
+
+  LogicalResult
+  matchAndRewrite(SourceOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Type type = op.getResult().getType();
+    auto vectorType = getWordVectorType(type, minWidth);
+    auto operands = adaptor.getOperands();
+    if (!vectorType || operands.size() < 2)
+      return failure();
+
+    auto loc = op.getLoc();
+    Value result =
+        rewriter.create<LLVM::BitcastOp>(loc, vectorType, operands.front());
+    for (auto operand : operands.drop_front()) {
+      Value vector = rewriter.create<LLVM::BitcastOp>(loc, vectorType, operand);
+      result = rewriter.create<TargetOp>(loc, vectorType, result, vector);
+    }
+    rewriter.replaceOpWithNewOp<LLVM::BitcastOp>(op, type, result);
+    return success();
+  }
+
+  unsigned minWidth;
+};
+
+/// Lower a comb::ExtractOp of whole words from a wide integer to a selection
+/// of the words.
+struct WordVectorExtractConversion
+    : public ConvertOpToLLVMPattern<comb::ExtractOp> {
+  WordVectorExtractConversion(LLVMTypeConverter &converter, unsigned minWidth)
+      : ConvertOpToLLVMPattern<comb::ExtractOp>(converter, /*benefit=*/2),
+        minWidth(minWidth) {}
+
+  LogicalResult
+  matchAndRewrite(comb::ExtractOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    unsigned width = op.getType().getIntOrFloatBitWidth();
+    if (!getWordVectorType(op.getInput().getType(), minWidth) ||
+        op.getLowBit() % 64 != 0 || width % 64 != 0)
+      return failure();
+
+    SmallVector<Value> words;
+    unsigned begin = op.getLowBit() / 64;
+    unpackWords(rewriter, op.getLoc(), adaptor.getInput(), begin,
+                begin + width / 64, words);
+    rewriter.replaceOp(op, packWords(rewriter, op.getLoc(), words,
+                                     op.getType()));
+    return success();
+  }
+
+  unsigned minWidth;
+};
+
+/// Lower a comb::ConcatOp of whole words into a wide integer to a sequence of
+/// the words.
+struct WordVectorConcatConversion
+    : public ConvertOpToLLVMPattern<comb::ConcatOp> {
+  WordVectorConcatConversion(LLVMTypeConverter &converter, unsigned minWidth)
+      : ConvertOpToLLVMPattern<comb::ConcatOp>(converter, /*benefit=*/2),
+        minWidth(minWidth) {}
+
+  LogicalResult
+  matchAndRewrite(comb::ConcatOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    if (!getWordVectorType(op.getType(), minWidth) ||
+        llvm::any_of(op.getInputs(), [](Value input) {
+          return input.getType().getIntOrFloatBitWidth() % 64 != 0;
+        }))
+      return failure();
+
+    // The first operand holds the most significant bits.
+    SmallVector<Value> words;
+    for (auto input : llvm::reverse(adaptor.getInputs()))
+      unpackWords(rewriter, op.getLoc(), input, 0,
+                  input.getType().getIntOrFloatBitWidth() / 64, words);
+    rewriter.replaceOp(op, packWords(rewriter, op.getLoc(), words,
+                                     op.getType()));
+    return success();
+  }
+
+  unsigned minWidth;
+};
+} // namespace
+
 //===----------------------------------------------------------------------===//
 // Pass initialization
 //===----------------------------------------------------------------------===//
@@ -231,9 +383,18 @@ struct CombToLLVMLoweringPass
 } // namespace
 
 void circt::populateCombToLLVMConversionPatterns(LLVMTypeConverter &converter,
-                                                 RewritePatternSet &patterns) {
+                                                 RewritePatternSet &patterns,
+                                                 unsigned vectorizeWidth) {
   MLIRContext *ctx = converter.getDialect()->getContext();
 
+  // Word vector conversion patterns, which take precedence where they apply.
+  if (vectorizeWidth != 0)
+    patterns.add<WordVectorBitwiseConversion<comb::AndOp, LLVM::AndOp>,
+                 WordVectorBitwiseConversion<comb::OrOp, LLVM::OrOp>,
+                 WordVectorBitwiseConversion<comb::XorOp, LLVM::XOrOp>,
+                 WordVectorExtractConversion, WordVectorConcatConversion>(
+        converter, vectorizeWidth);
+
   // Extract conversion patterns.
   patterns.add<CombExtractOpConversion, CombConcatOpConversion>(ctx, converter);
 
@@ -262,7 +423,7 @@ void CombToLLVMLoweringPass::runOnOperation() {
   target.addIllegalDialect<comb::CombDialect>();
 
   // Setup the conversion.
-  populateCombToLLVMConversionPatterns(converter, patterns);
+  populateCombToLLVMConversionPatterns(converter, patterns, vectorizeWidth);
 
   // Apply a partial conversion.
   if (failed(
@@ -14,6 +14,7 @@
 #include "../PassDetail.h"
 #include "circt/Dialect/FIRRTL/FIRRTLOps.h"
 #include "circt/Support/Version.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Support/FileUtilities.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
@@ -173,51 +174,88 @@ static LogicalResult emitModule(FModuleLike module, llvm::raw_ostream &os) {
   return success();
 }
 
-/// Exports a Chisel interface to the output stream.
-static LogicalResult exportChiselInterface(CircuitOp circuit,
-                                           llvm::raw_ostream &os) {
-  // Emit version, package, and import declarations
+/// Emits the version comment, package, and import declarations.
+static void emitHeader(CircuitOp circuit, llvm::raw_ostream &os) {
   os << circt::getCirctVersionComment() << "package shelf."
      << circuit.getName().lower()
      << "\n\nimport chisel3._\nimport chisel3.experimental._\n\n";
+}
 
-  // Emit a class for the main circuit module.
+/// Returns the modules an interface is exported for: the main module of the
+/// circuit, followed by the other public modules in circuit order.
+static SmallVector<FModuleLike> getExportedModules(CircuitOp circuit) {
   auto topModule = circuit.getMainModule();
-  if (failed(emitModule(topModule, os)))
+  SmallVector<FModuleLike> modules;
+  modules.push_back(topModule);
+  for (auto module : circuit.getBodyBlock()->getOps<FModuleLike>())
+    if (module != topModule && module.isPublic())
+      modules.push_back(module);
+  return modules;
+}
+
+/// Exports a Chisel interface to the output stream.
+static LogicalResult exportChiselInterface(CircuitOp circuit,
+                                           llvm::raw_ostream &os) {
+  // Emit the classes of the modules into separate buffers in parallel, and
+  // write them out in order afterwards.
+  auto modules = getExportedModules(circuit);
+  SmallVector<std::string> interfaces(modules.size());
+  auto result = mlir::failableParallelForEachN(
+      circuit.getContext(), 0, modules.size(), [&](size_t index) {
+        llvm::raw_string_ostream interfaceOs(interfaces[index]);
+        return emitModule(modules[index], interfaceOs);
+      });
+  if (failed(result))
     return failure();
 
+  emitHeader(circuit, os);
+  llvm::interleave(interfaces, os, "\n");
   return success();
 }
 
-/// Exports Chisel interface files for the circuit to the specified directory.
-static LogicalResult exportSplitChiselInterface(CircuitOp circuit,
-                                                StringRef outputDirectory) {
-  // Create the output directory if needed.
-  std::error_code error = llvm::sys::fs::create_directories(outputDirectory);
-  if (error) {
-    circuit.emitError("cannot create output directory \"")
-        << outputDirectory << "\": " << error.message();
-    return failure();
-  }
-
+/// Exports a Chisel interface file for the module to the specified directory.
+static LogicalResult exportModuleInterfaceFile(CircuitOp circuit,
+                                               FModuleLike module,
+                                               StringRef outputDirectory) {
   // Open the output file.
   SmallString<128> interfaceFilePath(outputDirectory);
-  llvm::sys::path::append(interfaceFilePath, circuit.getName());
+  llvm::sys::path::append(interfaceFilePath, module.moduleName());
   llvm::sys::path::replace_extension(interfaceFilePath, "scala");
   std::string errorMessage;
   auto interfaceFile = mlir::openOutputFile(interfaceFilePath, &errorMessage);
   if (!interfaceFile) {
-    circuit.emitError(errorMessage);
+    module.emitError(errorMessage);
     return failure();
   }
 
   // Export the interface to the file.
-  auto result = exportChiselInterface(circuit, interfaceFile->os());
+  emitHeader(circuit, interfaceFile->os());
+  auto result = emitModule(module, interfaceFile->os());
   if (succeeded(result))
     interfaceFile->keep();
   return result;
 }
 
+/// Exports Chisel interface files for the circuit to the specified directory,
+/// one file per exported module. The files are generated and written in
+/// parallel.
+static LogicalResult exportSplitChiselInterface(CircuitOp circuit,
+                                                StringRef outputDirectory) {
+  // Create the output directory if needed.
+  std::error_code error = llvm::sys::fs::create_directories(outputDirectory);
+  if (error) {
+    circuit.emitError("cannot create output directory \"")
+        << outputDirectory << "\": " << error.message();
+    return failure();
+  }
+
+  auto modules = getExportedModules(circuit);
+  return mlir::failableParallelForEach(
+      circuit.getContext(), modules, [&](FModuleLike module) {
+        return exportModuleInterfaceFile(circuit, module, outputDirectory);
+      });
+}
+
 //===----------------------------------------------------------------------===//
 // ExportChiselInterfacePass and ExportSplitChiselInterfacePass
 //===----------------------------------------------------------------------===//
@@ -37,14 +37,19 @@
 #include "mlir/Support/FileUtilities.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SaveAndRestore.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <chrono>
+
 using namespace circt;
 
 using namespace comb;
@@ -854,6 +859,9 @@ public:
   bool encounteredError = false;
   unsigned currentIndent = 0;
 
+  /// The statistics of the module being emitted, if they are being collected.
+  ModuleEmissionStats *stats = nullptr;
+
 private:
   VerilogEmitterState(const VerilogEmitterState &) = delete;
   void operator=(const VerilogEmitterState &) = delete;
@@ -1895,8 +1903,17 @@ private:
   /// back to the caller in this vector.
   SmallVectorImpl<char> &outBuffer;
   llvm::raw_svector_ostream os;
+
+  /// Prefixes to be inserted into `outBuffer` at the given offsets, such as
+  /// parentheses which are only known to be needed once a subexpression has
+  /// been emitted. They are inserted all at once by `formatOutBuffer`.
+  SmallVector<std::pair<size_t, StringRef>> pendingPrefixes;
+
   // Track legalized names.
   ModuleNameManager &names;
+
+  /// Current nesting depth of inline subexpressions, for emission statistics.
+  unsigned exprDepth = 0;
 };
 } // end anonymous namespace
 
@@ -1975,9 +1992,36 @@ void ExprEmitter::emitSVAttributes(Operation *op) {
   emitSVAttributesImpl(os, svAttrs);
 }
 
-/// This function split the output buffer into multiple lines if the emitted
-/// length is larger than the constraint.
+/// This function inserts the pending prefixes into the output buffer and
+/// splits it into multiple lines if the emitted length is larger than the
+/// constraint.
 void ExprEmitter::formatOutBuffer() {
+  // Insert all prefixes in a single pass over the buffer rather than moving
+  // the tail of the buffer for every parenthesized subexpression. Prefixes
+  // recorded later belong to enclosing subexpressions, so they go first among
+  // the prefixes at the same offset.
+  if (!pendingPrefixes.empty()) {
+    std::reverse(pendingPrefixes.begin(), pendingPrefixes.end());
+    llvm::stable_sort(pendingPrefixes, [](const auto &a, const auto &b) {
+      return a.first < b.first;
+    });
+    SmallVector<char> tmpOutBuffer;
+    size_t prefixLength = 0;
+    for (auto &prefix : pendingPrefixes)
+      prefixLength += prefix.second.size();
+    tmpOutBuffer.reserve(outBuffer.size() + prefixLength);
+    size_t offset = 0;
+    for (auto [prefixOffset, prefix] : pendingPrefixes) {
+      tmpOutBuffer.append(outBuffer.begin() + offset,
+                          outBuffer.begin() + prefixOffset);
+      tmpOutBuffer.append(prefix.begin(), prefix.end());
+      offset = prefixOffset;
+    }
+    tmpOutBuffer.append(outBuffer.begin() + offset, outBuffer.end());
+    outBuffer = std::move(tmpOutBuffer);
+    pendingPrefixes.clear();
+  }
+
   // If the output already satisfies the constraint, skip here.
   if (outBuffer.size() <= state.options.emittedLineLength)
     return;
@@ -2065,6 +2109,11 @@ SubExprInfo ExprEmitter::emitSubExpr(Value exp,
 
   unsigned subExprStartIndex = outBuffer.size();
 
+  llvm::SaveAndRestore<unsigned> saveDepth(exprDepth, exprDepth + 1);
+  if (state.stats)
+    state.stats->maxExpressionDepth =
+        std::max(state.stats->maxExpressionDepth, exprDepth);
+
   // Inform the visit method about the preferred sign we want from the result.
   // It may choose to ignore this, but some emitters can change behavior based
   // on contextual desired sign.
@@ -2082,10 +2131,10 @@ SubExprInfo ExprEmitter::emitSubExpr(Value exp,
   auto expInfo = dispatchCombinationalVisitor(exp.getDefiningOp());
 
   // Check cases where we have to insert things before the expression now that
-  // we know things about it.
+  // we know things about it. The prefixes are inserted once the whole
+  // expression has been emitted.
   auto addPrefix = [&](StringRef prefix) {
-    outBuffer.insert(outBuffer.begin() + subExprStartIndex, prefix.begin(),
-                     prefix.end());
+    pendingPrefixes.push_back({subExprStartIndex, prefix});
   };
   if (signRequirement == RequireSigned && expInfo.signedness == IsUnsigned) {
     addPrefix("$signed(");
@@ -3048,8 +3097,23 @@ LogicalResult StmtEmitter::visitSV(VerbatimOp op) {
   SmallPtrSet<Operation *, 8> ops;
   ops.insert(op);
 
-  // Drop an extraneous \n off the end of the string if present.
+  // A verbatim op can refer to a source file, whose contents are copied into
+  // the output without ever being held in an attribute.
   StringRef string = op.getFormatString();
+  std::unique_ptr<llvm::MemoryBuffer> sourceFile;
+  if (auto path =
+          op->getAttrOfType<StringAttr>(getVerbatimSourceFileAttrName())) {
+    std::string errorMessage;
+    sourceFile = mlir::openInputFile(path.getValue(), &errorMessage);
+    if (!sourceFile) {
+      emitOpError(op, "cannot read source file '")
+          << path.getValue() << "': " << errorMessage;
+      return failure();
+    }
+    string = sourceFile->getBuffer();
+  }
+
+  // Drop an extraneous \n off the end of the string if present.
   if (string.endswith("\n"))
     string = string.drop_back();
 
@@ -3069,10 +3133,14 @@ LogicalResult StmtEmitter::visitSV(VerbatimOp op) {
       indent();
     }
 
-    // Emit each chunk of the line.
-    emitTextWithSubstitutions(
-        lhsRhs.first, op, [&](Value operand) { emitExpression(operand, ops); },
-        op.getSymbols(), names);
+    // Emit each chunk of the line.  Source files are copied as they are.
+    if (sourceFile)
+      os << lhsRhs.first;
+    else
+      emitTextWithSubstitutions(
+          lhsRhs.first, op,
+          [&](Value operand) { emitExpression(operand, ops); },
+          op.getSymbols(), names);
     string = lhsRhs.second;
   }
 
@@ -4067,7 +4135,13 @@ LogicalResult StmtEmitter::emitDeclaration(Operation *op) {
     os.indent(maxTypeWidth - typeString.size());
 
   // Emit the name.
-  os << names.getName(value);
+  StringRef name = names.getName(value);
+  os << name;
+  if (state.stats) {
+    ++state.stats->numDeclarations;
+    if (name.startswith("_"))
+      ++state.stats->numTemporaries;
+  }
 
   // Print out any array subscripts or other post-name stuff.
   emitter.printUnpackedTypePostfix(type, os);
@@ -4584,20 +4658,28 @@ void ModuleEmitter::emitHWModule(HWModuleOp module) {
 /// of an explicit output file attribute.
 void SharedEmitterState::gatherFiles(bool separateModules) {
 
-  /// Collect all the inner names from the specified module and add them to the
-  /// IRCache.  Declarations (named things) only exist at the top level of the
-  /// module.  Also keep track of any modules that contain bind operations.
-  /// These are non-hierarchical references which we need to be careful about
-  /// during emission.
-  auto collectInstanceSymbolsAndBinds = [&](HWModuleOp moduleOp) {
-    moduleOp.walk([&](Operation *op) {
-      // Populate the symbolCache with all operations that can define a symbol.
+  /// Collect all the inner names from the specified module.  Declarations
+  /// (named things) only exist at the top level of the module.  Bind emission
+  /// resolves the bound instance through these in the IRCache.
+  ///
+  /// Walking the body of every module is by far the most expensive part of
+  /// building the symbol cache, so this runs for all modules in parallel, and
+  /// the results are added to the cache in module order below.
+  SmallVector<HWModuleOp> modules(designOp.getBody()->getOps<HWModuleOp>());
+  SmallVector<SmallVector<std::pair<StringAttr, Operation *>, 0>>
+      instanceSymbols(modules.size());
+  mlir::parallelFor(designOp.getContext(), 0, modules.size(), [&](size_t i) {
+    modules[i].walk([&](Operation *op) {
       if (auto name = op->getAttrOfType<StringAttr>(
               hw::InnerName::getInnerNameAttrName()))
-        symbolCache.addDefinition(moduleOp.getNameAttr(), name, op);
-      if (isa<BindOp>(op))
-        modulesContainingBinds.insert(moduleOp);
+        instanceSymbols[i].push_back({name, op});
     });
+  });
+  size_t nextModule = 0;
+  auto collectInstanceSymbols = [&](HWModuleOp moduleOp) {
+    assert(modules[nextModule] == moduleOp && "modules visited out of order");
+    for (auto [name, op] : instanceSymbols[nextModule++])
+      symbolCache.addDefinition(moduleOp.getNameAttr(), name, op);
   };
   /// Collect any port marked as being referenced via symbol.
   auto collectPorts = [&](auto moduleOp) {
@@ -4676,7 +4758,7 @@ void SharedEmitterState::gatherFiles(bool separateModules) {
           // Build the IR cache.
           symbolCache.addDefinition(mod.getNameAttr(), mod);
           collectPorts(mod);
-          collectInstanceSymbolsAndBinds(mod);
+          collectInstanceSymbols(mod);
 
           // Emit into a separate file named after the module.
           if (attr || separateModules)
@@ -4811,6 +4893,30 @@ static void emitOperation(VerilogEmitterState &state, Operation *op) {
       });
 }
 
+/// Emit an operation, recording statistics for it if it is a module and
+/// statistics are being collected.
+static void emitOperation(SharedEmitterState &shared,
+                          VerilogEmitterState &state, Operation *op) {
+  auto module = dyn_cast<HWModuleOp>(op);
+  if (!shared.collectStats || !module)
+    return emitOperation(state, op);
+
+  ModuleEmissionStats stats;
+  stats.moduleName = module.getNameAttr();
+  state.stats = &stats;
+  auto startTime = std::chrono::steady_clock::now();
+  auto startPos = state.os.tell();
+  emitOperation(state, op);
+  stats.bytesEmitted = state.os.tell() - startPos;
+  stats.wallTime = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - startTime)
+                       .count();
+  state.stats = nullptr;
+
+  std::lock_guard<std::mutex> lock(shared.moduleStatsMutex);
+  shared.moduleStats.push_back(stats);
+}
+
 /// Actually emit the collected list of operations and strings to the
 /// specified file.
 void SharedEmitterState::emitOps(EmissionList &thingsToEmit, raw_ostream &os,
@@ -4828,7 +4934,7 @@ void SharedEmitterState::emitOps(EmissionList &thingsToEmit, raw_ostream &os,
                               globalNames, os);
     for (auto &entry : thingsToEmit) {
       if (auto *op = entry.getOperation())
-        emitOperation(state, op);
+        emitOperation(*this, state, op);
       else
         os << entry.getStringData();
     }
@@ -4839,52 +4945,107 @@ void SharedEmitterState::emitOps(EmissionList &thingsToEmit, raw_ostream &os,
   }
 
   // If we are parallelizing emission, we emit each independent operation to a
-  // string buffer in parallel, then concat at the end.
-  parallelForEach(context, thingsToEmit, [&](StringOrOpToEmit &stringOrOp) {
+  // string buffer in parallel and stream the buffers out in order: as soon as
+  // an entry and all entries before it are done, they are written and freed.
+  // Workers pick up entries roughly in order, so only a few buffers are alive
+  // at any time rather than the entire output.
+  size_t numEntries = thingsToEmit.size();
+  SmallVector<bool> done;
+  done.reserve(numEntries);
+  for (auto &entry : thingsToEmit)
+    done.push_back(!entry.getOperation());
+
+  std::mutex writeMutex;
+  size_t nextToWrite = 0;
+
+  // Write out the finished prefix of the list.  Must hold `writeMutex`.
+  auto writeFinished = [&] {
+    for (; nextToWrite < numEntries && done[nextToWrite]; ++nextToWrite) {
+      auto &entry = thingsToEmit[nextToWrite];
+      os << entry.getStringData();
+      entry.clearString();
+    }
+  };
+
+  {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    writeFinished();
+  }
+
+  mlir::parallelFor(context, 0, numEntries, [&](size_t i) {
+    auto &stringOrOp = thingsToEmit[i];
     auto *op = stringOrOp.getOperation();
     if (!op)
       return; // Ignore things that are already strings.
 
-    // BindOp emission reaches into the hw.module of the instance, and that
-    // body may be being transformed by its own emission.  Defer their
-    // emission to the serial phase.  They are speedy to emit anyway.
-    if (isa<BindOp>(op) || modulesContainingBinds.count(op))
-      return;
-
+    // BindOp emission reaches into the hw.module of the instance.  This is
+    // safe to do concurrently with the emission of that module: all names
+    // have been legalized into attributes and the symbol cache is frozen
+    // before emission starts, and emission never mutates the IR.
     SmallString<256> buffer;
     llvm::raw_svector_ostream tmpStream(buffer);
     VerilogEmitterState state(designOp, *this, options, symbolCache,
                               globalNames, tmpStream);
-    emitOperation(state, op);
-    stringOrOp.setString(buffer);
-  });
+    emitOperation(*this, state, op);
+    if (state.encounteredError)
+      encounteredError = true;
 
-  // Finally emit each entry now that we know it is a string.
-  for (auto &entry : thingsToEmit) {
-    // Almost everything is lowered to a string, just concat the strings onto
-    // the output stream.
-    auto *op = entry.getOperation();
-    if (!op) {
-      os << entry.getStringData();
-      continue;
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (i != nextToWrite) {
+      stringOrOp.setString(buffer);
+      done[i] = true;
+      return;
     }
+    os << buffer;
+    ++nextToWrite;
+    writeFinished();
+  });
 
-    // If this wasn't emitted to a string (e.g. it is a bind) do so now.
-    VerilogEmitterState state(designOp, *this, options, symbolCache,
-                              globalNames, os);
-    emitOperation(state, op);
-  }
+  assert(nextToWrite == numEntries && "all entries should have been written");
+}
+
+void SharedEmitterState::writeStatsJSON(raw_ostream &os) {
+  llvm::sort(moduleStats, [](auto &a, auto &b) {
+    return a.moduleName.getValue() < b.moduleName.getValue();
+  });
+  llvm::json::OStream json(os, 2);
+  json.array([&] {
+    for (auto &stats : moduleStats)
+      json.object([&] {
+        json.attribute("module", stats.moduleName.getValue());
+        json.attribute("wallTime", stats.wallTime);
+        json.attribute("bytesEmitted", (int64_t)stats.bytesEmitted);
+        json.attribute("declarations", (int64_t)stats.numDeclarations);
+        json.attribute("temporaries", (int64_t)stats.numTemporaries);
+        json.attribute("maxExpressionDepth", (int64_t)stats.maxExpressionDepth);
+      });
+  });
+  os << "\n";
 }
 
 //===----------------------------------------------------------------------===//
 // Unified Emitter
 //===----------------------------------------------------------------------===//
 
-static LogicalResult exportVerilogImpl(ModuleOp module, llvm::raw_ostream &os) {
+/// Write the emission statistics collected by `emitter` to `statsFile`.
+static LogicalResult writeEmissionStats(SharedEmitterState &emitter,
+                                        StringRef statsFile) {
+  std::string errorMessage;
+  auto output = mlir::openOutputFile(statsFile, &errorMessage);
+  if (!output)
+    return emitter.designOp.emitError(errorMessage);
+  emitter.writeStatsJSON(output->os());
+  output->keep();
+  return success();
+}
+
+static LogicalResult exportVerilogImpl(ModuleOp module, llvm::raw_ostream &os,
+                                       StringRef statsFile = {}) {
   GlobalNameTable globalNames = legalizeGlobalNames(module);
 
   LoweringOptions options(module);
   SharedEmitterState emitter(module, options, std::move(globalNames));
+  emitter.collectStats = !statsFile.empty();
   emitter.gatherFiles(false);
 
   if (emitter.options.emitReplicatedOpsToHeader)
@@ -4916,6 +5077,8 @@ static LogicalResult exportVerilogImpl(ModuleOp module, llvm::raw_ostream &os) {
 
   // Finally, emit all the ops we collected.
   emitter.emitOps(list, os, /*parallelize=*/true);
+  if (emitter.collectStats && failed(writeEmissionStats(emitter, statsFile)))
+    return failure();
   return failure(emitter.encounteredError);
 }
 
@@ -4940,7 +5103,7 @@ struct ExportVerilogPass : public ExportVerilogBase<ExportVerilogPass> {
     if (failed(runPipeline(preparePM, getOperation())))
       return signalPassFailure();
 
-    if (failed(exportVerilogImpl(getOperation(), os)))
+    if (failed(exportVerilogImpl(getOperation(), os, statsFile)))
       return signalPassFailure();
   }
 
@@ -4962,22 +5125,14 @@ std::unique_ptr<mlir::Pass> circt::createExportVerilogPass() {
 // Split Emitter
 //===----------------------------------------------------------------------===//
 
+/// Open an output file of a split emission.  The directory of the file must
+/// already exist; see `createOutputDirectories`.
 static std::unique_ptr<llvm::ToolOutputFile>
 createOutputFile(StringRef fileName, StringRef dirname,
                  SharedEmitterState &emitter) {
   // Determine the output path from the output directory and filename.
   SmallString<128> outputFilename(dirname);
   appendPossiblyAbsolutePath(outputFilename, fileName);
-  auto outputDir = llvm::sys::path::parent_path(outputFilename);
-
-  // Create the output directory if needed.
-  std::error_code error = llvm::sys::fs::create_directories(outputDir);
-  if (error) {
-    emitter.designOp.emitError("cannot create output directory \"")
-        << outputDir << "\": " << error.message();
-    emitter.encounteredError = true;
-    return {};
-  }
 
   // Open the output file.
   std::string errorMessage;
@@ -4989,13 +5144,61 @@ createOutputFile(StringRef fileName, StringRef dirname,
   return output;
 }
 
-static void createSplitOutputFile(StringAttr fileName, FileInfo &file,
-                                  StringRef dirname,
-                                  SharedEmitterState &emitter) {
+/// Create the directories of all the files a split emission will write, once
+/// per distinct directory.  Many output files usually share a few directories,
+/// and doing this before the parallel write keeps the workers from issuing a
+/// redundant `mkdir -p` for every single file.
+static void createOutputDirectories(SharedEmitterState &emitter,
+                                    StringRef dirname) {
+  llvm::SetVector<StringRef> directories;
+  SmallVector<SmallString<128>> paths;
+  auto addFile = [&](StringRef fileName) {
+    SmallString<128> &path = paths.emplace_back(dirname);
+    appendPossiblyAbsolutePath(path, fileName);
+  };
+  for (auto &it : emitter.files)
+    addFile(it.first.getValue());
+  for (auto &it : emitter.fileLists)
+    addFile(it.first());
+  for (auto &path : paths)
+    directories.insert(llvm::sys::path::parent_path(path));
+  directories.insert(dirname);
+  directories.remove("");
+
+  for (auto directory : directories) {
+    std::error_code error = llvm::sys::fs::create_directories(directory);
+    if (error) {
+      emitter.designOp.emitError("cannot create output directory \"")
+          << directory << "\": " << error.message();
+      emitter.encounteredError = true;
+    }
+  }
+}
+
+/// Write `contents` to an output file of a split emission, unless the file
+/// already exists with exactly these contents.  Leaving an unchanged file
+/// untouched preserves its modification time, such that downstream tools do
+/// not consider it dirty.
+static void writeOutputFileIfChanged(StringRef fileName, StringRef dirname,
+                                     StringRef contents,
+                                     SharedEmitterState &emitter) {
+  SmallString<128> outputFilename(dirname);
+  appendPossiblyAbsolutePath(outputFilename, fileName);
+  auto existing = llvm::MemoryBuffer::getFile(
+      outputFilename, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+  if (existing && (*existing)->getBuffer() == contents)
+    return;
+
   auto output = createOutputFile(fileName, dirname, emitter);
   if (!output)
     return;
+  output->os() << contents;
+  output->keep();
+}
 
+static void createSplitOutputFile(StringAttr fileName, FileInfo &file,
+                                  StringRef dirname,
+                                  SharedEmitterState &emitter) {
   SharedEmitterState::EmissionList list;
   emitter.collectOpsForFile(file, list,
                             emitter.options.emitReplicatedOpsToHeader);
@@ -5004,18 +5207,33 @@ static void createSplitOutputFile(StringAttr fileName, FileInfo &file,
   // state.  Don't parallelize emission of the ops within this file - we
   // already parallelize per-file emission and we pay a string copy overhead
   // for parallelization.
+  if (emitter.skipUnchangedFiles) {
+    SmallString<0> contents;
+    llvm::raw_svector_ostream os(contents);
+    emitter.emitOps(list, os, /*parallelize=*/false);
+    writeOutputFileIfChanged(fileName, dirname, contents, emitter);
+    return;
+  }
+
+  auto output = createOutputFile(fileName, dirname, emitter);
+  if (!output)
+    return;
   emitter.emitOps(list, output->os(), /*parallelize=*/false);
   output->keep();
 }
 
 static LogicalResult exportSplitVerilogImpl(ModuleOp module,
-                                            StringRef dirname) {
+                                            StringRef dirname,
+                                            StringRef statsFile = {},
+                                            bool skipUnchangedFiles = false) {
   // Prepare the ops in the module for emission and legalize the names that will
   // end up in the output.
   LoweringOptions options(module);
   GlobalNameTable globalNames = legalizeGlobalNames(module);
 
   SharedEmitterState emitter(module, options, std::move(globalNames));
+  emitter.collectStats = !statsFile.empty();
+  emitter.skipUnchangedFiles = skipUnchangedFiles;
   emitter.gatherFiles(true);
 
   if (emitter.options.emitReplicatedOpsToHeader) {
@@ -5035,40 +5253,59 @@ static LogicalResult exportSplitVerilogImpl(ModuleOp module,
     }
   }
 
-  // Emit each file in parallel if context enables it.
-  parallelForEach(module->getContext(), emitter.files.begin(),
-                  emitter.files.end(), [&](auto &it) {
-                    createSplitOutputFile(it.first, it.second, dirname,
-                                          emitter);
-                  });
-
-  // Write the file list.
-  SmallString<128> filelistPath(dirname);
-  llvm::sys::path::append(filelistPath, "filelist.f");
-
-  std::string errorMessage;
-  auto output = mlir::openOutputFile(filelistPath, &errorMessage);
-  if (!output) {
-    module->emitError(errorMessage);
+  // Create the output directories up front, such that the workers below only
+  // have to open and write their files.
+  createOutputDirectories(emitter, dirname);
+  if (emitter.encounteredError)
     return failure();
-  }
-
-  for (const auto &it : emitter.files) {
-    if (it.second.addToFilelist)
-      output->os() << it.first.str() << "\n";
-  }
-  output->keep();
 
-  // Emit the filelists.
-  for (auto &it : emitter.fileLists) {
-    auto output = createOutputFile(it.first(), dirname, emitter);
+  // The file lists only depend on the set of files, so they are written
+  // alongside the emitted files instead of in a serial loop afterwards.
+  SmallVector<llvm::StringMapEntry<SmallVector<StringAttr>> *> fileLists;
+  for (auto &it : emitter.fileLists)
+    fileLists.push_back(&it);
+
+  auto writeFileList = [&](StringRef fileName, ArrayRef<StringAttr> names) {
+    std::string contents;
+    for (auto name : names)
+      contents += (name.getValue() + "\n").str();
+    if (emitter.skipUnchangedFiles)
+      return writeOutputFileIfChanged(fileName, dirname, contents, emitter);
+    auto output = createOutputFile(fileName, dirname, emitter);
     if (!output)
-      continue;
-    for (auto &name : it.second)
-      output->os() << name.str() << "\n";
+      return;
+    output->os() << contents;
     output->keep();
-  }
+  };
+
+  // Emit each file in parallel if context enables it.  The pool of the context
+  // bounds the number of files open at any time.  Diagnostics are reported in
+  // the order of the files, regardless of which worker produced them.
+  auto *context = module->getContext();
+  size_t numFiles = emitter.files.size();
+  mlir::ParallelDiagnosticHandler diagHandler(context);
+  mlir::parallelFor(context, 0, numFiles + 1 + fileLists.size(), [&](size_t i) {
+    diagHandler.setOrderIDForThread(i);
+    if (i < numFiles) {
+      auto &it = *std::next(emitter.files.begin(), i);
+      createSplitOutputFile(it.first, it.second, dirname, emitter);
+    } else if (i == numFiles) {
+      // Write the file list.
+      SmallVector<StringAttr> names;
+      for (auto &it : emitter.files)
+        if (it.second.addToFilelist)
+          names.push_back(it.first);
+      writeFileList("filelist.f", names);
+    } else {
+      // Emit the filelists.
+      auto *it = fileLists[i - numFiles - 1];
+      writeFileList(it->first(), it->second);
+    }
+    diagHandler.eraseOrderIDForThread();
+  });
 
+  if (emitter.collectStats && failed(writeEmissionStats(emitter, statsFile)))
+    return failure();
   return failure(emitter.encounteredError);
 }
 
@@ -5085,8 +5322,9 @@ namespace {
 
 struct ExportSplitVerilogPass
     : public ExportSplitVerilogBase<ExportSplitVerilogPass> {
-  ExportSplitVerilogPass(StringRef directory) {
+  ExportSplitVerilogPass(StringRef directory, bool skipUnchanged) {
     directoryName = directory.str();
+    skipUnchangedFiles = skipUnchanged;
   }
   void runOnOperation() override {
     // Prepare the ops in the module for emission.
@@ -5096,13 +5334,16 @@ struct ExportSplitVerilogPass
     if (failed(runPipeline(preparePM, getOperation())))
       return signalPassFailure();
 
-    if (failed(exportSplitVerilogImpl(getOperation(), directoryName)))
+    if (failed(exportSplitVerilogImpl(getOperation(), directoryName,
+                                      statsFile, skipUnchangedFiles)))
       return signalPassFailure();
   }
 };
 } // end anonymous namespace
 
 std::unique_ptr<mlir::Pass>
-circt::createExportSplitVerilogPass(StringRef directory) {
-  return std::make_unique<ExportSplitVerilogPass>(directory);
+circt::createExportSplitVerilogPass(StringRef directory,
+                                    bool skipUnchangedFiles) {
+  return std::make_unique<ExportSplitVerilogPass>(directory,
+                                                  skipUnchangedFiles);
 }
@@ -18,6 +18,7 @@
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include <atomic>
+#include <mutex>
 
 namespace circt {
 struct LoweringOptions;
@@ -210,6 +211,14 @@ public:
     pointerData = (const void *)data;
   }
 
+  /// Release the string data of this entry once it has been written out.
+  void clearString() {
+    if (const void *ptr = pointerData.dyn_cast<const void *>())
+      free(const_cast<void *>(ptr));
+    pointerData = (const void *)nullptr;
+    length = 0;
+  }
+
   // These move just fine.
   StringOrOpToEmit(StringOrOpToEmit &&rhs)
       : pointerData(rhs.pointerData), length(rhs.length) {
@@ -223,6 +232,29 @@ private:
   size_t length;
 };
 
+/// Statistics about the emission of a single hw.module, recorded when the
+/// emitter is asked to collect them.
+struct ModuleEmissionStats {
+  /// The name of the emitted module.
+  StringAttr moduleName;
+
+  /// Wall time spent emitting the module, in seconds.
+  double wallTime = 0;
+
+  /// Number of bytes of Verilog emitted for the module.
+  uint64_t bytesEmitted = 0;
+
+  /// Number of wire, reg, logic, and localparam declarations emitted.
+  unsigned numDeclarations = 0;
+
+  /// Number of those declarations that are temporaries, i.e. have a name with
+  /// the "_" prefix given to spilled expressions by PrepareForEmission.
+  unsigned numTemporaries = 0;
+
+  /// Deepest nesting of inline subexpressions hit in the ExprEmitter.
+  unsigned maxExpressionDepth = 0;
+};
+
 /// This class tracks the top-level state for the emitters, which is built and
 /// then shared across all per-file emissions that happen in parallel.
 struct SharedEmitterState {
@@ -254,13 +286,20 @@ struct SharedEmitterState {
   // Emitter options extracted from the top-level module.
   const LoweringOptions &options;
 
-  /// This is a set is populated at "gather" time, containing the hw.module
-  /// operations that have a sv.bind in them.
-  SmallPtrSet<Operation *, 8> modulesContainingBinds;
-
   /// Information about renamed global symbols, parameters, etc.
   const GlobalNameTable globalNames;
 
+  /// Whether split emission should leave files whose contents did not change
+  /// untouched on disk.
+  bool skipUnchangedFiles = false;
+
+  /// Whether to record a ModuleEmissionStats entry for every emitted module.
+  bool collectStats = false;
+
+  /// The statistics of the emitted modules, if `collectStats` is set.
+  std::vector<ModuleEmissionStats> moduleStats;
+  std::mutex moduleStatsMutex;
+
   explicit SharedEmitterState(ModuleOp designOp, const LoweringOptions &options,
                               GlobalNameTable globalNames)
       : designOp(designOp), options(options),
@@ -272,6 +311,10 @@ struct SharedEmitterState {
   void collectOpsForFile(const FileInfo &fileInfo, EmissionList &thingsToEmit,
                          bool emitHeader = false);
   void emitOps(EmissionList &thingsToEmit, raw_ostream &os, bool parallelize);
+
+  /// Write the collected module statistics as a JSON array to `os`, sorted by
+  /// module name.
+  void writeStatsJSON(raw_ostream &os);
 };
 
 //===----------------------------------------------------------------------===//
@@ -14,6 +14,7 @@
 #include "ExportVerilogInternals.h"
 #include "circt/Dialect/HW/HWAttributes.h"
 #include "circt/Dialect/HW/HWOps.h"
+#include "mlir/IR/Threading.h"
 
 using namespace circt;
 using namespace sv;
@@ -108,10 +109,17 @@ public:
   GlobalNameTable takeGlobalNameTable() { return std::move(globalNameTable); }
 
 private:
-  /// Check to see if the port names of the specified module conflict with
-  /// keywords or themselves.  If so, add the replacement names to
-  /// globalNameTable.
-  void legalizeModuleNames(HWModuleOp module);
+  /// Check to see if the name of the specified module conflicts with other
+  /// global names or keywords.  If so, set its "verilogName" attribute.
+  void legalizeModuleName(HWModuleOp module);
+
+  /// Check to see if the port, parameter, and declaration names of the
+  /// specified module conflict with keywords or themselves.  If so, rename
+  /// them and add any renamed parameter to `renamedParams`.  This only touches
+  /// the module itself and may run concurrently for different modules.
+  static void legalizeModuleLocalNames(
+      HWModuleOp module,
+      SmallVectorImpl<std::pair<StringAttr, StringAttr>> &renamedParams);
   void legalizeInterfaceNames(InterfaceOp interface);
 
   // Gathers prefixes of enum types by inspecting typescopes in the module.
@@ -149,9 +157,11 @@ GlobalNameResolver::GlobalNameResolver(mlir::ModuleOp topLevel) {
   }
 
   // Legalize module and interface names.
+  SmallVector<HWModuleOp> modules;
   for (auto &op : *topLevel.getBody()) {
     if (auto module = dyn_cast<HWModuleOp>(op)) {
-      legalizeModuleNames(module);
+      legalizeModuleName(module);
+      modules.push_back(module);
       continue;
     }
 
@@ -163,6 +173,17 @@ GlobalNameResolver::GlobalNameResolver(mlir::ModuleOp topLevel) {
     }
   }
 
+  // Legalize the names local to each module in parallel.  Renamed parameters
+  // are collected per module and added to the name table in module order.
+  SmallVector<SmallVector<std::pair<StringAttr, StringAttr>>> renamedParams(
+      modules.size());
+  mlir::parallelFor(topLevel.getContext(), 0, modules.size(), [&](size_t i) {
+    legalizeModuleLocalNames(modules[i], renamedParams[i]);
+  });
+  for (auto [module, params] : llvm::zip(modules, renamedParams))
+    for (auto [oldName, newName] : params)
+      globalNameTable.addRenamedParam(module, oldName, newName.getValue());
+
   // Gather enum prefixes.
   gatherEnumPrefixes(topLevel);
 }
@@ -184,18 +205,24 @@ void GlobalNameResolver::gatherEnumPrefixes(mlir::ModuleOp topLevel) {
   }
 }
 
-/// Check to see if the port names of the specified module conflict with
-/// keywords or themselves.  If so, add the replacement names to
-/// globalNameTable.
-void GlobalNameResolver::legalizeModuleNames(HWModuleOp module) {
-  MLIRContext *ctxt = module.getContext();
+/// Check to see if the name of the specified module conflicts with other
+/// global names or keywords.  If so, set its "verilogName" attribute.
+void GlobalNameResolver::legalizeModuleName(HWModuleOp module) {
   // If the module's symbol itself conflicts, then set a "verilogName" attribute
   // on the module to reflect the name we need to use.
   StringRef oldName = module.getName();
   auto newName = globalNameResolver.getLegalName(oldName);
   if (newName != oldName)
-    module->setAttr("verilogName", StringAttr::get(ctxt, newName));
+    module->setAttr("verilogName",
+                    StringAttr::get(module.getContext(), newName));
+}
 
+/// Check to see if the port, parameter, and declaration names of the specified
+/// module conflict with keywords or themselves.  If so, rename them.
+void GlobalNameResolver::legalizeModuleLocalNames(
+    HWModuleOp module,
+    SmallVectorImpl<std::pair<StringAttr, StringAttr>> &renamedParams) {
+  MLIRContext *ctxt = module.getContext();
   NameCollisionResolver nameResolver;
   auto verilogNameAttr = StringAttr::get(ctxt, "hw.verilogName");
   // Legalize the port names.
@@ -217,7 +244,8 @@ void GlobalNameResolver::legalizeModuleNames(HWModuleOp module) {
     auto paramAttr = param.cast<ParamDeclAttr>();
     auto newName = nameResolver.getLegalName(paramAttr.getName());
     if (newName != paramAttr.getName().getValue())
-      globalNameTable.addRenamedParam(module, paramAttr.getName(), newName);
+      renamedParams.push_back(
+          {paramAttr.getName(), StringAttr::get(ctxt, newName)});
   }
 
   SmallVector<std::pair<Operation *, StringAttr>> declAndNames;
@@ -440,11 +440,17 @@ static bool isMovableDeclaration(Operation *op) {
 //===----------------------------------------------------------------------===//
 
 struct EmittedExpressionState {
+  /// The number of terms in the expression.
   size_t size = 0;
+  /// The number of nested operators in the expression.
+  size_t depth = 0;
   static EmittedExpressionState getBaseState() {
-    return EmittedExpressionState{1};
+    return EmittedExpressionState{1, 0};
+  }
+  void mergeState(const EmittedExpressionState &state) {
+    size += state.size;
+    depth = std::max(depth, state.depth);
   }
-  void mergeState(const EmittedExpressionState &state) { size += state.size; }
 };
 
 /// This class handles information about AST structures of each expressions.
@@ -514,8 +520,8 @@ EmittedExpressionStateManager::getExpressionState(Value v) {
   if (it != expressionStates.end())
     return it->second;
 
-  // Ports.
-  if (auto blockArg = v.dyn_cast<BlockArgument>())
+  // Ports, and reads of wires, which includes spilled expressions.
+  if (v.isa<BlockArgument>() || v.getDefiningOp<ReadInOutOp>())
     return EmittedExpressionState::getBaseState();
 
   EmittedExpressionState state =
@@ -529,6 +535,7 @@ EmittedExpressionStateManager::mergeOperandsStates(Operation *op) {
   EmittedExpressionState state;
   for (auto operand : op->getOperands())
     state.mergeState(getExpressionState(operand));
+  ++state.depth;
 
   return state;
 }
@@ -599,6 +606,15 @@ bool EmittedExpressionStateManager::dispatchHeuristic(Operation &op) {
         return true;
     }
 
+  // Deeply nested expressions are expensive to compile for simulators, while
+  // every spilled wire adds a declaration. Spill once the nesting exceeds the
+  // limit, which restarts the depth count for the users of the wire.
+  if (options.isWireSpillingHeuristicEnabled(
+          LoweringOptions::SpillDeepExpressions) &&
+      getExpressionState(op.getResult(0)).depth >
+          options.wireSpillingDepthLimit)
+    return true;
+
   return false;
 }
 
@@ -247,6 +247,21 @@ namespace {
 
 struct FIRRTLModuleLowering;
 
+/// This is state local to the lowering of a single module body.  Module bodies
+/// are lowered in parallel, each into its own shard, and the shards are merged
+/// into the `CircuitLoweringState` in module order afterwards.  This avoids any
+/// locking in the parallel region.
+struct ModuleLoweringShard {
+  /// The sv::BindOps created inside the module.  These are moved outside of
+  /// the module when the shard is merged.
+  SmallVector<sv::BindOp> binds;
+
+  /// The first location of each unprocessed annotation class in the module,
+  /// in the order these were found.
+  SmallVector<std::pair<StringAttr, Location>> remainingAnnotations;
+  StringSet<> remainingAnnotationClasses;
+};
+
 /// This is state shared across the parallel module lowering logic.
 struct CircuitLoweringState {
   std::atomic<bool> used_PRINTF_COND{false};
@@ -298,17 +313,19 @@ struct CircuitLoweringState {
   }
 
   // Process remaining annotations and emit warnings on unprocessed annotations
-  // still remaining in the annoSet.
+  // still remaining in the annoSet.  This must not be called in parallel.
   void processRemainingAnnotations(Operation *op, const AnnotationSet &annoSet);
 
-  CircuitOp circuitOp;
+  // Record unprocessed annotations remaining in the annoSet in a module shard.
+  // Warnings for these are emitted when the shard is merged.
+  void processRemainingAnnotations(Operation *op, const AnnotationSet &annoSet,
+                                   ModuleLoweringShard &shard);
 
-  // Safely add a BindOp to global mutable state.  This will acquire a lock to
-  // do this safely.
-  void addBind(sv::BindOp op) {
-    std::lock_guard<std::mutex> lock(bindsMutex);
-    binds.push_back(op);
-  }
+  // Merge a module shard into the circuit state.  This must not be called in
+  // parallel.
+  void mergeShard(ModuleLoweringShard &shard);
+
+  CircuitOp circuitOp;
 
   FModuleLike getDut() { return dut; }
   FModuleLike getTestHarness() { return testHarness; }
@@ -354,18 +371,17 @@ private:
   // once about any annotation class.
   StringSet<> pendingAnnotations;
   const bool enableAnnotationWarning;
-  std::mutex annotationPrintingMtx;
+
+  // Warn about an unprocessed annotation class, once per class.
+  void warnRemainingAnnotation(StringAttr annoClass, Location loc);
 
   const bool emitChiselAssertsAsSVA;
   const bool stripMuxPragmas;
 
   // Records any sv::BindOps that are found during the course of execution.
-  // This is unsafe to access directly and should only be used through addBind.
+  // These are gathered from the module shards.
   SmallVector<sv::BindOp> binds;
 
-  // Control access to binds.
-  std::mutex bindsMutex;
-
   // The design-under-test (DUT), if it is found.  This will be set if a
   // "sifive.enterprise.firrtl.MarkDUTAnnotation" exists.
   FModuleLike dut;
@@ -391,57 +407,76 @@ private:
   NLATable *nlaTable = nullptr;
 };
 
+/// Return true if an annotation is okay to be silently dropped by LowerToHW.
+static bool isIgnorableAnnotation(Annotation a) {
+  // The following annotations are okay to be silently dropped at this point.
+  // This can occur for example if an annotation marks something in the IR as
+  // not to be processed by a pass, but that pass hasn't run anyway.
+  return a.isClass(
+      // If the class is `circt.nonlocal`, it's not really an annotation,
+      // but part of a path specifier for another annotation which is
+      // non-local.  We can ignore these path specifiers since there will
+      // be a warning produced for the real annotation.
+      "circt.nonlocal",
+      // The following are either consumed by a pass running before
+      // LowerToHW, or they have no effect if the pass doesn't run at all.
+      // If the accompanying pass runs on the HW dialect, then LowerToHW
+      // should have consumed and processed these into an attribute on the
+      // output.
+      dontObfuscateModuleAnnoClass, noDedupAnnoClass,
+      // The following are inspected (but not consumed) by FIRRTL/GCT
+      // passes that have all run by now. Since no one is responsible for
+      // consuming these, they will linger around and can be ignored.
+      scalaClassAnnoClass, dutAnnoClass, metadataDirectoryAttrName,
+      elaborationArtefactsDirectoryAnnoClass, testBenchDirAnnoClass,
+      subCircuitsTargetDirectoryAnnoClass,
+      // This annotation is used to mark which external modules are
+      // imported blackboxes from the BlackBoxReader pass.
+      blackBoxAnnoClass,
+      // This annotation is used by several GrandCentral passes.
+      extractGrandCentralClass,
+      // The following will be handled while lowering the verification
+      // ops.
+      extractAssertAnnoClass, extractAssumeAnnoClass,
+      extractCoverageAnnoClass,
+      // The following will be handled after lowering FModule ops, since
+      // they are still needed on the circuit until after lowering
+      // FModules.
+      moduleHierAnnoClass, testHarnessHierAnnoClass,
+      blackBoxTargetDirAnnoClass);
+}
+
 void CircuitLoweringState::processRemainingAnnotations(
     Operation *op, const AnnotationSet &annoSet) {
   if (!enableAnnotationWarning || annoSet.empty())
     return;
-  std::lock_guard<std::mutex> lock(annotationPrintingMtx);
+  for (auto a : annoSet)
+    if (!isIgnorableAnnotation(a))
+      warnRemainingAnnotation(a.getClassAttr(), op->getLoc());
+}
 
-  for (auto a : annoSet) {
-    auto inserted = pendingAnnotations.insert(a.getClass());
-    if (!inserted.second)
-      continue;
+void CircuitLoweringState::processRemainingAnnotations(
+    Operation *op, const AnnotationSet &annoSet, ModuleLoweringShard &shard) {
+  if (!enableAnnotationWarning || annoSet.empty())
+    return;
+  for (auto a : annoSet)
+    if (!isIgnorableAnnotation(a) &&
+        shard.remainingAnnotationClasses.insert(a.getClass()).second)
+      shard.remainingAnnotations.push_back({a.getClassAttr(), op->getLoc()});
+}
 
-    // The following annotations are okay to be silently dropped at this point.
-    // This can occur for example if an annotation marks something in the IR as
-    // not to be processed by a pass, but that pass hasn't run anyway.
-    if (a.isClass(
-            // If the class is `circt.nonlocal`, it's not really an annotation,
-            // but part of a path specifier for another annotation which is
-            // non-local.  We can ignore these path specifiers since there will
-            // be a warning produced for the real annotation.
-            "circt.nonlocal",
-            // The following are either consumed by a pass running before
-            // LowerToHW, or they have no effect if the pass doesn't run at all.
-            // If the accompanying pass runs on the HW dialect, then LowerToHW
-            // should have consumed and processed these into an attribute on the
-            // output.
-            dontObfuscateModuleAnnoClass, noDedupAnnoClass,
-            // The following are inspected (but not consumed) by FIRRTL/GCT
-            // passes that have all run by now. Since no one is responsible for
-            // consuming these, they will linger around and can be ignored.
-            scalaClassAnnoClass, dutAnnoClass, metadataDirectoryAttrName,
-            elaborationArtefactsDirectoryAnnoClass, testBenchDirAnnoClass,
-            subCircuitsTargetDirectoryAnnoClass,
-            // This annotation is used to mark which external modules are
-            // imported blackboxes from the BlackBoxReader pass.
-            blackBoxAnnoClass,
-            // This annotation is used by several GrandCentral passes.
-            extractGrandCentralClass,
-            // The following will be handled while lowering the verification
-            // ops.
-            extractAssertAnnoClass, extractAssumeAnnoClass,
-            extractCoverageAnnoClass,
-            // The following will be handled after lowering FModule ops, since
-            // they are still needed on the circuit until after lowering
-            // FModules.
-            moduleHierAnnoClass, testHarnessHierAnnoClass,
-            blackBoxTargetDirAnnoClass))
-      continue;
+void CircuitLoweringState::warnRemainingAnnotation(StringAttr annoClass,
+                                                   Location loc) {
+  if (!pendingAnnotations.insert(annoClass.getValue()).second)
+    return;
+  mlir::emitWarning(loc, "unprocessed annotation:'" + annoClass.getValue() +
+                             "' still remaining after LowerToHW");
+}
 
-    mlir::emitWarning(op->getLoc(), "unprocessed annotation:'" + a.getClass() +
-                                        "' still remaining after LowerToHW");
-  }
+void CircuitLoweringState::mergeShard(ModuleLoweringShard &shard) {
+  binds.append(shard.binds);
+  for (auto [annoClass, loc] : shard.remainingAnnotations)
+    warnRemainingAnnotation(annoClass, loc);
 }
 } // end anonymous namespace
 
@@ -471,9 +506,11 @@ private:
                                       CircuitLoweringState &loweringState);
 
   LogicalResult lowerModuleBody(FModuleOp oldModule,
-                                CircuitLoweringState &loweringState);
+                                CircuitLoweringState &loweringState,
+                                ModuleLoweringShard &shard);
   LogicalResult lowerModuleOperations(hw::HWModuleOp module,
-                                      CircuitLoweringState &loweringState);
+                                      CircuitLoweringState &loweringState,
+                                      ModuleLoweringShard &shard);
 
   void lowerMemoryDecls(ArrayRef<FirMemory> mems,
                         CircuitLoweringState &loweringState);
@@ -663,16 +700,27 @@ void FIRRTLModuleLowering::runOnOperation() {
     lowerMemoryDecls(memories, state);
 
   // Now that we've lowered all of the modules, move the bodies over and
-  // update any instances that refer to the old modules.
+  // update any instances that refer to the old modules.  Each module records
+  // its contributions to the circuit state in its own shard.
+  //
+  // Bodies are spliced into the new module and lowered in place, and the
+  // FIRRTL operations are erased as soon as that module is done, so peak
+  // memory only holds both forms of the modules currently being lowered.  The
+  // empty FIRRTL module shells must stay alive until all bodies are lowered,
+  // since instances read port information from the modules they refer to.
+  SmallVector<ModuleLoweringShard> shards(modulesToProcess.size());
   auto result = mlir::failableParallelForEachN(
       &getContext(), 0, modulesToProcess.size(), [&](auto index) {
-        return lowerModuleBody(modulesToProcess[index], state);
+        return lowerModuleBody(modulesToProcess[index], state, shards[index]);
       });
 
   // If any module bodies failed to lower, return early.
   if (failed(result))
     return signalPassFailure();
 
+  for (auto &shard : shards)
+    state.mergeShard(shard);
+
   // Move binds from inside modules to outside modules.
   for (auto bind : state.binds) {
     bind->moveBefore(bind->getParentOfType<hw::HWModuleOp>());
@@ -708,7 +756,29 @@ void FIRRTLModuleLowering::lowerMemoryDecls(ArrayRef<FirMemory> mems,
 
   Type b1Type = IntegerType::get(&getContext(), 1);
 
+  // Set a name for each memory wrapper module, the combMem is an arbitrary
+  // suffix. It is important to derive the name from the original MemOp name,
+  // to respect the corresponding prefixes. Names are picked serially, in the
+  // sorted order of `mems`, to keep them deterministic.
+  SmallVector<StringAttr> memoryNames;
+  memoryNames.reserve(mems.size());
   for (auto &mem : mems) {
+    auto memoryName = b.getStringAttr(
+        namesp.newName(static_cast<MemOp>(mem.op).getName() + "_combMem"));
+    // Now record this generated name for the corresponding FirMemory name,
+    // because all the memories that have the same FirMemory name, will now use
+    // this new generated name at the Instance Op. Basically this is the name
+    // used for all the deduped memories.
+    state.memoryNameMap[mem.getFirMemoryName()] = memoryName;
+    memoryNames.push_back(memoryName);
+  }
+
+  // Build the generated modules in parallel. These are created detached and
+  // inserted at the bottom of the file in order afterwards.
+  SmallVector<hw::HWModuleGeneratedOp> genOps(mems.size());
+  mlir::parallelFor(&getContext(), 0, mems.size(), [&](size_t index) {
+    auto &mem = mems[index];
+    OpBuilder b(&getContext());
     SmallVector<hw::PortInfo> ports;
     size_t inputPin = 0;
     size_t outputPin = 0;
@@ -781,24 +851,18 @@ void FIRRTLModuleLowering::lowerMemoryDecls(ArrayRef<FirMemory> mems,
         b.getNamedAttr("writeClockIDs", b.getI32ArrayAttr(mem.writeClockIDs))};
 
     // Make the global module for the memory
-    // Set a name for the memory wrapper module, the combMem is an arbitrary
-    // suffix. It is important to derive the name from the original MemOp name,
-    // to respect the corresponding prefixes..
-    auto memoryName = b.getStringAttr(
-        namesp.newName(static_cast<MemOp>(mem.op).getName() + "_combMem"));
-    // Now record this generated name for the corresponding FirMemory name,
-    // because all the memories that have the same FirMemory name, will now use
-    // this new generated name at the Instance Op. Basically this is the name
-    // used for all the deduped memories.
-    state.memoryNameMap[mem.getFirMemoryName()] = memoryName;
     auto genOp = b.create<hw::HWModuleGeneratedOp>(
-        mem.loc, memorySchema, memoryName, ports, StringRef(), ArrayAttr(),
-        genAttrs);
+        mem.loc, memorySchema, memoryNames[index], ports, StringRef(),
+        ArrayAttr(), genAttrs);
     // Also set the appropriate directory.
     if (!mem.isInDut)
       if (auto testBenchDir = state.getTestBenchDirectory())
         genOp->setAttr("output_file", testBenchDir);
-  }
+    genOps[index] = genOp;
+  });
+
+  for (auto genOp : genOps)
+    b.insert(genOp);
 }
 
 /// Emit the file header that defines a bunch of macros.
@@ -1321,7 +1385,8 @@ static SmallVector<SubfieldOp> getAllFieldAccesses(Value structValue,
 /// ports and instances.
 LogicalResult
 FIRRTLModuleLowering::lowerModuleBody(FModuleOp oldModule,
-                                      CircuitLoweringState &loweringState) {
+                                      CircuitLoweringState &loweringState,
+                                      ModuleLoweringShard &shard) {
   auto newModule =
       dyn_cast_or_null<hw::HWModuleOp>(loweringState.getNewModule(oldModule));
   // Don't touch modules if we failed to lower ports.
@@ -1416,7 +1481,7 @@ FIRRTLModuleLowering::lowerModuleBody(FModuleOp oldModule,
   cursor.erase();
 
   // Lower all of the other operations.
-  return lowerModuleOperations(newModule, loweringState);
+  return lowerModuleOperations(newModule, loweringState, shard);
 }
 
 //===----------------------------------------------------------------------===//
@@ -1427,8 +1492,9 @@ namespace {
 
 struct FIRRTLLowering : public FIRRTLVisitor<FIRRTLLowering, LogicalResult> {
 
-  FIRRTLLowering(hw::HWModuleOp module, CircuitLoweringState &circuitState)
-      : theModule(module), circuitState(circuitState),
+  FIRRTLLowering(hw::HWModuleOp module, CircuitLoweringState &circuitState,
+                 ModuleLoweringShard &shard)
+      : theModule(module), circuitState(circuitState), shard(shard),
         builder(module.getLoc(), module.getContext()),
         moduleNamespace(hw::ModuleNamespace(module)),
         backedgeBuilder(builder, module.getLoc()) {}
@@ -1639,6 +1705,7 @@ private:
 
   /// Global state.
   CircuitLoweringState &circuitState;
+  ModuleLoweringShard &shard;
 
   /// This builder is set to the right location for each visit call.
   ImplicitLocOpBuilder builder;
@@ -1697,8 +1764,9 @@ private:
 } // end anonymous namespace
 
 LogicalResult FIRRTLModuleLowering::lowerModuleOperations(
-    hw::HWModuleOp module, CircuitLoweringState &loweringState) {
-  return FIRRTLLowering(module, loweringState).run();
+    hw::HWModuleOp module, CircuitLoweringState &loweringState,
+    ModuleLoweringShard &shard) {
+  return FIRRTLLowering(module, loweringState, shard).run();
 }
 
 // This is the main entrypoint for the lowering pass.
@@ -1716,7 +1784,7 @@ LogicalResult FIRRTLLowering::run() {
     builder.setInsertionPoint(&op);
     builder.setLoc(op.getLoc());
     auto done = succeeded(dispatchVisitor(&op));
-    circuitState.processRemainingAnnotations(&op, AnnotationSet(&op));
+    circuitState.processRemainingAnnotations(&op, AnnotationSet(&op), shard);
     if (done)
       opsToRemove.push_back(&op);
     else {
@@ -3010,7 +3078,7 @@ LogicalResult FIRRTLLowering::visitDecl(InstanceOp oldInstance) {
       bindOp->setAttr("output_file", outputFile);
     // Add the bind to the circuit state.  This will be moved outside of the
     // encapsulating module after all modules have been processed in parallel.
-    circuitState.addBind(bindOp);
+    shard.binds.push_back(bindOp);
   }
 
   // Create the new hw.instance operation.
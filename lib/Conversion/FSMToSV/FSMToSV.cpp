@@ -15,6 +15,7 @@
 #include "circt/Dialect/Seq/SeqOps.h"
 #include "circt/Support/BackedgeBuilder.h"
 #include "mlir/Transforms/RegionUtils.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/TypeSwitch.h"
 
 #include <memory>
@@ -82,6 +83,57 @@ static void cloneConstantsIntoRegion(Region &region, OpBuilder &builder) {
 
 namespace {
 
+// The ways in which the states of a machine can be encoded in its state
+// register.
+enum class StateEncodingKind {
+  // An enum typedef, leaving the choice of values to the SV emitter.
+  Binary,
+  // One bit per state, such that every state is decoded by a single bit.
+  OneHot,
+  // Reflected binary code - consecutive states differ in a single bit.
+  Gray,
+};
+
+// Machines with at most this many states are always binary encoded; the state
+// decoders are small enough that the extra flip-flops of one-hot don't pay off.
+static constexpr size_t kMaxBinaryStates = 4;
+
+// One-hot encoding is only considered up to this number of states.
+static constexpr size_t kMaxOneHotStates = 64;
+
+// One-hot encoding is only considered if the states have this many distinct
+// successors on average at most, which bounds the fan-in of each state bit.
+static constexpr size_t kMaxOneHotFanout = 4;
+
+// Selects an encoding for the states of 'machine'. Machines which only ever
+// advance to the next state in their declaration order behave like counters
+// and are Gray encoded. Otherwise, machines with sparse transitions are one-hot
+// encoded, and dense or very large machines are binary encoded.
+static StateEncodingKind selectStateEncoding(MachineOp machine) {
+  auto states = llvm::to_vector(machine.getBody().getOps<StateOp>());
+  size_t numStates = states.size();
+  if (numStates <= kMaxBinaryStates)
+    return StateEncodingKind::Binary;
+
+  bool isCounter = true;
+  size_t numEdges = 0;
+  for (auto [idx, state] : llvm::enumerate(states)) {
+    for (auto nextState : state.getNextStates()) {
+      if (nextState == state)
+        continue;
+      ++numEdges;
+      if (nextState != states[(idx + 1) % numStates])
+        isCounter = false;
+    }
+  }
+
+  if (isCounter)
+    return StateEncodingKind::Gray;
+  if (numStates <= kMaxOneHotStates && numEdges <= kMaxOneHotFanout * numStates)
+    return StateEncodingKind::OneHot;
+  return StateEncodingKind::Binary;
+}
+
 class StateEncoding {
   // An class for handling state encoding. The class is designed to
   // abstract away how states are selected in case patterns, referred to as
@@ -89,7 +141,7 @@ class StateEncoding {
 
 public:
   StateEncoding(OpBuilder &b, hw::TypeScopeOp typeScope, MachineOp machine,
-                hw::HWModuleOp hwModule);
+                hw::HWModuleOp hwModule, StateEncodingKind kind);
 
   // Get the encoded value for a state.
   Value encode(StateOp state);
@@ -103,6 +155,14 @@ public:
   std::unique_ptr<sv::CasePattern> getCasePattern(StateOp state);
 
 protected:
+  // Creates an enum typedef for the states and an enum value per state.
+  void encodeAsEnum();
+
+  // Creates an integer constant per state, whose value is returned by
+  // 'getStateValue' for the index of the state in the machine.
+  void encodeAsInteger(unsigned width,
+                       llvm::function_ref<APInt(unsigned)> getStateValue);
+
   // Creates a constant value in the module for the given encoded state
   // and records the state value in the mappings. An inner symbol is
   // attached to the wire to avoid it being optimized away.
@@ -123,7 +183,7 @@ protected:
   // A typescope to emit the FSM enum type within.
   hw::TypeScopeOp typeScope;
 
-  // The enum type for the states.
+  // The type of the encoded states - an enum or an integer type.
   Type stateType;
 
   OpBuilder &b;
@@ -132,8 +192,30 @@ protected:
 };
 
 StateEncoding::StateEncoding(OpBuilder &b, hw::TypeScopeOp typeScope,
-                             MachineOp machine, hw::HWModuleOp hwModule)
+                             MachineOp machine, hw::HWModuleOp hwModule,
+                             StateEncodingKind kind)
     : typeScope(typeScope), b(b), machine(machine), hwModule(hwModule) {
+  unsigned numStates = machine.getNumStates();
+  switch (kind) {
+  case StateEncodingKind::Binary:
+    encodeAsEnum();
+    break;
+  case StateEncodingKind::OneHot:
+    encodeAsInteger(numStates, [&](unsigned idx) {
+      return APInt::getOneBitSet(numStates, idx);
+    });
+    break;
+  case StateEncodingKind::Gray: {
+    unsigned width = std::max(1u, llvm::Log2_64_Ceil(numStates));
+    encodeAsInteger(width, [&](unsigned idx) {
+      return APInt(width, idx ^ (idx >> 1));
+    });
+    break;
+  }
+  }
+}
+
+void StateEncoding::encodeAsEnum() {
   Location loc = machine.getLoc();
   llvm::SmallVector<Attribute> stateNames;
 
@@ -167,6 +249,20 @@ StateEncoding::StateEncoding(OpBuilder &b, hw::TypeScopeOp typeScope,
   }
 }
 
+void StateEncoding::encodeAsInteger(
+    unsigned width, llvm::function_ref<APInt(unsigned)> getStateValue) {
+  Location loc = machine.getLoc();
+  stateType = b.getIntegerType(width);
+
+  OpBuilder::InsertionGuard guard(b);
+  b.setInsertionPointToStart(&hwModule.getBody().front());
+  for (auto [idx, state] :
+       llvm::enumerate(machine.getBody().getOps<StateOp>())) {
+    auto constantOp = b.create<hw::ConstantOp>(loc, getStateValue(idx));
+    setEncoding(state, constantOp, /*wire=*/true);
+  }
+}
+
 // Get the encoded value for a state.
 Value StateEncoding::encode(StateOp state) {
   auto it = stateToValue.find(state);
@@ -182,10 +278,13 @@ StateOp StateEncoding::decode(Value value) {
 
 // Returns a case pattern which matches the provided state.
 std::unique_ptr<sv::CasePattern> StateEncoding::getCasePattern(StateOp state) {
-  // Get the field attribute for the state - fetch it through the encoding.
-  auto fieldAttr =
-      cast<hw::EnumConstantOp>(valueToSrcValue[encode(state)].getDefiningOp())
-          .getFieldAttr();
+  // Get the field attribute or the constant value for the state - fetch it
+  // through the encoding.
+  Operation *srcOp = valueToSrcValue[encode(state)].getDefiningOp();
+  if (auto constantOp = dyn_cast<hw::ConstantOp>(srcOp))
+    return std::make_unique<sv::CaseBitPattern>(constantOp.getValue(),
+                                                b.getContext());
+  auto fieldAttr = cast<hw::EnumConstantOp>(srcOp).getFieldAttr();
   return std::make_unique<sv::CaseEnumPattern>(fieldAttr);
 }
 
@@ -212,8 +311,9 @@ void StateEncoding::setEncoding(StateOp state, Value v, bool wire) {
 class MachineOpConverter {
 public:
   MachineOpConverter(OpBuilder &builder, hw::TypeScopeOp typeScope,
-                     MachineOp machineOp)
-      : machineOp(machineOp), typeScope(typeScope), b(builder) {}
+                     MachineOp machineOp, StateEncodingKind encodingKind)
+      : machineOp(machineOp), typeScope(typeScope), encodingKind(encodingKind),
+        b(builder) {}
 
   // Converts the machine op to a hardware module.
   // 1. Creates a HWModuleOp for the machine op, with the same I/O as the FSM +
@@ -320,6 +420,9 @@ private:
   // A typescope to emit the FSM enum type within.
   hw::TypeScopeOp typeScope;
 
+  // The encoding of the state register.
+  StateEncodingKind encodingKind;
+
   OpBuilder &b;
 };
 
@@ -422,8 +525,8 @@ LogicalResult MachineOpConverter::dispatch() {
   auto reset = hwModuleOp.front().getArgument(clkRstIdxs.resetIdx);
 
   // 2) Build state and variable registers.
-  encoding =
-      std::make_unique<StateEncoding>(b, typeScope, machineOp, hwModuleOp);
+  encoding = std::make_unique<StateEncoding>(b, typeScope, machineOp,
+                                             hwModuleOp, encodingKind);
   auto stateType = encoding->getStateType();
 
   auto nextStateWire =
@@ -664,6 +767,19 @@ void FSMToSVPass::runOnOperation() {
   auto b = OpBuilder(module);
   SmallVector<Operation *, 16> opToErase;
 
+  // Without a fixed encoding, one is selected for each machine separately.
+  bool selectEncoding = stateEncoding == "auto";
+  auto encodingKind =
+      llvm::StringSwitch<Optional<StateEncodingKind>>(stateEncoding)
+          .Case("binary", StateEncodingKind::Binary)
+          .Case("one-hot", StateEncodingKind::OneHot)
+          .Case("gray", StateEncodingKind::Gray)
+          .Default(None);
+  if (!selectEncoding && !encodingKind) {
+    module.emitError() << "unknown state encoding '" << stateEncoding << "'";
+    return signalPassFailure();
+  }
+
   // Create a typescope shared by all of the FSMs. This typescope will be
   // emitted in a single separate file to avoid polluting each output file with
   // typedefs.
@@ -680,7 +796,9 @@ void FSMToSVPass::runOnOperation() {
 
   // Traverse all machines and convert.
   for (auto machine : llvm::make_early_inc_range(module.getOps<MachineOp>())) {
-    MachineOpConverter converter(b, typeScope, machine);
+    MachineOpConverter converter(b, typeScope, machine,
+                                 selectEncoding ? selectStateEncoding(machine)
+                                                : *encodingKind);
 
     if (failed(converter.dispatch())) {
       signalPassFailure();
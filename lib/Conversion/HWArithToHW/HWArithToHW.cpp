@@ -101,10 +101,84 @@ static Value extendTypeWidth(OpBuilder &builder, Location loc, Value value,
   return extOp->getOpResult(0);
 }
 
+namespace {
+/// Records the bit extensions created by the lowering. All users of a value
+/// within a block share a single extension to the same width, and a value that
+/// is itself an extension is extended from its source instead, such that
+/// chains of arithmetic do not accumulate nested extensions.
+class ExtensionCache {
+public:
+  Value extend(OpBuilder &builder, Location loc, Value value,
+               unsigned targetWidth, bool signExtension);
+
+private:
+  struct Extension {
+    Value source;
+    bool signExtension;
+  };
+  /// The source of each created extension.
+  DenseMap<Value, Extension> extensionSources;
+  /// The extension of a value to a width, with sign or zero extension.
+  DenseMap<std::tuple<Value, unsigned, bool>, Value> extensions;
+};
+} // namespace
+
+Value ExtensionCache::extend(OpBuilder &builder, Location loc, Value value,
+                             unsigned targetWidth, bool signExtension) {
+  if (value.getType().getIntOrFloatBitWidth() == targetWidth)
+    return value;
+
+  // Extend the source of an extension directly. A zero extended value has a
+  // zero sign bit, so a sign extension of it is a zero extension as well.
+  auto it = extensionSources.find(value);
+  if (it != extensionSources.end() &&
+      (signExtension || !it->second.signExtension)) {
+    value = it->second.source;
+    signExtension = it->second.signExtension;
+  }
+
+  // Reuse an existing extension if it dominates the insertion point.
+  auto &extension = extensions[{value, targetWidth, signExtension}];
+  if (extension) {
+    auto *extensionOp = extension.getDefiningOp();
+    auto *block = builder.getInsertionBlock();
+    auto insertionPoint = builder.getInsertionPoint();
+    if (extensionOp->getBlock() == block &&
+        (insertionPoint == block->end() ||
+         extensionOp->isBeforeInBlock(&*insertionPoint)))
+      return extension;
+  }
+
+  extension = extendTypeWidth(builder, loc, value, targetWidth, signExtension);
+  extensionSources[extension] = {value, signExtension};
+  return extension;
+}
+
 //===----------------------------------------------------------------------===//
 // Conversion patterns
 //===----------------------------------------------------------------------===//
 
+namespace {
+/// Base class for the lowering patterns which extend the operands of an
+/// operation, sharing the extensions with all other patterns.
+template <typename OpTy>
+struct ExtendingOpConversion : public OpConversionPattern<OpTy> {
+  ExtendingOpConversion(TypeConverter &typeConverter, MLIRContext *context,
+                        std::shared_ptr<ExtensionCache> extensions)
+      : OpConversionPattern<OpTy>(typeConverter, context),
+        extensions(std::move(extensions)) {}
+
+protected:
+  Value extend(OpBuilder &builder, Location loc, Value value,
+               unsigned targetWidth, bool signExtension) const {
+    return extensions->extend(builder, loc, value, targetWidth, signExtension);
+  }
+
+private:
+  std::shared_ptr<ExtensionCache> extensions;
+};
+} // namespace
+
 namespace {
 struct ConstantOpLowering : public OpConversionPattern<ConstantOp> {
   using OpConversionPattern<ConstantOp>::OpConversionPattern;
@@ -120,8 +194,8 @@ struct ConstantOpLowering : public OpConversionPattern<ConstantOp> {
 } // namespace
 
 namespace {
-struct DivOpLowering : public OpConversionPattern<DivOp> {
-  using OpConversionPattern<DivOp>::OpConversionPattern;
+struct DivOpLowering : public ExtendingOpConversion<DivOp> {
+  using ExtendingOpConversion<DivOp>::ExtendingOpConversion;
 
   LogicalResult
   matchAndRewrite(DivOp op, OpAdaptor adaptor,
@@ -147,10 +221,10 @@ struct DivOpLowering : public OpConversionPattern<DivOp> {
         rhsType.getWidth() + (signedDivision && !rhsType.isSigned() ? 1 : 0));
 
     // Extend the operands
-    Value lhsValue = extendTypeWidth(rewriter, loc, adaptor.getInputs()[0],
-                                     extendSize, isLhsTypeSigned);
-    Value rhsValue = extendTypeWidth(rewriter, loc, adaptor.getInputs()[1],
-                                     extendSize, rhsType.isSigned());
+    Value lhsValue = extend(rewriter, loc, adaptor.getInputs()[0], extendSize,
+                            isLhsTypeSigned);
+    Value rhsValue = extend(rewriter, loc, adaptor.getInputs()[1], extendSize,
+                            rhsType.isSigned());
 
     Value divResult;
     if (signedDivision)
@@ -174,8 +248,8 @@ struct DivOpLowering : public OpConversionPattern<DivOp> {
 } // namespace
 
 namespace {
-struct CastOpLowering : public OpConversionPattern<CastOp> {
-  using OpConversionPattern<CastOp>::OpConversionPattern;
+struct CastOpLowering : public ExtendingOpConversion<CastOp> {
+  using ExtendingOpConversion<CastOp>::ExtendingOpConversion;
 
   LogicalResult
   matchAndRewrite(CastOp op, OpAdaptor adaptor,
@@ -193,8 +267,8 @@ struct CastOpLowering : public OpConversionPattern<CastOp> {
     } else if (sourceWidth < targetWidth) {
       // bit extensions needed, the type of extension required is determined by
       // the source type only!
-      replaceValue = extendTypeWidth(rewriter, op.getLoc(), adaptor.getIn(),
-                                     targetWidth, isSourceTypeSigned);
+      replaceValue = extend(rewriter, op.getLoc(), adaptor.getIn(),
+                            targetWidth, isSourceTypeSigned);
     } else {
       // bit truncation needed
       replaceValue = extractBits(rewriter, op.getLoc(), adaptor.getIn(),
@@ -237,8 +311,8 @@ static comb::ICmpPredicate lowerPredicate(ICmpPredicate pred, bool isSigned) {
   return comb::ICmpPredicate::eq;
 }
 
-struct ICmpOpLowering : public OpConversionPattern<ICmpOp> {
-  using OpConversionPattern<ICmpOp>::OpConversionPattern;
+struct ICmpOpLowering : public ExtendingOpConversion<ICmpOp> {
+  using ExtendingOpConversion<ICmpOp>::ExtendingOpConversion;
 
   LogicalResult
   matchAndRewrite(ICmpOp op, OpAdaptor adaptor,
@@ -254,10 +328,10 @@ struct ICmpOpLowering : public OpConversionPattern<ICmpOp> {
         pred, cmpSignedness == IntegerType::SignednessSemantics::Signed);
 
     const auto loc = op.getLoc();
-    Value lhsValue = extendTypeWidth(rewriter, loc, adaptor.getLhs(), cmpWidth,
-                                     lhsType.isSigned());
-    Value rhsValue = extendTypeWidth(rewriter, loc, adaptor.getRhs(), cmpWidth,
-                                     rhsType.isSigned());
+    Value lhsValue =
+        extend(rewriter, loc, adaptor.getLhs(), cmpWidth, lhsType.isSigned());
+    Value rhsValue =
+        extend(rewriter, loc, adaptor.getRhs(), cmpWidth, rhsType.isSigned());
 
     auto newOp = rewriter.replaceOpWithNewOp<comb::ICmpOp>(
         op, combPred, lhsValue, rhsValue, false);
@@ -272,8 +346,8 @@ struct ICmpOpLowering : public OpConversionPattern<ICmpOp> {
 
 namespace {
 template <class BinOp, class ReplaceOp>
-struct BinaryOpLowering : public OpConversionPattern<BinOp> {
-  using OpConversionPattern<BinOp>::OpConversionPattern;
+struct BinaryOpLowering : public ExtendingOpConversion<BinOp> {
+  using ExtendingOpConversion<BinOp>::ExtendingOpConversion;
   using OpAdaptor = typename OpConversionPattern<BinOp>::OpAdaptor;
 
   LogicalResult
@@ -287,10 +361,10 @@ struct BinaryOpLowering : public OpConversionPattern<BinOp> {
     auto targetWidth =
         op.getResult().getType().template cast<IntegerType>().getWidth();
 
-    Value lhsValue = extendTypeWidth(rewriter, loc, adaptor.getInputs()[0],
-                                     targetWidth, isLhsTypeSigned);
-    Value rhsValue = extendTypeWidth(rewriter, loc, adaptor.getInputs()[1],
-                                     targetWidth, isRhsTypeSigned);
+    Value lhsValue = this->extend(rewriter, loc, adaptor.getInputs()[0],
+                                  targetWidth, isLhsTypeSigned);
+    Value rhsValue = this->extend(rewriter, loc, adaptor.getInputs()[1],
+                                  targetWidth, isRhsTypeSigned);
     auto newOp =
         rewriter.replaceOpWithNewOp<ReplaceOp>(op, lhsValue, rhsValue, false);
     newOp->setDialectAttrs(op->getDialectAttrs());
@@ -449,11 +523,13 @@ HWArithToHWTypeConverter::HWArithToHWTypeConverter() {
 
 void circt::populateHWArithToHWConversionPatterns(
     HWArithToHWTypeConverter &typeConverter, RewritePatternSet &patterns) {
-  patterns.add<ConstantOpLowering, CastOpLowering, ICmpOpLowering,
+  patterns.add<ConstantOpLowering>(typeConverter, patterns.getContext());
+  auto extensions = std::make_shared<ExtensionCache>();
+  patterns.add<CastOpLowering, ICmpOpLowering,
                BinaryOpLowering<AddOp, comb::AddOp>,
                BinaryOpLowering<SubOp, comb::SubOp>,
                BinaryOpLowering<MulOp, comb::MulOp>, DivOpLowering>(
-      typeConverter, patterns.getContext());
+      typeConverter, patterns.getContext(), extensions);
 }
 
 namespace {
@@ -18,6 +18,7 @@
 #include "circt/Dialect/HW/HWOps.h"
 #include "circt/Dialect/LLHD/IR/LLHDDialect.h"
 #include "circt/Dialect/LLHD/IR/LLHDOps.h"
+#include "circt/Dialect/Seq/SeqOps.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/DialectConversion.h"
@@ -262,6 +263,51 @@ struct ConvertInstance : public OpConversionPattern<InstanceOp> {
   }
 };
 
+/// This works on each register, converting it to a signal which is driven by
+/// an `llhd.reg` on the rising clock edge. The synchronous reset becomes a
+/// gated trigger on the same edge, which takes precedence over the input.
+struct ConvertCompReg : public OpConversionPattern<seq::CompRegOp> {
+  using OpConversionPattern::OpConversionPattern;
+
+  LogicalResult
+  matchAndRewrite(seq::CompRegOp reg, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    Type type = reg.getType();
+    if (!type.isa<IntegerType>())
+      return rewriter.notifyMatchFailure(reg, [&](Diagnostic &diag) {
+        diag << "register type " << type << " is not supported";
+      });
+
+    Location loc = reg.getLoc();
+    auto init = rewriter.create<ConstantOp>(loc, type, 0);
+    auto sig = rewriter.createOrFold<SigOp>(loc, SigType::get(type),
+                                            reg.getName(), init);
+    auto delta = rewriter.create<ConstantTimeOp>(loc, 0, "ns", 1, 0);
+
+    SmallVector<Value, 2> values, triggers, delays, gates;
+    SmallVector<int64_t, 2> modes, gateMask;
+    if (adaptor.getReset()) {
+      values.push_back(adaptor.getResetValue());
+      gates.push_back(adaptor.getReset());
+      gateMask.push_back(gates.size());
+      triggers.push_back(adaptor.getClk());
+      delays.push_back(delta);
+      modes.push_back(static_cast<int64_t>(RegMode::rise));
+    }
+    values.push_back(adaptor.getInput());
+    gateMask.push_back(0);
+    triggers.push_back(adaptor.getClk());
+    delays.push_back(delta);
+    modes.push_back(static_cast<int64_t>(RegMode::rise));
+
+    rewriter.create<llhd::RegOp>(loc, sig, rewriter.getI64ArrayAttr(modes),
+                                 values, triggers, delays, gates,
+                                 rewriter.getI64ArrayAttr(gateMask));
+    rewriter.replaceOpWithNewOp<PrbOp>(reg, type, sig);
+    return success();
+  }
+};
+
 } // namespace
 
 //===----------------------------------------------------------------------===//
@@ -298,8 +344,9 @@ void HWToLLHDPass::runOnOperation() {
   target.addIllegalOp<HWModuleOp>();
   target.addIllegalOp<hw::OutputOp>();
   target.addIllegalOp<InstanceOp>();
+  target.addIllegalOp<seq::CompRegOp>();
 
-  // Rewrite `hw.module`, `hw.output`, and `hw.instance`.
+  // Rewrite `hw.module`, `hw.output`, `hw.instance`, and `seq.compreg`.
   HWToLLHDTypeConverter typeConverter;
   RewritePatternSet patterns(&context);
   mlir::populateFunctionOpInterfaceTypeConversionPattern<HWModuleOp>(
@@ -307,6 +354,7 @@ void HWToLLHDPass::runOnOperation() {
   patterns.add<ConvertHWModule>(&context);
   patterns.add<ConvertInstance>(&context);
   patterns.add<ConvertOutput>(&context);
+  patterns.add<ConvertCompReg>(&context);
   if (failed(applyPartialConversion(module, target, std::move(patterns))))
     signalPassFailure();
 }
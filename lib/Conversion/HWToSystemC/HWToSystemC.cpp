@@ -18,6 +18,7 @@
 #include "mlir/Dialect/EmitC/IR/EmitC.h"
 #include "mlir/IR/BuiltinDialect.h"
 #include "mlir/Transforms/DialectConversion.h"
+#include "llvm/ADT/EquivalenceClasses.h"
 #include "llvm/ADT/TypeSwitch.h"
 
 using namespace mlir;
@@ -38,6 +39,146 @@ namespace {
 struct ConvertHWModule : public OpConversionPattern<HWModuleOp> {
   using OpConversionPattern::OpConversionPattern;
 
+private:
+  /// Partition the outputs of the module into groups whose fan-in cones do not
+  /// share any operations. Constants are not considered shared since they can
+  /// be duplicated. `opGroup` is populated with the group of every operation in
+  /// a fan-in cone.
+  void groupOutputsByCone(HWModuleOp module,
+                          SmallVectorImpl<SmallVector<unsigned>> &groups,
+                          DenseMap<Operation *, unsigned> &opGroup) const {
+    auto *outputOp = module.getBodyBlock()->getTerminator();
+    llvm::EquivalenceClasses<unsigned> cones;
+    DenseMap<Operation *, unsigned> coneOf;
+    SmallVector<Operation *> worklist;
+    for (auto [idx, output] : llvm::enumerate(outputOp->getOperands())) {
+      cones.insert(idx);
+      worklist.push_back(output.getDefiningOp());
+      while (!worklist.empty()) {
+        Operation *op = worklist.pop_back_val();
+        if (!op || isa<hw::ConstantOp>(op))
+          continue;
+        auto [it, inserted] = coneOf.insert({op, idx});
+        if (!inserted) {
+          cones.unionSets(it->second, idx);
+          continue;
+        }
+        for (Value operand : op->getOperands())
+          worklist.push_back(operand.getDefiningOp());
+      }
+    }
+
+    DenseMap<unsigned, unsigned> groupOfLeader;
+    for (unsigned idx = 0, e = outputOp->getNumOperands(); idx < e; ++idx) {
+      auto [it, inserted] =
+          groupOfLeader.insert({cones.getLeaderValue(idx), groups.size()});
+      if (inserted)
+        groups.emplace_back();
+      groups[it->second].push_back(idx);
+    }
+    for (auto [op, cone] : coneOf)
+      opGroup[op] = groupOfLeader.lookup(cones.getLeaderValue(cone));
+  }
+
+  /// Move the body of the module into one systemc.func per group of outputs,
+  /// each registered as an SC_METHOD which is only sensitive to the inputs its
+  /// fan-in cones read. Operations not driving any output end up in the first
+  /// method.
+  void lowerToMethodPerCone(HWModuleOp module, SCModuleOp scModule,
+                            ArrayRef<SmallVector<unsigned>> groups,
+                            const DenseMap<Operation *, unsigned> &opGroup,
+                            ConversionPatternRewriter &rewriter) const {
+    Block *body = module.getBodyBlock();
+    auto *outputOp = body->getTerminator();
+    Location loc = module.getLoc();
+
+    // Create a systemc.func for each group, named after its first output.
+    rewriter.setInsertionPointToStart(scModule.getBodyBlock());
+    ArrayAttr resultNames = module.getResultNames();
+    SmallVector<Block *> blocks;
+    SmallVector<SCFuncOp> funcs;
+    for (auto &group : groups) {
+      auto name = resultNames[group.front()].cast<StringAttr>().getValue();
+      funcs.push_back(rewriter.create<SCFuncOp>(
+          loc, rewriter.getStringAttr("innerLogic_" + name)));
+      blocks.push_back(funcs.back().getBodyBlock());
+    }
+
+    // Move the operations of each cone into the func of its group. Constants
+    // are duplicated into each func using them below.
+    for (Operation &op :
+         llvm::make_early_inc_range(body->without_terminator())) {
+      if (isa<hw::ConstantOp>(op))
+        continue;
+      Block *block = blocks[opGroup.lookup(&op)];
+      op.moveBefore(block, block->end());
+    }
+
+    // Write the output ports at the end of the func of their group.
+    SmallVector<Value> outPorts(
+        llvm::make_filter_range(scModule.getArguments(), [](BlockArgument arg) {
+          return arg.getType().isa<OutputType>();
+        }));
+    for (auto [group, block] : llvm::zip(groups, blocks)) {
+      rewriter.setInsertionPointToEnd(block);
+      for (unsigned idx : group) {
+        Value portValue = outPorts[idx];
+        auto converted = typeConverter->materializeTargetConversion(
+            rewriter, loc, getSignalBaseType(portValue.getType()),
+            outputOp->getOperand(idx));
+        rewriter.create<SignalWriteOp>(outputOp->getLoc(), portValue,
+                                       converted);
+      }
+    }
+
+    for (auto constOp : body->getOps<hw::ConstantOp>()) {
+      for (Block *block : blocks) {
+        auto inBlock = [&](OpOperand &use) {
+          return use.getOwner()->getBlock() == block;
+        };
+        if (llvm::none_of(constOp->getUses(), inBlock))
+          continue;
+        rewriter.setInsertionPointToStart(block);
+        auto *clone = rewriter.clone(*constOp);
+        constOp.getResult().replaceUsesWithIf(clone->getResult(0), inBlock);
+      }
+    }
+
+    // Read the inputs used in each func at its start and register the func
+    // with the inputs it reads as its sensitivities.
+    OpBuilder ctorBuilder =
+        OpBuilder::atBlockBegin(scModule.getOrCreateCtor().getBodyBlock());
+    for (auto [func, block] : llvm::zip(funcs, blocks)) {
+      SmallVector<Value> sensitivityValues;
+      rewriter.setInsertionPointToStart(block);
+      for (unsigned i = 0, e = module.getNumInputs(); i < e; ++i) {
+        Value arg = body->getArgument(i);
+        auto inBlock = [&](OpOperand &use) {
+          return use.getOwner()->getBlock() == block;
+        };
+        if (llvm::none_of(arg.getUses(), inBlock))
+          continue;
+        auto inputRead =
+            rewriter.create<SignalReadOp>(loc, scModule.getArgument(i))
+                .getResult();
+        auto converted = typeConverter->materializeSourceConversion(
+            rewriter, loc, arg.getType(), inputRead);
+        arg.replaceUsesWithIf(converted, inBlock);
+        sensitivityValues.push_back(scModule.getArgument(i));
+      }
+
+      ctorBuilder.create<MethodOp>(loc, func.getHandle());
+      if (!sensitivityValues.empty())
+        ctorBuilder.create<SensitiveOp>(loc, sensitivityValues);
+    }
+
+    // Erase the HW OutputOp and module.
+    outputOp->dropAllReferences();
+    rewriter.eraseOp(outputOp);
+    rewriter.eraseOp(module);
+  }
+
+public:
   LogicalResult
   matchAndRewrite(HWModuleOp module, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
@@ -71,6 +212,20 @@ struct ConvertHWModule : public OpConversionPattern<HWModuleOp> {
 
     scModule.setAllArgAttrs(portAttrs);
 
+    // Split the combinational logic into one SC_METHOD per group of outputs
+    // with disjoint fan-in cones, such that the SystemC kernel only
+    // re-evaluates the logic affected by an input change. The instance lowering needs a
+    // single update function to insert its signal accesses into, so modules
+    // with instances are kept in one method.
+    SmallVector<SmallVector<unsigned>> outputGroups;
+    DenseMap<Operation *, unsigned> opGroup;
+    if (module.getBodyBlock()->getOps<InstanceOp>().empty())
+      groupOutputsByCone(module, outputGroups, opGroup);
+    if (outputGroups.size() > 1) {
+      lowerToMethodPerCone(module, scModule, outputGroups, opGroup, rewriter);
+      return success();
+    }
+
     // Create a systemc.func operation inside the module after the ctor.
     // TODO: implement logic to extract a better name and properly unique it.
     rewriter.setInsertionPointToStart(scModule.getBodyBlock());
@@ -25,8 +25,10 @@
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Transforms/DialectConversion.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/MathExtras.h"
 #include <optional>
@@ -44,11 +46,28 @@ static Type tupleToStruct(TypeRange types) {
   return toValidType(mlir::TupleType::get(types[0].getContext(), types));
 }
 
+// The hardware implementing the slots of a handshake.buffer.
+enum class BufferImplementation {
+  // A relay station per slot, which registers both the valid and the ready
+  // path at the cost of a second data register.
+  Skid,
+  // A single register per slot. The ready path is combinational through the
+  // whole buffer.
+  Pipeline,
+};
+
 // Shared state used by various functions; captured in a struct to reduce the
 // number of arguments that we have to pass around.
 struct HandshakeLoweringState {
   ModuleOp parentModule;
   NameUniquer nameUniquer;
+  // The module holding the submodules of previously lowered functions, if
+  // different from the module 'parentModule' is lowered into.
+  ModuleOp topModule = {};
+  BufferImplementation bufferImplementation = BufferImplementation::Skid;
+  // Buffers with at least this many slots are built as a FIFO on top of a
+  // memory, if non-zero.
+  unsigned sramBufferThreshold = 0;
 };
 
 // A type converter is needed to perform the in-flight materialization of "raw"
@@ -257,9 +276,12 @@ static Operation *checkSubModuleOp(mlir::ModuleOp parentModule,
   return nullptr;
 }
 
-static Operation *checkSubModuleOp(mlir::ModuleOp parentModule,
+static Operation *checkSubModuleOp(HandshakeLoweringState &ls,
                                    Operation *oldOp) {
-  auto *moduleOp = checkSubModuleOp(parentModule, getSubModuleName(oldOp));
+  auto modName = getSubModuleName(oldOp);
+  auto *moduleOp = checkSubModuleOp(ls.parentModule, modName);
+  if (!moduleOp && ls.topModule)
+    moduleOp = checkSubModuleOp(ls.topModule, modName);
 
   if (isa<handshake::InstanceOp>(oldOp))
     assert(moduleOp &&
@@ -724,7 +746,7 @@ public:
     // Check if a submodule has already been created for the op. If so,
     // instantiate the submodule. Else, run the pattern-defined module
     // builder.
-    hw::HWModuleLike implModule = checkSubModuleOp(ls.parentModule, op);
+    hw::HWModuleLike implModule = checkSubModuleOp(ls, op);
     if (!implModule) {
       auto portInfo = ModulePortInfo(getPortInfoForOp(op));
 
@@ -952,6 +974,8 @@ public:
 
 private:
   OpBuilder &submoduleBuilder;
+
+protected:
   HandshakeLoweringState &ls;
 };
 
@@ -1615,14 +1639,27 @@ public:
     auto output = unwrappedIO.outputs[0];
     InputHandshake lastStage;
     SmallVector<int64_t> initValues;
+    Type dataType = toValidType(op.getDataType());
+    unsigned numSlots = op.getNumSlots();
 
     // For now, always build seq buffers.
     if (op.getInitValues())
       initValues = op.getInitValueArray();
 
-    lastStage =
-        buildSeqBufferLogic(s, bb, toValidType(op.getDataType()),
-                            op.getNumSlots(), input, output, initValues);
+    // Deep buffers are cheaper in memory than in registers. Memories cannot
+    // hold initial tokens, and are only built for non-empty integer data.
+    unsigned sramThreshold = ls.sramBufferThreshold;
+    bool isIntegerData = dataType.isa<IntegerType>() &&
+                         dataType.getIntOrFloatBitWidth() != 0;
+    if (sramThreshold != 0 && numSlots >= std::max(sramThreshold, 2u) &&
+        initValues.empty() && isIntegerData)
+      lastStage = buildSRAMBufferLogic(s, bb, dataType, numSlots, input);
+    else if (ls.bufferImplementation == BufferImplementation::Pipeline)
+      lastStage = buildPipelineBufferLogic(s, bb, dataType, numSlots, input,
+                                           initValues);
+    else
+      lastStage = buildSeqBufferLogic(s, bb, dataType, numSlots, input, output,
+                                      initValues);
 
     // Connect the last stage to the output handshake.
     output.data->setValue(lastStage.data);
@@ -1753,6 +1790,111 @@ public:
 
     return currentStage;
   };
+
+  // Builds a chain of plain pipeline registers. Each slot is ready whenever
+  // it is empty or its successor is ready, which registers the valid path
+  // only.
+  InputHandshake
+  buildPipelineBufferLogic(RTLBuilder &s, BackedgeBuilder &bb, Type dataType,
+                           unsigned size, InputHandshake &input,
+                           llvm::ArrayRef<int64_t> initValues) const {
+    InputHandshake preStage = input;
+    for (unsigned i = 0; i < size; ++i) {
+      bool isInitialized = i < initValues.size();
+      auto regName = [&](StringRef name) {
+        return s.b.getStringAttr(name + std::to_string(i) + "_reg");
+      };
+
+      InputHandshake stage;
+      stage.ready = std::make_shared<Backedge>(bb.get(s.b.getI1Type()));
+      auto validBE = bb.get(s.b.getI1Type());
+      auto validReg =
+          s.reg(regName("valid"), validBE, s.constant(1, isInitialized));
+      auto emptyOrReady = s.bOr({s.bNot(validReg), *stage.ready});
+      preStage.ready->setValue(emptyOrReady);
+      validBE.setValue(s.mux(emptyOrReady, {validReg, preStage.valid}));
+
+      Value initValue =
+          isInitialized
+              ? s.constant(dataType.getIntOrFloatBitWidth(), initValues[i])
+              : createZeroDataConst(s, s.loc, dataType);
+      auto dataBE = bb.get(dataType);
+      auto dataReg = s.reg(regName("data"),
+                           s.mux(emptyOrReady, {dataBE, preStage.data}),
+                           initValue);
+      dataBE.setValue(dataReg);
+
+      stage.valid = validReg;
+      stage.data = dataReg;
+      preStage = stage;
+    }
+    return preStage;
+  }
+
+  // Builds a circular FIFO on top of a memory with 'size' entries. The head
+  // of the FIFO is read combinationally, such that a token is available in
+  // the cycle after it was written.
+  InputHandshake buildSRAMBufferLogic(RTLBuilder &s, BackedgeBuilder &bb,
+                                      Type dataType, unsigned size,
+                                      InputHandshake &input) const {
+    unsigned ptrWidth = llvm::Log2_64_Ceil(size);
+    unsigned countWidth = llvm::Log2_64_Ceil(size + 1);
+    auto ptrType = s.b.getIntegerType(ptrWidth);
+    auto countType = s.b.getIntegerType(countWidth);
+
+    InputHandshake output;
+    output.ready = std::make_shared<Backedge>(bb.get(s.b.getI1Type()));
+
+    auto countBE = bb.get(countType);
+    auto count = s.reg("count_reg", countBE, s.constant(countWidth, 0));
+    auto notEmpty = s.cmp(count, s.constant(countWidth, 0),
+                          comb::ICmpPredicate::ne, "notEmpty");
+    auto notFull = s.cmp(count, s.constant(countWidth, size),
+                         comb::ICmpPredicate::ne, "notFull");
+    input.ready->setValue(notFull);
+    output.valid = notEmpty;
+
+    auto doWrite = s.bAnd({input.valid, notFull}, "doWrite");
+    auto doRead = s.bAnd({*output.ready, notEmpty}, "doRead");
+
+    // Advance a pointer by one entry if 'enable' is asserted, wrapping around
+    // at the end of the memory.
+    auto buildPointer = [&](StringRef name, Value enable) {
+      auto ptrBE = bb.get(ptrType);
+      auto ptr = s.reg(name, ptrBE, s.constant(ptrWidth, 0));
+      auto isLast = s.cmp(ptr, s.constant(ptrWidth, size - 1),
+                          comb::ICmpPredicate::eq);
+      auto incremented =
+          s.b.create<comb::AddOp>(s.loc, ptr, s.constant(ptrWidth, 1), false);
+      auto next = s.mux(isLast, {incremented, s.constant(ptrWidth, 0)});
+      ptrBE.setValue(s.mux(enable, {ptr, next}));
+      return ptr;
+    };
+    auto writePtr = buildPointer("write_ptr_reg", doWrite);
+    auto readPtr = buildPointer("read_ptr_reg", doRead);
+
+    // The count only changes if a token enters or leaves the FIFO, but not
+    // both.
+    auto one = s.constant(countWidth, 1);
+    auto countUp = s.b.create<comb::AddOp>(s.loc, count, one, false);
+    auto countDown = s.b.create<comb::SubOp>(s.loc, count, one, false);
+    auto writeOnly = s.bAnd({doWrite, s.bNot(doRead)});
+    auto readOnly = s.bAnd({doRead, s.bNot(doWrite)});
+    countBE.setValue(
+        s.mux(writeOnly, {s.mux(readOnly, {count, countDown}), countUp}));
+
+    auto memory = s.b.create<seq::HLMemOp>(
+        s.loc, s.clk, s.rst, "_handshake_fifo",
+        llvm::SmallVector<int64_t>{size}, dataType);
+    s.b.create<seq::WritePortOp>(s.loc, memory.getHandle(),
+                                 ValueRange{writePtr}, input.data, doWrite,
+                                 /*latency=*/1);
+    output.data =
+        s.b.create<seq::ReadPortOp>(s.loc, memory.getHandle(),
+                                    ValueRange{readPtr}, notEmpty,
+                                    /*latency=*/0);
+    return output;
+  }
 };
 
 class IndexCastConversionPattern
@@ -1788,7 +1930,7 @@ public:
   matchAndRewrite(T op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
 
-    hw::HWModuleLike implModule = checkSubModuleOp(ls.parentModule, op);
+    hw::HWModuleLike implModule = checkSubModuleOp(ls, op);
     if (!implModule) {
       auto portInfo = ModulePortInfo(getPortInfoForOp(op));
       implModule = submoduleBuilder.create<hw::HWModuleExternOp>(
@@ -1858,10 +2000,11 @@ public:
 // HW Top-module Related Functions
 //===----------------------------------------------------------------------===//
 
-static LogicalResult convertFuncOp(ESITypeConverter &typeConverter,
-                                   ConversionTarget &target,
-                                   handshake::FuncOp op,
-                                   OpBuilder &moduleBuilder) {
+static LogicalResult
+convertFuncOp(ESITypeConverter &typeConverter, ConversionTarget &target,
+              handshake::FuncOp op, OpBuilder &moduleBuilder,
+              BufferImplementation bufferImplementation,
+              unsigned sramBufferThreshold, ModuleOp topModule = {}) {
 
   std::map<std::string, unsigned> instanceNameCntr;
   NameUniquer instanceUniquer = [&](Operation *op) {
@@ -1878,7 +2021,8 @@ static LogicalResult convertFuncOp(ESITypeConverter &typeConverter,
   };
 
   auto ls = HandshakeLoweringState{op->getParentOfType<mlir::ModuleOp>(),
-                                   instanceUniquer};
+                                   instanceUniquer, bufferImplementation,
+                                   sramBufferThreshold, topModule};
   RewritePatternSet patterns(op.getContext());
   patterns.insert<FuncOpConversionPattern, ReturnConversionPattern>(
       op.getContext());
@@ -1927,6 +2071,18 @@ public:
   void runOnOperation() override {
     mlir::ModuleOp mod = getOperation();
 
+    auto bufferImpl =
+        llvm::StringSwitch<std::optional<BufferImplementation>>(
+            bufferImplementation)
+            .Case("skid", BufferImplementation::Skid)
+            .Case("pipeline", BufferImplementation::Pipeline)
+            .Default(std::nullopt);
+    if (!bufferImpl) {
+      mod.emitError() << "unknown buffer implementation '"
+                      << bufferImplementation << "'";
+      return signalPassFailure();
+    }
+
     // Lowering to HW requires that every value is used exactly once. Check
     // whether this precondition is met, and if not, exit.
     for (auto f : mod.getOps<handshake::FuncOp>()) {
@@ -1948,28 +2104,22 @@ public:
       return;
     }
 
-    ESITypeConverter typeConverter;
-    ConversionTarget target(getContext());
-    // All top-level logic of a handshake module will be the interconnectivity
-    // between instantiated modules.
-    target.addLegalOp<hw::HWModuleOp, hw::OutputOp, hw::InstanceOp>();
-    target
-        .addIllegalDialect<handshake::HandshakeDialect, arith::ArithDialect>();
-
     // Convert the handshake.func operations in post-order wrt. the instance
     // graph. This ensures that any referenced submodules (through
     // handshake.instance) has already been lowered, and their HW module
-    // equivalents are available.
+    // equivalents are available. Functions of the same level in the instance
+    // graph do not reference each other and are converted concurrently.
     OpBuilder submoduleBuilder(mod.getContext());
     submoduleBuilder.setInsertionPointToStart(mod.getBody());
-    for (auto &funcName : llvm::reverse(sortedFuncs)) {
-      auto funcOp = mod.lookupSymbol<handshake::FuncOp>(funcName);
-      assert(funcOp && "handshake.func not found in module!");
-      if (failed(
-              convertFuncOp(typeConverter, target, funcOp, submoduleBuilder))) {
-        signalPassFailure();
-        return;
+    for (auto &level : getInstanceGraphLevels(uses, sortedFuncs)) {
+      SmallVector<handshake::FuncOp> funcOps;
+      for (auto &funcName : level) {
+        auto funcOp = mod.lookupSymbol<handshake::FuncOp>(funcName);
+        assert(funcOp && "handshake.func not found in module!");
+        funcOps.push_back(funcOp);
       }
+      if (failed(convertLevel(funcOps, submoduleBuilder, *bufferImpl)))
+        return signalPassFailure();
     }
 
     // Second stage: Convert any handshake.extmemory operations and the
@@ -1978,9 +2128,108 @@ public:
       if (failed(convertExtMemoryOps(hwModule)))
         return signalPassFailure();
   }
+
+private:
+  SmallVector<SmallVector<std::string>>
+  getInstanceGraphLevels(handshake::InstanceGraph &uses,
+                         ArrayRef<std::string> sortedFuncs);
+
+  // Converts the functions of a single level of the instance graph.
+  LogicalResult convertLevel(ArrayRef<handshake::FuncOp> funcs,
+                             OpBuilder &submoduleBuilder,
+                             BufferImplementation bufferImpl);
 };
 } // end anonymous namespace
 
+// Groups the functions of 'sortedFuncs' into levels, such that each function
+// only instantiates functions of earlier levels.
+SmallVector<SmallVector<std::string>> HandshakeToHWPass::getInstanceGraphLevels(
+    handshake::InstanceGraph &uses, ArrayRef<std::string> sortedFuncs) {
+  llvm::StringMap<unsigned> levelOf;
+  SmallVector<SmallVector<std::string>> levels;
+  for (auto &funcName : llvm::reverse(sortedFuncs)) {
+    unsigned level = 0;
+    for (auto &callee : uses[funcName])
+      level = std::max(level, levelOf[callee] + 1);
+    levelOf[funcName] = level;
+    if (levels.size() <= level)
+      levels.resize(level + 1);
+    levels[level].push_back(funcName);
+  }
+  return levels;
+}
+
+LogicalResult HandshakeToHWPass::convertLevel(ArrayRef<handshake::FuncOp> funcs,
+                                              OpBuilder &submoduleBuilder,
+                                              BufferImplementation bufferImpl) {
+  mlir::ModuleOp mod = getOperation();
+  auto convert = [&](handshake::FuncOp funcOp, OpBuilder &builder,
+                     ModuleOp topModule) {
+    ESITypeConverter typeConverter;
+    ConversionTarget target(getContext());
+    // All top-level logic of a handshake module will be the
+    // interconnectivity between instantiated modules.
+    target.addLegalOp<hw::HWModuleOp, hw::OutputOp, hw::InstanceOp>();
+    target
+        .addIllegalDialect<handshake::HandshakeDialect, arith::ArithDialect>();
+    return convertFuncOp(typeConverter, target, funcOp, builder, bufferImpl,
+                         sramBufferThreshold, topModule);
+  };
+
+  // Predeclarations are resolved across the whole module, which only the
+  // serial conversion supports.
+  bool hasPredeclarations = llvm::any_of(funcs, [](handshake::FuncOp funcOp) {
+    return funcOp->hasAttr(kPredeclarationAttr);
+  });
+  if (funcs.size() < 2 || hasPredeclarations ||
+      !getContext().isMultithreadingEnabled()) {
+    for (auto funcOp : funcs)
+      if (failed(convert(funcOp, submoduleBuilder, {})))
+        return failure();
+    return success();
+  }
+
+  // Move each function into a module of its own, such that the conversions
+  // only ever modify their own module, and read the top-level module.
+  SmallVector<ModuleOp> scratchModules;
+  for (auto funcOp : funcs) {
+    OpBuilder builder(funcOp);
+    auto scratch = builder.create<ModuleOp>(funcOp.getLoc());
+    funcOp->moveBefore(scratch.getBody(), scratch.getBody()->end());
+    scratchModules.push_back(scratch);
+  }
+  auto result = failableParallelForEach(
+      &getContext(), scratchModules, [&](ModuleOp scratch) {
+        auto funcOp = *scratch.getOps<handshake::FuncOp>().begin();
+        OpBuilder builder(&getContext());
+        builder.setInsertionPointToStart(scratch.getBody());
+        return convert(funcOp, builder, mod);
+      });
+  if (failed(result))
+    return failure();
+
+  // Merge the modules back in order. A submodule generated by several
+  // functions is identical in all of them, as its name encodes everything
+  // it depends on, so only the first one is kept.
+  for (auto scratch : scratchModules) {
+    auto *funcModule = &scratch.getBody()->back();
+    for (auto &op : llvm::make_early_inc_range(
+             scratch.getBody()->without_terminator())) {
+      if (&op == funcModule)
+        continue;
+      auto name = SymbolTable::getSymbolName(&op);
+      if (checkSubModuleOp(mod, name))
+        op.erase();
+      else
+        op.moveBefore(submoduleBuilder.getInsertionBlock(),
+                      submoduleBuilder.getInsertionPoint());
+    }
+    funcModule->moveBefore(scratch);
+    scratch.erase();
+  }
+  return success();
+}
+
 std::unique_ptr<mlir::Pass> circt::createHandshakeToHWPass() {
   return std::make_unique<HandshakeToHWPass>();
 }
@@ -1045,17 +1045,27 @@ struct InstOpConversion : public ConvertToLLVMPattern {
                             "addSigStructElement", addSigStructElemFuncTy);
 
     // Get or insert allocProc library call definition.
-    auto allocProcFuncTy =
-        LLVM::LLVMFunctionType::get(voidTy, {i8PtrTy, i8PtrTy, i8PtrTy});
+    // Signature: (i8* state, i8* owner, i8* procState, i64 size) -> void
+    auto allocProcFuncTy = LLVM::LLVMFunctionType::get(
+        voidTy, {i8PtrTy, i8PtrTy, i8PtrTy, i64Ty});
     auto allocProcFunc = getOrInsertFunction(module, rewriter, op->getLoc(),
                                              "allocProc", allocProcFuncTy);
 
     // Get or insert allocEntity library call definition.
-    auto allocEntityFuncTy =
-        LLVM::LLVMFunctionType::get(voidTy, {i8PtrTy, i8PtrTy, i8PtrTy});
+    // Signature: (i8* state, i8* owner, i8* entityState, i64 size) -> void
+    auto allocEntityFuncTy = LLVM::LLVMFunctionType::get(
+        voidTy, {i8PtrTy, i8PtrTy, i8PtrTy, i64Ty});
     auto allocEntityFunc = getOrInsertFunction(
         module, rewriter, op->getLoc(), "allocEntity", allocEntityFuncTy);
 
+    // Register a signal struct persisted in the state of a process.
+    // Signature: (i8* state, i8* owner, i64 offset) -> void
+    auto addProcSigFuncTy =
+        LLVM::LLVMFunctionType::get(voidTy, {i8PtrTy, i8PtrTy, i64Ty});
+    auto addProcSigFunc = getOrInsertFunction(
+        module, rewriter, op->getLoc(), "addProcPersistedSignal",
+        addProcSigFuncTy);
+
     Value initStatePtr = initFunc.getArgument(0);
 
     // Get a builder for the init function.
@@ -1128,7 +1138,7 @@ struct InstOpConversion : public ConvertToLLVMPattern {
       // Add reg state pointer to global state.
       initBuilder.create<LLVM::CallOp>(
           op->getLoc(), llvm::None, SymbolRefAttr::get(allocEntityFunc),
-          ArrayRef<Value>({initStatePtr, owner, regMall}));
+          ArrayRef<Value>({initStatePtr, owner, regMall, regSize}));
 
       // Index of the signal in the entity's signal table.
       int initCounter = 0;
@@ -1346,10 +1356,35 @@ struct InstOpConversion : public ConvertToLLVMPattern {
       initBuilder.create<LLVM::StoreOp>(op->getLoc(), sensesBC,
                                         procStateSensesPtr);
 
-      std::array<Value, 3> allocProcArgs({initStatePtr, owner, procStateMall});
+      std::array<Value, 4> allocProcArgs(
+          {initStatePtr, owner, procStateMall, procStateSize});
       initBuilder.create<LLVM::CallOp>(op->getLoc(), llvm::None,
                                        SymbolRefAttr::get(allocProcFunc),
                                        allocProcArgs);
+
+      // Tell the state where the persisted signal structs are, as they point
+      // into the signal values.
+      auto sigTy = getLLVMSigType(&getDialect());
+      auto persistenceTy = procStatePtrTy.getElementType()
+                               .cast<LLVM::LLVMStructType>()
+                               .getBody()[3]
+                               .cast<LLVM::LLVMStructType>();
+      auto threeC = initBuilder.create<LLVM::ConstantOp>(
+          op->getLoc(), i32Ty, rewriter.getI32IntegerAttr(3));
+      for (auto &elem : llvm::enumerate(persistenceTy.getBody())) {
+        if (elem.value() != sigTy)
+          continue;
+        auto indexC = initBuilder.create<LLVM::ConstantOp>(
+            op->getLoc(), i32Ty, rewriter.getI32IntegerAttr(elem.index()));
+        auto sigGep = initBuilder.create<LLVM::GEPOp>(
+            op->getLoc(), LLVM::LLVMPointerType::get(sigTy), procStateNullPtr,
+            ArrayRef<Value>({zeroC, threeC, indexC}));
+        auto sigOffset =
+            initBuilder.create<LLVM::PtrToIntOp>(op->getLoc(), i64Ty, sigGep);
+        initBuilder.create<LLVM::CallOp>(
+            op->getLoc(), llvm::None, SymbolRefAttr::get(addProcSigFunc),
+            ArrayRef<Value>({initStatePtr, owner, sigOffset}));
+      }
     }
 
     rewriter.eraseOp(op);
@@ -504,6 +504,8 @@ LogicalResult BuildOpGroups::buildOp(PatternRewriter &rewriter,
                             loweringState().blockName(succBlock.value());
     auto groupOp = calyx::createGroup<calyx::GroupOp>(rewriter, getComponent(),
                                                       brOp.getLoc(), groupName);
+    // The group only writes registers, which takes a single cycle.
+    calyx::setStaticLatency(groupOp, 1);
     // Fetch block argument registers associated with the basic block
     auto dstBlockArgRegs =
         getState<ComponentLoweringState>().getBlockArgRegs(succBlock.value());
@@ -534,6 +536,8 @@ LogicalResult BuildOpGroups::buildOp(PatternRewriter &rewriter,
       getState<ComponentLoweringState>().getUniqueName("ret_assign");
   auto groupOp = calyx::createGroup<calyx::GroupOp>(rewriter, getComponent(),
                                                     retOp.getLoc(), groupName);
+  // The group only writes registers, which takes a single cycle.
+  calyx::setStaticLatency(groupOp, 1);
   for (auto op : enumerate(retOp.getOperands())) {
     auto reg = getState<ComponentLoweringState>().getReturnReg(op.index());
     calyx::buildAssignmentsForRegisterWrite(
@@ -909,13 +913,41 @@ class BuildWhileGroups : public calyx::FuncOpPartialLoweringPattern {
   }
 };
 
+/// The cells and component ports which a group reads from and drives,
+/// including those of the combinational groups it will have inlined. Cells
+/// are represented by their first result.
+struct GroupFootprint {
+  DenseSet<Value> reads;
+  DenseSet<Value> writes;
+
+  /// Returns whether the groups of 'this' and 'other' may not execute in
+  /// parallel.
+  bool conflictsWith(const GroupFootprint &other) const {
+    auto intersects = [](const DenseSet<Value> &lhs,
+                         const DenseSet<Value> &rhs) {
+      return llvm::any_of(lhs, [&](Value v) { return rhs.contains(v); });
+    };
+    return intersects(writes, other.writes) ||
+           intersects(writes, other.reads) || intersects(reads, other.writes);
+  }
+};
+
 /// Builds a control schedule by traversing the CFG of the function and
 /// associating this with the previously created groups.
 /// For simplicity, the generated control flow is expanded for all possible
 /// paths in the input DAG. This elaborated control flow is later reduced in
 /// the runControlFlowSimplification passes.
 class BuildControl : public calyx::FuncOpPartialLoweringPattern {
-  using FuncOpPartialLoweringPattern::FuncOpPartialLoweringPattern;
+public:
+  BuildControl(MLIRContext *context, LogicalResult &resRef,
+               DenseMap<FuncOp, calyx::ComponentOp> &map,
+               calyx::CalyxLoweringState &state, unsigned maxParallelGroups)
+      : FuncOpPartialLoweringPattern(context, resRef, map, state),
+        maxParallelGroups(maxParallelGroups) {}
+
+private:
+  /// The maximum number of groups of a basic block that are run in parallel.
+  unsigned maxParallelGroups;
 
   LogicalResult
   partiallyLowerFuncToComp(FuncOp funcOp,
@@ -929,9 +961,80 @@ class BuildControl : public calyx::FuncOpPartialLoweringPattern {
                            nullptr, entryBlock);
   }
 
-private:
-  /// Sequentially schedules the groups that registered themselves with
-  /// 'block'.
+  /// Returns the cell or component port behind 'port'.
+  static Value getResource(Value port) {
+    if (auto *op = port.getDefiningOp())
+      return op->getResult(0);
+    return port;
+  }
+
+  /// Returns the footprint of 'group'.
+  GroupFootprint getFootprint(calyx::GroupOp group) const {
+    GroupFootprint footprint;
+    SmallVector<calyx::GroupInterface> worklist = {group};
+    DenseSet<Operation *> visited = {group};
+    while (!worklist.empty()) {
+      auto recGroup = worklist.pop_back_val();
+      for (auto assignOp : recGroup.getBody()->getOps<calyx::AssignOp>()) {
+        footprint.writes.insert(getResource(assignOp.getDest()));
+        Value src = assignOp.getSrc();
+        if (isa_and_nonnull<hw::ConstantOp, arith::ConstantOp>(
+                src.getDefiningOp()))
+          continue;
+        footprint.reads.insert(getResource(src));
+        if (calyx::breaksCombinationalPath(src))
+          continue;
+        auto combGroup = dyn_cast<calyx::CombGroupOp>(
+            getState<ComponentLoweringState>()
+                .getEvaluatingGroup<calyx::GroupInterface>(src)
+                .getOperation());
+        if (combGroup && visited.insert(combGroup).second)
+          worklist.push_back(combGroup);
+      }
+    }
+    return footprint;
+  }
+
+  /// Schedules 'groups', which execute in this order in the source program,
+  /// at the end of 'parentCtrlBlock'. Groups without conflicting footprints
+  /// run in parallel, up to 'maxParallelGroups' of them at once.
+  void scheduleGroups(PatternRewriter &rewriter, Block *parentCtrlBlock,
+                      ArrayRef<calyx::GroupOp> groups) const {
+    // Assign every group to the earliest step after all the groups it
+    // conflicts with, and which has not exhausted the budget yet.
+    SmallVector<SmallVector<calyx::GroupOp>> steps;
+    SmallVector<GroupFootprint> footprints;
+    SmallVector<unsigned> groupSteps;
+    for (auto group : groups) {
+      unsigned step = 0;
+      footprints.push_back(maxParallelGroups > 1 ? getFootprint(group)
+                                                 : GroupFootprint());
+      for (unsigned i = 0, e = groupSteps.size(); i < e; ++i)
+        if (footprints[i].conflictsWith(footprints.back()))
+          step = std::max(step, groupSteps[i] + 1);
+      while (step < steps.size() &&
+             steps[step].size() >= std::max(1u, maxParallelGroups))
+        ++step;
+      if (step == steps.size())
+        steps.emplace_back();
+      steps[step].push_back(group);
+      groupSteps.push_back(step);
+    }
+
+    for (auto &step : steps) {
+      rewriter.setInsertionPointToEnd(parentCtrlBlock);
+      if (step.size() > 1) {
+        auto parOp = rewriter.create<calyx::ParOp>(step.front().getLoc());
+        rewriter.setInsertionPointToEnd(parOp.getBodyBlock());
+      }
+      for (auto group : step)
+        rewriter.create<calyx::EnableOp>(group.getLoc(), group.getSymName());
+    }
+  }
+
+  /// Schedules the groups that registered themselves with 'block'. Loops are
+  /// scheduled sequentially, and the groups in between them are scheduled by
+  /// scheduleGroups.
   LogicalResult scheduleBasicBlock(PatternRewriter &rewriter,
                                    const DenseSet<Block *> &path,
                                    mlir::Block *parentCtrlBlock,
@@ -945,13 +1048,18 @@ private:
       parentCtrlBlock = seqOp.getBodyBlock();
     }
 
+    SmallVector<calyx::GroupOp> pendingGroups;
     for (auto &group : compBlockScheduleables) {
-      rewriter.setInsertionPointToEnd(parentCtrlBlock);
       if (auto groupPtr = std::get_if<calyx::GroupOp>(&group); groupPtr) {
-        rewriter.create<calyx::EnableOp>(groupPtr->getLoc(),
-                                         groupPtr->getSymName());
-      } else if (auto whileSchedPtr = std::get_if<WhileScheduleable>(&group);
-                 whileSchedPtr) {
+        pendingGroups.push_back(*groupPtr);
+        continue;
+      }
+      scheduleGroups(rewriter, parentCtrlBlock, pendingGroups);
+      pendingGroups.clear();
+
+      rewriter.setInsertionPointToEnd(parentCtrlBlock);
+      if (auto whileSchedPtr = std::get_if<WhileScheduleable>(&group);
+          whileSchedPtr) {
         auto &whileOp = whileSchedPtr->whileOp;
 
         auto whileCtrlOp =
@@ -978,6 +1086,7 @@ private:
       } else
         llvm_unreachable("Unknown scheduleable");
     }
+    scheduleGroups(rewriter, parentCtrlBlock, pendingGroups);
     return success();
   }
 
@@ -1341,7 +1450,8 @@ void SCFToCalyxPass::runOnOperation() {
   /// This pattern traverses the CFG of the program and generates a control
   /// schedule based on the calyx::GroupOp's which were registered for each
   /// basic block in the source function.
-  addOncePattern<BuildControl>(loweringPatterns, funcMap, *loweringState);
+  addOncePattern<BuildControl>(loweringPatterns, funcMap, *loweringState,
+                               maxParallelGroups);
 
   /// This pass recursively inlines use-def chains of combinational logic (from
   /// non-stateful groups) into groups referenced in the control schedule.
@@ -19,10 +19,14 @@
 #include "circt/Support/LLVM.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Tools/mlir-translate/Translation.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/TypeSwitch.h"
 
+#include <atomic>
+
 using namespace circt;
 using namespace calyx;
 using namespace mlir;
@@ -172,6 +176,7 @@ struct Emitter {
 
   // Module emission
   void emitModule(ModuleOp op);
+  void emitModuleBodyOp(Operation *op);
 
   // Metadata emission for the Cider debugger.
   void emitCiderMetadata(mlir::ModuleOp op) {
@@ -531,16 +536,40 @@ private:
 
 LogicalResult Emitter::finalize() { return failure(encounteredError); }
 
-/// Emit an entire program.
+/// Emit an entire program. The components and primitives are independent of
+/// each other, hence they are formatted concurrently into separate buffers,
+/// which are then written out in program order.
 void Emitter::emitModule(ModuleOp op) {
-  for (auto &bodyOp : *op.getBody()) {
-    if (auto componentOp = dyn_cast<ComponentInterface>(bodyOp))
-      emitComponent(componentOp);
-    else if (auto hwModuleExternOp = dyn_cast<hw::HWModuleExternOp>(bodyOp))
-      emitPrimitiveExtern(hwModuleExternOp);
-    else
-      emitOpError(&bodyOp, "Unexpected op");
-  }
+  auto bodyOps = llvm::to_vector(llvm::make_pointer_range(*op.getBody()));
+  SmallVector<std::string> buffers(bodyOps.size());
+  std::atomic<bool> anyFailed = false;
+
+  // Diagnostics are reported in program order, regardless of which worker
+  // produced them.
+  auto *context = op.getContext();
+  mlir::ParallelDiagnosticHandler diagHandler(context);
+  mlir::parallelFor(context, 0, bodyOps.size(), [&](size_t i) {
+    diagHandler.setOrderIDForThread(i);
+    llvm::raw_string_ostream bufferStream(buffers[i]);
+    Emitter bodyOpEmitter(bufferStream);
+    bodyOpEmitter.emitModuleBodyOp(bodyOps[i]);
+    if (bodyOpEmitter.encounteredError)
+      anyFailed = true;
+  });
+
+  encounteredError |= anyFailed;
+  for (auto &buffer : buffers)
+    os << buffer;
+}
+
+/// Emit a component or primitive of the program.
+void Emitter::emitModuleBodyOp(Operation *op) {
+  if (auto componentOp = dyn_cast<ComponentInterface>(op))
+    emitComponent(componentOp);
+  else if (auto hwModuleExternOp = dyn_cast<hw::HWModuleExternOp>(op))
+    emitPrimitiveExtern(hwModuleExternOp);
+  else
+    emitOpError(op, "Unexpected op");
 }
 
 /// Emit a component.
@@ -36,6 +36,18 @@ hw::ConstantOp createConstant(Location loc, OpBuilder &builder,
                                         APInt(width, value, /*unsigned=*/true));
 }
 
+Optional<uint64_t> getStaticLatency(GroupOp group) {
+  auto latency = group->getAttrOfType<IntegerAttr>("static");
+  if (!latency || latency.getValue().isZero())
+    return None;
+  return latency.getValue().getZExtValue();
+}
+
+void setStaticLatency(GroupOp group, uint64_t latency) {
+  OpBuilder builder(group);
+  group->setAttr("static", builder.getI64IntegerAttr(latency));
+}
+
 bool isControlLeafNode(Operation *op) { return isa<calyx::EnableOp>(op); }
 
 DictionaryAttr getMandatoryPortAttr(MLIRContext *ctx, StringRef name) {
@@ -135,6 +135,24 @@ Value getComponentOutput(calyx::ComponentOp compOp, unsigned outPortIdx) {
   return compOp.getArgument(index);
 }
 
+bool breaksCombinationalPath(Value value) {
+  // Things which stop recursive inlining (or in other words, what
+  // breaks combinational paths).
+  // - Component inputs
+  // - Register and memory reads
+  // - Constant ops (constant ops are not evaluated by any group)
+  // - Multiplication pipelines are sequential.
+  // - 'While' return values (these are registers, however, 'while'
+  //   return values have at the current point of conversion not yet
+  //   been rewritten to their register outputs, see comment in
+  //   LateSSAReplacement)
+  return value.isa<BlockArgument>() ||
+         isa<calyx::RegisterOp, calyx::MemoryOp, hw::ConstantOp,
+             mlir::arith::ConstantOp, calyx::MultPipeLibOp,
+             calyx::DivUPipeLibOp, calyx::DivSPipeLibOp, calyx::RemSPipeLibOp,
+             calyx::RemUPipeLibOp, mlir::scf::WhileOp>(value.getDefiningOp());
+}
+
 Type convIndexType(OpBuilder &builder, Type type) {
   if (type.isIndex())
     return builder.getI32Type();
@@ -542,22 +560,7 @@ void InlineCombGroups::recurseInlineCombGroups(
                                  originGroup.getBody()->end());
     }
     Value src = assignOp.getSrc();
-
-    // Things which stop recursive inlining (or in other words, what
-    // breaks combinational paths).
-    // - Component inputs
-    // - Register and memory reads
-    // - Constant ops (constant ops are not evaluated by any group)
-    // - Multiplication pipelines are sequential.
-    // - 'While' return values (these are registers, however, 'while'
-    //   return values have at the current point of conversion not yet
-    //   been rewritten to their register outputs, see comment in
-    //   LateSSAReplacement)
-    if (src.isa<BlockArgument>() ||
-        isa<calyx::RegisterOp, calyx::MemoryOp, hw::ConstantOp,
-            mlir::arith::ConstantOp, calyx::MultPipeLibOp, calyx::DivUPipeLibOp,
-            calyx::DivSPipeLibOp, calyx::RemSPipeLibOp, calyx::RemUPipeLibOp,
-            mlir::scf::WhileOp>(src.getDefiningOp()))
+    if (breaksCombinationalPath(src))
       continue;
 
     auto srcCombGroup = dyn_cast<calyx::CombGroupOp>(
@@ -55,9 +55,11 @@ private:
 /// This is done by initializing GroupGoOp values for the enabled groups in
 /// the SeqOp, and then creating a new Seq GroupOp with the given FSM. Each
 /// step in the FSM is guarded by the done operation of the group currently
-/// being executed. After the group is complete, the FSM is incremented. This
-/// SeqOp is then replaced in the control with an Enable statement referring
-/// to the new Seq GroupOp.
+/// being executed. After the group is complete, the FSM is incremented. Groups
+/// with a static latency instead occupy one step per cycle they take, and the
+/// FSM is incremented every cycle without waiting for their done operation.
+/// This SeqOp is then replaced in the control with an Enable statement
+/// referring to the new Seq GroupOp.
 void CompileControlVisitor::visit(SeqOp seq, ComponentOp &component) {
   auto wires = component.getWiresOp();
   Block *wiresBody = wires.getBodyBlock();
@@ -68,9 +70,18 @@ void CompileControlVisitor::visit(SeqOp seq, ComponentOp &component) {
     return;
   }
 
-  // This should be the number of enable statements + 1 since this is the
-  // maximum value the FSM register will reach.
-  size_t fsmBitWidth = getNecessaryBitWidth(seqOps.size() + 1);
+  // Used to look up the enabled groups, and to guarantee a unique SymbolName
+  // for the new group.
+  SymbolTable symTable(wires);
+
+  // This should be the number of FSM steps + 1 since this is the maximum
+  // value the FSM register will reach.
+  size_t numSteps = 0;
+  for (auto enable : seq.getBodyBlock()->getOps<EnableOp>()) {
+    auto groupOp = symTable.lookup<GroupOp>(enable.getGroupName());
+    numSteps += getStaticLatency(groupOp).value_or(1);
+  }
+  size_t fsmBitWidth = getNecessaryBitWidth(numSteps + 1);
 
   OpBuilder builder(component->getRegion(0));
   auto fsmRegister =
@@ -87,8 +98,6 @@ void CompileControlVisitor::visit(SeqOp seq, ComponentOp &component) {
   auto seqGroup =
       builder.create<GroupOp>(wires->getLoc(), builder.getStringAttr("seq"));
 
-  // Guarantees a unique SymbolName for the group.
-  SymbolTable symTable(wires);
   symTable.insert(seqGroup);
 
   size_t fsmIndex = 0;
@@ -99,35 +108,61 @@ void CompileControlVisitor::visit(SeqOp seq, ComponentOp &component) {
     compiledGroups.push_back(
         SymbolRefAttr::get(builder.getContext(), groupName));
     auto groupOp = symTable.lookup<GroupOp>(groupName);
+    Optional<uint64_t> latency = getStaticLatency(groupOp);
 
     builder.setInsertionPoint(groupOp);
     auto fsmCurrentState = createConstant(wires->getLoc(), builder, component,
                                           fsmBitWidth, fsmIndex);
-
-    // TODO(Calyx): Eventually, we should canonicalize the GroupDoneOp's guard
-    // and source.
-    auto guard = groupOp.getDoneOp().getGuard();
-    Value source = groupOp.getDoneOp().getSrc();
-    auto doneOpValue = !guard ? source
-                              : builder.create<comb::AndOp>(
-                                    wires->getLoc(), guard, source, false);
-
-    // Build the Guard for the `go` signal of the current group being walked.
-    // The group should begin when:
-    // (1) the current step in the fsm is reached, and
-    // (2) the done signal of this group is not high.
-    auto eqCmp =
-        builder.create<comb::ICmpOp>(wires->getLoc(), comb::ICmpPredicate::eq,
-                                     fsmOut, fsmCurrentState, false);
-    auto notDone = comb::createOrFoldNot(wires->getLoc(), doneOpValue, builder);
-    auto groupGoGuard =
-        builder.create<comb::AndOp>(wires->getLoc(), eqCmp, notDone, false);
-
-    // Guard for the `in` and `write_en` signal of the fsm register. These are
-    // driven when the group has completed.
-    builder.setInsertionPoint(seqGroup);
-    auto groupDoneGuard =
-        builder.create<comb::AndOp>(wires->getLoc(), eqCmp, doneOpValue, false);
+    auto eqCmp = [&]() {
+      return builder.create<comb::ICmpOp>(wires->getLoc(),
+                                          comb::ICmpPredicate::eq, fsmOut,
+                                          fsmCurrentState, false);
+    };
+
+    Value groupGoGuard, groupDoneGuard;
+    if (latency) {
+      // A static group is active during all of its steps, and the fsm moves on
+      // every cycle, which avoids the round trip through its done signal.
+      if (*latency == 1) {
+        groupGoGuard = eqCmp();
+      } else {
+        auto fsmEndState = createConstant(wires->getLoc(), builder, component,
+                                          fsmBitWidth, fsmIndex + *latency);
+        auto hasBegun = builder.create<comb::ICmpOp>(
+            wires->getLoc(), comb::ICmpPredicate::uge, fsmOut, fsmCurrentState,
+            false);
+        auto hasNotEnded = builder.create<comb::ICmpOp>(
+            wires->getLoc(), comb::ICmpPredicate::ult, fsmOut, fsmEndState,
+            false);
+        groupGoGuard = builder.create<comb::AndOp>(wires->getLoc(), hasBegun,
+                                                   hasNotEnded, false);
+      }
+      groupDoneGuard = groupGoGuard;
+    } else {
+      // TODO(Calyx): Eventually, we should canonicalize the GroupDoneOp's
+      // guard and source.
+      auto guard = groupOp.getDoneOp().getGuard();
+      Value source = groupOp.getDoneOp().getSrc();
+      auto doneOpValue = !guard ? source
+                                : builder.create<comb::AndOp>(
+                                      wires->getLoc(), guard, source, false);
+
+      // Build the Guard for the `go` signal of the current group being walked.
+      // The group should begin when:
+      // (1) the current step in the fsm is reached, and
+      // (2) the done signal of this group is not high.
+      Value isCurrentState = eqCmp();
+      auto notDone =
+          comb::createOrFoldNot(wires->getLoc(), doneOpValue, builder);
+      groupGoGuard = builder.create<comb::AndOp>(
+          wires->getLoc(), isCurrentState, notDone, false);
+
+      // Guard for the `in` and `write_en` signal of the fsm register. These
+      // are driven when the group has completed.
+      builder.setInsertionPoint(seqGroup);
+      groupDoneGuard = builder.create<comb::AndOp>(
+          wires->getLoc(), isCurrentState, doneOpValue, false);
+    }
 
     // Directly update the GroupGoOp of the current group being walked.
     auto goOp = groupOp.getGoOp();
@@ -135,15 +170,22 @@ void CompileControlVisitor::visit(SeqOp seq, ComponentOp &component) {
     goOp->setOperands({oneConstant, groupGoGuard});
 
     // Add guarded assignments to the fsm register `in` and `write_en` ports.
+    // Within a static group taking multiple cycles, the fsm counts up.
+    fsmIndex += latency.value_or(1);
     fsmNextState = createConstant(wires->getLoc(), builder, component,
-                                  fsmBitWidth, fsmIndex + 1);
+                                  fsmBitWidth, fsmIndex);
+    Value fsmStep = fsmNextState;
+    if (latency.value_or(1) > 1) {
+      builder.setInsertionPoint(seqGroup);
+      fsmStep = builder.create<comb::AddOp>(
+          wires->getLoc(), fsmOut,
+          createConstant(wires->getLoc(), builder, component, fsmBitWidth, 1),
+          false);
+    }
     builder.setInsertionPointToEnd(seqGroup.getBodyBlock());
-    builder.create<AssignOp>(wires->getLoc(), fsmIn, fsmNextState,
-                             groupDoneGuard);
+    builder.create<AssignOp>(wires->getLoc(), fsmIn, fsmStep, groupDoneGuard);
     builder.create<AssignOp>(wires->getLoc(), fsmWriteEn, oneConstant,
                              groupDoneGuard);
-    // Increment the fsm index for the next group.
-    ++fsmIndex;
   });
 
   // Build the final guard for the new Seq group's GroupDoneOp. This is
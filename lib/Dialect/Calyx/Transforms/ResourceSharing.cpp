@@ -0,0 +1,379 @@
+//===- ResourceSharing.cpp - Register and cell sharing passes ---*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Contains the definitions of the register sharing and cell sharing passes,
+// which merge registers with disjoint live ranges and combinational cells used
+// by groups that never execute at the same time.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetails.h"
+#include "circt/Dialect/Calyx/CalyxOps.h"
+#include "circt/Dialect/Calyx/CalyxPasses.h"
+#include "circt/Support/LLVM.h"
+#include "llvm/ADT/TypeSwitch.h"
+
+using namespace circt;
+using namespace calyx;
+using namespace mlir;
+
+namespace {
+
+/// A linearization of the control program of a component. Every enable, and
+/// the condition of every if and while, is assigned a position, in the order
+/// in which sequential control executes them. The positions of both branches
+/// of an if are consecutive. The par and while regions, whose positions may
+/// be active at the same time or repeatedly, are recorded as intervals.
+class ControlSchedule {
+public:
+  /// Builds the schedule of 'control'. Fails if the control program contains
+  /// operations unknown to this analysis.
+  LogicalResult build(ControlOp control);
+
+  /// Returns the positions at which 'accessor' is active, which is either a
+  /// group, or an if or while operation reading its condition port. Returns
+  /// an empty list if 'accessor' is never executed.
+  ArrayRef<unsigned> getPositions(Operation *accessor) const;
+
+  /// Returns whether the positions 'p' and 'q' may be active at the same time,
+  /// i.e., they are located in different arms of a par.
+  bool areConcurrent(unsigned p, unsigned q) const;
+
+  /// Widens the live range ['start', 'end'] such that it safely covers the
+  /// par and while regions it overlaps with. A live range contained in the
+  /// body of a while does not cross iterations, and hence is not widened.
+  std::pair<unsigned, unsigned> widen(unsigned start, unsigned end) const;
+
+private:
+  LogicalResult visit(Operation *op);
+  LogicalResult visitBlock(Block *block);
+  unsigned addPosition();
+
+  struct Interval {
+    Operation *op;
+    unsigned start, end;
+  };
+
+  /// The positions of each group and each condition reading operation.
+  DenseMap<StringRef, SmallVector<unsigned>> groupPositions;
+  DenseMap<Operation *, SmallVector<unsigned>> conditionPositions;
+  /// The par and while regions, inner regions ahead of the outer ones.
+  SmallVector<Interval> regions;
+  /// The par arms enclosing each position, outermost first.
+  SmallVector<SmallVector<std::pair<Operation *, unsigned>>> positionArms;
+  SmallVector<std::pair<Operation *, unsigned>> currentArms;
+};
+
+} // end anonymous namespace
+
+LogicalResult ControlSchedule::build(ControlOp control) {
+  return visitBlock(control.getBodyBlock());
+}
+
+unsigned ControlSchedule::addPosition() {
+  positionArms.push_back(currentArms);
+  return positionArms.size() - 1;
+}
+
+LogicalResult ControlSchedule::visitBlock(Block *block) {
+  for (auto &op : *block)
+    if (failed(visit(&op)))
+      return failure();
+  return success();
+}
+
+LogicalResult ControlSchedule::visit(Operation *op) {
+  return TypeSwitch<Operation *, LogicalResult>(op)
+      .Case<EnableOp>([&](auto enable) {
+        groupPositions[enable.getGroupName()].push_back(addPosition());
+        return success();
+      })
+      .Case<SeqOp>([&](auto seq) { return visitBlock(seq.getBodyBlock()); })
+      .Case<ParOp>([&](auto par) {
+        unsigned start = positionArms.size();
+        unsigned arm = 0;
+        for (auto &child : *par.getBodyBlock()) {
+          currentArms.push_back({par, arm++});
+          LogicalResult result = visit(&child);
+          currentArms.pop_back();
+          if (failed(result))
+            return failure();
+        }
+        if (positionArms.size() > start)
+          regions.push_back({par, start, (unsigned)positionArms.size() - 1});
+        return success();
+      })
+      .Case<IfOp>([&](auto ifOp) {
+        unsigned start = addPosition();
+        if (ifOp.thenBodyExists() && failed(visitBlock(ifOp.getThenBody())))
+          return failure();
+        if (ifOp.elseBodyExists() && failed(visitBlock(ifOp.getElseBody())))
+          return failure();
+        // The condition may be read for as long as the if executes.
+        unsigned end = positionArms.size() - 1;
+        conditionPositions[ifOp] = {start, end};
+        if (auto groupName = ifOp.getGroupName())
+          groupPositions[*groupName].append({start, end});
+        return success();
+      })
+      .Case<WhileOp>([&](auto whileOp) {
+        unsigned start = addPosition();
+        if (failed(visitBlock(whileOp.getBodyBlock())))
+          return failure();
+        unsigned end = positionArms.size() - 1;
+        conditionPositions[whileOp] = {start, end};
+        if (auto groupName = whileOp.getGroupName())
+          groupPositions[*groupName].append({start, end});
+        regions.push_back({whileOp, start, end});
+        return success();
+      })
+      .Default([&](auto) { return failure(); });
+}
+
+ArrayRef<unsigned> ControlSchedule::getPositions(Operation *accessor) const {
+  if (auto group = dyn_cast<GroupInterface>(accessor)) {
+    auto it = groupPositions.find(group.symName().getValue());
+    return it == groupPositions.end() ? ArrayRef<unsigned>() : it->second;
+  }
+  auto it = conditionPositions.find(accessor);
+  return it == conditionPositions.end() ? ArrayRef<unsigned>() : it->second;
+}
+
+bool ControlSchedule::areConcurrent(unsigned p, unsigned q) const {
+  auto &armsP = positionArms[p];
+  auto &armsQ = positionArms[q];
+  for (unsigned i = 0, e = std::min(armsP.size(), armsQ.size()); i < e; ++i) {
+    if (armsP[i].first != armsQ[i].first)
+      return false;
+    if (armsP[i].second != armsQ[i].second)
+      return true;
+  }
+  return false;
+}
+
+std::pair<unsigned, unsigned> ControlSchedule::widen(unsigned start,
+                                                     unsigned end) const {
+  for (auto &region : regions) {
+    if (end < region.start || start > region.end)
+      continue;
+    // Positions after the condition of a while belong to its body.
+    bool inBody = start > region.start && end <= region.end;
+    if (isa<WhileOp>(region.op) && inBody)
+      continue;
+    start = std::min(start, region.start);
+    end = std::max(end, region.end);
+  }
+  return {start, end};
+}
+
+/// Collects the groups and control operations accessing 'port' into
+/// 'accessors'. Combinational logic in wire scope is accessed on behalf of
+/// the groups using its results. Fails if 'port' is accessed by anything else,
+/// e.g., a continuous assignment.
+static LogicalResult
+collectAccessors(Value port, SmallPtrSetImpl<Operation *> &accessors) {
+  SmallVector<Value> worklist = {port};
+  SmallPtrSet<Operation *, 8> visited;
+  while (!worklist.empty()) {
+    Value value = worklist.pop_back_val();
+    for (auto *user : value.getUsers()) {
+      if (isa<IfOp, WhileOp>(user)) {
+        accessors.insert(user);
+        continue;
+      }
+      if (auto group = user->getParentOfType<GroupInterface>()) {
+        accessors.insert(group);
+        continue;
+      }
+      if (!isa<comb::CombDialect>(user->getDialect()))
+        return failure();
+      if (visited.insert(user).second)
+        worklist.append(user->result_begin(), user->result_end());
+    }
+  }
+  return success();
+}
+
+/// Returns whether the cells 'lhs' and 'rhs' are interchangeable.
+static bool isSameKindOfCell(Operation *lhs, Operation *rhs) {
+  return lhs->getName() == rhs->getName() &&
+         lhs->getResultTypes() == rhs->getResultTypes();
+}
+
+//===----------------------------------------------------------------------===//
+// Register sharing
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+struct LiveRange {
+  Operation *reg;
+  unsigned start, end;
+};
+
+struct RegisterSharingPass
+    : public RegisterSharingBase<RegisterSharingPass> {
+  void runOnOperation() override;
+};
+
+} // end anonymous namespace
+
+/// Returns the positions between which 'reg' holds a value, or None if its
+/// value may outlive the component's execution or cannot be tracked.
+static Optional<LiveRange> getLiveRange(RegisterOp reg,
+                                        const ControlSchedule &schedule) {
+  Optional<unsigned> firstRead, firstWrite;
+  unsigned start = ~0u, end = 0;
+  for (auto port : reg->getResults()) {
+    SmallPtrSet<Operation *, 8> accessors;
+    if (failed(collectAccessors(port, accessors)))
+      return None;
+
+    // Waiting for the register to be done is part of writing it.
+    bool isRead = port == reg.getOut();
+    for (auto *accessor : accessors) {
+      auto positions = schedule.getPositions(accessor);
+      if (positions.empty())
+        return None;
+      for (unsigned pos : positions) {
+        start = std::min(start, pos);
+        end = std::max(end, pos);
+        auto &first = isRead ? firstRead : firstWrite;
+        first = std::min(first.value_or(pos), pos);
+      }
+    }
+  }
+
+  // A register read no later than it is first written carries a value into
+  // the component, e.g., from its previous invocation.
+  if (!firstWrite || (firstRead && *firstRead <= *firstWrite))
+    return None;
+
+  std::tie(start, end) = schedule.widen(start, end);
+  return LiveRange{reg, start, end};
+}
+
+void RegisterSharingPass::runOnOperation() {
+  ComponentOp component = getOperation();
+  ControlSchedule schedule;
+  if (failed(schedule.build(component.getControlOp())))
+    return markAllAnalysesPreserved();
+
+  SmallVector<LiveRange> liveRanges;
+  for (auto reg : component.getBodyBlock()->getOps<RegisterOp>())
+    if (auto liveRange = getLiveRange(reg, schedule))
+      liveRanges.push_back(*liveRange);
+
+  // Assign the live ranges to registers in the order of their start, and let
+  // each one reuse the first register that is free by then. For intervals,
+  // this left-edge allocation uses the fewest registers possible.
+  llvm::stable_sort(liveRanges, [](const LiveRange &lhs, const LiveRange &rhs) {
+    return lhs.start < rhs.start;
+  });
+  SmallVector<LiveRange> allocated;
+  for (auto &liveRange : liveRanges) {
+    auto *it = llvm::find_if(allocated, [&](const LiveRange &other) {
+      return other.end < liveRange.start &&
+             isSameKindOfCell(other.reg, liveRange.reg);
+    });
+    if (it == allocated.end()) {
+      allocated.push_back(liveRange);
+      continue;
+    }
+    liveRange.reg->replaceAllUsesWith(it->reg);
+    liveRange.reg->erase();
+    it->end = liveRange.end;
+    ++numRegistersShared;
+  }
+}
+
+std::unique_ptr<mlir::Pass> circt::calyx::createRegisterSharingPass() {
+  return std::make_unique<RegisterSharingPass>();
+}
+
+//===----------------------------------------------------------------------===//
+// Cell sharing
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+struct CellUses {
+  Operation *cell;
+  SmallVector<unsigned> positions;
+};
+
+struct CellSharingPass : public CellSharingBase<CellSharingPass> {
+  void runOnOperation() override;
+};
+
+} // end anonymous namespace
+
+/// Returns the positions at which 'cell' is used, or None if it is used by
+/// anything but groups.
+static Optional<CellUses> getCellUses(Operation *cell,
+                                      const ControlSchedule &schedule) {
+  CellUses uses{cell, {}};
+  SmallPtrSet<Operation *, 8> accessors;
+  for (auto port : cell->getResults())
+    if (failed(collectAccessors(port, accessors)))
+      return None;
+
+  // Combinational groups may be active for as long as the control operation
+  // using them, so only cells used by regular groups are shared.
+  for (auto *accessor : accessors) {
+    auto positions = schedule.getPositions(accessor);
+    if (!isa<GroupOp>(accessor) || positions.empty())
+      return None;
+    uses.positions.append(positions.begin(), positions.end());
+  }
+  if (uses.positions.empty())
+    return None;
+  return uses;
+}
+
+void CellSharingPass::runOnOperation() {
+  ComponentOp component = getOperation();
+  ControlSchedule schedule;
+  if (failed(schedule.build(component.getControlOp())))
+    return markAllAnalysesPreserved();
+
+  SmallVector<CellUses> cells;
+  for (auto &op : *component.getBodyBlock())
+    if (op.hasTrait<Combinational>())
+      if (auto uses = getCellUses(&op, schedule))
+        cells.push_back(std::move(*uses));
+
+  auto conflict = [&](const CellUses &lhs, const CellUses &rhs) {
+    for (unsigned p : lhs.positions)
+      for (unsigned q : rhs.positions)
+        if (p == q || schedule.areConcurrent(p, q))
+          return true;
+    return false;
+  };
+
+  // Greedily merge each cell into the first compatible cell whose uses are
+  // mutually exclusive with its own.
+  SmallVector<CellUses> shared;
+  for (auto &uses : cells) {
+    auto *it = llvm::find_if(shared, [&](const CellUses &other) {
+      return isSameKindOfCell(other.cell, uses.cell) && !conflict(other, uses);
+    });
+    if (it == shared.end()) {
+      shared.push_back(std::move(uses));
+      continue;
+    }
+    uses.cell->replaceAllUsesWith(it->cell);
+    uses.cell->erase();
+    it->positions.append(uses.positions.begin(), uses.positions.end());
+    ++numCellsShared;
+  }
+}
+
+std::unique_ptr<mlir::Pass> circt::calyx::createCellSharingPass() {
+  return std::make_unique<CellSharingPass>();
+}
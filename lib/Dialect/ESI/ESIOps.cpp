@@ -95,6 +95,40 @@ circt::esi::ChannelType PipelineStageOp::channelType() {
   return getInput().getType().cast<circt::esi::ChannelType>();
 }
 
+//===----------------------------------------------------------------------===//
+// FIFOOp functions.
+//===----------------------------------------------------------------------===//
+
+ParseResult FIFOOp::parse(OpAsmParser &parser, OperationState &result) {
+  llvm::SMLoc inputOperandsLoc = parser.getCurrentLocation();
+
+  SmallVector<OpAsmParser::UnresolvedOperand, 4> operands;
+  Type innerOutputType;
+  if (parser.parseOperandList(operands, /*requiredOperandCount=*/3) ||
+      parser.parseOptionalAttrDict(result.attributes) || parser.parseColon() ||
+      parser.parseType(innerOutputType))
+    return failure();
+  auto type =
+      ChannelType::get(parser.getBuilder().getContext(), innerOutputType);
+  result.addTypes({type});
+
+  auto i1 = IntegerType::get(result.getContext(), 1);
+  if (parser.resolveOperands(operands, {i1, i1, type}, inputOperandsLoc,
+                             result.operands))
+    return failure();
+  return success();
+}
+
+void FIFOOp::print(OpAsmPrinter &p) {
+  p << " " << getClk() << ", " << getRst() << ", " << getInput() << " ";
+  p.printOptionalAttrDict((*this)->getAttrs());
+  p << " : " << innerType();
+}
+
+circt::esi::ChannelType FIFOOp::channelType() {
+  return getInput().getType().cast<circt::esi::ChannelType>();
+}
+
 //===----------------------------------------------------------------------===//
 // Wrap / unwrap.
 //===----------------------------------------------------------------------===//
@@ -58,8 +58,10 @@ public:
   ESIHWBuilder(Operation *top);
 
   ArrayAttr getStageParameterList(Attribute value);
+  ArrayAttr getFIFOParameterList(Attribute widthValue, Attribute depthValue);
 
   HWModuleExternOp declareStage(Operation *symTable, PipelineStageOp);
+  HWModuleExternOp declareFIFO(Operation *symTable, FIFOOp);
   // Will be unused when CAPNP is undefined
   HWModuleExternOp declareCosimEndpointOp(Operation *symTable, Type sendType,
                                           Type recvType) LLVM_ATTRIBUTE_UNUSED;
@@ -72,7 +74,7 @@ public:
   const StringAttr dataOutValid, dataOutReady, dataOut, dataInValid,
       dataInReady, dataIn;
   const StringAttr clk, rst;
-  const StringAttr width;
+  const StringAttr width, depth;
 
   // Various identifier strings. Keep them all here in case we rename them.
   static constexpr char dataStr[] = "data", validStr[] = "valid",
@@ -84,7 +86,12 @@ private:
   /// taken in the symbol table.
   StringAttr constructInterfaceName(ChannelType);
 
+  /// Get the ports of the hand-coded buffer modules, which all share the same
+  /// valid/ready interface.
+  SmallVector<PortInfo> getBufferPorts(Type dataType);
+
   llvm::DenseMap<Type, HWModuleExternOp> declaredStage;
+  llvm::DenseMap<Type, HWModuleExternOp> declaredFIFO;
   llvm::DenseMap<std::pair<Type, Type>, HWModuleExternOp>
       declaredCosimEndpointOp;
   llvm::DenseMap<Type, InterfaceOp> portTypeLookup;
@@ -113,7 +120,8 @@ ESIHWBuilder::ESIHWBuilder(Operation *top)
       dataIn(StringAttr::get(getContext(), "DataIn")),
       clk(StringAttr::get(getContext(), "clk")),
       rst(StringAttr::get(getContext(), "rst")),
-      width(StringAttr::get(getContext(), "WIDTH")) {
+      width(StringAttr::get(getContext(), "WIDTH")),
+      depth(StringAttr::get(getContext(), "DEPTH")) {
 
   auto regions = top->getRegions();
   if (regions.size() == 0) {
@@ -181,17 +189,17 @@ ArrayAttr ESIHWBuilder::getStageParameterList(Attribute value) {
   return ArrayAttr::get(width.getContext(), widthParam);
 }
 
-/// Write an 'ExternModuleOp' to use a hand-coded SystemVerilog module. Said
-/// module implements pipeline stage, adding 1 cycle latency. This particular
-/// implementation is double-buffered and fully pipelines the reverse-flow ready
-/// signal.
-HWModuleExternOp ESIHWBuilder::declareStage(Operation *symTable,
-                                            PipelineStageOp stage) {
-  Type dataType = stage.innerType();
-  HWModuleExternOp &stageMod = declaredStage[dataType];
-  if (stageMod)
-    return stageMod;
+/// Return a parameter list for the FIFO module with the specified values.
+ArrayAttr ESIHWBuilder::getFIFOParameterList(Attribute widthValue,
+                                             Attribute depthValue) {
+  auto type = IntegerType::get(getContext(), 32, IntegerType::Unsigned);
+  Attribute params[] = {
+      ParamDeclAttr::get(getContext(), width, type, widthValue),
+      ParamDeclAttr::get(getContext(), depth, type, depthValue)};
+  return ArrayAttr::get(getContext(), params);
+}
 
+SmallVector<PortInfo> ESIHWBuilder::getBufferPorts(Type dataType) {
   // Since this module has parameterized widths on the a input and x output,
   // give the extern declation a None type since nothing else makes sense.
   // Will be refining this when we decide how to better handle parameterized
@@ -209,13 +217,42 @@ HWModuleExternOp ESIHWBuilder::declareStage(Operation *symTable,
 
   ports.push_back({xValid, PortDirection::OUTPUT, getI1Type(), resn++});
   ports.push_back({xReady, PortDirection::INPUT, getI1Type(), argn++});
+  return ports;
+}
+
+/// Write an 'ExternModuleOp' to use a hand-coded SystemVerilog module. Said
+/// module implements pipeline stage, adding 1 cycle latency. This particular
+/// implementation is double-buffered and fully pipelines the reverse-flow ready
+/// signal.
+HWModuleExternOp ESIHWBuilder::declareStage(Operation *symTable,
+                                            PipelineStageOp stage) {
+  Type dataType = stage.innerType();
+  HWModuleExternOp &stageMod = declaredStage[dataType];
+  if (stageMod)
+    return stageMod;
 
   stageMod = create<HWModuleExternOp>(
-      constructUniqueSymbol(symTable, "ESI_PipelineStage"), ports,
-      "ESI_PipelineStage", getStageParameterList({}));
+      constructUniqueSymbol(symTable, "ESI_PipelineStage"),
+      getBufferPorts(dataType), "ESI_PipelineStage",
+      getStageParameterList({}));
   return stageMod;
 }
 
+/// Write an 'ExternModuleOp' to use a hand-coded SystemVerilog module. Said
+/// module implements a circular FIFO backed by a RAM of DEPTH entries, adding 1
+/// cycle latency regardless of its depth.
+HWModuleExternOp ESIHWBuilder::declareFIFO(Operation *symTable, FIFOOp fifo) {
+  Type dataType = fifo.innerType();
+  HWModuleExternOp &fifoMod = declaredFIFO[dataType];
+  if (fifoMod)
+    return fifoMod;
+
+  fifoMod = create<HWModuleExternOp>(
+      constructUniqueSymbol(symTable, "ESI_FIFO"), getBufferPorts(dataType),
+      "ESI_FIFO", getFIFOParameterList({}, {}));
+  return fifoMod;
+}
+
 /// Write an 'ExternModuleOp' to use a hand-coded SystemVerilog module. Said
 /// module contains a bi-directional Cosimulation DPI interface with valid/ready
 /// semantics.
@@ -286,16 +323,22 @@ InterfaceOp ESIHWBuilder::constructInterface(ChannelType chan) {
 //===----------------------------------------------------------------------===//
 
 namespace {
-/// Lower `ChannelBufferOp`s, breaking out the various options. For now, just
-/// replace with the specified number of pipeline stages (since that's the only
-/// option).
+/// Lower `ChannelBufferOp`s, breaking out the various options. Replace with
+/// the specified number of pipeline stages, or with a single FIFO of that depth
+/// if the buffer is deep enough to make a chain of stages a waste of registers.
 struct ChannelBufferLowering : public OpConversionPattern<ChannelBufferOp> {
 public:
-  using OpConversionPattern::OpConversionPattern;
+  ChannelBufferLowering(MLIRContext *ctxt, uint64_t fifoDepthThreshold)
+      : OpConversionPattern(ctxt), fifoDepthThreshold(fifoDepthThreshold) {}
 
   LogicalResult
   matchAndRewrite(ChannelBufferOp buffer, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const final;
+
+private:
+  /// The minimum number of stages at which a buffer is lowered to a FIFO. Zero
+  /// if buffers should always be lowered to pipeline stages.
+  uint64_t fifoDepthThreshold;
 };
 } // anonymous namespace
 
@@ -315,6 +358,18 @@ LogicalResult ChannelBufferLowering::matchAndRewrite(
   }
   Value input = buffer.getInput();
   StringAttr bufferName = buffer.getNameAttr();
+
+  // Deep buffers are better off in a RAM than in a chain of registers.
+  if (fifoDepthThreshold != 0 && numStages >= fifoDepthThreshold) {
+    auto fifo = rewriter.create<FIFOOp>(
+        loc, type, buffer.getClk(), buffer.getRst(), input,
+        rewriter.getI64IntegerAttr(numStages));
+    if (bufferName)
+      fifo->setAttr("name", bufferName);
+    rewriter.replaceOp(buffer, fifo.getOutput());
+    return success();
+  }
+
   for (uint64_t i = 0; i < numStages; ++i) {
     // Create the stages, connecting them up as we build.
     auto stage = rewriter.create<PipelineStageOp>(loc, type, buffer.getClk(),
@@ -347,7 +402,7 @@ void ESIToPhysicalPass::runOnOperation() {
 
   // Add all the conversion patterns.
   RewritePatternSet patterns(&getContext());
-  patterns.insert<ChannelBufferLowering>(&getContext());
+  patterns.insert<ChannelBufferLowering>(&getContext(), fifoDepthThreshold);
 
   // Run the conversion.
   if (failed(
@@ -861,6 +916,52 @@ void ESIPortsPass::updateInstance(HWModuleExternOp mod, InstanceOp inst) {
 // Lower to HW/SV conversions and pass.
 //===----------------------------------------------------------------------===//
 
+/// Replace `op` with an instance of one of the hand-coded buffer modules, which
+/// all share the same valid/ready ports. Unwrap the `input` channel into the
+/// instance and wrap its outputs back up into a channel.
+static void replaceWithBufferInstance(Operation *op, Value clk, Value rst,
+                                      Value input, HWModuleExternOp bufferMod,
+                                      ArrayAttr params, StringRef defaultName,
+                                      ConversionPatternRewriter &rewriter) {
+  auto loc = op->getLoc();
+  auto chPort = input.getType().cast<ChannelType>();
+
+  // Unwrap the channel. The ready signal is a Value we haven't created yet, so
+  // create a temp value and replace it later. Give this constant an odd-looking
+  // type to make debugging easier.
+  circt::BackedgeBuilder back(rewriter, loc);
+  circt::Backedge wrapReady = back.get(rewriter.getI1Type());
+  auto unwrap = rewriter.create<UnwrapValidReadyOp>(loc, input, wrapReady);
+
+  StringRef instName = defaultName;
+  if (auto name = op->getAttrOfType<StringAttr>("name"))
+    instName = name.getValue();
+
+  circt::Backedge bufferReady = back.get(rewriter.getI1Type());
+  llvm::SmallVector<Value> operands = {clk, rst};
+  operands.push_back(unwrap.getRawOutput());
+  operands.push_back(unwrap.getValid());
+  operands.push_back(bufferReady);
+  auto bufferInst = rewriter.create<InstanceOp>(loc, bufferMod, instName,
+                                                operands, params);
+  auto bufferInstResults = bufferInst.getResults();
+
+  // Set a_ready (from the unwrap) back edge correctly to its output from the
+  // buffer.
+  wrapReady.setValue(bufferInstResults[0]);
+  Value x, xValid;
+  x = bufferInstResults[1];
+  xValid = bufferInstResults[2];
+
+  // Wrap up the output of the HW buffer module.
+  auto wrap = rewriter.create<WrapValidReadyOp>(
+      loc, chPort, rewriter.getI1Type(), x, xValid);
+  // Set the buffer's x_ready backedge correctly.
+  bufferReady.setValue(wrap.getReady());
+
+  rewriter.replaceOp(op, wrap.getChanOutput());
+}
+
 namespace {
 /// Lower PipelineStageOp ops to an HW implementation. Unwrap and re-wrap
 /// appropriately. Another conversion will take care merging the resulting
@@ -883,7 +984,6 @@ private:
 LogicalResult PipelineStageLowering::matchAndRewrite(
     PipelineStageOp stage, OpAdaptor adaptor,
     ConversionPatternRewriter &rewriter) const {
-  auto loc = stage.getLoc();
   auto chPort = stage.getInput().getType().dyn_cast<ChannelType>();
   if (!chPort)
     return rewriter.notifyMatchFailure(stage, "stage had wrong type");
@@ -895,41 +995,45 @@ LogicalResult PipelineStageLowering::matchAndRewrite(
   ArrayAttr stageParams =
       builder.getStageParameterList(rewriter.getUI32IntegerAttr(width));
 
-  // Unwrap the channel. The ready signal is a Value we haven't created yet, so
-  // create a temp value and replace it later. Give this constant an odd-looking
-  // type to make debugging easier.
-  circt::BackedgeBuilder back(rewriter, loc);
-  circt::Backedge wrapReady = back.get(rewriter.getI1Type());
-  auto unwrap =
-      rewriter.create<UnwrapValidReadyOp>(loc, stage.getInput(), wrapReady);
-
-  StringRef pipeStageName = "pipelineStage";
-  if (auto name = stage->getAttrOfType<StringAttr>("name"))
-    pipeStageName = name.getValue();
-
   // Instantiate the "ESI_PipelineStage" external module.
-  circt::Backedge stageReady = back.get(rewriter.getI1Type());
-  llvm::SmallVector<Value> operands = {stage.getClk(), stage.getRst()};
-  operands.push_back(unwrap.getRawOutput());
-  operands.push_back(unwrap.getValid());
-  operands.push_back(stageReady);
-  auto stageInst = rewriter.create<InstanceOp>(loc, stageModule, pipeStageName,
-                                               operands, stageParams);
-  auto stageInstResults = stageInst.getResults();
+  replaceWithBufferInstance(stage, stage.getClk(), stage.getRst(),
+                            stage.getInput(), stageModule, stageParams,
+                            "pipelineStage", rewriter);
+  return success();
+}
 
-  // Set a_ready (from the unwrap) back edge correctly to its output from stage.
-  wrapReady.setValue(stageInstResults[0]);
-  Value x, xValid;
-  x = stageInstResults[1];
-  xValid = stageInstResults[2];
+namespace {
+/// Lower FIFOOp ops to an HW implementation, the same way as PipelineStageOps.
+struct FIFOLowering : public OpConversionPattern<FIFOOp> {
+public:
+  FIFOLowering(ESIHWBuilder &builder, MLIRContext *ctxt)
+      : OpConversionPattern(ctxt), builder(builder) {}
+  using OpConversionPattern::OpConversionPattern;
 
-  // Wrap up the output of the HW stage module.
-  auto wrap = rewriter.create<WrapValidReadyOp>(
-      loc, chPort, rewriter.getI1Type(), x, xValid);
-  // Set the stages x_ready backedge correctly.
-  stageReady.setValue(wrap.getReady());
+  LogicalResult
+  matchAndRewrite(FIFOOp fifo, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const final;
 
-  rewriter.replaceOp(stage, wrap.getChanOutput());
+private:
+  ESIHWBuilder &builder;
+};
+} // anonymous namespace
+
+LogicalResult
+FIFOLowering::matchAndRewrite(FIFOOp fifo, OpAdaptor adaptor,
+                              ConversionPatternRewriter &rewriter) const {
+  Operation *symTable = fifo->getParentWithTrait<OpTrait::SymbolTable>();
+  auto fifoModule = builder.declareFIFO(symTable, fifo);
+
+  size_t width = circt::hw::getBitWidth(fifo.innerType());
+  ArrayAttr fifoParams = builder.getFIFOParameterList(
+      rewriter.getUI32IntegerAttr(width),
+      rewriter.getUI32IntegerAttr(fifo.getDepth()));
+
+  // Instantiate the "ESI_FIFO" external module.
+  replaceWithBufferInstance(fifo, fifo.getClk(), fifo.getRst(),
+                            fifo.getInput(), fifoModule, fifoParams, "fifo",
+                            rewriter);
   return success();
 }
 
@@ -1291,12 +1395,13 @@ void ESItoHWPass::runOnOperation() {
   pass1Target.addLegalOp<CapnpDecodeOp, CapnpEncodeOp>();
 
   pass1Target.addIllegalOp<WrapSVInterfaceOp, UnwrapSVInterfaceOp>();
-  pass1Target.addIllegalOp<PipelineStageOp>();
+  pass1Target.addIllegalOp<PipelineStageOp, FIFOOp>();
 
   // Add all the conversion patterns.
   ESIHWBuilder esiBuilder(top);
   RewritePatternSet pass1Patterns(ctxt);
   pass1Patterns.insert<PipelineStageLowering>(esiBuilder, ctxt);
+  pass1Patterns.insert<FIFOLowering>(esiBuilder, ctxt);
   pass1Patterns.insert<WrapInterfaceLower>(ctxt);
   pass1Patterns.insert<UnwrapInterfaceLower>(ctxt);
   pass1Patterns.insert<CosimLowering>(esiBuilder);
@@ -337,35 +337,46 @@ LogicalResult ESIConnectServicesPass::process(hw::HWMutableModuleLike mod) {
       anyServiceInst = b;
   }
 
-  // Decompose the 'inout' requests int to 'in' and 'out' requests.
-  mod.walk([&](RequestInOutChannelOp reqInOut) {
-    ImplicitLocOpBuilder b(reqInOut.getLoc(), reqInOut);
-    b.create<RequestToServerConnectionOp>(reqInOut.getServicePortAttr(),
-                                          reqInOut.getToServer(),
-                                          reqInOut.getClientNamePathAttr());
-    auto toClientReq = b.create<RequestToClientConnectionOp>(
-        reqInOut.getToClient().getType(), reqInOut.getServicePortAttr(),
-        reqInOut.getClientNamePathAttr());
-    reqInOut.getToClient().replaceAllUsesWith(toClientReq.getToClient());
-    reqInOut.erase();
-  });
-
-  // Find all of the "local" requests.
+  // Gather all the requests in a single walk. Move the "local" ones into the
+  // request block of the service instance which serves them and collect the
+  // non-local ones, which need to be surfaced from this module all at once.
+  SmallVector<RequestToClientConnectionOp, 4> nonLocalToClientReqs;
+  SmallVector<RequestToServerConnectionOp, 4> nonLocalToServerReqs;
+  auto isLocal = [&](Operation *req, hw::InnerRefAttr servicePort) {
+    auto implOpF = localImplReqs.find(servicePort.getModuleRef());
+    Block *portReqs =
+        implOpF != localImplReqs.end() ? implOpF->second : anyServiceInst;
+    if (!portReqs)
+      return false;
+    req->moveBefore(portReqs, portReqs->end());
+    return true;
+  };
+  auto gatherToClient = [&](RequestToClientConnectionOp req) {
+    if (!isLocal(req, req.getServicePortAttr()))
+      nonLocalToClientReqs.push_back(req);
+  };
+  auto gatherToServer = [&](RequestToServerConnectionOp req) {
+    if (!isLocal(req, req.getServicePortAttr()))
+      nonLocalToServerReqs.push_back(req);
+  };
   mod.walk([&](Operation *op) {
     if (auto req = dyn_cast<RequestToClientConnectionOp>(op)) {
-      auto service = req.getServicePortAttr().getModuleRef();
-      auto implOpF = localImplReqs.find(service);
-      if (implOpF != localImplReqs.end())
-        req->moveBefore(implOpF->second, implOpF->second->end());
-      else if (anyServiceInst)
-        req->moveBefore(anyServiceInst, anyServiceInst->end());
+      gatherToClient(req);
     } else if (auto req = dyn_cast<RequestToServerConnectionOp>(op)) {
-      auto service = req.getServicePortAttr().getModuleRef();
-      auto implOpF = localImplReqs.find(service);
-      if (implOpF != localImplReqs.end())
-        req->moveBefore(implOpF->second, implOpF->second->end());
-      else if (anyServiceInst)
-        req->moveBefore(anyServiceInst, anyServiceInst->end());
+      gatherToServer(req);
+    } else if (auto reqInOut = dyn_cast<RequestInOutChannelOp>(op)) {
+      // Decompose the 'inout' requests in to 'in' and 'out' requests.
+      ImplicitLocOpBuilder b(reqInOut.getLoc(), reqInOut);
+      auto toServerReq = b.create<RequestToServerConnectionOp>(
+          reqInOut.getServicePortAttr(), reqInOut.getToServer(),
+          reqInOut.getClientNamePathAttr());
+      auto toClientReq = b.create<RequestToClientConnectionOp>(
+          reqInOut.getToClient().getType(), reqInOut.getServicePortAttr(),
+          reqInOut.getClientNamePathAttr());
+      reqInOut.getToClient().replaceAllUsesWith(toClientReq.getToClient());
+      reqInOut.erase();
+      gatherToServer(toServerReq);
+      gatherToClient(toClientReq);
     }
   });
 
@@ -381,23 +392,6 @@ LogicalResult ESIConnectServicesPass::process(hw::HWMutableModuleLike mod) {
   // Copy any metadata up the instance hierarchy.
   copyMetadata(mod);
 
-  // Identify the non-local reqs which need to be surfaced from this module.
-  SmallVector<RequestToClientConnectionOp, 4> nonLocalToClientReqs;
-  SmallVector<RequestToServerConnectionOp, 4> nonLocalToServerReqs;
-  mod.walk([&](Operation *op) {
-    if (auto req = dyn_cast<RequestToClientConnectionOp>(op)) {
-      auto service = req.getServicePortAttr().getModuleRef();
-      auto implOpF = localImplReqs.find(service);
-      if (implOpF == localImplReqs.end())
-        nonLocalToClientReqs.push_back(req);
-    } else if (auto req = dyn_cast<RequestToServerConnectionOp>(op)) {
-      auto service = req.getServicePortAttr().getModuleRef();
-      auto implOpF = localImplReqs.find(service);
-      if (implOpF == localImplReqs.end())
-        nonLocalToServerReqs.push_back(req);
-    }
-  });
-
   // Surface all of the requests which cannot be fulfilled locally.
   if (nonLocalToClientReqs.empty() && nonLocalToServerReqs.empty())
     return success();
@@ -576,6 +570,8 @@ LogicalResult ESIConnectServicesPass::surfaceReqs(
   SmallVector<hw::HWInstanceLike, 1> newModuleInstantiations;
   StringAttr argsAttrName = StringAttr::get(ctxt, "argNames");
   StringAttr resultsAttrName = StringAttr::get(ctxt, "resultNames");
+  ArrayAttr argNames = mod.getArgNames();
+  ArrayAttr resultNames = mod.getResultNames();
   for (auto inst : moduleInstantiations[mod]) {
     OpBuilder b(inst);
 
@@ -603,10 +599,9 @@ LogicalResult ESIConnectServicesPass::surfaceReqs(
     SmallVector<NamedAttribute> newAttrs;
     for (auto attr : inst->getAttrs()) {
       if (attr.getName() == argsAttrName)
-        newAttrs.push_back(b.getNamedAttr(argsAttrName, mod.getArgNames()));
+        newAttrs.push_back(b.getNamedAttr(argsAttrName, argNames));
       else if (attr.getName() == resultsAttrName)
-        newAttrs.push_back(
-            b.getNamedAttr(resultsAttrName, mod.getResultNames()));
+        newAttrs.push_back(b.getNamedAttr(resultsAttrName, resultNames));
       else
         newAttrs.push_back(attr);
     }
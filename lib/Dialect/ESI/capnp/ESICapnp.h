@@ -42,6 +42,8 @@ struct TypeSchemaImpl;
 } // namespace detail
 
 /// Generate and reason about a Cap'nProto schema for a particular MLIR type.
+/// Schemas are memoized per type, such that constructing a TypeSchema for a
+/// type seen before is cheap and shares the parsed capnp schema.
 class TypeSchema {
 public:
   TypeSchema(mlir::Type);
@@ -68,10 +70,13 @@ public:
   /// Write out the schema in its entirety.
   mlir::LogicalResult write(llvm::raw_ostream &os) const;
 
-  /// Build an HW/SV dialect capnp encoder for this type.
+  /// Build an HW/SV dialect capnp encoder for this type. The encoder module is
+  /// generated once per type and top-level module, and instantiated for every
+  /// use.
   mlir::Value buildEncoder(mlir::OpBuilder &, mlir::Value clk,
                            mlir::Value valid, mlir::Value rawData) const;
-  /// Build an HW/SV dialect capnp decoder for this type.
+  /// Build an HW/SV dialect capnp decoder for this type. Shared like the
+  /// encoder.
   mlir::Value buildDecoder(mlir::OpBuilder &, mlir::Value clk,
                            mlir::Value valid, mlir::Value capnpData) const;
 
@@ -79,10 +84,6 @@ private:
   /// The implementation of this. Separate to hide the details and avoid having
   /// to include the capnp headers in this header.
   std::shared_ptr<detail::TypeSchemaImpl> s;
-
-  /// Cache of the decode/encode modules;
-  static llvm::SmallDenseMap<Type, hw::HWModuleOp> decImplMods;
-  static llvm::SmallDenseMap<Type, hw::HWModuleOp> encImplMods;
 };
 
 } // namespace capnp
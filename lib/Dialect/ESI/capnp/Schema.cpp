@@ -23,10 +23,12 @@
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "llvm/ADT/IntervalMap.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/Format.h"
 
 #include <initializer_list>
+#include <mutex>
 #include <string>
 
 using namespace circt::esi::capnp::detail;
@@ -104,6 +106,10 @@ public:
 
   bool operator==(const TypeSchemaImpl &) const;
 
+  /// Compute all the lazily computed properties of the schema. Afterwards, the
+  /// schema is only read, hence can be shared across threads.
+  void populateCaches() const;
+
   /// Build an HW/SV dialect capnp encoder for this type.
   hw::HWModuleOp buildEncoder(Value clk, Value valid, Value);
   /// Build an HW/SV dialect capnp decoder for this type.
@@ -457,6 +463,14 @@ bool TypeSchemaImpl::operator==(const TypeSchemaImpl &that) const {
   return type == that.type;
 }
 
+void TypeSchemaImpl::populateCaches() const {
+  capnpTypeID();
+  if (!isSupported())
+    return;
+  name();
+  getTypeSchema();
+}
+
 //===----------------------------------------------------------------------===//
 // Helper classes for common operations in the encode / decoders
 //===----------------------------------------------------------------------===//
@@ -950,6 +964,9 @@ hw::HWModuleOp TypeSchemaImpl::buildEncoder(Value clk, Value valid,
   SmallString<64> modName;
   modName.append("encode");
   modName.append(name());
+  // Share the encoder among all the uses of the type.
+  if (auto existing = topMod.lookupSymbol<hw::HWModuleOp>(modName))
+    return existing;
   SmallVector<hw::PortInfo, 4> ports;
   ports.push_back(hw::PortInfo{b.getStringAttr("clk"), hw::PortDirection::INPUT,
                                clk.getType(), 0});
@@ -1125,6 +1142,9 @@ hw::HWModuleOp TypeSchemaImpl::buildDecoder(Value clk, Value valid,
   SmallString<64> modName;
   modName.append("decode");
   modName.append(name());
+  // Share the decoder among all the uses of the type.
+  if (auto existing = topMod.lookupSymbol<hw::HWModuleOp>(modName))
+    return existing;
   SmallVector<hw::PortInfo, 4> ports;
   ports.push_back(hw::PortInfo{b.getStringAttr("clk"), hw::PortDirection::INPUT,
                                clk.getType(), 0});
@@ -1228,16 +1248,26 @@ hw::HWModuleOp TypeSchemaImpl::buildDecoder(Value clk, Value valid,
 // TypeSchema wrapper.
 //===----------------------------------------------------------------------===//
 
-llvm::SmallDenseMap<Type, hw::HWModuleOp>
-    circt::esi::capnp::TypeSchema::decImplMods;
-llvm::SmallDenseMap<Type, hw::HWModuleOp>
-    circt::esi::capnp::TypeSchema::encImplMods;
+/// The schemas of all the types seen so far. Parsing a schema with the capnp
+/// library is expensive, so every type is only parsed once. The cache is
+/// keyed by the textual form of the types since it outlives their contexts.
+static llvm::StringMap<std::shared_ptr<detail::TypeSchemaImpl>> schemaCache;
+static std::mutex schemaCacheMutex;
 
 circt::esi::capnp::TypeSchema::TypeSchema(Type type) {
   circt::esi::ChannelType chan = type.dyn_cast<circt::esi::ChannelType>();
   if (chan) // Unwrap the channel if it's a channel.
     type = chan.getInner();
-  s = std::make_shared<detail::TypeSchemaImpl>(type);
+
+  std::string key;
+  llvm::raw_string_ostream(key) << type;
+  std::lock_guard<std::mutex> lock(schemaCacheMutex);
+  auto &cached = schemaCache[key];
+  if (!cached || cached->getType() != type) {
+    cached = std::make_shared<detail::TypeSchemaImpl>(type);
+    cached->populateCaches();
+  }
+  s = cached;
 }
 Type circt::esi::capnp::TypeSchema::getType() const { return s->getType(); }
 uint64_t circt::esi::capnp::TypeSchema::capnpTypeID() const {
@@ -1261,14 +1291,7 @@ bool circt::esi::capnp::TypeSchema::operator==(const TypeSchema &that) const {
 Value circt::esi::capnp::TypeSchema::buildEncoder(OpBuilder &builder, Value clk,
                                                   Value valid,
                                                   Value operand) const {
-  hw::HWModuleOp encImplMod;
-  auto encImplIT = encImplMods.find(getType());
-  if (encImplIT == encImplMods.end()) {
-    encImplMod = s->buildEncoder(clk, valid, operand);
-    encImplMods[getType()] = encImplMod;
-  } else {
-    encImplMod = encImplIT->second;
-  }
+  hw::HWModuleOp encImplMod = s->buildEncoder(clk, valid, operand);
 
   SmallString<64> instName;
   instName.append("encode");
@@ -1283,14 +1306,7 @@ Value circt::esi::capnp::TypeSchema::buildEncoder(OpBuilder &builder, Value clk,
 Value circt::esi::capnp::TypeSchema::buildDecoder(OpBuilder &builder, Value clk,
                                                   Value valid,
                                                   Value operand) const {
-  hw::HWModuleOp decImplMod;
-  auto decImplIT = decImplMods.find(getType());
-  if (decImplIT == decImplMods.end()) {
-    decImplMod = s->buildDecoder(clk, valid, operand);
-    decImplMods[getType()] = decImplMod;
-  } else {
-    decImplMod = decImplIT->second;
-  }
+  hw::HWModuleOp decImplMod = s->buildDecoder(clk, valid, operand);
 
   SmallString<64> instName;
   instName.append("decode");
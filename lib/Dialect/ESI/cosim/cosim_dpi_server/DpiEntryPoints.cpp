@@ -21,6 +21,8 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <string>
+#include <unistd.h>
 
 using namespace circt::esi::cosim;
 
@@ -32,15 +34,15 @@ static std::mutex serverMutex;
 // ---- Helper functions ----
 
 /// Emit the contents of 'msg' to the log file in hex.
-static void log(char *epId, bool toClient, const Endpoint::BlobPtr &msg) {
+static void log(char *epId, bool toClient, const uint8_t *msg,
+                size_t msgSize) {
   std::lock_guard<std::mutex> g(serverMutex);
   if (!logFile)
     return;
 
   fprintf(logFile, "[ep: %50s to: %4s]", epId, toClient ? "host" : "sim");
-  size_t msgSize = msg->size();
   for (size_t i = 0; i < msgSize; ++i) {
-    auto b = (*msg)[i];
+    auto b = msg[i];
     // Separate 32-bit words.
     if (i % 4 == 0 && i > 0)
       fprintf(logFile, " ");
@@ -95,6 +97,57 @@ static int validateSvOpenArray(const svOpenArrayHandle data,
   return 0;
 }
 
+/// Copy the message 'msg' of 'msgSize' bytes into 'data' at 'offset',
+/// zero-padding it to 'limit' bytes.
+// NOLINTNEXTLINE(misc-misplaced-const)
+static void copyToSvArray(const svOpenArrayHandle data, size_t offset,
+                          size_t limit, const uint8_t *msg, size_t msgSize) {
+  size_t i;
+  for (i = 0; i < msgSize; ++i) {
+    auto b = msg[i];
+    *(char *)svGetArrElemPtr1(data, offset + i) = b;
+  }
+  // Zero out the rest of the buffer.
+  for (; i < limit; ++i) {
+    *(char *)svGetArrElemPtr1(data, offset + i) = 0;
+  }
+}
+
+/// Copy the message 'msg' of 'msgSize' bytes into 'data'. Returns zero on
+/// success.
+// NOLINTNEXTLINE(misc-misplaced-const)
+static int copyMessageToSim(char *endpointId, const svOpenArrayHandle data,
+                            unsigned int *dataSize, const uint8_t *msg,
+                            size_t msgSize) {
+  log(endpointId, false, msg, msgSize);
+
+  if (validateSvOpenArray(data, sizeof(int8_t)) != 0) {
+    printf("ERROR: DPI-func=%s line=%d event=invalid-sv-array\n", __func__,
+           __LINE__);
+    return -2;
+  }
+
+  // Detect or verify size of buffer.
+  if (*dataSize == ~0u) {
+    *dataSize = svSizeOfArray(data);
+  } else if (*dataSize > (unsigned)svSizeOfArray(data)) {
+    printf("ERROR: DPI-func=%s line %d event=invalid-size (max %d)\n", __func__,
+           __LINE__, (unsigned)svSizeOfArray(data));
+    return -3;
+  }
+  // Verify it'll fit.
+  if (msgSize > *dataSize) {
+    printf("ERROR: Message size too big to fit in HW buffer\n");
+    return -5;
+  }
+
+  // Copy the message data.
+  copyToSvArray(data, 0, *dataSize, msg, msgSize);
+  // Set the output data size.
+  *dataSize = msgSize;
+  return 0;
+}
+
 // ---- DPI entry points ----
 
 // Register simulated device endpoints.
@@ -130,9 +183,11 @@ DPI int sv2cCosimserverEpTryGet(char *endpointId,
     return -4;
   }
 
-  Endpoint::BlobPtr msg;
   // Poll for a message.
-  if (!ep->getMessageToSim(msg)) {
+  MessageRing &toSim = ep->getToSim();
+  size_t msgSize;
+  const uint8_t *msg = toSim.front(msgSize);
+  if (!msg) {
     // No message.
     *dataSize = 0;
     return 0;
@@ -140,8 +195,22 @@ DPI int sv2cCosimserverEpTryGet(char *endpointId,
   // Do the validation only if there's a message available. Since the
   // simulator is going to poll up to every tick and there's not going to be
   // a message most of the time, this is important for performance.
+  int rc = copyMessageToSim(endpointId, data, dataSize, msg, msgSize);
+  // The message is consumed even if it could not be delivered.
+  toSim.pop();
+  return rc;
+}
 
-  log(endpointId, false, msg);
+// Attempt to send data to a client.
+// - return 0 on success, negative on failure (unregistered EP, or the queue to
+//   the client is full).
+// - if dataSize is negative, attempt to dynamically determine the size of
+//   'data'.
+DPI int sv2cCosimserverEpTryPut(char *endpointId,
+                                // NOLINTNEXTLINE(misc-misplaced-const)
+                                const svOpenArrayHandle data, int dataSize) {
+  if (server == nullptr)
+    return -1;
 
   if (validateSvOpenArray(data, sizeof(int8_t)) != 0) {
     printf("ERROR: DPI-func=%s line=%d event=invalid-sv-array\n", __func__,
@@ -149,43 +218,101 @@ DPI int sv2cCosimserverEpTryGet(char *endpointId,
     return -2;
   }
 
-  // Detect or verify size of buffer.
-  if (*dataSize == ~0u) {
-    *dataSize = svSizeOfArray(data);
-  } else if (*dataSize > (unsigned)svSizeOfArray(data)) {
-    printf("ERROR: DPI-func=%s line %d event=invalid-size (max %d)\n", __func__,
-           __LINE__, (unsigned)svSizeOfArray(data));
+  // Detect or verify size.
+  if (dataSize < 0) {
+    dataSize = svSizeOfArray(data);
+  } else if (dataSize > svSizeOfArray(data)) { // not enough data
+    printf("ERROR: DPI-func=%s line %d event=invalid-size limit %d array %d\n",
+           __func__, __LINE__, dataSize, svSizeOfArray(data));
     return -3;
   }
-  // Verify it'll fit.
-  size_t msgSize = msg->size();
-  if (msgSize > *dataSize) {
-    printf("ERROR: Message size too big to fit in HW buffer\n");
+
+  Endpoint *ep = server->endpoints[endpointId];
+  if (!ep) {
+    fprintf(stderr, "Endpoint not found in registry!\n");
+    return -4;
+  }
+  MessageRing &toClient = ep->getToClient();
+  if ((size_t)dataSize > toClient.getMaxMessageSize()) {
+    printf("ERROR: DPI-func=%s line %d event=invalid-size limit %zu\n",
+           __func__, __LINE__, toClient.getMaxMessageSize());
+    return -3;
+  }
+  uint8_t *msg = toClient.reserve();
+  if (!msg) {
+    printf("ERROR: DPI-func=%s line %d event=queue-full\n", __func__, __LINE__);
     return -5;
   }
+  // Copy the message data into the queue.
+  for (int i = 0; i < dataSize; ++i) {
+    msg[i] = *(char *)svGetArrElemPtr1(data, i);
+  }
+  log(endpointId, true, msg, dataSize);
+  toClient.commit(dataSize);
+  return 0;
+}
 
-  // Copy the message data.
-  size_t i;
-  for (i = 0; i < msgSize; ++i) {
-    auto b = (*msg)[i];
-    *(char *)svGetArrElemPtr1(data, i) = b;
+// Attempt to recieve up to '*numMsgs' messages from a client in one call.
+//   - Returns negative when call failed (e.g. EP not registered).
+//   - Sets '*numMsgs' to the number of messages recieved, which may be 0.
+//   - The messages are packed into 'data' at a stride of 'msgSize' bytes, each
+//     zero-padded to that size. Fails if a message is larger.
+DPI int sv2cCosimserverEpTryGetBatch(char *endpointId,
+                                     // NOLINTNEXTLINE(misc-misplaced-const)
+                                     const svOpenArrayHandle data,
+                                     unsigned int msgSize,
+                                     unsigned int *numMsgs) {
+  unsigned int maxMsgs = *numMsgs;
+  *numMsgs = 0;
+  if (server == nullptr)
+    return -1;
+
+  Endpoint *ep = server->endpoints[endpointId];
+  if (!ep) {
+    fprintf(stderr, "Endpoint not found in registry!\n");
+    return -4;
   }
-  // Zero out the rest of the buffer.
-  for (; i < *dataSize; ++i) {
-    *(char *)svGetArrElemPtr1(data, i) = 0;
+
+  // As in the single message case, only validate once there's a message.
+  MessageRing &toSim = ep->getToSim();
+  size_t available = toSim.getNumMessages();
+  if (available == 0)
+    return 0;
+  if (validateSvOpenArray(data, sizeof(int8_t)) != 0) {
+    printf("ERROR: DPI-func=%s line=%d event=invalid-sv-array\n", __func__,
+           __LINE__);
+    return -2;
+  }
+  if ((size_t)msgSize * maxMsgs > (size_t)svSizeOfArray(data)) {
+    printf("ERROR: DPI-func=%s line %d event=invalid-size (max %d)\n", __func__,
+           __LINE__, (unsigned)svSizeOfArray(data));
+    return -3;
+  }
+
+  for (size_t n = std::min<size_t>(available, maxMsgs); *numMsgs < n;) {
+    size_t size;
+    const uint8_t *msg = toSim.front(size);
+    log(endpointId, false, msg, size);
+    if (size > msgSize) {
+      printf("ERROR: Message size too big to fit in HW buffer\n");
+      toSim.pop();
+      return -5;
+    }
+    copyToSvArray(data, (size_t)*numMsgs * msgSize, msgSize, msg, size);
+    toSim.pop();
+    ++*numMsgs;
   }
-  // Set the output data size.
-  *dataSize = msg->size();
   return 0;
 }
 
-// Attempt to send data to a client.
-// - return 0 on success, negative on failure (unregistered EP).
-// - if dataSize is negative, attempt to dynamically determine the size of
-//   'data'.
-DPI int sv2cCosimserverEpTryPut(char *endpointId,
-                                // NOLINTNEXTLINE(misc-misplaced-const)
-                                const svOpenArrayHandle data, int dataSize) {
+// Attempt to send 'numMsgs' messages of 'msgSize' bytes each, packed into
+// 'data', to a client in one call.
+// - return the number of messages queued, which is less than 'numMsgs' if the
+//   queue to the client fills up, or negative on failure (unregistered EP).
+DPI int sv2cCosimserverEpTryPutBatch(char *endpointId,
+                                     // NOLINTNEXTLINE(misc-misplaced-const)
+                                     const svOpenArrayHandle data, int msgSize,
+                                     int numMsgs) {
   if (server == nullptr)
     return -1;
 
@@ -194,30 +321,38 @@ DPI int sv2cCosimserverEpTryPut(char *endpointId,
            __LINE__);
     return -2;
   }
-
-  // Detect or verify size.
-  if (dataSize < 0) {
-    dataSize = svSizeOfArray(data);
-  } else if (dataSize > svSizeOfArray(data)) { // not enough data
+  if (msgSize < 0 || numMsgs < 0 ||
+      (size_t)msgSize * numMsgs > (size_t)svSizeOfArray(data)) {
     printf("ERROR: DPI-func=%s line %d event=invalid-size limit %d array %d\n",
-           __func__, __LINE__, dataSize, svSizeOfArray(data));
+           __func__, __LINE__, msgSize * numMsgs, svSizeOfArray(data));
     return -3;
   }
 
-  Endpoint::BlobPtr blob = std::make_shared<Endpoint::Blob>(dataSize);
-  // Copy the message data into 'blob'.
-  for (int i = 0; i < dataSize; ++i) {
-    (*blob)[i] = *(char *)svGetArrElemPtr1(data, i);
-  }
-  // Queue the blob.
   Endpoint *ep = server->endpoints[endpointId];
   if (!ep) {
     fprintf(stderr, "Endpoint not found in registry!\n");
     return -4;
   }
-  log(endpointId, true, blob);
-  ep->pushMessageToClient(blob);
-  return 0;
+  MessageRing &toClient = ep->getToClient();
+  if ((size_t)msgSize > toClient.getMaxMessageSize()) {
+    printf("ERROR: DPI-func=%s line %d event=invalid-size limit %zu\n",
+           __func__, __LINE__, toClient.getMaxMessageSize());
+    return -3;
+  }
+
+  int numSent = 0;
+  for (; numSent < numMsgs; ++numSent) {
+    uint8_t *msg = toClient.reserve();
+    if (!msg)
+      break;
+    // Copy the message data into the queue.
+    size_t offset = (size_t)numSent * msgSize;
+    for (int i = 0; i < msgSize; ++i)
+      msg[i] = *(char *)svGetArrElemPtr1(data, offset + i);
+    log(endpointId, true, msg, msgSize);
+    toClient.commit(msgSize);
+  }
+  return numSent;
 }
 
 // Teardown cosimserver (disconnects from primary server port, stops connections
@@ -226,7 +361,9 @@ DPI void sv2cCosimserverFinish() {
   std::lock_guard<std::mutex> g(serverMutex);
   printf("[cosim] Tearing down RPC server.\n");
   if (server != nullptr) {
-    server->stop();
+    // Deleting the server stops it and removes the shared memory objects of
+    // its endpoints.
+    delete server;
     server = nullptr;
 
     fclose(logFile);
@@ -249,6 +386,12 @@ DPI int sv2cCosimserverInit() {
     // Find the port and run.
     printf("[cosim] Starting RPC server.\n");
     server = new RpcServer();
+    // Let clients on the same host bypass the RPC server if requested.
+    if (getenv("COSIM_SHM") != nullptr) {
+      printf("[cosim] Placing endpoint queues into shared memory.\n");
+      server->endpoints.enableSharedMemory("/esi-cosim-" +
+                                           std::to_string(getpid()));
+    }
     server->run(findPort());
   }
   return 0;
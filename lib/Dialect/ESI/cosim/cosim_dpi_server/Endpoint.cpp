@@ -12,11 +12,115 @@
 
 #include "circt/Dialect/ESI/cosim/Endpoint.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 using namespace circt::esi::cosim;
 
+size_t MessageRing::getRegionSize(size_t maxMessageSize, size_t numSlots) {
+  size_t slotWords = (maxMessageSize + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+  size_t size =
+      sizeof(Header) + numSlots * (1 + slotWords) * sizeof(uint64_t);
+  return (size + alignof(Header) - 1) / alignof(Header) * alignof(Header);
+}
+
+MessageRing::MessageRing(size_t maxMessageSize, size_t numSlots, void *region)
+    : ownedRegion(nullptr, std::free), numSlots(numSlots),
+      slotWords((maxMessageSize + sizeof(uint64_t) - 1) / sizeof(uint64_t)),
+      pushTimes(new uint64_t[numSlots]()), numBytes(0), maxDepth(0),
+      latencyHistogram() {
+  if (!region) {
+    region = std::aligned_alloc(alignof(Header),
+                                getRegionSize(maxMessageSize, numSlots));
+    ownedRegion.reset(region);
+  }
+  header = new (region) Header();
+  header->head.store(0);
+  header->tail.store(0);
+  header->numSlots = numSlots;
+  header->slotWords = slotWords;
+  sizes = reinterpret_cast<uint64_t *>(header + 1);
+  slots = sizes + numSlots;
+}
+
+MessageRing::Stats MessageRing::getStats() const {
+  Stats stats;
+  // Messages exchanged through shared memory are counted as well, since the
+  // header is shared.
+  stats.numMessages = header->tail.load(std::memory_order_relaxed);
+  stats.numBytes = numBytes.load(std::memory_order_relaxed);
+  stats.maxDepth = maxDepth.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < numLatencyBuckets; ++i)
+    stats.latencyHistogram[i] =
+        latencyHistogram[i].load(std::memory_order_relaxed);
+  return stats;
+}
+
+SharedMemory::SharedMemory(std::string name, size_t size)
+    : name(std::move(name)), size(size), base(nullptr) {
+  int fd = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0)
+    return;
+  if (ftruncate(fd, size) == 0) {
+    void *mapping =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping != MAP_FAILED)
+      base = mapping;
+  }
+  close(fd);
+  if (!base)
+    shm_unlink(this->name.c_str());
+}
+
+SharedMemory::~SharedMemory() {
+  if (!base)
+    return;
+  munmap(base, size);
+  shm_unlink(name.c_str());
+}
+
+/// Create the shared memory object for the queues of an endpoint, if it has a
+/// name. Falls back to private queues if the object cannot be created.
+static std::unique_ptr<SharedMemory> createSharedMemory(const std::string &name,
+                                                        size_t size) {
+  if (name.empty())
+    return nullptr;
+  auto shm = std::make_unique<SharedMemory>(name, size);
+  if (shm->isValid())
+    return shm;
+  fprintf(stderr, "Warning: could not create shared memory '%s': %s\n",
+          name.c_str(), strerror(errno));
+  return nullptr;
+}
+
+/// Returns the largest message of a type of 'maxSize' bytes. Types of unknown
+/// size yield empty slots, which reject all messages.
+static size_t getMaxMessageSize(int maxSize) { return std::max(maxSize, 0); }
+
+/// Returns the memory at 'offset' into 'shm', or null for private queues.
+static void *getRegion(const std::unique_ptr<SharedMemory> &shm,
+                       size_t offset) {
+  return shm ? static_cast<char *>(shm->getBase()) + offset : nullptr;
+}
+
 Endpoint::Endpoint(uint64_t sendTypeId, int sendTypeMaxSize,
-                   uint64_t recvTypeId, int recvTypeMaxSize)
-    : sendTypeId(sendTypeId), recvTypeId(recvTypeId), inUse(false) {}
+                   uint64_t recvTypeId, int recvTypeMaxSize,
+                   const std::string &shmName)
+    : sendTypeId(sendTypeId), recvTypeId(recvTypeId), inUse(false),
+      shm(createSharedMemory(
+          shmName,
+          MessageRing::getRegionSize(getMaxMessageSize(recvTypeMaxSize)) +
+              MessageRing::getRegionSize(getMaxMessageSize(sendTypeMaxSize)))),
+      toCosim(getMaxMessageSize(recvTypeMaxSize), MessageRing::defaultNumSlots,
+              getRegion(shm, 0)),
+      toClient(getMaxMessageSize(sendTypeMaxSize), MessageRing::defaultNumSlots,
+               getRegion(shm, MessageRing::getRegionSize(
+                                  getMaxMessageSize(recvTypeMaxSize)))) {}
 Endpoint::~Endpoint() {}
 
 bool Endpoint::setInUse() {
@@ -43,6 +147,14 @@ bool EndpointRegistry::registerEndpoint(std::string epId, uint64_t sendTypeId,
     fprintf(stderr, "Endpoint ID already exists!\n");
     return false;
   }
+  // Shared memory object names consist of a leading slash and otherwise
+  // portable characters only.
+  std::string shmName;
+  if (!shmPrefix.empty()) {
+    shmName = shmPrefix + "-";
+    for (char c : epId)
+      shmName += isalnum(c) ? c : '_';
+  }
   // The following ugliness adds an Endpoint to the map of Endpoints. The
   // Endpoint class has its copy constructor deleted, thus the metaprogramming.
   endpoints.emplace(std::piecewise_construct,
@@ -50,10 +162,16 @@ bool EndpointRegistry::registerEndpoint(std::string epId, uint64_t sendTypeId,
                     std::forward_as_tuple(epId),
                     // Endpoint constructor args.
                     std::forward_as_tuple(sendTypeId, sendTypeMaxSize,
-                                          recvTypeId, recvTypeMaxSize));
+                                          recvTypeId, recvTypeMaxSize,
+                                          shmName));
   return true;
 }
 
+void EndpointRegistry::enableSharedMemory(std::string prefix) {
+  Lock g(m);
+  shmPrefix = std::move(prefix);
+}
+
 void EndpointRegistry::iterateEndpoints(
     const std::function<void(std::string, const Endpoint &)> &f) const {
   // This function is logically const, but modification is needed to obtain a
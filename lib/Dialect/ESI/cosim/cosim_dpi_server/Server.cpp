@@ -19,6 +19,7 @@
 
 #include "circt/Dialect/ESI/cosim/Server.h"
 #include "circt/Dialect/ESI/cosim/CosimDpi.capnp.h"
+#include <algorithm>
 #include <capnp/ez-rpc.h>
 #include <thread>
 #include <unistd.h>
@@ -35,12 +36,14 @@ class EndpointServer final
     : public EsiDpiEndpoint<capnp::AnyPointer, capnp::AnyPointer>::Server {
   /// The wrapped endpoint.
   Endpoint &endpoint;
+  /// The timer of the RPC event loop, used to wait for messages.
+  kj::Timer &timer;
   /// Signals that this endpoint has been opened by a client and hasn't been
   /// closed by said client.
   bool open;
 
 public:
-  EndpointServer(Endpoint &ep);
+  EndpointServer(Endpoint &ep, kj::Timer &timer);
   /// Release the Endpoint should the client disconnect without properly closing
   /// it.
   ~EndpointServer();
@@ -51,85 +54,147 @@ public:
   kj::Promise<void> send(SendContext) override;
   kj::Promise<void> recv(RecvContext) override;
   kj::Promise<void> close(CloseContext) override;
+  kj::Promise<void> sendBatch(SendBatchContext) override;
+  kj::Promise<void> recvBatch(RecvBatchContext) override;
+
+private:
+  /// Pop a message into the results of 'context', if one is available.
+  /// Returns true if there was a message.
+  bool tryRecv(RecvContext &context);
 };
 
 /// Implements the `CosimDpiServer` interface from the RPC schema.
 class CosimServer final : public CosimDpiServer::Server {
   /// The registry of endpoints. The RpcServer class owns this.
   EndpointRegistry &reg;
+  /// The timer of the RPC event loop. Set once the event loop is up.
+  kj::Timer *timer = nullptr;
 
 public:
   CosimServer(EndpointRegistry &reg);
 
+  void setTimer(kj::Timer &t) { timer = &t; }
+
   /// List all the registered interfaces.
   kj::Promise<void> list(ListContext ctxt) override;
   /// Open a specific interface, locking it in the process.
   kj::Promise<void> open(OpenContext ctxt) override;
+  /// Report the traffic statistics of all the interfaces.
+  kj::Promise<void> stats(StatsContext ctxt) override;
 };
 } // anonymous namespace
 
 /// ------ EndpointServer definitions.
 
-EndpointServer::EndpointServer(Endpoint &ep) : endpoint(ep), open(true) {}
+EndpointServer::EndpointServer(Endpoint &ep, kj::Timer &timer)
+    : endpoint(ep), timer(timer), open(true) {}
 EndpointServer::~EndpointServer() {
   if (open)
     endpoint.returnForUse();
 }
 
+/// Copy the oldest message of 'toClient', which must not be empty, into 'resp'
+/// and release its slot.
+static void popMessage(MessageRing &toClient, AnyPointer::Builder resp) {
+  size_t msgSize;
+  const uint8_t *msg = toClient.front(msgSize);
+  KJ_DEFER(toClient.pop());
+  KJ_REQUIRE(msgSize % 8 == 0,
+             "Response msg was malformed. Size of response was not a "
+             "multiple of 8 bytes.");
+  // Read the message in place from its slot, as a single segment. Setting the
+  // response is the only copy of the message.
+  auto segment =
+      kj::ArrayPtr<const capnp::word>((const word *)msg, msgSize / 8);
+  SegmentArrayMessageReader msgReader(kj::arrayPtr(&segment, 1));
+  resp.set(msgReader.getRoot<AnyPointer>());
+}
+
+/// Build 'msg' directly into a free slot of 'toSim' as a single, flat
+/// segment, which is the only copy. Returns false if the queue is full.
+static bool pushMessage(MessageRing &toSim, AnyPointer::Reader msg) {
+  KJ_REQUIRE(msg.isStruct(), "Only messages can go in the 'msg' parameter");
+
+  // The flat message consists of the root pointer and the message itself.
+  size_t msgWords = msg.targetSize().wordCount + 1;
+  KJ_REQUIRE(msgWords * sizeof(word) <= toSim.getMaxMessageSize(),
+             "Message is larger than the endpoint type");
+  uint8_t *slot = toSim.reserve();
+  if (!slot)
+    return false;
+
+  // Capnp requires the memory of a message under construction to be zeroed.
+  memset(slot, 0, msgWords * sizeof(word));
+  FlatArrayMessageBuilder builder(kj::arrayPtr((word *)slot, msgWords));
+  builder.setRoot(msg);
+  auto segments = builder.getSegmentsForOutput();
+  KJ_ASSERT(segments.size() == 1);
+  toSim.commit(segments[0].asBytes().size());
+  return true;
+}
+
+bool EndpointServer::tryRecv(RecvContext &context) {
+  MessageRing &toClient = endpoint.getToClient();
+  bool hasData = toClient.getNumMessages() != 0;
+  context.getResults().setHasData(hasData);
+  if (hasData)
+    popMessage(toClient, context.getResults().getResp());
+  return hasData;
+}
+
 /// This is the client polling for a message. If one is available, send it.
-/// TODO: implement a blocking call with a timeout.
+/// Blocking calls are parked on the event loop until the simulation produces a
+/// message, such that the client does not have to poll.
 kj::Promise<void> EndpointServer::recv(RecvContext context) {
   KJ_REQUIRE(open, "EndPoint closed already");
-  KJ_REQUIRE(!context.getParams().getBlock(),
-             "Blocking recv() not supported yet");
-
-  // Try to pop a message.
-  Endpoint::BlobPtr blob;
-  auto msgPresent = endpoint.getMessageToClient(blob);
-  context.getResults().setHasData(msgPresent);
-  if (msgPresent) {
-    KJ_REQUIRE(blob->size() % 8 == 0,
-               "Response msg was malformed. Size of response was not a "
-               "multiple of 8 bytes.");
-    // Copy the blob into a single segment.
-    auto segment =
-        kj::ArrayPtr<capnp::word>((word *)blob->data(), blob->size() / 8)
-            .asConst();
-    // Create a single-element array of segments.
-    kj::Array<kj::ArrayPtr<const capnp::word>> segments =
-        kj::heapArray({segment});
-    // Create an object which will read the segments into a message on send.
-    std::unique_ptr<SegmentArrayMessageReader> msgReader =
-        std::make_unique<SegmentArrayMessageReader>(segments);
-    // Send.
-    context.getResults().getResp().set(msgReader->getRoot<AnyPointer>());
-  }
-  return kj::READY_NOW;
+  if (tryRecv(context) || !context.getParams().getBlock())
+    return kj::READY_NOW;
+  // The simulation does not notify the RPC thread about new messages, hence
+  // check again on the next turn of the event loop.
+  return timer.afterDelay(kj::MILLISECONDS).then([this, context]() mutable {
+    return recv(context);
+  });
 }
 
 /// 'Send' is from the client perspective, so this is a message we are
-/// recieving. The only way I could figure out to copy the raw message is a
-/// double copy. I was have issues getting libkj's arrays to play nice with
-/// others.
+/// recieving.
 kj::Promise<void> EndpointServer::send(SendContext context) {
   KJ_REQUIRE(open, "EndPoint closed already");
-  auto capnpMsgPointer = context.getParams().getMsg();
-  KJ_REQUIRE(capnpMsgPointer.isStruct(),
-             "Only messages can go in the 'msg' parameter");
-
-  // Copy the incoming message into a flat, single segment buffer.
-  auto msgSize = capnpMsgPointer.targetSize();
-  auto builder = std::make_unique<MallocMessageBuilder>(
-      msgSize.wordCount + 1, AllocationStrategy::FIXED_SIZE);
-  builder->setRoot(capnpMsgPointer);
-  auto segments = builder->getSegmentsForOutput();
-  KJ_ASSERT(segments.size() == 1);
+  KJ_REQUIRE(pushMessage(endpoint.getToSim(), context.getParams().getMsg()),
+             "Queue to the simulation is full, retry later");
+  return kj::READY_NOW;
+}
 
-  // Now copy it into a blob and queue it.
-  auto fstSegmentData = segments[0].asBytes();
-  auto blob = std::make_shared<Endpoint::Blob>(fstSegmentData.begin(),
-                                               fstSegmentData.end());
-  endpoint.pushMessageToSim(blob);
+/// Queue as many messages of the batch as fit. The client resends the rest.
+kj::Promise<void> EndpointServer::sendBatch(SendBatchContext context) {
+  KJ_REQUIRE(open, "EndPoint closed already");
+  MessageRing &toSim = endpoint.getToSim();
+  uint32_t numSent = 0;
+  for (auto batchMsg : context.getParams().getMsgs()) {
+    if (!pushMessage(toSim, batchMsg.getMsg()))
+      break;
+    ++numSent;
+  }
+  context.getResults().setNumSent(numSent);
+  return kj::READY_NOW;
+}
+
+/// Drain up to the requested number of messages in one response. Blocking
+/// calls wait for the first message just like recv().
+kj::Promise<void> EndpointServer::recvBatch(RecvBatchContext context) {
+  KJ_REQUIRE(open, "EndPoint closed already");
+  MessageRing &toClient = endpoint.getToClient();
+  size_t numMsgs = std::min<size_t>(toClient.getNumMessages(),
+                                    context.getParams().getMaxMsgs());
+  if (numMsgs == 0 && context.getParams().getBlock() &&
+      context.getParams().getMaxMsgs() != 0)
+    return timer.afterDelay(kj::MILLISECONDS).then([this, context]() mutable {
+      return recvBatch(context);
+    });
+
+  auto resps = context.getResults().initResps(numMsgs);
+  for (auto resp : resps)
+    popMessage(toClient, resp.getMsg());
   return kj::READY_NOW;
 }
 
@@ -151,6 +216,7 @@ kj::Promise<void> CosimServer::list(ListContext context) {
     ifaces[ctr].setEndpointID(id);
     ifaces[ctr].setSendTypeID(ep.getSendTypeId());
     ifaces[ctr].setRecvTypeID(ep.getRecvTypeId());
+    ifaces[ctr].setShmName(ep.getShmName());
     ++ctr;
   });
   return kj::READY_NOW;
@@ -164,7 +230,30 @@ kj::Promise<void> CosimServer::open(OpenContext ctxt) {
   KJ_REQUIRE(gotLock, "Endpoint in use");
 
   ctxt.getResults().setIface(EsiDpiEndpoint<AnyPointer, AnyPointer>::Client(
-      kj::heap<EndpointServer>(*ep)));
+      kj::heap<EndpointServer>(*ep, *timer)));
+  return kj::READY_NOW;
+}
+
+/// Fill 'builder' with the statistics of one queue.
+static void setQueueStats(EsiDpiQueueStats::Builder builder,
+                          const MessageRing::Stats &stats) {
+  builder.setMessages(stats.numMessages);
+  builder.setBytes(stats.numBytes);
+  builder.setMaxDepth(stats.maxDepth);
+  auto histogram = builder.initLatencyHistogram(stats.latencyHistogram.size());
+  for (size_t i = 0, e = stats.latencyHistogram.size(); i < e; ++i)
+    histogram.set(i, stats.latencyHistogram[i]);
+}
+
+kj::Promise<void> CosimServer::stats(StatsContext context) {
+  auto endpoints = context.getResults().initEndpoints((unsigned int)reg.size());
+  unsigned int ctr = 0u;
+  reg.iterateEndpoints([&](std::string id, const Endpoint &ep) {
+    endpoints[ctr].setEndpointID(id);
+    setQueueStats(endpoints[ctr].initToSim(), ep.getToSimStats());
+    setQueueStats(endpoints[ctr].initToClient(), ep.getToClientStats());
+    ++ctr;
+  });
   return kj::READY_NOW;
 }
 
@@ -184,8 +273,11 @@ static void writePort(uint16_t port) {
 }
 
 void RpcServer::mainLoop(uint16_t port) {
-  capnp::EzRpcServer rpcServer(kj::heap<CosimServer>(endpoints),
+  auto cosimServer = kj::heap<CosimServer>(endpoints);
+  CosimServer &cosim = *cosimServer;
+  capnp::EzRpcServer rpcServer(kj::mv(cosimServer),
                                /* bindAddress */ "*", port);
+  cosim.setTimer(rpcServer.getIoProvider().getTimer());
   auto &waitScope = rpcServer.getWaitScope();
   // If port is 0, ExRpcSever selects one and we have to wait to get the port.
   if (port == 0) {
@@ -14,14 +14,16 @@
 #include "circt/Dialect/FIRRTL/CHIRRTLDialect.h"
 #include "circt/Dialect/FIRRTL/FIRRTLDialect.h"
 #include "circt/Dialect/FIRRTL/FIRRTLOps.h"
-#include "circt/Dialect/FIRRTL/Namespace.h"
 #include "circt/Support/LLVM.h"
+#include "circt/Support/Namespace.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Tools/mlir-translate/Translation.h"
 #include "llvm/ADT/APSInt.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/Debug.h"
+#include <mutex>
 
 #define DEBUG_TYPE "export-firrtl"
 
@@ -36,7 +38,8 @@ using namespace chirrtl;
 namespace {
 /// An emitter for FIRRTL dialect operations to .fir output.
 struct Emitter {
-  Emitter(llvm::raw_ostream &os) : os(os) {}
+  Emitter(llvm::raw_ostream &os, unsigned currentIndent = 0)
+      : os(os), currentIndent(currentIndent) {}
   LogicalResult finalize();
 
   // Indentation
@@ -49,6 +52,7 @@ struct Emitter {
 
   // Circuit/module emission
   void emitCircuit(CircuitOp op);
+  void emitCircuitBody(Operation *op);
   void emitModule(FModuleOp op);
   void emitModule(FExtModuleOp op);
   void emitModulePorts(ArrayRef<PortInfo> ports,
@@ -203,8 +207,9 @@ private:
     valueNames.insert({value, it.first->getKey()});
   }
 
-  /// The current circuit namespace valid within the call to `emitCircuit`.
-  CircuitNamespace circuitNamespace;
+  /// The namespace for names made up during emission, valid within the call
+  /// to `emitModule`.
+  Namespace moduleNamespace;
 };
 } // namespace
 
@@ -212,23 +217,77 @@ LogicalResult Emitter::finalize() { return failure(encounteredError); }
 
 /// Emit an entire circuit.
 void Emitter::emitCircuit(CircuitOp op) {
-  circuitNamespace.add(op);
   indent() << "circuit " << op.getName() << " :\n";
   addIndent();
-  for (auto &bodyOp : *op.getBodyBlock()) {
-    if (encounteredError)
-      break;
-    TypeSwitch<Operation *>(&bodyOp)
-        .Case<FModuleOp, FExtModuleOp>([&](auto op) {
-          emitModule(op);
-          os << "\n";
-        })
-        .Default([&](auto op) {
-          emitOpError(op, "not supported for emission inside circuit");
-        });
+
+  SmallVector<Operation *> bodyOps;
+  for (auto &bodyOp : *op.getBodyBlock())
+    bodyOps.push_back(&bodyOp);
+
+  // If MLIR threading is disabled, directly emit each module to the output
+  // stream.
+  MLIRContext *context = op.getContext();
+  if (!context->isMultithreadingEnabled()) {
+    for (auto *bodyOp : bodyOps) {
+      if (encounteredError)
+        break;
+      emitCircuitBody(bodyOp);
+    }
+    reduceIndent();
+    return;
   }
+
+  // Modules do not share any emission state, so emit each of them to a string
+  // buffer in parallel and stream the buffers out in order: as soon as a
+  // module and all modules before it are done, they are written and freed.
+  // Workers pick up modules roughly in order, so only a few buffers are alive
+  // at any time rather than the entire output.
+  size_t numBodyOps = bodyOps.size();
+  SmallVector<SmallString<0>> buffers(numBodyOps);
+  SmallVector<bool> done(numBodyOps, false);
+  std::mutex writeMutex;
+  size_t nextToWrite = 0;
+
+  mlir::parallelFor(context, 0, numBodyOps, [&](size_t i) {
+    SmallString<0> buffer;
+    bool failedBodyOp;
+    {
+      llvm::raw_svector_ostream tmpStream(buffer);
+      Emitter bodyEmitter(tmpStream, currentIndent);
+      bodyEmitter.emitCircuitBody(bodyOps[i]);
+      failedBodyOp = failed(bodyEmitter.finalize());
+    }
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (failedBodyOp)
+      encounteredError = true;
+    if (i != nextToWrite) {
+      buffers[i] = std::move(buffer);
+      done[i] = true;
+      return;
+    }
+    os << buffer;
+    for (++nextToWrite; nextToWrite < numBodyOps && done[nextToWrite];
+         ++nextToWrite) {
+      os << buffers[nextToWrite];
+      buffers[nextToWrite] = {};
+    }
+  });
+
+  assert(nextToWrite == numBodyOps && "all modules should have been written");
   reduceIndent();
-  circuitNamespace.clear();
+}
+
+/// Emit an operation in the body of a circuit.
+void Emitter::emitCircuitBody(Operation *op) {
+  TypeSwitch<Operation *>(op)
+      .Case<FModuleOp, FExtModuleOp>([&](auto op) {
+        emitModule(op);
+        os << "\n";
+      })
+      .Default([&](auto op) {
+        emitOpError(op, "not supported for emission inside circuit");
+      });
 }
 
 /// Emit an entire module.
@@ -248,6 +307,7 @@ void Emitter::emitModule(FModuleOp op) {
   reduceIndent();
   valueNames.clear();
   valueNamesStorage.clear();
+  moduleNamespace.clear();
 }
 
 /// Emit an external module.
@@ -615,7 +675,7 @@ void Emitter::emitStatement(InvalidValueOp op) {
       }))
     return;
 
-  auto name = circuitNamespace.newName("_invalid");
+  auto name = moduleNamespace.newName("_invalid");
   addValueName(op, name);
   indent() << "wire " << name << " : ";
   emitType(op.getType());
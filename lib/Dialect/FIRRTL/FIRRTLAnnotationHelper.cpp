@@ -12,6 +12,7 @@
 
 #include "circt/Dialect/FIRRTL/FIRRTLAnnotationHelper.h"
 #include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/IR/Threading.h"
 
 using namespace circt;
 using namespace firrtl;
@@ -227,13 +228,10 @@ Optional<AnnoPathValue> firrtl::resolveEntities(TokenAnnoTarget path,
           << "illegal target '" << path.str() << "' indexes into an instance";
       return {};
     } else {
+      // The target cache holds the ports of the module by name, ahead of any
+      // operations with the same name.
       auto field = component.front().name;
-      ref = AnnoTarget();
-      for (size_t p = 0, pe = target.getNumPorts(); p < pe; ++p)
-        if (target.getPortName(p) == field) {
-          ref = PortAnnoTarget(target, p);
-          break;
-        }
+      ref = cache.lookup(target, field).dyn_cast_or_null<PortAnnoTarget>();
       if (!ref) {
         mlir::emitError(circuit.getLoc())
             << "!cannot find port '" << field << "' in module "
@@ -432,6 +430,24 @@ void AnnoTargetCache::gatherTargets(FModuleLike mod) {
   mod.walk([&](Operation *op) { insertOp(op); });
 }
 
+//===----------------------------------------------------------------------===//
+// CircuitTargetCache
+//===----------------------------------------------------------------------===//
+
+void CircuitTargetCache::populateAll(CircuitOp circuit) {
+  SmallVector<FModuleLike> modules;
+  for (auto module : circuit.getBody().getOps<FModuleLike>())
+    if (!targetCaches.count(module))
+      modules.push_back(module);
+
+  // Walk the modules in parallel, then insert the results serially.
+  SmallVector<Optional<AnnoTargetCache>> caches(modules.size());
+  mlir::parallelFor(circuit.getContext(), 0, modules.size(),
+                    [&](size_t i) { caches[i].emplace(modules[i]); });
+  for (auto [module, cache] : llvm::zip(modules, caches))
+    targetCaches.try_emplace(module, std::move(*cache));
+}
+
 LogicalResult
 firrtl::findLCAandSetPath(AnnoPathValue &srcTarget, AnnoPathValue &dstTarget,
                           SmallVector<InstanceOp> &pathFromSrcToDst,
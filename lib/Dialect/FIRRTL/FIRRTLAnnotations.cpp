@@ -529,6 +529,73 @@ Annotation AnnotationSetIterator::operator*() const {
   return Annotation(this->getBase().getArray()[this->getIndex()]);
 }
 
+//===----------------------------------------------------------------------===//
+// PendingAnnotations
+//===----------------------------------------------------------------------===//
+
+void PendingAnnotations::Annotations::add(Attribute anno) {
+  annos.push_back(anno);
+  if (auto cls = Annotation(anno).getClassAttr())
+    classes.insert(cls);
+}
+
+void PendingAnnotations::addAnnotation(Operation *op, Attribute anno) {
+  entries[op].opAnnos.add(anno);
+}
+
+void PendingAnnotations::addPortAnnotation(Operation *op, unsigned portNo,
+                                           Attribute anno) {
+  entries[op].portAnnos[portNo].add(anno);
+}
+
+bool PendingAnnotations::hasAnnotation(Operation *op,
+                                       StringAttr className) const {
+  auto it = entries.find(op);
+  return it != entries.end() && it->second.opAnnos.classes.count(className);
+}
+
+bool PendingAnnotations::hasPortAnnotation(Operation *op, unsigned portNo,
+                                           StringAttr className) const {
+  auto it = entries.find(op);
+  if (it == entries.end())
+    return false;
+  auto portIt = it->second.portAnnos.find(portNo);
+  return portIt != it->second.portAnnos.end() &&
+         portIt->second.classes.count(className);
+}
+
+void PendingAnnotations::applyToIR() {
+  for (auto &[op, entry] : entries) {
+    auto *context = op->getContext();
+    if (!entry.opAnnos.annos.empty()) {
+      AnnotationSet annos(op);
+      annos.addAnnotations(entry.opAnnos.annos);
+      annos.applyToOperation(op);
+    }
+
+    if (entry.portAnnos.empty())
+      continue;
+
+    // Rebuild the port annotations array once for all ports of this op.
+    auto numPorts = getNumPorts(op);
+    SmallVector<Attribute> portAnnotations;
+    auto before = op->getAttrOfType<ArrayAttr>(getPortAnnotationAttrName());
+    if (!before || before.size() != numPorts)
+      portAnnotations.assign(numPorts, ArrayAttr::get(context, {}));
+    else
+      portAnnotations.append(before.begin(), before.end());
+    for (auto &[portNo, annos] : entry.portAnnos) {
+      SmallVector<Attribute> newAnnos(
+          portAnnotations[portNo].cast<ArrayAttr>().getValue());
+      newAnnos.append(annos.annos.begin(), annos.annos.end());
+      portAnnotations[portNo] = ArrayAttr::get(context, newAnnos);
+    }
+    op->setAttr(getPortAnnotationAttrName(),
+                ArrayAttr::get(context, portAnnotations));
+  }
+  entries.clear();
+}
+
 //===----------------------------------------------------------------------===//
 // AnnoTarget
 //===----------------------------------------------------------------------===//
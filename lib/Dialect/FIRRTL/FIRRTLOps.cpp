@@ -25,9 +25,11 @@
 #include "mlir/IR/FunctionImplementation.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Threading.h"
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/TypeSwitch.h"
@@ -327,18 +329,12 @@ LogicalResult CircuitOp::verifyRegions() {
     return failure();
   }
 
-  // Store a mapping of defname to either the first external module
-  // that defines it or, preferentially, the first external module
-  // that defines it and has no parameters.
-  llvm::DenseMap<Attribute, FExtModuleOp> defnameMap;
-
-  auto verifyExtModule = [&](FExtModuleOp extModule) -> LogicalResult {
-    if (!extModule)
-      return success();
-
+  // Verify an external module against `value`, which is either the first
+  // external module with the same defname or, preferentially, the first
+  // external module with the same defname that has no parameters.
+  auto verifyExtModule = [&](FExtModuleOp extModule,
+                             FExtModuleOp &value) -> LogicalResult {
     auto defname = extModule.getDefnameAttr();
-    if (!defname)
-      return success();
 
     // Check that this extmodule's defname does not conflict with
     // the symbol name of any module.
@@ -350,13 +346,13 @@ LogicalResult CircuitOp::verifyRegions() {
           .append("previous module declared here");
 
     // Find an optional extmodule with a defname collision. Update
-    // the defnameMap if this is the first extmodule with that
+    // the value if this is the first extmodule with that
     // defname or if the current extmodule takes no parameters and
     // the collision does. The latter condition improves later
     // extmodule verification as checking against a parameterless
     // module is stricter.
     FExtModuleOp collidingExtModule;
-    if (auto &value = defnameMap[defname]) {
+    if (value) {
       collidingExtModule = value;
       if (!value.getParameters().empty() && extModule.getParameters().empty())
         value = extModule;
@@ -422,15 +418,22 @@ LogicalResult CircuitOp::verifyRegions() {
     return success();
   };
 
-  for (auto &op : *getBodyBlock()) {
-    // Verify external modules.
-    if (auto extModule = dyn_cast<FExtModuleOp>(op)) {
-      if (verifyExtModule(extModule).failed())
-        return failure();
-    }
-  }
-
-  return success();
+  // Verify external modules. Only the external modules with the same defname
+  // are compared with each other, so each group of them is verified in
+  // parallel, in the order in which they appear in the circuit.
+  llvm::MapVector<StringAttr, SmallVector<FExtModuleOp, 2>> extModuleGroups;
+  for (auto extModule : getBodyBlock()->getOps<FExtModuleOp>())
+    if (auto defname = extModule.getDefnameAttr())
+      extModuleGroups[defname].push_back(extModule);
+
+  return mlir::failableParallelForEach(
+      getContext(), extModuleGroups, [&](auto &group) -> LogicalResult {
+        FExtModuleOp value;
+        for (auto extModule : group.second)
+          if (failed(verifyExtModule(extModule, value)))
+            return failure();
+        return success();
+      });
 }
 
 Block *CircuitOp::getBodyBlock() { return &getBody().front(); }
@@ -783,6 +783,11 @@ namespace detail {
 struct BundleTypeStorage : mlir::TypeStorage {
   using KeyTy = ArrayRef<BundleType::BundleElement>;
 
+  /// The maximum number of field IDs for which a bundle holds a table mapping
+  /// each field ID to the index of its element. Larger bundles fall back to
+  /// a binary search of their fields' IDs.
+  static constexpr unsigned maxFieldIndexTableSize = 1 << 16;
+
   BundleTypeStorage(KeyTy elements)
       : elements(elements.begin(), elements.end()) {
     RecursiveTypeProperties props{true, false, false};
@@ -801,6 +806,14 @@ struct BundleTypeStorage : mlir::TypeStorage {
     }
     maxFieldID = fieldID;
     passiveContainsAnalogTypeInfo.setInt(props.toFlags());
+
+    if (maxFieldID <= maxFieldIndexTableSize) {
+      fieldIndices.reserve(maxFieldID);
+      for (unsigned i = 0, e = fieldIDs.size(); i != e; ++i) {
+        unsigned end = i + 1 == e ? maxFieldID : fieldIDs[i + 1] - 1;
+        fieldIndices.append(end - fieldIDs[i] + 1, i);
+      }
+    }
   }
 
   bool operator==(const KeyTy &key) const { return key == KeyTy(elements); }
@@ -818,6 +831,10 @@ struct BundleTypeStorage : mlir::TypeStorage {
   SmallVector<unsigned, 4> fieldIDs;
   unsigned maxFieldID;
 
+  /// The index of the element which holds each field ID, starting at field ID
+  /// 1. Empty if the bundle has more than `maxFieldIndexTableSize` field IDs.
+  SmallVector<unsigned, 0> fieldIndices;
+
   /// This holds the bits for the type's recursive properties, and can hold a
   /// pointer to a passive version of the type.
   llvm::PointerIntPair<Type, RecursiveTypeProperties::numBits, unsigned>
@@ -936,8 +953,11 @@ unsigned BundleType::getFieldID(unsigned index) {
 
 unsigned BundleType::getIndexForFieldID(unsigned fieldID) {
   assert(getElements().size() && "Bundle must have >0 fields");
-  auto fieldIDs = getImpl()->fieldIDs;
-  auto *it = std::prev(llvm::upper_bound(fieldIDs, fieldID));
+  auto *impl = getImpl();
+  if (fieldID - 1 < impl->fieldIndices.size())
+    return impl->fieldIndices[fieldID - 1];
+  ArrayRef<unsigned> fieldIDs = impl->fieldIDs;
+  const auto *it = std::prev(llvm::upper_bound(fieldIDs, fieldID));
   return std::distance(fieldIDs.begin(), it);
 }
 
@@ -945,7 +965,6 @@ std::pair<FIRRTLBaseType, unsigned>
 BundleType::getSubTypeByFieldID(unsigned fieldID) {
   if (fieldID == 0)
     return {*this, 0};
-  auto fieldIDs = getImpl()->fieldIDs;
   auto subfieldIndex = getIndexForFieldID(fieldID);
   auto subfieldType = getElementType(subfieldIndex);
   auto subfieldID = fieldID - getFieldID(subfieldIndex);
@@ -976,6 +995,7 @@ struct VectorTypeStorage : mlir::TypeStorage {
   VectorTypeStorage(KeyTy value) : value(value) {
     auto properties = value.first.getRecursiveTypeProperties();
     passiveContainsAnalogTypeInfo.setInt(properties.toFlags());
+    elementFieldIDs = value.first.getMaxFieldID() + 1;
   }
 
   bool operator==(const KeyTy &key) const { return key == value; }
@@ -987,6 +1007,9 @@ struct VectorTypeStorage : mlir::TypeStorage {
 
   KeyTy value;
 
+  /// The number of field IDs of each element, including its own.
+  size_t elementFieldIDs;
+
   /// This holds the bits for the type's recursive properties, and can hold a
   /// pointer to a passive version of the type.
   llvm::PointerIntPair<Type, RecursiveTypeProperties::numBits, size_t>
@@ -1034,13 +1057,13 @@ FIRRTLBaseType FVectorType::getPassiveType() {
 }
 
 size_t FVectorType::getFieldID(size_t index) {
-  return 1 + index * (getElementType().getMaxFieldID() + 1);
+  return 1 + index * getImpl()->elementFieldIDs;
 }
 
 size_t FVectorType::getIndexForFieldID(size_t fieldID) {
   assert(fieldID && "fieldID must be at least 1");
   // Divide the field ID by the number of fieldID's per element.
-  return (fieldID - 1) / (getElementType().getMaxFieldID() + 1);
+  return (fieldID - 1) / getImpl()->elementFieldIDs;
 }
 
 std::pair<FIRRTLBaseType, size_t>
@@ -1052,7 +1075,7 @@ FVectorType::getSubTypeByFieldID(size_t fieldID) {
 }
 
 size_t FVectorType::getMaxFieldID() {
-  return getNumElements() * (getElementType().getMaxFieldID() + 1);
+  return getNumElements() * getImpl()->elementFieldIDs;
 }
 
 std::pair<size_t, bool> FVectorType::rootChildFieldID(size_t fieldID,
@@ -607,7 +607,7 @@ std::pair<bool, Optional<mlir::LocationAttr>>
 circt::firrtl::maybeStringToLocation(StringRef spelling, bool skipParsing,
                                      StringAttr &locatorFilenameCache,
                                      FileLineColLoc &fileLineColLocCache,
-                                     MLIRContext *context) {
+                                     MLIRContext *context, bool compact) {
   // The spelling of the token looks something like "@[Decoupled.scala 221:8]".
   if (!spelling.startswith("@[") || !spelling.endswith("]"))
     return {false, None};
@@ -705,16 +705,20 @@ circt::firrtl::maybeStringToLocation(StringRef spelling, bool skipParsing,
       break;
 
     // On success, remember what we already parsed (Bar.Scala / 309:14), and
-    // move on to the next chunk.
-    auto loc =
-        getFileLineColLoc(filename.drop_front(spaceLoc + 1), lineNo, columnNo);
-    extraLocs.push_back(loc);
+    // move on to the next chunk.  Compact locations only keep the first chunk.
+    if (!compact) {
+      auto loc = getFileLineColLoc(filename.drop_front(spaceLoc + 1), lineNo,
+                                   columnNo);
+      extraLocs.push_back(loc);
+    }
     filename = nextFilename;
     lineNo = nextLineNo;
     columnNo = nextColumnNo;
     spaceLoc = filename.find_last_of(' ');
   }
 
+  if (compact)
+    columnNo = 0;
   mlir::LocationAttr result = getFileLineColLoc(filename, lineNo, columnNo);
   if (!extraLocs.empty()) {
     extraLocs.push_back(result);
@@ -32,11 +32,38 @@ using namespace circt;
 using namespace firrtl;
 using mlir::UnitAttr;
 
+/// Return true if a string could possibly hold a JSON value other than a
+/// number.  This is a cheap check used to avoid running the full JSON parser
+/// over every string in large annotation payloads, the vast majority of which
+/// are not quoted JSON.
+static bool mightBeQuotedJSON(StringRef str) {
+  str = str.ltrim(" \t\n\r");
+  if (str.empty())
+    return false;
+  switch (str.front()) {
+  case '{':
+  case '[':
+  case '"':
+    return true;
+  case 't':
+  case 'f':
+  case 'n':
+    str = str.rtrim(" \t\n\r");
+    return str == "true" || str == "false" || str == "null";
+  default:
+    return false;
+  }
+}
+
 /// Convert arbitrary JSON to an MLIR Attribute.
 static Attribute convertJSONToAttribute(MLIRContext *context,
                                         json::Value &value, json::Path p) {
   // String or quoted JSON
   if (auto a = value.getAsString()) {
+    // Most strings are just strings, don't bother trying to parse them.
+    if (!mightBeQuotedJSON(*a))
+      return StringAttr::get(context, *a);
+
     // Test to see if this might be quoted JSON (a string that is actually
     // JSON).  Sometimes FIRRTL developers will do this to serialize objects
     // that the Scala FIRRTL Compiler doesn't know about.
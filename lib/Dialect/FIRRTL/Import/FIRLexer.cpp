@@ -16,6 +16,7 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
+#include <cstring>
 
 using namespace circt;
 using namespace firrtl;
@@ -61,15 +62,32 @@ std::string FIRToken::getStringValue() const {
 }
 
 std::string FIRToken::getStringValue(StringRef spelling) {
+  SmallString<64> storage;
+  return getStringValue(spelling, storage).str();
+}
+
+StringRef FIRToken::getStringValue(SmallVectorImpl<char> &storage) const {
+  assert(getKind() == string);
+  return getStringValue(getSpelling(), storage);
+}
+
+StringRef FIRToken::getStringValue(StringRef spelling,
+                                   SmallVectorImpl<char> &storage) {
   // Start by dropping the quotes.
   StringRef bytes = spelling.drop_front().drop_back();
 
-  std::string result;
-  result.reserve(bytes.size());
-  for (size_t i = 0, e = bytes.size(); i != e;) {
+  // If there is nothing to unescape, refer to the source buffer directly.
+  auto firstEscape = bytes.find('\\');
+  if (firstEscape == StringRef::npos)
+    return bytes;
+
+  storage.clear();
+  storage.reserve(bytes.size());
+  storage.append(bytes.begin(), bytes.begin() + firstEscape);
+  for (size_t i = firstEscape, e = bytes.size(); i != e;) {
     auto c = bytes[i++];
     if (c != '\\') {
-      result.push_back(c);
+      storage.push_back(c);
       continue;
     }
 
@@ -79,22 +97,22 @@ std::string FIRToken::getStringValue(StringRef spelling) {
     case '\\':
     case '"':
     case '\'':
-      result.push_back(c1);
+      storage.push_back(c1);
       continue;
     case 'b':
-      result.push_back('\b');
+      storage.push_back('\b');
       continue;
     case 'n':
-      result.push_back('\n');
+      storage.push_back('\n');
       continue;
     case 't':
-      result.push_back('\t');
+      storage.push_back('\t');
       continue;
     case 'f':
-      result.push_back('\f');
+      storage.push_back('\f');
       continue;
     case 'r':
-      result.push_back('\r');
+      storage.push_back('\r');
       continue;
       // TODO: Handle the rest of the escapes (octal and unicode).
     default:
@@ -105,10 +123,10 @@ std::string FIRToken::getStringValue(StringRef spelling) {
     auto c2 = bytes[i++];
 
     assert(llvm::isHexDigit(c1) && llvm::isHexDigit(c2) && "invalid escape");
-    result.push_back((llvm::hexDigitValue(c1) << 4) | llvm::hexDigitValue(c2));
+    storage.push_back((llvm::hexDigitValue(c1) << 4) | llvm::hexDigitValue(c2));
   }
 
-  return result;
+  return StringRef(storage.data(), storage.size());
 }
 
 /// Given a token containing a raw string, return its value, including removing
@@ -204,6 +222,37 @@ Optional<unsigned> FIRLexer::getIndentation(const FIRToken &tok) const {
   return indent;
 }
 
+void FIRLexer::skipToNextModule() {
+  if (curToken.isAny(FIRToken::kw_module, FIRToken::kw_extmodule,
+                     FIRToken::eof, FIRToken::error))
+    return;
+
+  // Scan ahead a line at a time, only looking at the first token on each line.
+  // Finding the line ends with memchr is much cheaper than lexing every token
+  // of the body.
+  const char *ptr = curToken.getSpelling().data();
+  const char *end = curBuffer.end();
+  while (true) {
+    ptr = static_cast<const char *>(memchr(ptr, '\n', end - ptr));
+    if (!ptr) {
+      curPtr = end;
+      break;
+    }
+    ++ptr;
+    while (*ptr == ' ' || *ptr == '\t' || *ptr == ',')
+      ++ptr;
+    if (*ptr != 'm' && *ptr != 'e')
+      continue;
+    curPtr = ptr + 1;
+    auto tok = lexIdentifierOrKeyword(ptr);
+    if (tok.isAny(FIRToken::kw_module, FIRToken::kw_extmodule)) {
+      curToken = tok;
+      return;
+    }
+  }
+  lexToken();
+}
+
 //===----------------------------------------------------------------------===//
 // Lexer Implementation Methods
 //===----------------------------------------------------------------------===//
@@ -74,6 +74,14 @@ public:
   std::string getStringValue() const;
   static std::string getStringValue(StringRef spelling);
 
+  /// Like getStringValue, but avoid copying the string when possible.  If the
+  /// string literal contains no escapes, the result points directly into the
+  /// source buffer.  Otherwise the string is unescaped into `storage` and the
+  /// result refers to that.
+  StringRef getStringValue(SmallVectorImpl<char> &storage) const;
+  static StringRef getStringValue(StringRef spelling,
+                                  SmallVectorImpl<char> &storage);
+
   /// Given a token containing a raw string, return its value, including removing
   /// the quote characters and unescaping the quotes of the string. The lexer has
   /// already verified that this token is valid.
@@ -117,6 +125,13 @@ public:
   /// Get an opaque pointer into the lexer state that can be restored later.
   FIRLexerCursor getCursor() const;
 
+  /// Skip over the remainder of a module body without tokenizing it, stopping
+  /// at the next line that starts with a 'module' or 'extmodule' keyword, or at
+  /// the end of the file.  This is used to quickly find the extent of module
+  /// bodies whose parsing is deferred; any errors in the skipped text are
+  /// reported once the body is actually parsed.
+  void skipToNextModule();
+
 private:
   FIRToken lexTokenImpl();
 
@@ -355,7 +355,8 @@ ParseResult FIRParser::parseOptionalInfoLocator(LocationAttr &result) {
 
   auto locationPair = maybeStringToLocation(
       spelling, constants.options.ignoreInfoLocators, locatorFilenameCache,
-      fileLineColLocCache, getContext());
+      fileLineColLocCache, getContext(),
+      constants.options.compactInfoLocators);
 
   // If parsing failed, then indicate that a weird info was found.
   if (!locationPair.first) {
@@ -2058,7 +2059,9 @@ ParseResult FIRStmtParser::parsePrintf() {
 
   locationProcessor.setLoc(startTok.getLoc());
 
-  auto formatStrUnescaped = FIRToken::getStringValue(formatString);
+  SmallString<64> formatStrStorage;
+  auto formatStrUnescaped =
+      FIRToken::getStringValue(formatString, formatStrStorage);
   builder.create<PrintFOp>(clock, condition,
                            builder.getStringAttr(formatStrUnescaped), operands,
                            name);
@@ -2119,7 +2122,8 @@ ParseResult FIRStmtParser::parseAssert() {
     return failure();
 
   locationProcessor.setLoc(startTok.getLoc());
-  auto messageUnescaped = FIRToken::getStringValue(message);
+  SmallString<64> messageStorage;
+  auto messageUnescaped = FIRToken::getStringValue(message, messageStorage);
   builder.create<AssertOp>(clock, predicate, enable, messageUnescaped,
                            ValueRange{}, name.getValue());
   return success();
@@ -2142,7 +2146,8 @@ ParseResult FIRStmtParser::parseAssume() {
     return failure();
 
   locationProcessor.setLoc(startTok.getLoc());
-  auto messageUnescaped = FIRToken::getStringValue(message);
+  SmallString<64> messageStorage;
+  auto messageUnescaped = FIRToken::getStringValue(message, messageStorage);
   builder.create<AssumeOp>(clock, predicate, enable, messageUnescaped,
                            ValueRange{}, name.getValue());
   return success();
@@ -2165,7 +2170,8 @@ ParseResult FIRStmtParser::parseCover() {
     return failure();
 
   locationProcessor.setLoc(startTok.getLoc());
-  auto messageUnescaped = FIRToken::getStringValue(message);
+  SmallString<64> messageStorage;
+  auto messageUnescaped = FIRToken::getStringValue(message, messageStorage);
   builder.create<CoverOp>(clock, predicate, enable, messageUnescaped,
                           ValueRange{}, name.getValue());
   return success();
@@ -2988,26 +2994,11 @@ ParseResult FIRCircuitParser::parseModule(CircuitOp circuit,
         DeferredModuleToParse{moduleOp, portLocs, getLexer().getCursor(),
                               std::move(moduleTarget), indent});
 
-    // We're going to defer parsing this module, so just skip tokens until we
-    // get to the next module or the end of the file.
-    while (true) {
-      switch (getToken().getKind()) {
-
-      // End of file or invalid token will be handled by outer level.
-      case FIRToken::eof:
-      case FIRToken::error:
-        return success();
-
-        // If we got to the next module, then we're done.
-      case FIRToken::kw_module:
-      case FIRToken::kw_extmodule:
-        return success();
-
-      default:
-        consumeToken();
-        break;
-      }
-    }
+    // We're going to defer parsing this module, so just skip ahead to the next
+    // module or the end of the file.  End of file or an invalid token will be
+    // handled by the outer level.
+    getLexer().skipToNextModule();
+    return success();
   }
 
   // Otherwise, handle extmodule specific features like parameters.
@@ -3056,7 +3047,8 @@ ParseResult FIRCircuitParser::parseModule(CircuitOp circuit,
     }
     case FIRToken::string: {
       // Drop the double quotes and unescape.
-      value = builder.getStringAttr(getToken().getStringValue());
+      SmallString<64> storage;
+      value = builder.getStringAttr(getToken().getStringValue(storage));
       consumeToken(FIRToken::string);
       break;
     }
@@ -3145,6 +3137,12 @@ FIRCircuitParser::parseModuleBody(DeferredModuleToParse &deferredModule) {
       return result;
   }
 
+  // Hand the finished module to the client, e.g. to start running module-local
+  // passes while the other module bodies are still being parsed.
+  if (auto &callback = getConstants().options.moduleBodyCallback)
+    if (failed(callback(moduleOp)))
+      return failure();
+
   return success();
 }
 
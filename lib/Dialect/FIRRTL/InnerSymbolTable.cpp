@@ -166,11 +166,30 @@ StringAttr InnerSymbolTable::getInnerSymbol(const InnerSymTarget &target) {
 InnerSymbolTable &
 InnerSymbolTableCollection::getInnerSymbolTable(Operation *op) {
   auto it = symbolTables.try_emplace(op, nullptr);
-  if (it.second)
+  if (!it.first->second) {
     it.first->second = ::std::make_unique<InnerSymbolTable>(op);
+    addTableByName(op, it.first->second.get());
+  }
   return *it.first->second;
 }
 
+void InnerSymbolTableCollection::addTableByName(Operation *op,
+                                                InnerSymbolTable *table) {
+  if (auto name = op->getAttrOfType<StringAttr>(
+          SymbolTable::getSymbolAttrName()))
+    tablesByName[name] = table;
+}
+
+void InnerSymbolTableCollection::invalidate(Operation *op) {
+  auto it = symbolTables.find(op);
+  if (it == symbolTables.end())
+    return;
+  if (auto name = op->getAttrOfType<StringAttr>(
+          SymbolTable::getSymbolAttrName()))
+    tablesByName.erase(name);
+  symbolTables.erase(it);
+}
+
 LogicalResult
 InnerSymbolTableCollection::populateAndVerifyTables(Operation *innerRefNSOp) {
   // Gather top-level operations that have the InnerSymbolTable trait.
@@ -180,24 +199,30 @@ InnerSymbolTableCollection::populateAndVerifyTables(Operation *innerRefNSOp) {
         return op->hasTrait<OpTrait::InnerSymbolTable>();
       }));
 
-  // Ensure entries exist for each operation.
-  llvm::for_each(innerSymTableOps,
-                 [&](auto *op) { symbolTables.try_emplace(op, nullptr); });
+  // Ensure entries exist for each operation, and only keep the ones that do
+  // not have an up-to-date table yet.
+  llvm::erase_if(innerSymTableOps, [&](auto *op) {
+    return symbolTables.try_emplace(op, nullptr).first->second != nullptr;
+  });
 
   // Construct the tables in parallel (if context allows it).
-  return mlir::failableParallelForEach(
+  auto result = mlir::failableParallelForEach(
       innerRefNSOp->getContext(), innerSymTableOps, [&](auto *op) {
         auto it = symbolTables.find(op);
-        assert(it != symbolTables.end());
-        if (!it->second) {
-          auto result = InnerSymbolTable::get(op);
-          if (failed(result))
-            return failure();
-          it->second = std::make_unique<InnerSymbolTable>(std::move(*result));
-          return success();
-        }
-        return failure();
+        assert(it != symbolTables.end() && !it->second);
+        auto result = InnerSymbolTable::get(op);
+        if (failed(result))
+          return failure();
+        it->second = std::make_unique<InnerSymbolTable>(std::move(*result));
+        return success();
       });
+
+  // Record the new tables by name.  This is done serially as it mutates the
+  // name map.
+  for (auto *op : innerSymTableOps)
+    if (auto &table = symbolTables[op])
+      addTableByName(op, table.get());
+  return result;
 }
 
 //===----------------------------------------------------------------------===//
@@ -205,6 +230,8 @@ InnerSymbolTableCollection::populateAndVerifyTables(Operation *innerRefNSOp) {
 //===----------------------------------------------------------------------===//
 
 InnerSymTarget InnerRefNamespace::lookup(hw::InnerRefAttr inner) {
+  if (auto *table = innerSymTables.lookupInnerSymbolTable(inner.getModule()))
+    return table->lookup(inner.getName());
   auto *mod = symTable.lookup(inner.getModule());
   if (!mod)
     return {};
@@ -213,6 +240,8 @@ InnerSymTarget InnerRefNamespace::lookup(hw::InnerRefAttr inner) {
 }
 
 Operation *InnerRefNamespace::lookupOp(hw::InnerRefAttr inner) {
+  if (auto *table = innerSymTables.lookupInnerSymbolTable(inner.getModule()))
+    return table->lookupOp(inner.getName());
   auto *mod = symTable.lookup(inner.getModule());
   if (!mod)
     return nullptr;
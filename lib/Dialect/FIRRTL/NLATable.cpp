@@ -75,6 +75,28 @@ void NLATable::erase(HierPathOp nla, SymbolTable *symbolTable) {
     symbolTable->erase(nla);
 }
 
+void NLATable::eraseNLAs(ArrayRef<HierPathOp> nlas, SymbolTable *symbolTable) {
+  DenseSet<HierPathOp> erased(nlas.begin(), nlas.end());
+  DenseSet<StringAttr> modules;
+  for (auto nla : erased) {
+    symToOp.erase(nla.getSymNameAttr());
+    for (auto ent : nla.getNamepath())
+      if (auto mod = ent.dyn_cast<FlatSymbolRefAttr>())
+        modules.insert(mod.getAttr());
+      else if (auto inr = ent.dyn_cast<hw::InnerRefAttr>())
+        modules.insert(inr.getModule());
+  }
+  for (auto mod : modules) {
+    auto iter = nodeMap.find(mod);
+    if (iter != nodeMap.end())
+      llvm::erase_if(iter->second,
+                     [&](HierPathOp nla) { return erased.contains(nla); });
+  }
+  if (symbolTable)
+    for (auto nla : erased)
+      symbolTable->erase(nla);
+}
+
 void NLATable::updateModuleInNLA(HierPathOp nlaOp, StringAttr oldModule,
                                  StringAttr newModule) {
   nlaOp.updateModule(oldModule, newModule);
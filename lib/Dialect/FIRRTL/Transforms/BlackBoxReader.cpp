@@ -23,9 +23,12 @@
 #include "circt/Dialect/SV/SVOps.h"
 #include "circt/Support/Path.h"
 #include "mlir/IR/Attributes.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Support/FileUtilities.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 
@@ -46,6 +49,8 @@ struct BlackBoxReaderPass : public BlackBoxReaderBase<BlackBoxReaderPass> {
   void runOnOperation() override;
   bool runOnAnnotation(Operation *op, Annotation anno, OpBuilder &builder,
                        bool isCover);
+  SmallString<128> getInputPath(StringAttr path);
+  void loadFiles(CircuitOp circuitOp);
   VerbatimOp loadFile(Operation *op, StringRef inputPath, OpBuilder &builder);
   void setOutputFile(VerbatimOp op, Operation *origOp, StringAttr fileNameAttr,
                      bool isCover = false);
@@ -53,12 +58,17 @@ struct BlackBoxReaderPass : public BlackBoxReaderBase<BlackBoxReaderPass> {
   bool isDut(Operation *module);
 
   using BlackBoxReaderBase::inputPrefix;
+  using BlackBoxReaderBase::referenceFiles;
 
 private:
   /// A set of the files generated so far. This is used to prevent two
   /// annotations from generating the same file.
   SmallPtrSet<Attribute, 8> emittedFiles;
 
+  /// The contents of the files of all path annotations, keyed by their input
+  /// path. Files which could not be read map to a null attribute.
+  llvm::StringMap<StringAttr> loadedFiles;
+
   /// A list of all files which will be included in the file list.  This is
   /// subset of all emitted files.
   SmallVector<StringRef> fileListFiles;
@@ -163,6 +173,10 @@ void BlackBoxReaderPass::runOnOperation() {
   // Newly generated IR will be placed at the end of the circuit.
   auto builder = OpBuilder::atBlockEnd(circuitOp->getBlock());
 
+  // Read the files of all path annotations up front.
+  if (!referenceFiles)
+    loadFiles(circuitOp);
+
   // Do a shallow walk of the circuit to collect information necessary before we
   // do real work.
   for (auto &op : *circuitOp.getBodyBlock()) {
@@ -243,6 +257,7 @@ void BlackBoxReaderPass::runOnOperation() {
   // Clean up.
   emittedFiles.clear();
   fileListFiles.clear();
+  loadedFiles.clear();
 }
 
 /// Run on an operation-annotation pair. The annotation need not be a black box
@@ -284,8 +299,7 @@ bool BlackBoxReaderPass::runOnAnnotation(Operation *op, Annotation anno,
       signalPassFailure();
       return true;
     }
-    SmallString<128> inputPath(inputPrefix);
-    appendPossiblyAbsolutePath(inputPath, path.getValue());
+    auto inputPath = getInputPath(path);
     auto verbatim = loadFile(op, inputPath, builder);
     if (!verbatim) {
       op->emitError("Cannot find file ") << inputPath;
@@ -301,6 +315,44 @@ bool BlackBoxReaderPass::runOnAnnotation(Operation *op, Annotation anno,
   return false;
 }
 
+/// Return the path from which the file of a path annotation is read.
+SmallString<128> BlackBoxReaderPass::getInputPath(StringAttr path) {
+  SmallString<128> inputPath(inputPrefix);
+  appendPossiblyAbsolutePath(inputPath, path.getValue());
+  return inputPath;
+}
+
+/// Read the files of all path annotations in the circuit into `loadedFiles`.
+/// Circuits can refer to thousands of black box files, so they are read and
+/// uniqued into the context in parallel.
+void BlackBoxReaderPass::loadFiles(CircuitOp circuitOp) {
+  SmallVector<std::string> inputPaths;
+  for (auto &op : *circuitOp.getBodyBlock()) {
+    if (!isa<FModuleOp, FExtModuleOp>(op))
+      continue;
+    for (auto anno : AnnotationSet(&op)) {
+      if (!anno.isClass(blackBoxPathAnnoClass))
+        continue;
+      auto path = anno.getMember<StringAttr>("path");
+      if (!path)
+        continue;
+      auto inputPath = getInputPath(path);
+      if (loadedFiles.try_emplace(inputPath).second)
+        inputPaths.push_back(std::string(inputPath));
+    }
+  }
+
+  auto *context = &getContext();
+  SmallVector<StringAttr> contents(inputPaths.size());
+  mlir::parallelFor(context, 0, inputPaths.size(), [&](size_t i) {
+    std::string errorMessage;
+    if (auto input = mlir::openInputFile(inputPaths[i], &errorMessage))
+      contents[i] = StringAttr::get(context, input->getBuffer());
+  });
+  for (auto [inputPath, content] : llvm::zip(inputPaths, contents))
+    loadedFiles[inputPath] = content;
+}
+
 /// Copies a black box source file to the appropriate location in the target
 /// directory.
 VerbatimOp BlackBoxReaderPass::loadFile(Operation *op, StringRef inputPath,
@@ -314,16 +366,24 @@ VerbatimOp BlackBoxReaderPass::loadFile(Operation *op, StringRef inputPath,
   if (emittedFiles.count(fileNameAttr))
     return {};
 
-  // Open and read the input file.
-  std::string errorMessage;
-  auto input = mlir::openInputFile(inputPath, &errorMessage);
-  if (!input)
-    return {};
+  // If the files are referenced, create an IR node which refers to the file.
+  // Use "unknown location" so that no file info will unnecessarily print.
+  if (referenceFiles) {
+    if (!llvm::sys::fs::exists(inputPath))
+      return {};
+    SmallString<128> absolutePath(inputPath);
+    llvm::sys::fs::make_absolute(absolutePath);
+    auto verbatim = builder.create<VerbatimOp>(builder.getUnknownLoc(), "");
+    verbatim->setAttr(sv::getVerbatimSourceFileAttrName(),
+                      builder.getStringAttr(absolutePath));
+    return verbatim;
+  }
 
-  // Create an IR node to hold the contents.  Use "unknown location" so that no
-  // file info will unnecessarily print.
-  return builder.create<VerbatimOp>(builder.getUnknownLoc(),
-                                    input->getBuffer());
+  // Otherwise, create an IR node to hold the contents loaded before.
+  auto contents = loadedFiles.lookup(inputPath);
+  if (!contents)
+    return {};
+  return builder.create<VerbatimOp>(builder.getUnknownLoc(), contents);
 }
 
 /// This function is called for every file generated.  It does the following
@@ -411,9 +471,11 @@ bool BlackBoxReaderPass::isDut(Operation *module) {
 //===----------------------------------------------------------------------===//
 
 std::unique_ptr<mlir::Pass>
-circt::firrtl::createBlackBoxReaderPass(llvm::Optional<StringRef> inputPrefix) {
+circt::firrtl::createBlackBoxReaderPass(llvm::Optional<StringRef> inputPrefix,
+                                        bool referenceFiles) {
   auto pass = std::make_unique<BlackBoxReaderPass>();
   if (inputPrefix)
     pass->inputPrefix = inputPrefix->str();
+  pass->referenceFiles = referenceFiles;
   return pass;
 }
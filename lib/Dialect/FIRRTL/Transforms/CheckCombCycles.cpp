@@ -708,69 +708,18 @@ void dumpSimpleCycle(SCCIterator &scc, FModuleOp module,
 /// This pass constructs a local graph for each module to detect combinational
 /// cycles. To capture the cross-module combinational cycles, this pass inlines
 /// the combinational paths between IOs of its subinstances into a subgraph and
-/// encodes them in a `combPathsMap`.
+/// encodes them in a `combPathsMap`. Every module is only traversed once, no
+/// matter how often it is instantiated, and modules whose subinstances have
+/// all been summarized are handled in parallel.
 class CheckCombCyclesPass : public CheckCombCyclesBase<CheckCombCyclesPass> {
   void runOnOperation() override {
     auto &instanceGraph = getAnalysis<InstanceGraph>();
-    bool detectedCycle = false;
 
-    // Traverse modules in a post order to make sure the combinational paths
-    // between IOs of a module have been detected and recorded in `combPathsMap`
-    // before we handle its parent modules.
-    for (auto node : llvm::post_order<InstanceGraph *>(&instanceGraph)) {
+    // The entry of every module is created up front so that the map is not
+    // modified while the modules are handled in parallel.
+    for (auto *node : llvm::post_order<InstanceGraph *>(&instanceGraph)) {
       if (auto module = dyn_cast<FModuleOp>(*node->getModule())) {
-        NodeContext context(&map, &instanceGraph,
-                            module.getOps<FConnectLike>());
-        auto dummyNode = Node(nullptr, &context);
-
-        // Traversing SCCs in the combinational graph to detect cycles. As
-        // FIRRTL module is an SSA region, all cycles must contain at least one
-        // connect op. Thus we introduce a dummy source node to iterate on the
-        // `dest`s of all connect ops in the module.
-        for (auto combSCC = SCCIterator::begin(dummyNode); !combSCC.isAtEnd();
-             ++combSCC) {
-          if (combSCC.hasCycle()) {
-            detectedCycle = true;
-            auto errorDiag = mlir::emitError(
-                module.getLoc(),
-                "detected combinational cycle in a FIRRTL module");
-            if (printSimpleCycle)
-              dumpSimpleCycle(combSCC, module, errorDiag);
-            else {
-              for (auto node : *combSCC) {
-                auto &noteDiag = errorDiag.attachNote(node.value.getLoc());
-                noteDiag << "this operation is part of the combinational cycle";
-              }
-            }
-          }
-        }
-
-        SmallVector<bool, 8> directionVec;
-        for (auto &port : module.getPorts())
-          directionVec.push_back(port.isOutput());
-
-        auto &combPaths = map[module];
-        NodeDenseSet nodeSet;
-        SmallVector<size_t, 2> outputVec;
-        unsigned index = 0;
-
-        // Record all combinational paths.
-        for (auto &port : module.getPorts()) {
-          nodeSet.clear();
-          outputVec.clear();
-          auto arg = module.getArgument(index++);
-          if (port.isOutput()) {
-            combPaths.push_back(outputVec);
-            continue;
-          }
-          Node inputNode(arg, &context);
-          for (auto node : llvm::depth_first_ext<Node>(inputNode, nodeSet)) {
-            if (auto output = node.value.dyn_cast<BlockArgument>())
-              if (directionVec[output.getArgNumber()])
-                outputVec.push_back(output.getArgNumber());
-          }
-          combPaths.push_back(outputVec);
-        }
+        map[module];
         continue;
       }
       if (auto extModule = dyn_cast<FExtModuleOp>(*node->getModule())) {
@@ -782,11 +731,79 @@ class CheckCombCyclesPass : public CheckCombCyclesBase<CheckCombCyclesPass> {
       llvm_unreachable("invalid instance graph node");
     }
 
-    if (detectedCycle)
+    // Handle the modules bottom-up, such that the combinational paths between
+    // IOs of all the modules instantiated by a module are recorded in
+    // `combPathsMap` before we handle it.
+    auto result = instanceGraph.failableParallelForEachModule(
+        /*bottomUp=*/true, [&](InstanceGraphNode *node) {
+          if (auto module = dyn_cast<FModuleOp>(*node->getModule()))
+            return checkModule(module, instanceGraph);
+          return success();
+        });
+    if (failed(result))
       signalPassFailure();
     markAllAnalysesPreserved();
   }
 
+  /// Detect the combinational cycles in a module and record the combinational
+  /// paths between its IOs.
+  LogicalResult checkModule(FModuleOp module, InstanceGraph &instanceGraph) {
+    bool detectedCycle = false;
+    NodeContext context(&map, &instanceGraph, module.getOps<FConnectLike>());
+    auto dummyNode = Node(nullptr, &context);
+
+    // Traversing SCCs in the combinational graph to detect cycles. As FIRRTL
+    // module is an SSA region, all cycles must contain at least one connect
+    // op. Thus we introduce a dummy source node to iterate on the `dest`s of
+    // all connect ops in the module.
+    for (auto combSCC = SCCIterator::begin(dummyNode); !combSCC.isAtEnd();
+         ++combSCC) {
+      if (combSCC.hasCycle()) {
+        detectedCycle = true;
+        auto errorDiag = mlir::emitError(
+            module.getLoc(), "detected combinational cycle in a FIRRTL module");
+        if (printSimpleCycle)
+          dumpSimpleCycle(combSCC, module, errorDiag);
+        else {
+          for (auto node : *combSCC) {
+            auto &noteDiag = errorDiag.attachNote(node.value.getLoc());
+            noteDiag << "this operation is part of the combinational cycle";
+          }
+        }
+      }
+    }
+
+    SmallVector<bool, 8> directionVec;
+    for (auto &port : module.getPorts())
+      directionVec.push_back(port.isOutput());
+
+    // The entry was created before any module was handled, so looking it up
+    // does not modify the map.
+    auto &combPaths = map.find(module)->second;
+    NodeDenseSet nodeSet;
+    SmallVector<size_t, 2> outputVec;
+    unsigned index = 0;
+
+    // Record all combinational paths.
+    for (auto &port : module.getPorts()) {
+      nodeSet.clear();
+      outputVec.clear();
+      auto arg = module.getArgument(index++);
+      if (port.isOutput()) {
+        combPaths.push_back(outputVec);
+        continue;
+      }
+      Node inputNode(arg, &context);
+      for (auto node : llvm::depth_first_ext<Node>(inputNode, nodeSet)) {
+        if (auto output = node.value.dyn_cast<BlockArgument>())
+          if (directionVec[output.getArgNumber()])
+            outputVec.push_back(output.getArgNumber());
+      }
+      combPaths.push_back(outputVec);
+    }
+    return failure(detectedCycle);
+  }
+
 private:
   /// A global map from FIRRTL modules to their combinational paths between IOs.
   CombPathsMap map;
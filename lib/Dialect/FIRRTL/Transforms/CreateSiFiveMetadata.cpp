@@ -67,7 +67,7 @@ LogicalResult CreateSiFiveMetadataPass::emitMemoryMetadata() {
   // memmory conf file.
   auto createMemMetadata = [&](FMemModuleOp mem,
                                llvm::json::OStream &jsonStream,
-                               std::string &seqMemConfStr) {
+                               llvm::raw_ostream &seqMemConfOs) {
     // Get the memory data width.
     auto width = mem.getDataWidth();
     // Metadata needs to be printed for memories which are candidates for
@@ -102,10 +102,9 @@ LogicalResult CreateSiFiveMetadataPass::emitMemoryMetadata() {
     auto memExtName = mem.getName();
     auto maskGranStr =
         !isMasked ? "" : " mask_gran " + std::to_string(maskGran);
-    seqMemConfStr = (StringRef(seqMemConfStr) + "name " + memExtName +
-                     " depth " + Twine(mem.getDepth()) + " width " +
-                     Twine(width) + " ports " + portStr + maskGranStr + "\n")
-                        .str();
+    seqMemConfOs << "name " << memExtName << " depth " << mem.getDepth()
+                 << " width " << width << " ports " << portStr << maskGranStr
+                 << "\n";
     // This adds a Json array element entry corresponding to this memory.
     jsonStream.object([&] {
       jsonStream.attribute("module_name", memExtName);
@@ -131,7 +130,7 @@ LogicalResult CreateSiFiveMetadataPass::emitMemoryMetadata() {
         }
       });
       // Record all the hierarchy names.
-      SmallVector<std::string> hierNames;
+      SmallString<128> hierName;
       jsonStream.attributeArray("hierarchy", [&] {
         // Get the absolute path for the parent memory, to create the
         // hierarchy names.
@@ -140,15 +139,14 @@ LogicalResult CreateSiFiveMetadataPass::emitMemoryMetadata() {
           if (p.empty())
             continue;
           auto top = p.front();
-          std::string hierName =
-              top->getParentOfType<FModuleOp>().getName().str();
+          hierName = top->getParentOfType<FModuleOp>().getName();
           for (auto inst : p) {
             auto parentModule = inst->getParentOfType<FModuleOp>();
             if (dutMod == parentModule)
-              hierName = parentModule.getName().str();
-            hierName = (Twine(hierName) + "." + inst.instanceName()).str();
+              hierName = parentModule.getName();
+            hierName += '.';
+            hierName += inst.instanceName();
           }
-          hierNames.push_back(hierName);
           jsonStream.value(hierName);
         }
       });
@@ -164,25 +162,6 @@ LogicalResult CreateSiFiveMetadataPass::emitMemoryMetadata() {
       tbMems.push_back(mod);
   }
 
-  std::string testBenchJsonBuffer;
-  llvm::raw_string_ostream testBenchOs(testBenchJsonBuffer);
-  llvm::json::OStream testBenchJson(testBenchOs, 2);
-  std::string dutJsonBuffer;
-  llvm::raw_string_ostream dutOs(dutJsonBuffer);
-  llvm::json::OStream dutJson(dutOs, 2);
-
-  std::string seqMemConfStr;
-  dutJson.array([&] {
-    for (auto &dutM : dutMems)
-      createMemMetadata(dutM, dutJson, seqMemConfStr);
-  });
-  testBenchJson.array([&] {
-    // The tbConfStr is populated here, but unused, it will not be printed to
-    // file.
-    for (auto &tbM : tbMems)
-      createMemMetadata(tbM, testBenchJson, seqMemConfStr);
-  });
-
   auto *context = &getContext();
   auto builder = OpBuilder::atBlockEnd(circuitOp.getBodyBlock());
   AnnotationSet annos(circuitOp);
@@ -192,17 +171,38 @@ LogicalResult CreateSiFiveMetadataPass::emitMemoryMetadata() {
     if (auto dir = dirAnno.getMember<StringAttr>("dirname"))
       metadataDir = dir.getValue();
 
-  // Use unknown loc to avoid printing the location in the metadata files.
-  auto tbVerbatimOp = builder.create<sv::VerbatimOp>(builder.getUnknownLoc(),
-                                                     testBenchJsonBuffer);
-  auto fileAttr = hw::OutputFileAttr::getFromDirectoryAndFilename(
-      context, metadataDir, "tb_seq_mems.json", /*excludeFromFilelist=*/true);
-  tbVerbatimOp->setAttr("output_file", fileAttr);
-  auto dutVerbatimOp =
-      builder.create<sv::VerbatimOp>(builder.getUnknownLoc(), dutJsonBuffer);
-  fileAttr = hw::OutputFileAttr::getFromDirectoryAndFilename(
-      context, metadataDir, "seq_mems.json", /*excludeFromFilelist=*/true);
-  dutVerbatimOp->setAttr("output_file", fileAttr);
+  // The JSON of every memory list is streamed into a buffer, which is released
+  // as soon as its verbatim op has been created, so that at most one copy of
+  // each list is alive at a time.
+  auto createMemList = [&](ArrayRef<FMemModuleOp> mems, StringRef filename,
+                           llvm::raw_ostream &seqMemConfOs) {
+    std::string buffer;
+    {
+      llvm::raw_string_ostream os(buffer);
+      llvm::json::OStream jsonStream(os, 2);
+      jsonStream.array([&] {
+        for (auto mem : mems)
+          createMemMetadata(mem, jsonStream, seqMemConfOs);
+      });
+    }
+    // Use unknown loc to avoid printing the location in the metadata files.
+    auto verbatimOp =
+        builder.create<sv::VerbatimOp>(builder.getUnknownLoc(), buffer);
+    auto fileAttr = hw::OutputFileAttr::getFromDirectoryAndFilename(
+        context, metadataDir, filename, /*excludeFromFilelist=*/true);
+    verbatimOp->setAttr("output_file", fileAttr);
+    return verbatimOp;
+  };
+
+  std::string seqMemConfStr;
+  llvm::raw_string_ostream seqMemConfOs(seqMemConfStr);
+  auto dutVerbatimOp = createMemList(dutMems, "seq_mems.json", seqMemConfOs);
+  // The test bench memories are also added to the conf string, and the test
+  // bench file is placed before the DUT file.
+  builder.setInsertionPoint(dutVerbatimOp);
+  createMemList(tbMems, "tb_seq_mems.json", seqMemConfOs);
+  builder.setInsertionPointToEnd(circuitOp.getBodyBlock());
+  seqMemConfOs.flush();
 
   auto confVerbatimOp =
       builder.create<sv::VerbatimOp>(builder.getUnknownLoc(), seqMemConfStr);
@@ -213,8 +213,8 @@ LogicalResult CreateSiFiveMetadataPass::emitMemoryMetadata() {
     return failure();
   }
 
-  fileAttr = hw::OutputFileAttr::getFromFilename(context, replSeqMemFile,
-                                                 /*excludeFromFilelist=*/true);
+  auto fileAttr = hw::OutputFileAttr::getFromFilename(
+      context, replSeqMemFile, /*excludeFromFilelist=*/true);
   confVerbatimOp->setAttr("output_file", fileAttr);
 
   return success();
@@ -21,9 +21,12 @@
 #include "circt/Dialect/FIRRTL/Namespace.h"
 #include "circt/Dialect/FIRRTL/Passes.h"
 #include "circt/Dialect/HW/HWAttributes.h"
+#include "circt/Dialect/SV/SVOps.h"
 #include "circt/Support/LLVM.h"
 #include "mlir/IR/BlockAndValueMapping.h"
 #include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/IR/Threading.h"
+#include "mlir/Support/FileUtilities.h"
 #include "mlir/Support/LogicalResult.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseMapInfo.h"
@@ -33,7 +36,12 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/Format.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SHA256.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/xxhash.h"
 
 using namespace circt;
 using namespace firrtl;
@@ -59,9 +67,66 @@ llvm::raw_ostream &printHash(llvm::raw_ostream &stream, std::string data) {
   return printHex(stream, bytes);
 }
 
+/// A fast, non-cryptographic 128-bit hash with the same interface as
+/// llvm::SHA256. The input is buffered, and every full buffer is folded into
+/// two 64-bit lanes with xxHash64, each chained with its own previous value.
+/// The result is padded to the size of a SHA256 hash, so that both can be
+/// used interchangeably.
+class FastHash {
+public:
+  FastHash() { init(); }
+
+  void init() {
+    lanes = {0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL};
+    buffer.clear();
+    buffer.append(sizeof(uint64_t), 0);
+  }
+
+  void update(ArrayRef<uint8_t> data) {
+    buffer.append(data.begin(), data.end());
+    if (buffer.size() >= bufferSize)
+      flush();
+  }
+
+  void update(StringRef str) { update(llvm::arrayRefFromStringRef(str)); }
+
+  std::array<uint8_t, 32> final() {
+    flush();
+    std::array<uint8_t, 32> result{};
+    std::memcpy(result.data(), lanes.data(), sizeof(lanes));
+    return result;
+  }
+
+private:
+  /// Fold the buffered input into the lanes. The first word of the buffer is
+  /// reserved for the previous value of the lane being computed.
+  void flush() {
+    for (auto &lane : lanes) {
+      std::memcpy(buffer.data(), &lane, sizeof(lane));
+      lane = llvm::xxHash64(llvm::toStringRef(buffer));
+    }
+    buffer.resize(sizeof(uint64_t));
+  }
+
+  static constexpr size_t bufferSize = 4096;
+  std::array<uint64_t, 2> lanes;
+  SmallVector<uint8_t, 0> buffer;
+};
+
+/// Computes a structural hash of a module. By default, the hash ignores names
+/// and annotations, and is built from the addresses of uniqued types and
+/// attributes, so it is only meaningful within a single MLIRContext.  In
+/// stable mode, every attribute and location is hashed by its printed form,
+/// which makes the hash reproducible across runs and usable as a cache key.
+/// The hash function is either llvm::SHA256 or the faster FastHash.
+template <typename Hash>
 struct StructuralHasher {
-  explicit StructuralHasher(MLIRContext *context) {
+  explicit StructuralHasher(MLIRContext *context, bool stable = false)
+      : stable(stable) {
     portTypesAttr = StringAttr::get(context, "portTypes");
+    // Everything can affect the output when the hash is used as a cache key.
+    if (stable)
+      return;
     nonessentialAttributes.insert(StringAttr::get(context, "annotations"));
     nonessentialAttributes.insert(StringAttr::get(context, "name"));
     nonessentialAttributes.insert(StringAttr::get(context, "portAnnotations"));
@@ -97,6 +162,24 @@ private:
 
   void update(TypeID typeID) { update(typeID.getAsOpaquePointer()); }
 
+  /// Hash a uniqued object such as a type, attribute, or location.  In stable
+  /// mode its printed form is hashed instead of its address.  The printed hash
+  /// is cached, since the same object usually appears many times in a module.
+  template <typename T>
+  void updateUniqued(T object) {
+    auto *pointer = object.getAsOpaquePointer();
+    if (!stable)
+      return update(pointer);
+    auto it = stableHashes.find(pointer);
+    if (it == stableHashes.end()) {
+      std::string str;
+      llvm::raw_string_ostream os(str);
+      object.print(os);
+      it = stableHashes.try_emplace(pointer, llvm::xxHash64(os.str())).first;
+    }
+    update(static_cast<size_t>(it->second));
+  }
+
   // NOLINTNEXTLINE(misc-no-recursion)
   void update(BundleType type) {
     update(type.getTypeID());
@@ -108,12 +191,17 @@ private:
 
   // NOLINTNEXTLINE(misc-no-recursion)
   void update(Type type) {
-    if (auto bundle = type.dyn_cast<BundleType>())
-      return update(bundle);
-    update(type.getAsOpaquePointer());
+    if (!stable)
+      if (auto bundle = type.dyn_cast<BundleType>())
+        return update(bundle);
+    updateUniqued(type);
   }
 
-  void update(BlockArgument arg) { indexes[arg] = currentIndex++; }
+  void update(BlockArgument arg) {
+    indexes[arg] = currentIndex++;
+    if (stable)
+      updateUniqued(arg.getLoc());
+  }
 
   void update(OpResult result) {
     indexes[result] = currentIndex++;
@@ -135,15 +223,15 @@ private:
       if (nonessentialAttributes.contains(name))
         continue;
       // Hash the port types.
-      if (name == portTypesAttr) {
+      if (!stable && name == portTypesAttr) {
         auto portTypes = value.cast<ArrayAttr>().getAsValueRange<TypeAttr>();
         for (auto type : portTypes)
           update(type);
         continue;
       }
       // Hash the interned pointer.
-      update(name.getAsOpaquePointer());
-      update(value.getAsOpaquePointer());
+      updateUniqued(name);
+      updateUniqued(value);
     }
   }
 
@@ -158,12 +246,16 @@ private:
 
   void update(mlir::OperationName name) {
     // Operation names are interned.
+    if (stable)
+      return sha.update(name.getStringRef());
     update(name.getAsOpaquePointer());
   }
 
   // NOLINTNEXTLINE(misc-no-recursion)
   void update(Operation *op) {
     update(op->getName());
+    if (stable)
+      updateUniqued(op->getLoc());
     update(op->getAttrDictionary());
     // Hash the operands.
     for (auto &operand : op->getOpOperands())
@@ -188,9 +280,14 @@ private:
   // This is a cached "portTypes" string attr.
   StringAttr portTypesAttr;
 
+  // If set, hash the printed form of uniqued objects rather than their address.
+  bool stable;
+  // The cached hashes of printed uniqued objects, used in stable mode.
+  DenseMap<const void *, uint64_t> stableHashes;
+
   // This is the actual running hash calculation. This is a stateful element
   // that should be reinitialized after each hash is produced.
-  llvm::SHA256 sha;
+  Hash sha;
 };
 
 //===----------------------------------------------------------------------===//
@@ -582,8 +679,11 @@ struct Equivalence {
 // files, and however many annotations come from "real" sources.  When
 // deduplicating, modules tend not to have scala source locators, so we wind
 // up fusing source locators for a module from every copy being deduped.  There
-// is little value in this (all the modules are identical by definition).
-static Location mergeLoc(MLIRContext *context, Location to, Location from) {
+// is little value in this (all the modules are identical by definition).  If
+// `maxLocs` is not zero, at most that many locations are fused, keeping the
+// ones of `to` first.
+static Location mergeLoc(MLIRContext *context, Location to, Location from,
+                         unsigned maxLocs) {
   // Unique the set of locations to be fused.
   llvm::SmallSetVector<Location, 4> decomposedLocs;
   // only track 8 "fir" locations
@@ -621,6 +721,8 @@ static Location mergeLoc(MLIRContext *context, Location to, Location from) {
   }
 
   auto locs = decomposedLocs.getArrayRef();
+  if (maxLocs && locs.size() > maxLocs)
+    locs = locs.take_front(maxLocs);
 
   // Handle the simple cases of less than two locations. Ensure the metadata (if
   // provided) is not dropped.
@@ -637,9 +739,10 @@ struct Deduper {
   using RenameMap = DenseMap<StringAttr, StringAttr>;
 
   Deduper(InstanceGraph &instanceGraph, SymbolTable &symbolTable,
-          NLATable *nlaTable, CircuitOp circuit)
-      : context(circuit->getContext()), instanceGraph(instanceGraph),
-        symbolTable(symbolTable), nlaTable(nlaTable),
+          NLATable *nlaTable, CircuitOp circuit, unsigned maxMergedLocs)
+      : context(circuit->getContext()), maxMergedLocs(maxMergedLocs),
+        instanceGraph(instanceGraph), symbolTable(symbolTable),
+        nlaTable(nlaTable),
         nlaBlock(circuit.getBodyBlock()),
         nonLocalString(StringAttr::get(context, "circt.nonlocal")),
         classString(StringAttr::get(context, "class")) {
@@ -799,15 +902,23 @@ private:
     }
   }
 
-  /// This erases the NLA op, and removes the NLA from every module's NLA map,
-  /// but it does not delete the NLA reference from the target operation's
-  /// annotations.
-  void eraseNLA(HierPathOp nla) {
+  /// This removes the NLA op from the circuit and the symbol table, but it
+  /// does not delete the NLA reference from the target operation's
+  /// annotations. The op itself stays alive until it is dropped from every
+  /// module's NLA map by `eraseNLAs`.
+  void removeNLA(HierPathOp nla) {
     // Erase the NLA from the leaf module's nlaMap.
     targetMap.erase(nla.getNameAttr());
-    nlaTable->erase(nla);
     nlaCache.erase(nla.getNamepathAttr());
-    symbolTable.erase(nla);
+    symbolTable.remove(nla);
+  }
+
+  /// This erases NLA ops previously removed with `removeNLA`, and removes the
+  /// NLAs from every module's NLA map.
+  void eraseNLAs(ArrayRef<HierPathOp> nlas) {
+    nlaTable->eraseNLAs(nlas);
+    for (auto nla : nlas)
+      nla.erase();
   }
 
   /// Process all NLAs referencing the "from" module to point to the "to"
@@ -822,7 +933,8 @@ private:
     // Change the NLA to target the toModule.
     nlaTable->renameModuleAndInnerRef(toName, fromName, renameMap);
     // Now we walk the NLA searching for ones that require more context to be
-    // added.
+    // added. The replaced NLAs are erased together at the end.
+    SmallVector<HierPathOp> replacedNLAs;
     for (auto nla : moduleNLAs) {
       auto elements = nla.getNamepath().getValue();
       // If we don't need to add more context, we're done here.
@@ -865,9 +977,12 @@ private:
           targetMap[nla.getAttr()].insert(target);
       }
 
-      // Erase the old NLA and remove it from all breadcrumbs.
-      eraseNLA(nla);
+      removeNLA(nla);
+      replacedNLAs.push_back(nla);
     }
+
+    // Erase the old NLAs and remove them from all breadcrumbs.
+    eraseNLAs(replacedNLAs);
   }
 
   /// Process all the NLAs that the two modules participate in, replacing
@@ -1072,7 +1187,8 @@ private:
                 FModuleLike fromModule, Operation *from) {
     // Merge the operation locations.
     if (to->getLoc() != from->getLoc())
-      to->setLoc(mergeLoc(context, to->getLoc(), from->getLoc()));
+      to->setLoc(
+          mergeLoc(context, to->getLoc(), from->getLoc(), maxMergedLocs));
 
     // Recurse into any regions.
     for (auto regions : llvm::zip(to->getRegions(), from->getRegions()))
@@ -1104,6 +1220,11 @@ private:
   }
 
   MLIRContext *context;
+
+  /// The maximum number of locations fused when merging operations, or zero
+  /// for no limit.
+  unsigned maxMergedLocs;
+
   InstanceGraph &instanceGraph;
   SymbolTable &symbolTable;
 
@@ -1257,8 +1378,8 @@ class DedupPass : public DedupBase<DedupPass> {
     auto &instanceGraph = getAnalysis<InstanceGraph>();
     auto *nlaTable = &getAnalysis<NLATable>();
     SymbolTable symbolTable(circuit);
-    Deduper deduper(instanceGraph, symbolTable, nlaTable, circuit);
-    StructuralHasher hasher(&getContext());
+    Deduper deduper(instanceGraph, symbolTable, nlaTable, circuit,
+                    maxMergedLocs);
     Equivalence equiv(context, instanceGraph);
     auto anythingChanged = false;
 
@@ -1275,43 +1396,90 @@ class DedupPass : public DedupBase<DedupPass> {
     DenseMap<Attribute, StringAttr> dedupMap;
 
     // We must iterate the modules from the bottom up so that we can properly
-    // deduplicate the modules. We copy the list of modules into a vector first
-    // to avoid iterator invalidation while we mutate the instance graph.
-    SmallVector<FModuleLike, 0> modules(
-        llvm::map_range(llvm::post_order(&instanceGraph), [](auto *node) {
-          return cast<FModuleLike>(*node->getModule());
-        }));
-
-    for (auto module : modules) {
-      auto moduleName = module.moduleNameAttr();
-      // If the module is marked with NoDedup, just skip it.
-      if (AnnotationSet(module).hasAnnotation(noDedupClass)) {
-        // We record it in the dedup map to help detect errors when the user
-        // marks the module as both NoDedup and MustDedup. We do not record this
-        // module in the hasher to make sure no other module dedups "into" this
-        // one.
-        dedupMap[moduleName] = moduleName;
-        continue;
+    // deduplicate the modules. We copy the modules into vectors first to avoid
+    // iterator invalidation while we mutate the instance graph.
+    //
+    // A module's hash covers the names of the modules it instantiates, so it
+    // can only be computed once all of its children were deduplicated. Group
+    // the modules by their height in the instance graph, such that all modules
+    // of one level only instantiate modules of lower levels. The modules of a
+    // level can then be hashed in parallel. Modules with the same hash have the
+    // same children and therefore the same height, and within a level the
+    // modules stay in post-order, so the same module is kept as before.
+    SmallVector<SmallVector<FModuleLike, 0>> levels;
+    for (auto &nodes : instanceGraph.getLevels(/*bottomUp=*/true))
+      levels.emplace_back(llvm::map_range(nodes, [](auto *node) {
+        return cast<FModuleLike>(*node->getModule());
+      }));
+
+    // If a previous run on the same input cached its decisions, replay them
+    // instead of hashing the modules again.
+    auto cachedDecisions = readCache(levels, noDedupClass);
+
+    // The decision taken for every module, in the order they were taken.
+    SmallVector<std::pair<StringAttr, StringAttr>, 0> decisions;
+    // The modules which were kept, by name.
+    DenseMap<StringAttr, FModuleLike> keptModules;
+
+    SmallVector<std::array<uint8_t, 32>, 0> hashes;
+    for (auto &level : levels) {
+      // Calculate the hash of the modules.
+      if (!cachedDecisions) {
+        hashes.resize(level.size());
+        mlir::parallelFor(context, 0, level.size(), [&](size_t i) {
+          if (AnnotationSet(level[i]).hasAnnotation(noDedupClass))
+            return;
+          if (fastHash)
+            hashes[i] = StructuralHasher<FastHash>(context).hash(level[i]);
+          else
+            hashes[i] = StructuralHasher<llvm::SHA256>(context).hash(level[i]);
+        });
       }
-      // Calculate the hash of the module.
-      auto h = hasher.hash(module);
-      // Check if there a module with the same hash.
-      auto it = moduleHashes.find(h);
-      if (it != moduleHashes.end()) {
-        auto original = cast<FModuleLike>(it->second);
-        // Record the group ID of the other module.
-        dedupMap[moduleName] = original.moduleNameAttr();
-        deduper.dedup(original, module);
-        ++erasedModules;
-        anythingChanged = true;
-        continue;
+
+      for (auto &it : llvm::enumerate(level)) {
+        auto module = it.value();
+        auto moduleName = module.moduleNameAttr();
+        // If the module is marked with NoDedup, just skip it.
+        if (AnnotationSet(module).hasAnnotation(noDedupClass)) {
+          // We record it in the dedup map to help detect errors when the user
+          // marks the module as both NoDedup and MustDedup. We do not record
+          // this module in the hasher to make sure no other module dedups
+          // "into" this one.
+          dedupMap[moduleName] = moduleName;
+          decisions.push_back({moduleName, moduleName});
+          continue;
+        }
+        // Check if there a module with the same hash, or which this module was
+        // deduplicated into by the cached run.
+        FModuleLike original;
+        if (cachedDecisions) {
+          auto lead = cachedDecisions->lookup(moduleName);
+          if (lead != moduleName)
+            original = keptModules.lookup(lead);
+        } else {
+          auto hashIt = moduleHashes.find(hashes[it.index()]);
+          if (hashIt != moduleHashes.end())
+            original = cast<FModuleLike>(hashIt->second);
+        }
+        if (original) {
+          // Record the group ID of the other module.
+          dedupMap[moduleName] = original.moduleNameAttr();
+          decisions.push_back({moduleName, original.moduleNameAttr()});
+          deduper.dedup(original, module);
+          ++erasedModules;
+          anythingChanged = true;
+          continue;
+        }
+        // Any module not deduplicated must be recorded.
+        deduper.record(module);
+        // Add the module to a new dedup group.
+        dedupMap[moduleName] = moduleName;
+        decisions.push_back({moduleName, moduleName});
+        keptModules[moduleName] = module;
+        // Record the module's hash.
+        if (!cachedDecisions)
+          moduleHashes[hashes[it.index()]] = module;
       }
-      // Any module not deduplicated must be recorded.
-      deduper.record(module);
-      // Add the module to a new dedup group.
-      dedupMap[moduleName] = moduleName;
-      // Record the module's hash.
-      moduleHashes[h] = module;
     }
 
     // This part verifies that all modules marked by "MustDedup" have been
@@ -1389,13 +1557,159 @@ class DedupPass : public DedupBase<DedupPass> {
     // can block the deduplication of the parent modules.
     fixupAllModules(instanceGraph);
 
-    markAnalysesPreserved<NLATable>();
+    if (!cachedDecisions && mlir::failed(writeCache(decisions)))
+      return signalPassFailure();
+
+    // Modules are merged through the instance graph, which keeps it up to
+    // date.
+    markAnalysesPreserved<NLATable, InstanceGraph>();
     if (!anythingChanged)
       markAllAnalysesPreserved();
   }
+
+  /// Read the decisions of a previous run from the cache file, mapping each
+  /// module to the module it was deduplicated into. Returns nothing if there
+  /// is no cache, if it was written for a different cache key, or if it does
+  /// not describe a valid deduplication of the given modules.
+  Optional<DenseMap<StringAttr, StringAttr>>
+  readCache(ArrayRef<SmallVector<FModuleLike, 0>> levels,
+            StringAttr noDedupClass) {
+    if (cacheFile.empty() || cacheKey.empty())
+      return {};
+    auto buffer = llvm::MemoryBuffer::getFile(cacheFile);
+    if (!buffer)
+      return {};
+    auto json = llvm::json::parse(buffer.get()->getBuffer());
+    if (!json) {
+      llvm::consumeError(json.takeError());
+      return {};
+    }
+    auto *object = json->getAsObject();
+    if (!object || object->getString("key") != StringRef(cacheKey))
+      return {};
+    auto *modules = object->getObject("modules");
+    if (!modules)
+      return {};
+
+    // Every module has to be kept or deduplicated into a kept module which
+    // comes before it, such that replaying the decisions in order is valid.
+    DenseMap<StringAttr, StringAttr> decisions;
+    DenseSet<StringAttr> kept;
+    size_t numModules = 0;
+    for (auto &level : levels) {
+      for (auto module : level) {
+        ++numModules;
+        auto moduleName = module.moduleNameAttr();
+        auto lead = modules->getString(moduleName.getValue());
+        if (!lead)
+          return {};
+        auto leadName = StringAttr::get(&getContext(), *lead);
+        if (leadName == moduleName) {
+          if (!AnnotationSet(module).hasAnnotation(noDedupClass))
+            kept.insert(moduleName);
+        } else if (!kept.contains(leadName)) {
+          return {};
+        }
+        decisions[moduleName] = leadName;
+      }
+    }
+    if (modules->size() != numModules)
+      return {};
+    return decisions;
+  }
+
+  /// Write the decisions taken by this run to the cache file.
+  LogicalResult
+  writeCache(ArrayRef<std::pair<StringAttr, StringAttr>> decisions) {
+    if (cacheFile.empty() || cacheKey.empty())
+      return success();
+    std::string errorMessage;
+    auto output = mlir::openOutputFile(cacheFile, &errorMessage);
+    if (!output) {
+      mlir::emitError(getOperation().getLoc(), errorMessage);
+      return failure();
+    }
+    llvm::json::OStream json(output->os(), 2);
+    json.object([&] {
+      json.attribute("key", cacheKey);
+      json.attributeObject("modules", [&] {
+        for (auto [module, lead] : decisions)
+          json.attribute(module.getValue(), lead.getValue());
+      });
+    });
+    output->keep();
+    return success();
+  }
+};
+} // end anonymous namespace
+
+std::unique_ptr<mlir::Pass>
+circt::firrtl::createDedupPass(StringRef cacheFile, StringRef cacheKey,
+                               unsigned maxMergedLocs, bool fastHash) {
+  auto pass = std::make_unique<DedupPass>();
+  pass->cacheFile = cacheFile.str();
+  pass->cacheKey = cacheKey.str();
+  pass->maxMergedLocs = maxMergedLocs;
+  pass->fastHash = fastHash;
+  return pass;
+}
+
+//===----------------------------------------------------------------------===//
+// ModuleFingerprintsPass
+//===----------------------------------------------------------------------===//
+
+namespace {
+class ModuleFingerprintsPass
+    : public ModuleFingerprintsBase<ModuleFingerprintsPass> {
+  void runOnOperation() override {
+    auto circuit = getOperation();
+    auto *context = &getContext();
+    if (outputFilename.empty()) {
+      circuit.emitError("module fingerprint emission requires an output file");
+      return signalPassFailure();
+    }
+
+    SmallVector<FModuleLike> modules(circuit.getOps<FModuleLike>());
+    SmallVector<std::array<uint8_t, 32>> hashes(modules.size());
+    mlir::parallelFor(context, 0, modules.size(), [&](size_t i) {
+      StructuralHasher<llvm::SHA256> hasher(context, /*stable=*/true);
+      auto moduleHash = hasher.hash(modules[i]);
+      // Mix in the salt so that changing options invalidates every entry.
+      llvm::SHA256 sha;
+      sha.update(StringRef(salt));
+      sha.update(moduleHash);
+      hashes[i] = sha.final();
+    });
+
+    std::string buffer;
+    llvm::raw_string_ostream os(buffer);
+    llvm::json::OStream json(os, 2);
+    json.array([&] {
+      for (auto [module, hash] : llvm::zip(modules, hashes))
+        json.object([&, module = module, hash = hash] {
+          json.attribute("module", module.moduleName());
+          json.attribute("hash", llvm::toHex(hash, /*LowerCase=*/true));
+        });
+    });
+
+    // Use unknown loc to avoid printing the location in the output file.
+    auto builder = OpBuilder::atBlockEnd(circuit.getBodyBlock());
+    auto verbatimOp =
+        builder.create<sv::VerbatimOp>(builder.getUnknownLoc(), os.str());
+    verbatimOp->setAttr("output_file",
+                        hw::OutputFileAttr::getFromFilename(
+                            context, outputFilename,
+                            /*excludeFromFileList=*/true));
+    markAllAnalysesPreserved();
+  }
 };
 } // end anonymous namespace
 
-std::unique_ptr<mlir::Pass> circt::firrtl::createDedupPass() {
-  return std::make_unique<DedupPass>();
+std::unique_ptr<mlir::Pass>
+circt::firrtl::createModuleFingerprintsPass(StringRef outputFilename,
+                                            StringRef salt) {
+  auto pass = std::make_unique<ModuleFingerprintsPass>();
+  pass->outputFilename = outputFilename.str();
+  pass->salt = salt.str();
+  return pass;
 }
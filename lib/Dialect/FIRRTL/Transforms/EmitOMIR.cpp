@@ -23,6 +23,7 @@
 #include "circt/Dialect/SV/SVDialect.h"
 #include "circt/Dialect/SV/SVOps.h"
 #include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/IR/Threading.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/JSON.h"
@@ -52,37 +53,22 @@ struct Tracker {
   int portNo = -1;
 };
 
-class EmitOMIRPass : public EmitOMIRBase<EmitOMIRPass> {
-public:
-  using EmitOMIRBase::outputFilename;
-
-private:
-  void runOnOperation() override;
-  void makeTrackerAbsolute(Tracker &tracker);
+/// The symbols interpolated into a verbatim JSON string, numbered in order of
+/// first use.
+struct SymbolList {
+  SmallVector<Attribute> symbols;
+  SmallDenseMap<Attribute, unsigned> symbolIndices;
 
-  void emitSourceInfo(Location input, SmallString<64> &into);
-  void emitOMNode(Attribute node, llvm::json::OStream &jsonStream);
-  void emitOMField(StringAttr fieldName, DictionaryAttr field,
-                   llvm::json::OStream &jsonStream);
-  void emitOptionalRTLPorts(DictionaryAttr node,
-                            llvm::json::OStream &jsonStream);
-  void emitValue(Attribute node, llvm::json::OStream &jsonStream,
-                 bool dutInstance);
-  void emitTrackedTarget(DictionaryAttr node, llvm::json::OStream &jsonStream,
-                         bool dutInstance);
+  unsigned getIndex(Attribute symbol) {
+    auto it = symbolIndices.insert({symbol, symbols.size()});
+    if (it.second)
+      symbols.push_back(symbol);
+    return it.first->second;
+  }
 
   SmallString<8> addSymbolImpl(Attribute symbol) {
-    unsigned id;
-    auto it = symbolIndices.find(symbol);
-    if (it != symbolIndices.end()) {
-      id = it->second;
-    } else {
-      id = symbols.size();
-      symbols.push_back(symbol);
-      symbolIndices.insert({symbol, id});
-    }
     SmallString<8> str;
-    ("{{" + Twine(id) + "}}").toVector(str);
+    ("{{" + Twine(getIndex(symbol)) + "}}").toVector(str);
     return str;
   }
   SmallString<8> addSymbol(hw::InnerRefAttr symbol) {
@@ -97,6 +83,44 @@ private:
   SmallString<8> addSymbol(Operation *op) {
     return addSymbol(SymbolTable::getSymbolName(op));
   }
+};
+
+/// The serialization of a single top-level `OMNode`.  Nodes are serialized
+/// independently of each other and merged into the final JSON afterwards.
+struct NodeEmission {
+  /// The JSON of this node, with symbols numbered locally.
+  std::string json;
+  /// The symbols referenced by `json`.
+  SymbolList symbols;
+  /// Whether any errors occurred while serializing this node.
+  bool failed = false;
+};
+
+class EmitOMIRPass : public EmitOMIRBase<EmitOMIRPass> {
+public:
+  using EmitOMIRBase::outputFilename;
+
+private:
+  void runOnOperation() override;
+  void makeTrackerAbsolute(Tracker &tracker);
+
+  void addOMNodeSymbols(Attribute node);
+  void addValueSymbols(Attribute node);
+  FModuleLike getTrackedModule(DictionaryAttr node);
+  void mergeOMNode(NodeEmission &emission, raw_ostream &os);
+
+  void emitSourceInfo(Location input, SmallString<64> &into);
+  void emitOMNode(Attribute node, llvm::json::OStream &jsonStream,
+                  NodeEmission &emission);
+  void emitOMField(StringAttr fieldName, DictionaryAttr field,
+                   llvm::json::OStream &jsonStream, NodeEmission &emission);
+  void emitOptionalRTLPorts(DictionaryAttr node,
+                            llvm::json::OStream &jsonStream,
+                            NodeEmission &emission);
+  void emitValue(Attribute node, llvm::json::OStream &jsonStream,
+                 bool dutInstance, NodeEmission &emission);
+  void emitTrackedTarget(DictionaryAttr node, llvm::json::OStream &jsonStream,
+                         bool dutInstance, NodeEmission &emission);
 
   /// Obtain an inner reference to an operation, possibly adding an `inner_sym`
   /// to that operation.
@@ -122,10 +146,8 @@ private:
   /// OMIR target trackers gathered in the current operation, by tracker ID.
   DenseMap<Attribute, Tracker> trackers;
   /// The list of symbols to be interpolated in the verbatim JSON. This gets
-  /// populated as the JSON is constructed and module and instance names are
-  /// collected.
-  SmallVector<Attribute> symbols;
-  SmallDenseMap<Attribute, unsigned> symbolIndices;
+  /// populated as the serialized nodes are merged into the final JSON.
+  SymbolList symbols;
   /// Temporary `firrtl.hierpath` operations to be deleted at the end of the
   /// pass. Vector elements are unique.
   SmallVector<HierPathOp> removeTempNLAs;
@@ -360,7 +382,7 @@ scatterOMField(Attribute original, const Attribute root, unsigned index,
     return None;
   auto maybeLoc =
       maybeStringToLocation(infoAttr.getValue(), false, locatorFilenameCache,
-                            fileLineColLocCache, ctx);
+                            fileLineColLocCache, ctx, /*compact=*/false);
   mlir::LocationAttr infoLoc;
   if (maybeLoc.first)
     infoLoc = maybeLoc.second.value();
@@ -428,7 +450,7 @@ scatterOMNode(Attribute original, const Attribute root, ApplyState &state) {
     return None;
   auto maybeLoc =
       maybeStringToLocation(infoAttr.getValue(), false, locatorFilenameCache,
-                            fileLineColLocCache, ctx);
+                            fileLineColLocCache, ctx, /*compact=*/false);
   mlir::LocationAttr infoLoc;
   if (maybeLoc.first)
     infoLoc = maybeLoc.second.value();
@@ -513,8 +535,7 @@ void EmitOMIRPass::runOnOperation() {
   instanceGraph = nullptr;
   instancePaths = nullptr;
   trackers.clear();
-  symbols.clear();
-  symbolIndices.clear();
+  symbols = {};
   removeTempNLAs.clear();
   moduleNamespaces.clear();
   instancesByName.clear();
@@ -636,26 +657,50 @@ void EmitOMIRPass::runOnOperation() {
     }
   });
 
-  // Build the output JSON.
+  // Add all inner symbols the JSON will refer to up front, in serialization
+  // order. This leaves the IR untouched while the nodes are serialized, which
+  // allows them to be serialized in parallel.
+  SmallVector<Attribute> allNodes;
+  for (auto nodes : annoNodes)
+    allNodes.append(nodes.begin(), nodes.end());
+  for (auto node : allNodes)
+    addOMNodeSymbols(node);
+
+  // Serialize each node into its own buffer. Diagnostics are reported in node
+  // order.
+  SmallVector<NodeEmission> emissions(allNodes.size());
+  {
+    mlir::ParallelDiagnosticHandler diagHandler(context);
+    mlir::parallelFor(context, 0, allNodes.size(), [&](size_t index) {
+      diagHandler.setOrderIDForThread(index);
+      auto &emission = emissions[index];
+      llvm::raw_string_ostream os(emission.json);
+      llvm::json::OStream json(os, 2);
+      emitOMNode(allNodes[index], json, emission);
+      diagHandler.eraseOrderIDForThread();
+    });
+  }
+  if (anyFailures ||
+      llvm::any_of(emissions, [](auto &emission) { return emission.failed; }))
+    return signalPassFailure();
+
+  // Build the output JSON by merging the nodes in order, renumbering their
+  // symbols. This produces exactly what a single `json::OStream` would have.
   std::string jsonBuffer;
   llvm::raw_string_ostream jsonOs(jsonBuffer);
-  llvm::json::OStream json(jsonOs, 2);
-  json.array([&] {
-    for (auto nodes : annoNodes) {
-      for (auto node : nodes) {
-        emitOMNode(node, json);
-        if (anyFailures)
-          return;
-      }
-    }
-  });
-  if (anyFailures)
-    return signalPassFailure();
+  jsonOs << '[';
+  for (auto &emission : emissions) {
+    if (&emission != &emissions.front())
+      jsonOs << ',';
+    jsonOs << "\n  ";
+    mergeOMNode(emission, jsonOs);
+  }
+  jsonOs << (emissions.empty() ? "]" : "\n]");
 
   // Drop temporary (and sometimes invalid) NLA's created during the pass:
+  nlaTable->eraseNLAs(removeTempNLAs);
   for (auto nla : removeTempNLAs) {
     LLVM_DEBUG(llvm::dbgs() << "Removing '" << nla << "'\n");
-    nlaTable->erase(nla);
     nla.erase();
   }
   removeTempNLAs.clear();
@@ -673,7 +718,7 @@ void EmitOMIRPass::runOnOperation() {
   auto fileAttr = hw::OutputFileAttr::getFromFilename(
       context, *outputFilename, /*excludeFromFilelist=*/true, false);
   verbatimOp->setAttr("output_file", fileAttr);
-  verbatimOp.setSymbolsAttr(ArrayAttr::get(context, symbols));
+  verbatimOp.setSymbolsAttr(ArrayAttr::get(context, symbols.symbols));
 
   markAnalysesPreserved<NLATable>();
 }
@@ -702,7 +747,7 @@ void EmitOMIRPass::makeTrackerAbsolute(Tracker &tracker) {
     mod = tracker.op->getParentOfType<FModuleOp>();
 
   // Get all the paths instantiating this module.
-  auto paths = instancePaths->getAbsolutePaths(mod);
+  auto paths = instancePaths->getCompactAbsolutePaths(mod);
   if (paths.empty()) {
     tracker.op->emitError("OMIR node targets uninstantiated component `")
         << opName.getValue() << "`";
@@ -727,7 +772,9 @@ void EmitOMIRPass::makeTrackerAbsolute(Tracker &tracker) {
     namepath.push_back(getInnerRefTo(op));
   };
   // Add the path up to where the NLA starts.
-  for (auto inst : paths[0])
+  SmallVector<hw::HWInstanceLike, 8> pathToNLA;
+  paths[0].toVector(pathToNLA);
+  for (auto inst : pathToNLA)
     addToPath(inst, inst.instanceNameAttr());
   // Add the path from the NLA to the op.
   if (tracker.nla) {
@@ -764,6 +811,147 @@ void EmitOMIRPass::makeTrackerAbsolute(Tracker &tracker) {
   removeTempNLAs.push_back(tracker.nla);
 }
 
+/// Sort the fields of an `OMNode` by their `index`.  Returns the first field
+/// that is not a dictionary, or null if all fields are valid.
+static Attribute
+getOrderedFields(DictionaryAttr fieldsDict,
+                 SmallVectorImpl<std::tuple<unsigned, StringAttr,
+                                            DictionaryAttr>> &orderedFields) {
+  if (!fieldsDict)
+    return {};
+  for (auto nameAndField : fieldsDict.getValue()) {
+    auto fieldDict = nameAndField.getValue().dyn_cast<DictionaryAttr>();
+    if (!fieldDict)
+      return nameAndField.getValue();
+
+    unsigned index = 0;
+    if (auto indexAttr = fieldDict.getAs<IntegerAttr>("index"))
+      index = indexAttr.getValue().getLimitedValue();
+
+    orderedFields.push_back({index, nameAndField.getName(), fieldDict});
+  }
+  llvm::stable_sort(orderedFields, [](auto a, auto b) {
+    return std::get<0>(a) < std::get<0>(b);
+  });
+  return {};
+}
+
+/// Add the inner symbols that serializing an `OMNode` refers to.  This visits
+/// the node in the same order as `emitOMNode` such that symbols are named
+/// exactly as if they were added during serialization.  Malformed nodes are
+/// skipped here and diagnosed during serialization.
+void EmitOMIRPass::addOMNodeSymbols(Attribute node) {
+  auto dict = node.dyn_cast<DictionaryAttr>();
+  if (!dict || !dict.getAs<StringAttr>("id"))
+    return;
+
+  SmallVector<std::tuple<unsigned, StringAttr, DictionaryAttr>> orderedFields;
+  auto fieldsDict = dict.getAs<DictionaryAttr>("fields");
+  if (getOrderedFields(fieldsDict, orderedFields))
+    return;
+  for (auto &orderedField : orderedFields)
+    addValueSymbols(std::get<2>(orderedField).get("value"));
+
+  // Add the symbols of the ports emitted by `emitOptionalRTLPorts`.
+  if (!fieldsDict)
+    return;
+  auto containingModule = fieldsDict.getAs<DictionaryAttr>("containingModule");
+  if (!containingModule)
+    return;
+  auto value = containingModule.getAs<DictionaryAttr>("value");
+  if (!value)
+    return;
+  auto module = getTrackedModule(value);
+  if (!module)
+    return;
+  for (const auto &port : llvm::enumerate(module.getPorts())) {
+    auto portType = port.value().type.dyn_cast<FIRRTLBaseType>();
+    if (portType && portType.getBitWidthOrSentinel() != 0)
+      getInnerRefTo(module, port.index());
+  }
+}
+
+/// Add the inner symbols that serializing an OMIR value refers to.  This is
+/// the counterpart of `emitValue` and `emitTrackedTarget`.
+void EmitOMIRPass::addValueSymbols(Attribute node) {
+  if (auto attr = node.dyn_cast_or_null<ArrayAttr>()) {
+    for (auto element : attr.getValue())
+      addValueSymbols(element);
+    return;
+  }
+  auto attr = node.dyn_cast_or_null<DictionaryAttr>();
+  if (!attr)
+    return;
+  if (!attr.getAs<UnitAttr>("omir.tracker")) {
+    for (auto field : attr.getValue())
+      addValueSymbols(field.getValue());
+    return;
+  }
+
+  auto idAttr = attr.getAs<IntegerAttr>("id");
+  if (!idAttr || !attr.getAs<StringAttr>("type"))
+    return;
+  auto trackerIt = trackers.find(idAttr);
+  if (trackerIt == trackers.end())
+    return;
+  auto &tracker = trackerIt->second;
+
+  // Instances along a non-local path already have a symbol, but must keep it.
+  if (tracker.nla)
+    for (auto nameRef : tracker.nla.getNamepath())
+      if (auto innerRef = nameRef.dyn_cast<hw::InnerRefAttr>())
+        if (auto instOp = instancesByName.lookup(innerRef))
+          tempSymInstances.erase(instOp);
+
+  if (isa<WireOp, RegOp, RegResetOp, InstanceOp, NodeOp, MemOp>(tracker.op)) {
+    tempSymInstances.erase(tracker.op);
+    getInnerRefTo(tracker.op);
+  } else if (auto mod = dyn_cast<FModuleLike>(tracker.op)) {
+    if (tracker.portNo >= 0)
+      getInnerRefTo(mod, tracker.portNo);
+  }
+}
+
+/// Append the JSON of a serialized `OMNode` to the output, nested one level
+/// into the top-level array, and renumber its symbols to global indices.
+void EmitOMIRPass::mergeOMNode(NodeEmission &emission, raw_ostream &os) {
+  // Local indices are in order of first use, so mapping them in order assigns
+  // global indices in order of first use as well.
+  SmallVector<unsigned> globalIndices;
+  for (auto symbol : emission.symbols.symbols)
+    globalIndices.push_back(symbols.getIndex(symbol));
+
+  StringRef json = emission.json;
+  while (!json.empty()) {
+    auto pos = json.find_first_of("\n{");
+    os << json.take_front(pos);
+    if (pos == StringRef::npos)
+      break;
+    json = json.drop_front(pos);
+    // JSON strings cannot contain raw newlines, so indenting after every
+    // newline is safe.
+    if (json.front() == '\n') {
+      os << "\n  ";
+      json = json.drop_front();
+      continue;
+    }
+    // Renumber `{{<index>}}` placeholders.
+    unsigned index;
+    auto rest = json;
+    if (rest.consume_front("{{") && !rest.consumeInteger(10, index) &&
+        index < globalIndices.size() && rest.consume_front("}}")) {
+      os << "{{" << globalIndices[index] << "}}";
+      json = rest;
+      continue;
+    }
+    os << json.front();
+    json = json.drop_front();
+  }
+
+  // Release the node's buffer early to keep peak memory down.
+  std::string().swap(emission.json);
+}
+
 /// Emit a source locator into a string, for inclusion in the `info` field of
 /// `OMNode` and `OMField`.
 void EmitOMIRPass::emitSourceInfo(Location input, SmallString<64> &into) {
@@ -784,14 +972,15 @@ void EmitOMIRPass::emitSourceInfo(Location input, SmallString<64> &into) {
 }
 
 /// Emit an entire `OMNode` as JSON.
-void EmitOMIRPass::emitOMNode(Attribute node, llvm::json::OStream &jsonStream) {
+void EmitOMIRPass::emitOMNode(Attribute node, llvm::json::OStream &jsonStream,
+                              NodeEmission &emission) {
   auto dict = node.dyn_cast<DictionaryAttr>();
   if (!dict) {
     getOperation()
             .emitError("OMNode must be a dictionary")
             .attachNote(getOperation().getLoc())
         << node;
-    anyFailures = true;
+    emission.failed = true;
     return;
   }
 
@@ -799,7 +988,7 @@ void EmitOMIRPass::emitOMNode(Attribute node, llvm::json::OStream &jsonStream) {
   SmallString<64> info;
   if (auto infoAttr = dict.getAs<LocationAttr>("info"))
     emitSourceInfo(infoAttr, info);
-  if (anyFailures)
+  if (emission.failed)
     return;
 
   // Extract the `id` field.
@@ -809,33 +998,20 @@ void EmitOMIRPass::emitOMNode(Attribute node, llvm::json::OStream &jsonStream) {
             .emitError("OMNode missing `id` string field")
             .attachNote(getOperation().getLoc())
         << dict;
-    anyFailures = true;
+    emission.failed = true;
     return;
   }
 
   // Extract and order the fields of this node.
   SmallVector<std::tuple<unsigned, StringAttr, DictionaryAttr>> orderedFields;
   auto fieldsDict = dict.getAs<DictionaryAttr>("fields");
-  if (fieldsDict) {
-    for (auto nameAndField : fieldsDict.getValue()) {
-      auto fieldDict = nameAndField.getValue().dyn_cast<DictionaryAttr>();
-      if (!fieldDict) {
-        getOperation()
-                .emitError("OMField must be a dictionary")
-                .attachNote(getOperation().getLoc())
-            << nameAndField.getValue();
-        anyFailures = true;
-        return;
-      }
-
-      unsigned index = 0;
-      if (auto indexAttr = fieldDict.getAs<IntegerAttr>("index"))
-        index = indexAttr.getValue().getLimitedValue();
-
-      orderedFields.push_back({index, nameAndField.getName(), fieldDict});
-    }
-    llvm::sort(orderedFields,
-               [](auto a, auto b) { return std::get<0>(a) < std::get<0>(b); });
+  if (auto invalidField = getOrderedFields(fieldsDict, orderedFields)) {
+    getOperation()
+            .emitError("OMField must be a dictionary")
+            .attachNote(getOperation().getLoc())
+        << invalidField;
+    emission.failed = true;
+    return;
   }
 
   jsonStream.object([&] {
@@ -844,13 +1020,13 @@ void EmitOMIRPass::emitOMNode(Attribute node, llvm::json::OStream &jsonStream) {
     jsonStream.attributeArray("fields", [&] {
       for (auto &orderedField : orderedFields) {
         emitOMField(std::get<1>(orderedField), std::get<2>(orderedField),
-                    jsonStream);
-        if (anyFailures)
+                    jsonStream, emission);
+        if (emission.failed)
           return;
       }
       if (auto node = fieldsDict.getAs<DictionaryAttr>("containingModule"))
         if (auto value = node.getAs<DictionaryAttr>("value"))
-          emitOptionalRTLPorts(value, jsonStream);
+          emitOptionalRTLPorts(value, jsonStream, emission);
     });
   });
 }
@@ -859,13 +1035,14 @@ void EmitOMIRPass::emitOMNode(Attribute node, llvm::json::OStream &jsonStream) {
 /// provided from the outside, for example as the field name that this attribute
 /// has in the surrounding dictionary.
 void EmitOMIRPass::emitOMField(StringAttr fieldName, DictionaryAttr field,
-                               llvm::json::OStream &jsonStream) {
+                               llvm::json::OStream &jsonStream,
+                               NodeEmission &emission) {
   // Extract the `info` field and serialize the location.
   auto infoAttr = field.getAs<LocationAttr>("info");
   SmallString<64> info;
   if (infoAttr)
     emitSourceInfo(infoAttr, info);
-  if (anyFailures)
+  if (emission.failed)
     return;
 
   jsonStream.object([&] {
@@ -873,7 +1050,7 @@ void EmitOMIRPass::emitOMField(StringAttr fieldName, DictionaryAttr field,
     jsonStream.attribute("name", fieldName.strref());
     jsonStream.attributeBegin("value");
     emitValue(field.get("value"), jsonStream,
-              fieldName.strref().equals("dutInstance"));
+              fieldName.strref().equals("dutInstance"), emission);
     jsonStream.attributeEnd();
   });
 }
@@ -881,15 +1058,15 @@ void EmitOMIRPass::emitOMField(StringAttr fieldName, DictionaryAttr field,
 // If the given `node` refers to a valid tracker in the IR, gather the
 // additional port metadata of the module it refers to. Then emit this port
 // metadata as a `ports` array field for the surrounding `OMNode`.
-void EmitOMIRPass::emitOptionalRTLPorts(DictionaryAttr node,
-                                        llvm::json::OStream &jsonStream) {
-  // First make sure we actually have a valid tracker. If not, just silently
-  // abort and don't emit any port metadata.
+/// Return the module a tracked target refers to, or null if `node` is not a
+/// valid tracker or the tracked operation is not within a module.
+FModuleLike EmitOMIRPass::getTrackedModule(DictionaryAttr node) {
+  // First make sure we actually have a valid tracker.
   auto idAttr = node.getAs<IntegerAttr>("id");
   auto trackerIt = trackers.find(idAttr);
   if (!idAttr || !node.getAs<UnitAttr>("omir.tracker") ||
       trackerIt == trackers.end())
-    return;
+    return {};
   auto tracker = trackerIt->second;
 
   // Lookup the module the tracker refers to. If it points at something *within*
@@ -898,12 +1075,21 @@ void EmitOMIRPass::emitOptionalRTLPorts(DictionaryAttr node,
   auto module = dyn_cast<FModuleLike>(tracker.op);
   if (!module)
     module = tracker.op->getParentOfType<FModuleLike>();
-  if (!module) {
+  if (!module)
     LLVM_DEBUG(llvm::dbgs() << "Not emitting RTL ports since tracked operation "
                                "does not have a FModuleLike parent: "
                             << *tracker.op << "\n");
+  return module;
+}
+
+void EmitOMIRPass::emitOptionalRTLPorts(DictionaryAttr node,
+                                        llvm::json::OStream &jsonStream,
+                                        NodeEmission &emission) {
+  // If the node is not a valid tracker of something within a module, just
+  // silently abort and don't emit any port metadata.
+  auto module = getTrackedModule(node);
+  if (!module)
     return;
-  }
   LLVM_DEBUG(llvm::dbgs() << "Emitting RTL ports for module `"
                           << module.moduleName() << "`\n");
 
@@ -929,9 +1115,10 @@ void EmitOMIRPass::emitOptionalRTLPorts(DictionaryAttr node,
             buf.append(getOperation().getName());
           }
           buf.push_back('|');
-          buf.append(addSymbol(module));
+          buf.append(emission.symbols.addSymbol(module));
           buf.push_back('>');
-          buf.append(addSymbol(getInnerRefTo(module, port.index())));
+          buf.append(
+              emission.symbols.addSymbol(getInnerRefTo(module, port.index())));
           jsonStream.attribute("ref", buf);
 
           // Emit the `direction` field.
@@ -950,7 +1137,7 @@ void EmitOMIRPass::emitOptionalRTLPorts(DictionaryAttr node,
 }
 
 void EmitOMIRPass::emitValue(Attribute node, llvm::json::OStream &jsonStream,
-                             bool dutInstance) {
+                             bool dutInstance, NodeEmission &emission) {
   // Handle the null case.
   if (!node || node.isa<UnitAttr>())
     return jsonStream.value(nullptr);
@@ -982,8 +1169,8 @@ void EmitOMIRPass::emitValue(Attribute node, llvm::json::OStream &jsonStream,
   if (auto attr = node.dyn_cast<ArrayAttr>()) {
     jsonStream.array([&] {
       for (auto element : attr.getValue()) {
-        emitValue(element, jsonStream, dutInstance);
-        if (anyFailures)
+        emitValue(element, jsonStream, dutInstance, emission);
+        if (emission.failed)
           return;
       }
     });
@@ -992,15 +1179,15 @@ void EmitOMIRPass::emitValue(Attribute node, llvm::json::OStream &jsonStream,
   if (auto attr = node.dyn_cast<DictionaryAttr>()) {
     // Handle targets that have a corresponding tracker annotation in the IR.
     if (attr.getAs<UnitAttr>("omir.tracker"))
-      return emitTrackedTarget(attr, jsonStream, dutInstance);
+      return emitTrackedTarget(attr, jsonStream, dutInstance, emission);
 
     // Handle regular dictionaries.
     jsonStream.object([&] {
       for (auto field : attr.getValue()) {
         jsonStream.attributeBegin(field.getName());
-        emitValue(field.getValue(), jsonStream, dutInstance);
+        emitValue(field.getValue(), jsonStream, dutInstance, emission);
         jsonStream.attributeEnd();
-        if (anyFailures)
+        if (emission.failed)
           return;
       }
     });
@@ -1019,12 +1206,12 @@ void EmitOMIRPass::emitValue(Attribute node, llvm::json::OStream &jsonStream,
   jsonStream.value("<unsupported value>");
   getOperation().emitError("unsupported attribute for OMIR serialization: `")
       << node << "`";
-  anyFailures = true;
+  emission.failed = true;
 }
 
 void EmitOMIRPass::emitTrackedTarget(DictionaryAttr node,
                                      llvm::json::OStream &jsonStream,
-                                     bool dutInstance) {
+                                     bool dutInstance, NodeEmission &emission) {
   // Extract the `id` field.
   auto idAttr = node.getAs<IntegerAttr>("id");
   if (!idAttr) {
@@ -1032,7 +1219,7 @@ void EmitOMIRPass::emitTrackedTarget(DictionaryAttr node,
             .emitError("tracked OMIR target missing `id` string field")
             .attachNote(getOperation().getLoc())
         << node;
-    anyFailures = true;
+    emission.failed = true;
     return jsonStream.value("<error>");
   }
 
@@ -1043,7 +1230,7 @@ void EmitOMIRPass::emitTrackedTarget(DictionaryAttr node,
             .emitError("tracked OMIR target missing `type` string field")
             .attachNote(getOperation().getLoc())
         << node;
-    anyFailures = true;
+    emission.failed = true;
     return jsonStream.value("<error>");
   }
   StringRef type = typeAttr.getValue();
@@ -1066,7 +1253,7 @@ void EmitOMIRPass::emitTrackedTarget(DictionaryAttr node,
     if (auto path = node.getAs<StringAttr>("path"))
       diag.attachNote(getOperation().getLoc())
           << "original path: `" << path.getValue() << "`";
-    anyFailures = true;
+    emission.failed = true;
     return jsonStream.value("<error>");
   }
   auto tracker = trackerIt->second;
@@ -1114,10 +1301,10 @@ void EmitOMIRPass::emitTrackedTarget(DictionaryAttr node,
         target.push_back('/');
       notFirst = true;
       if (instName) {
-        target.append(addSymbol(instName));
+        target.append(emission.symbols.addSymbol(instName));
         target.push_back(':');
       }
-      target.append(addSymbol(module));
+      target.append(emission.symbols.addSymbol(module));
 
       if (auto innerRef = nameRef.dyn_cast<hw::InnerRefAttr>()) {
         // Find an instance with the given name in this module. Ensure it has a
@@ -1128,7 +1315,6 @@ void EmitOMIRPass::emitTrackedTarget(DictionaryAttr node,
         LLVM_DEBUG(llvm::dbgs() << "Marking NLA-participating instance "
                                 << innerRef.getName() << " in module "
                                 << modName << " as dont-touch\n");
-        tempSymInstances.erase(instOp);
         instName = getInnerRefTo(instOp);
       }
     }
@@ -1144,14 +1330,13 @@ void EmitOMIRPass::emitTrackedTarget(DictionaryAttr node,
       target.append(dutModuleName);
       target.push_back('|');
     }
-    target.append(addSymbol(module));
+    target.append(emission.symbols.addSymbol(module));
   }
 
   // Serialize any potential component *inside* the module that this target may
   // specifically refer to.
   hw::InnerRefAttr componentName;
   if (isa<WireOp, RegOp, RegResetOp, InstanceOp, NodeOp, MemOp>(tracker.op)) {
-    tempSymInstances.erase(tracker.op);
     componentName = getInnerRefTo(tracker.op);
     LLVM_DEBUG(llvm::dbgs() << "Marking OMIR-targeted " << componentName
                             << " as dont-touch\n");
@@ -1160,7 +1345,7 @@ void EmitOMIRPass::emitTrackedTarget(DictionaryAttr node,
       componentName = getInnerRefTo(mod, tracker.portNo);
   } else if (!isa<FModuleLike>(tracker.op)) {
     tracker.op->emitError("invalid target for `") << type << "` OMIR";
-    anyFailures = true;
+    emission.failed = true;
     return jsonStream.value("<error>");
   }
   if (componentName) {
@@ -1172,21 +1357,22 @@ void EmitOMIRPass::emitTrackedTarget(DictionaryAttr node,
       if (type == "OMMemberInstanceTarget") {
         if (auto instOp = dyn_cast<InstanceOp>(tracker.op)) {
           target.push_back('/');
-          target.append(addSymbol(componentName));
+          target.append(emission.symbols.addSymbol(componentName));
           target.push_back(':');
-          target.append(addSymbol(instOp.getModuleNameAttr()));
+          target.append(
+              emission.symbols.addSymbol(instOp.getModuleNameAttr()));
           return;
         }
         if (auto memOp = dyn_cast<MemOp>(tracker.op)) {
           target.push_back('/');
-          target.append(addSymbol(componentName));
+          target.append(emission.symbols.addSymbol(componentName));
           target.push_back(':');
           target.append(memOp.getSummary().getFirMemoryName());
           return;
         }
       }
       target.push_back('>');
-      target.append(addSymbol(componentName));
+      target.append(emission.symbols.addSymbol(componentName));
     }();
   }
 
@@ -30,84 +30,102 @@ static void mergeBlock(Block &destination, Block::iterator insertPoint,
   destination.getOperations().splice(insertPoint, source.getOperations());
 }
 
-/// This is a stack of hashtables, if lookup fails in the top-most hashtable,
-/// it will attempt to lookup in lower hashtables.  This class is used instead
-/// of a ScopedHashTable so we can manually pop off a scope and keep it around.
+/// This is a scoped hashtable where lookups see the innermost value of a key
+/// across all scopes. This class is used instead of a ScopedHashTable so we can
+/// manually pop off a scope and keep its entries around.
 ///
-/// This only allows inserting into the outermost scope.
+/// All scopes share a single hashtable which holds the innermost value of each
+/// key, so lookups take constant time regardless of the nesting depth. Each
+/// scope keeps an undo log of the keys it set and the outer values it
+/// shadowed, which are restored when the scope is popped.
+///
+/// This only allows inserting into the innermost scope.
 template <typename KeyT, typename ValueT>
-struct HashTableStack {
+struct ScopedMap {
   using ScopeT = typename llvm::MapVector<KeyT, ValueT>;
-  using StackT = typename llvm::SmallVector<ScopeT, 3>;
-
-  struct Iterator {
-    Iterator(typename StackT::iterator stackIt,
-             typename ScopeT::iterator scopeIt)
-        : stackIt(stackIt), scopeIt(scopeIt) {}
-
-    bool operator==(const Iterator &rhs) const {
-      return stackIt == rhs.stackIt && scopeIt == rhs.scopeIt;
-    }
-
-    bool operator!=(const Iterator &rhs) const { return !(*this == rhs); }
-
-    std::pair<KeyT, ValueT> &operator*() const { return *scopeIt; }
-
-    Iterator &operator++() {
-      if (scopeIt == stackIt->end())
-        scopeIt = (++stackIt)->begin();
-      else
-        ++scopeIt;
-      return *this;
-    }
-
-    typename StackT::iterator stackIt;
-    typename ScopeT::iterator scopeIt;
-  };
 
-  HashTableStack() {
+  ScopedMap() {
     // We require at least one scope.
     pushScope();
   }
 
-  using iterator = Iterator;
-
-  iterator begin() {
-    return Iterator(mapStack.begin(), mapStack.first().begin());
+  /// Return the innermost value of a key, or null if it is not in any scope.
+  /// The pointer is invalidated by any insertion.
+  ValueT *lookup(const KeyT &key) {
+    auto it = entries.find(key);
+    if (it == entries.end())
+      return nullptr;
+    return &it->second.value;
   }
 
-  iterator end() { return Iterator(mapStack.end() - 1, mapStack.back().end()); }
-
-  iterator find(const KeyT &key) {
-    // Try to find a hashtable with the missing value.
-    for (auto i = mapStack.size(); i > 0; --i) {
-      auto &map = mapStack[i - 1];
-      auto it = map.find(key);
-      if (it != map.end())
-        return Iterator(mapStack.begin() + i - 1, it);
+  /// Insert a value into the innermost scope, unless the key is already set in
+  /// that scope. Returns the value slot of the key in the innermost scope, and
+  /// whether the value was inserted. The pointer is invalidated by any other
+  /// insertion.
+  std::pair<ValueT *, bool> insert(const KeyT &key, ValueT value) {
+    auto depth = scopes.size();
+    auto [it, inserted] = entries.try_emplace(key, Entry{value, depth});
+    if (inserted) {
+      scopes.back().push_back({key, llvm::None});
+      return {&it->second.value, true};
     }
-    return end();
+    if (it->second.depth == depth)
+      return {&it->second.value, false};
+    scopes.back().push_back({key, it->second});
+    it->second = Entry{value, depth};
+    return {&it->second.value, true};
   }
 
-  ScopeT &getLastScope() { return mapStack.back(); }
+  /// Return the value of a key in the innermost scope, inserting a default
+  /// constructed one if it is not set in that scope.
+  ValueT &operator[](const KeyT &key) { return *insert(key, ValueT()).first; }
 
-  void pushScope() { mapStack.emplace_back(); }
+  /// Return the entries of the innermost scope, in insertion order.
+  ScopeT getLastScope() {
+    ScopeT scope;
+    for (auto &undo : scopes.back())
+      scope.insert({undo.key, entries.find(undo.key)->second.value});
+    return scope;
+  }
 
+  void pushScope() { scopes.emplace_back(); }
+
+  /// Pop the innermost scope, restoring the values it shadowed, and return
+  /// its entries in insertion order.
   ScopeT popScope() {
-    assert(mapStack.size() > 1 && "Cannot pop the last scope");
-    return mapStack.pop_back_val();
+    assert(scopes.size() > 1 && "Cannot pop the last scope");
+    auto scope = getLastScope();
+    for (auto &undo : llvm::reverse(scopes.back())) {
+      if (undo.shadowed)
+        entries[undo.key] = *undo.shadowed;
+      else
+        entries.erase(undo.key);
+    }
+    scopes.pop_back();
+    return scope;
   }
 
-  // This class lets you insert into the top scope.
-  ValueT &operator[](const KeyT &key) { return mapStack.back()[key]; }
-
 private:
-  StackT mapStack;
+  struct Entry {
+    ValueT value;
+    /// The number of scopes that were open when the value was set.
+    size_t depth;
+  };
+  struct Undo {
+    KeyT key;
+    /// The entry of an outer scope which was shadowed by this key, if any.
+    llvm::Optional<Entry> shadowed;
+  };
+
+  /// The innermost value of every key across all scopes.
+  llvm::DenseMap<KeyT, Entry> entries;
+  /// The undo log of every scope, from outermost to innermost.
+  llvm::SmallVector<llvm::SmallVector<Undo, 0>, 3> scopes;
 };
 
 /// This is a determistic mapping of a FieldRef to the last operation which set
 /// a value to it.
-using ScopedDriverMap = HashTableStack<FieldRef, Operation *>;
+using ScopedDriverMap = ScopedMap<FieldRef, Operation *>;
 using DriverMap = ScopedDriverMap::ScopeT;
 
 //===----------------------------------------------------------------------===//
@@ -137,17 +155,16 @@ public:
   /// true if an old connect was erased.
   bool setLastConnect(FieldRef dest, Operation *connection) {
     // Try to insert, if it doesn't insert, replace the previous value.
-    auto itAndInserted = driverMap.getLastScope().insert({dest, connection});
-    if (!std::get<1>(itAndInserted)) {
-      auto iterator = std::get<0>(itAndInserted);
+    auto [slot, inserted] = driverMap.insert(dest, connection);
+    if (!inserted) {
       auto changed = false;
       // Delete the old connection if it exists. Null connections are inserted
       // on declarations.
-      if (auto *oldConnect = iterator->second) {
+      if (auto *oldConnect = *slot) {
         oldConnect->erase();
         changed = true;
       }
-      iterator->second = connection;
+      *slot = connection;
       return changed;
     }
     return false;
@@ -331,8 +348,8 @@ public:
       auto dest = std::get<0>(destAndConnect);
       auto thenConnect = std::get<1>(destAndConnect);
 
-      auto outerIt = driverMap.find(dest);
-      if (outerIt == driverMap.end()) {
+      auto *outerSlot = driverMap.lookup(dest);
+      if (!outerSlot) {
         // `dest` is set in `then` only. This indicates it was created in the
         // `then` block, so just copy it into the outer scope.
         driverMap[dest] = thenConnect;
@@ -361,7 +378,7 @@ public:
         continue;
       }
 
-      auto &outerConnect = std::get<1>(*outerIt);
+      auto *outerConnect = *outerSlot;
       if (!outerConnect) {
         // `dest` is null in the outer scope. This indicate an initialization
         // problem: `mux(p, then, nullptr)`. Just delete the broken connect.
@@ -386,15 +403,15 @@ public:
       auto dest = std::get<0>(destAndConnect);
       auto elseConnect = std::get<1>(destAndConnect);
 
-      auto outerIt = driverMap.find(dest);
-      if (outerIt == driverMap.end()) {
+      auto *outerSlot = driverMap.lookup(dest);
+      if (!outerSlot) {
         // `dest` is set in `else` only. This indicates it was created in the
         // `else` block, so just copy it into the outer scope.
         driverMap[dest] = elseConnect;
         continue;
       }
 
-      auto &outerConnect = std::get<1>(*outerIt);
+      auto *outerConnect = *outerSlot;
       if (!outerConnect) {
         // `dest` is null in the outer scope. This indicate an initialization
         // problem: `mux(p, null, else)`. Just delete the broken connect.
@@ -182,6 +182,8 @@ void ExtractInstancesPass::runOnOperation() {
   LLVM_DEBUG(llvm::dbgs() << "\n");
   if (!anythingChanged)
     markAllAnalysesPreserved();
+  else
+    markAnalysesPreserved<InstanceGraph>();
 }
 
 static bool isAnnoInteresting(Annotation anno) {
@@ -450,11 +452,42 @@ static unsigned findInstanceInNLA(InstanceOp inst, HierPathOp nla) {
 
 /// Move instances in the extraction worklist upwards in the hierarchy. This
 /// iteratively pushes instances up one level of hierarchy until they have
-/// arrived in the desired container module.
+/// arrived in the desired container module. All instances at the back of the
+/// worklist that leave the same parent module are moved together, such that
+/// the parent module and each of its instantiations are only rewritten once.
 void ExtractInstancesPass::extractInstances() {
-  // The list of ports to be added to an instance's parent module. Cleared and
-  // reused across instances.
+  /// An instance moved out of its parent module, and the state gathered for it
+  /// before the instantiations of the parent module are updated.
+  struct Extraction {
+    InstanceOp inst;
+    ExtractionInfo info;
+    /// The index of the first parent module port added for the instance.
+    unsigned portOffset;
+    /// The NLAs that pass through or end at the instance.
+    DenseSet<HierPathOp> instanceNLAs;
+    /// The same NLAs, sorted by name to have a deterministic output.
+    SmallVector<HierPathOp> sortedInstanceNLAs;
+    /// The nonlocal annotations of the instance, grouped by their NLA.
+    DenseMap<HierPathOp, SmallVector<Annotation>> instNonlocalAnnos;
+    /// The clones of the instance, one for each parent module instantiation.
+    SmallVector<InstanceOp> newInsts;
+  };
+
+  /// A clone of an extracted instance, placed next to one instantiation of the
+  /// instance's old parent module.
+  struct MovedInstance {
+    unsigned extractionIdx;
+    InstanceOp newParentInst;
+    InstanceOp newInst;
+  };
+
+  // The list of ports to be added to a parent module. Cleared and reused across
+  // parent modules.
   SmallVector<std::pair<unsigned, PortInfo>> newPorts;
+  // The instances moved out of a parent module together, and their clones.
+  // Cleared and reused across parent modules.
+  SmallVector<Extraction> batch;
+  SmallVector<MovedInstance> movedInstances;
   // The number of instances with the same prefix. Used to uniquify prefices.
   DenseMap<StringRef, unsigned> prefixUniqueIDs;
 
@@ -467,110 +500,140 @@ void ExtractInstancesPass::extractInstances() {
     originalInstanceParents[inst] =
         inst->getParentOfType<FModuleLike>().moduleNameAttr();
 
-  while (!extractionWorklist.empty()) {
-    InstanceOp inst;
-    ExtractionInfo info;
-    std::tie(inst, info) = extractionWorklist.pop_back_val();
-    auto parent = inst->getParentOfType<FModuleOp>();
-
-    // Figure out the wiring prefix to use for this instance. If we are supposed
-    // to use a wiring prefix (`info.prefix` is non-empty), we assemble a
-    // `<prefix>_<N>` string, where `N` is an unsigned integer used to uniquifiy
-    // the prefix. This is very close to what the original Scala implementation
-    // of the pass does, which would group instances to be extracted by prefix
-    // and then iterate over them with the index in the group being used as `N`.
-    StringRef prefix;
-    if (!info.prefix.empty()) {
-      auto &prefixSlot = instPrefices[inst];
-      if (prefixSlot.empty()) {
-        auto idx = prefixUniqueIDs[info.prefix]++;
-        (Twine(info.prefix) + "_" + Twine(idx)).toVector(prefixSlot);
-      }
-      prefix = prefixSlot;
+  // Figure out the wiring prefix to use for an instance. If we are supposed to
+  // use a wiring prefix (`info.prefix` is non-empty), we assemble a
+  // `<prefix>_<N>` string, where `N` is an unsigned integer used to uniquifiy
+  // the prefix. This is very close to what the original Scala implementation
+  // of the pass does, which would group instances to be extracted by prefix
+  // and then iterate over them with the index in the group being used as `N`.
+  // The returned prefix is only valid until the next prefix is assigned.
+  auto assignPrefix = [&](InstanceOp inst,
+                          const ExtractionInfo &info) -> StringRef {
+    if (info.prefix.empty())
+      return {};
+    auto &prefixSlot = instPrefices[inst];
+    if (prefixSlot.empty()) {
+      auto idx = prefixUniqueIDs[info.prefix]++;
+      (Twine(info.prefix) + "_" + Twine(idx)).toVector(prefixSlot);
     }
+    return prefixSlot;
+  };
 
-    // If the instance is already in the right place (outside the DUT or already
-    // in the root module), there's nothing left for us to do. Otherwise we
-    // proceed to bubble it up one level in the hierarchy and add the resulting
-    // instances back to the worklist.
-    if (!dutModules.contains(parent) ||
-        instanceGraph->lookup(parent)->noUses() ||
-        (info.stopAtDUT && dutRootModules.contains(parent))) {
+  // If the instance is already in the right place (outside the DUT or already
+  // in the root module), there's nothing left for us to do. Otherwise we
+  // proceed to bubble it up one level in the hierarchy and add the resulting
+  // instances back to the worklist.
+  auto needsMove = [&](InstanceOp inst, const ExtractionInfo &info) {
+    auto parent = inst->getParentOfType<FModuleOp>();
+    return dutModules.contains(parent) &&
+           !instanceGraph->lookup(parent)->noUses() &&
+           !(info.stopAtDUT && dutRootModules.contains(parent));
+  };
+
+  while (!extractionWorklist.empty()) {
+    auto parent =
+        extractionWorklist.back().first->getParentOfType<FModuleOp>();
+    if (!needsMove(extractionWorklist.back().first,
+                   extractionWorklist.back().second)) {
+      InstanceOp inst;
+      ExtractionInfo info;
+      std::tie(inst, info) = extractionWorklist.pop_back_val();
+      assignPrefix(inst, info);
       LLVM_DEBUG(llvm::dbgs() << "\nNo need to further move " << inst << "\n");
       extractedInstances.push_back({inst, info});
       continue;
     }
-    LLVM_DEBUG({
-      llvm::dbgs() << "\nMoving ";
-      if (!prefix.empty())
-        llvm::dbgs() << "`" << prefix << "` ";
-      llvm::dbgs() << inst << "\n";
-    });
 
-    // Add additional ports to the parent module as a replacement for the
-    // instance port signals once the instance is extracted.
+    // Pop all instances at the back of the worklist that are moved out of the
+    // same parent module, and add additional ports to the parent module as a
+    // replacement for their port signals once the instances are extracted.
     unsigned numParentPorts = parent.getNumPorts();
-    unsigned numInstPorts = inst.getNumResults();
-
-    for (unsigned portIdx = 0; portIdx < numInstPorts; ++portIdx) {
-      // Assemble the new port name as "<prefix>_<name>", where the prefix is
-      // provided by the extraction annotation.
-      auto name = inst.getPortNameStr(portIdx);
-      auto nameAttr = StringAttr::get(
-          &getContext(),
-          prefix.empty() ? Twine(name) : Twine(prefix) + "_" + name);
-
-      PortInfo newPort{nameAttr,
-                       inst.getResult(portIdx).getType().cast<FIRRTLType>(),
-                       direction::flip(inst.getPortDirection(portIdx))};
-      newPort.loc = inst.getResult(portIdx).getLoc();
-      newPorts.push_back({numParentPorts, newPort});
-      LLVM_DEBUG(llvm::dbgs()
-                 << "- Adding port " << newPort.direction << " "
-                 << newPort.name.getValue() << ": " << newPort.type << "\n");
+    batch.clear();
+    newPorts.clear();
+    while (!extractionWorklist.empty() &&
+           extractionWorklist.back().first->getParentOp() ==
+               parent.getOperation() &&
+           needsMove(extractionWorklist.back().first,
+                     extractionWorklist.back().second)) {
+      auto &extraction = batch.emplace_back();
+      std::tie(extraction.inst, extraction.info) =
+          extractionWorklist.pop_back_val();
+      auto inst = extraction.inst;
+      extraction.portOffset = numParentPorts + newPorts.size();
+      StringRef prefix = assignPrefix(inst, extraction.info);
+      LLVM_DEBUG({
+        llvm::dbgs() << "\nMoving ";
+        if (!prefix.empty())
+          llvm::dbgs() << "`" << prefix << "` ";
+        llvm::dbgs() << inst << "\n";
+      });
+
+      for (unsigned portIdx = 0, e = inst.getNumResults(); portIdx < e;
+           ++portIdx) {
+        // Assemble the new port name as "<prefix>_<name>", where the prefix is
+        // provided by the extraction annotation.
+        auto name = inst.getPortNameStr(portIdx);
+        auto nameAttr = StringAttr::get(
+            &getContext(),
+            prefix.empty() ? Twine(name) : Twine(prefix) + "_" + name);
+
+        PortInfo newPort{nameAttr,
+                         inst.getResult(portIdx).getType().cast<FIRRTLType>(),
+                         direction::flip(inst.getPortDirection(portIdx))};
+        newPort.loc = inst.getResult(portIdx).getLoc();
+        newPorts.push_back({numParentPorts, newPort});
+        LLVM_DEBUG(llvm::dbgs()
+                   << "- Adding port " << newPort.direction << " "
+                   << newPort.name.getValue() << ": " << newPort.type << "\n");
+      }
     }
     parent.insertPorts(newPorts);
     anythingChanged = true;
 
-    // Replace all uses of the existing instance ports with the newly-created
-    // module ports.
-    for (unsigned portIdx = 0; portIdx < numInstPorts; ++portIdx) {
-      inst.getResult(portIdx).replaceAllUsesWith(
-          parent.getArgument(numParentPorts + portIdx));
+    for (auto &extraction : batch) {
+      auto inst = extraction.inst;
+
+      // Replace all uses of the existing instance ports with the newly-created
+      // module ports.
+      for (unsigned portIdx = 0, e = inst.getNumResults(); portIdx < e;
+           ++portIdx)
+        inst.getResult(portIdx).replaceAllUsesWith(
+            parent.getArgument(extraction.portOffset + portIdx));
+      assert(inst.use_empty() && "instance ports should have been detached");
+
+      // Get the NLAs that pass through the InstanceOp `inst`.
+      // This does not returns NLAs that have the `inst` as the leaf.
+      nlaTable.getInstanceNLAs(inst, extraction.instanceNLAs);
+      // Map of the NLAs, that are applied to the InstanceOp. That is the NLA
+      // terminates on the InstanceOp.
+      AnnotationSet::removeAnnotations(inst, [&](Annotation anno) {
+        // Only consider annotations with a `circt.nonlocal` field.
+        auto nlaName = anno.getMember<FlatSymbolRefAttr>("circt.nonlocal");
+        if (!nlaName)
+          return false;
+        // Track the NLA.
+        if (HierPathOp nla = nlaTable.getNLA(nlaName.getAttr())) {
+          extraction.instNonlocalAnnos[nla].push_back(anno);
+          extraction.instanceNLAs.insert(nla);
+        }
+        return true;
+      });
+
+      // Sort the instance NLAs we've collected by the NLA name to have a
+      // deterministic output.
+      extraction.sortedInstanceNLAs.assign(extraction.instanceNLAs.begin(),
+                                           extraction.instanceNLAs.end());
+      llvm::sort(extraction.sortedInstanceNLAs, [](auto a, auto b) {
+        return a.getSymName() < b.getSymName();
+      });
     }
-    assert(inst.use_empty() && "instance ports should have been detached");
-    DenseSet<HierPathOp> instanceNLAs;
-    // Get the NLAs that pass through the InstanceOp `inst`.
-    // This does not returns NLAs that have the `inst` as the leaf.
-    nlaTable.getInstanceNLAs(inst, instanceNLAs);
-    // Map of the NLAs, that are applied to the InstanceOp. That is the NLA
-    // terminates on the InstanceOp.
-    DenseMap<HierPathOp, SmallVector<Annotation>> instNonlocalAnnos;
-    AnnotationSet::removeAnnotations(inst, [&](Annotation anno) {
-      // Only consider annotations with a `circt.nonlocal` field.
-      auto nlaName = anno.getMember<FlatSymbolRefAttr>("circt.nonlocal");
-      if (!nlaName)
-        return false;
-      // Track the NLA.
-      if (HierPathOp nla = nlaTable.getNLA(nlaName.getAttr())) {
-        instNonlocalAnnos[nla].push_back(anno);
-        instanceNLAs.insert(nla);
-      }
-      return true;
-    });
 
-    // Sort the instance NLAs we've collected by the NLA name to have a
-    // deterministic output.
-    SmallVector<HierPathOp> sortedInstanceNLAs(instanceNLAs.begin(),
-                                               instanceNLAs.end());
-    llvm::sort(sortedInstanceNLAs,
-               [](auto a, auto b) { return a.getSymName() < b.getSymName(); });
-
-    // Move the original instance one level up such that it is right next to
-    // the instances of the parent module, and wire the instance ports up to
-    // the newly added parent module ports.
+    // Update each instantiation of the parent module once to carry the ports
+    // of all moved instances, and place a clone of each moved instance right
+    // next to it, wired up to the newly added parent module ports.
     auto *instParentNode =
         instanceGraph->lookup(cast<hw::HWModuleLike>(*parent));
+    movedInstances.clear();
     for (auto *instRecord : instParentNode->uses()) {
       auto oldParentInst = cast<InstanceOp>(*instRecord->getInstance());
       auto newParent = oldParentInst->getParentOfType<FModuleLike>();
@@ -582,33 +645,65 @@ void ExtractInstancesPass::extractInstances() {
         oldParentInst.getResult(portIdx).replaceAllUsesWith(
             newParentInst.getResult(portIdx));
 
-      // Clone the existing instance and remove it from its current parent, such
-      // that we can insert it at its extracted location.
-      auto newInst = inst.cloneAndInsertPorts({});
-      newInst->remove();
-
-      // Ensure that the `inner_sym` of the instance is unique within the parent
-      // module we're extracting it to.
-      if (auto instSym = getInnerSymName(inst)) {
-        auto newName =
-            getModuleNamespace(newParent).newName(instSym.getValue());
-        if (newName != instSym.getValue())
-          newInst.setInnerSymAttr(
-              InnerSymAttr::get(StringAttr::get(&getContext(), newName)));
-      }
+      for (unsigned extractionIdx = 0, e = batch.size(); extractionIdx < e;
+           ++extractionIdx) {
+        auto inst = batch[extractionIdx].inst;
+        unsigned portOffset = batch[extractionIdx].portOffset;
+
+        // Clone the existing instance and remove it from its current parent,
+        // such that we can insert it at its extracted location.
+        auto newInst = inst.cloneAndInsertPorts({});
+        newInst->remove();
+
+        // Ensure that the `inner_sym` of the instance is unique within the
+        // parent module we're extracting it to.
+        if (auto instSym = getInnerSymName(inst)) {
+          auto newName =
+              getModuleNamespace(newParent).newName(instSym.getValue());
+          if (newName != instSym.getValue())
+            newInst.setInnerSymAttr(
+                InnerSymAttr::get(StringAttr::get(&getContext(), newName)));
+        }
 
-      // Add the moved instance and hook it up to the added ports.
-      ImplicitLocOpBuilder builder(inst.getLoc(), newParentInst);
-      builder.setInsertionPointAfter(newParentInst);
-      builder.insert(newInst);
-      for (unsigned portIdx = 0; portIdx < numInstPorts; ++portIdx) {
-        auto dst = newInst.getResult(portIdx);
-        auto src = newParentInst.getResult(numParentPorts + portIdx);
-        if (newPorts[portIdx].second.direction == Direction::In)
-          std::swap(src, dst);
-        builder.create<StrictConnectOp>(dst, src);
+        // Add the moved instance and hook it up to the added ports.
+        ImplicitLocOpBuilder builder(inst.getLoc(), newParentInst);
+        builder.setInsertionPointAfter(newParentInst);
+        builder.insert(newInst);
+        instanceGraph->addInstance(newInst);
+        unsigned numInstPorts = inst.getNumResults();
+        for (unsigned portIdx = 0; portIdx < numInstPorts; ++portIdx) {
+          auto dst = newInst.getResult(portIdx);
+          auto src = newParentInst.getResult(portOffset + portIdx);
+          if (newPorts[portOffset - numParentPorts + portIdx]
+                  .second.direction == Direction::In)
+            std::swap(src, dst);
+          builder.create<StrictConnectOp>(dst, src);
+        }
+        movedInstances.push_back({extractionIdx, newParentInst, newInst});
       }
 
+      // Keep instance graph up-to-date.
+      instanceGraph->replaceInstance(oldParentInst, newParentInst);
+      oldParentInst.erase();
+    }
+
+    // Update the prefices and NLAs of the clones one moved instance at a time,
+    // in the same order as if the instances were moved one by one.
+    llvm::stable_sort(movedInstances, [](auto &a, auto &b) {
+      return a.extractionIdx < b.extractionIdx;
+    });
+    Builder builder(&getContext());
+    // The NLAs which became local, to be dropped from the NLATable together.
+    SmallVector<HierPathOp> localizedNLAs;
+    for (auto &moved : movedInstances) {
+      auto &extraction = batch[moved.extractionIdx];
+      auto inst = extraction.inst;
+      auto &instNonlocalAnnos = extraction.instNonlocalAnnos;
+      auto &sortedInstanceNLAs = extraction.sortedInstanceNLAs;
+      auto newParentInst = moved.newParentInst;
+      auto newParent = newParentInst->getParentOfType<FModuleLike>();
+      auto newInst = moved.newInst;
+
       // Move the wiring prefix from the old to the new instance. We just look
       // up the prefix for the old instance and if it exists, we remove it and
       // assign it to the new instance. This has the effect of making the first
@@ -744,7 +839,7 @@ void ExtractInstancesPass::extractInstances() {
             LLVM_DEBUG(llvm::dbgs() << "    - Converted to local "
                                     << anno.getDict() << "\n");
           }
-          nlaTable.erase(nla);
+          localizedNLAs.push_back(nla);
           nlasToRemove.insert(nla);
           continue;
         }
@@ -793,24 +888,28 @@ void ExtractInstancesPass::extractInstances() {
       AnnotationSet newInstAnnos(newInst);
       newInstAnnos.addAnnotations(newInstNonlocalAnnos);
       newInstAnnos.applyToOperation(newInst);
-
-      // Add the moved instance to the extraction worklist such that it gets
-      // bubbled up further if needed.
-      extractionWorklist.push_back({newInst, info});
+      extraction.newInsts.push_back(newInst);
       LLVM_DEBUG(llvm::dbgs() << "  - Updated to " << newInst << "\n");
-
-      // Keep instance graph up-to-date.
-      instanceGraph->replaceInstance(oldParentInst, newParentInst);
-      oldParentInst.erase();
     }
-    // Remove the obsolete NLAs from the instance of the parent module, since
-    // the extracted instance no longer resides in that module and any NLAs to
-    // it no longer go through the parent module.
-    nlaTable.removeNLAsfromModule(instanceNLAs, parent.getNameAttr());
-
-    // Clean up the original instance.
-    inst.erase();
-    newPorts.clear();
+    nlaTable.eraseNLAs(localizedNLAs);
+
+    for (auto &extraction : llvm::reverse(batch)) {
+      // Add the moved instances to the extraction worklist such that they get
+      // bubbled up further if needed. The instances popped first are pushed
+      // last, such that they are also moved further up first.
+      for (auto newInst : extraction.newInsts)
+        extractionWorklist.push_back({newInst, extraction.info});
+
+      // Remove the obsolete NLAs from the instance of the parent module, since
+      // the extracted instance no longer resides in that module and any NLAs
+      // to it no longer go through the parent module.
+      nlaTable.removeNLAsfromModule(extraction.instanceNLAs,
+                                    parent.getNameAttr());
+
+      // Clean up the original instance.
+      instanceGraph->eraseInstance(extraction.inst);
+      extraction.inst.erase();
+    }
   }
 
   // Remove unused NLAs.
@@ -929,6 +1028,7 @@ void ExtractInstancesPass::groupInstances() {
     auto wrapper = builder.create<FModuleOp>(
         builder.getUnknownLoc(), builder.getStringAttr(wrapperName), ports);
     SymbolTable::setSymbolVisibility(wrapper, SymbolTable::Visibility::Private);
+    instanceGraph->addModule(wrapper);
 
     // Instantiate the wrapper module in the parent and replace uses of the
     // extracted instances' ports with the corresponding wrapper module ports.
@@ -939,6 +1039,7 @@ void ExtractInstancesPass::groupInstances() {
         ArrayRef<Attribute>{},
         /*portAnnotations=*/ArrayRef<Attribute>{}, /*lowerToBind=*/false,
         wrapperInstName);
+    instanceGraph->addInstance(wrapperInst);
     unsigned portIdx = 0;
     for (auto inst : insts)
       for (auto result : inst.getResults())
@@ -949,8 +1050,10 @@ void ExtractInstancesPass::groupInstances() {
     portIdx = 0;
     builder.setInsertionPointToStart(wrapper.getBodyBlock());
     for (auto inst : insts) {
+      instanceGraph->eraseInstance(inst);
       inst->remove();
       builder.insert(inst);
+      instanceGraph->addInstance(inst);
       for (auto result : inst.getResults()) {
         Value dst = result;
         Value src = wrapper.getArgument(portIdx);
@@ -0,0 +1,162 @@
+//===- ExtractPartition.cpp - Extract a partition of a circuit --*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the ExtractPartition pass, which reduces a circuit to the
+// part of the instance hierarchy that is compiled by one process when a large
+// design is compiled as multiple independent partitions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetails.h"
+#include "circt/Dialect/FIRRTL/FIRRTLAnnotations.h"
+#include "circt/Dialect/FIRRTL/FIRRTLOps.h"
+#include "circt/Dialect/FIRRTL/Passes.h"
+#include "circt/Dialect/HW/HWAttributes.h"
+#include "circt/Support/LLVM.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "firrtl-extract-partition"
+
+using namespace circt;
+using namespace firrtl;
+
+namespace {
+struct ExtractPartitionPass
+    : public ExtractPartitionBase<ExtractPartitionPass> {
+  ExtractPartitionPass(StringRef rootName,
+                       ArrayRef<std::string> blackBoxNames) {
+    root = rootName.str();
+    blackBoxes = blackBoxNames;
+  }
+  void runOnOperation() override;
+};
+} // namespace
+
+/// Replace a module compiled by another partition with an extmodule that has
+/// the same ports.
+static void replaceWithBlackBox(FModuleOp module, SymbolTable &symbolTable) {
+  // The annotations of the module are handled by the partition that compiles
+  // its body, so drop them.
+  SmallVector<PortInfo> ports = module.getPorts();
+  for (auto &port : ports)
+    port.annotations = AnnotationSet(module.getContext());
+
+  OpBuilder builder(module);
+  auto extModule = builder.create<FExtModuleOp>(
+      module.getLoc(), module.getNameAttr(), ports, module.getName());
+  extModule.setVisibility(module.getVisibility());
+  symbolTable.erase(module);
+  symbolTable.insert(extModule);
+}
+
+void ExtractPartitionPass::runOnOperation() {
+  CircuitOp circuit = getOperation();
+  SymbolTable &symbolTable = getAnalysis<SymbolTable>();
+
+  // Find the top of the partition.
+  FModuleLike rootModule = root.empty()
+                               ? circuit.getMainModule(&symbolTable)
+                               : symbolTable.lookup<FModuleLike>(root);
+  if (!rootModule) {
+    circuit.emitError("partition root module '") << root << "' not found";
+    return signalPassFailure();
+  }
+
+  // Replace the modules compiled in other partitions with black boxes.
+  DenseSet<StringAttr> blackBoxNames;
+  for (auto &name : blackBoxes) {
+    auto module = symbolTable.lookup<FModuleLike>(name);
+    if (!module) {
+      circuit.emitError("partition black box module '") << name
+                                                        << "' not found";
+      return signalPassFailure();
+    }
+    if (module == rootModule) {
+      module.emitError("partition root cannot be a black box");
+      return signalPassFailure();
+    }
+    blackBoxNames.insert(module.moduleNameAttr());
+    if (auto fmodule = dyn_cast<FModuleOp>(*module))
+      replaceWithBlackBox(fmodule, symbolTable);
+  }
+
+  // Collect the modules instantiated underneath the root.
+  DenseSet<StringAttr> keptModules;
+  SmallVector<FModuleLike> worklist;
+  keptModules.insert(rootModule.moduleNameAttr());
+  worklist.push_back(rootModule);
+  while (!worklist.empty()) {
+    auto module = worklist.pop_back_val();
+    module->walk([&](InstanceOp inst) {
+      auto moduleName = inst.getModuleNameAttr().getAttr();
+      if (!keptModules.insert(moduleName).second)
+        return;
+      if (auto child = symbolTable.lookup<FModuleLike>(moduleName))
+        worklist.push_back(child);
+    });
+  }
+
+  // Drop the modules outside the partition, and the hierarchical paths which
+  // leave the partition or reach into the body of a black box.
+  DenseSet<StringAttr> droppedPaths;
+  for (auto &op : llvm::make_early_inc_range(*circuit.getBodyBlock())) {
+    if (auto module = dyn_cast<FModuleLike>(op)) {
+      if (!keptModules.contains(module.moduleNameAttr())) {
+        LLVM_DEBUG(llvm::dbgs() << "Dropping module " << module.moduleName()
+                                << "\n");
+        symbolTable.erase(module);
+      }
+      continue;
+    }
+    auto path = dyn_cast<HierPathOp>(op);
+    if (!path)
+      continue;
+    bool outside = llvm::any_of(path.getNamepath(), [&](Attribute attr) {
+      if (auto innerRef = attr.dyn_cast<hw::InnerRefAttr>())
+        return !keptModules.contains(innerRef.getModule()) ||
+               blackBoxNames.contains(innerRef.getModule());
+      return !keptModules.contains(attr.cast<FlatSymbolRefAttr>().getAttr());
+    });
+    if (outside) {
+      droppedPaths.insert(path.getSymNameAttr());
+      symbolTable.erase(path);
+    }
+  }
+
+  // Drop the non-local annotations using the dropped paths.
+  if (!droppedPaths.empty()) {
+    auto usesDroppedPath = [&](Annotation anno) {
+      auto path = anno.getMember<FlatSymbolRefAttr>("circt.nonlocal");
+      return path && droppedPaths.contains(path.getAttr());
+    };
+    for (auto &op : *circuit.getBodyBlock()) {
+      if (!isa<FModuleLike>(op))
+        continue;
+      AnnotationSet::removePortAnnotations(&op, [&](unsigned, Annotation anno) {
+        return usesDroppedPath(anno);
+      });
+      op.walk([&](Operation *op) {
+        AnnotationSet::removeAnnotations(op, usesDroppedPath);
+      });
+    }
+  }
+
+  // Make the root the main module of the circuit.
+  circuit.setNameAttr(rootModule.moduleNameAttr());
+  SymbolTable::setSymbolVisibility(rootModule.getOperation(),
+                                   SymbolTable::Visibility::Public);
+
+  markAnalysesPreserved<SymbolTable>();
+}
+
+std::unique_ptr<mlir::Pass>
+circt::firrtl::createExtractPartitionPass(StringRef root,
+                                          ArrayRef<std::string> blackBoxes) {
+  return std::make_unique<ExtractPartitionPass>(root, blackBoxes);
+}
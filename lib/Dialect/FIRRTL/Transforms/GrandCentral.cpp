@@ -23,7 +23,9 @@
 #include "circt/Dialect/HW/HWOps.h"
 #include "circt/Dialect/SV/SVOps.h"
 #include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/IR/Threading.h"
 #include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/YAMLTraits.h"
@@ -599,18 +601,42 @@ private:
   /// (generate XMRs) for this interface.  This does not build new interfaces.
   bool traverseField(Attribute field, IntegerAttr id, VerbatimBuilder &path);
 
+  /// State of a single view while its interfaces are being built.  Views are
+  /// built concurrently, so anything that must be serialized (naming,
+  /// insertion into the circuit) is decided before or after the build.
+  struct ViewState {
+    /// Interface names reserved for this view, in the order that
+    /// `traverseBundle` will consume them.
+    SmallVector<StringAttr> interfaceNames;
+    unsigned nextName = 0;
+
+    /// True if the companion is instantiated outside the DUT.
+    bool inTestHarness = false;
+
+    /// Interfaces built for this view, in creation order.  These are not
+    /// inserted into the circuit until all views are built.
+    SmallVector<sv::InterfaceOp> interfaces;
+  };
+
+  /// Reserve circuit-namespace names for every interface which
+  /// `traverseBundle` will create for this bundle, in creation order.
+  void reserveInterfaceNames(AugmentedBundleTypeAttr bundle, StringAttr prefix,
+                             ViewState &view);
+
   /// Recursively examine an AugmentedType to both build new interfaces and
   /// populate a "mappings" file (generate XMRs) using `traverseField`.  Return
   /// the type of the field exmained.
   Optional<TypeSum> computeField(Attribute field, IntegerAttr id,
-                                 StringAttr prefix, VerbatimBuilder &path);
+                                 StringAttr prefix, VerbatimBuilder &path,
+                                 ViewState &view);
 
   /// Recursively examine an AugmentedBundleType to both build new interfaces
   /// and populate a "mappings" file (generate XMRs).  Return none if the
   /// interface is invalid.
   Optional<sv::InterfaceOp> traverseBundle(AugmentedBundleTypeAttr bundle,
                                            IntegerAttr id, StringAttr prefix,
-                                           VerbatimBuilder &path);
+                                           VerbatimBuilder &path,
+                                           ViewState &view);
 
   /// Return the module associated with this value.
   HWModuleLike getEnclosingModule(Value value, FlatSymbolRefAttr sym = {});
@@ -1054,19 +1080,18 @@ static Optional<DictionaryAttr> parseAugmentedType(
       // Move the target to the InstanceOp for the extern module.
       auto portNo = xmrSrcTarget->ref.getImpl().getPortNo();
       if (xmrSrcTarget->instances.empty()) {
-        auto paths =
-            state.instancePathCache.getAbsolutePaths(xmrSrcTarget->ref.getOp());
+        auto paths = state.instancePathCache.getCompactAbsolutePaths(
+            xmrSrcTarget->ref.getOp());
         if (paths.size() > 1) {
           extMod.emitError("cannot resolve a unique instance path from the "
                            "external module '")
               << targetAttr << "'";
           return None;
         }
-        auto *it = xmrSrcTarget->instances.begin();
-        for (auto inst : paths.back()) {
-          xmrSrcTarget->instances.insert(it, cast<InstanceOp>(inst));
-          ++it;
-        }
+        SmallVector<hw::HWInstanceLike, 8> path;
+        paths.back().toVector(path);
+        for (auto inst : path)
+          xmrSrcTarget->instances.push_back(cast<InstanceOp>(inst));
       }
       auto lastInst = xmrSrcTarget->instances.pop_back_val();
       auto builder = ImplicitLocOpBuilder::atBlockEnd(lastInst.getLoc(),
@@ -1436,10 +1461,42 @@ bool GrandCentralPass::traverseField(Attribute field, IntegerAttr id,
       .Default([](auto a) { return true; });
 }
 
+/// Mirror the recursion of `traverseBundle` and `computeField` without
+/// building anything.  Only bundles create interfaces, and only the first
+/// element of a vector is examined for its type.
+void GrandCentralPass::reserveInterfaceNames(AugmentedBundleTypeAttr bundle,
+                                             StringAttr prefix,
+                                             ViewState &view) {
+  view.interfaceNames.push_back(StringAttr::get(
+      &getContext(), getNamespace().newName(getInterfaceName(prefix, bundle))));
+  for (auto element : bundle.getElements()) {
+    auto dict = element.dyn_cast<DictionaryAttr>();
+    while (dict) {
+      auto clazz = dict.getAs<StringAttr>("class");
+      if (!clazz)
+        break;
+      auto classBase = clazz.getValue();
+      classBase.consume_front("sifive.enterprise.grandcentral.Augmented");
+      auto elements = dict.getAs<ArrayAttr>("elements");
+      if (classBase == "VectorType" && dict.getAs<StringAttr>("name") &&
+          elements && !elements.empty()) {
+        dict = elements[0].dyn_cast<DictionaryAttr>();
+        continue;
+      }
+      if (classBase == "BundleType" && dict.getAs<StringAttr>("defName") &&
+          elements)
+        reserveInterfaceNames(AugmentedBundleTypeAttr::get(&getContext(), dict),
+                              prefix, view);
+      break;
+    }
+  }
+}
+
 Optional<TypeSum> GrandCentralPass::computeField(Attribute field,
                                                  IntegerAttr id,
                                                  StringAttr prefix,
-                                                 VerbatimBuilder &path) {
+                                                 VerbatimBuilder &path,
+                                                 ViewState &view) {
 
   auto unsupported = [&](StringRef name, StringRef kind) {
     return VerbatimType({("// <unsupported " + kind + " type>").str(), false});
@@ -1473,7 +1530,8 @@ Optional<TypeSum> GrandCentralPass::computeField(Attribute field,
             auto firstElement = fromAttr(elements[0]);
             auto elementType =
                 computeField(firstElement.value(), id, prefix,
-                             path.snapshot().append("[" + Twine(0) + "]"));
+                             path.snapshot().append("[" + Twine(0) + "]"),
+                             view);
             if (!elementType)
               return None;
 
@@ -1494,7 +1552,7 @@ Optional<TypeSum> GrandCentralPass::computeField(Attribute field,
           })
       .Case<AugmentedBundleTypeAttr>(
           [&](AugmentedBundleTypeAttr bundle) -> TypeSum {
-            auto iface = traverseBundle(bundle, id, prefix, path);
+            auto iface = traverseBundle(bundle, id, prefix, path, view);
             assert(iface && *iface);
             (void)iface;
             return VerbatimType({iface->getNameAttr().str(), true});
@@ -1527,18 +1585,19 @@ Optional<TypeSum> GrandCentralPass::computeField(Attribute field,
 /// drive the interface. Returns false on any failure and true on success.
 Optional<sv::InterfaceOp>
 GrandCentralPass::traverseBundle(AugmentedBundleTypeAttr bundle, IntegerAttr id,
-                                 StringAttr prefix, VerbatimBuilder &path) {
-  auto builder = OpBuilder::atBlockEnd(getOperation().getBodyBlock());
-  sv::InterfaceOp iface;
-  builder.setInsertionPointToEnd(getOperation().getBodyBlock());
+                                 StringAttr prefix, VerbatimBuilder &path,
+                                 ViewState &view) {
+  // The interface is built detached from the circuit and inserted once all
+  // views are done.
+  OpBuilder builder(&getContext());
   auto loc = getOperation().getLoc();
-  auto iFaceName = getNamespace().newName(getInterfaceName(prefix, bundle));
-  iface = builder.create<sv::InterfaceOp>(loc, iFaceName);
+  assert(view.nextName < view.interfaceNames.size() &&
+         "interface name was not reserved");
+  auto iFaceName = view.interfaceNames[view.nextName++];
+  auto iface = builder.create<sv::InterfaceOp>(loc, iFaceName.getValue());
+  view.interfaces.push_back(iface);
   ++numInterfaces;
-  if (dut &&
-      !instancePaths->instanceGraph.isAncestor(companionIDMap[id].companion,
-                                               cast<hw::HWModuleLike>(*dut)) &&
-      testbenchDir)
+  if (view.inTestHarness && testbenchDir)
     iface->setAttr("output_file", hw::OutputFileAttr::getAsDirectory(
                                       &getContext(), testbenchDir.getValue(),
                                       /*excludeFromFileList=*/true));
@@ -1568,7 +1627,7 @@ GrandCentralPass::traverseBundle(AugmentedBundleTypeAttr bundle, IntegerAttr id,
     // naming conflicts).
     auto elementType =
         computeField(*field, id, prefix,
-                     path.snapshot().append(".").append(name.getValue()));
+                     path.snapshot().append(".").append(name.getValue()), view);
     if (!elementType)
       return None;
 
@@ -1614,7 +1673,6 @@ GrandCentralPass::traverseBundle(AugmentedBundleTypeAttr bundle, IntegerAttr id,
     builder.create<sv::InterfaceSignalOp>(uloc, name.getValue(), tpe);
   }
 
-  interfaceMap[FlatSymbolRefAttr::get(builder.getContext(), iFaceName)] = iface;
   return iface;
 }
 
@@ -2188,8 +2246,25 @@ void GrandCentralPass::runOnOperation() {
   // will use XMRs to drive the interface.  If extraction info is available,
   // then the top-level instantiate interface will be marked for extraction via
   // a SystemVerilog bind.
-  SmallVector<sv::InterfaceOp, 2> interfaceVec;
-  for (auto anno : worklist) {
+  //
+  // Views are built in three phases.  First, each view is validated and every
+  // name it needs from the circuit namespace is reserved, in worklist order.
+  // Second, the views are built in parallel.  Views which share a companion
+  // are built serially by the same task as they all write into the companion
+  // body.  Third, the built interfaces are inserted into the circuit and
+  // instantiated in their companions, again in worklist order.  Diagnostics
+  // are ordered by view so that the output is deterministic.
+  struct View {
+    AugmentedBundleTypeAttr bundle;
+    FModuleOp companion;
+    StringAttr symbolName;
+    ViewState state;
+    Optional<sv::InterfaceOp> iface;
+  };
+  SmallVector<View> views;
+  mlir::ParallelDiagnosticHandler diagHandler(&getContext());
+  for (auto [index, anno] : llvm::enumerate(worklist)) {
+    diagHandler.setOrderIDForThread(index);
     auto bundle = AugmentedBundleTypeAttr::get(&getContext(), anno.getDict());
 
     // The top-level AugmentedBundleType must have a global ID field so that
@@ -2217,49 +2292,70 @@ void GrandCentralPass::runOnOperation() {
 
     // Decide on a symbol name to use for the interface instance. This is needed
     // in `traverseBundle` as a placeholder for the connect operations.
-    auto companionModule = companionIDMap.lookup(bundle.getID()).companion;
-    auto symbolName = getNamespace().newName(
-        "__" + companionIDMap.lookup(bundle.getID()).name + "_" +
-        getInterfaceName(bundle.getPrefix(), bundle) + "__");
-
-    // Recursively walk the AugmentedBundleType to generate interfaces and XMRs.
-    // Error out if this returns None (indicating that the annotation is
-    // malformed in some way).  A good error message is generated inside
-    // `traverseBundle` or the functions it calls.
-    auto instanceSymbol =
-        hw::InnerRefAttr::get(SymbolTable::getSymbolName(companionModule),
-                              StringAttr::get(&getContext(), symbolName));
-    VerbatimBuilder::Base verbatimData;
-    VerbatimBuilder verbatim(verbatimData);
-    verbatim += instanceSymbol;
-    auto iface =
-        traverseBundle(bundle, bundle.getID(), bundle.getPrefix(), verbatim);
-    if (!iface) {
+    auto &view = views.emplace_back();
+    view.bundle = bundle;
+    view.companion = companionIDMap.lookup(bundle.getID()).companion;
+    view.symbolName = StringAttr::get(
+        &getContext(),
+        getNamespace().newName(
+            "__" + companionIDMap.lookup(bundle.getID()).name + "_" +
+            getInterfaceName(bundle.getPrefix(), bundle) + "__"));
+    view.state.inTestHarness =
+        dut && !instancePaths->instanceGraph.isAncestor(
+                   view.companion, cast<hw::HWModuleLike>(*dut));
+    reserveInterfaceNames(bundle, bundle.getPrefix(), view.state);
+  }
+  diagHandler.eraseOrderIDForThread();
+
+  // Group views by companion, preserving worklist order within each group.
+  // Construct the lazily-built symbol table up front as it is used while
+  // building views.
+  (void)getSymbolTable();
+  llvm::MapVector<FModuleOp, SmallVector<unsigned>> companionViews;
+  for (auto [index, view] : llvm::enumerate(views))
+    companionViews[view.companion].push_back(index);
+  auto groups = companionViews.takeVector();
+
+  // Recursively walk each AugmentedBundleType to generate interfaces and XMRs.
+  // A view fails if this returns None (indicating that the annotation is
+  // malformed in some way).  A good error message is generated inside
+  // `traverseBundle` or the functions it calls.
+  mlir::parallelForEach(&getContext(), groups, [&](auto &group) {
+    for (auto index : group.second) {
+      auto &view = views[index];
+      diagHandler.setOrderIDForThread(index);
+      auto instanceSymbol = hw::InnerRefAttr::get(
+          SymbolTable::getSymbolName(view.companion), view.symbolName);
+      VerbatimBuilder::Base verbatimData;
+      VerbatimBuilder verbatim(verbatimData);
+      verbatim += instanceSymbol;
+      view.iface = traverseBundle(view.bundle, view.bundle.getID(),
+                                  view.bundle.getPrefix(), verbatim,
+                                  view.state);
+      diagHandler.eraseOrderIDForThread();
+    }
+  });
+
+  SmallVector<sv::InterfaceOp, 2> interfaceVec;
+  auto *circuitBody = circuitOp.getBodyBlock();
+  for (auto &view : views) {
+    for (auto iface : view.state.interfaces) {
+      circuitBody->push_back(iface);
+      interfaceMap[FlatSymbolRefAttr::get(iface.getSymNameAttr())] = iface;
+    }
+    if (!view.iface) {
       removalError = true;
       continue;
     }
     ++numViews;
 
-    interfaceVec.push_back(*iface);
+    interfaceVec.push_back(*view.iface);
 
     // Instantiate the interface inside the parent.
-    builder.setInsertionPointToStart(companionModule.getBodyBlock());
+    builder.setInsertionPointToStart(view.companion.getBodyBlock());
     builder.create<sv::InterfaceInstanceOp>(
-        getOperation().getLoc(), iface->getInterfaceType(),
-        companionIDMap.lookup(bundle.getID()).name,
-        builder.getStringAttr(symbolName));
-
-    // If no extraction information was present, then just leave the interface
-    // instantiated in the parent.  Otherwise, make it a bind.
-    if (!maybeExtractInfo)
-      continue;
-
-    // If the interface is associated with a companion that is instantiated
-    // above the DUT (e.g.., in the test harness), then don't extract it.
-    if (dut && !instancePaths->instanceGraph.isAncestor(
-                   companionIDMap[bundle.getID()].companion,
-                   cast<hw::HWModuleLike>(*dut)))
-      continue;
+        getOperation().getLoc(), view.iface->getInterfaceType(),
+        companionIDMap.lookup(view.bundle.getID()).name, view.symbolName);
   }
 
   // If a `GrandCentralHierarchyFileAnnotation` was passed in, generate a YAML
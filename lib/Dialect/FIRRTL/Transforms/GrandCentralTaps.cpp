@@ -27,6 +27,7 @@
 #include "circt/Dialect/HW/InstanceGraphBase.h"
 #include "circt/Dialect/SV/SVOps.h"
 #include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/IR/Threading.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/TinyPtrVector.h"
@@ -1096,7 +1097,7 @@ void GrandCentralTapsPass::runOnOperation() {
   });
 
   // Process each black box independently.
-  for (auto blackBox : modules) {
+  for (auto &blackBox : modules) {
     LLVM_DEBUG(llvm::dbgs() << "Generating impls for "
                             << blackBox.extModule.getName() << "\n");
 
@@ -1140,19 +1141,64 @@ void GrandCentralTapsPass::runOnOperation() {
     // implementation for every data tap instance, and among the possible
     // targets for the data taps choose the one with the shortest relative
     // path to the data tap instance.
+    //
+    // The code tries to come up with a relative path from the data tap
+    // instance (path being the absolute path to that instance) to the tapped
+    // thing (prefix being the path to the tapped port, wire, or memory) by
+    // calling stripCommonPrefix(prefix, path).  If the tapped thing includes
+    // an NLA, then the NLA path is appended to the rest of the path before the
+    // common prefix stripping is done. The NLA path does not depend on the
+    // data tap instance, so append it to the prefixes of each port only once.
+    SmallVector<SmallVector<SmallVector<HWInstanceLike>>> prefixesWithNLA;
+    prefixesWithNLA.reserve(portWiring.size());
+    for (auto &port : portWiring) {
+      SmallVector<HWInstanceLike> nlaPath;
+      if (port.nla)
+        for (auto segment : port.nla.getNamepath().getValue().drop_back())
+          if (auto ref = segment.dyn_cast<InnerRefAttr>())
+            nlaPath.push_back(cast<HWInstanceLike>(innerRefNS.lookupOp(ref)));
+      auto &prefixes = prefixesWithNLA.emplace_back();
+      prefixes.reserve(port.prefices.size());
+      for (auto prefix : port.prefices) {
+        auto &prefixWithNLA =
+            prefixes.emplace_back(prefix.begin(), prefix.end());
+        prefixWithNLA.append(nlaPath.begin(), nlaPath.end());
+      }
+    }
+
+    // Determine the shortest hierarchical prefix from every black box instance
+    // to every tapped object. This only reads the instance paths computed
+    // above, so resolve all instances in parallel before any IR is created.
+    SmallVector<SmallVector<Optional<InstancePath>>> shortestPrefixes(
+        paths.size());
+    mlir::parallelFor(&getContext(), 0, paths.size(), [&](size_t pathIdx) {
+      auto path = paths[pathIdx];
+      auto &shortest = shortestPrefixes[pathIdx];
+      shortest.resize(portWiring.size());
+      for (size_t portIdx = 0, e = portWiring.size(); portIdx < e; ++portIdx) {
+        for (auto &prefix : prefixesWithNLA[portIdx]) {
+          auto relative = stripCommonPrefix(prefix, path);
+          if (!shortest[portIdx] ||
+              relative.size() < shortest[portIdx]->size())
+            shortest[portIdx] = relative;
+        }
+      }
+    });
+
+    // Get the list of ports from the original extmodule, and update the
+    // annotations such that they no longer contain any data/mem taps.
+    auto ports = blackBox.extModule.getPorts();
+    for (auto port : llvm::zip(ports, blackBox.filteredPortAnnos)) {
+      std::get<0>(port).annotations = std::get<1>(port);
+    }
+
     ImplicitLocOpBuilder builder(blackBox.extModule->getLoc(),
                                  blackBox.extModule);
     unsigned implIdx = 0;
-    for (auto path : paths) {
+    for (size_t pathIdx = 0, e = paths.size(); pathIdx < e; ++pathIdx) {
+      auto path = paths[pathIdx];
       builder.setInsertionPointAfter(blackBox.extModule);
 
-      // Get the list of ports from the original extmodule, and update the
-      // annotations such that they no longer contain any data/mem taps.
-      auto ports = blackBox.extModule.getPorts();
-      for (auto port : llvm::zip(ports, blackBox.filteredPortAnnos)) {
-        std::get<0>(port).annotations = std::get<1>(port);
-      }
-
       // Create a new firrtl.module that implements the data tap.
       auto name =
           StringAttr::get(&getContext(), Twine(blackBox.extModule.getName()) +
@@ -1178,7 +1224,8 @@ void GrandCentralTapsPass::runOnOperation() {
       builder.setInsertionPointToEnd(impl.getBodyBlock());
 
       // Connect the output ports to the appropriate tapped object.
-      for (auto port : portWiring) {
+      for (size_t portIdx = 0, e = portWiring.size(); portIdx < e; ++portIdx) {
+        auto &port = portWiring[portIdx];
         LLVM_DEBUG(llvm::dbgs() << "- Wiring up port " << port.portNum << "\n");
 
         // Ignore the port if it is marked for deletion.
@@ -1197,33 +1244,9 @@ void GrandCentralTapsPass::runOnOperation() {
           builder.create<ConnectOp>(arg, literal);
           continue;
         }
-        // The code tries to come up with a relative path from the data tap
-        // instance (path being the absolute path to that instance) to the
-        // tapped thing (prefix being the path to the tapped port, wire, or
-        // memory) by calling stripCommonPrefix(prefix, path).  If the tapped
-        // thing includes an NLA, then the NLA path is appended to the rest of
-        // the path before the common prefix stripping is done.
-
-        // Determine the shortest hierarchical prefix from this black box
-        // instance to the tapped object.
-        Optional<SmallVector<HWInstanceLike>> shortestPrefix;
-        for (auto prefix : port.prefices) {
-
-          // Append the NLA path to the instance graph-determined path.
-          SmallVector<HWInstanceLike> prefixWithNLA(prefix.begin(),
-                                                    prefix.end());
-          if (port.nla) {
-            for (auto segment : port.nla.getNamepath().getValue().drop_back())
-              if (auto ref = segment.dyn_cast<InnerRefAttr>()) {
-                prefixWithNLA.push_back(
-                    cast<HWInstanceLike>(innerRefNS.lookupOp(ref)));
-              }
-          }
-
-          auto relative = stripCommonPrefix(prefixWithNLA, path);
-          if (!shortestPrefix || relative.size() < shortestPrefix->size())
-            shortestPrefix.emplace(relative.begin(), relative.end());
-        }
+        // Use the shortest hierarchical prefix from this black box instance to
+        // the tapped object determined above.
+        auto shortestPrefix = shortestPrefixes[pathIdx][portIdx];
         if (!shortestPrefix) {
           LLVM_DEBUG(llvm::dbgs() << "  - Has no prefix, skipping\n");
           continue;
@@ -1280,7 +1303,7 @@ void GrandCentralTapsPass::runOnOperation() {
                 unsigned index = vector.getIndexForFieldID(fieldID);
                 tpe = vector.getElementType();
                 fieldID -= vector.getFieldID(index);
-                hname += ("[" + Twine(index) + "]").str();
+                ("[" + Twine(index) + "]").toVector(hname);
               })
               .template Case<BundleType>([&](BundleType bundle) {
                 unsigned index = bundle.getIndexForFieldID(fieldID);
@@ -1291,7 +1314,8 @@ void GrandCentralTapsPass::runOnOperation() {
                 // might become invalid. We can use an inner name ref to encode
                 // a reference to a subfield.
 
-                hname += "." + bundle.getElement(index).name.getValue().str();
+                hname += '.';
+                hname += bundle.getElement(index).name.getValue();
               })
               .Default([&](auto) {
                 blackBox.extModule.emitError()
@@ -20,7 +20,6 @@
 #include "circt/Support/APInt.h"
 #include "mlir/IR/Threading.h"
 #include "llvm/ADT/APSInt.h"
-#include "llvm/ADT/TinyPtrVector.h"
 
 using namespace circt;
 using namespace firrtl;
@@ -30,9 +29,28 @@ static bool isWireOrReg(Operation *op) {
   return isa<WireOp, RegResetOp, RegOp>(op);
 }
 
-/// Return true if this is an aggregate indexer.
-static bool isAggregate(Operation *op) {
-  return isa<SubindexOp, SubaccessOp, SubfieldOp>(op);
+/// Call `fn` with the field ID, the type and the flip of every ground field of
+/// the given type, relative to `fieldID`.  Non-aggregate types are a single
+/// field with ID 0.
+static void
+walkGroundFields(Type type, llvm::function_ref<void(unsigned, Type, bool)> fn,
+                 unsigned fieldID = 0, bool isFlip = false) {
+  if (auto refType = type.dyn_cast<RefType>())
+    type = refType.getType();
+  if (auto bundle = type.dyn_cast<BundleType>()) {
+    for (auto element : llvm::enumerate(bundle.getElements()))
+      walkGroundFields(element.value().type, fn,
+                       fieldID + bundle.getFieldID(element.index()),
+                       isFlip != element.value().isFlip);
+    return;
+  }
+  if (auto vector = type.dyn_cast<FVectorType>()) {
+    for (size_t i = 0, e = vector.getNumElements(); i != e; ++i)
+      walkGroundFields(vector.getElementType(), fn,
+                       fieldID + vector.getFieldID(i), isFlip);
+    return;
+  }
+  fn(fieldID, type, isFlip);
 }
 
 /// Return true if this is a wire or register we're allowed to delete.
@@ -186,49 +204,100 @@ static llvm::raw_ostream &operator<<(llvm::raw_ostream &os,
 }
 
 namespace {
-struct IMConstPropPass : public IMConstPropBase<IMConstPropPass> {
-  void runOnOperation() override;
-  void rewriteModuleBody(FModuleOp module);
+struct ModuleState;
+
+/// The lattice updates one module sends to the other modules while it is being
+/// solved. These are only delivered once every module of the current round has
+/// reached its local fixpoint.
+struct Outbox {
+  /// Modules which have been instantiated in a live block.
+  SmallVector<ModuleState *, 0> executable;
+  /// Lattice values to merge into fields owned by other modules.
+  SmallVector<std::tuple<ModuleState *, FieldRef, LatticeValue>, 0> merges;
+  /// Instance results which have to follow the value of an output port.
+  SmallVector<std::tuple<ModuleState *, BlockArgument, Value, ModuleState *>, 0>
+      subscriptions;
+
+  bool empty() const {
+    return executable.empty() && merges.empty() && subscriptions.empty();
+  }
+};
+
+/// The dataflow state of a single module. Each module is solved on its own,
+/// in parallel with the others, and only exchanges lattice values with the
+/// other modules through its inbox and outbox at the ports of its instances.
+///
+/// Lattice values are tracked for the ground fields of the values, identified
+/// by a FieldRef into the root value they are part of. Subfield and subindex
+/// operations do not have lattice values of their own, but refer to the fields
+/// of their root, such that aggregates are propagated without being lowered.
+struct ModuleState {
+  ModuleState(FModuleOp module, InstanceGraph &instanceGraph,
+              const DenseMap<Operation *, ModuleState *> &moduleStates)
+      : module(module), instanceGraph(instanceGraph),
+        moduleStates(moduleStates) {}
+
+  /// Returns true if this module has work left to do in the next round.
+  bool hasPendingWork() const {
+    return markExecutableRequested || !incomingMerges.empty() ||
+           !incomingSubscriptions.empty();
+  }
+
+  /// Apply the updates in the inbox and run the worklist to the local
+  /// fixpoint, collecting any updates for other modules in the outbox.
+  void solve();
+
+  /// Returns true if the body of the module is known to execute.
+  bool isExecutable() const { return executable; }
 
   /// Returns true if the given block is executable.
   bool isBlockExecutable(Block *block) const {
-    return executableBlocks.count(block);
+    return executable && block == module.getBodyBlock();
   }
 
-  bool isOverdefined(Value value) const {
-    auto it = latticeValues.find(value);
+  bool isOverdefined(FieldRef fieldRef) const {
+    auto it = latticeValues.find(fieldRef);
     return it != latticeValues.end() && it->second.isOverdefined();
   }
 
-  /// Mark the given value as overdefined. This means that we cannot refine a
-  /// specific constant for this value.
-  void markOverdefined(Value value) {
-    auto &entry = latticeValues[value];
+  /// Mark the given field as overdefined. This means that we cannot refine a
+  /// specific constant for this field.
+  void markOverdefined(FieldRef fieldRef) {
+    auto &entry = latticeValues[fieldRef];
     if (!entry.isOverdefined()) {
       entry.markOverdefined();
-      changedLatticeValueWorklist.push_back(value);
+      changedLatticeValueWorklist.push_back(fieldRef);
     }
   }
 
-  /// Merge information from the 'from' lattice value into value.  If it
-  /// changes, then users of the value are added to the worklist for
+  /// Mark every ground field of the given value as overdefined.
+  void markOverdefined(Value value) {
+    auto fieldRef = getFieldRefFromValue(value);
+    walkGroundFields(value.getType(), [&](unsigned fieldID, Type, bool) {
+      markOverdefined(fieldRef.getSubField(fieldID));
+    });
+  }
+
+  /// Merge information from the 'from' lattice value into the field.  If it
+  /// changes, then users of the field are added to the worklist for
   /// revisitation.
-  void mergeLatticeValue(Value value, LatticeValue &valueEntry,
+  void mergeLatticeValue(FieldRef fieldRef, LatticeValue &valueEntry,
                          LatticeValue source) {
+    auto value = fieldRef.getValue();
     if (!source.isOverdefined() &&
         (!isa_and_nonnull<InstanceOp>(value.getDefiningOp()) &&
          hasDontTouch(value)))
       source = LatticeValue::getOverdefined();
     if (valueEntry.mergeIn(source))
-      changedLatticeValueWorklist.push_back(value);
+      changedLatticeValueWorklist.push_back(fieldRef);
   }
-  void mergeLatticeValue(Value value, LatticeValue source) {
+  void mergeLatticeValue(FieldRef fieldRef, LatticeValue source) {
     // Don't even do a map lookup if from has no info in it.
     if (source.isUnknown())
       return;
-    mergeLatticeValue(value, latticeValues[value], source);
+    mergeLatticeValue(fieldRef, latticeValues[fieldRef], source);
   }
-  void mergeLatticeValue(Value result, Value from) {
+  void mergeLatticeValue(FieldRef result, FieldRef from) {
     // If 'from' hasn't been computed yet, then it is unknown, don't do
     // anything.
     auto it = latticeValues.find(from);
@@ -237,36 +306,48 @@ struct IMConstPropPass : public IMConstPropBase<IMConstPropPass> {
     mergeLatticeValue(result, it->second);
   }
 
+  /// Merge every ground field of 'from' into the same field of 'result'.
+  void mergeLatticeValue(Value result, Value from) {
+    auto resultRef = getFieldRefFromValue(result);
+    auto fromRef = getFieldRefFromValue(from);
+    walkGroundFields(result.getType(), [&](unsigned fieldID, Type, bool) {
+      mergeLatticeValue(resultRef.getSubField(fieldID),
+                        fromRef.getSubField(fieldID));
+    });
+  }
+
   /// setLatticeValue - This is used when a new LatticeValue is computed for
   /// the result of the specified value that replaces any previous knowledge,
   /// e.g. because a fold() function on an op returned a new thing.  This should
   /// not be used on operations that have multiple contributors to it, e.g.
   /// wires or ports.
-  void setLatticeValue(Value value, LatticeValue source) {
+  void setLatticeValue(FieldRef fieldRef, LatticeValue source) {
     // Don't even do a map lookup if from has no info in it.
     if (source.isUnknown())
       return;
 
+    auto value = fieldRef.getValue();
     if (!source.isOverdefined() &&
         (!isa_and_nonnull<InstanceOp>(value.getDefiningOp()) &&
          hasDontTouch(value)))
       source = LatticeValue::getOverdefined();
     // If we've changed this value then revisit all the users.
-    auto &valueEntry = latticeValues[value];
+    auto &valueEntry = latticeValues[fieldRef];
     if (valueEntry != source) {
-      changedLatticeValueWorklist.push_back(value);
+      changedLatticeValueWorklist.push_back(fieldRef);
       valueEntry = source;
     }
   }
 
-  /// Return the lattice value for the specified SSA value, extended to the
-  /// width of the specified destType.  If allowTruncation is true, then this
-  /// allows truncating the lattice value to the specified type.
-  LatticeValue getExtendedLatticeValue(Value value, FIRRTLBaseType destType,
+  /// Return the lattice value for the specified field, extended to the width
+  /// of the specified destType.  If allowTruncation is true, then this allows
+  /// truncating the lattice value to the specified type.
+  LatticeValue getExtendedLatticeValue(FieldRef fieldRef,
+                                       FIRRTLBaseType destType,
                                        bool allowTruncation = false);
 
-  /// Mark the given block as executable.
-  void markBlockExecutable(Block *block);
+  /// Mark the body of the module as executable.
+  void markBlockExecutable();
   void markWireRegOp(Operation *wireOrReg);
   void markMemOp(MemOp mem);
 
@@ -275,77 +356,211 @@ struct IMConstPropPass : public IMConstPropBase<IMConstPropPass> {
   void markSpecialConstantOp(SpecialConstantOp specialConstant);
   void markInstanceOp(InstanceOp instance);
 
+  /// Drive the field `dest` with `value`, where `dest` is the destination of
+  /// `connect`.
+  void driveField(FieldRef dest, LatticeValue value, FConnectLike connect);
+
   void visitConnectLike(FConnectLike connect);
   void visitRegResetOp(RegResetOp regReset);
   void visitRefSend(RefSendOp send);
   void visitRefResolve(RefResolveOp resolve);
   void visitOperation(Operation *op);
 
-private:
+  /// Visit the users of every value referring to the given field: the root
+  /// value itself, and the subfields and subindices leading to the field.
+  void visitUsers(FieldRef fieldRef);
+
+  /// The module this state belongs to.
+  FModuleOp module;
+
   /// This is the current instance graph for the Circuit.
-  InstanceGraph *instanceGraph = nullptr;
+  InstanceGraph &instanceGraph;
 
-  /// This keeps track of the current state of each tracked value.
-  DenseMap<Value, LatticeValue> latticeValues;
+  /// The state of every module in the circuit, used to address messages.
+  const DenseMap<Operation *, ModuleState *> &moduleStates;
 
-  /// The set of blocks that are known to execute, or are intrinsically live.
-  SmallPtrSet<Block *, 16> executableBlocks;
+  /// This keeps track of the current state of each tracked field.
+  DenseMap<FieldRef, LatticeValue> latticeValues;
 
-  /// A worklist of values whose LatticeValue recently changed, indicating the
+  /// The subfield and subindex results referring to each field of an
+  /// aggregate.
+  DenseMap<FieldRef, SmallVector<Value, 1>> fieldValues;
+
+  /// True if the body of the module is known to execute.
+  bool executable = false;
+
+  /// A worklist of fields whose LatticeValue recently changed, indicating the
   /// users need to be reprocessed.
-  SmallVector<Value, 64> changedLatticeValueWorklist;
+  SmallVector<FieldRef, 64> changedLatticeValueWorklist;
 
-  /// This keeps track of users the instance results that correspond to output
-  /// ports.
-  DenseMap<BlockArgument, llvm::TinyPtrVector<Value>>
+  /// This keeps track of the instance results, and the modules owning them,
+  /// which correspond to the output ports of this module.
+  DenseMap<BlockArgument, SmallVector<std::pair<Value, ModuleState *>, 1>>
       resultPortToInstanceResultMapping;
+
+  /// The updates other modules sent to this one during the last exchange.
+  bool markExecutableRequested = false;
+  SmallVector<std::pair<FieldRef, LatticeValue>, 0> incomingMerges;
+  SmallVector<std::pair<BlockArgument, std::pair<Value, ModuleState *>>, 0>
+      incomingSubscriptions;
+
+  /// The updates this module sends to other modules in the next exchange.
+  Outbox outbox;
+};
+
+struct IMConstPropPass : public IMConstPropBase<IMConstPropPass> {
+  void runOnOperation() override;
+  void rewriteModuleBody(ModuleState &state);
 };
 } // end anonymous namespace
 
 // TODO: handle annotations: [[OptimizableExtModuleAnnotation]]
 void IMConstPropPass::runOnOperation() {
   auto circuit = getOperation();
+  auto *context = circuit.getContext();
 
-  instanceGraph = &getAnalysis<InstanceGraph>();
+  auto &instanceGraph = getAnalysis<InstanceGraph>();
 
-  // Mark the input ports of public modules as being overdefined.
+  // Create the state of every module up front, so that the module solvers can
+  // address each other without synchronization.
+  std::vector<std::unique_ptr<ModuleState>> states;
+  DenseMap<Operation *, ModuleState *> moduleStates;
   for (auto module : circuit.getBodyBlock()->getOps<FModuleOp>()) {
-    if (module.isPublic()) {
-      markBlockExecutable(module.getBodyBlock());
-      for (auto port : module.getBodyBlock()->getArguments())
-        markOverdefined(port);
+    states.push_back(
+        std::make_unique<ModuleState>(module, instanceGraph, moduleStates));
+    moduleStates[module] = states.back().get();
+  }
+
+  // Mark the input ports of public modules as being overdefined.
+  for (auto &state : states) {
+    if (state->module.isPublic()) {
+      state->markExecutableRequested = true;
+      for (auto port : state->module.getBodyBlock()->getArguments())
+        walkGroundFields(port.getType(), [&](unsigned fieldID, Type, bool) {
+          state->incomingMerges.push_back(
+              {FieldRef(port, fieldID), LatticeValue::getOverdefined()});
+        });
     }
   }
 
-  // If a value changed lattice state then reprocess any of its users.
-  while (!changedLatticeValueWorklist.empty()) {
-    Value changedVal = changedLatticeValueWorklist.pop_back_val();
-    for (Operation *user : changedVal.getUsers()) {
-      if (isBlockExecutable(user->getBlock()))
-        visitOperation(user);
+  // Solve every module with pending updates to its local fixpoint in parallel,
+  // then deliver the updates they produced for other modules. Repeat until no
+  // module has anything left to do.
+  SmallVector<ModuleState *, 0> active;
+  while (true) {
+    active.clear();
+    for (auto &state : states)
+      if (state->hasPendingWork())
+        active.push_back(state.get());
+    if (active.empty())
+      break;
+
+    mlir::parallelForEach(context, active,
+                          [&](ModuleState *state) { state->solve(); });
+
+    for (auto *state : active) {
+      auto &outbox = state->outbox;
+      for (auto *target : outbox.executable)
+        target->markExecutableRequested = true;
+      for (auto [target, fieldRef, lattice] : outbox.merges)
+        target->incomingMerges.push_back({fieldRef, lattice});
+      for (auto [target, port, result, owner] : outbox.subscriptions)
+        target->incomingSubscriptions.push_back({port, {result, owner}});
+      outbox = {};
     }
   }
 
   // Rewrite any constants in the modules.
-  mlir::parallelForEach(circuit.getContext(),
-                        circuit.getBodyBlock()->getOps<FModuleOp>(),
-                        [&](auto op) { rewriteModuleBody(op); });
-
-  // Clean up our state for next time.
-  instanceGraph = nullptr;
-  latticeValues.clear();
-  executableBlocks.clear();
-  resultPortToInstanceResultMapping.clear();
+  mlir::parallelForEach(context, states,
+                        [&](auto &state) { rewriteModuleBody(*state); });
+}
+
+/// Apply the updates other modules sent to this one and run the worklist to
+/// the local fixpoint. The module is only marked executable once, before the
+/// incoming lattice values are merged, mirroring the order in which a single
+/// global worklist would have processed them.
+void ModuleState::solve() {
+  if (markExecutableRequested) {
+    markExecutableRequested = false;
+    markBlockExecutable();
+  }
+
+  for (auto [fieldRef, lattice] : incomingMerges)
+    mergeLatticeValue(fieldRef, lattice);
+  incomingMerges.clear();
+
+  // Start forwarding the value of the output ports to new instance results.
+  for (auto &subscription : incomingSubscriptions) {
+    auto port = subscription.first;
+    auto &user = subscription.second;
+    resultPortToInstanceResultMapping[port].push_back(user);
+    walkGroundFields(port.getType(), [&](unsigned fieldID, Type, bool) {
+      auto it = latticeValues.find(FieldRef(port, fieldID));
+      if (it != latticeValues.end() && !it->second.isUnknown())
+        outbox.merges.push_back(
+            {user.second, FieldRef(user.first, fieldID), it->second});
+    });
+  }
+  incomingSubscriptions.clear();
+
+  // If a field changed lattice state then reprocess any of its users.
+  while (!changedLatticeValueWorklist.empty()) {
+    FieldRef changedField = changedLatticeValueWorklist.pop_back_val();
+
+    // Changes to an output port propagate to each instance of the module.
+    if (auto blockArg = changedField.getValue().dyn_cast<BlockArgument>()) {
+      auto it = resultPortToInstanceResultMapping.find(blockArg);
+      if (it != resultPortToInstanceResultMapping.end()) {
+        auto lattice = latticeValues.lookup(changedField);
+        for (auto [result, owner] : it->second)
+          outbox.merges.push_back(
+              {owner, FieldRef(result, changedField.getFieldID()), lattice});
+      }
+    }
+
+    visitUsers(changedField);
+  }
 }
 
-/// Return the lattice value for the specified SSA value, extended to the width
+void ModuleState::visitUsers(FieldRef fieldRef) {
+  auto visitUsersOf = [&](Value value) {
+    for (Operation *user : value.getUsers())
+      if (isBlockExecutable(user->getBlock()))
+        visitOperation(user);
+  };
+
+  auto root = fieldRef.getValue();
+  visitUsersOf(root);
+  if (fieldValues.empty())
+    return;
+
+  // Walk down the type of the root towards the field, visiting the users of
+  // the subelements taken at every level.
+  auto type = root.getType().dyn_cast<FIRRTLType>();
+  if (!type)
+    return;
+  auto baseType = getBaseType(type);
+  unsigned fieldID = fieldRef.getFieldID(), base = 0;
+  while (fieldID != 0) {
+    auto [subType, subFieldID] = baseType.getSubTypeByFieldID(fieldID);
+    base += fieldID - subFieldID;
+    fieldID = subFieldID;
+    baseType = subType;
+    auto it = fieldValues.find(FieldRef(root, base));
+    if (it != fieldValues.end())
+      for (auto value : it->second)
+        visitUsersOf(value);
+  }
+}
+
+/// Return the lattice value for the specified field, extended to the width
 /// of the specified destType.  If allowTruncation is true, then this allows
 /// truncating the lattice value to the specified type.
-LatticeValue IMConstPropPass::getExtendedLatticeValue(Value value,
-                                                      FIRRTLBaseType destType,
-                                                      bool allowTruncation) {
-  // If 'value' hasn't been computed yet, then it is unknown.
-  auto it = latticeValues.find(value);
+LatticeValue ModuleState::getExtendedLatticeValue(FieldRef fieldRef,
+                                                  FIRRTLBaseType destType,
+                                                  bool allowTruncation) {
+  // If 'fieldRef' hasn't been computed yet, then it is unknown.
+  auto it = latticeValues.find(fieldRef);
   if (it == latticeValues.end())
     return LatticeValue();
 
@@ -378,14 +593,20 @@ LatticeValue IMConstPropPass::getExtendedLatticeValue(Value value,
   return LatticeValue(IntegerAttr::get(destType.getContext(), resultConstant));
 }
 
-/// Mark a block executable if it isn't already.  This does an initial scan of
-/// the block, processing nullary operations like wires, instances, and
+/// Mark the module body executable if it isn't already.  This does an initial
+/// scan of the block, processing nullary operations like wires, instances, and
 /// constants that only get processed once.
-void IMConstPropPass::markBlockExecutable(Block *block) {
-  if (!executableBlocks.insert(block).second)
+void ModuleState::markBlockExecutable() {
+  if (executable)
     return; // Already executable.
+  executable = true;
 
-  for (auto &op : *block) {
+  for (auto &op : *module.getBodyBlock()) {
+    // Remember which fields the subelements refer to.
+    if (isa<SubfieldOp, SubindexOp>(op)) {
+      auto result = op.getResult(0);
+      fieldValues[getFieldRefFromValue(result)].push_back(result);
+    }
 
     // Handle each of the special operations in the firrtl dialect.
     if (isWireOrReg(&op))
@@ -400,8 +621,9 @@ void IMConstPropPass::markBlockExecutable(Block *block) {
       markInstanceOp(instance);
     else if (auto mem = dyn_cast<MemOp>(op))
       markMemOp(mem);
-    else if (isAggregate(&op))
-      markOverdefined(op.getResult(0));
+    else if (auto subaccess = dyn_cast<SubaccessOp>(op))
+      // The accessed element is not known statically.
+      markOverdefined(subaccess.getResult());
     else if (auto cast = dyn_cast<mlir::UnrealizedConversionCastOp>(op))
       for (auto result : cast.getResults())
         markOverdefined(result);
@@ -412,42 +634,50 @@ void IMConstPropPass::markBlockExecutable(Block *block) {
   }
 }
 
-void IMConstPropPass::markWireRegOp(Operation *wireOrReg) {
-  // If the wire/reg has a non-ground type, then it is too complex for us to
+void ModuleState::markWireRegOp(Operation *wireOrReg) {
+  // If the wire/reg has a foreign type, then it is too complex for us to
   // handle, mark it as overdefined.
-  // TODO: Eventually add a field-sensitive model.
   auto resultValue = wireOrReg->getResult(0);
-  auto type = resultValue.getType().dyn_cast<FIRRTLType>();
-  if (!type || !type.cast<FIRRTLBaseType>().getPassiveType().isGround())
+  auto type = resultValue.getType().dyn_cast<FIRRTLBaseType>();
+  if (!type)
     return markOverdefined(resultValue);
 
-  // Otherwise, this starts out as InvalidValue and is upgraded by connects.
-  mergeLatticeValue(resultValue, InvalidValueAttr::get(resultValue.getType()));
+  // Otherwise, every field starts out as InvalidValue and is upgraded by
+  // connects.
+  walkGroundFields(type, [&](unsigned fieldID, Type fieldType, bool) {
+    mergeLatticeValue(FieldRef(resultValue, fieldID),
+                      InvalidValueAttr::get(fieldType));
+  });
 }
 
-void IMConstPropPass::markMemOp(MemOp mem) {
+void ModuleState::markMemOp(MemOp mem) {
   for (auto result : mem.getResults())
     markOverdefined(result);
 }
 
-void IMConstPropPass::markConstantOp(ConstantOp constant) {
-  mergeLatticeValue(constant, LatticeValue(constant.getValueAttr()));
+void ModuleState::markConstantOp(ConstantOp constant) {
+  mergeLatticeValue(FieldRef(constant, 0),
+                    LatticeValue(constant.getValueAttr()));
 }
 
-void IMConstPropPass::markSpecialConstantOp(SpecialConstantOp specialConstant) {
-  mergeLatticeValue(specialConstant,
+void ModuleState::markSpecialConstantOp(SpecialConstantOp specialConstant) {
+  mergeLatticeValue(FieldRef(specialConstant, 0),
                     LatticeValue(specialConstant.getValueAttr()));
 }
 
-void IMConstPropPass::markInvalidValueOp(InvalidValueOp invalid) {
-  mergeLatticeValue(invalid, InvalidValueAttr::get(invalid.getType()));
+void ModuleState::markInvalidValueOp(InvalidValueOp invalid) {
+  walkGroundFields(invalid.getType(), [&](unsigned fieldID, Type fieldType,
+                                          bool) {
+    mergeLatticeValue(FieldRef(invalid, fieldID),
+                      InvalidValueAttr::get(fieldType));
+  });
 }
 
 /// Instances have no operands, so they are visited exactly once when their
 /// enclosing block is marked live.  This sets up the def-use edges for ports.
-void IMConstPropPass::markInstanceOp(InstanceOp instance) {
+void ModuleState::markInstanceOp(InstanceOp instance) {
   // Get the module being reference or a null pointer if this is an extmodule.
-  Operation *op = instanceGraph->getReferencedModule(instance);
+  Operation *op = instanceGraph.getReferencedModule(instance);
 
   // If this is an extmodule, just remember that any results and inouts are
   // overdefined.
@@ -456,8 +686,10 @@ void IMConstPropPass::markInstanceOp(InstanceOp instance) {
     for (size_t resultNo = 0, e = instance.getNumResults(); resultNo != e;
          ++resultNo) {
       auto portVal = instance.getResult(resultNo);
-      // If this is an input to the extmodule, we can ignore it.
-      if (module.getPortDirection(resultNo) == Direction::In)
+      // If this is a passive input to the extmodule, we can ignore it.
+      auto portType = portVal.getType().dyn_cast<FIRRTLBaseType>();
+      if (module.getPortDirection(resultNo) == Direction::In &&
+          (!portType || portType.isPassive()))
         continue;
 
       // Otherwise this is a result from it or an inout, mark it as overdefined.
@@ -468,24 +700,22 @@ void IMConstPropPass::markInstanceOp(InstanceOp instance) {
 
   // Otherwise this is a defined module.
   auto fModule = cast<FModuleOp>(op);
-  markBlockExecutable(fModule.getBodyBlock());
+  auto *fModuleState = moduleStates.lookup(fModule);
+  outbox.executable.push_back(fModuleState);
 
-  // Ok, it is a normal internal module reference.  Populate
-  // resultPortToInstanceResultMapping, and forward any already-computed values.
+  // Ok, it is a normal internal module reference.  Ask the module to populate
+  // its resultPortToInstanceResultMapping, and to forward any already-computed
+  // values.
   for (size_t resultNo = 0, e = instance.getNumResults(); resultNo != e;
        ++resultNo) {
     auto instancePortVal = instance.getResult(resultNo);
-    // If this is an input to the instance, it will
-    // get handled when any connects to it are processed.
-    if (fModule.getPortDirection(resultNo) == Direction::In)
-      continue;
-    // We only support simple values so far.
+    // If this is a passive input to the instance, it will get handled when
+    // any connects to it are processed.  Inputs with flipped fields also flow
+    // out of the module.
     auto portType = instancePortVal.getType().dyn_cast<FIRRTLBaseType>();
-    if (portType && !portType.isGround()) {
-      // TODO: Add field sensitivity.
-      markOverdefined(instancePortVal);
+    if (fModule.getPortDirection(resultNo) == Direction::In &&
+        (!portType || portType.isPassive()))
       continue;
-    }
 
     // Otherwise we have a result from the instance.  We need to forward results
     // from the body to this instance result's SSA value, so remember it.
@@ -493,70 +723,65 @@ void IMConstPropPass::markInstanceOp(InstanceOp instance) {
 
     // Mark don't touch results as overdefined
     if (hasDontTouch(modulePortVal))
-      markOverdefined(modulePortVal);
-
-    resultPortToInstanceResultMapping[modulePortVal].push_back(instancePortVal);
-
-    // If there is already a value known for modulePortVal make sure to forward
-    // it here.
-    mergeLatticeValue(instancePortVal, modulePortVal);
+      walkGroundFields(modulePortVal.getType(),
+                       [&](unsigned fieldID, Type, bool) {
+                         outbox.merges.push_back(
+                             {fModuleState, FieldRef(modulePortVal, fieldID),
+                              LatticeValue::getOverdefined()});
+                       });
+
+    outbox.subscriptions.push_back(
+        {fModuleState, modulePortVal, instancePortVal, this});
   }
 }
 
-void IMConstPropPass::visitConnectLike(FConnectLike connect) {
-  // Mark foreign types as overdefined.
-  auto destTypeFIRRTL = connect.getDest().getType().dyn_cast<FIRRTLType>();
-  if (!destTypeFIRRTL) {
-    markOverdefined(connect.getSrc());
-    return markOverdefined(connect.getDest());
-  }
-  auto destType = getBaseType(destTypeFIRRTL).getPassiveType();
-
-  // Handle implicit extensions.
-  auto srcValue = getExtendedLatticeValue(connect.getSrc(), destType);
-  if (srcValue.isUnknown())
-    return;
-
+void ModuleState::driveField(FieldRef dest, LatticeValue value,
+                             FConnectLike connect) {
   // Driving result ports propagates the value to each instance using the
-  // module.
-  if (auto blockArg = connect.getDest().dyn_cast<BlockArgument>()) {
-    for (auto userOfResultPort : resultPortToInstanceResultMapping[blockArg])
-      mergeLatticeValue(userOfResultPort, srcValue);
-    // Output ports are wire-like and may have users.
-    return mergeLatticeValue(connect.getDest(), srcValue);
-  }
-
-  auto dest = connect.getDest().cast<mlir::OpResult>();
+  // module once the port changes.  Output ports are wire-like and may have
+  // users.
+  auto root = dest.getValue();
+  if (root.isa<BlockArgument>())
+    return mergeLatticeValue(dest, value);
 
   // For wires and registers, we drive the value of the wire itself, which
   // automatically propagates to users.
-  if (isWireOrReg(dest.getOwner()))
-    return mergeLatticeValue(connect.getDest(), srcValue);
+  auto *rootOp = root.getDefiningOp();
+  if (isWireOrReg(rootOp))
+    return mergeLatticeValue(dest, value);
 
   // Driving an instance argument port drives the corresponding argument of the
   // referenced module.
-  if (auto instance = dest.getDefiningOp<InstanceOp>()) {
+  if (auto instance = dyn_cast<InstanceOp>(rootOp)) {
     // Update the dest, when its an instance op.
-    mergeLatticeValue(connect.getDest(), srcValue);
+    mergeLatticeValue(dest, value);
     auto module =
-        dyn_cast<FModuleOp>(*instanceGraph->getReferencedModule(instance));
+        dyn_cast<FModuleOp>(*instanceGraph.getReferencedModule(instance));
     if (!module)
       return;
 
-    BlockArgument modulePortVal = module.getArgument(dest.getResultNumber());
-    return mergeLatticeValue(modulePortVal, srcValue);
+    BlockArgument modulePortVal =
+        module.getArgument(root.cast<mlir::OpResult>().getResultNumber());
+    outbox.merges.push_back({moduleStates.lookup(module),
+                             FieldRef(modulePortVal, dest.getFieldID()),
+                             value});
+    return;
   }
 
-  // Driving a memory result is ignored because these are always treated as
-  // overdefined.
-  if (auto subfield = dest.getDefiningOp<SubfieldOp>()) {
-    if (subfield.getOperand().getDefiningOp<MemOp>())
-      return;
+  // Driving a dynamically indexed element may drive any element of the vector.
+  if (auto subaccess = dyn_cast<SubaccessOp>(rootOp)) {
+    auto input = subaccess.getInput();
+    auto inputRef = getFieldRefFromValue(input);
+    walkGroundFields(input.getType(), [&](unsigned fieldID, Type, bool) {
+      driveField(inputRef.getSubField(fieldID), LatticeValue::getOverdefined(),
+                 connect);
+    });
+    return;
   }
 
-  // Skip if the dest is an aggregate value. Aggregate values are firstly marked
-  // overdefined.
-  if (isAggregate(dest.getOwner()))
+  // Driving a memory port, the flipped field of an invalid value, or any other
+  // value which is overdefined from the start, is ignored.
+  if (isa<MemOp, InvalidValueOp>(rootOp) || isOverdefined(dest))
     return;
 
   connect.emitError("connectlike operation unhandled by IMConstProp")
@@ -564,33 +789,60 @@ void IMConstPropPass::visitConnectLike(FConnectLike connect) {
       << "connect destination is here";
 }
 
-void IMConstPropPass::visitRegResetOp(RegResetOp regReset) {
-  // If the reg has a non-ground type, then it is too complex for us to handle,
-  // mark it as overdefined.
-  // TODO: Eventually add a field-sensitive model.
-  if (!regReset.getType().getPassiveType().isGround())
-    return markOverdefined(regReset);
+void ModuleState::visitConnectLike(FConnectLike connect) {
+  // Mark foreign types as overdefined.
+  auto destTypeFIRRTL = connect.getDest().getType().dyn_cast<FIRRTLType>();
+  if (!destTypeFIRRTL) {
+    markOverdefined(connect.getSrc());
+    return markOverdefined(connect.getDest());
+  }
+
+  // Drive every ground field of the destination from the same field of the
+  // source, or the other way around for flipped fields.
+  auto srcRef = getFieldRefFromValue(connect.getSrc());
+  auto destRef = getFieldRefFromValue(connect.getDest());
+  walkGroundFields(destTypeFIRRTL, [&](unsigned fieldID, Type fieldType,
+                                       bool isFlip) {
+    auto src = srcRef.getSubField(fieldID);
+    auto dest = destRef.getSubField(fieldID);
+    if (isFlip)
+      std::swap(src, dest);
+
+    // Handle implicit extensions.
+    auto srcValue = getExtendedLatticeValue(
+        src, fieldType.cast<FIRRTLBaseType>().getPassiveType());
+    if (!srcValue.isUnknown())
+      driveField(dest, srcValue, connect);
+  });
+}
 
+void ModuleState::visitRegResetOp(RegResetOp regReset) {
   // The reset value may be known - if so, merge it in if the enable is greater
   // than invalid.
-  auto srcValue = getExtendedLatticeValue(
-      regReset.getResetValue(), regReset.getType().cast<FIRRTLBaseType>(),
-      /*allowTruncation=*/true);
   auto enable = getExtendedLatticeValue(
-      regReset.getResetSignal(),
+      getFieldRefFromValue(regReset.getResetSignal()),
       regReset.getResetSignal().getType().cast<FIRRTLBaseType>(),
       /*allowTruncation=*/true);
-  if (enable.isOverdefined() ||
-      (enable.isConstant() && !enable.getConstant().getValue().isZero()))
-    mergeLatticeValue(regReset, srcValue);
+  if (!enable.isOverdefined() &&
+      !(enable.isConstant() && !enable.getConstant().getValue().isZero()))
+    return;
+
+  auto resetValueRef = getFieldRefFromValue(regReset.getResetValue());
+  walkGroundFields(regReset.getType(), [&](unsigned fieldID, Type fieldType,
+                                           bool) {
+    auto srcValue = getExtendedLatticeValue(
+        resetValueRef.getSubField(fieldID), fieldType.cast<FIRRTLBaseType>(),
+        /*allowTruncation=*/true);
+    mergeLatticeValue(FieldRef(regReset, fieldID), srcValue);
+  });
 }
 
-void IMConstPropPass::visitRefSend(RefSendOp send) {
+void ModuleState::visitRefSend(RefSendOp send) {
   // Send connects the base value (source) to the result (dest).
   return mergeLatticeValue(send.getResult(), send.getBase());
 }
 
-void IMConstPropPass::visitRefResolve(RefResolveOp resolve) {
+void ModuleState::visitRefResolve(RefResolveOp resolve) {
   // Resolve connects the ref value (source) to result (dest).
   // If writes are ever supported, this will need to work differently!
   return mergeLatticeValue(resolve.getResult(), resolve.getRef());
@@ -602,7 +854,7 @@ void IMConstPropPass::visitRefResolve(RefResolveOp resolve) {
 ///
 /// This should update the lattice value state for any result values.
 ///
-void IMConstPropPass::visitOperation(Operation *op) {
+void ModuleState::visitOperation(Operation *op) {
   // If this is a operation with special handling, handle it specially.
   if (auto connectLikeOp = dyn_cast<FConnectLike>(op))
     return visitConnectLike(connectLikeOp);
@@ -616,6 +868,10 @@ void IMConstPropPass::visitOperation(Operation *op) {
   // The clock operand of regop changing doesn't change its result value.
   if (isa<RegOp>(op))
     return;
+  // Subelements refer to the fields of their input, and have no lattice value
+  // of their own.
+  if (isa<SubfieldOp, SubindexOp, SubaccessOp>(op))
+    return;
   // TODO: Handle 'when' operations.
 
   // Nodes might not fold since they might have a name, but should prop
@@ -624,9 +880,23 @@ void IMConstPropPass::visitOperation(Operation *op) {
     return;
   }
 
+  // Other operations are only folded on ground values.
+  auto isAggregateType = [](Type type) {
+    auto baseType = type.dyn_cast<FIRRTLBaseType>();
+    return baseType && !baseType.isGround();
+  };
+  if (llvm::any_of(op->getResultTypes(), isAggregateType) ||
+      llvm::any_of(op->getOperandTypes(), isAggregateType)) {
+    for (auto value : op->getResults())
+      markOverdefined(value);
+    return;
+  }
+
   // If all of the results of this operation are already overdefined (or if
   // there are no results) then bail out early: we've converged.
-  auto isOverdefinedFn = [&](Value value) { return isOverdefined(value); };
+  auto isOverdefinedFn = [&](Value value) {
+    return isOverdefined(FieldRef(value, 0));
+  };
   if (llvm::all_of(op->getResults(), isOverdefinedFn))
     return;
 
@@ -635,7 +905,7 @@ void IMConstPropPass::visitOperation(Operation *op) {
   SmallVector<Attribute, 8> operandConstants;
   operandConstants.reserve(op->getNumOperands());
   for (Value operand : op->getOperands()) {
-    auto &operandLattice = latticeValues[operand];
+    auto &operandLattice = latticeValues[getFieldRefFromValue(operand)];
 
     // If the operand is an unknown value, then we generally don't want to
     // process it - we want to wait until the value is resolved to by the SCCP
@@ -680,20 +950,44 @@ void IMConstPropPass::visitOperation(Operation *op) {
       else // Treat non integer constants as overdefined.
         resultLattice = LatticeValue::getOverdefined();
     } else { // Folding to an operand results in its value.
-      resultLattice = latticeValues[foldResult.get<Value>()];
+      resultLattice =
+          latticeValues[getFieldRefFromValue(foldResult.get<Value>())];
     }
 
     // We do not "merge" the lattice value in, we set it.  This is because the
     // fold functions can produce different values over time, e.g. in the
     // presence of InvalidValue operands that get resolved to other constants.
-    setLatticeValue(op->getResult(i), resultLattice);
+    setLatticeValue(FieldRef(op->getResult(i), 0), resultLattice);
   }
 }
 
-void IMConstPropPass::rewriteModuleBody(FModuleOp module) {
+/// Return true if the passive aggregate `value` is only written to through
+/// the connects to its ground fields, and only read through those fields.
+/// Dropping the connect to a constant field then cannot change what is read
+/// from the aggregate, as every read of the field is replaced by the constant.
+static bool isOnlyAccessedByField(Value value) {
+  for (auto &use : value.getUses()) {
+    auto *user = use.getOwner();
+    if (isa<SubfieldOp, SubindexOp>(user)) {
+      auto result = user->getResult(0);
+      if (!result.getType().cast<FIRRTLBaseType>().isGround() &&
+          !isOnlyAccessedByField(result))
+        return false;
+      continue;
+    }
+    if (isa<FConnectLike>(user) && use.getOperandNumber() == 0)
+      continue;
+    return false;
+  }
+  return true;
+}
+
+void IMConstPropPass::rewriteModuleBody(ModuleState &state) {
+  auto module = state.module;
+  auto &latticeValues = state.latticeValues;
   auto *body = module.getBodyBlock();
   // If a module is unreachable, just ignore it.
-  if (!executableBlocks.count(body))
+  if (!state.isExecutable())
     return;
 
   auto builder = OpBuilder::atBlockBegin(body);
@@ -721,17 +1015,17 @@ void IMConstPropPass::rewriteModuleBody(FModuleOp module) {
   // If the lattice value for the specified value is a constant or
   // InvalidValue, update it and return true.  Otherwise return false.
   auto replaceValueIfPossible = [&](Value value) -> bool {
-    auto it = latticeValues.find(value);
-    if (it == latticeValues.end() || it->second.isOverdefined() ||
-        it->second.isUnknown())
+    // Cannot materialize constants for non-base or aggregate types.
+    auto type = value.getType().dyn_cast<FIRRTLBaseType>();
+    if (!type || !type.isGround())
       return false;
 
-    // Cannot materialize constants for non-base types.
-    if (!value.getType().isa<FIRRTLBaseType>())
+    auto it = latticeValues.find(getFieldRefFromValue(value));
+    if (it == latticeValues.end() || it->second.isOverdefined() ||
+        it->second.isUnknown())
       return false;
 
-    auto cstValue =
-        getConst(it->second.getValue(), value.getType(), value.getLoc());
+    auto cstValue = getConst(it->second.getValue(), type, value.getLoc());
 
     // Replace all uses of this value with the constant, unless this is the
     // destination of a connect.  We leave those alone to avoid upsetting flow.
@@ -746,6 +1040,18 @@ void IMConstPropPass::rewriteModuleBody(FModuleOp module) {
   for (auto &port : body->getArguments())
     replaceValueIfPossible(port);
 
+  // Returns true if the connects to the fields of the aggregate wire or
+  // register can be dropped once they are known to be constant.
+  DenseMap<Value, bool> fieldConnectsDeletable;
+  auto areFieldConnectsDeletable = [&](Value root) {
+    auto [it, inserted] = fieldConnectsDeletable.try_emplace(root, false);
+    if (inserted)
+      it->second =
+          root.getType().cast<FIRRTLBaseType>().isPassive() &&
+          isOnlyAccessedByField(root);
+    return it->second;
+  };
+
   // TODO: Walk 'when's preorder with `walk`.
 
   // Walk the IR bottom-up when folding.  We often fold entire chains of
@@ -755,8 +1061,14 @@ void IMConstPropPass::rewriteModuleBody(FModuleOp module) {
   for (auto &op : llvm::make_early_inc_range(llvm::reverse(*body))) {
     // Connects to values that we found to be constant can be dropped.
     if (auto connect = dyn_cast<FConnectLike>(op)) {
-      if (auto *destOp = connect.getDest().getDefiningOp()) {
-        if (isDeletableWireOrReg(destOp) && !isOverdefined(connect.getDest())) {
+      auto destType = connect.getDest().getType().dyn_cast<FIRRTLBaseType>();
+      if (!destType || !destType.isGround())
+        continue;
+      auto destRef = getFieldRefFromValue(connect.getDest());
+      auto root = destRef.getValue();
+      if (auto *destOp = root.getDefiningOp()) {
+        if (isDeletableWireOrReg(destOp) && !state.isOverdefined(destRef) &&
+            (root == connect.getDest() || areFieldConnectsDeletable(root))) {
           connect.erase();
           ++numErasedOp;
         }
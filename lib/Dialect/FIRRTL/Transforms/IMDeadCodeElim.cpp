@@ -13,7 +13,6 @@
 #include "mlir/IR/Threading.h"
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/PostOrderIterator.h"
-#include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Support/Debug.h"
 
 #define DEBUG_TYPE "firrtl-imdeadcodeelim"
@@ -35,24 +34,85 @@ static bool isDeletableDeclaration(Operation *op) {
 }
 
 namespace {
-struct IMDeadCodeElimPass : public IMDeadCodeElimBase<IMDeadCodeElimPass> {
-  void runOnOperation() override;
+struct ModuleState;
+
+/// The liveness updates one module sends to the other modules while it is
+/// being solved. These are only delivered once every module of the current
+/// round has reached its local fixpoint.
+struct Outbox {
+  /// Modules which have been instantiated in a live block.
+  SmallVector<ModuleState *, 0> executable;
+  /// Values owned by other modules which are alive.
+  SmallVector<std::pair<ModuleState *, Value>, 0> alive;
+  /// Instance results which have to follow the liveness of an input port.
+  SmallVector<std::tuple<ModuleState *, BlockArgument, Value, ModuleState *>, 0>
+      subscriptions;
+};
 
-  void rewriteModuleSignature(FModuleOp module);
-  void rewriteModuleBody(FModuleOp module);
-  void eraseEmptyModule(FModuleOp module);
-  void forwardConstantOutputPort(FModuleOp module);
+/// The liveness state of a single module. Values are numbered densely within
+/// their module: ports by their argument number and operation results by a
+/// per-operation base index, so that liveness is a pair of bit vectors. Each
+/// module is solved on its own, in parallel with the others, and only
+/// exchanges liveness with the other modules at the ports of its instances.
+struct ModuleState {
+  ModuleState(FModuleOp module, InstanceGraph &instanceGraph,
+              const DenseMap<Operation *, ModuleState *> &moduleStates)
+      : module(module), instanceGraph(instanceGraph),
+        moduleStates(moduleStates), livePorts(module.getNumPorts()) {}
+
+  /// Returns true if this module has work left to do in the next round.
+  bool hasPendingWork() const {
+    return markExecutableRequested || !incomingAlive.empty() ||
+           !incomingSubscriptions.empty();
+  }
+
+  /// Apply the updates in the inbox and run the worklist to the local
+  /// fixpoint, collecting any updates for other modules in the outbox.
+  void solve();
+
+  /// Return the index of the first result of the operation in `liveResults`,
+  /// numbering it if this is the first time it is seen.
+  unsigned getOrCreateNumber(Operation *op) {
+    auto [it, inserted] = resultNumbers.try_emplace(op, liveResults.size());
+    if (inserted)
+      liveResults.resize(liveResults.size() + op->getNumResults());
+    return it->second;
+  }
+
+  /// Record that the value is alive. Returns true if it was not already.
+  bool setAlive(Value value) {
+    if (auto blockArg = value.dyn_cast<BlockArgument>()) {
+      assert(blockArg.getOwner() == module.getBodyBlock() &&
+             "only ports are block arguments");
+      if (livePorts.test(blockArg.getArgNumber()))
+        return false;
+      livePorts.set(blockArg.getArgNumber());
+      return true;
+    }
+    auto result = value.cast<OpResult>();
+    auto index =
+        getOrCreateNumber(result.getOwner()) + result.getResultNumber();
+    if (liveResults.test(index))
+      return false;
+    liveResults.set(index);
+    return true;
+  }
 
   void markAlive(Value value) {
-    //  If the value is already in `liveSet`, skip it.
-    if (liveSet.insert(value).second)
+    //  If the value is already alive, skip it.
+    if (setAlive(value))
       worklist.push_back(value);
   }
 
   /// Return true if the value is known alive.
   bool isKnownAlive(Value value) const {
     assert(value && "null should not be used");
-    return liveSet.count(value);
+    if (auto blockArg = value.dyn_cast<BlockArgument>())
+      return livePorts.test(blockArg.getArgNumber());
+    auto result = value.cast<OpResult>();
+    auto it = resultNumbers.find(result.getOwner());
+    return it != resultNumbers.end() &&
+           liveResults.test(it->second + result.getResultNumber());
   }
 
   /// Return true if the value is assumed dead.
@@ -62,45 +122,81 @@ struct IMDeadCodeElimPass : public IMDeadCodeElimBase<IMDeadCodeElimPass> {
                          [&](Value value) { return isKnownAlive(value); });
   }
 
-  /// Return true if the block is alive.
-  bool isBlockExecutable(Block *block) const {
-    return executableBlocks.count(block);
-  }
+  /// Return true if the body of the module is alive.
+  bool isExecutable() const { return executable; }
 
   void visitUser(Operation *op);
   void visitValue(Value value);
   void visitConnect(FConnectLike connect);
   void visitSubelement(Operation *op);
-  void markBlockExecutable(Block *block);
+  void markBlockExecutable();
   void markDeclaration(Operation *op);
   void markInstanceOp(InstanceOp instanceOp);
   void markUnknownSideEffectOp(Operation *op);
 
-private:
-  /// The set of blocks that are known to execute, or are intrinsically alive.
-  DenseSet<Block *> executableBlocks;
+  /// The module this state belongs to.
+  FModuleOp module;
+
+  InstanceGraph &instanceGraph;
 
-  /// This keeps track of users the instance results that correspond to output
-  /// ports.
-  DenseMap<BlockArgument, llvm::TinyPtrVector<Value>>
+  /// The state of every module in the circuit, used to address messages.
+  const DenseMap<Operation *, ModuleState *> &moduleStates;
+
+  /// True if the body of the module is known to execute, or is intrinsically
+  /// alive.
+  bool executable = false;
+
+  /// The liveness of the ports of the module, indexed by argument number.
+  /// Once the module has been solved this is its port summary.
+  llvm::BitVector livePorts;
+
+  /// The liveness of operation results, indexed by `resultNumbers`.
+  DenseMap<Operation *, unsigned> resultNumbers;
+  llvm::BitVector liveResults;
+
+  /// This keeps track of users the instance results, and the modules owning
+  /// them, that correspond to ports of this module.
+  DenseMap<BlockArgument, SmallVector<std::pair<Value, ModuleState *>, 1>>
       resultPortToInstanceResultMapping;
-  InstanceGraph *instanceGraph;
 
   /// A worklist of values whose liveness recently changed, indicating the
   /// users need to be reprocessed.
   SmallVector<Value, 64> worklist;
-  llvm::DenseSet<Value> liveSet;
+
+  /// The updates other modules sent to this one during the last exchange.
+  bool markExecutableRequested = false;
+  SmallVector<Value, 0> incomingAlive;
+  SmallVector<std::pair<BlockArgument, std::pair<Value, ModuleState *>>, 0>
+      incomingSubscriptions;
+
+  /// The updates this module sends to other modules in the next exchange.
+  Outbox outbox;
+};
+
+struct IMDeadCodeElimPass : public IMDeadCodeElimBase<IMDeadCodeElimPass> {
+  void runOnOperation() override;
+
+  void rewriteModuleSignature(ModuleState &state);
+  void rewriteModuleBody(ModuleState &state);
+  void eraseEmptyModule(FModuleOp module);
+  void forwardConstantOutputPort(FModuleOp module);
+
+private:
+  InstanceGraph *instanceGraph;
+
+  /// The liveness state of every module.
+  DenseMap<Operation *, ModuleState *> moduleStates;
 };
 } // namespace
 
-void IMDeadCodeElimPass::markDeclaration(Operation *op) {
+void ModuleState::markDeclaration(Operation *op) {
   assert(isDeclaration(op) && "only a declaration is expected");
   if (!isDeletableDeclaration(op))
     for (auto result : op->getResults())
       markAlive(result);
 }
 
-void IMDeadCodeElimPass::markUnknownSideEffectOp(Operation *op) {
+void ModuleState::markUnknownSideEffectOp(Operation *op) {
   // For operations with side effects, pessimistically mark results and
   // operands as alive.
   for (auto result : op->getResults())
@@ -109,7 +205,7 @@ void IMDeadCodeElimPass::markUnknownSideEffectOp(Operation *op) {
     markAlive(operand);
 }
 
-void IMDeadCodeElimPass::visitUser(Operation *op) {
+void ModuleState::visitUser(Operation *op) {
   LLVM_DEBUG(llvm::dbgs() << "Visit: " << *op << "\n");
   if (auto connectOp = dyn_cast<FConnectLike>(op))
     return visitConnect(connectOp);
@@ -117,9 +213,9 @@ void IMDeadCodeElimPass::visitUser(Operation *op) {
     return visitSubelement(op);
 }
 
-void IMDeadCodeElimPass::markInstanceOp(InstanceOp instance) {
+void ModuleState::markInstanceOp(InstanceOp instance) {
   // Get the module being referenced.
-  Operation *op = instanceGraph->getReferencedModule(instance);
+  Operation *op = instanceGraph.getReferencedModule(instance);
 
   // If this is an extmodule, just remember that any inputs and inouts are
   // alive.
@@ -139,10 +235,11 @@ void IMDeadCodeElimPass::markInstanceOp(InstanceOp instance) {
 
   // Otherwise this is a defined module.
   auto fModule = cast<FModuleOp>(op);
-  markBlockExecutable(fModule.getBodyBlock());
+  auto *fModuleState = moduleStates.lookup(fModule);
+  outbox.executable.push_back(fModuleState);
 
-  // Ok, it is a normal internal module reference so populate
-  // resultPortToInstanceResultMapping.
+  // Ok, it is a normal internal module reference so ask the module to populate
+  // its resultPortToInstanceResultMapping.
   for (auto resultNo : llvm::seq(0u, instance.getNumResults())) {
     auto instancePortVal = instance.getResult(resultNo);
 
@@ -150,13 +247,17 @@ void IMDeadCodeElimPass::markInstanceOp(InstanceOp instance) {
     // from the body to this instance result's SSA value, so remember it.
     BlockArgument modulePortVal = fModule.getArgument(resultNo);
 
-    resultPortToInstanceResultMapping[modulePortVal].push_back(instancePortVal);
+    outbox.subscriptions.push_back(
+        {fModuleState, modulePortVal, instancePortVal, this});
   }
 }
 
-void IMDeadCodeElimPass::markBlockExecutable(Block *block) {
-  if (!executableBlocks.insert(block).second)
+void ModuleState::markBlockExecutable() {
+  if (executable)
     return; // Already executable.
+  executable = true;
+
+  auto *block = module.getBodyBlock();
 
   // Mark ports with don't touch as alive.
   for (auto blockArg : block->getArguments())
@@ -229,28 +330,58 @@ void IMDeadCodeElimPass::runOnOperation() {
     if (auto module = dyn_cast_or_null<FModuleOp>(*node->getModule()))
       forwardConstantOutputPort(module);
 
+  // Create the state of every module up front, so that the module solvers can
+  // address each other without synchronization.
+  std::vector<std::unique_ptr<ModuleState>> states;
   for (auto module : circuit.getBodyBlock()->getOps<FModuleOp>()) {
+    states.push_back(
+        std::make_unique<ModuleState>(module, *instanceGraph, moduleStates));
+    moduleStates[module] = states.back().get();
+  }
+
+  for (auto &state : states) {
     // Mark the ports of public modules as alive.
-    if (module.isPublic()) {
-      markBlockExecutable(module.getBodyBlock());
-      for (auto port : module.getBodyBlock()->getArguments())
-        markAlive(port);
+    if (state->module.isPublic()) {
+      state->markExecutableRequested = true;
+      for (auto port : state->module.getBodyBlock()->getArguments())
+        state->incomingAlive.push_back(port);
     }
   }
 
-  // If a value changed liveness then propagate liveness through its users and
-  // definition.
-  while (!worklist.empty())
-    visitValue(worklist.pop_back_val());
+  // Solve every module with pending updates to its local fixpoint in parallel,
+  // then deliver the updates they produced for other modules. Repeat until no
+  // module has anything left to do.
+  SmallVector<ModuleState *, 0> active;
+  while (true) {
+    active.clear();
+    for (auto &state : states)
+      if (state->hasPendingWork())
+        active.push_back(state.get());
+    if (active.empty())
+      break;
+
+    mlir::parallelForEach(circuit.getContext(), active,
+                          [&](ModuleState *state) { state->solve(); });
+
+    for (auto *state : active) {
+      auto &outbox = state->outbox;
+      for (auto *target : outbox.executable)
+        target->markExecutableRequested = true;
+      for (auto [target, value] : outbox.alive)
+        target->incomingAlive.push_back(value);
+      for (auto [target, port, result, owner] : outbox.subscriptions)
+        target->incomingSubscriptions.push_back({port, {result, owner}});
+      outbox = {};
+    }
+  }
 
   // Rewrite module signatures.
-  for (auto module : circuit.getBodyBlock()->getOps<FModuleOp>())
-    rewriteModuleSignature(module);
+  for (auto &state : states)
+    rewriteModuleSignature(*state);
 
   // Rewrite module bodies parallelly.
-  mlir::parallelForEach(circuit.getContext(),
-                        circuit.getBodyBlock()->getOps<FModuleOp>(),
-                        [&](auto op) { rewriteModuleBody(op); });
+  mlir::parallelForEach(circuit.getContext(), states,
+                        [&](auto &state) { rewriteModuleBody(*state); });
 
   // Erase empty modules. To erase empty modules transitively, it is necessary
   // to visit modules in the post order of instance graph.
@@ -264,9 +395,38 @@ void IMDeadCodeElimPass::runOnOperation() {
 
   for (auto module : modules)
     eraseEmptyModule(module);
+
+  moduleStates.clear();
 }
 
-void IMDeadCodeElimPass::visitValue(Value value) {
+/// Apply the updates other modules sent to this one and run the worklist to
+/// the local fixpoint.
+void ModuleState::solve() {
+  if (markExecutableRequested) {
+    markExecutableRequested = false;
+    markBlockExecutable();
+  }
+
+  for (auto value : incomingAlive)
+    markAlive(value);
+  incomingAlive.clear();
+
+  // Instance results of a live input port are alive as well.
+  for (auto &[port, user] : incomingSubscriptions) {
+    resultPortToInstanceResultMapping[port].push_back(user);
+    if (module.getPortDirection(port.getArgNumber()) == Direction::In &&
+        isKnownAlive(port))
+      outbox.alive.push_back({user.second, user.first});
+  }
+  incomingSubscriptions.clear();
+
+  // If a value changed liveness then propagate liveness through its users and
+  // definition.
+  while (!worklist.empty())
+    visitValue(worklist.pop_back_val());
+}
+
+void ModuleState::visitValue(Value value) {
   assert(isKnownAlive(value) && "only alive values reach here");
 
   // Propagate liveness through users.
@@ -280,9 +440,12 @@ void IMDeadCodeElimPass::visitValue(Value value) {
     // If the port is input, it's necessary to mark corresponding input ports of
     // instances as alive. We don't have to propagate the liveness of output
     // ports.
-    if (portDirection == Direction::In)
-      for (auto userOfResultPort : resultPortToInstanceResultMapping[blockArg])
-        markAlive(userOfResultPort);
+    if (portDirection == Direction::In) {
+      auto it = resultPortToInstanceResultMapping.find(blockArg);
+      if (it != resultPortToInstanceResultMapping.end())
+        for (auto [userOfResultPort, owner] : it->second)
+          outbox.alive.push_back({owner, userOfResultPort});
+    }
     return;
   }
 
@@ -292,13 +455,14 @@ void IMDeadCodeElimPass::visitValue(Value value) {
     auto instanceResult = value.cast<mlir::OpResult>();
     // Update the src, when it's an instance op.
     auto module =
-        dyn_cast<FModuleOp>(*instanceGraph->getReferencedModule(instance));
+        dyn_cast<FModuleOp>(*instanceGraph.getReferencedModule(instance));
     if (!module)
       return;
 
     BlockArgument modulePortVal =
         module.getArgument(instanceResult.getResultNumber());
-    return markAlive(modulePortVal);
+    outbox.alive.push_back({moduleStates.lookup(module), modulePortVal});
+    return;
   }
 
   // If a port of a memory is alive, all other ports are.
@@ -314,29 +478,29 @@ void IMDeadCodeElimPass::visitValue(Value value) {
       markAlive(operand);
 }
 
-void IMDeadCodeElimPass::visitConnect(FConnectLike connect) {
+void ModuleState::visitConnect(FConnectLike connect) {
   // If the dest is alive, mark the source value as alive.
   if (isKnownAlive(connect.getDest()))
     markAlive(connect.getSrc());
 }
 
-void IMDeadCodeElimPass::visitSubelement(Operation *op) {
+void ModuleState::visitSubelement(Operation *op) {
   if (isKnownAlive(op->getOperand(0)))
     markAlive(op->getResult(0));
 }
 
-void IMDeadCodeElimPass::rewriteModuleBody(FModuleOp module) {
-  auto *body = module.getBodyBlock();
+void IMDeadCodeElimPass::rewriteModuleBody(ModuleState &state) {
+  auto *body = state.module.getBodyBlock();
   // If the module is unreachable, just ignore it.
   // TODO: Erase this module from circuit op.
-  if (!isBlockExecutable(body))
+  if (!state.isExecutable())
     return;
 
   // Walk the IR bottom-up when deleting operations.
   for (auto &op : llvm::make_early_inc_range(llvm::reverse(*body))) {
     // Connects to values that we found to be dead can be dropped.
     if (auto connect = dyn_cast<FConnectLike>(op)) {
-      if (isAssumedDead(connect.getDest())) {
+      if (state.isAssumedDead(connect.getDest())) {
         LLVM_DEBUG(llvm::dbgs() << "DEAD: " << connect << "\n";);
         connect.erase();
         ++numErasedOps;
@@ -345,7 +509,7 @@ void IMDeadCodeElimPass::rewriteModuleBody(FModuleOp module) {
     }
 
     // Delete dead wires, regs and nodes.
-    if (isDeclaration(&op) && isAssumedDead(&op)) {
+    if (isDeclaration(&op) && state.isAssumedDead(&op)) {
       LLVM_DEBUG(llvm::dbgs() << "DEAD: " << op << "\n";);
       assert(op.use_empty() && "users should be already removed");
       op.erase();
@@ -361,10 +525,11 @@ void IMDeadCodeElimPass::rewriteModuleBody(FModuleOp module) {
   }
 }
 
-void IMDeadCodeElimPass::rewriteModuleSignature(FModuleOp module) {
+void IMDeadCodeElimPass::rewriteModuleSignature(ModuleState &state) {
+  auto module = state.module;
   // If the module is unreachable, just ignore it.
   // TODO: Erase this module from circuit op.
-  if (!isBlockExecutable(module.getBodyBlock()))
+  if (!state.isExecutable())
     return;
 
   // Ports of public modules cannot be modified.
@@ -383,7 +548,7 @@ void IMDeadCodeElimPass::rewriteModuleSignature(FModuleOp module) {
 
   for (auto index : llvm::seq(0u, numOldPorts)) {
     auto argument = module.getArgument(index);
-    assert((!hasDontTouch(argument) || isKnownAlive(argument)) &&
+    assert((!hasDontTouch(argument) || state.isKnownAlive(argument)) &&
            "If the port has don't touch, it should be known alive");
 
     // If the port has dontTouch, skip.
@@ -392,11 +557,13 @@ void IMDeadCodeElimPass::rewriteModuleSignature(FModuleOp module) {
 
     // If the port is known alive, then we can't delete it except for write-only
     // output ports.
-    if (isKnownAlive(argument)) {
+    if (state.isKnownAlive(argument)) {
       bool deadOutputPortAtAnyInstantiation =
           module.getPortDirection(index) == Direction::Out &&
-          llvm::all_of(resultPortToInstanceResultMapping[argument],
-                       [&](Value result) { return isAssumedDead(result); });
+          llvm::all_of(state.resultPortToInstanceResultMapping[argument],
+                       [&](auto user) {
+                         return user.second->isAssumedDead(user.first);
+                       });
 
       if (!deadOutputPortAtAnyInstantiation)
         continue;
@@ -409,9 +576,8 @@ void IMDeadCodeElimPass::rewriteModuleSignature(FModuleOp module) {
       // the port with a wire.
       WireOp wire = builder.create<WireOp>(argument.getType());
 
-      // Since `liveSet` contains the port, we have to erase it from the set.
-      liveSet.erase(argument);
-      liveSet.insert(wire);
+      // The port is replaced by the wire, which is alive instead.
+      state.setAlive(wire);
       argument.replaceAllUsesWith(wire);
       deadPortIndexes.set(index);
       continue;
@@ -421,7 +587,7 @@ void IMDeadCodeElimPass::rewriteModuleSignature(FModuleOp module) {
     // `rewriteModuleBody`.
     WireOp wire = builder.create<WireOp>(argument.getType());
     argument.replaceAllUsesWith(wire);
-    assert(isAssumedDead(wire.getResult()) && "dummy wire must be dead");
+    assert(state.isAssumedDead(wire.getResult()) && "dummy wire must be dead");
     deadPortIndexes.set(index);
   }
 
@@ -429,31 +595,24 @@ void IMDeadCodeElimPass::rewriteModuleSignature(FModuleOp module) {
   if (deadPortIndexes.none())
     return;
 
-  // Erase arguments of the old module from liveSet to prevent from creating
-  // dangling pointers.
-  for (auto arg : module.getArguments())
-    liveSet.erase(arg);
-
   // Delete ports from the module.
   module.erasePorts(deadPortIndexes);
 
-  // Add arguments of the new module to liveSet.
-  for (auto arg : module.getArguments())
-    liveSet.insert(arg);
+  // All the remaining ports are alive.
+  state.livePorts.clear();
+  state.livePorts.resize(module.getNumPorts(), true);
 
   // Rewrite all uses.
   for (auto *use : instanceGraphNode->uses()) {
     auto instance = cast<InstanceOp>(*use->getInstance());
+    auto *instanceState =
+        moduleStates.lookup(instance->getParentOfType<FModuleOp>());
     ImplicitLocOpBuilder builder(instance.getLoc(), instance);
-    // Since we will rewrite instance op, it is necessary to remove old instance
-    // results from liveSet.
-    for (auto oldResult : instance.getResults())
-      liveSet.erase(oldResult);
 
     // Replace old instance results with dummy wires.
     for (auto index : deadPortIndexes.set_bits()) {
       auto result = instance.getResult(index);
-      assert(isAssumedDead(result) &&
+      assert(instanceState->isAssumedDead(result) &&
              "instance results of dead ports must be dead");
       WireOp wire = builder.create<WireOp>(result.getType());
       result.replaceAllUsesWith(wire);
@@ -464,10 +623,12 @@ void IMDeadCodeElimPass::rewriteModuleSignature(FModuleOp module) {
 
     // Mark new results as alive.
     for (auto newResult : newInstance.getResults())
-      liveSet.insert(newResult);
+      instanceState->setAlive(newResult);
 
     instanceGraph->replaceInstance(instance, newInstance);
-    // Remove old one.
+    // Remove old one. Since we rewrote the instance op, it is necessary to
+    // forget its number so that no other operation inherits its liveness.
+    instanceState->resultNumbers.erase(instance);
     instance.erase();
   }
 
@@ -41,7 +41,9 @@ struct InferReadWritePass : public InferReadWriteBase<InferReadWritePass> {
   void runOnOperation() override {
     LLVM_DEBUG(llvm::dbgs() << "\n Running Infer Read Write on module:"
                             << getOperation().getName());
-    ModuleNamespace modNamespace(getOperation());
+    // The namespace is only needed to name inferred read-write ports, so it is
+    // only built for modules which have one.
+    Optional<ModuleNamespace> modNamespace;
     SmallVector<Operation *> opsToErase;
     for (MemOp memOp : llvm::make_early_inc_range(
              getOperation().getBodyBlock()->getOps<MemOp>())) {
@@ -122,8 +124,10 @@ struct InferReadWritePass : public InferReadWriteBase<InferReadWritePass> {
         continue;
 
       // Create the merged rw port for the new memory.
+      if (!modNamespace)
+        modNamespace.emplace(getOperation());
       resultNames.push_back(
-          StringAttr::get(memOp.getContext(), modNamespace.newName("rw")));
+          StringAttr::get(memOp.getContext(), modNamespace->newName("rw")));
       // Set the type of the rw port.
       resultTypes.push_back(MemOp::getTypeForPort(
           memOp.getDepth(), memOp.getDataType(), MemOp::PortKind::ReadWrite,
@@ -256,11 +260,16 @@ private:
   void getProductTerms(Value enValue, SmallVector<Value> &terms) {
     if (!enValue)
       return;
+    // The enable logic is a DAG, where terms are commonly shared by several
+    // AND expressions. Visit each term once.
+    DenseSet<Value> visited;
     SmallVector<Value> worklist;
     worklist.push_back(enValue);
     while (!worklist.empty()) {
       auto term = worklist.back();
       worklist.pop_back();
+      if (!visited.insert(term).second)
+        continue;
       terms.push_back(term);
       if (term.isa<BlockArgument>())
         continue;
@@ -20,6 +20,7 @@
 #include "circt/Support/FieldRef.h"
 #include "mlir/IR/Dominance.h"
 #include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/IR/Threading.h"
 #include "llvm/ADT/EquivalenceClasses.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/TinyPtrVector.h"
@@ -43,23 +44,14 @@ using namespace firrtl;
 // Utilities
 //===----------------------------------------------------------------------===//
 
-/// An absolute instance path.
-using InstancePathRef = ArrayRef<InstanceOp>;
-using InstancePathVec = SmallVector<InstanceOp>;
-
-template <typename T>
-static T &operator<<(T &os, InstancePathRef path) {
-  os << "$root";
-  for (InstanceOp inst : path)
-    os << "/" << inst.getName() << ":" << inst.getModuleName();
-  return os;
-}
+/// An absolute instance path.  Paths share their common prefixes.
+using InstancePath = CompactInstancePath;
 
 #ifndef NDEBUG
-static StringRef getTail(InstancePathRef path) {
+static StringRef getTail(InstancePath path) {
   if (path.empty())
     return "$root";
-  auto last = path.back();
+  auto last = cast<InstanceOp>(path.back());
   return last.getName();
 }
 #endif
@@ -438,16 +430,23 @@ struct InferResetsPass : public InferResetsBase<InferResetsPass> {
   LogicalResult collectAnnos(FModuleOp module);
 
   LogicalResult buildDomains(CircuitOp circuit);
-  void buildDomains(FModuleOp module, const InstancePathVec &instPath,
-                    Value parentReset, InstanceGraph &instGraph,
+  void buildDomains(FModuleOp module, InstancePath instPath,
+                    Value parentReset, InstancePathCache &instPaths,
                     unsigned indent = 0);
 
   void determineImpl();
   void determineImpl(FModuleOp module, ResetDomain &domain);
 
+  /// Instances that were replaced by a clone with an additional reset port,
+  /// and the clone that replaced them.
+  using ReplacedInstances = SmallVectorImpl<std::pair<InstanceOp, InstanceOp>>;
+
   LogicalResult implementAsyncReset();
-  LogicalResult implementAsyncReset(FModuleOp module, ResetDomain &domain);
-  void implementAsyncReset(Operation *op, FModuleOp module, Value actualReset);
+  LogicalResult implementAsyncReset(FModuleOp module, ResetDomain &domain,
+                                    ReplacedInstances &replacedInstances);
+  LogicalResult implementAsyncReset(Operation *op, FModuleOp module,
+                                    Value actualReset,
+                                    ReplacedInstances &replacedInstances);
 
   LogicalResult verifyNoAbstractReset();
 
@@ -488,9 +487,12 @@ struct InferResetsPass : public InferResetsBase<InferResetsPass> {
 
   /// The reset domain for a module. In case of conflicting domain membership,
   /// the vector for a module contains multiple elements.
-  MapVector<FModuleOp, SmallVector<std::pair<ResetDomain, InstancePathVec>, 1>>
+  MapVector<FModuleOp, SmallVector<std::pair<ResetDomain, InstancePath>, 1>>
       domains;
 
+  /// The storage of the instance paths in `domains`.
+  std::unique_ptr<InstancePathCache> instancePaths;
+
   /// Cache of modules symbols
   InstanceGraph *instanceGraph;
 };
@@ -502,6 +504,7 @@ void InferResetsPass::runOnOperation() {
   resetDrives.clear();
   annotatedResets.clear();
   domains.clear();
+  instancePaths.reset();
   markAnalysesPreserved<InstanceGraph>();
 }
 
@@ -1334,7 +1337,8 @@ LogicalResult InferResetsPass::buildDomains(CircuitOp circuit) {
                << "Skipping circuit because main module is no `firrtl.module`");
     return success();
   }
-  buildDomains(module, InstancePathVec{}, Value{}, instGraph);
+  instancePaths = std::make_unique<InstancePathCache>(instGraph);
+  buildDomains(module, InstancePath{}, Value{}, *instancePaths);
 
   // Report any domain conflicts among the modules.
   bool anyFailed = false;
@@ -1351,9 +1355,8 @@ LogicalResult InferResetsPass::buildDomains(CircuitOp circuit) {
                 << "' instantiated in different reset domains";
     for (auto &it : domainConflicts) {
       ResetDomain &domain = it.first;
-      InstancePathRef path = it.second;
-      auto inst = path.back();
-      auto loc = path.empty() ? module.getLoc() : inst.getLoc();
+      InstancePath path = it.second;
+      auto loc = path.empty() ? module.getLoc() : path.back().getLoc();
       auto &note = diag.attachNote(loc);
 
       // Describe the instance itself.
@@ -1361,8 +1364,11 @@ LogicalResult InferResetsPass::buildDomains(CircuitOp circuit) {
         note << "root instance";
       else {
         note << "instance '";
+        SmallVector<hw::HWInstanceLike, 8> instances;
+        path.toVector(instances);
         llvm::interleave(
-            path, [&](InstanceOp inst) { note << inst.getName(); },
+            instances,
+            [&](auto inst) { note << cast<InstanceOp>(inst).getName(); },
             [&]() { note << "/"; });
         note << "'";
       }
@@ -1388,9 +1394,9 @@ LogicalResult InferResetsPass::buildDomains(CircuitOp circuit) {
   return failure(anyFailed);
 }
 
-void InferResetsPass::buildDomains(FModuleOp module,
-                                   const InstancePathVec &instPath,
-                                   Value parentReset, InstanceGraph &instGraph,
+void InferResetsPass::buildDomains(FModuleOp module, InstancePath instPath,
+                                   Value parentReset,
+                                   InstancePathCache &instPaths,
                                    unsigned indent) {
   LLVM_DEBUG(llvm::dbgs().indent(indent * 2)
              << "Visiting " << getTail(instPath) << " (" << module.getName()
@@ -1413,14 +1419,13 @@ void InferResetsPass::buildDomains(FModuleOp module,
     entries.push_back({domain, instPath});
 
   // Traverse the child instances.
-  InstancePathVec childPath = instPath;
-  for (auto *record : *instGraph[module]) {
+  for (auto *record : *instPaths.instanceGraph[module]) {
     auto submodule = dyn_cast<FModuleOp>(*record->getTarget()->getModule());
     if (!submodule)
       continue;
-    childPath.push_back(cast<InstanceOp>(*record->getInstance()));
-    buildDomains(submodule, childPath, domain.reset, instGraph, indent + 1);
-    childPath.pop_back();
+    auto childPath = instPaths.appendInstance(
+        instPath, cast<hw::HWInstanceLike>(*record->getInstance()));
+    buildDomains(submodule, childPath, domain.reset, instPaths, indent + 1);
   }
 }
 
@@ -1517,13 +1522,32 @@ void InferResetsPass::determineImpl(FModuleOp module, ResetDomain &domain) {
 //===----------------------------------------------------------------------===//
 
 /// Implement the async resets gathered in the pass' `domains` map.
+///
+/// Each module only modifies its own body and ports, and only reads the reset
+/// domains of the modules it instantiates, so the modules are processed in
+/// parallel. The instance graph is not thread-safe, so instances replaced with
+/// a clone are recorded per module and swapped out in the graph afterwards.
 LogicalResult InferResetsPass::implementAsyncReset() {
   LLVM_DEBUG(llvm::dbgs() << "\n===----- Implement async resets -----===\n\n");
+  SmallVector<std::pair<FModuleOp, ResetDomain *>> worklist;
   for (auto &it : domains)
-    if (failed(implementAsyncReset(cast<FModuleOp>(it.first),
-                                   it.second.back().first)))
-      return failure();
-  return success();
+    worklist.push_back({it.first, &it.second.back().first});
+
+  SmallVector<SmallVector<std::pair<InstanceOp, InstanceOp>, 0>>
+      replacedInstances(worklist.size());
+  auto result = mlir::failableParallelForEachN(
+      &getContext(), 0, worklist.size(), [&](size_t i) {
+        auto [module, domain] = worklist[i];
+        return implementAsyncReset(module, *domain, replacedInstances[i]);
+      });
+
+  for (auto &replaced : replacedInstances) {
+    for (auto [oldInstOp, newInstOp] : replaced) {
+      instanceGraph->replaceInstance(oldInstOp, newInstOp);
+      oldInstOp->erase();
+    }
+  }
+  return result;
 }
 
 /// Implement the async resets for a specific module.
@@ -1531,8 +1555,9 @@ LogicalResult InferResetsPass::implementAsyncReset() {
 /// This will add ports to the module as appropriate, update the register ops in
 /// the module, and update any instantiated submodules with their corresponding
 /// reset implementation details.
-LogicalResult InferResetsPass::implementAsyncReset(FModuleOp module,
-                                                   ResetDomain &domain) {
+LogicalResult
+InferResetsPass::implementAsyncReset(FModuleOp module, ResetDomain &domain,
+                                     ReplacedInstances &replacedInstances) {
   LLVM_DEBUG(llvm::dbgs() << "Implementing async reset for " << module.getName()
                           << "\n");
 
@@ -1641,15 +1666,21 @@ LogicalResult InferResetsPass::implementAsyncReset(FModuleOp module,
   }
 
   // Update the operations.
+  bool anyFailed = false;
   for (auto *op : opsToUpdate)
-    implementAsyncReset(op, module, actualReset);
+    if (failed(implementAsyncReset(op, module, actualReset, replacedInstances)))
+      anyFailed = true;
 
-  return success();
+  return failure(anyFailed);
 }
 
 /// Modify an operation in a module to implement an async reset for that module.
-void InferResetsPass::implementAsyncReset(Operation *op, FModuleOp module,
-                                          Value actualReset) {
+/// Instances which need an additional reset port are cloned, and the original
+/// instance is left in place, without uses, and added to `replacedInstances`.
+LogicalResult
+InferResetsPass::implementAsyncReset(Operation *op, FModuleOp module,
+                                     Value actualReset,
+                                     ReplacedInstances &replacedInstances) {
   ImplicitLocOpBuilder builder(op->getLoc(), op);
 
   // Handle instances.
@@ -1660,13 +1691,13 @@ void InferResetsPass::implementAsyncReset(Operation *op, FModuleOp module,
     auto refModule =
         dyn_cast<FModuleOp>(*instanceGraph->getReferencedModule(instOp));
     if (!refModule)
-      return;
+      return success();
     auto domainIt = domains.find(refModule);
     if (domainIt == domains.end())
-      return;
+      return success();
     auto &domain = domainIt->second.back().first;
     if (!domain.reset)
-      return;
+      return success();
     LLVM_DEBUG(llvm::dbgs()
                << "- Update instance '" << instOp.getName() << "'\n");
 
@@ -1681,10 +1712,10 @@ void InferResetsPass::implementAsyncReset(Operation *op, FModuleOp module,
              Direction::In}}});
       instReset = newInstOp.getResult(0);
 
-      // Update the uses over to the new instance and drop the old instance.
+      // Update the uses over to the new instance. The old instance is dropped
+      // once all modules have been updated.
       instOp.replaceAllUsesWith(newInstOp.getResults().drop_front());
-      instanceGraph->replaceInstance(instOp, newInstOp);
-      instOp->erase();
+      replacedInstances.push_back({instOp, newInstOp});
       instOp = newInstOp;
     } else if (domain.existingPort.has_value()) {
       auto idx = domain.existingPort.value();
@@ -1696,19 +1727,19 @@ void InferResetsPass::implementAsyncReset(Operation *op, FModuleOp module,
     // happen if the instantiated module has a reset domain, but that domain is
     // e.g. rooted at an internal wire.
     if (!instReset)
-      return;
+      return success();
 
     // Connect the instance's reset to the actual reset.
     assert(instReset && actualReset);
     builder.setInsertionPointAfter(instOp);
     builder.create<StrictConnectOp>(instReset, actualReset);
-    return;
+    return success();
   }
 
   // Handle reset-less registers.
   if (auto regOp = dyn_cast<RegOp>(op)) {
     if (AnnotationSet::removeAnnotations(regOp, excludeMemToRegAnnoClass))
-      return;
+      return success();
 
     LLVM_DEBUG(llvm::dbgs() << "- Adding async reset to " << regOp << "\n");
     auto zero = createZeroValue(builder, regOp.getType());
@@ -1718,7 +1749,7 @@ void InferResetsPass::implementAsyncReset(Operation *op, FModuleOp module,
         regOp.getInnerSymAttr());
     regOp.getResult().replaceAllUsesWith(newRegOp);
     regOp->erase();
-    return;
+    return success();
   }
 
   // Handle registers with reset.
@@ -1729,9 +1760,7 @@ void InferResetsPass::implementAsyncReset(Operation *op, FModuleOp module,
                  << "- Skipping (has async reset) " << regOp << "\n");
       // The following performs the logic of `CheckResets` in the original Scala
       // source code.
-      if (failed(regOp.verifyInvariants()))
-        signalPassFailure();
-      return;
+      return regOp.verifyInvariants();
     }
     LLVM_DEBUG(llvm::dbgs() << "- Updating reset of " << regOp << "\n");
 
@@ -1752,6 +1781,7 @@ void InferResetsPass::implementAsyncReset(Operation *op, FModuleOp module,
     regOp.getResetSignalMutable().assign(actualReset);
     regOp.getResetValueMutable().assign(zero);
   }
+  return success();
 }
 
 LogicalResult InferResetsPass::verifyNoAbstractReset() {
@@ -18,8 +18,11 @@
 #include "circt/Dialect/FIRRTL/Passes.h"
 #include "circt/Support/FieldRef.h"
 #include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/IR/Threading.h"
 #include "llvm/ADT/APSInt.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/EquivalenceClasses.h"
 #include "llvm/ADT/GraphTraits.h"
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/MapVector.h"
@@ -119,6 +122,12 @@ struct VarExpr : public ExprBase<VarExpr, Expr::Kind::Var> {
   iterator begin() const { return &constraint; }
   iterator end() const { return &constraint + (constraint ? 1 : 0); }
 
+  /// The position of this variable within its independent group of variables,
+  /// assigned right before solving. The solver tracks the variables on the
+  /// current recursion path in a bit vector indexed by this. It fits into the
+  /// padding before `constraint` and does not grow the expression.
+  unsigned groupIndex = 0;
+
   /// The constraint expression this variable is supposed to be greater than or
   /// equal to. This is not part of the variable's hash and equality property.
   Expr *constraint = nullptr;
@@ -610,7 +619,7 @@ public:
   }
 
   void dumpConstraints(llvm::raw_ostream &os);
-  LogicalResult solve();
+  LogicalResult solve(MLIRContext *context);
 
   using ContextInfo = DenseMap<Expr *, llvm::SmallSetVector<FieldRef, 1>>;
   const ContextInfo &getContextInfo() const { return info; }
@@ -659,8 +668,11 @@ private:
 
   bool emitUninferredWidthError(VarExpr *var);
 
+  using VarGroups = std::vector<SmallVector<unsigned, 0>>;
+  VarGroups partitionVars();
+
   LinIneq checkCycles(VarExpr *var, Expr *expr,
-                      SmallPtrSetImpl<Expr *> &seenVars,
+                      llvm::BitVector &seenVars,
                       InFlightDiagnostic *reportInto = nullptr,
                       unsigned indent = 1);
 };
@@ -697,7 +709,7 @@ inline llvm::raw_ostream &operator<<(llvm::raw_ostream &os, const LinIneq &l) {
 /// additionally attach unsatisfiable inequalities as notes to the diagnostic as
 /// it encounters them.
 LinIneq ConstraintSolver::checkCycles(VarExpr *var, Expr *expr,
-                                      SmallPtrSetImpl<Expr *> &seenVars,
+                                      llvm::BitVector &seenVars,
                                       InFlightDiagnostic *reportInto,
                                       unsigned indent) {
   auto ineq =
@@ -706,19 +718,20 @@ LinIneq ConstraintSolver::checkCycles(VarExpr *var, Expr *expr,
           .Case<VarExpr>([&](auto *expr) {
             if (expr == var)
               return LinIneq(1, 0); // x >= 1*x + 0
-            if (!seenVars.insert(expr).second)
+            if (!expr->constraint)
+              // Count unconstrained variables as `x >= 0`.
+              return LinIneq(0);
+            if (seenVars.test(expr->groupIndex))
               // Count recursions in other variables as 0. This is sane
               // since the cycle is either breakable, in which case the
               // recursion does not modify the resulting value of the
               // variable, or it is not breakable and will be caught by
               // this very function once it is called on that variable.
               return LinIneq(0);
-            if (!expr->constraint)
-              // Count unconstrained variables as `x >= 0`.
-              return LinIneq(0);
+            seenVars.set(expr->groupIndex);
             auto l = checkCycles(var, expr->constraint, seenVars, reportInto,
                                  indent + 1);
-            seenVars.erase(expr);
+            seenVars.reset(expr->groupIndex);
             return l;
           })
           .Case<IdExpr>([&](auto *expr) {
@@ -806,12 +819,12 @@ computeBinary(ExprSolution lhs, ExprSolution rhs,
 }
 
 /// Compute the value of a constraint expression`expr`. `seenVars` is used as a
-/// recursion breaker. Recursive variables are treated as zero. Returns the
-/// computed value and a boolean indicating whether a recursion was detected.
-/// This may be used to memoize the result of expressions in case they were not
-/// involved in a cycle (which may alter their value from the perspective of a
-/// variable).
-static ExprSolution solveExpr(Expr *expr, SmallPtrSetImpl<Expr *> &seenVars,
+/// recursion breaker and is indexed by `VarExpr::groupIndex`. Recursive
+/// variables are treated as zero. Returns the computed value and a boolean
+/// indicating whether a recursion was detected. This may be used to memoize the
+/// result of expressions in case they were not involved in a cycle (which may
+/// alter their value from the perspective of a variable).
+static ExprSolution solveExpr(Expr *expr, llvm::BitVector &seenVars,
                               unsigned indent = 1) {
   // See if we have a memoized result we can return.
   if (expr->solution) {
@@ -840,10 +853,11 @@ static ExprSolution solveExpr(Expr *expr, SmallPtrSetImpl<Expr *> &seenVars,
             // Return no solution for recursions in the variables. This is sane
             // and will cause the expression to be ignored when computing the
             // parent, e.g. `a >= max(a, 1)` will become just `a >= 1`.
-            if (!seenVars.insert(expr).second)
+            if (seenVars.test(expr->groupIndex))
               return ExprSolution{llvm::None, true};
+            seenVars.set(expr->groupIndex);
             auto solution = solveExpr(expr->constraint, seenVars, indent + 1);
-            seenVars.erase(expr);
+            seenVars.reset(expr->groupIndex);
             // Constrain variables >= 0.
             if (solution.first && *solution.first < 0)
               solution.first = 0;
@@ -900,53 +914,111 @@ static ExprSolution solveExpr(Expr *expr, SmallPtrSetImpl<Expr *> &seenVars,
   return solution;
 }
 
+/// Partition the variables into groups that share no constraint expressions
+/// other than known constants. Solving a variable only visits and memoizes
+/// expressions within its group, so the groups can be solved independently.
+/// Each group lists the indices of its variables in `exprs`, in creation
+/// order, and each variable's `groupIndex` is set to its position in its group.
+ConstraintSolver::VarGroups ConstraintSolver::partitionVars() {
+  llvm::EquivalenceClasses<Expr *> classes;
+  for (auto *expr : exprs) {
+    if (isa<KnownExpr>(expr))
+      continue;
+    classes.insert(expr);
+    for (auto *child : *expr)
+      if (!isa<KnownExpr>(child))
+        classes.unionSets(expr, child);
+  }
+
+  VarGroups groups;
+  DenseMap<Expr *, unsigned> groupIndices;
+  for (unsigned i = 0, e = exprs.size(); i != e; ++i) {
+    if (!isa<VarExpr>(exprs[i]))
+      continue;
+    auto *leader = classes.getLeaderValue(exprs[i]);
+    auto it = groupIndices.try_emplace(leader, groups.size());
+    if (it.second)
+      groups.emplace_back();
+    auto &group = groups[it.first->second];
+    cast<VarExpr>(exprs[i])->groupIndex = group.size();
+    group.push_back(i);
+  }
+  return groups;
+}
+
 /// Solve the constraint problem. This is a very simple implementation that
 /// does not fully solve the problem if there are weird dependency cycles
-/// present.
-LogicalResult ConstraintSolver::solve() {
+/// present. Independent groups of variables are solved in parallel, and all
+/// diagnostics are emitted afterwards in variable creation order.
+LogicalResult ConstraintSolver::solve(MLIRContext *context) {
   LLVM_DEBUG({
     llvm::dbgs() << "\n===----- Constraints -----===\n\n";
     dumpConstraints(llvm::dbgs());
   });
 
+  // Solve the groups one at a time when debugging to keep the log readable.
+  auto groups = partitionVars();
+  bool parallel = true;
+  LLVM_DEBUG(parallel = false);
+  auto forEachGroup = [&](llvm::function_ref<void(ArrayRef<unsigned>)> fn) {
+    if (parallel)
+      mlir::parallelFor(context, 0, groups.size(),
+                        [&](size_t i) { fn(groups[i]); });
+    else
+      for (auto &group : groups)
+        fn(group);
+  };
+
   // Ensure that there are no adverse cycles around.
   LLVM_DEBUG(
       llvm::dbgs() << "\n===----- Checking for unbreakable loops -----===\n\n");
-  SmallPtrSet<Expr *, 16> seenVars;
-  bool anyFailed = false;
-
-  for (auto *expr : exprs) {
-    // Only work on variables.
-    auto *var = dyn_cast<VarExpr>(expr);
-    if (!var || !var->constraint)
-      continue;
-    LLVM_DEBUG(llvm::dbgs()
-               << "- Checking " << *var << " >= " << *var->constraint << "\n");
-
-    // Canonicalize the variable's constraint expression into a form that allows
-    // us to easily determine if any recursion leads to an unsatisfiable
-    // constraint. The `seenVars` set acts as a recursion breaker.
-    seenVars.insert(var);
-    auto ineq = checkCycles(var, var->constraint, seenVars);
-    seenVars.clear();
-
-    // If the constraint is satisfiable, we're done.
-    // TODO: It's possible that this result is already sufficient to arrive at a
-    // solution for the constraint, and the second pass further down is not
-    // necessary. This would require more proper handling of `MinExpr` in the
-    // cycle checking code.
-    if (ineq.sat()) {
+  std::vector<char> unbreakable(exprs.size(), false);
+  forEachGroup([&](ArrayRef<unsigned> group) {
+    llvm::BitVector seenVars(group.size());
+    for (auto index : group) {
+      auto *var = cast<VarExpr>(exprs[index]);
+      if (!var->constraint)
+        continue;
+      LLVM_DEBUG(llvm::dbgs() << "- Checking " << *var << " >= "
+                              << *var->constraint << "\n");
+
+      // Canonicalize the variable's constraint expression into a form that
+      // allows us to easily determine if any recursion leads to an
+      // unsatisfiable constraint. The `seenVars` set acts as a recursion
+      // breaker.
+      seenVars.set(var->groupIndex);
+      auto ineq = checkCycles(var, var->constraint, seenVars);
+      seenVars.reset(var->groupIndex);
+
+      // If the constraint is satisfiable, we're done.
+      // TODO: It's possible that this result is already sufficient to arrive
+      // at a solution for the constraint, and the second pass further down is
+      // not necessary. This would require more proper handling of `MinExpr` in
+      // the cycle checking code.
+      if (ineq.sat()) {
+        LLVM_DEBUG(llvm::dbgs()
+                   << "  = Breakable since " << ineq << " satisfiable\n");
+        continue;
+      }
       LLVM_DEBUG(llvm::dbgs()
-                 << "  = Breakable since " << ineq << " satisfiable\n");
-      continue;
+                 << "  = UNBREAKABLE since " << ineq << " unsatisfiable\n");
+      unbreakable[index] = true;
     }
+  });
 
-    // If we arrive here, the constraint is not satisfiable at all. To provide
-    // some guidance to the user, we call the cycle checking code again, but
-    // this time with an in-flight diagnostic to attach notes indicating
-    // unsatisfiable paths in the cycle.
-    LLVM_DEBUG(llvm::dbgs()
-               << "  = UNBREAKABLE since " << ineq << " unsatisfiable\n");
+  // If a constraint is not satisfiable at all, provide some guidance to the
+  // user by calling the cycle checking code again, but this time with an
+  // in-flight diagnostic to attach notes indicating unsatisfiable paths in the
+  // cycle.
+  size_t maxGroupSize = 0;
+  for (auto &group : groups)
+    maxGroupSize = std::max(maxGroupSize, group.size());
+  llvm::BitVector seenVars(maxGroupSize);
+  bool anyFailed = false;
+  for (unsigned i = 0, e = exprs.size(); i != e; ++i) {
+    if (!unbreakable[i])
+      continue;
+    auto *var = cast<VarExpr>(exprs[i]);
     anyFailed = true;
     for (auto fieldRef : info.find(var)->second) {
       // Depending on whether this value stems from an operation or not, create
@@ -958,9 +1030,9 @@ LogicalResult ConstraintSolver::solve() {
       diag << "is constrained to be wider than itself";
 
       // Re-run the cycle checking, but this time reporting into the diagnostic.
-      seenVars.insert(var);
+      seenVars.set(var->groupIndex);
       checkCycles(var, var->constraint, seenVars, &diag);
-      seenVars.clear();
+      seenVars.reset(var->groupIndex);
     }
   }
 
@@ -971,44 +1043,47 @@ LogicalResult ConstraintSolver::solve() {
 
   // Iterate over the constraint variables and solve each.
   LLVM_DEBUG(llvm::dbgs() << "\n===----- Solving constraints -----===\n\n");
-  for (auto *expr : exprs) {
-    // Only work on variables.
-    auto *var = dyn_cast<VarExpr>(expr);
-    if (!var)
-      continue;
+  std::vector<char> unsolved(exprs.size(), false);
+  forEachGroup([&](ArrayRef<unsigned> group) {
+    llvm::BitVector seenVars(group.size());
+    for (auto index : group) {
+      auto *var = cast<VarExpr>(exprs[index]);
+
+      // Complain about unconstrained variables.
+      if (!var->constraint) {
+        LLVM_DEBUG(llvm::dbgs() << "- Unconstrained " << *var << "\n");
+        unsolved[index] = true;
+        continue;
+      }
 
-    // Complain about unconstrained variables.
-    if (!var->constraint) {
-      LLVM_DEBUG(llvm::dbgs() << "- Unconstrained " << *var << "\n");
-      if (emitUninferredWidthError(var))
-        anyFailed = true;
-      continue;
+      // Compute the value for the variable.
+      LLVM_DEBUG(llvm::dbgs() << "- Solving " << *var << " >= "
+                              << *var->constraint << "\n");
+      seenVars.set(var->groupIndex);
+      auto solution = solveExpr(var->constraint, seenVars);
+      seenVars.reset(var->groupIndex);
+
+      // Constrain variables >= 0.
+      if (solution.first && *solution.first < 0)
+        solution.first = 0;
+
+      // In case the width could not be inferred, complain to the user. This
+      // might be the case if the width depends on an unconstrained variable.
+      if (!solution.first) {
+        LLVM_DEBUG(llvm::dbgs() << "  - UNSOLVED " << *var << "\n");
+        unsolved[index] = true;
+      } else {
+        LLVM_DEBUG(llvm::dbgs()
+                   << "  - Solved " << *var << " = " << solution.first << " ("
+                   << (solution.second ? "cycle broken" : "unique") << ")\n");
+      }
+      var->solution = solution.first;
     }
+  });
 
-    // Compute the value for the variable.
-    LLVM_DEBUG(llvm::dbgs()
-               << "- Solving " << *var << " >= " << *var->constraint << "\n");
-    seenVars.insert(var);
-    auto solution = solveExpr(var->constraint, seenVars);
-    seenVars.clear();
-
-    // Constrain variables >= 0.
-    if (solution.first && *solution.first < 0)
-      solution.first = 0;
-
-    // In case the width could not be inferred, complain to the user. This might
-    // be the case if the width depends on an unconstrained variable.
-    if (!solution.first) {
-      LLVM_DEBUG(llvm::dbgs() << "  - UNSOLVED " << *var << "\n");
-      if (emitUninferredWidthError(var))
-        anyFailed = true;
-    } else {
-      LLVM_DEBUG(llvm::dbgs()
-                 << "  - Solved " << *var << " = " << solution.first << " ("
-                 << (solution.second ? "cycle broken" : "unique") << ")\n");
-    }
-    var->solution = solution.first;
-  }
+  for (unsigned i = 0, e = exprs.size(); i != e; ++i)
+    if (unsolved[i] && emitUninferredWidthError(cast<VarExpr>(exprs[i])))
+      anyFailed = true;
 
   return failure(anyFailed);
 }
@@ -1120,7 +1195,9 @@ public:
   void setExpr(FieldRef fieldRef, Expr *expr);
 
   /// Return whether a module was skipped due to being fully inferred already.
-  bool isModuleSkipped(ModuleOp module) { return skippedModules.count(module); }
+  bool isModuleSkipped(FModuleOp module) {
+    return skippedModules.count(module);
+  }
 
   /// Return whether all modules in the mapping were fully inferred.
   bool areAllModulesSkipped() { return allModulesSkipped; }
@@ -1151,41 +1228,53 @@ static bool hasUninferredWidth(Type type) {
       .Default([](auto) { return false; });
 }
 
+/// Check if a module contains *any* uninferred widths in its ports or in the
+/// results of its operations.
+static bool hasUninferredWidth(FModuleOp module) {
+  for (auto arg : module.getArguments())
+    if (hasUninferredWidth(arg.getType()))
+      return true;
+  auto result = module.walk([&](Operation *op) {
+    for (auto type : op->getResultTypes())
+      if (hasUninferredWidth(type))
+        return WalkResult::interrupt();
+    return WalkResult::advance();
+  });
+  return result.wasInterrupted();
+}
+
 LogicalResult InferenceMapping::map(CircuitOp op) {
   LLVM_DEBUG(llvm::dbgs()
              << "\n===----- Mapping ops to constraint exprs -----===\n\n");
 
+  // Modules cannot be nested, so there is no need to walk into their bodies to
+  // find them.
+  SmallVector<FModuleOp> modules(op.getBodyBlock()->getOps<FModuleOp>());
+
   // Ensure we have constraint variables established for all module ports.
-  op.walk<WalkOrder::PostOrder>([&](FModuleOp module) {
+  for (auto module : modules) {
     for (auto arg : module.getArguments()) {
       solver.setCurrentContextInfo(FieldRef(arg, 0));
       declareVars(arg, module.getLoc());
     }
-    return WalkResult::skip(); // no need to look inside the module
+  }
+
+  // Find the modules which contain any uninferred widths. This allows us to
+  // skip modules that are already fully inferred, such that running the pass
+  // again after a few uninferred values were added only costs as much as the
+  // modules that contain them.
+  SmallVector<char> anyUninferred(modules.size());
+  mlir::parallelFor(op.getContext(), 0, modules.size(), [&](size_t i) {
+    anyUninferred[i] = hasUninferredWidth(modules[i]);
   });
 
   // Go through the module bodies and populate the constraint problem.
-  auto result = op.walk<WalkOrder::PostOrder>([&](FModuleOp module) {
-    // Check if the module contains *any* uninferred widths. This allows us to
-    // do an early skip if the module is already fully inferred.
-    bool anyUninferred = false;
-    for (auto arg : module.getArguments()) {
-      anyUninferred |= hasUninferredWidth(arg.getType());
-      if (anyUninferred)
-        break;
-    }
-    module.walk([&](Operation *op) {
-      for (auto type : op->getResultTypes())
-        anyUninferred |= hasUninferredWidth(type);
-      if (anyUninferred)
-        return WalkResult::interrupt();
-      return WalkResult::advance();
-    });
-    if (!anyUninferred) {
+  for (auto [module, uninferred] : llvm::zip(modules, anyUninferred)) {
+    if (!uninferred) {
       LLVM_DEBUG(llvm::dbgs() << "Skipping fully-inferred module '"
                               << module.getName() << "'\n");
       skippedModules.insert(module);
-      return WalkResult::skip();
+      continue;
     }
     allModulesSkipped = false;
 
@@ -1194,10 +1283,9 @@ LogicalResult InferenceMapping::map(CircuitOp op) {
     auto result = module.getBodyBlock()->walk(
         [&](Operation *op) { return WalkResult(mapOperation(op)); });
     if (result.wasInterrupted())
-      return WalkResult::interrupt();
-    return WalkResult::skip(); // walk above already visited module body
-  });
-  return failure(result.wasInterrupted());
+      return failure();
+  }
+  return success();
 }
 
 LogicalResult InferenceMapping::mapOperation(Operation *op) {
@@ -1799,7 +1887,7 @@ LogicalResult InferenceTypeUpdate::update(CircuitOp op) {
   anyFailed = false;
   op.walk<WalkOrder::PreOrder>([&](Operation *op) {
     // Skip this module if it had no widths to be inferred at all.
-    if (auto module = dyn_cast<ModuleOp>(op))
+    if (auto module = dyn_cast<FModuleOp>(op))
       if (mapping.isModuleSkipped(module))
         return WalkResult::skip();
 
@@ -2073,7 +2161,7 @@ void InferWidthsPass::runOnOperation() {
   }
 
   // Solve the constraints.
-  if (failed(solver.solve())) {
+  if (failed(solver.solve(&getContext()))) {
     signalPassFailure();
     return;
   }
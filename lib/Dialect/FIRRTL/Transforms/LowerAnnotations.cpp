@@ -36,34 +36,11 @@ using namespace circt;
 using namespace firrtl;
 using namespace chirrtl;
 
-/// Get annotations or an empty set of annotations.
-static ArrayAttr getAnnotationsFrom(Operation *op) {
-  if (auto annots = op->getAttrOfType<ArrayAttr>(getAnnotationAttrName()))
-    return annots;
-  return ArrayAttr::get(op->getContext(), {});
-}
-
-/// Construct the annotation array with a new thing appended.
-static ArrayAttr appendArrayAttr(ArrayAttr array, Attribute a) {
-  if (!array)
-    return ArrayAttr::get(a.getContext(), ArrayRef<Attribute>{a});
-  SmallVector<Attribute> old(array.begin(), array.end());
-  old.push_back(a);
-  return ArrayAttr::get(a.getContext(), old);
-}
-
-/// Update an ArrayAttribute by replacing one entry.
-static ArrayAttr replaceArrayAttrElement(ArrayAttr array, size_t elem,
-                                         Attribute newVal) {
-  SmallVector<Attribute> old(array.begin(), array.end());
-  old[elem] = newVal;
-  return ArrayAttr::get(array.getContext(), old);
-}
-
 /// Apply a new annotation to a resolved target.  This handles ports,
-/// aggregates, modules, wires, etc.
+/// aggregates, modules, wires, etc.  Annotations on anything but the circuit
+/// are queued in the state and written back to the IR at the end of the pass.
 static void addAnnotation(AnnoTarget ref, unsigned fieldIdx,
-                          ArrayRef<NamedAttribute> anno) {
+                          ArrayRef<NamedAttribute> anno, ApplyState &state) {
   auto *context = ref.getOp()->getContext();
   DictionaryAttr annotation;
   if (fieldIdx) {
@@ -78,25 +55,21 @@ static void addAnnotation(AnnoTarget ref, unsigned fieldIdx,
   }
 
   if (ref.isa<OpAnnoTarget>()) {
-    auto newAnno = appendArrayAttr(getAnnotationsFrom(ref.getOp()), annotation);
-    ref.getOp()->setAttr(getAnnotationAttrName(), newAnno);
+    // Other appliers update the circuit annotations directly, so keep these in
+    // order with them.
+    if (isa<CircuitOp>(ref.getOp())) {
+      AnnotationSet annos(ref.getOp());
+      annos.addAnnotations(annotation);
+      annos.applyToOperation(ref.getOp());
+      return;
+    }
+    state.pendingAnnotations.addAnnotation(ref.getOp(), annotation);
     return;
   }
 
   auto portRef = ref.cast<PortAnnoTarget>();
-  auto portAnnoRaw = ref.getOp()->getAttr(getPortAnnotationAttrName());
-  ArrayAttr portAnno = portAnnoRaw.dyn_cast_or_null<ArrayAttr>();
-  if (!portAnno || portAnno.size() != getNumPorts(ref.getOp())) {
-    SmallVector<Attribute> emptyPortAttr(
-        getNumPorts(ref.getOp()),
-        ArrayAttr::get(ref.getOp()->getContext(), {}));
-    portAnno = ArrayAttr::get(ref.getOp()->getContext(), emptyPortAttr);
-  }
-  portAnno = replaceArrayAttrElement(
-      portAnno, portRef.getPortNo(),
-      appendArrayAttr(portAnno[portRef.getPortNo()].dyn_cast<ArrayAttr>(),
-                      annotation));
-  ref.getOp()->setAttr("portAnnotations", portAnno);
+  state.pendingAnnotations.addPortAnnotation(ref.getOp(), portRef.getPortNo(),
+                                             annotation);
 }
 
 /// Make an anchor for a non-local annotation.  Use the expanded path to build
@@ -230,7 +203,7 @@ static LogicalResult applyWithoutTargetImpl(const AnnoPathValue &target,
           {StringAttr::get(anno.getContext(), "circt.nonlocal"), sym});
     }
   }
-  addAnnotation(target.ref, target.fieldIdx, newAnnoAttrs);
+  addAnnotation(target.ref, target.fieldIdx, newAnnoAttrs, state);
   return success();
 }
 
@@ -468,6 +441,13 @@ LogicalResult LowerAnnotationsPass::applyAnnotation(DictionaryAttr anno,
   if (!target)
     return mlir::emitError(state.circuit.getLoc())
            << "Unable to resolve target of annotation: " << anno;
+
+  // Annotations without a specific target, e.g. Grand Central or OMIR, may
+  // look at or restructure arbitrary parts of the circuit.  Make sure they see
+  // all the annotations applied so far.
+  if (target->ref.getOp() == state.circuit)
+    state.pendingAnnotations.applyToIR();
+
   if (record->applier(*target, anno, state).failed())
     return mlir::emitError(state.circuit.getLoc())
            << "Unable to apply annotation: " << anno;
@@ -507,12 +487,18 @@ void LowerAnnotationsPass::runOnOperation() {
   };
   InstancePathCache instancePathCache(getAnalysis<InstanceGraph>());
   ApplyState state{circuit, modules, addToWorklist, instancePathCache};
+
+  // Most annotations are resolved against named things inside modules.  Walk
+  // all modules up front, in parallel, rather than one at a time as the
+  // annotations that target them are encountered.
+  state.targetCaches.populateAll(circuit);
   LLVM_DEBUG(llvm::dbgs() << "Processing annotations:\n");
   while (!worklistAttrs.empty()) {
     auto attr = worklistAttrs.pop_back_val();
     if (applyAnnotation(attr, state).failed())
       ++numFailures;
   }
+  state.pendingAnnotations.applyToIR();
 
   // Update statistics
   numRawAnnotations += annotations.size();
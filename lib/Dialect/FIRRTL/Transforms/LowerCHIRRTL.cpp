@@ -643,6 +643,16 @@ void LowerCHIRRTLPass::visitUnhandledOp(Operation *op) {
 }
 
 void LowerCHIRRTLPass::runOnOperation() {
+  // Most modules do not contain any CHIRRTL memories. Check for them first, so
+  // that the visitor does not have to look up every operand of every operation
+  // in such modules.
+  auto result = getOperation().walk([](Operation *op) {
+    return isa<CombMemOp, SeqMemOp>(op) ? WalkResult::interrupt()
+                                        : WalkResult::advance();
+  });
+  if (!result.wasInterrupted())
+    return markAllAnalysesPreserved();
+
   // Walk the entire body of the module and dispatch the visitor on each
   // function.  This will replace all CHIRRTL memories and ports, and update all
   // uses.
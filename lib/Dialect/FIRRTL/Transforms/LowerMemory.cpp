@@ -190,10 +190,16 @@ FMemModuleOp
 LowerMemoryPass::getOrCreateMemModule(MemOp op, const FirMemory &summary,
                                       const SmallVectorImpl<PortInfo> &ports,
                                       bool shouldDedup) {
+  // The memory module, and the entry of the memory configuration file derived
+  // from it, do not record the read-under-write behavior. Memories which only
+  // differ in it are equivalent macros, so it is not part of the key.
+  auto key = summary;
+  key.readUnderWrite = 0;
+
   // Try to find a matching memory blackbox that we already created.  If
   // shouldDedup is true, we will just generate a new memory module.
   if (shouldDedup) {
-    auto it = memories.find(summary);
+    auto it = memories.find(key);
     if (it != memories.end())
       return it->second;
   }
@@ -205,7 +211,7 @@ LowerMemoryPass::getOrCreateMemModule(MemOp op, const FirMemory &summary,
   // Record the memory module.  We don't want to use this module for other
   // memories, then we don't add it to the table.
   if (shouldDedup)
-    memories[summary] = module;
+    memories[key] = module;
 
   return module;
 }
@@ -124,9 +124,28 @@ static bool containsBundleType(FIRRTLType type) {
       .Default([](auto groundType) { return false; });
 }
 
+/// A cache of `hasZeroBitWidth` results. Aggregates in generated designs can
+/// have thousands of leaf fields, and checking every value of such a type
+/// would walk the whole type each time.
+using ZeroBitWidthCache = DenseMap<Type, bool>;
+
+/// Return true if the type has zero bitwidth or contains a zero bitwidth field,
+/// reusing and updating previous results in `cache` if one is given.
+static bool hasZeroBitWidth(FIRRTLType type, ZeroBitWidthCache *cache) {
+  if (!cache)
+    return hasZeroBitWidth(type);
+  auto it = cache->find(type);
+  if (it != cache->end())
+    return it->second;
+  auto result = hasZeroBitWidth(type);
+  cache->insert({type, result});
+  return result;
+}
+
 /// Return true if we can preserve the type.
 static bool isPreservableAggregateType(Type type,
-                                       PreserveAggregate::PreserveMode mode) {
+                                       PreserveAggregate::PreserveMode mode,
+                                       ZeroBitWidthCache *cache = nullptr) {
   // Return false if no aggregate value is preserved.
   if (mode == PreserveAggregate::None)
     return false;
@@ -139,7 +158,7 @@ static bool isPreservableAggregateType(Type type,
   // We can a preserve the type iff (i) the type is not passive, (ii) the type
   // doesn't contain analog and (iii) type don't contain zero bitwidth.
   if (!firrtlType.isPassive() || firrtlType.containsAnalog() ||
-      hasZeroBitWidth(firrtlType))
+      hasZeroBitWidth(firrtlType, cache))
     return false;
 
   switch (mode) {
@@ -157,10 +176,11 @@ static bool isPreservableAggregateType(Type type,
 /// Peel one layer of an aggregate type into its components.  Type may be
 /// complex, but empty, in which case fields is empty, but the return is true.
 static bool peelType(Type type, SmallVectorImpl<FlatBundleFieldEntry> &fields,
-                     PreserveAggregate::PreserveMode mode) {
+                     PreserveAggregate::PreserveMode mode,
+                     ZeroBitWidthCache *cache = nullptr) {
   // If the aggregate preservation is enabled and the type is preservable,
   // then just return.
-  if (isPreservableAggregateType(type, mode))
+  if (isPreservableAggregateType(type, mode, cache))
     return false;
 
   if (auto refType = type.dyn_cast<RefType>())
@@ -436,6 +456,9 @@ private:
 
   // Set true if the lowering failed.
   bool encounteredError = false;
+
+  // Cache of which aggregate types contain zero bitwidth fields.
+  ZeroBitWidthCache zeroBitWidthCache;
 };
 } // namespace
 
@@ -563,7 +586,8 @@ bool TypeLoweringVisitor::lowerProducer(
     return false;
   SmallVector<FlatBundleFieldEntry, 8> fieldTypes;
 
-  if (!peelType(srcType, fieldTypes, aggregatePreservationMode))
+  if (!peelType(srcType, fieldTypes, aggregatePreservationMode,
+                &zeroBitWidthCache))
     return false;
 
   // If an aggregate value has a symbol, emit errors.
@@ -719,7 +743,8 @@ bool TypeLoweringVisitor::lowerArg(FModuleLike module, size_t argIndex,
   // Flatten any bundle types.
   SmallVector<FlatBundleFieldEntry> fieldTypes;
   auto srcType = newArgs[argIndex].type.cast<FIRRTLType>();
-  if (!peelType(srcType, fieldTypes, getPreservatinoModeForModule(module)))
+  if (!peelType(srcType, fieldTypes, getPreservatinoModeForModule(module),
+                &zeroBitWidthCache))
     return false;
 
   for (const auto &field : llvm::enumerate(fieldTypes)) {
@@ -769,15 +794,17 @@ void TypeLoweringVisitor::lowerSAWritePath(Operation *op,
 
 static bool
 canLowerConnect(FConnectLike op,
-                PreserveAggregate::PreserveMode aggregatePreservationMode) {
+                PreserveAggregate::PreserveMode aggregatePreservationMode,
+                ZeroBitWidthCache &cache) {
   auto destType = op.getDest().getType();
   return !(destType.isa<RefType>() &&
-           isPreservableAggregateType(destType, aggregatePreservationMode));
+           isPreservableAggregateType(destType, aggregatePreservationMode,
+                                      &cache));
 }
 
 // Expand connects of aggregates
 bool TypeLoweringVisitor::visitStmt(ConnectOp op) {
-  if (!canLowerConnect(op, aggregatePreservationMode))
+  if (!canLowerConnect(op, aggregatePreservationMode, zeroBitWidthCache))
     return false;
   if (processSAPath(op))
     return true;
@@ -802,7 +829,7 @@ bool TypeLoweringVisitor::visitStmt(ConnectOp op) {
 
 // Expand connects of aggregates
 bool TypeLoweringVisitor::visitStmt(StrictConnectOp op) {
-  if (!canLowerConnect(op, aggregatePreservationMode))
+  if (!canLowerConnect(op, aggregatePreservationMode, zeroBitWidthCache))
     return false;
   if (processSAPath(op))
     return true;
@@ -1219,7 +1246,7 @@ bool TypeLoweringVisitor::visitDecl(InstanceOp op) {
 
     // Flatten any nested bundle types the usual way.
     SmallVector<FlatBundleFieldEntry, 8> fieldTypes;
-    if (!peelType(srcType, fieldTypes, mode)) {
+    if (!peelType(srcType, fieldTypes, mode, &zeroBitWidthCache)) {
       newDirs.push_back(op.getPortDirection(i));
       newNames.push_back(op.getPortName(i));
       resultTypes.push_back(srcType);
@@ -1295,6 +1322,12 @@ bool TypeLoweringVisitor::visitExpr(SubaccessOp op) {
     return true;
   }
 
+  // Dynamic indexing into a preserved vector is kept, LowerToHW lowers it to a
+  // single array index instead of a mux over every element.
+  if (isPreservableAggregateType(vType, aggregatePreservationMode,
+                                 &zeroBitWidthCache))
+    return false;
+
   // Construct a multibit mux
   SmallVector<Value> inputs;
   inputs.reserve(vType.getNumElements());
@@ -237,30 +237,9 @@ class LowerXMRPass : public LowerXMRBase<LowerXMRPass> {
     auto remoteOpPath = getRemoteRefSend(resolve.getRef());
     if (!remoteOpPath)
       return failure();
-    SmallVector<Attribute> refSendPath;
-    // Verbatim XMR begins with the Top level module.
-    refSendPath.push_back(refSendPathList[remoteOpPath.value()]
-                              .first.cast<InnerRefAttr>()
-                              .getModuleRef());
-    SmallString<128> xmrString;
-    Attribute lastInnerRef;
-    size_t lastIndex;
-    unsigned index = 0;
-    for (; remoteOpPath; ++index) {
-      lastIndex = remoteOpPath.value();
-      auto entr = refSendPathList[remoteOpPath.value()];
-      refSendPath.push_back(entr.first);
-      lastInnerRef = entr.first;
-      remoteOpPath = entr.second;
-      ("{{" + Twine(index) + "}}").toVector(xmrString);
-      xmrString += '.';
-    }
-    ("{{" + Twine(index) + "}}").toVector(xmrString);
-    auto iter = xmrPathSuffix.find(lastIndex);
-    // If this xmr has a suffix string (internal path into a module, that is not
-    // yet generated).
-    if (iter != xmrPathSuffix.end())
-      xmrString += ("." + iter->getSecond()).str();
+    const auto &xmrPath = getXMRPath(remoteOpPath.value());
+    auto xmrString = xmrPath.text.getValue();
+    auto refSendPath = xmrPath.symbols;
     if (auto vec = resolve.getResult().getType().dyn_cast<FVectorType>()) {
       // If the RefType is a vector, then replace all its users with [i] suffix,
       // instead of creatign a temp wire to the vector xmr, and then followup
@@ -271,7 +250,8 @@ class LowerXMRPass : public LowerXMRBase<LowerXMRPass> {
           auto index = sub.getIndex();
           ImplicitLocOpBuilder builder(sub.getLoc(), sub);
           auto xmrVerbatim = builder.create<VerbatimExprOp>(
-              vec.getElementType(), xmrString + "[" + Twine(index) + "]",
+              vec.getElementType(),
+              builder.getStringAttr(xmrString + "[" + Twine(index) + "]"),
               ValueRange{}, refSendPath);
           sub.getResult().replaceAllUsesWith(xmrVerbatim);
           opsToRemove.push_back(sub);
@@ -286,13 +266,55 @@ class LowerXMRPass : public LowerXMRBase<LowerXMRPass> {
     // replace the RefResolveOp with the coresponding VerbatimExpr to
     // generate the XMR.
     ImplicitLocOpBuilder builder(resolve.getLoc(), resolve);
-    auto xmrVerbatim =
-        builder.create<VerbatimExprOp>(resolve.getType().cast<FIRRTLType>(),
-                                       xmrString, ValueRange{}, refSendPath);
+    auto xmrVerbatim = builder.create<VerbatimExprOp>(
+        resolve.getType().cast<FIRRTLType>(), xmrPath.text, ValueRange{},
+        refSendPath);
     resolve.getResult().replaceAllUsesWith(xmrVerbatim);
     return success();
   }
 
+  /// The verbatim text and symbols of an XMR.
+  struct XMRPath {
+    StringAttr text;
+    ArrayAttr symbols;
+  };
+
+  /// Get the XMR text and the symbols it refers to for the path starting at
+  /// the refSendPathList entry 'pathIndex'. Paths are shared by every
+  /// RefResolveOp reached by the same entry, so they are only built once.
+  const XMRPath &getXMRPath(size_t pathIndex) {
+    auto it = xmrPaths.find(pathIndex);
+    if (it != xmrPaths.end())
+      return it->second;
+
+    SmallVector<Attribute> refSendPath;
+    // Verbatim XMR begins with the Top level module.
+    refSendPath.push_back(
+        refSendPathList[pathIndex].first.cast<InnerRefAttr>().getModuleRef());
+    SmallString<128> xmrString;
+    size_t lastIndex = pathIndex;
+    unsigned index = 0;
+    for (Optional<size_t> remoteOpPath = pathIndex; remoteOpPath; ++index) {
+      lastIndex = remoteOpPath.value();
+      const auto &entr = refSendPathList[lastIndex];
+      refSendPath.push_back(entr.first);
+      remoteOpPath = entr.second;
+      ("{{" + Twine(index) + "}}").toVector(xmrString);
+      xmrString += '.';
+    }
+    ("{{" + Twine(index) + "}}").toVector(xmrString);
+    auto iter = xmrPathSuffix.find(lastIndex);
+    // If this xmr has a suffix string (internal path into a module, that is not
+    // yet generated).
+    if (iter != xmrPathSuffix.end())
+      xmrString += ("." + iter->getSecond()).str();
+
+    auto *context = &getContext();
+    XMRPath xmrPath{StringAttr::get(context, xmrString),
+                    ArrayAttr::get(context, refSendPath)};
+    return xmrPaths.insert({pathIndex, xmrPath}).first->second;
+  }
+
   void setPortToRemove(Operation *op, size_t index, size_t numPorts) {
     if (refPortsToRemoveMap[op].size() < numPorts)
       refPortsToRemoveMap[op].resize(numPorts);
@@ -497,6 +519,7 @@ class LowerXMRPass : public LowerXMRBase<LowerXMRPass> {
     refPortsToRemoveMap.clear();
     dataflowAt.clear();
     refSendPathList.clear();
+    xmrPaths.clear();
   }
 
   /// Cached module namespaces.
@@ -537,6 +560,9 @@ class LowerXMRPass : public LowerXMRBase<LowerXMRPass> {
 
   /// Record the internal path to an external module or a memory.
   DenseMap<size_t, SmallString<128>> xmrPathSuffix;
+
+  /// Cache of the XMRs built for an entry of refSendPathList.
+  DenseMap<size_t, XMRPath> xmrPaths;
 };
 
 std::unique_ptr<mlir::Pass> circt::firrtl::createLowerXMRPass() {
@@ -31,8 +31,11 @@ using namespace firrtl;
 
 namespace {
 struct MemToRegOfVecPass : public MemToRegOfVecBase<MemToRegOfVecPass> {
-  MemToRegOfVecPass(bool replSeqMem, bool ignoreReadEnable)
-      : replSeqMem(replSeqMem), ignoreReadEnable(ignoreReadEnable){};
+  MemToRegOfVecPass(bool replSeqMem, bool ignoreReadEnable,
+                    uint64_t maxMemorySize)
+      : replSeqMem(replSeqMem), ignoreReadEnable(ignoreReadEnable) {
+    this->maxMemorySize = maxMemorySize;
+  };
 
   void runOnOperation() override {
     auto circtOp = getOperation();
@@ -81,6 +84,12 @@ struct MemToRegOfVecPass : public MemToRegOfVecBase<MemToRegOfVecPass> {
            (firMem.numReadPorts <= 1) && firMem.dataWidth > 0))
         return;
 
+      // Keep large memories as memories. A vector of registers with write
+      // logic for every element blows up the IR and slows down simulation,
+      // whereas a memory is lowered to a single array register.
+      if (maxMemorySize && firMem.depth * firMem.dataWidth > maxMemorySize)
+        return;
+
       generateMemory(memOp, firMem);
       ++numConvertedMems;
       memOp.erase();
@@ -445,6 +454,8 @@ private:
 } // end anonymous namespace
 
 std::unique_ptr<mlir::Pass>
-circt::firrtl::createMemToRegOfVecPass(bool replSeqMem, bool ignoreReadEnable) {
-  return std::make_unique<MemToRegOfVecPass>(replSeqMem, ignoreReadEnable);
+circt::firrtl::createMemToRegOfVecPass(bool replSeqMem, bool ignoreReadEnable,
+                                       uint64_t maxMemorySize) {
+  return std::make_unique<MemToRegOfVecPass>(replSeqMem, ignoreReadEnable,
+                                             maxMemorySize);
 }
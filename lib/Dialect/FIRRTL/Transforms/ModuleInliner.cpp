@@ -543,11 +543,21 @@ private:
   /// Flattens a target module into the insertion point of the builder,
   /// renaming all operations using the prefix.  This clones all operations from
   /// the target, and does not trigger inlining on the target itself.
+  /// The NLAs added to `localSymbols` while flattening the target are removed
+  /// again before returning.
   void flattenInto(StringRef prefix, OpBuilder &b, BlockAndValueMapping &mapper,
                    BackedgeBuilder &beb, SmallVectorImpl<Backedge> &edges,
-                   FModuleOp target, DenseSet<Attribute> localSymbols,
+                   FModuleOp target, DenseSet<Attribute> &localSymbols,
                    ModuleNamespace &moduleNamespace);
 
+  /// Return the NLAs which originate from the given module.
+  ArrayRef<Attribute> getRootedNLAs(StringAttr moduleName) const {
+    auto it = rootMap.find(moduleName);
+    if (it == rootMap.end())
+      return {};
+    return it->second;
+  }
+
   /// Inlines a target module into the insertion point of the builder,
   /// prefixing all operations with prefix.  This clones all operations from
   /// the target, and does not trigger inlining on the target itself.
@@ -571,8 +581,13 @@ private:
   /// parent, and on the current instance. Also HierPaths that are rooted at
   /// this module are also added to the active set.
   void setActiveHierPaths(StringAttr moduleName, StringAttr instInnerSym) {
-    auto &instPaths =
-        instOpHierPaths[InnerRefAttr::get(moduleName, instInnerSym)];
+    ArrayRef<StringAttr> instPaths;
+    if (instInnerSym) {
+      auto it =
+          instOpHierPaths.find(InnerRefAttr::get(moduleName, instInnerSym));
+      if (it != instOpHierPaths.end())
+        instPaths = it->second;
+    }
     if (currentPath.empty()) {
       activeHierpaths.insert(instPaths.begin(), instPaths.end());
       return;
@@ -865,11 +880,14 @@ bool Inliner::shouldInline(Operation *op) {
 void Inliner::flattenInto(StringRef prefix, OpBuilder &b,
                           BlockAndValueMapping &mapper, BackedgeBuilder &beb,
                           SmallVectorImpl<Backedge> &edges, FModuleOp target,
-                          DenseSet<Attribute> localSymbols,
+                          DenseSet<Attribute> &localSymbols,
                           ModuleNamespace &moduleNamespace) {
   auto moduleName = target.getNameAttr();
   DenseMap<Attribute, Attribute> symbolRenames;
   SmallVector<Value> wires;
+  // The NLAs this call added to `localSymbols`, which are only local within
+  // the flattened target.
+  SmallVector<Attribute> addedLocalSymbols;
   for (auto &op : *target.getBodyBlock()) {
     // If it's not an instance op, clone it and continue.
     auto instance = dyn_cast<InstanceOp>(op);
@@ -892,7 +910,9 @@ void Inliner::flattenInto(StringRef prefix, OpBuilder &b,
     // Add any NLAs which start at this instance to the localSymbols set.
     // Anything in this set will be made local during the recursive flattenInto
     // walk.
-    llvm::set_union(localSymbols, rootMap[childModule.getNameAttr()]);
+    for (auto sym : getRootedNLAs(childModule.getNameAttr()))
+      if (localSymbols.insert(sym).second)
+        addedLocalSymbols.push_back(sym);
     auto instInnerSym = getInnerSymName(instance);
     auto parentActivePaths = activeHierpaths;
     setActiveHierPaths(moduleName, instInnerSym);
@@ -911,6 +931,9 @@ void Inliner::flattenInto(StringRef prefix, OpBuilder &b,
     activeHierpaths = parentActivePaths;
     wires.clear();
   }
+
+  for (auto sym : addedLocalSymbols)
+    localSymbols.erase(sym);
 }
 
 void Inliner::flattenInstances(FModuleOp module) {
@@ -948,8 +971,8 @@ void Inliner::flattenInstances(FModuleOp module) {
     // Add any NLAs which start at this instance to the localSymbols set.
     // Anything in this set will be made local during the recursive flattenInto
     // walk.
-    DenseSet<Attribute> localSymbols;
-    llvm::set_union(localSymbols, rootMap[target.getNameAttr()]);
+    auto rootedNLAs = getRootedNLAs(target.getNameAttr());
+    DenseSet<Attribute> localSymbols(rootedNLAs.begin(), rootedNLAs.end());
     auto instInnerSym = getInnerSymName(instance);
     auto parentActivePaths = activeHierpaths;
     setActiveHierPaths(moduleName, instInnerSym);
@@ -1038,8 +1061,8 @@ void Inliner::inlineInto(StringRef prefix, OpBuilder &b,
     // add an annotation on the instance saying that this now participates in
     // this new NLA.
     DenseMap<Attribute, Attribute> symbolRenames;
-    if (!rootMap[childModule.getNameAttr()].empty()) {
-      for (auto sym : rootMap[childModule.getNameAttr()]) {
+    if (!getRootedNLAs(childModule.getNameAttr()).empty()) {
+      for (auto sym : getRootedNLAs(childModule.getNameAttr())) {
         auto &mnla = nlaMap[sym];
         sym = mnla.reTop(target);
         StringAttr instSym = getInnerSymName(instance);
@@ -1070,8 +1093,9 @@ void Inliner::inlineInto(StringRef prefix, OpBuilder &b,
 
     // Inline the module, it can be marked as flatten and inline.
     if (toBeFlattened) {
-      flattenInto(nestedPrefix, b, mapper, beb, edges, childModule, {},
-                  moduleNamespace);
+      DenseSet<Attribute> localSymbols;
+      flattenInto(nestedPrefix, b, mapper, beb, edges, childModule,
+                  localSymbols, moduleNamespace);
     } else {
       inlineInto(nestedPrefix, b, mapper, beb, edges, childModule,
                  symbolRenames, moduleNamespace);
@@ -1132,8 +1156,8 @@ void Inliner::inlineInstances(FModuleOp parent) {
     // participate in any HierPathOp. But the reTop might add a symbol to it, if
     // a HierPathOp is added to this Op.
     DenseMap<Attribute, Attribute> symbolRenames;
-    if (!rootMap[target.getNameAttr()].empty()) {
-      for (auto sym : rootMap[target.getNameAttr()]) {
+    if (!getRootedNLAs(target.getNameAttr()).empty()) {
+      for (auto sym : getRootedNLAs(target.getNameAttr())) {
         auto &mnla = nlaMap[sym];
         sym = mnla.reTop(parent);
         StringAttr instSym = getInnerSymName(instance);
@@ -1167,7 +1191,8 @@ void Inliner::inlineInstances(FModuleOp parent) {
 
     // Inline the module, it can be marked as flatten and inline.
     if (toBeFlattened) {
-      flattenInto(nestedPrefix, b, mapper, beb, edges, target, {},
+      DenseSet<Attribute> localSymbols;
+      flattenInto(nestedPrefix, b, mapper, beb, edges, target, localSymbols,
                   moduleNamespace);
     } else {
       inlineInto(nestedPrefix, b, mapper, beb, edges, target, symbolRenames,
@@ -12,6 +12,7 @@
 #include "circt/Dialect/FIRRTL/FIRRTLInstanceGraph.h"
 #include "circt/Dialect/FIRRTL/Passes.h"
 #include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/IR/Threading.h"
 #include "llvm/ADT/APSInt.h"
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/PostOrderIterator.h"
@@ -23,180 +24,335 @@ using namespace circt;
 using namespace firrtl;
 
 namespace {
+/// The ports removed from a module, and how the instances of the module are
+/// rewritten.
+struct PortSummary {
+  /// The ports which are removed.
+  llvm::BitVector removedPorts;
+  /// The removed output ports which are used within the module, but not by
+  /// any instance of it. They are replaced with a wire within the module.
+  llvm::BitVector unusedOutputs;
+  /// The output ports which are undriven or only driven by a constant or an
+  /// invalid value, and the value which replaces them at every instance. None
+  /// indicates an invalid value.
+  DenseMap<unsigned, Optional<APSInt>> outputConstants;
+};
+
 struct RemoveUnusedPortsPass
     : public RemoveUnusedPortsBase<RemoveUnusedPortsPass> {
   void runOnOperation() override;
+  bool isRemovalCandidate(FModuleOp module, unsigned index);
+  void computeDrivenPorts(FModuleOp module, PortSummary &summary);
+  void computeUnusedOutputs(FModuleOp module,
+                            InstanceGraphNode *instanceGraphNode,
+                            PortSummary &summary);
+  void rewriteInstance(InstanceOp instance, const PortSummary &summary);
   void removeUnusedModulePorts(FModuleOp module,
                                InstanceGraphNode *instanceGraphNode);
 
+  /// Return the summary of the module instantiated by `instance`, or null if
+  /// it is not a module whose ports may be removed.
+  const PortSummary *lookupSummary(InstanceOp instance) {
+    auto it = summaries.find(instanceGraph->getReferencedModule(instance));
+    if (it == summaries.end())
+      return nullptr;
+    return &it->second;
+  }
+
   /// If true, the pass will remove unused ports even if they have carry a
   /// symbol or annotations. This is likely to break the IR, but may be useful
   /// for `circt-reduce` where preserving functional correctness of the IR is
   /// not important.
   bool ignoreDontTouch = false;
+
+  InstanceGraph *instanceGraph = nullptr;
+
+  /// The summary of every module. The entries are created up front, such that
+  /// the modules can be handled in parallel without modifying the map.
+  DenseMap<Operation *, PortSummary> summaries;
 };
 } // namespace
 
 void RemoveUnusedPortsPass::runOnOperation() {
-  auto &instanceGraph = getAnalysis<InstanceGraph>();
+  instanceGraph = &getAnalysis<InstanceGraph>();
   LLVM_DEBUG(llvm::dbgs() << "===----- Remove unused ports -----==="
                           << "\n");
-  // Iterate in the reverse order of instance graph iterator, i.e. from leaves
-  // to top.
-  for (auto *node : llvm::post_order(&instanceGraph))
-    if (auto module = dyn_cast<FModuleOp>(*node->getModule()))
-      // Don't prune the main module.
-      if (!module.isPublic())
-        removeUnusedModulePorts(module, node);
+
+  summaries.clear();
+  SmallVector<std::pair<FModuleOp, InstanceGraphNode *>, 0> modules;
+  for (auto *node : llvm::post_order(instanceGraph)) {
+    if (auto module = dyn_cast<FModuleOp>(*node->getModule())) {
+      auto &summary = summaries[module];
+      summary.removedPorts.resize(module.getNumPorts());
+      summary.unusedOutputs.resize(module.getNumPorts());
+      modules.push_back({module, node});
+    }
+  }
+
+  // Determine the ports to remove before touching the IR, such that removals
+  // cascade through the entire hierarchy in a single run. An input port can
+  // be removed if it is only connected to removed input ports of instances,
+  // and an output port inherits the constant driving it from an instance.
+  // This is propagated from the leaves to the top. Conversely, an output port
+  // is unused if it is only connected to unused output ports at all of its
+  // instances, which is propagated from the top to the leaves. The modules of
+  // each level of the instance graph are handled in parallel.
+  instanceGraph->parallelForEachModule(
+      /*bottomUp=*/true, [&](InstanceGraphNode *node) {
+        auto it = summaries.find(node->getModule());
+        if (it != summaries.end())
+          computeDrivenPorts(cast<FModuleOp>(it->first), it->second);
+      });
+  instanceGraph->parallelForEachModule(
+      /*bottomUp=*/false, [&](InstanceGraphNode *node) {
+        auto it = summaries.find(node->getModule());
+        if (it != summaries.end())
+          computeUnusedOutputs(cast<FModuleOp>(it->first), node, it->second);
+      });
+
+  // Every module rewrites its own body: the instances within it, and its own
+  // ports. This does not touch any other module and is done in parallel.
+  mlir::parallelForEach(&getContext(), modules, [&](auto &moduleAndNode) {
+    removeUnusedModulePorts(moduleAndNode.first, moduleAndNode.second);
+  });
+  summaries.clear();
 }
 
-void RemoveUnusedPortsPass::removeUnusedModulePorts(
-    FModuleOp module, InstanceGraphNode *instanceGraphNode) {
-  LLVM_DEBUG(llvm::dbgs() << "Prune ports of module: " << module.getName()
-                          << "\n");
-  // This tracks constant values of output ports. None indicates an invalid
-  // value.
-  SmallVector<llvm::Optional<APSInt>> outputPortConstants;
-  auto ports = module.getPorts();
-  // This tracks port indexes that can be erased.
-  llvm::BitVector removalPortIndexes(ports.size());
-
-  for (const auto &e : llvm::enumerate(ports)) {
-    unsigned index = e.index();
-    auto port = e.value();
+/// Return true if the port of a module may be removed at all.
+bool RemoveUnusedPortsPass::isRemovalCandidate(FModuleOp module,
+                                               unsigned index) {
+  // Don't prune the main module.
+  if (module.isPublic())
+    return false;
+
+  // If the port is don't touch or has unprocessed annotations, we cannot
+  // remove the port. Maybe we can allow annotations though.
+  auto arg = module.getArgument(index);
+  if ((hasDontTouch(arg) || !AnnotationSet::forPort(module, index).empty()) &&
+      !ignoreDontTouch)
+    return false;
+
+  // TODO: Handle inout ports.
+  return module.getPortDirection(index) != Direction::InOut;
+}
+
+/// Determine the input ports which are unused once the removed ports of all
+/// instances within the module are gone, and the output ports which are
+/// undriven or driven by a constant or invalid value.
+void RemoveUnusedPortsPass::computeDrivenPorts(FModuleOp module,
+                                               PortSummary &summary) {
+  for (unsigned index = 0, e = module.getNumPorts(); index < e; ++index) {
+    if (!isRemovalCandidate(module, index))
+      continue;
     auto arg = module.getArgument(index);
 
-    // If the port is don't touch or has unprocessed annotations, we cannot
-    // remove the port. Maybe we can allow annotations though.
-    if ((hasDontTouch(arg) || !port.annotations.empty()) && !ignoreDontTouch)
+    // An input port can be removed if it is unused, or only drives removed
+    // input ports of instances. Those connects are erased with the ports.
+    if (module.getPortDirection(index) == Direction::In) {
+      bool removable = llvm::all_of(arg.getUsers(), [&](Operation *op) {
+        auto connect = dyn_cast<FConnectLike>(op);
+        if (!connect || connect.getSrc() != arg)
+          return false;
+        auto result = connect.getDest().dyn_cast<OpResult>();
+        if (!result)
+          return false;
+        auto instance = dyn_cast<InstanceOp>(result.getOwner());
+        if (!instance)
+          return false;
+        auto *childSummary = lookupSummary(instance);
+        if (!childSummary ||
+            !childSummary->removedPorts.test(result.getResultNumber()))
+          return false;
+        // Sometimes input ports are used as temporary wires. In that case, the
+        // connections to the instance port are not erased.
+        return llvm::all_of(result.getUsers(), [&](Operation *user) {
+          if (auto connect = dyn_cast<FConnectLike>(user))
+            return connect.getDest() == result;
+          return false;
+        });
+      });
+      if (removable)
+        summary.removedPorts.set(index);
+      continue;
+    }
+
+    // Sometimes the connection is already removed possibly by IMCP. In that
+    // case, regard the port value as an invalid value.
+    if (arg.use_empty()) {
+      summary.outputConstants[index] = None;
       continue;
+    }
 
-    // TODO: Handle inout ports.
-    if (port.isInOut())
+    // If the port has a single use, check the port is only connected to
+    // invalid or constant, or to an instance port which is.
+    if (!arg.hasOneUse())
+      continue;
+    auto connect = dyn_cast<FConnectLike>(*arg.getUsers().begin());
+    if (!connect)
+      continue;
+    auto src = connect.getSrc();
+    if (auto constant = src.getDefiningOp<ConstantOp>()) {
+      summary.outputConstants[index] = constant.getValue();
       continue;
+    }
+    if (src.getDefiningOp<InvalidValueOp>()) {
+      summary.outputConstants[index] = None;
+      continue;
+    }
+    if (auto instance = src.getDefiningOp<InstanceOp>()) {
+      if (auto *childSummary = lookupSummary(instance)) {
+        auto it = childSummary->outputConstants.find(
+            src.cast<OpResult>().getResultNumber());
+        if (it != childSummary->outputConstants.end())
+          summary.outputConstants[index] = it->second;
+      }
+    }
+  }
+}
 
-    // If the port is input and has an user, we cannot remove the
-    // port.
-    if (port.isInput() && !arg.use_empty())
+/// Determine the output ports which are not used by any instance of the
+/// module, and finalize the set of removed output ports.
+void RemoveUnusedPortsPass::computeUnusedOutputs(
+    FModuleOp module, InstanceGraphNode *instanceGraphNode,
+    PortSummary &summary) {
+  for (unsigned index = 0, e = module.getNumPorts(); index < e; ++index) {
+    if (module.getPortDirection(index) != Direction::Out ||
+        !isRemovalCandidate(module, index))
       continue;
+    auto arg = module.getArgument(index);
 
-    auto portIsUnused = [&](InstanceRecord *a) -> bool {
-      auto port = a->getInstance()->getResult(arg.getArgNumber());
-      return port.getUses().empty();
+    // An instance port is unused if it only drives unused output ports of the
+    // parent module, which are replaced with wires.
+    auto portIsUnused = [&](InstanceRecord *record) -> bool {
+      auto port = record->getInstance()->getResult(index);
+      auto parent = record->getParent()->getModule();
+      return llvm::all_of(port.getUsers(), [&](Operation *op) {
+        auto connect = dyn_cast<FConnectLike>(op);
+        if (!connect || connect.getSrc() != port)
+          return false;
+        auto dest = connect.getDest().dyn_cast<BlockArgument>();
+        if (!dest)
+          return false;
+        auto it = summaries.find(parent);
+        return it != summaries.end() &&
+               it->second.unusedOutputs.test(dest.getArgNumber());
+      });
     };
 
-    // Output port.
-    if (port.isOutput()) {
-      if (arg.use_empty()) {
-        // Sometimes the connection is already removed possibly by IMCP.
-        // In that case, regard the port value as an invalid value.
-        outputPortConstants.push_back(None);
-      } else if (llvm::all_of(instanceGraphNode->uses(), portIsUnused)) {
-        // Replace the port with a wire if it is unused.
-        auto builder = ImplicitLocOpBuilder::atBlockBegin(
-            arg.getLoc(), module.getBodyBlock());
-        auto wire = builder.create<WireOp>(arg.getType());
-        arg.replaceAllUsesWith(wire);
-        outputPortConstants.push_back(None);
-      } else if (arg.hasOneUse()) {
-        // If the port has a single use, check the port is only connected to
-        // invalid or constant
-        Operation *op = arg.use_begin().getUser();
-        auto connectLike = dyn_cast<FConnectLike>(op);
-        if (!connectLike)
-          continue;
-        auto *srcOp = connectLike.getSrc().getDefiningOp();
-        if (!isa_and_nonnull<InvalidValueOp, ConstantOp>(srcOp))
-          continue;
-
-        if (auto constant = dyn_cast<ConstantOp>(srcOp))
-          outputPortConstants.push_back(constant.getValue());
-        else {
-          assert(isa<InvalidValueOp>(srcOp) && "only expect invalid");
-          outputPortConstants.push_back(None);
+    if (!arg.use_empty() &&
+        llvm::all_of(instanceGraphNode->uses(), portIsUnused)) {
+      summary.unusedOutputs.set(index);
+      summary.outputConstants.erase(index);
+    }
+    if (summary.unusedOutputs.test(index) ||
+        summary.outputConstants.count(index))
+      summary.removedPorts.set(index);
+  }
+}
+
+/// Replace the removed ports of an instance with wires, constants and invalid
+/// values, and create a new instance without them.
+void RemoveUnusedPortsPass::rewriteInstance(InstanceOp instance,
+                                            const PortSummary &summary) {
+  ImplicitLocOpBuilder builder(instance.getLoc(), instance);
+  for (auto index : summary.removedPorts.set_bits()) {
+    auto result = instance.getResult(index);
+
+    // If the port is input, replace the port with an unwritten wire
+    // so that we can remove use-chains in SV dialect canonicalization.
+    if (instance.getPortDirection(index) == Direction::In) {
+      WireOp wire = builder.create<WireOp>(result.getType());
+
+      // Check that the input port is only written. Sometimes input ports are
+      // used as temporary wires. In that case, we cannot erase connections.
+      bool onlyWritten = llvm::all_of(result.getUsers(), [&](Operation *op) {
+        if (auto connect = dyn_cast<FConnectLike>(op))
+          return connect.getDest() == result;
+        return false;
+      });
+
+      result.replaceUsesWithIf(wire, [&](OpOperand &op) -> bool {
+        // Connects can be deleted directly.
+        if (onlyWritten && isa<FConnectLike>(op.getOwner())) {
+          op.getOwner()->erase();
+          return false;
         }
+        return true;
+      });
 
-        // Erase connect op because we are going to remove this output ports.
-        op->erase();
+      // If the wire doesn't have an user, just erase it.
+      if (wire.use_empty())
+        wire.erase();
 
-        if (srcOp->use_empty())
-          srcOp->erase();
-      } else {
-        // Otherwise, we cannot remove the port.
-        continue;
-      }
+      continue;
     }
 
-    removalPortIndexes.set(index);
-  }
-
-  // If there is nothing to remove, abort.
-  if (removalPortIndexes.none())
-    return;
+    // Output port. Replace with the output port with an invalid or constant
+    // value.
+    Value value;
+    auto it = summary.outputConstants.find(index);
+    if (it != summary.outputConstants.end() && it->second)
+      value = builder.create<ConstantOp>(*it->second);
+    else
+      value = builder.create<InvalidValueOp>(result.getType());
 
-  // Delete ports from the module.
-  module.erasePorts(removalPortIndexes);
-  LLVM_DEBUG(llvm::for_each(removalPortIndexes.set_bits(), [&](unsigned index) {
-               llvm::dbgs() << "Delete port: " << ports[index].name << "\n";
-             }););
-
-  // Rewrite all uses.
-  for (auto *use : instanceGraphNode->uses()) {
-    auto instance = ::cast<InstanceOp>(*use->getInstance());
-    ImplicitLocOpBuilder builder(instance.getLoc(), instance);
-    unsigned outputPortIndex = 0;
-    for (auto index : removalPortIndexes.set_bits()) {
-      auto result = instance.getResult(index);
-      assert(!ports[index].isInOut() && "don't expect inout ports");
-
-      // If the port is input, replace the port with an unwritten wire
-      // so that we can remove use-chains in SV dialect canonicalization.
-      if (ports[index].isInput()) {
-        WireOp wire = builder.create<WireOp>(result.getType());
-
-        // Check that the input port is only written. Sometimes input ports are
-        // used as temporary wires. In that case, we cannot erase connections.
-        bool onlyWritten = llvm::all_of(result.getUsers(), [&](Operation *op) {
-          if (auto connect = dyn_cast<FConnectLike>(op))
-            return connect.getDest() == result;
-          return false;
-        });
+    result.replaceAllUsesWith(value);
+  }
 
-        result.replaceUsesWithIf(wire, [&](OpOperand &op) -> bool {
-          // Connects can be deleted directly.
-          if (onlyWritten && isa<FConnectLike>(op.getOwner())) {
-            op.getOwner()->erase();
-            return false;
-          }
-          return true;
-        });
+  // Create a new instance op without unused ports.
+  instance.erasePorts(builder, summary.removedPorts);
+  // Remove old one.
+  instance.erase();
+}
 
-        // If the wire doesn't have an user, just erase it.
-        if (wire.use_empty())
-          wire.erase();
+void RemoveUnusedPortsPass::removeUnusedModulePorts(
+    FModuleOp module, InstanceGraphNode *instanceGraphNode) {
+  // Rewrite the instances within the module first, which erases the connects
+  // to the removed input ports of the instances.
+  for (auto *record : *instanceGraphNode)
+    if (auto instance = dyn_cast<InstanceOp>(*record->getInstance()))
+      if (auto *childSummary = lookupSummary(instance))
+        if (childSummary->removedPorts.any())
+          rewriteInstance(instance, *childSummary);
 
-        continue;
-      }
+  auto &summary = summaries.find(module)->second;
+  if (summary.removedPorts.none())
+    return;
 
-      // Output port. Replace with the output port with an invalid or constant
-      // value.
-      auto portConstant = outputPortConstants[outputPortIndex++];
-      Value value;
-      if (portConstant)
-        value = builder.create<ConstantOp>(*portConstant);
-      else
-        value = builder.create<InvalidValueOp>(result.getType());
+  LLVM_DEBUG(llvm::dbgs() << "Prune ports of module: " << module.getName()
+                          << "\n");
+  for (auto index : summary.removedPorts.set_bits()) {
+    auto arg = module.getArgument(index);
+    if (arg.use_empty())
+      continue;
+    assert(module.getPortDirection(index) == Direction::Out &&
+           "removed input port has uses");
 
-      result.replaceAllUsesWith(value);
+    // Replace the port with a wire if it is unused.
+    if (summary.unusedOutputs.test(index)) {
+      auto builder = ImplicitLocOpBuilder::atBlockBegin(arg.getLoc(),
+                                                        module.getBodyBlock());
+      auto wire = builder.create<WireOp>(arg.getType());
+      arg.replaceAllUsesWith(wire);
+      continue;
     }
 
-    // Create a new instance op without unused ports.
-    instance.erasePorts(builder, removalPortIndexes);
-    // Remove old one.
-    instance.erase();
+    // Erase connect op because we are going to remove this output ports.
+    Operation *op = *arg.getUsers().begin();
+    auto *srcOp = cast<FConnectLike>(op).getSrc().getDefiningOp();
+    op->erase();
+    if (srcOp && srcOp->use_empty())
+      srcOp->erase();
   }
 
-  numRemovedPorts += removalPortIndexes.count();
+  // Delete ports from the module.
+  module.erasePorts(summary.removedPorts);
+  LLVM_DEBUG(
+      llvm::for_each(summary.removedPorts.set_bits(), [&](unsigned index) {
+        llvm::dbgs() << "Delete port: " << index << "\n";
+      }););
+
+  numRemovedPorts += summary.removedPorts.count();
 }
 
 std::unique_ptr<mlir::Pass>
@@ -8,10 +8,24 @@
 
 #include "circt/Dialect/FSM/FSMDialect.h"
 #include "circt/Dialect/FSM/FSMOps.h"
+#include "mlir/Interfaces/FoldInterfaces.h"
 
 using namespace circt;
 using namespace fsm;
 
+namespace {
+// Keeps the constants created while folding the guards and actions of a
+// transition within that transition, instead of hoisting them out of the
+// machine, which is not isolated from above.
+struct FSMFoldInterface : public DialectFoldInterface {
+  using DialectFoldInterface::DialectFoldInterface;
+
+  bool shouldMaterializeInto(Region *region) const final {
+    return isa<TransitionOp>(region->getParentOp());
+  }
+};
+} // namespace
+
 void FSMDialect::initialize() {
   // Register types.
   addTypes<
@@ -24,4 +38,7 @@ void FSMDialect::initialize() {
 #define GET_OP_LIST
 #include "circt/Dialect/FSM/FSM.cpp.inc"
       >();
+
+  // Register interfaces.
+  addInterfaces<FSMFoldInterface>();
 }
@@ -0,0 +1,182 @@
+//===- MinimizeStates.cpp - Merge equivalent FSM states -------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Merges the states of a machine which produce the same outputs and lead to
+// equivalent states under the same conditions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetails.h"
+#include "circt/Dialect/FSM/FSMPasses.h"
+#include "llvm/ADT/DenseMap.h"
+
+using namespace mlir;
+using namespace circt;
+using namespace fsm;
+
+namespace {
+
+/// Structurally compares the regions of two states, given a partition of the
+/// states of their machine into classes. Transitions are considered equal if
+/// their next states are in the same class.
+class StateComparator {
+public:
+  StateComparator(const DenseMap<StringAttr, unsigned> &classes)
+      : classes(classes) {}
+
+  /// Returns true if 'lhs' and 'rhs' can't be told apart under the current
+  /// partition.
+  bool isEquivalent(StateOp lhs, StateOp rhs) {
+    // Values defined within the output region may be used by the transitions,
+    // hence share the mapping between both regions.
+    DenseMap<Value, Value> mapping;
+    return isEquivalent(lhs.getOutput(), rhs.getOutput(), mapping) &&
+           isEquivalent(lhs.getTransitions(), rhs.getTransitions(), mapping);
+  }
+
+private:
+  bool isEquivalent(Region &lhs, Region &rhs, DenseMap<Value, Value> &mapping);
+  bool isEquivalent(Operation &lhs, Operation &rhs,
+                    DenseMap<Value, Value> &mapping);
+
+  const DenseMap<StringAttr, unsigned> &classes;
+};
+
+} // namespace
+
+bool StateComparator::isEquivalent( // NOLINT(misc-no-recursion)
+    Region &lhs, Region &rhs, DenseMap<Value, Value> &mapping) {
+  if (lhs.getBlocks().size() != rhs.getBlocks().size())
+    return false;
+
+  for (auto [lhsBlock, rhsBlock] : llvm::zip(lhs, rhs)) {
+    if (lhsBlock.getNumArguments() != rhsBlock.getNumArguments() ||
+        lhsBlock.getOperations().size() != rhsBlock.getOperations().size())
+      return false;
+    for (auto [lhsArg, rhsArg] :
+         llvm::zip(lhsBlock.getArguments(), rhsBlock.getArguments())) {
+      if (lhsArg.getType() != rhsArg.getType())
+        return false;
+      mapping[lhsArg] = rhsArg;
+    }
+    for (auto [lhsOp, rhsOp] : llvm::zip(lhsBlock, rhsBlock))
+      if (!isEquivalent(lhsOp, rhsOp, mapping))
+        return false;
+  }
+  return true;
+}
+
+bool StateComparator::isEquivalent( // NOLINT(misc-no-recursion)
+    Operation &lhs, Operation &rhs, DenseMap<Value, Value> &mapping) {
+  if (lhs.getName() != rhs.getName() ||
+      lhs.getNumOperands() != rhs.getNumOperands() ||
+      lhs.getResultTypes() != rhs.getResultTypes() ||
+      lhs.getNumRegions() != rhs.getNumRegions())
+    return false;
+
+  // The next state of a transition only needs to be in the same class, all
+  // other attributes have to match exactly.
+  if (auto lhsTransition = dyn_cast<TransitionOp>(lhs)) {
+    auto rhsTransition = cast<TransitionOp>(rhs);
+    if (classes.lookup(lhsTransition.getNextStateAttr().getAttr()) !=
+        classes.lookup(rhsTransition.getNextStateAttr().getAttr()))
+      return false;
+  } else if (lhs.getAttrDictionary() != rhs.getAttrDictionary()) {
+    return false;
+  }
+
+  // Values defined outside of the states, e.g. machine arguments, variables
+  // and constants, map to themselves.
+  for (auto [lhsOperand, rhsOperand] :
+       llvm::zip(lhs.getOperands(), rhs.getOperands())) {
+    auto it = mapping.find(lhsOperand);
+    if ((it == mapping.end() ? lhsOperand : it->second) != rhsOperand)
+      return false;
+  }
+
+  for (auto [lhsResult, rhsResult] :
+       llvm::zip(lhs.getResults(), rhs.getResults()))
+    mapping[lhsResult] = rhsResult;
+
+  for (auto [lhsRegion, rhsRegion] :
+       llvm::zip(lhs.getRegions(), rhs.getRegions()))
+    if (!isEquivalent(lhsRegion, rhsRegion, mapping))
+      return false;
+  return true;
+}
+
+namespace {
+struct MinimizeStatesPass : public MinimizeStatesBase<MinimizeStatesPass> {
+  void runOnOperation() override;
+
+private:
+  void minimize(MachineOp machine);
+};
+} // end anonymous namespace
+
+void MinimizeStatesPass::minimize(MachineOp machine) {
+  auto states = llvm::to_vector(machine.getBody().getOps<StateOp>());
+
+  // Start with all states in a single class, and split the classes until
+  // every state is equivalent to the first state of its class. Every round
+  // only splits existing classes, such that the number of classes stops
+  // growing once the partition is stable.
+  DenseMap<StringAttr, unsigned> classes;
+  for (auto state : states)
+    classes[state.getSymNameAttr()] = 0;
+
+  SmallVector<StateOp> leaders;
+  for (size_t numClasses = 1;;) {
+    StateComparator comparator(classes);
+    DenseMap<StringAttr, unsigned> refined;
+    leaders.clear();
+    for (auto state : states) {
+      unsigned oldClass = classes.lookup(state.getSymNameAttr());
+      auto *leader = llvm::find_if(leaders, [&](StateOp leader) {
+        return classes.lookup(leader.getSymNameAttr()) == oldClass &&
+               comparator.isEquivalent(leader, state);
+      });
+      refined[state.getSymNameAttr()] = leader - leaders.begin();
+      if (leader == leaders.end())
+        leaders.push_back(state);
+    }
+    classes = std::move(refined);
+    if (leaders.size() == numClasses)
+      break;
+    numClasses = leaders.size();
+  }
+  if (leaders.size() == states.size())
+    return;
+
+  // The initial state represents its class, and the first state in the order
+  // of the machine represents all other classes.
+  auto initialState = machine.getInitialStateOp();
+  leaders[classes[initialState.getSymNameAttr()]] = initialState;
+
+  for (auto state : states)
+    for (auto transition : state.getTransitions().getOps<TransitionOp>()) {
+      auto leader = leaders[classes[transition.getNextStateAttr().getAttr()]];
+      transition.setNextStateAttr(FlatSymbolRefAttr::get(leader));
+    }
+
+  for (auto state : states) {
+    if (leaders[classes[state.getSymNameAttr()]] == state)
+      continue;
+    state.erase();
+    ++numStatesMerged;
+  }
+}
+
+void MinimizeStatesPass::runOnOperation() {
+  for (auto machine : getOperation().getOps<MachineOp>())
+    minimize(machine);
+}
+
+std::unique_ptr<mlir::Pass> circt::fsm::createMinimizeStatesPass() {
+  return std::make_unique<MinimizeStatesPass>();
+}
@@ -16,7 +16,9 @@
 #ifndef DIALECT_FSM_TRANSFORMS_PASSDETAILS_H
 #define DIALECT_FSM_TRANSFORMS_PASSDETAILS_H
 
+#include "circt/Dialect/Comb/CombDialect.h"
 #include "circt/Dialect/FSM/FSMOps.h"
+#include "circt/Dialect/HW/HWDialect.h"
 #include "mlir/Pass/Pass.h"
 
 namespace circt {
@@ -0,0 +1,204 @@
+//===- SimplifyMachines.cpp - Simplify FSM transition graphs --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Removes unreachable states and redundant transitions from FSM machines, and
+// simplifies the transition guards.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetails.h"
+#include "circt/Dialect/Comb/CombOps.h"
+#include "circt/Dialect/FSM/FSMGraph.h"
+#include "circt/Dialect/FSM/FSMPasses.h"
+#include "circt/Dialect/HW/HWOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/DepthFirstIterator.h"
+
+using namespace mlir;
+using namespace circt;
+using namespace fsm;
+
+/// Returns the value of the guard of 'transition' if it is a constant.
+/// Transitions without a guard are always taken.
+static Optional<bool> getConstantGuard(TransitionOp transition) {
+  if (!transition.hasGuard())
+    return true;
+  auto guardReturn = transition.getGuardReturn();
+  if (guardReturn.getNumOperands() == 0)
+    return true;
+
+  Value guard = guardReturn.getOperand();
+  if (auto constantOp = guard.getDefiningOp<hw::ConstantOp>())
+    return constantOp.getValue().isOne();
+  if (auto constantOp = guard.getDefiningOp<arith::ConstantOp>())
+    if (auto boolAttr = constantOp.getValue().dyn_cast<BoolAttr>())
+      return boolAttr.getValue();
+  return None;
+}
+
+/// Removes the guard region of 'transition', which makes it always taken.
+static void eraseGuard(TransitionOp transition) {
+  Region &guard = transition.getGuard();
+  guard.dropAllReferences();
+  guard.getBlocks().clear();
+}
+
+namespace {
+struct SimplifyMachinesPass
+    : public SimplifyMachinesBase<SimplifyMachinesPass> {
+  void runOnOperation() override;
+
+private:
+  /// Canonicalizes the guards of the transitions of 'node', and removes those
+  /// which are never taken or follow an always taken transition. Returns true
+  /// if any transition was changed.
+  bool simplifyGuards(FSMStateNode *node,
+                      const FrozenRewritePatternSet &patterns);
+
+  /// Merges adjacent transitions of 'node' into the same state and removes
+  /// trailing self-transitions. Returns true if any transition was changed.
+  bool mergeTransitions(FSMStateNode *node);
+
+  void simplify(MachineOp machine, const FrozenRewritePatternSet &patterns);
+};
+} // end anonymous namespace
+
+bool SimplifyMachinesPass::simplifyGuards(
+    FSMStateNode *node, const FrozenRewritePatternSet &patterns) {
+  bool changed = false;
+  bool isDead = false;
+  for (auto *edge : llvm::make_early_inc_range(*node)) {
+    auto transition = edge->getTransition();
+    if (isDead) {
+      edge->erase();
+      ++numTransitionsRemoved;
+      changed = true;
+      continue;
+    }
+
+    if (transition.hasGuard())
+      (void)applyPatternsAndFoldGreedily(transition.getGuard(), patterns);
+
+    auto constantGuard = getConstantGuard(transition);
+    if (!constantGuard)
+      continue;
+    if (!*constantGuard) {
+      edge->erase();
+      ++numTransitionsRemoved;
+      changed = true;
+      continue;
+    }
+
+    // All transitions behind an always taken one are dead.
+    if (transition.hasGuard()) {
+      eraseGuard(transition);
+      changed = true;
+    }
+    isDead = true;
+  }
+  return changed;
+}
+
+bool SimplifyMachinesPass::mergeTransitions(FSMStateNode *node) {
+  bool changed = false;
+  FSMTransitionEdge *prevEdge = nullptr;
+  for (auto *edge : llvm::make_early_inc_range(*node)) {
+    auto transition = edge->getTransition();
+    if (!prevEdge || prevEdge->getNextState() != edge->getNextState() ||
+        prevEdge->getTransition().hasAction() || transition.hasAction()) {
+      prevEdge = edge;
+      continue;
+    }
+
+    // If the latter transition is always taken, the former one is redundant.
+    // Otherwise, the guard of the latter is moved into the guard of the
+    // former, which is then taken if either of them holds.
+    auto prevTransition = prevEdge->getTransition();
+    if (transition.isAlwaysTaken()) {
+      prevEdge->erase();
+    } else {
+      auto prevReturn = prevTransition.getGuardReturn();
+      auto guardReturn = transition.getGuardReturn();
+      for (auto &op : llvm::make_early_inc_range(
+               transition.getGuard().front().without_terminator()))
+        op.moveBefore(prevReturn);
+      OpBuilder builder(prevReturn);
+      auto orOp = builder.create<comb::OrOp>(transition.getLoc(),
+                                             prevReturn.getOperand(),
+                                             guardReturn.getOperand(), false);
+      prevReturn.getOperandMutable().assign(orOp);
+      edge->erase();
+      edge = prevEdge;
+    }
+    ++numTransitionsRemoved;
+    changed = true;
+    prevEdge = edge;
+  }
+
+  // A state is not left if none of its transitions are taken, hence trailing
+  // transitions into the state itself are redundant.
+  while (node->begin() != node->end()) {
+    auto *lastEdge = *std::prev(node->end());
+    if (lastEdge->getNextState() != node ||
+        lastEdge->getTransition().hasAction())
+      break;
+    lastEdge->erase();
+    ++numTransitionsRemoved;
+    changed = true;
+  }
+  return changed;
+}
+
+void SimplifyMachinesPass::simplify(MachineOp machine,
+                                    const FrozenRewritePatternSet &patterns) {
+  FSMGraph graph(machine);
+
+  // Merging transitions exposes guards to further simplification, and removing
+  // transitions may make others adjacent, hence iterate until neither applies.
+  for (auto *node : graph) {
+    bool changed;
+    do {
+      changed = simplifyGuards(node, patterns);
+      changed |= mergeTransitions(node);
+    } while (changed);
+  }
+
+  // Remove all states which are no longer reachable once the transitions are
+  // simplified.
+  DenseSet<FSMStateNode *> reachable;
+  for (auto *node : llvm::depth_first(graph.getEntryNode()))
+    reachable.insert(node);
+  for (auto *node : llvm::make_early_inc_range(graph)) {
+    if (reachable.contains(node))
+      continue;
+    auto state = node->getState();
+    graph.eraseState(state);
+    state.erase();
+    ++numStatesRemoved;
+  }
+}
+
+void SimplifyMachinesPass::runOnOperation() {
+  auto *context = &getContext();
+
+  // Only the patterns of the dialects which guards are built from are used.
+  RewritePatternSet patternList(context);
+  for (auto opName : context->getRegisteredOperations())
+    if (isa<comb::CombDialect, hw::HWDialect>(opName.getDialect()))
+      opName.getCanonicalizationPatterns(patternList, context);
+  FrozenRewritePatternSet patterns(std::move(patternList));
+
+  for (auto machine : getOperation().getOps<MachineOp>())
+    simplify(machine, patterns);
+}
+
+std::unique_ptr<mlir::Pass> circt::fsm::createSimplifyMachinesPass() {
+  return std::make_unique<SimplifyMachinesPass>();
+}
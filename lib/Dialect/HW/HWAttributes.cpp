@@ -852,9 +852,9 @@ replaceDeclRefInExpr(Location loc,
   return {};
 }
 
-FailureOr<Attribute> hw::evaluateParametricAttr(Location loc,
-                                                ArrayAttr parameters,
-                                                Attribute paramAttr) {
+static FailureOr<Attribute> evaluateParametricAttrImpl(Location loc,
+                                                       ArrayAttr parameters,
+                                                       Attribute paramAttr) {
   // Create a map of the provided parameters for faster lookup.
   std::map<std::string, Attribute> parameterMap;
   for (auto param : parameters) {
@@ -884,6 +884,41 @@ FailureOr<Attribute> hw::evaluateParametricAttr(Location loc,
   return Attribute();
 }
 
+FailureOr<Attribute> hw::evaluateParametricAttr(Location loc,
+                                                ArrayAttr parameters,
+                                                Attribute paramAttr) {
+  // Nothing to do, constant value.
+  if (paramAttr.isa<IntegerAttr>())
+    return paramAttr;
+
+  // The same expressions are evaluated with the same parameters many times,
+  // e.g. for every instance of a specialized module, so the results are
+  // memoized in the dialect. Failures are not recorded, such that every
+  // evaluation reports its own diagnostic.
+  auto *dialect = paramAttr.getContext()->getLoadedDialect<HWDialect>();
+  if (auto result =
+          dialect->lookupEvaluatedParametricAttr(paramAttr, parameters))
+    return result;
+
+  auto result = evaluateParametricAttrImpl(loc, parameters, paramAttr);
+  if (succeeded(result))
+    dialect->recordEvaluatedParametricAttr(paramAttr, parameters, *result);
+  return result;
+}
+
+Attribute HWDialect::lookupEvaluatedParametricAttr(Attribute paramAttr,
+                                                   ArrayAttr parameters) {
+  llvm::sys::SmartScopedReader<true> lock(evaluatedParametricAttrsMutex);
+  return evaluatedParametricAttrs.lookup({paramAttr, parameters});
+}
+
+void HWDialect::recordEvaluatedParametricAttr(Attribute paramAttr,
+                                              ArrayAttr parameters,
+                                              Attribute result) {
+  llvm::sys::SmartScopedWriter<true> lock(evaluatedParametricAttrsMutex);
+  evaluatedParametricAttrs.insert({{paramAttr, parameters}, result});
+}
+
 FailureOr<Type> hw::evaluateParametricType(Location loc, ArrayAttr parameters,
                                            Type type) {
   return llvm::TypeSwitch<Type, FailureOr<Type>>(type)
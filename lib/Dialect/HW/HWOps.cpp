@@ -787,17 +787,16 @@ void HWModuleGeneratedOp::modifyPorts(
 void HWModuleGeneratedOp::appendOutputs(
     ArrayRef<std::pair<StringAttr, Value>> outputs) {}
 
-/// Return an encapsulated set of information about input and output ports of
-/// the specified module or instance.  The input ports always come before the
-/// output ports in the list.
-ModulePortInfo hw::getModulePortInfo(Operation *op) {
+/// Decode the input and output ports of the specified module or instance.
+static void getModulePorts(Operation *op, SmallVectorImpl<PortInfo> &inputs,
+                           SmallVectorImpl<PortInfo> &outputs) {
   assert(isAnyModuleOrInstance(op) &&
          "Can only get module ports from an instance or module");
 
-  SmallVector<PortInfo> inputs, outputs;
-  auto argTypes = getModuleType(op).getInputs();
-
+  auto moduleType = getModuleType(op);
+  auto argTypes = moduleType.getInputs();
   auto argNames = op->getAttrOfType<ArrayAttr>("argNames");
+  inputs.reserve(inputs.size() + argTypes.size());
   for (unsigned i = 0, e = argTypes.size(); i < e; ++i) {
     bool isInOut = false;
     auto type = argTypes[i];
@@ -813,11 +812,20 @@ ModulePortInfo hw::getModulePortInfo(Operation *op) {
   }
 
   auto resultNames = op->getAttrOfType<ArrayAttr>("resultNames");
-  auto resultTypes = getModuleType(op).getResults();
+  auto resultTypes = moduleType.getResults();
+  outputs.reserve(outputs.size() + resultTypes.size());
   for (unsigned i = 0, e = resultTypes.size(); i < e; ++i) {
     outputs.push_back({resultNames[i].cast<StringAttr>(), PortDirection::OUTPUT,
                        resultTypes[i], i, getResultSym(op, i)});
   }
+}
+
+/// Return an encapsulated set of information about input and output ports of
+/// the specified module or instance.  The input ports always come before the
+/// output ports in the list.
+ModulePortInfo hw::getModulePortInfo(Operation *op) {
+  SmallVector<PortInfo> inputs, outputs;
+  getModulePorts(op, inputs, outputs);
   return ModulePortInfo(inputs, outputs);
 }
 
@@ -825,32 +833,10 @@ ModulePortInfo hw::getModulePortInfo(Operation *op) {
 /// the specified module or instance.  The input ports always come before the
 /// output ports in the list.
 SmallVector<PortInfo> hw::getAllModulePortInfos(Operation *op) {
-  assert(isAnyModuleOrInstance(op) &&
-         "Can only get module ports from an instance or module");
-
   SmallVector<PortInfo> results;
-  auto argTypes = getModuleType(op).getInputs();
-  auto argNames = op->getAttrOfType<ArrayAttr>("argNames");
-  for (unsigned i = 0, e = argTypes.size(); i < e; ++i) {
-    bool isInOut = false;
-    auto type = argTypes[i];
-
-    if (auto inout = type.dyn_cast<InOutType>()) {
-      isInOut = true;
-      type = inout.getElementType();
-    }
-
-    auto direction = isInOut ? PortDirection::INOUT : PortDirection::INPUT;
-    results.push_back(
-        {argNames[i].cast<StringAttr>(), direction, type, i, getArgSym(op, i)});
-  }
-
-  auto resultNames = op->getAttrOfType<ArrayAttr>("resultNames");
-  auto resultTypes = getModuleType(op).getResults();
-  for (unsigned i = 0, e = resultTypes.size(); i < e; ++i) {
-    results.push_back({resultNames[i].cast<StringAttr>(), PortDirection::OUTPUT,
-                       resultTypes[i], i, getResultSym(op, i)});
-  }
+  SmallVector<PortInfo> outputs;
+  getModulePorts(op, results, outputs);
+  results.append(outputs.begin(), outputs.end());
   return results;
 }
 
@@ -880,6 +866,44 @@ PortInfo hw::getModuleOutputPort(Operation *op, size_t idx) {
           resultTypes[idx], idx, getResultSym(op, idx)};
 }
 
+ModulePortLookupInfo::ModulePortLookupInfo(ModulePortInfo ports)
+    : ports(std::move(ports)) {
+  for (auto [i, port] : llvm::enumerate(this->ports.inputs))
+    inputPortMap.insert({port.name, i});
+  for (auto [i, port] : llvm::enumerate(this->ports.outputs))
+    outputPortMap.insert({port.name, i});
+}
+
+FailureOr<unsigned>
+ModulePortLookupInfo::getInputPortIndex(StringAttr name) const {
+  auto it = inputPortMap.find(name);
+  if (it == inputPortMap.end())
+    return failure();
+  return it->second;
+}
+
+FailureOr<unsigned>
+ModulePortLookupInfo::getOutputPortIndex(StringAttr name) const {
+  auto it = outputPortMap.find(name);
+  if (it == outputPortMap.end())
+    return failure();
+  return it->second;
+}
+
+FailureOr<PortInfo> ModulePortLookupInfo::getInputPort(StringAttr name) const {
+  auto index = getInputPortIndex(name);
+  if (failed(index))
+    return failure();
+  return ports.inputs[*index];
+}
+
+FailureOr<PortInfo> ModulePortLookupInfo::getOutputPort(StringAttr name) const {
+  auto index = getOutputPortIndex(name);
+  if (failed(index))
+    return failure();
+  return ports.outputs[*index];
+}
+
 static bool hasAttribute(StringRef name, ArrayRef<NamedAttribute> attrs) {
   for (auto &argAttr : attrs)
     if (argAttr.getName() == name)
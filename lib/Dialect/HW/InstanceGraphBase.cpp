@@ -8,6 +8,8 @@
 
 #include "circt/Dialect/HW/InstanceGraphBase.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Threading.h"
+#include "llvm/ADT/PostOrderIterator.h"
 
 using namespace circt;
 using namespace hw;
@@ -71,6 +73,7 @@ InstanceGraphNode *InstanceGraphBase::addModule(HWModuleLike module) {
   node->module = module;
   nodeMap[module.moduleNameAttr()] = node;
   nodes.push_back(node);
+  inferredTopLevelNodes.clear();
   return node;
 }
 
@@ -82,6 +85,7 @@ void InstanceGraphBase::erase(InstanceGraphNode *node) {
     instance->erase();
   nodeMap.erase(node->getModule().moduleNameAttr());
   nodes.erase(node);
+  inferredTopLevelNodes.clear();
 }
 
 InstanceGraphNode *InstanceGraphBase::lookup(StringAttr name) {
@@ -117,6 +121,24 @@ void InstanceGraphBase::replaceInstance(HWInstanceLike inst,
   (*it)->instance = newInst;
 }
 
+InstanceRecord *InstanceGraphBase::addInstance(HWInstanceLike inst) {
+  auto *parentNode = lookup(inst->getParentOfType<HWModuleLike>());
+  auto *targetNode = lookup(inst.referencedModuleNameAttr());
+  inferredTopLevelNodes.clear();
+  return parentNode->addInstance(inst, targetNode);
+}
+
+void InstanceGraphBase::eraseInstance(HWInstanceLike inst) {
+  // Find the instance record of this instance.
+  auto *node = lookup(inst.referencedModuleNameAttr());
+  auto it = llvm::find_if(node->uses(), [&](InstanceRecord *record) {
+    return record->getInstance() == inst;
+  });
+  assert(it != node->usesEnd() && "Instance of module not recorded in graph");
+  inferredTopLevelNodes.clear();
+  (*it)->erase();
+}
+
 bool InstanceGraphBase::isAncestor(HWModuleLike child, HWModuleLike parent) {
   DenseSet<InstanceGraphNode *> seen;
   SmallVector<InstanceGraphNode *> worklist;
@@ -202,6 +224,62 @@ InstanceGraphBase::getInferredTopLevelNodes() {
   return {inferredTopLevelNodes};
 }
 
+SmallVector<SmallVector<InstanceGraphNode *, 0>>
+InstanceGraphBase::getLevels(bool bottomUp) {
+  SmallVector<InstanceGraphNode *, 0> postOrder(llvm::post_order(this));
+
+  // The level of a module is its height in the instance graph when going
+  // bottom-up, and its depth when going top-down.
+  DenseMap<InstanceGraphNode *, unsigned> levelOf;
+  if (bottomUp) {
+    for (auto *node : postOrder) {
+      unsigned level = 0;
+      for (auto *record : *node)
+        level = std::max(level, levelOf.lookup(record->getTarget()) + 1);
+      levelOf[node] = level;
+    }
+  } else {
+    for (auto *node : llvm::reverse(postOrder)) {
+      unsigned level = 0;
+      for (auto *record : node->uses()) {
+        auto it = levelOf.find(record->getParent());
+        if (it != levelOf.end())
+          level = std::max(level, it->second + 1);
+      }
+      levelOf[node] = level;
+    }
+  }
+
+  // Bucket the modules by level, keeping them in post order. Nodes without a
+  // module, such as an artificial top-level node, are skipped.
+  SmallVector<SmallVector<InstanceGraphNode *, 0>> levels;
+  for (auto *node : postOrder) {
+    if (!node->getModule())
+      continue;
+    auto level = levelOf[node];
+    if (level >= levels.size())
+      levels.resize(level + 1);
+    levels[level].push_back(node);
+  }
+  llvm::erase_if(levels, [](auto &level) { return level.empty(); });
+  return levels;
+}
+
+LogicalResult InstanceGraphBase::failableParallelForEachModule(
+    bool bottomUp, llvm::function_ref<LogicalResult(InstanceGraphNode *)> fn) {
+  bool anyFailed = false;
+  for (auto &level : getLevels(bottomUp))
+    if (failed(mlir::failableParallelForEach(parent->getContext(), level, fn)))
+      anyFailed = true;
+  return failure(anyFailed);
+}
+
+void InstanceGraphBase::parallelForEachModule(
+    bool bottomUp, llvm::function_ref<void(InstanceGraphNode *)> fn) {
+  for (auto &level : getLevels(bottomUp))
+    mlir::parallelForEach(parent->getContext(), level, fn);
+}
+
 ArrayRef<InstancePath> InstancePathCache::getAbsolutePaths(HWModuleLike op) {
   InstanceGraphNode *node = instanceGraph[op];
 
@@ -241,6 +319,54 @@ ArrayRef<InstancePath> InstancePathCache::getAbsolutePaths(HWModuleLike op) {
   return pathList;
 }
 
+ArrayRef<CompactInstancePath>
+InstancePathCache::getCompactAbsolutePaths(HWModuleLike op) {
+  InstanceGraphNode *node = instanceGraph[op];
+
+  // If we have reached the circuit root, we're done.
+  if (node == instanceGraph.getTopLevelNode()) {
+    static CompactInstancePath empty{};
+    return empty; // array with single empty path
+  }
+
+  // Fast path: hit the cache.
+  auto cached = compactPathsCache.find(op);
+  if (cached != compactPathsCache.end())
+    return cached->second;
+
+  // For each instance, extend each path to its parent by the instance itself.
+  // The parent paths are shared, so this only allocates a single node per
+  // path.
+  SmallVector<CompactInstancePath, 8> extendedPaths;
+  for (auto *inst : node->uses()) {
+    if (auto module = inst->getParent()->getModule()) {
+      auto instPaths = getCompactAbsolutePaths(module);
+      extendedPaths.reserve(extendedPaths.size() + instPaths.size());
+      for (auto path : instPaths)
+        extendedPaths.push_back(
+            appendInstance(path, cast<HWInstanceLike>(*inst->getInstance())));
+    }
+  }
+
+  // Move the list of paths into the bump allocator for later quick retrieval.
+  ArrayRef<CompactInstancePath> pathList;
+  if (!extendedPaths.empty()) {
+    auto *paths = allocator.Allocate<CompactInstancePath>(extendedPaths.size());
+    std::uninitialized_copy(extendedPaths.begin(), extendedPaths.end(), paths);
+    pathList = ArrayRef<CompactInstancePath>(paths, extendedPaths.size());
+  }
+  compactPathsCache.insert({op, pathList});
+  return pathList;
+}
+
+CompactInstancePath InstancePathCache::appendInstance(CompactInstancePath path,
+                                                      HWInstanceLike inst) {
+  auto *node = allocator.Allocate<InstancePathNode>();
+  new (node) InstancePathNode{inst, path.getNode(),
+                              static_cast<unsigned>(path.size() + 1)};
+  return CompactInstancePath(node);
+}
+
 InstancePath InstancePathCache::appendInstance(InstancePath path,
                                                HWInstanceLike inst) {
   size_t n = path.size() + 1;
@@ -285,4 +411,12 @@ void InstancePathCache::replaceInstance(HWInstanceLike oldOp,
     llvm::copy(updatedPaths, paths);
     iter.getSecond() = ArrayRef<InstancePath>(paths, updatedPaths.size());
   }
+
+  // Compact paths share their nodes, and every node is the last node of some
+  // cached path, so updating the last node of each cached path in place
+  // updates every path that contains the old instance.
+  for (auto &iter : compactPathsCache)
+    for (auto path : iter.getSecond())
+      if (!path.empty() && path.back() == oldOp)
+        const_cast<InstancePathNode *>(path.getNode())->instance = newOp;
 }
@@ -0,0 +1,143 @@
+//===- HWBalanceMuxChains.cpp - Rebalance priority mux chains -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass rewrites long priority chains of muxes, as produced by
+// `when/elsewhen` cascades, into balanced trees of logarithmic depth.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetails.h"
+#include "circt/Dialect/Comb/CombOps.h"
+#include "circt/Dialect/HW/HWOps.h"
+#include "circt/Dialect/HW/HWPasses.h"
+#include "mlir/IR/Builders.h"
+
+using namespace mlir;
+using namespace circt;
+using namespace hw;
+
+namespace {
+/// A priority chain `mux(c0, v0, mux(c1, v1, ... mux(cN, vN, otherwise)))`.
+struct MuxChain {
+  /// The muxes making up the chain, from the root to the leaf.
+  SmallVector<comb::MuxOp> muxes;
+  /// The condition and value of each case, in priority order.
+  SmallVector<std::pair<Value, Value>> cases;
+  /// The value used when no condition holds.
+  Value otherwise;
+  /// Whether all muxes in the chain are two-state.
+  bool twoState = true;
+};
+
+struct HWBalanceMuxChainsPass
+    : public HWBalanceMuxChainsBase<HWBalanceMuxChainsPass> {
+  void runOnOperation() override;
+};
+} // end anonymous namespace
+
+/// Return the mux whose false value `mux` is, if `mux` is only used there and
+/// in the same block, i.e. if `mux` is an intermediate link of a chain.
+static comb::MuxOp getChainParent(comb::MuxOp mux) {
+  if (!mux->hasOneUse())
+    return {};
+  auto parent = dyn_cast<comb::MuxOp>(*mux->user_begin());
+  if (!parent || parent.getFalseValue() != mux.getResult() ||
+      parent->getBlock() != mux->getBlock())
+    return {};
+  return parent;
+}
+
+/// Collect the priority chain rooted at `root`.
+static MuxChain collectChain(comb::MuxOp root) {
+  MuxChain chain;
+  for (auto mux = root; mux;) {
+    chain.muxes.push_back(mux);
+    chain.cases.push_back({mux.getCond(), mux.getTrueValue()});
+    chain.twoState &= mux.getTwoState();
+    chain.otherwise = mux.getFalseValue();
+    auto next = chain.otherwise.getDefiningOp<comb::MuxOp>();
+    mux = next && getChainParent(next) == mux ? next : comb::MuxOp();
+  }
+  return chain;
+}
+
+/// Build a balanced tree that selects the value of the first case in `cases`
+/// whose condition holds, or `otherwise` if there is none.  The first half of
+/// the cases is chosen iff any of its conditions holds, in which case the
+/// first condition that holds is within that half.  Recursing on both halves
+/// keeps the priority semantics with a depth logarithmic in the chain length.
+static Value buildTree(OpBuilder &builder, Location loc,
+                       ArrayRef<std::pair<Value, Value>> cases, Value otherwise,
+                       bool twoState) {
+  if (cases.empty())
+    return otherwise;
+  if (cases.size() == 1)
+    return builder.createOrFold<comb::MuxOp>(loc, cases[0].first,
+                                             cases[0].second, otherwise,
+                                             twoState);
+
+  auto firstHalf = cases.take_front(cases.size() / 2);
+  auto secondHalf = cases.drop_front(firstHalf.size());
+
+  SmallVector<Value> conds;
+  for (auto &entry : firstHalf)
+    conds.push_back(entry.first);
+  Value anyCond = conds.size() == 1
+                      ? conds.front()
+                      : builder.createOrFold<comb::OrOp>(loc, conds, twoState);
+
+  // Within the first half, the last case is known to hold if none of the
+  // earlier ones does, so its value doubles as the fallback.
+  Value trueValue = buildTree(builder, loc, firstHalf.drop_back(),
+                              firstHalf.back().second, twoState);
+  Value falseValue = buildTree(builder, loc, secondHalf, otherwise, twoState);
+  return builder.createOrFold<comb::MuxOp>(loc, anyCond, trueValue,
+                                           falseValue, twoState);
+}
+
+void HWBalanceMuxChainsPass::runOnOperation() {
+  // Find the roots of all chains that are too deep.
+  SmallVector<comb::MuxOp> roots;
+  getOperation().walk([&](comb::MuxOp mux) {
+    if (!getChainParent(mux) && collectChain(mux).muxes.size() > maxDepth)
+      roots.push_back(mux);
+  });
+
+  // The values feeding a chain may themselves be the roots of other chains.
+  // Rewrite users before their operands, and only collect each chain right
+  // before rewriting it, so that no chain ever refers to an erased mux.
+  for (auto root : llvm::reverse(roots)) {
+    auto chain = collectChain(root);
+    SmallVector<Location> locs;
+    for (auto mux : chain.muxes)
+      locs.push_back(mux.getLoc());
+    auto loc = FusedLoc::get(&getContext(), locs);
+
+    OpBuilder builder(root);
+    auto tree = buildTree(builder, loc, chain.cases, chain.otherwise,
+                          chain.twoState);
+    if (auto name = root->getAttrOfType<StringAttr>("sv.namehint"))
+      if (auto *treeOp = tree.getDefiningOp())
+        if (!treeOp->hasAttr("sv.namehint"))
+          treeOp->setAttr("sv.namehint", name);
+    root.getResult().replaceAllUsesWith(tree);
+
+    // Each link of the chain is only used by the previous one, so erasing
+    // from the root down leaves every mux dead by the time it is erased.
+    for (auto mux : chain.muxes)
+      mux.erase();
+    ++numChainsBalanced;
+  }
+
+  if (roots.empty())
+    markAllAnalysesPreserved();
+}
+
+std::unique_ptr<mlir::Pass> circt::hw::createHWBalanceMuxChainsPass() {
+  return std::make_unique<HWBalanceMuxChainsPass>();
+}
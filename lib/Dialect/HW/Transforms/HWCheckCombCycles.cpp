@@ -0,0 +1,250 @@
+//===- HWCheckCombCycles.cpp - Combinational cycle detection --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass detects combinational cycles in HW, Comb, Seq and SV structural
+// logic. Every module is summarized by the input ports each of its outputs
+// combinationally depends on, such that instances are checked against the
+// summary of the instantiated module rather than its body. Summaries are kept
+// across runs of the pass and only recomputed for modules that changed.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetails.h"
+#include "circt/Dialect/HW/HWInstanceGraph.h"
+#include "circt/Dialect/HW/HWPasses.h"
+#include "circt/Dialect/Seq/SeqOps.h"
+#include "circt/Dialect/SV/SVOps.h"
+#include "mlir/IR/OperationSupport.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/StringMap.h"
+
+using namespace mlir;
+using namespace circt;
+using namespace hw;
+
+namespace {
+
+/// The combinational paths through a module: for every output port, the input
+/// ports it depends on without passing through a register.
+struct ModuleSummary {
+  /// A fingerprint of the module body the summary was computed from.
+  llvm::hash_code hash = 0;
+  SmallVector<llvm::BitVector> outputDeps;
+};
+
+struct HWCheckCombCyclesPass
+    : public HWCheckCombCyclesBase<HWCheckCombCyclesPass> {
+  void runOnOperation() override;
+
+private:
+  LogicalResult checkModule(HWModuleOp module, ModuleSummary &summary);
+  void getPredecessors(Value value, SmallVectorImpl<Value> &preds);
+
+  /// The summaries of the modules without cycles, kept across runs.
+  llvm::StringMap<ModuleSummary> summaryCache;
+
+  /// The summaries of the modules visited in the current run.
+  DenseMap<Operation *, ModuleSummary *> summaries;
+
+  InstanceGraph *instanceGraph = nullptr;
+};
+} // namespace
+
+/// Return true if the results of `op` hold state, and thus do not depend
+/// combinationally on its operands.
+static bool isStateElement(Operation *op) {
+  if (auto readPort = dyn_cast<seq::ReadPortOp>(op))
+    return readPort.getLatency() != 0;
+  return isa<seq::CompRegOp, seq::CompRegClockEnabledOp, seq::FirRegOp,
+             seq::HLMemOp, sv::RegOp>(op);
+}
+
+/// Collect the values `value` combinationally depends on.
+void HWCheckCombCyclesPass::getPredecessors(Value value,
+                                            SmallVectorImpl<Value> &preds) {
+  // A wire depends on the values assigned to it.
+  if (value.getType().isa<InOutType>())
+    for (auto *user : value.getUsers())
+      if (auto assign = dyn_cast<sv::AssignOp>(user))
+        if (assign.getDest() == value)
+          preds.push_back(assign.getSrc());
+
+  auto *op = value.getDefiningOp();
+  if (!op || isStateElement(op))
+    return;
+
+  // Instances depend on the inputs which the summary of the instantiated
+  // module connects to the output. External modules have no summary and are
+  // assumed not to have any combinational paths.
+  if (auto inst = dyn_cast<HWInstanceLike>(op)) {
+    auto module = instanceGraph->getReferencedModule(inst);
+    auto it = summaries.find(module.getOperation());
+    if (it == summaries.end())
+      return;
+    auto resultNumber = value.cast<OpResult>().getResultNumber();
+    auto &deps = it->second->outputDeps[resultNumber];
+    for (auto index : deps.set_bits())
+      preds.push_back(op->getOperand(index));
+    return;
+  }
+
+  preds.append(op->operand_begin(), op->operand_end());
+}
+
+/// Check the module for cycles and compute its summary. This is a depth-first
+/// search along the operands of the values, starting from the outputs and the
+/// values without users.
+LogicalResult HWCheckCombCyclesPass::checkModule(HWModuleOp module,
+                                                 ModuleSummary &summary) {
+  unsigned numInputs = module.getNumInputs();
+
+  // The input ports every visited value depends on. Values currently on the
+  // stack have no entry yet.
+  DenseMap<Value, llvm::BitVector> inputDeps;
+  DenseSet<Value> onStack;
+  struct Frame {
+    Value value;
+    SmallVector<Value> preds;
+    unsigned nextPred = 0;
+  };
+  SmallVector<Frame> stack;
+
+  auto visit = [&](Value root) -> LogicalResult {
+    if (inputDeps.count(root))
+      return success();
+    stack.push_back({root});
+    onStack.insert(root);
+    getPredecessors(root, stack.back().preds);
+
+    while (!stack.empty()) {
+      auto &frame = stack.back();
+      if (frame.nextPred == frame.preds.size()) {
+        llvm::BitVector deps(numInputs);
+        if (auto arg = frame.value.dyn_cast<BlockArgument>())
+          deps.set(arg.getArgNumber());
+        for (auto pred : frame.preds)
+          deps |= inputDeps.find(pred)->second;
+        inputDeps.try_emplace(frame.value, std::move(deps));
+        onStack.erase(frame.value);
+        stack.pop_back();
+        continue;
+      }
+
+      auto pred = frame.preds[frame.nextPred++];
+      if (inputDeps.count(pred))
+        continue;
+      if (onStack.contains(pred)) {
+        auto diag =
+            module.emitError("detected combinational cycle in a HW module");
+        auto start = llvm::find_if(
+            stack, [&](const Frame &other) { return other.value == pred; });
+        for (auto &cycleFrame : llvm::make_range(start, stack.end()))
+          diag.attachNote(cycleFrame.value.getLoc())
+              << "this operation is part of the combinational cycle";
+        return failure();
+      }
+      stack.push_back({pred});
+      onStack.insert(pred);
+      getPredecessors(pred, stack.back().preds);
+    }
+    return success();
+  };
+
+  auto outputOp = cast<OutputOp>(module.getBodyBlock()->getTerminator());
+  summary.outputDeps.clear();
+  for (auto output : outputOp.getOperands()) {
+    if (failed(visit(output)))
+      return failure();
+    summary.outputDeps.push_back(inputDeps.find(output)->second);
+  }
+
+  // Cycles not reaching an output end in a value without users or a wire.
+  for (auto &op : *module.getBodyBlock())
+    for (auto result : op.getResults())
+      if (result.use_empty() || result.getType().isa<InOutType>())
+        if (failed(visit(result)))
+          return failure();
+  return success();
+}
+
+/// Compute a fingerprint of the module, which changes whenever an operation
+/// within it is modified, replaced or moved.
+static llvm::hash_code hashModule(HWModuleOp module) {
+  llvm::hash_code hash = 0;
+  module.walk([&](Operation *op) {
+    hash = llvm::hash_combine(
+        hash, OperationEquivalence::computeHash(
+                  op, /*hashOperands=*/OperationEquivalence::directHashValue,
+                  /*hashResults=*/OperationEquivalence::directHashValue,
+                  OperationEquivalence::IgnoreLocations));
+  });
+  return hash;
+}
+
+void HWCheckCombCyclesPass::runOnOperation() {
+  instanceGraph = &getAnalysis<InstanceGraph>();
+  summaries.clear();
+
+  // The modules whose summary differs from the previous run. Their parents
+  // have to be rechecked even if they did not change themselves.
+  DenseSet<Operation *> changedSummaries;
+  bool detectedCycle = false;
+
+  auto process = [&](HWModuleOp module) {
+    auto hash = hashModule(module);
+    bool childChanged = llvm::any_of(
+        module.getOps<HWInstanceLike>(), [&](HWInstanceLike inst) {
+          return changedSummaries.contains(
+              instanceGraph->getReferencedModule(inst).getOperation());
+        });
+
+    auto it = summaryCache.find(module.getName());
+    if (it != summaryCache.end() && it->second.hash == hash && !childChanged) {
+      summaries[module] = &it->second;
+      ++numModulesReused;
+      return;
+    }
+
+    ++numModulesChecked;
+    ModuleSummary summary;
+    summary.hash = hash;
+    if (failed(checkModule(module, summary))) {
+      detectedCycle = true;
+      changedSummaries.insert(module);
+      if (it != summaryCache.end())
+        summaryCache.erase(it);
+      return;
+    }
+
+    if (it == summaryCache.end() ||
+        it->second.outputDeps != summary.outputDeps)
+      changedSummaries.insert(module);
+    auto &entry = summaryCache[module.getName()];
+    entry = std::move(summary);
+    summaries[module] = &entry;
+  };
+
+  // Visit the modules bottom-up, such that the summaries of the instantiated
+  // modules are known when checking their parents.
+  llvm::SmallPtrSet<InstanceGraphNode *, 16> visited;
+  for (auto module : getOperation().getOps<HWModuleLike>())
+    for (auto *node :
+         llvm::post_order_ext(instanceGraph->lookup(module), visited))
+      if (auto hwModule =
+              dyn_cast<HWModuleOp>(node->getModule().getOperation()))
+        process(hwModule);
+
+  if (detectedCycle)
+    signalPassFailure();
+  markAllAnalysesPreserved();
+}
+
+std::unique_ptr<mlir::Pass> circt::hw::createHWCheckCombCyclesPass() {
+  return std::make_unique<HWCheckCombCyclesPass>();
+}
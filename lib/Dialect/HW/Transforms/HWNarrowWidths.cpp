@@ -0,0 +1,234 @@
+//===- HWNarrowWidths.cpp - Demanded-bits width narrowing -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass computes which bits of every combinational value in a module are
+// observed by something outside of the combinational logic, and narrows the
+// comb operations computing those values to just the observed bits.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetails.h"
+#include "circt/Dialect/Comb/CombOps.h"
+#include "circt/Dialect/HW/HWOps.h"
+#include "circt/Dialect/HW/HWPasses.h"
+#include "mlir/IR/Builders.h"
+#include "llvm/ADT/TypeSwitch.h"
+
+using namespace mlir;
+using namespace circt;
+using namespace hw;
+
+/// Return true if `type` is a non-zero-width integer.
+static bool isNonZeroWidthInteger(Type type) {
+  auto intType = type.dyn_cast<IntegerType>();
+  return intType && intType.getWidth() != 0;
+}
+
+/// Return true if `op` takes part in the analysis: a single-result comb
+/// operation whose result and operands are all integers.
+static bool isNarrowingCandidate(Operation *op) {
+  return isa_and_nonnull<comb::CombDialect>(op->getDialect()) &&
+         op->getNumResults() == 1 &&
+         isNonZeroWidthInteger(op->getResult(0).getType()) &&
+         llvm::all_of(op->getOperandTypes(), isNonZeroWidthInteger);
+}
+
+/// Given the bits of the result of `op` that are demanded, return the bits of
+/// operand `index` that are needed to compute them.
+static APInt getDemandedOperandBits(Operation *op, unsigned index,
+                                    const APInt &resultBits) {
+  unsigned width = op->getOperand(index).getType().getIntOrFloatBitWidth();
+  if (resultBits.isZero())
+    return APInt::getZero(width);
+
+  return TypeSwitch<Operation *, APInt>(op)
+      // Bitwise operations need exactly the demanded bits of their operands.
+      .Case<comb::AndOp, comb::OrOp, comb::XorOp>(
+          [&](auto) { return resultBits; })
+      // Carries only propagate upwards, so arithmetic needs every operand bit
+      // up to the highest demanded one.
+      .Case<comb::AddOp, comb::SubOp, comb::MulOp>([&](auto) {
+        return APInt::getLowBitsSet(width, resultBits.getActiveBits());
+      })
+      .Case<comb::MuxOp>([&](auto) {
+        return index == 0 ? APInt::getAllOnes(width) : resultBits;
+      })
+      .Case<comb::ExtractOp>([&](comb::ExtractOp extractOp) {
+        return resultBits.zext(width) << extractOp.getLowBit();
+      })
+      .Case<comb::ConcatOp>([&](comb::ConcatOp concatOp) {
+        // Operands are concatenated from the most significant end, so this
+        // operand sits above all of the ones following it.
+        unsigned offset = 0;
+        for (auto operand : concatOp.getOperands().drop_front(index + 1))
+          offset += operand.getType().getIntOrFloatBitWidth();
+        return resultBits.extractBits(width, offset);
+      })
+      .Case<comb::ReplicateOp>([&](auto) {
+        APInt bits = APInt::getZero(width);
+        for (unsigned i = 0, e = resultBits.getBitWidth(); i != e; i += width)
+          bits |= resultBits.extractBits(width, i);
+        return bits;
+      })
+      .Default([&](auto) { return APInt::getAllOnes(width); });
+}
+
+namespace {
+struct HWNarrowWidthsPass : public HWNarrowWidthsBase<HWNarrowWidthsPass> {
+  void runOnOperation() override;
+
+private:
+  void computeDemandedBits();
+  bool narrowOperation(Operation *op);
+
+  /// The bits of each candidate value that are observed by its users.  Values
+  /// missing from this map have no demanded bits at all.
+  DenseMap<Value, APInt> demandedBits;
+};
+} // end anonymous namespace
+
+/// Run the backwards dataflow analysis over the module.  Anything that is not
+/// a narrowing candidate observes all bits of its operands, and candidates
+/// pass demand on to their operands through `getDemandedOperandBits`.  Since
+/// demand only ever grows this converges, even through the cycles that graph
+/// regions allow.
+void HWNarrowWidthsPass::computeDemandedBits() {
+  SmallVector<Operation *> worklist;
+  auto addDemand = [&](Value value, const APInt &bits) {
+    if (bits.isZero())
+      return;
+    auto it =
+        demandedBits.try_emplace(value, APInt::getZero(bits.getBitWidth()))
+            .first;
+    APInt newBits = it->second | bits;
+    if (newBits == it->second)
+      return;
+    it->second = std::move(newBits);
+    worklist.push_back(value.getDefiningOp());
+  };
+  auto isCandidateValue = [](Value value) {
+    auto *defOp = value.getDefiningOp();
+    return defOp && isNarrowingCandidate(defOp);
+  };
+
+  getOperation().walk([&](Operation *op) {
+    if (isNarrowingCandidate(op))
+      return;
+    for (auto operand : op->getOperands())
+      if (isCandidateValue(operand))
+        addDemand(operand, APInt::getAllOnes(
+                               operand.getType().getIntOrFloatBitWidth()));
+  });
+
+  while (!worklist.empty()) {
+    auto *op = worklist.pop_back_val();
+    APInt resultBits = demandedBits.lookup(op->getResult(0));
+    for (auto &operand : op->getOpOperands())
+      if (isCandidateValue(operand.get()))
+        addDemand(operand.get(),
+                  getDemandedOperandBits(op, operand.getOperandNumber(),
+                                         resultBits));
+  }
+}
+
+/// Rewrite `op` to compute only its demanded bits.  Return true if the IR was
+/// changed.
+bool HWNarrowWidthsPass::narrowOperation(Operation *op) {
+  auto result = op->getResult(0);
+
+  // Narrowing the users of this operation may have left it dead.
+  if (result.use_empty()) {
+    op->erase();
+    return true;
+  }
+
+  unsigned width = result.getType().getIntOrFloatBitWidth();
+  auto it = demandedBits.find(result);
+  OpBuilder builder(op);
+
+  // Nothing observes this value, so any value will do.
+  if (it == demandedBits.end()) {
+    auto zero =
+        builder.create<hw::ConstantOp>(op->getLoc(), APInt::getZero(width));
+    result.replaceAllUsesWith(zero);
+    op->erase();
+    ++numOpsZeroed;
+    return true;
+  }
+
+  // Bitwise operations can drop undemanded bits at either end, arithmetic
+  // only the ones above the highest demanded bit.
+  bool isBitwise = isa<comb::AndOp, comb::OrOp, comb::XorOp, comb::MuxOp>(op);
+  if (!isBitwise && !isa<comb::AddOp, comb::SubOp, comb::MulOp>(op))
+    return false;
+
+  const APInt &demanded = it->second;
+  unsigned lowBit = isBitwise ? demanded.countTrailingZeros() : 0;
+  unsigned newWidth = demanded.getActiveBits() - lowBit;
+  if (newWidth == width)
+    return false;
+
+  auto loc = op->getLoc();
+  auto newType = builder.getIntegerType(newWidth);
+  OperationState state(loc, op->getName());
+  state.addTypes(newType);
+  state.addAttributes(op->getAttrs());
+  for (auto &operand : op->getOpOperands()) {
+    // The condition of a mux keeps its width.
+    if (isa<comb::MuxOp>(op) && operand.getOperandNumber() == 0) {
+      state.addOperands(operand.get());
+      continue;
+    }
+    state.addOperands(builder.createOrFold<comb::ExtractOp>(
+        loc, newType, operand.get(), lowBit));
+  }
+  Value newValue = builder.create(state)->getResult(0);
+
+  // Pad the result back out to the original width.  The padding is never
+  // observed, so zeros are as good as anything else.
+  SmallVector<Value, 3> parts;
+  if (unsigned highBits = width - lowBit - newWidth)
+    parts.push_back(
+        builder.create<hw::ConstantOp>(loc, APInt::getZero(highBits)));
+  parts.push_back(newValue);
+  if (lowBit)
+    parts.push_back(
+        builder.create<hw::ConstantOp>(loc, APInt::getZero(lowBit)));
+  if (parts.size() > 1)
+    newValue = builder.create<comb::ConcatOp>(loc, parts);
+
+  result.replaceAllUsesWith(newValue);
+  op->erase();
+  ++numOpsNarrowed;
+  return true;
+}
+
+void HWNarrowWidthsPass::runOnOperation() {
+  computeDemandedBits();
+
+  // Visit users before the values they use, so that values only used by
+  // operations that get zeroed are cleaned up rather than narrowed.
+  // Operations that were already dead are left alone.
+  SmallVector<Operation *> candidates;
+  getOperation().walk([&](Operation *op) {
+    if (isNarrowingCandidate(op) && !op->use_empty())
+      candidates.push_back(op);
+  });
+
+  bool changed = false;
+  for (auto *op : llvm::reverse(candidates))
+    changed |= narrowOperation(op);
+
+  demandedBits.clear();
+  if (!changed)
+    markAllAnalysesPreserved();
+}
+
+std::unique_ptr<mlir::Pass> circt::hw::createHWNarrowWidthsPass() {
+  return std::make_unique<HWNarrowWidthsPass>();
+}
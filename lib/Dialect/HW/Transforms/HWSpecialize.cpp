@@ -22,6 +22,7 @@
 #include "mlir/IR/BlockAndValueMapping.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "llvm/ADT/TypeSwitch.h"
 
@@ -91,12 +92,6 @@ struct ParameterSpecializationRegistry {
   llvm::MapVector<hw::HWModuleOp, llvm::SetVector<ArrayAttr>>
       uniqueModuleParameters;
 
-  bool isRegistered(hw::HWModuleOp moduleOp, ArrayAttr parameters) const {
-    auto it = uniqueModuleParameters.find(moduleOp);
-    return it != uniqueModuleParameters.end() &&
-           it->second.contains(parameters);
-  }
-
   void registerModuleOp(hw::HWModuleOp moduleOp, ArrayAttr parameters) {
     uniqueModuleParameters[moduleOp].insert(parameters);
   }
@@ -206,11 +201,17 @@ static void populateTypeConversion(Location loc, TypeConverter &typeConverter,
   typeConverter.addConversion([](mlir::IntegerType type) { return type; });
 }
 
+/// The specialized module created for each pair of parametric module and
+/// parameter values.
+using SpecializationMap =
+    llvm::DenseMap<hw::HWModuleOp, llvm::DenseMap<ArrayAttr, hw::HWModuleOp>>;
+
 // Registers any nested parametric instance ops of `target` for the next
-// specialization loop
+// specialization loop, unless the instantiated module has already been
+// specialized for the same parameters anywhere in the design.
 static LogicalResult registerNestedParametricInstanceOps(
     HWModuleOp target, ArrayAttr parameters, SymbolCache &sc,
-    const ParameterSpecializationRegistry &currentRegistry,
+    const SpecializationMap &specializations,
     ParameterSpecializationRegistry &nextRegistry,
     llvm::DenseMap<hw::HWModuleOp,
                    llvm::DenseMap<ArrayAttr, llvm::SmallVector<hw::InstanceOp>>>
@@ -240,8 +241,9 @@ static LogicalResult registerNestedParametricInstanceOps(
         ArrayAttr::get(target.getContext(), evaluatedInstanceParameters);
 
     if (auto targetHWModule = targetModuleOp(instanceOp, sc)) {
-      if (!currentRegistry.isRegistered(targetHWModule,
-                                        evaluatedInstanceParametersAttr))
+      auto it = specializations.find(targetHWModule);
+      if (it == specializations.end() ||
+          !it->second.count(evaluatedInstanceParametersAttr))
         nextRegistry.registerModuleOp(targetHWModule,
                                       evaluatedInstanceParametersAttr);
       parametersUsers[targetHWModule][evaluatedInstanceParametersAttr]
@@ -262,15 +264,12 @@ static LogicalResult registerNestedParametricInstanceOps(
 // 3. Has a top-level interface with any parametric types resolved.
 // 4. Any references to module parameters have been replaced with the
 // parameter value.
-static LogicalResult specializeModule(
-    OpBuilder builder, ArrayAttr parameters, SymbolCache &sc, Namespace &ns,
-    HWModuleOp source, HWModuleOp &target,
-    const ParameterSpecializationRegistry &currentRegistry,
-    ParameterSpecializationRegistry &nextRegistry,
-    llvm::DenseMap<hw::HWModuleOp,
-                   llvm::DenseMap<ArrayAttr, llvm::SmallVector<hw::InstanceOp>>>
-        &parametersUsers) {
-  auto *ctx = builder.getContext();
+// The target module is created detached from the IR and only reads 'source',
+// so several modules can be specialized concurrently.
+static LogicalResult specializeModule(ArrayAttr parameters, StringAttr name,
+                                      HWModuleOp source, HWModuleOp &target) {
+  auto *ctx = source.getContext();
+  OpBuilder builder(ctx);
   // Update the types of the source module ports based on evaluating any
   // parametric in/output ports.
   auto ports = source.getPorts();
@@ -290,9 +289,7 @@ static LogicalResult specializeModule(
   }
 
   // Create the specialized module using the evaluated port info.
-  target = builder.create<HWModuleOp>(
-      source.getLoc(),
-      StringAttr::get(ctx, generateModuleName(ns, source, parameters)), ports);
+  target = builder.create<HWModuleOp>(source.getLoc(), name, ports);
 
   // Erase the default created hw.output op - we'll copy the correct operation
   // during body elaboration.
@@ -317,12 +314,6 @@ static LogicalResult specializeModule(
       mapper.set(oldRes, newRes);
   }
 
-  // Register any nested parametric instance ops for the next loop
-  auto nestedRegistrationResult = registerNestedParametricInstanceOps(
-      target, parameters, sc, currentRegistry, nextRegistry, parametersUsers);
-  if (failed(nestedRegistrationResult))
-    return failure();
-
   // We've now created a separate copy of the source module with a rewritten
   // top-level interface. Next, we enter the module to convert parametric
   // types within operations.
@@ -376,30 +367,67 @@ void HWSpecializePass::runOnOperation() {
   // Create specialized modules.
   OpBuilder builder = OpBuilder(&getContext());
   builder.setInsertionPointToStart(module.getBody());
-  llvm::DenseMap<hw::HWModuleOp, llvm::DenseMap<ArrayAttr, hw::HWModuleOp>>
-      specializations;
+  SpecializationMap specializations;
 
   // For every module specialization, any nested parametric modules will be
   // registered for the next loop. We loop until no new nested modules have been
   // registered.
+  struct Specialization {
+    HWModuleOp source;
+    ArrayAttr parameters;
+    StringAttr name;
+    HWModuleOp target;
+  };
+  SmallVector<Specialization> work;
   while (!registry.uniqueModuleParameters.empty()) {
-    // The registry for the next specialization loop
-    ParameterSpecializationRegistry nextRegistry;
-    for (auto it : registry.uniqueModuleParameters) {
-      for (auto parameters : it.second) {
-        HWModuleOp specializedModule;
-        if (failed(specializeModule(builder, parameters, sc, ns, it.first,
-                                    specializedModule, registry, nextRegistry,
-                                    parametersUsers))) {
-          signalPassFailure();
-          return;
-        }
+    // Name all specializations of this round up front, since the namespace is
+    // shared between them.
+    work.clear();
+    for (auto &it : registry.uniqueModuleParameters)
+      for (auto parameters : it.second)
+        work.push_back(
+            {it.first, parameters,
+             StringAttr::get(&getContext(),
+                             generateModuleName(ns, it.first, parameters)),
+             {}});
+
+    // Specialize the modules of this round in parallel.
+    mlir::ParallelDiagnosticHandler diagHandler(&getContext());
+    std::atomic<bool> anyFailed(false);
+    mlir::parallelFor(&getContext(), 0, work.size(), [&](size_t i) {
+      diagHandler.setOrderIDForThread(i);
+      auto &item = work[i];
+      if (failed(specializeModule(item.parameters, item.name, item.source,
+                                  item.target)))
+        anyFailed = true;
+      diagHandler.eraseOrderIDForThread();
+    });
+    if (anyFailed) {
+      for (auto &item : work)
+        if (item.target)
+          item.target.erase();
+      signalPassFailure();
+      return;
+    }
 
-        // Extend the symbol cache with the newly created module.
-        sc.addDefinition(specializedModule.getNameAttr(), specializedModule);
+    // Insert the new modules in order, and record them before registering any
+    // nested instances so that those can reuse specializations from this round.
+    for (auto &item : work) {
+      builder.insert(item.target);
+      // Extend the symbol cache with the newly created module.
+      sc.addDefinition(item.target.getNameAttr(), item.target);
+      // Add the specialization
+      specializations[item.source][item.parameters] = item.target;
+    }
 
-        // Add the specialization
-        specializations[it.first][parameters] = specializedModule;
+    // The registry for the next specialization loop
+    ParameterSpecializationRegistry nextRegistry;
+    for (auto &item : work) {
+      if (failed(registerNestedParametricInstanceOps(
+              item.target, item.parameters, sc, specializations, nextRegistry,
+              parametersUsers))) {
+        signalPassFailure();
+        return;
       }
     }
 
@@ -16,6 +16,7 @@
 #ifndef DIALECT_HW_TRANSFORMS_PASSDETAILS_H
 #define DIALECT_HW_TRANSFORMS_PASSDETAILS_H
 
+#include "circt/Dialect/Comb/CombDialect.h"
 #include "circt/Dialect/HW/HWOps.h"
 #include "mlir/Pass/Pass.h"
 
@@ -104,7 +104,7 @@ namespace handshake {
 bool ForkOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
                         llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
                         llvm::DenseMap<mlir::Value, double> &timeMap,
-                        std::vector<std::vector<llvm::Any>> & /*store*/,
+                        std::vector<SimMemory> & /*store*/,
                         std::vector<mlir::Value> &scheduleList) {
   return tryToExecute(getOperation(), valueMap, timeMap, scheduleList, 1);
 }
@@ -112,7 +112,7 @@ bool ForkOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
 bool MergeOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
                          llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
                          llvm::DenseMap<mlir::Value, double> &timeMap,
-                         std::vector<std::vector<llvm::Any>> & /*store*/,
+                         std::vector<SimMemory> & /*store*/,
                          std::vector<mlir::Value> &scheduleList) {
   bool found = false;
   for (mlir::Value in : getOperands()) {
@@ -135,7 +135,7 @@ bool MergeOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
 bool MuxOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
                        llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
                        llvm::DenseMap<mlir::Value, double> &timeMap,
-                       std::vector<std::vector<llvm::Any>> & /*store*/,
+                       std::vector<SimMemory> & /*store*/,
                        std::vector<mlir::Value> &scheduleList) {
   mlir::Value control = getSelectOperand();
   if (valueMap.count(control) == 0)
@@ -165,7 +165,7 @@ bool ControlMergeOp::tryExecute(
     llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
     llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
     llvm::DenseMap<mlir::Value, double> &timeMap,
-    std::vector<std::vector<llvm::Any>> & /*store*/,
+    std::vector<SimMemory> & /*store*/,
     std::vector<mlir::Value> &scheduleList) {
   bool found = false;
   for (auto in : llvm::enumerate(getOperands())) {
@@ -198,7 +198,7 @@ void BranchOp::execute(std::vector<llvm::Any> &ins,
 bool BranchOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
                           llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
                           llvm::DenseMap<mlir::Value, double> &timeMap,
-                          std::vector<std::vector<llvm::Any>> & /*store*/,
+                          std::vector<SimMemory> & /*store*/,
                           std::vector<mlir::Value> &scheduleList) {
   return tryToExecute(getOperation(), valueMap, timeMap, scheduleList, 0);
 }
@@ -207,7 +207,7 @@ bool ConditionalBranchOp::tryExecute(
     llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
     llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
     llvm::DenseMap<mlir::Value, double> &timeMap,
-    std::vector<std::vector<llvm::Any>> & /*store*/,
+    std::vector<SimMemory> & /*store*/,
     std::vector<mlir::Value> &scheduleList) {
   mlir::Value control = getConditionOperand();
   if (valueMap.count(control) == 0)
@@ -234,7 +234,7 @@ bool ConditionalBranchOp::tryExecute(
 bool StartOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> & /*valueMap*/,
                          llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
                          llvm::DenseMap<mlir::Value, double> & /*timeMap*/,
-                         std::vector<std::vector<llvm::Any>> & /*store*/,
+                         std::vector<SimMemory> & /*store*/,
                          std::vector<mlir::Value> & /*scheduleList*/) {
   assert(false && "StartOp's should never exist in a real program due to being "
                   "purely lowering helper operations.");
@@ -243,7 +243,7 @@ bool StartOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> & /*valueMap*/,
 bool EndOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> & /*valueMap*/,
                        llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
                        llvm::DenseMap<mlir::Value, double> & /*timeMap*/,
-                       std::vector<std::vector<llvm::Any>> & /*store*/,
+                       std::vector<SimMemory> & /*store*/,
                        std::vector<mlir::Value> & /*scheduleList*/) {
   assert(false && "EndOp's should never exist in a real program due to being "
                   "purely lowering helper operations.");
@@ -253,7 +253,7 @@ bool EndOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> & /*valueMap*/,
 bool SinkOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
                         llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
                         llvm::DenseMap<mlir::Value, double> & /*timeMap*/,
-                        std::vector<std::vector<llvm::Any>> & /*store*/,
+                        std::vector<SimMemory> & /*store*/,
                         std::vector<mlir::Value> & /*scheduleList*/) {
   valueMap.erase(getOperand());
   return true;
@@ -267,7 +267,7 @@ void BufferOp::execute(std::vector<llvm::Any> &ins,
 bool BufferOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
                           llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
                           llvm::DenseMap<mlir::Value, double> &timeMap,
-                          std::vector<std::vector<llvm::Any>> & /*store*/,
+                          std::vector<SimMemory> & /*store*/,
                           std::vector<mlir::Value> &scheduleList) {
   return tryToExecute(getOperation(), valueMap, timeMap, scheduleList,
                       getNumSlots());
@@ -282,7 +282,7 @@ void ConstantOp::execute(std::vector<llvm::Any> & /*ins*/,
 bool ConstantOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
                             llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
                             llvm::DenseMap<mlir::Value, double> &timeMap,
-                            std::vector<std::vector<llvm::Any>> & /*store*/,
+                            std::vector<SimMemory> & /*store*/,
                             std::vector<mlir::Value> &scheduleList) {
   return tryToExecute(getOperation(), valueMap, timeMap, scheduleList, 0);
 }
@@ -293,7 +293,7 @@ executeMemoryOperation(TMemOp op, unsigned buffer, int opIndex,
                        llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
                        llvm::DenseMap<unsigned, unsigned> &memoryMap,
                        llvm::DenseMap<mlir::Value, double> &timeMap,
-                       std::vector<std::vector<llvm::Any>> &store,
+                       std::vector<SimMemory> &store,
                        std::vector<mlir::Value> &scheduleList) {
   bool notReady = false;
   for (unsigned i = 0; i < op.getStCount(); i++) {
@@ -313,7 +313,7 @@ executeMemoryOperation(TMemOp op, unsigned buffer, int opIndex,
     auto &ref = store[buffer];
     unsigned offset = llvm::any_cast<APInt>(addressValue).getZExtValue();
     assert(offset < ref.size());
-    ref[offset] = dataValue;
+    ref.store(offset, dataValue);
 
     // Implicit none argument
     APInt apnonearg(1, 0);
@@ -341,7 +341,7 @@ executeMemoryOperation(TMemOp op, unsigned buffer, int opIndex,
     unsigned offset = llvm::any_cast<APInt>(addressValue).getZExtValue();
     assert(offset < ref.size());
 
-    valueMap[dataOut] = ref[offset];
+    valueMap[dataOut] = ref.load(offset);
     timeMap[dataOut] = addressTime;
     // Implicit none argument
     APInt apnonearg(1, 0);
@@ -358,7 +358,7 @@ executeMemoryOperation(TMemOp op, unsigned buffer, int opIndex,
 bool MemoryOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
                           llvm::DenseMap<unsigned, unsigned> &memoryMap,
                           llvm::DenseMap<mlir::Value, double> &timeMap,
-                          std::vector<std::vector<llvm::Any>> &store,
+                          std::vector<SimMemory> &store,
                           std::vector<mlir::Value> &scheduleList) {
   unsigned buffer = memoryMap[getId()];
   return executeMemoryOperation(*this, buffer, 0, valueMap, memoryMap, timeMap,
@@ -368,7 +368,7 @@ bool MemoryOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
 bool LoadOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
                         llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
                         llvm::DenseMap<mlir::Value, double> &timeMap,
-                        std::vector<std::vector<llvm::Any>> & /*store*/,
+                        std::vector<SimMemory> & /*store*/,
                         std::vector<mlir::Value> &scheduleList) {
   mlir::Value address = getOperand(0);
   mlir::Value data = getOperand(1);
@@ -410,7 +410,7 @@ bool ExternalMemoryOp::tryExecute(
     llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
     llvm::DenseMap<unsigned, unsigned> &memoryMap,
     llvm::DenseMap<mlir::Value, double> &timeMap,
-    std::vector<std::vector<llvm::Any>> &store,
+    std::vector<SimMemory> &store,
     std::vector<mlir::Value> &scheduleList) {
   unsigned buffer = llvm::any_cast<unsigned>(valueMap[getMemref()]);
   return executeMemoryOperation(*this, buffer, 1, valueMap, memoryMap, timeMap,
@@ -420,7 +420,7 @@ bool ExternalMemoryOp::tryExecute(
 bool StoreOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
                          llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
                          llvm::DenseMap<mlir::Value, double> &timeMap,
-                         std::vector<std::vector<llvm::Any>> & /*store*/,
+                         std::vector<SimMemory> & /*store*/,
                          std::vector<mlir::Value> &scheduleList) {
   return tryToExecute(getOperation(), valueMap, timeMap, scheduleList, 1);
 }
@@ -433,7 +433,7 @@ void JoinOp::execute(std::vector<llvm::Any> &ins,
 bool JoinOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
                         llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
                         llvm::DenseMap<mlir::Value, double> &timeMap,
-                        std::vector<std::vector<llvm::Any>> & /*store*/,
+                        std::vector<SimMemory> & /*store*/,
                         std::vector<mlir::Value> &scheduleList) {
   return tryToExecute(getOperation(), valueMap, timeMap, scheduleList, 1);
 }
@@ -446,7 +446,7 @@ void SyncOp::execute(std::vector<llvm::Any> &ins,
 bool SyncOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
                         llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
                         llvm::DenseMap<mlir::Value, double> &timeMap,
-                        std::vector<std::vector<llvm::Any>> & /*store*/,
+                        std::vector<SimMemory> & /*store*/,
                         std::vector<mlir::Value> &scheduleList) {
   return tryToExecute(getOperation(), valueMap, timeMap, scheduleList, 1);
 }
@@ -467,7 +467,7 @@ void ForkOp::execute(std::vector<llvm::Any> &ins,
 bool UnpackOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
                           llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
                           llvm::DenseMap<mlir::Value, double> &timeMap,
-                          std::vector<std::vector<llvm::Any>> & /*store*/,
+                          std::vector<SimMemory> & /*store*/,
                           std::vector<mlir::Value> &scheduleList) {
   return tryToExecute(getOperation(), valueMap, timeMap, scheduleList, 1);
 }
@@ -485,7 +485,7 @@ void UnpackOp::execute(std::vector<llvm::Any> &ins,
 bool PackOp::tryExecute(llvm::DenseMap<mlir::Value, llvm::Any> &valueMap,
                         llvm::DenseMap<unsigned, unsigned> & /*memoryMap*/,
                         llvm::DenseMap<mlir::Value, double> &timeMap,
-                        std::vector<std::vector<llvm::Any>> & /*store*/,
+                        std::vector<SimMemory> & /*store*/,
                         std::vector<mlir::Value> &scheduleList) {
   return tryToExecute(getOperation(), valueMap, timeMap, scheduleList, 1);
 }
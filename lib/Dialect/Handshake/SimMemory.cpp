@@ -0,0 +1,111 @@
+//===- SimMemory.cpp - Memories of the handshake simulator ----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "circt/Dialect/Handshake/SimMemory.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace circt;
+using namespace circt::handshake;
+
+SimMemory::SimMemory(mlir::Type elementType, size_t size)
+    : elementType(elementType), width(elementType.getIntOrFloatBitWidth()),
+      elementBytes(llvm::divideCeil(width, 8)), numElements(size),
+      data(size * elementBytes) {
+  assert((elementType.isa<mlir::IntegerType, mlir::FloatType>()) &&
+         "memories hold integers or floats");
+}
+
+llvm::Any SimMemory::load(size_t index) const {
+  APInt bits = loadAPInt(index);
+  if (auto floatType = elementType.dyn_cast<mlir::FloatType>())
+    return APFloat(floatType.getFloatSemantics(), bits);
+  return bits;
+}
+
+void SimMemory::store(size_t index, const llvm::Any &value) {
+  if (llvm::any_isa<APInt>(value))
+    return storeAPInt(index, llvm::any_cast<APInt>(value).zextOrTrunc(width));
+
+  APFloat floatValue = llvm::any_cast<APFloat>(value);
+  if (auto floatType = elementType.dyn_cast<mlir::FloatType>()) {
+    bool losesInfo;
+    floatValue.convert(floatType.getFloatSemantics(),
+                       APFloat::rmNearestTiesToEven, &losesInfo);
+  }
+  storeAPInt(index, floatValue.bitcastToAPInt().zextOrTrunc(width));
+}
+
+uint64_t SimMemory::loadBits(size_t index) const {
+  assert(width <= 64 && index < numElements);
+  const uint8_t *element = data.data() + index * elementBytes;
+  uint64_t bits = 0;
+  for (unsigned i = 0; i < elementBytes; ++i)
+    bits |= uint64_t(element[i]) << (8 * i);
+  return bits;
+}
+
+void SimMemory::storeBits(size_t index, uint64_t bits) {
+  assert(width <= 64 && index < numElements);
+  if (width < 64)
+    bits &= (uint64_t(1) << width) - 1;
+  uint8_t *element = data.data() + index * elementBytes;
+  for (unsigned i = 0; i < elementBytes; ++i)
+    element[i] = bits >> (8 * i);
+}
+
+APInt SimMemory::loadAPInt(size_t index) const {
+  if (width <= 64)
+    return APInt(width, loadBits(index));
+  assert(index < numElements);
+  const uint8_t *element = data.data() + index * elementBytes;
+  APInt bits(width, 0);
+  for (unsigned i = 0; i < elementBytes; ++i)
+    bits.insertBits(uint64_t(element[i]), 8 * i, std::min(8u, width - 8 * i));
+  return bits;
+}
+
+void SimMemory::storeAPInt(size_t index, const APInt &bits) {
+  if (width <= 64)
+    return storeBits(index, bits.getZExtValue());
+  assert(index < numElements);
+  uint8_t *element = data.data() + index * elementBytes;
+  for (unsigned i = 0; i < elementBytes; ++i)
+    element[i] = bits.extractBitsAsZExtValue(std::min(8u, width - 8 * i),
+                                             8 * i);
+}
+
+llvm::Error SimMemory::readFromFile(StringRef path) {
+  auto file = llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                          /*RequiresNullTerminator=*/false);
+  if (!file)
+    return llvm::createFileError(path, file.getError());
+  StringRef contents = (*file)->getBuffer();
+  if (contents.size() != data.size())
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "'%s' has %zu bytes, but the memory has %zu elements of %u bytes",
+        path.str().c_str(), contents.size(), numElements, elementBytes);
+  std::copy(contents.begin(), contents.end(), data.begin());
+  return llvm::Error::success();
+}
+
+llvm::Error SimMemory::writeToFile(StringRef path) const {
+  std::error_code error;
+  llvm::raw_fd_ostream os(path, error, llvm::sys::fs::OF_None);
+  if (error)
+    return llvm::createFileError(path, error);
+  os.write(reinterpret_cast<const char *>(data.data()), data.size());
+  os.close();
+  if (os.has_error())
+    return llvm::createFileError(path, os.error());
+  return llvm::Error::success();
+}
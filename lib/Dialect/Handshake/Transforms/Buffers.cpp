@@ -168,15 +168,172 @@ static void bufferAllFIFOStrategy(Region &r, OpBuilder &builder,
                     /*bufferType=*/BufferTypeEnum::fifo);
 }
 
+// Returns the number of cycles a token spends within 'op'. Only sequential
+// buffers hold on to their tokens; all other operations are combinational.
+static unsigned getLatency(Operation *op) {
+  auto bufferOp = dyn_cast<handshake::BufferOp>(op);
+  if (bufferOp && bufferOp.isSequential())
+    return bufferOp.getNumSlots();
+  return 0;
+}
+
+// Orders the operations of 'r' such that each operation comes after the
+// producers of its operands. Operands which would violate this order close a
+// cycle of the dataflow graph and are collected in 'backEdges'.
+static SmallVector<Operation *>
+sortDataflowGraph(Region &r, DenseSet<OpOperand *> &backEdges) {
+  SmallVector<Operation *> postOrder;
+  DenseMap<Operation *, bool> onStack;
+  for (auto &root : r.getOps()) {
+    if (onStack.count(&root))
+      continue;
+    SmallVector<std::pair<Operation *, Operation::use_iterator>> stack;
+    onStack[&root] = true;
+    stack.push_back({&root, root.use_begin()});
+    while (!stack.empty()) {
+      auto &[op, it] = stack.back();
+      if (it == op->use_end()) {
+        onStack[op] = false;
+        postOrder.push_back(op);
+        stack.pop_back();
+        continue;
+      }
+      OpOperand &use = *it++;
+      Operation *user = use.getOwner();
+      auto visited = onStack.find(user);
+      if (visited == onStack.end()) {
+        onStack[user] = true;
+        stack.push_back({user, user->use_begin()});
+      } else if (visited->second) {
+        backEdges.insert(&use);
+      }
+    }
+  }
+  return SmallVector<Operation *>(llvm::reverse(postOrder));
+}
+
+// Returns the latency of each cycle of a dataflow graph sorted by
+// 'sortDataflowGraph', along with the consumer of the back edge closing it.
+// The latency of a cycle is the longest path from the consumer of its back
+// edge to the producer.
+static SmallVector<std::pair<Operation *, unsigned>>
+getCycleLatencies(ArrayRef<Operation *> order,
+                  const DenseSet<OpOperand *> &backEdges) {
+  SmallVector<std::pair<Operation *, unsigned>> latencies;
+  DenseMap<Operation *, unsigned> position;
+  for (auto it : llvm::enumerate(order))
+    position[it.value()] = it.index();
+  for (auto *backEdge : backEdges) {
+    Operation *head = backEdge->getOwner();
+    Operation *tail = backEdge->get().getDefiningOp();
+    DenseMap<Operation *, unsigned> distance = {{head, 0}};
+    for (auto *op : order.drop_front(position[head] + 1)) {
+      for (auto &operand : op->getOpOperands()) {
+        Operation *defOp = operand.get().getDefiningOp();
+        auto it = distance.find(defOp);
+        if (!defOp || backEdges.contains(&operand) || it == distance.end())
+          continue;
+        unsigned time = it->second + getLatency(defOp);
+        auto &dist = distance[op];
+        dist = std::max(dist, time);
+      }
+    }
+    auto it = distance.find(tail);
+    if (it == distance.end())
+      continue;
+    latencies.push_back({head, it->second + getLatency(tail)});
+  }
+  return latencies;
+}
+
+unsigned circt::handshake::getCriticalCycleLatency(Region &r) {
+  DenseSet<OpOperand *> backEdges;
+  SmallVector<Operation *> order = sortDataflowGraph(r, backEdges);
+  unsigned criticalLatency = 0;
+  for (auto [head, latency] : getCycleLatencies(order, backEdges))
+    criticalLatency = std::max(criticalLatency, latency);
+  return criticalLatency;
+}
+
+// Places buffers such that the region sustains one token every 'targetII'
+// cycles with as few buffer slots as possible. The dataflow graph is treated
+// as a marked graph in which only sequential buffers add latency:
+//  - Combinational cycles are broken by a single-slot sequential buffer
+//    after the merge-like op they pass through.
+//  - A cycle holding a single token completes an iteration once per cycle
+//    latency. Buffers cannot speed up a cycle which is slower than the target,
+//    so such critical cycles are reported instead.
+//  - Where paths of different latency reconverge, tokens on the faster path
+//    have to wait. A FIFO buffer on a channel with a slack of N cycles needs
+//    ceil(N / targetII) slots to keep tokens flowing at the target rate.
+static void bufferThroughputStrategy(Region &r, OpBuilder &builder,
+                                     unsigned targetII) {
+  auto isSeqBuffer = [](auto op) {
+    auto bufferOp = dyn_cast<handshake::BufferOp>(op);
+    return bufferOp && bufferOp.isSequential();
+  };
+  for (auto mergeOp : r.getOps<MergeLikeOpInterface>())
+    if (inCycle(mergeOp, isSeqBuffer))
+      bufferResults(builder, mergeOp, /*numSlots=*/1, BufferTypeEnum::seq);
+
+  DenseSet<OpOperand *> backEdges;
+  SmallVector<Operation *> order = sortDataflowGraph(r, backEdges);
+
+  // Compute the earliest cycle at which the operands of each operation can
+  // all be available, relative to the arguments of the region.
+  DenseMap<Operation *, unsigned> arrival;
+  auto getReadyTime = [&](Value value) -> unsigned {
+    Operation *defOp = value.getDefiningOp();
+    return defOp ? arrival[defOp] + getLatency(defOp) : 0;
+  };
+  for (auto *op : order) {
+    unsigned time = 0;
+    for (auto &operand : op->getOpOperands())
+      if (!backEdges.contains(&operand))
+        time = std::max(time, getReadyTime(operand.get()));
+    arrival[op] = time;
+  }
+
+  for (auto [head, latency] : getCycleLatencies(order, backEdges))
+    if (latency > targetII)
+      head->emitWarning() << "cycle through this operation has a latency of "
+                          << latency << " cycles, which exceeds the target II "
+                          << "of " << targetII;
+
+  // Balance the reconverging paths.
+  auto bufferSlack = [&](Value value, Operation *user, unsigned time) {
+    auto arg = value.dyn_cast<BlockArgument>();
+    if ((arg && !shouldBufferArgument(arg)) || !value.hasOneUse() ||
+        !isUnbufferedChannel(value.getDefiningOp(), user))
+      return;
+    unsigned readyTime = getReadyTime(value);
+    if (readyTime >= time)
+      return;
+    unsigned numSlots = llvm::divideCeil(time - readyTime, targetII);
+    insertBuffer(value.getLoc(), value, builder, numSlots,
+                 BufferTypeEnum::fifo);
+  };
+  for (auto *op : order)
+    for (auto &operand : op->getOpOperands())
+      if (!backEdges.contains(&operand))
+        bufferSlack(operand.get(), op, arrival[op]);
+}
+
 LogicalResult circt::handshake::bufferRegion(Region &r, OpBuilder &builder,
                                              StringRef strategy,
-                                             unsigned bufferSize) {
+                                             unsigned bufferSize,
+                                             unsigned targetII) {
   if (strategy == "cycles")
     bufferCyclesStrategy(r, builder, bufferSize);
   else if (strategy == "all")
     bufferAllStrategy(r, builder, bufferSize);
   else if (strategy == "allFIFO")
     bufferAllFIFOStrategy(r, builder, bufferSize);
+  else if (strategy == "throughput" && targetII > 0)
+    bufferThroughputStrategy(r, builder, targetII);
+  else if (strategy == "throughput")
+    return r.getParentOp()->emitOpError()
+           << "Target II of the throughput strategy must be positive";
   else
     return r.getParentOp()->emitOpError()
            << "Unknown buffer strategy: " << strategy;
@@ -187,9 +344,11 @@ LogicalResult circt::handshake::bufferRegion(Region &r, OpBuilder &builder,
 namespace {
 struct HandshakeInsertBuffersPass
     : public HandshakeInsertBuffersBase<HandshakeInsertBuffersPass> {
-  HandshakeInsertBuffersPass(const std::string &strategy, unsigned bufferSize) {
+  HandshakeInsertBuffersPass(const std::string &strategy, unsigned bufferSize,
+                             unsigned targetII) {
     this->strategy = strategy;
     this->bufferSize = bufferSize;
+    this->targetII = targetII;
   }
 
   void runOnOperation() override {
@@ -199,7 +358,8 @@ struct HandshakeInsertBuffersPass
 
     OpBuilder builder(f.getContext());
 
-    if (failed(bufferRegion(f.getBody(), builder, strategy, bufferSize)))
+    if (failed(bufferRegion(f.getBody(), builder, strategy, bufferSize,
+                            targetII)))
       signalPassFailure();
   }
 };
@@ -213,6 +373,8 @@ circt::handshake::createHandshakeRemoveBuffersPass() {
 
 std::unique_ptr<mlir::OperationPass<handshake::FuncOp>>
 circt::handshake::createHandshakeInsertBuffersPass(const std::string &strategy,
-                                                   unsigned bufferSize) {
-  return std::make_unique<HandshakeInsertBuffersPass>(strategy, bufferSize);
+                                                   unsigned bufferSize,
+                                                   unsigned targetII) {
+  return std::make_unique<HandshakeInsertBuffersPass>(strategy, bufferSize,
+                                                      targetII);
 }
@@ -0,0 +1,254 @@
+//===- ResourceSharing.cpp - share operators between call sites -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Contains the definitions of the operator sharing pass, which lets several
+// low-utilization operations time-multiplex a single arbitrated instance.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetails.h"
+#include "circt/Dialect/Handshake/HandshakeOps.h"
+#include "circt/Dialect/Handshake/HandshakePasses.h"
+#include "mlir/IR/Builders.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+using namespace circt;
+using namespace handshake;
+using namespace mlir;
+
+/// The operations shared by default: those which are expensive enough in
+/// area to be worth the arbitration logic.
+static const char *const defaultSharedOps[] = {
+    "arith.divsi", "arith.divui", "arith.remsi", "arith.remui", "arith.muli",
+    "arith.addf",  "arith.subf",  "arith.mulf",  "arith.divf",  "arith.remf"};
+
+static std::string getLocationString(Location loc) {
+  std::string str;
+  llvm::raw_string_ostream(str) << loc;
+  return str;
+}
+
+// Returns true if 'src' can reach itself through its users, i.e. if it fires
+// once per iteration of some loop rather than once per function invocation.
+static bool inCycle(Operation *src) {
+  DenseSet<Operation *> visited;
+  SmallVector<Operation *> stack = {src};
+  while (!stack.empty()) {
+    Operation *curr = stack.pop_back_val();
+    if (!visited.insert(curr).second)
+      continue;
+    for (auto *user : curr->getUsers()) {
+      if (user == src)
+        return true;
+      stack.push_back(user);
+    }
+  }
+  return false;
+}
+
+// Returns true if 'a' and 'b' compute the same function, such that one
+// instance can serve both.
+static bool isCompatible(Operation *a, Operation *b) {
+  return a->getName() == b->getName() &&
+         a->getAttrDictionary() == b->getAttrDictionary() &&
+         a->getOperandTypes() == b->getOperandTypes() &&
+         a->getResultTypes() == b->getResultTypes();
+}
+
+// Replaces the operations in 'sites' with a single instance of the first one.
+// The operands of each site are packed into a tuple, and a control merge
+// arbitrates between the sites. The index of the served site travels along
+// with the result through a chain of conditional branches, which routes the
+// result back to that site. Every site gets a single-slot FIFO buffer on its
+// result, such that a site whose consumer is not ready yet cannot hold up the
+// shared instance and deadlock the others.
+static void shareOperations(ArrayRef<Operation *> sites, OpBuilder &builder) {
+  Operation *first = sites.front();
+  Location loc = first->getLoc();
+  builder.setInsertionPoint(first);
+
+  SmallVector<Value> requests;
+  for (auto *site : sites) {
+    if (site->getNumOperands() == 1)
+      requests.push_back(site->getOperand(0));
+    else
+      requests.push_back(
+          builder.create<PackOp>(site->getLoc(), site->getOperands()));
+  }
+  auto arbiter = builder.create<ControlMergeOp>(loc, requests);
+  SmallVector<Value> operands;
+  if (first->getNumOperands() == 1)
+    operands.push_back(arbiter.getResult());
+  else
+    llvm::append_range(operands,
+                       builder.create<UnpackOp>(loc, arbiter.getResult())
+                           .getResults());
+
+  Operation *shared = builder.clone(*first);
+  shared->setOperands(operands);
+
+  // Route the result to the site it belongs to.
+  auto routeTo = [&](Operation *site, Value value) {
+    auto buffer = builder.create<BufferOp>(site->getLoc(), value.getType(), 1,
+                                           value, BufferTypeEnum::fifo);
+    site->getResult(0).replaceAllUsesWith(buffer.getResult());
+  };
+  SmallVector<Value> multiUseValues;
+  Value result = shared->getResult(0);
+  Value index = arbiter.getIndex();
+  for (auto it : llvm::enumerate(sites.drop_back())) {
+    auto source = builder.create<SourceOp>(loc);
+    auto siteIndex = builder.create<handshake::ConstantOp>(
+        loc, builder.getIndexAttr(it.index()), source);
+    auto isSite = builder.create<arith::CmpIOp>(loc, arith::CmpIPredicate::eq,
+                                                index, siteIndex);
+    auto resultBr = builder.create<ConditionalBranchOp>(loc, isSite, result);
+    auto indexBr = builder.create<ConditionalBranchOp>(loc, isSite, index);
+    builder.create<SinkOp>(loc, indexBr.getTrueResult());
+    multiUseValues.push_back(isSite);
+    multiUseValues.push_back(index);
+
+    routeTo(it.value(), resultBr.getTrueResult());
+    result = resultBr.getFalseResult();
+    index = indexBr.getFalseResult();
+  }
+  builder.create<SinkOp>(loc, index);
+  routeTo(sites.back(), result);
+
+  for (auto *site : sites)
+    site->erase();
+  for (auto value : multiUseValues)
+    insertFork(value, /*isLazy=*/false, builder);
+}
+
+namespace {
+struct HandshakeShareOperatorsPass
+    : public HandshakeShareOperatorsBase<HandshakeShareOperatorsPass> {
+  void runOnOperation() override;
+
+private:
+  /// Load the per-operation firing rates from a handshake-runner profile.
+  LogicalResult loadProfile();
+
+  /// Return the fraction of time in which 'op' occupies its unit.
+  double getUtilization(Operation *op);
+
+  /// The firing rates of the profiled operations, keyed by their name and
+  /// location.
+  llvm::StringMap<double> profiledRates;
+};
+} // namespace
+
+LogicalResult HandshakeShareOperatorsPass::loadProfile() {
+  auto fail = [&](const Twine &message) {
+    return getOperation().emitError()
+           << "cannot read profile '" << profile << "': " << message;
+  };
+
+  auto buffer = llvm::MemoryBuffer::getFile(profile);
+  if (!buffer)
+    return fail(buffer.getError().message());
+  auto json = llvm::json::parse((*buffer)->getBuffer());
+  if (!json)
+    return fail(llvm::toString(json.takeError()));
+
+  auto *root = json->getAsObject();
+  auto time = root ? root->getNumber("time") : llvm::None;
+  auto *operations = root ? root->getArray("operations") : nullptr;
+  if (!time || !operations)
+    return fail("expected a 'time' and an 'operations' entry");
+
+  // Operations without a unique location share a key, in which case they are
+  // conservatively all assumed to fire as often as they do together.
+  for (auto &entry : *operations) {
+    auto *operation = entry.getAsObject();
+    auto name = operation ? operation->getString("name") : llvm::None;
+    auto location = operation ? operation->getString("location") : llvm::None;
+    auto firings = operation ? operation->getNumber("firings") : llvm::None;
+    if (!name || !location || !firings)
+      return fail("expected a 'name', 'location' and 'firings' entry for "
+                  "each operation");
+    if (*time > 0)
+      profiledRates[(*name + "@" + *location).str()] += *firings / *time;
+  }
+  return success();
+}
+
+double HandshakeShareOperatorsPass::getUtilization(Operation *op) {
+  // Assume that each firing occupies the unit for one time unit of the
+  // profiled simulation.
+  auto key = (op->getName().getStringRef() + "@" +
+              getLocationString(op->getLoc()))
+                 .str();
+  auto it = profiledRates.find(key);
+  if (it != profiledRates.end())
+    return it->second;
+
+  // Without a profile, operations within a loop are assumed to fire in every
+  // cycle, and the others so rarely that they can always be shared.
+  return inCycle(op) ? 1.0 : 0.0;
+}
+
+void HandshakeShareOperatorsPass::runOnOperation() {
+  auto f = getOperation();
+  if (f.isExternal())
+    return;
+
+  if (!profile.empty() && failed(loadProfile()))
+    return signalPassFailure();
+
+  llvm::StringSet<> sharedOps;
+  if (opNames.empty())
+    sharedOps.insert(std::begin(defaultSharedOps), std::end(defaultSharedOps));
+  else
+    sharedOps.insert(opNames.begin(), opNames.end());
+
+  // Distribute the candidates over the units first-fit, as long as the
+  // combined utilization of a unit stays within the limit.
+  struct Unit {
+    SmallVector<Operation *> sites;
+    double utilization = 0.0;
+  };
+  SmallVector<Unit> units;
+  for (auto &op : f.getOps()) {
+    if (op.getNumResults() != 1 || op.getNumOperands() == 0 ||
+        op.getNumRegions() != 0 ||
+        !sharedOps.contains(op.getName().getStringRef()))
+      continue;
+    double utilization = getUtilization(&op);
+    auto *unit = llvm::find_if(units, [&](Unit &unit) {
+      return unit.sites.size() < maxShare &&
+             isCompatible(unit.sites.front(), &op) &&
+             unit.utilization + utilization <= maxUtilization;
+    });
+    if (unit == units.end())
+      unit = &units.emplace_back();
+    unit->sites.push_back(&op);
+    unit->utilization += utilization;
+  }
+
+  OpBuilder builder(f.getContext());
+  bool changed = false;
+  for (auto &unit : units) {
+    if (unit.sites.size() < 2)
+      continue;
+    shareOperations(unit.sites, builder);
+    numOpsShared += unit.sites.size();
+    changed = true;
+  }
+  if (!changed)
+    markAllAnalysesPreserved();
+}
+
+std::unique_ptr<mlir::Pass>
+circt::handshake::createHandshakeShareOperatorsPass() {
+  return std::make_unique<HandshakeShareOperatorsPass>();
+}
@@ -15,16 +15,24 @@
 
 #include "mlir/ExecutionEngine/ExecutionEngine.h"
 #include "mlir/IR/Builders.h"
+#include "mlir/IR/Threading.h"
 
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
 
+#include <chrono>
+
 using namespace circt::llhd::sim;
 
 Engine::Engine(
     llvm::raw_ostream &out, ModuleOp module,
     llvm::function_ref<mlir::LogicalResult(mlir::ModuleOp)> mlirTransformer,
     llvm::function_ref<llvm::Error(llvm::Module *)> llvmTransformer,
-    std::string root, TraceMode tm, ArrayRef<StringRef> sharedLibPaths)
+    std::string root, TraceMode tm, ArrayRef<StringRef> sharedLibPaths,
+    StringRef objectFile)
     : out(out), root(root), traceMode(tm) {
   state = std::make_unique<State>();
   state->root = root + '.' + root;
@@ -40,32 +48,113 @@ Engine::Engine(
                             llvm::None, root, root, ArrayRef<Value>(),
                             ArrayRef<Value>());
 
-  if (failed(mlirTransformer(module))) {
-    llvm::errs() << "failed to apply the MLIR passes\n";
-    exit(EXIT_FAILURE);
-  }
-
   this->module = module;
 
   llvm::InitializeNativeTarget();
   llvm::InitializeNativeTargetAsmPrinter();
 
+  // Reuse the code compiled by a previous run if there is any.
+  if (!objectFile.empty() && llvm::sys::fs::exists(objectFile)) {
+    if (auto err = loadObjectFile(objectFile, sharedLibPaths)) {
+      llvm::errs() << "failed to load " << objectFile << ": " << err << "\n";
+      exit(EXIT_FAILURE);
+    }
+    return;
+  }
+
+  if (failed(mlirTransformer(module))) {
+    llvm::errs() << "failed to apply the MLIR passes\n";
+    exit(EXIT_FAILURE);
+  }
+
   mlir::ExecutionEngineOptions options;
   options.transformer = llvmTransformer;
   options.sharedLibPaths = sharedLibPaths;
+  options.enableObjectDump = !objectFile.empty();
   auto maybeEngine = mlir::ExecutionEngine::create(this->module, options);
   assert(maybeEngine && "failed to create JIT");
   engine = std::move(*maybeEngine);
+  objectFileToWrite = objectFile.str();
 }
 
 Engine::~Engine() = default;
 
+llvm::Error Engine::loadObjectFile(StringRef objectFile,
+                                   ArrayRef<StringRef> sharedLibPaths) {
+  auto buffer = llvm::MemoryBuffer::getFile(objectFile);
+  if (!buffer)
+    return llvm::errorCodeToError(buffer.getError());
+
+  auto jit = llvm::orc::LLJITBuilder().create();
+  if (!jit)
+    return jit.takeError();
+  objectJIT = std::move(*jit);
+
+  // Resolve the runtime library and the C library the same way the JIT does.
+  auto &mainDylib = objectJIT->getMainJITDylib();
+  auto globalPrefix = objectJIT->getDataLayout().getGlobalPrefix();
+  for (auto libPath : sharedLibPaths) {
+    auto generator = llvm::orc::DynamicLibrarySearchGenerator::Load(
+        libPath.str().c_str(), globalPrefix);
+    if (!generator)
+      return generator.takeError();
+    mainDylib.addGenerator(std::move(*generator));
+  }
+  auto processGenerator =
+      llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+          globalPrefix);
+  if (!processGenerator)
+    return processGenerator.takeError();
+  mainDylib.addGenerator(std::move(*processGenerator));
+
+  return objectJIT->addObjectFile(std::move(*buffer));
+}
+
+llvm::Expected<void (*)(void **)> Engine::lookupPacked(StringRef name) {
+  if (engine)
+    return engine->lookupPacked(name);
+
+  // The packed wrappers are emitted under this prefix by the execution engine.
+  auto symbol = objectJIT->lookup(("_mlir_" + name).str());
+  if (!symbol)
+    return symbol.takeError();
+  return symbol->toPtr<void (*)(void **)>();
+}
+
 void Engine::dumpStateLayout() { state->dumpLayout(); }
 
 void Engine::dumpStateSignalTriggers() { state->dumpSignalTriggers(); }
 
-int Engine::simulate(int n, uint64_t maxTime) {
-  assert(engine && "engine not found");
+/// Overwrite the `width` bits of `dst` starting at bit `offset` with the low
+/// `width` bits of `src`. Works a byte of `src` at a time, and copies whole
+/// bytes directly if the bits are byte aligned.
+static void insertBits(uint8_t *dst, const uint8_t *src, unsigned offset,
+                       unsigned width) {
+  if (offset % 8 == 0 && width % 8 == 0) {
+    std::memcpy(dst + offset / 8, src, width / 8);
+    return;
+  }
+
+  unsigned shift = offset % 8;
+  dst += offset / 8;
+  for (unsigned i = 0; i < width; i += 8, ++dst) {
+    unsigned numBits = std::min(8u, width - i);
+    unsigned mask = ((1u << numBits) - 1) << shift;
+    unsigned bits = (src[i / 8] << shift) & mask;
+    // The source byte straddles two destination bytes unless it is aligned.
+    bool spills = shift + numBits > 8;
+    unsigned curr = dst[0] | (spills ? dst[1] << 8 : 0);
+    curr = (curr & ~mask) | bits;
+    dst[0] = curr;
+    if (spills)
+      dst[1] = curr >> 8;
+  }
+}
+
+int Engine::simulate(int n, uint64_t maxTime, bool parallel,
+                     StringRef checkpointIn, StringRef checkpointOut,
+                     StringRef activityOut) {
+  assert((engine || objectJIT) && "engine not found");
   assert(state && "state not found");
 
   auto tm = static_cast<TraceMode>(traceMode);
@@ -73,11 +162,33 @@ int Engine::simulate(int n, uint64_t maxTime) {
 
   SmallVector<void *, 1> arg({&state});
   // Initialize tbe simulation state.
-  auto invocationResult = engine->invokePacked("llhd_init", arg);
-  if (invocationResult) {
-    llvm::errs() << "Failed invocation of llhd_init: " << invocationResult;
+  auto initFPtr = lookupPacked("llhd_init");
+  if (!initFPtr) {
+    llvm::errs() << "Failed invocation of llhd_init: "
+                 << llvm::toString(initFPtr.takeError());
     return -1;
   }
+  (**initFPtr)(arg.data());
+  state->packSignals();
+
+  if (!checkpointIn.empty()) {
+    auto buffer = llvm::MemoryBuffer::getFile(checkpointIn);
+    if (!buffer) {
+      llvm::errs() << "failed to open " << checkpointIn << ": "
+                   << buffer.getError().message() << "\n";
+      return -1;
+    }
+    if (auto err = state->restoreCheckpoint((*buffer)->getBuffer())) {
+      llvm::errs() << "failed to restore " << checkpointIn << ": " << err
+                   << "\n";
+      return -1;
+    }
+  }
+
+  // The design is compiled lazily, so it can only be written out once the
+  // first function has been looked up.
+  if (!objectFileToWrite.empty())
+    engine->dumpToObjectFile(objectFileToWrite);
 
   if (traceMode != TraceMode::None) {
     // Add changes for all the signals' initial values.
@@ -86,19 +197,24 @@ int Engine::simulate(int n, uint64_t maxTime) {
     }
   }
 
-  // Add a dummy event to get the simulation started.
-  state->queue.push_back(Slot(Time()));
-  ++state->queue.events;
+  // Add a dummy event to get the simulation started. A restored simulation
+  // continues with the events pending in the checkpoint instead.
+  if (checkpointIn.empty())
+    state->queue.getOrCreateSlot(Time());
 
   // Keep track of the instances that need to wakeup.
   llvm::SmallVector<unsigned, 8> wakeupQueue;
 
+  // The events of each instance woken up, if they are run in parallel.
+  std::vector<EventBuffer> eventBuffers;
+
   // Add all instances to the wakeup queue for the first run and add the jitted
   // function pointers to all of the instances to make them readily available.
   for (size_t i = 0, e = state->instances.size(); i < e; ++i) {
-    wakeupQueue.push_back(i);
+    if (checkpointIn.empty())
+      wakeupQueue.push_back(i);
     auto &inst = state->instances[i];
-    auto expectedFPtr = engine->lookupPacked(inst.unit);
+    auto expectedFPtr = lookupPacked(inst.unit);
     if (!expectedFPtr) {
       llvm::errs() << "Could not lookup " << inst.unit << "!\n";
       return -1;
@@ -106,6 +222,17 @@ int Engine::simulate(int n, uint64_t maxTime) {
     inst.unitFPtr = *expectedFPtr;
   }
 
+  // Scratch space to apply the changes of a signal in, large enough for any
+  // signal once the first few have been processed.
+  llvm::SmallVector<uint64_t, 8> scratch;
+
+  bool recordActivity = !activityOut.empty();
+  if (recordActivity)
+    state->enableActivity();
+
+  statistics = Statistics();
+  auto startTime = std::chrono::steady_clock::now();
+
   int cycle = 0;
   while (state->queue.events > 0) {
     const auto &pop = state->queue.top();
@@ -118,6 +245,7 @@ int Engine::simulate(int n, uint64_t maxTime) {
 
     // Update the simulation time.
     state->time = pop.time;
+    statistics.events += pop.changesSize + pop.scheduled.size();
 
     if (traceMode != TraceMode::None)
       trace.flush();
@@ -127,41 +255,42 @@ int Engine::simulate(int n, uint64_t maxTime) {
     while (i < e) {
       const auto sigIndex = pop.changes[i].first;
       auto &curr = state->signals[sigIndex];
-      APInt buff(curr.getSize() * 8, 0);
-      llvm::LoadIntFromMemory(buff, curr.getValue(), curr.getSize());
+      const auto size = curr.getSize();
+      scratch.resize(llvm::divideCeil(size, 8));
+      auto *buff = reinterpret_cast<uint8_t *>(scratch.data());
+      std::memcpy(buff, curr.getValue(), size);
 
       // Apply the changes to the buffer until we reach the next signal.
       while (i < e && pop.changes[i].first == sigIndex) {
-        const auto &change = pop.buffers[pop.changes[i].second];
-        const auto offset = change.first;
-        const auto &drive = change.second;
-        if (drive.getBitWidth() < buff.getBitWidth())
-          buff.insertBits(drive, offset);
+        const auto &drive = pop.buffers[pop.changes[i].second];
+        const auto *bytes = pop.driveBytes.data() + drive.byteOffset;
+        if (drive.width < size * 8)
+          insertBits(buff, bytes, drive.bitOffset, drive.width);
         else
-          buff = drive;
+          std::memcpy(buff, bytes, size);
 
         ++i;
       }
 
-      if (!curr.updateWhenChanged(buff.getRawData()))
+      if (recordActivity)
+        state->recordActivity(sigIndex, buff);
+      if (!curr.updateWhenChanged(scratch.data()))
         continue;
 
       // Add sensitive instances.
-      for (auto inst : curr.getTriggeredInstanceIndices()) {
+      for (auto [inst, sensIndex] :
+           llvm::zip(curr.getTriggeredInstanceIndices(),
+                     curr.getTriggeredSensitivityIndices())) {
         // Skip if the process is not currently sensible to the signal.
         if (!state->instances[inst].isEntity) {
-          const auto &sensList = state->instances[inst].sensitivityList;
-          auto it = std::find_if(sensList.begin(), sensList.end(),
-                                 [sigIndex](const SignalDetail &sig) {
-                                   return sig.globalIndex == sigIndex;
-                                 });
-          if (sensList.end() != it &&
-              state->instances[inst].procState->senses[it - sensList.begin()] ==
-                  0)
+          if (state->instances[inst].procState->senses[sensIndex] == 0)
             continue;
 
           // Invalidate scheduled wakeup
           state->instances[inst].expectedWakeup = Time();
+        } else if (!state->instances[inst].readsSignal[sensIndex]) {
+          // Skip if the entity does not read the signal.
+          continue;
         }
         wakeupQueue.push_back(inst);
       }
@@ -182,9 +311,10 @@ int Engine::simulate(int n, uint64_t maxTime) {
     std::sort(wakeupQueue.begin(), wakeupQueue.end());
     wakeupQueue.erase(std::unique(wakeupQueue.begin(), wakeupQueue.end()),
                       wakeupQueue.end());
+    statistics.instanceRuns += wakeupQueue.size();
 
     // Run the instances present in the wakeup queue.
-    for (auto i : wakeupQueue) {
+    auto runInstance = [&](unsigned i) {
       auto &inst = state->instances[i];
       auto signalTable = inst.sensitivityList.data();
 
@@ -197,6 +327,25 @@ int Engine::simulate(int n, uint64_t maxTime) {
       }
       // Run the unit.
       (*inst.unitFPtr)(args.data());
+    };
+
+    if (parallel && wakeupQueue.size() > 1) {
+      // The instances only read signal values and their own state, so they
+      // can run concurrently as long as the events they push are added to
+      // the queue afterwards, in the order they would have been sequentially.
+      if (eventBuffers.size() < wakeupQueue.size())
+        eventBuffers.resize(wakeupQueue.size());
+      mlir::parallelFor(module.getContext(), 0, wakeupQueue.size(),
+                        [&](size_t i) {
+                          State::setThreadEventBuffer(&eventBuffers[i]);
+                          runInstance(wakeupQueue[i]);
+                          State::setThreadEventBuffer(nullptr);
+                        });
+      for (size_t i = 0, e = wakeupQueue.size(); i < e; ++i)
+        state->flushEventBuffer(eventBuffers[i]);
+    } else {
+      for (auto i : wakeupQueue)
+        runInstance(i);
     }
 
     // Clear wakeup queue.
@@ -204,6 +353,11 @@ int Engine::simulate(int n, uint64_t maxTime) {
     ++cycle;
   }
 
+  statistics.deltaCycles = cycle;
+  statistics.seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - startTime)
+                           .count();
+
   if (traceMode != TraceMode::None) {
     // Flush any remainign changes
     trace.flush(/*force=*/true);
@@ -211,6 +365,28 @@ int Engine::simulate(int n, uint64_t maxTime) {
 
   llvm::errs() << "Finished at " << state->time.toString() << " (" << cycle
                << " cycles)\n";
+
+  if (!checkpointOut.empty()) {
+    std::error_code ec;
+    llvm::raw_fd_ostream os(checkpointOut, ec, llvm::sys::fs::OF_None);
+    if (ec) {
+      llvm::errs() << "failed to open " << checkpointOut << ": "
+                   << ec.message() << "\n";
+      return -1;
+    }
+    state->saveCheckpoint(os);
+  }
+
+  if (recordActivity) {
+    std::error_code ec;
+    llvm::raw_fd_ostream os(activityOut, ec, llvm::sys::fs::OF_Text);
+    if (ec) {
+      llvm::errs() << "failed to open " << activityOut << ": " << ec.message()
+                   << "\n";
+      return -1;
+    }
+    state->dumpActivity(os);
+  }
   return 0;
 }
 
@@ -236,12 +412,24 @@ void Engine::buildLayout(ModuleOp module) {
   // Add triggers to signals.
   for (size_t i = 0, e = state->instances.size(); i < e; ++i) {
     auto &inst = state->instances[i];
-    for (auto trigger : inst.sensitivityList) {
-      state->signals[trigger.globalIndex].pushInstanceIndex(i);
+    for (auto &trigger : llvm::enumerate(inst.sensitivityList)) {
+      state->signals[trigger.value().globalIndex].pushInstanceIndex(
+          i, trigger.index());
     }
   }
 }
 
+/// Check whether an entity needs to be evaluated again when the signal `sig`
+/// changes. This is not the case if the entity only drives the signal, or
+/// passes it on to child instances, which are evaluated on their own.
+static bool isReadByEntity(mlir::Value sig) {
+  return llvm::any_of(sig.getUses(), [](mlir::OpOperand &use) {
+    if (auto drv = dyn_cast<circt::llhd::DrvOp>(use.getOwner()))
+      return use.get() != drv.getSignal();
+    return !isa<circt::llhd::InstOp>(use.getOwner());
+  });
+}
+
 void Engine::walkEntity(EntityOp entity, Instance &child) {
   entity.walk([&](Operation *op) {
     assert(op);
@@ -249,8 +437,11 @@ void Engine::walkEntity(EntityOp entity, Instance &child) {
     // Add a signal to the signal table.
     if (auto sig = dyn_cast<SigOp>(op)) {
       uint64_t index = state->addSignal(sig.getName().str(), child.name);
+      if (auto intType = sig.getInit().getType().dyn_cast<IntegerType>())
+        state->signals[index].setBitWidth(intType.getWidth());
       child.sensitivityList.push_back(
           SignalDetail({nullptr, 0, child.sensitivityList.size(), index}));
+      child.readsSignal.push_back(isReadByEntity(sig));
     }
 
     // Build (recursive) instance layout.
@@ -302,6 +493,9 @@ void Engine::walkEntity(EntityOp entity, Instance &child) {
         // define new signals or instances.
         if (auto ent = dyn_cast<EntityOp>(e)) {
           newChild.isEntity = true;
+          for (auto &detail : newChild.sensitivityList)
+            newChild.readsSignal.push_back(
+                isReadByEntity(ent.getArgument(detail.instIndex)));
           walkEntity(ent, newChild);
         } else {
           newChild.isEntity = false;
@@ -13,7 +13,9 @@
 
 #include "circt/Dialect/LLHD/Simulator/State.h"
 
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <string>
@@ -57,11 +59,6 @@ std::string Signal::toHexString(unsigned elemIndex) const {
   return ret;
 }
 
-Signal::~Signal() {
-  std::free(value);
-  value = nullptr;
-}
-
 //===----------------------------------------------------------------------===//
 // Slot
 //===----------------------------------------------------------------------===//
@@ -72,20 +69,19 @@ bool Slot::operator>(const Slot &rhs) const { return rhs.time < time; }
 
 void Slot::insertChange(int index, int bitOffset, uint8_t *bytes,
                         unsigned width) {
-  // Get the amount of 64 bit words required to store the value in an APInt.
+  // Copy the driven bytes into the slot.
   auto size = llvm::divideCeil(width, 8);
-
-  APInt buffer(width, 0);
-  llvm::LoadIntFromMemory(buffer, bytes, size);
-  auto offsetBufferPair = std::make_pair(bitOffset, buffer);
+  Drive drive{static_cast<unsigned>(bitOffset), width,
+              static_cast<unsigned>(driveBytes.size())};
+  driveBytes.append(bytes, bytes + size);
 
   if (changesSize >= buffers.size()) {
     // Create a new change buffer if we don't have any unused one available for
     // reuse.
-    buffers.push_back(offsetBufferPair);
+    buffers.push_back(drive);
   } else {
     // Reuse the first available buffer.
-    buffers[changesSize] = offsetBufferPair;
+    buffers[changesSize] = drive;
   }
 
   // Map the signal index to the change buffer so we can retrieve
@@ -111,84 +107,55 @@ void UpdateQueue::insertOrUpdate(Time time, unsigned inst) {
 }
 
 Slot &UpdateQueue::getOrCreateSlot(Time time) {
-  auto &top = begin()[topSlot];
+  // Directly add to an existing slot.
+  auto [it, inserted] = slotsByTime.try_emplace(time, 0);
+  if (!inserted)
+    return begin()[it->second];
 
-  // Directly add to top slot.
-  if (!top.unused && time == top.time) {
-    return top;
-  }
-
-  // We need to search through the queue for an existing slot only if we're
-  // spawning an event later than the top slot. Adding to an existing slot
-  // scheduled earlier than the top slot should never happens, as then it should
-  // be the top.
-  if (events > 0 && top.time < time) {
-    for (size_t i = 0, e = size(); i < e; ++i) {
-      if (time == begin()[i].time) {
-        return begin()[i];
-      }
-    }
-  }
+  ++events;
 
   // Spawn new event using an existing slot.
   if (!unused.empty()) {
-    auto firstUnused = unused.pop_back_val();
-    auto &newSlot = begin()[firstUnused];
+    it->second = unused.pop_back_val();
+    auto &newSlot = begin()[it->second];
     newSlot.unused = false;
     newSlot.time = time;
-
-    // Update the top of the queue either if it is currently unused or the new
-    // timestamp is earlier than it.
-    if (top.unused || time < top.time)
-      topSlot = firstUnused;
-
-    ++events;
     return newSlot;
   }
 
   // We do not have pre-allocated slots available, generate a new one.
+  it->second = size();
   push_back(Slot(time));
-
-  // Update the top of the queue either if it is currently unused or the new
-  // timestamp is earlier than it.
-  if (top.unused || time < top.time)
-    topSlot = size() - 1;
-
-  ++events;
   return back();
 }
 
 const Slot &UpdateQueue::top() {
-  assert(topSlot < size() && "top is pointing out of bounds!");
+  assert(!slotsByTime.empty() && "the queue is empty!");
 
   // Sort the changes of the top slot such that all changes to the same signal
   // are in succession.
-  auto &top = begin()[topSlot];
+  auto &top = begin()[slotsByTime.begin()->second];
   llvm::sort(top.changes.begin(), top.changes.begin() + top.changesSize);
   return top;
 }
 
 void UpdateQueue::pop() {
+  assert(!slotsByTime.empty() && "the queue is empty!");
+  auto topSlot = slotsByTime.begin()->second;
+  slotsByTime.erase(slotsByTime.begin());
+
   // Reset internal structures and decrease the event counter.
   auto &curr = begin()[topSlot];
   curr.unused = true;
   curr.changesSize = 0;
   curr.scheduled.clear();
   curr.changes.clear();
+  curr.driveBytes.clear();
   curr.time = Time();
   --events;
 
   // Add to unused slots list for easy retrieval.
   unused.push_back(topSlot);
-
-  // Update the current top of the queue.
-  topSlot = std::distance(
-      begin(),
-      std::min_element(begin(), end(), [](const auto &a, const auto &b) {
-        // a is "smaller" than b if either a's timestamp is earlier than b's, or
-        // b is unused (i.e. b has no actual meaning).
-        return !a.unused && (a < b || b.unused);
-      }));
 }
 
 //===----------------------------------------------------------------------===//
@@ -215,18 +182,54 @@ State::~State() {
 }
 
 Slot State::popQueue() {
-  assert(!queue.empty() && "the event queue is empty");
+  assert(queue.events > 0 && "the event queue is empty");
   Slot pop = queue.top();
   queue.pop();
   return pop;
 }
 
+/// The buffer the events of the current thread are recorded in, if any.
+static thread_local EventBuffer *threadEventBuffer = nullptr;
+
 void State::pushQueue(Time t, unsigned inst) {
   Time newTime = time + t;
-  queue.insertOrUpdate(newTime, inst);
+  if (threadEventBuffer)
+    threadEventBuffer->events.push_back({newTime, inst, 0, 0, 0, true});
+  else
+    queue.insertOrUpdate(newTime, inst);
   instances[inst].expectedWakeup = newTime;
 }
 
+void State::pushDrive(Time t, unsigned index, int bitOffset, uint8_t *bytes,
+                      unsigned width) {
+  Time newTime = time + t;
+  if (!threadEventBuffer) {
+    queue.insertOrUpdate(newTime, index, bitOffset, bytes, width);
+    return;
+  }
+
+  auto &buffer = *threadEventBuffer;
+  buffer.events.push_back({newTime, index, bitOffset, width,
+                           static_cast<unsigned>(buffer.bytes.size()), false});
+  buffer.bytes.append(bytes, bytes + llvm::divideCeil(width, 8));
+}
+
+void State::setThreadEventBuffer(EventBuffer *buffer) {
+  threadEventBuffer = buffer;
+}
+
+void State::flushEventBuffer(EventBuffer &buffer) {
+  for (auto &event : buffer.events) {
+    if (event.isWakeup)
+      queue.insertOrUpdate(event.time, event.index);
+    else
+      queue.insertOrUpdate(event.time, event.index, event.bitOffset,
+                           buffer.bytes.data() + event.byteOffset, event.width);
+  }
+  buffer.events.clear();
+  buffer.bytes.clear();
+}
+
 llvm::SmallVectorTemplateCommon<Instance>::iterator
 State::getInstanceIterator(std::string instName) {
   auto it =
@@ -243,12 +246,14 @@ int State::addSignal(std::string name, std::string owner) {
   return signals.size() - 1;
 }
 
-void State::addProcPtr(std::string name, ProcState *procStatePtr) {
+void State::addProcPtr(std::string name, ProcState *procStatePtr,
+                       uint64_t size) {
   auto it = getInstanceIterator(name);
 
   // Store instance index in process state.
   procStatePtr->inst = it - instances.begin();
   (*it).procState = procStatePtr;
+  (*it).stateSize = size;
 }
 
 int State::addSignalData(int index, std::string owner, uint8_t *value,
@@ -263,13 +268,10 @@ int State::addSignalData(int index, std::string owner, uint8_t *value,
 
   // Add the value pointer to the signal detail struct for each instance this
   // signal appears in.
-  for (auto inst : signals[globalIdx].getTriggeredInstanceIndices()) {
-    for (auto &detail : instances[inst].sensitivityList) {
-      if (detail.globalIndex == globalIdx) {
-        detail.value = sig.getValue();
-      }
-    }
-  }
+  for (auto [inst, sensIndex] :
+       llvm::zip(sig.getTriggeredInstanceIndices(),
+                 sig.getTriggeredSensitivityIndices()))
+    instances[inst].sensitivityList[sensIndex].value = sig.getValue();
   return globalIdx;
 }
 
@@ -277,6 +279,405 @@ void State::addSignalElement(unsigned index, unsigned offset, unsigned size) {
   signals[index].pushElement(std::make_pair(offset, size));
 }
 
+void State::packSignals() {
+  // Lay the signals out in the order of the instances owning them, and within
+  // an instance in the order of its signal table, such that the signals an
+  // entity reads and drives together are close to each other.
+  SmallVector<unsigned, 0> order;
+  SmallVector<bool, 0> placed(signals.size(), false);
+  for (auto &inst : instances)
+    for (auto &detail : llvm::drop_begin(inst.sensitivityList, inst.nArgs))
+      if (!placed[detail.globalIndex]) {
+        placed[detail.globalIndex] = true;
+        order.push_back(detail.globalIndex);
+      }
+  for (unsigned i = 0, e = signals.size(); i < e; ++i)
+    if (!placed[i])
+      order.push_back(i);
+
+  // Reserve twice the size of every value, rounded up to whole words, as the
+  // generated code does, to make sure signal shifts do not read out of bounds.
+  SmallVector<uint64_t, 0> offsets(signals.size());
+  uint64_t numWords = 0;
+  for (auto i : order) {
+    offsets[i] = numWords;
+    numWords += 2 * llvm::divideCeil(signals[i].getSize(), 8);
+  }
+  signalArena.assign(numWords, 0);
+
+  auto *arena = reinterpret_cast<uint8_t *>(signalArena.data());
+  for (unsigned i = 0, e = signals.size(); i < e; ++i) {
+    auto &sig = signals[i];
+    auto *value = arena + offsets[i] * 8;
+    if (sig.getValue())
+      std::memcpy(value, sig.getValue(), sig.getSize());
+    std::free(sig.getValue());
+    sig.store(value, sig.getSize());
+  }
+
+  // Point the signal detail structs at the new values.
+  for (auto &inst : instances)
+    for (auto &detail : inst.sensitivityList)
+      detail.value = signals[detail.globalIndex].getValue();
+}
+
+//===----------------------------------------------------------------------===//
+// Checkpoints
+//===----------------------------------------------------------------------===//
+
+/// Identifies checkpoint files, followed by the format version.
+static constexpr StringLiteral checkpointMagic = "LLHDCKPT";
+static constexpr uint32_t checkpointVersion = 1;
+
+/// The offset of the persisted values in the state of a process. Everything
+/// in front of it is written to checkpoints field by field.
+static constexpr uint64_t procPersistenceOffset =
+    offsetof(ProcState, resumeState);
+
+static void writeTime(support::endian::Writer &writer, const Time &time) {
+  writer.write<uint64_t>(time.getTime());
+  writer.write<uint64_t>(time.getDelta());
+  writer.write<uint64_t>(time.getEps());
+}
+
+namespace {
+/// Reads the values written to a checkpoint. Reading past the end of the data
+/// puts the reader in a failed state, in which all values read are zero.
+class CheckpointReader {
+public:
+  CheckpointReader(StringRef data) : data(data) {}
+
+  template <typename T>
+  T read() {
+    T value = 0;
+    readBytes(reinterpret_cast<uint8_t *>(&value), sizeof(T));
+    return support::endian::byte_swap<T, support::little>(value);
+  }
+
+  Time readTime() {
+    auto time = read<uint64_t>();
+    auto delta = read<uint64_t>();
+    auto eps = read<uint64_t>();
+    return Time(time, delta, eps);
+  }
+
+  void readBytes(uint8_t *dst, size_t size) {
+    if (failed || data.size() - pos < size) {
+      failed = true;
+      return;
+    }
+    std::memcpy(dst, data.data() + pos, size);
+    pos += size;
+  }
+
+  StringRef readString(size_t size) {
+    if (failed || data.size() - pos < size) {
+      failed = true;
+      return {};
+    }
+    pos += size;
+    return data.substr(pos - size, size);
+  }
+
+  bool atEnd() const { return pos == data.size(); }
+
+  bool failed = false;
+
+private:
+  StringRef data;
+  size_t pos = 0;
+};
+} // namespace
+
+void State::saveCheckpoint(raw_ostream &out) const {
+  support::endian::Writer writer(out, support::little);
+  out << checkpointMagic;
+  writer.write<uint32_t>(checkpointVersion);
+  writeTime(writer, time);
+
+  auto *arena = reinterpret_cast<const uint8_t *>(signalArena.data());
+  auto arenaSize = signalArena.size() * 8;
+  writer.write<uint64_t>(signals.size());
+  for (auto &sig : signals) {
+    writer.write<uint64_t>(sig.getSize());
+    out.write(reinterpret_cast<const char *>(sig.getValue()), sig.getSize());
+  }
+
+  writer.write<uint64_t>(instances.size());
+  for (auto &inst : instances) {
+    writer.write<uint8_t>(inst.isEntity);
+    writeTime(writer, inst.expectedWakeup);
+    writer.write<uint64_t>(inst.stateSize);
+    if (inst.isEntity) {
+      out.write(reinterpret_cast<const char *>(inst.entityState),
+                inst.stateSize);
+      continue;
+    }
+
+    auto *procState = inst.procState;
+    writer.write<int32_t>(procState->resume);
+    out.write(reinterpret_cast<const char *>(procState->senses), inst.nArgs);
+
+    // The persisted signal structs point into the signal arena, which lives
+    // at a different address when the checkpoint is restored. Store these
+    // pointers as offsets into the arena instead. The structs of values that
+    // have not been computed yet hold garbage, which is kept as is.
+    auto *bytes = reinterpret_cast<const uint8_t *>(procState);
+    SmallVector<uint8_t, 0> persisted(bytes + procPersistenceOffset,
+                                      bytes + inst.stateSize);
+    for (auto offset : inst.persistedSignalOffsets) {
+      uint8_t *value;
+      std::memcpy(&value, bytes + offset, sizeof(value));
+      bool inArena = value >= arena && value < arena + arenaSize;
+      uint64_t stored = inArena ? value - arena : uint64_t(uintptr_t(value));
+      writer.write<uint8_t>(inArena);
+      std::memcpy(persisted.data() + offset - procPersistenceOffset, &stored,
+                  sizeof(stored));
+    }
+    out.write(reinterpret_cast<const char *>(persisted.data()),
+              persisted.size());
+  }
+
+  // Write the pending events, in no particular order.
+  uint64_t numSlots = llvm::count_if(
+      queue, [](const Slot &slot) { return !slot.unused; });
+  writer.write<uint64_t>(numSlots);
+  for (auto &slot : queue) {
+    if (slot.unused)
+      continue;
+    writeTime(writer, slot.time);
+    writer.write<uint64_t>(slot.changesSize);
+    for (auto &change :
+         makeArrayRef(slot.changes).take_front(slot.changesSize)) {
+      auto &drive = slot.buffers[change.second];
+      writer.write<uint32_t>(change.first);
+      writer.write<uint32_t>(drive.bitOffset);
+      writer.write<uint32_t>(drive.width);
+      out.write(reinterpret_cast<const char *>(slot.driveBytes.data() +
+                                               drive.byteOffset),
+                llvm::divideCeil(drive.width, 8));
+    }
+    writer.write<uint64_t>(slot.scheduled.size());
+    for (auto inst : slot.scheduled)
+      writer.write<uint32_t>(inst);
+  }
+}
+
+Error State::restoreCheckpoint(StringRef data) {
+  auto error = [](const Twine &message) {
+    return createStringError(inconvertibleErrorCode(), message);
+  };
+  CheckpointReader reader(data);
+
+  if (reader.readString(checkpointMagic.size()) != checkpointMagic)
+    return error("not a simulation checkpoint");
+  if (auto version = reader.read<uint32_t>(); version != checkpointVersion)
+    return error("unsupported checkpoint version " + Twine(version));
+  if (queue.events > 0)
+    return error("the event queue is not empty");
+  auto newTime = reader.readTime();
+
+  if (reader.read<uint64_t>() != signals.size())
+    return error("the checkpoint has a different number of signals");
+  for (auto &sig : signals) {
+    if (reader.read<uint64_t>() != sig.getSize())
+      return error("signal " + sig.getOwner() + "/" + sig.getName() +
+                   " has a different size in the checkpoint");
+    reader.readBytes(sig.getValue(), sig.getSize());
+  }
+
+  auto *arena = reinterpret_cast<uint8_t *>(signalArena.data());
+  auto arenaSize = signalArena.size() * 8;
+  if (reader.read<uint64_t>() != instances.size())
+    return error("the checkpoint has a different number of instances");
+  for (auto &inst : instances) {
+    auto isEntity = reader.read<uint8_t>();
+    inst.expectedWakeup = reader.readTime();
+    if (isEntity != inst.isEntity ||
+        reader.read<uint64_t>() != inst.stateSize)
+      return error("instance " + inst.path +
+                   " has a different state in the checkpoint");
+    if (inst.isEntity) {
+      reader.readBytes(inst.entityState, inst.stateSize);
+      continue;
+    }
+
+    auto *procState = inst.procState;
+    if (inst.stateSize < procPersistenceOffset)
+      return error("instance " + inst.path + " has no process state");
+    procState->resume = reader.read<int32_t>();
+    reader.readBytes(reinterpret_cast<uint8_t *>(procState->senses),
+                     inst.nArgs);
+    SmallVector<uint8_t, 4> inArena;
+    for (size_t i = 0, e = inst.persistedSignalOffsets.size(); i < e; ++i)
+      inArena.push_back(reader.read<uint8_t>());
+    auto *bytes = reinterpret_cast<uint8_t *>(procState);
+    reader.readBytes(bytes + procPersistenceOffset,
+                     inst.stateSize - procPersistenceOffset);
+    for (auto [offset, relocate] :
+         llvm::zip(inst.persistedSignalOffsets, inArena)) {
+      uint64_t stored;
+      std::memcpy(&stored, bytes + offset, sizeof(stored));
+      if (relocate && stored >= arenaSize)
+        return error("instance " + inst.path +
+                     " has an invalid signal in the checkpoint");
+      uint8_t *value =
+          relocate ? arena + stored : reinterpret_cast<uint8_t *>(stored);
+      std::memcpy(bytes + offset, &value, sizeof(value));
+    }
+  }
+
+  SmallVector<uint8_t, 16> driveBytes;
+  for (uint64_t i = 0, e = reader.read<uint64_t>(); i < e && !reader.failed;
+       ++i) {
+    auto slotTime = reader.readTime();
+    queue.getOrCreateSlot(slotTime);
+    for (uint64_t j = 0, f = reader.read<uint64_t>(); j < f && !reader.failed;
+         ++j) {
+      auto index = reader.read<uint32_t>();
+      auto bitOffset = reader.read<uint32_t>();
+      auto width = reader.read<uint32_t>();
+      if (index >= signals.size() ||
+          uint64_t(bitOffset) + width > signals[index].getSize() * 8)
+        return error("the checkpoint drives an invalid signal");
+      driveBytes.resize(llvm::divideCeil(width, 8));
+      reader.readBytes(driveBytes.data(), driveBytes.size());
+      queue.insertOrUpdate(slotTime, index, bitOffset, driveBytes.data(),
+                           width);
+    }
+    for (uint64_t j = 0, f = reader.read<uint64_t>(); j < f && !reader.failed;
+         ++j) {
+      auto inst = reader.read<uint32_t>();
+      if (inst >= instances.size())
+        return error("the checkpoint wakes up an invalid instance");
+      queue.insertOrUpdate(slotTime, inst);
+    }
+  }
+
+  if (reader.failed || !reader.atEnd())
+    return error("the checkpoint is truncated or corrupted");
+  time = newTime;
+  return Error::success();
+}
+
+void State::enableActivity() {
+  // Every byte of a value gets the counters of eight bits, such that the bits
+  // changed can be found without regard for the significant width.
+  activityOffsets.resize(signals.size());
+  uint64_t numBits = 0;
+  for (unsigned i = 0, e = signals.size(); i < e; ++i) {
+    activityOffsets[i] = numBits;
+    numBits += signals[i].getSize() * 8;
+  }
+  activity.assign(numBits, BitActivity());
+  activityStartTime = time.getTime();
+  lastChangeTimes.assign(signals.size(), activityStartTime);
+}
+
+void State::recordActivity(unsigned index, const uint8_t *newValue) {
+  auto &sig = signals[index];
+  const auto *oldValue = sig.getValue();
+  auto size = sig.getSize();
+  if (std::memcmp(oldValue, newValue, size) == 0)
+    return;
+
+  // The bits high until now have been so since the last change.
+  auto now = time.getTime();
+  auto elapsed = now - lastChangeTimes[index];
+  lastChangeTimes[index] = now;
+  auto *bits = &activity[activityOffsets[index]];
+  for (uint64_t byte = 0; byte < size; ++byte) {
+    uint8_t high = elapsed ? oldValue[byte] : 0;
+    uint8_t toggled = oldValue[byte] ^ newValue[byte];
+    for (; high; high &= high - 1)
+      bits[byte * 8 + llvm::countTrailingZeros(high)].highTime += elapsed;
+    for (; toggled; toggled &= toggled - 1)
+      ++bits[byte * 8 + llvm::countTrailingZeros(toggled)].toggles;
+  }
+}
+
+void State::dumpActivity(llvm::raw_ostream &out) const {
+  auto now = time.getTime();
+  auto duration = now - activityStartTime;
+
+  // Group the signals by the hierarchical path of the instance owning them.
+  struct Scope {
+    SmallVector<StringRef, 4> path;
+    SmallVector<unsigned, 4> signals;
+  };
+  std::vector<Scope> scopes;
+  StringMap<unsigned> scopeIndices;
+  for (auto &inst : instances) {
+    scopeIndices[inst.name] = scopes.size();
+    scopes.emplace_back();
+    StringRef(inst.path).split(scopes.back().path, '/');
+  }
+  for (unsigned i = 0, e = signals.size(); i < e; ++i) {
+    auto it = scopeIndices.find(signals[i].getOwner());
+    if (it != scopeIndices.end())
+      scopes[it->second].signals.push_back(i);
+  }
+  llvm::sort(scopes, [](const Scope &lhs, const Scope &rhs) {
+    return lhs.path < rhs.path;
+  });
+
+  out << "(SAIFILE\n"
+      << "(SAIFVERSION \"2.0\")\n"
+      << "(DIRECTION \"backward\")\n"
+      << "(DESIGN \"" << (scopes.empty() ? "" : scopes.front().path.front())
+      << "\")\n"
+      << "(PROGRAM_NAME \"llhd-sim\")\n"
+      << "(DIVIDER / )\n"
+      << "(TIMESCALE 1 ps)\n"
+      << "(DURATION " << duration << ")\n";
+
+  SmallVector<StringRef, 4> openScopes;
+  for (auto &scope : scopes) {
+    // Close the scopes not containing this instance, and open the missing
+    // ones.
+    auto common = std::distance(
+        openScopes.begin(),
+        std::mismatch(openScopes.begin(), openScopes.end(), scope.path.begin(),
+                      scope.path.end())
+            .first);
+    while (openScopes.size() > size_t(common)) {
+      openScopes.pop_back();
+      out.indent(2 * openScopes.size()) << ")\n";
+    }
+    for (auto name : llvm::drop_begin(scope.path, common)) {
+      out.indent(2 * openScopes.size()) << "(INSTANCE " << name << "\n";
+      openScopes.push_back(name);
+    }
+    if (scope.signals.empty())
+      continue;
+
+    auto depth = 2 * openScopes.size();
+    out.indent(depth) << "(NET\n";
+    for (auto index : scope.signals) {
+      auto &sig = signals[index];
+      const auto *value = sig.getValue();
+      auto width = sig.getBitWidth();
+      for (uint64_t bit = 0; bit < width; ++bit) {
+        auto &bitActivity = activity[activityOffsets[index] + bit];
+        auto high = bitActivity.highTime;
+        if ((value[bit / 8] >> (bit % 8)) & 1)
+          high += now - lastChangeTimes[index];
+        out.indent(depth + 2) << '(' << sig.getName();
+        if (width > 1)
+          out << "\\[" << bit << "\\]";
+        out << " (T0 " << duration - high << ") (T1 " << high
+            << ") (TX 0) (TC " << bitActivity.toggles << "))\n";
+      }
+    }
+    out.indent(depth) << ")\n";
+  }
+  while (!openScopes.empty()) {
+    openScopes.pop_back();
+    out.indent(2 * openScopes.size()) << ")\n";
+  }
+  out << ")\n";
+}
+
 void State::dumpSignal(llvm::raw_ostream &out, int index) {
   auto &sig = signals[index];
   for (auto inst : sig.getTriggeredInstanceIndices()) {
@@ -13,20 +13,51 @@
 
 #include "circt/Dialect/LLHD/Simulator/Trace.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace circt::llhd::sim;
 
+/// Return the VCD identifier code of the signal at `index`, made of the
+/// printable ASCII characters.
+static std::string getVCDId(unsigned index) {
+  std::string id;
+  do {
+    id.push_back('!' + index % 94);
+    index /= 94;
+  } while (index);
+  return id;
+}
+
 Trace::Trace(std::unique_ptr<State> const &state, llvm::raw_ostream &out,
              TraceMode mode)
     : out(out), state(state), mode(mode) {
   auto root = state->root;
   for (auto &sig : state->signals) {
     bool done = (mode != TraceMode::Full && mode != TraceMode::Merged &&
-                 !sig.isOwner(root)) ||
+                 mode != TraceMode::VCD && !sig.isOwner(root)) ||
                 (mode == TraceMode::NamedOnly && sig.isValidSigName());
     isTraced.push_back(!done);
   }
+
+  if (mode == TraceMode::VCD) {
+    auto numSignals = state->signals.size();
+    isVCDChanged.resize(numSignals);
+    vcdLastValue.resize(numSignals);
+    for (size_t i = 0; i < numSignals; ++i)
+      vcdIds.push_back(getVCDId(i));
+  }
+}
+
+Trace::~Trace() {
+  if (!vcdWriter.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(vcdMutex);
+    vcdDone = true;
+  }
+  vcdCondition.notify_one();
+  vcdWriter.join();
 }
 
 //===----------------------------------------------------------------------===//
@@ -87,6 +118,8 @@ void Trace::addChange(unsigned sigIndex) {
     } else if (mode == TraceMode::Merged || mode == TraceMode::MergedReduce ||
                mode == TraceMode::NamedOnly) {
       addChangeMerged(sigIndex);
+    } else if (mode == TraceMode::VCD) {
+      addChangeVCD(sigIndex);
     }
   }
 }
@@ -106,6 +139,13 @@ void Trace::addChangeMerged(unsigned sigIndex) {
   }
 }
 
+void Trace::addChangeVCD(unsigned sigIndex) {
+  if (isVCDChanged[sigIndex])
+    return;
+  isVCDChanged[sigIndex] = true;
+  vcdChanged.push_back(sigIndex);
+}
+
 //===----------------------------------------------------------------------===//
 // Flush methods
 //===----------------------------------------------------------------------===//
@@ -122,9 +162,13 @@ void Trace::flush(bool force) {
   if (mode == TraceMode::Full || mode == TraceMode::Reduced)
     flushFull();
   else if (mode == TraceMode::Merged || mode == TraceMode::MergedReduce ||
-           mode == TraceMode::NamedOnly)
+           mode == TraceMode::NamedOnly) {
     if (state->time.getTime() > currentTime.getTime() || force)
       flushMerged();
+  } else if (mode == TraceMode::VCD) {
+    if (state->time.getTime() > currentTime.getTime() || force)
+      flushVCD();
+  }
 }
 
 void Trace::flushFull() {
@@ -170,3 +214,120 @@ void Trace::flushMerged() {
     changes.clear();
   }
 }
+
+//===----------------------------------------------------------------------===//
+// VCD format
+//===----------------------------------------------------------------------===//
+
+void Trace::writeVCDHeader() {
+  struct Var {
+    llvm::SmallVector<llvm::StringRef, 4> scope;
+    std::string name;
+    unsigned sigIndex;
+  };
+  std::vector<Var> vars;
+  for (size_t i = 0, e = state->signals.size(); i < e; ++i) {
+    if (!isTraced[i])
+      continue;
+    auto &sig = state->signals[i];
+    auto insts = sig.getTriggeredInstanceIndices();
+    llvm::sort(insts);
+    insts.erase(std::unique(insts.begin(), insts.end()), insts.end());
+    for (auto inst : insts) {
+      Var var{{}, sig.getName(), static_cast<unsigned>(i)};
+      llvm::StringRef(state->instances[inst].path).split(var.scope, '/');
+      vars.push_back(std::move(var));
+    }
+  }
+  llvm::sort(vars, [](const Var &lhs, const Var &rhs) {
+    return std::tie(lhs.scope, lhs.name) < std::tie(rhs.scope, rhs.name);
+  });
+
+  out << "$timescale 1ps $end\n";
+  llvm::SmallVector<llvm::StringRef, 4> openScopes;
+  for (auto &var : vars) {
+    // Close the scopes not containing this variable, and open the missing
+    // ones.
+    auto common = std::distance(
+        openScopes.begin(),
+        std::mismatch(openScopes.begin(), openScopes.end(), var.scope.begin(),
+                      var.scope.end())
+            .first);
+    for (auto i = openScopes.size(); i > size_t(common); --i)
+      out << "$upscope $end\n";
+    openScopes.resize(common);
+    for (auto scope : llvm::drop_begin(var.scope, common)) {
+      out << "$scope module " << scope << " $end\n";
+      openScopes.push_back(scope);
+    }
+
+    auto width = state->signals[var.sigIndex].getSize() * 8;
+    out << "$var wire " << width << ' ' << vcdIds[var.sigIndex] << ' '
+        << var.name << " $end\n";
+  }
+  for (size_t i = 0, e = openScopes.size(); i < e; ++i)
+    out << "$upscope $end\n";
+  out << "$enddefinitions $end\n";
+}
+
+void Trace::flushVCD() {
+  // Write the header once all signals have been initialized, and hand the
+  // output stream over to the writer thread.
+  if (!vcdWriter.joinable()) {
+    writeVCDHeader();
+    vcdWriter = std::thread([this] { runVCDWriter(); });
+  }
+
+  // Only record the raw values of the signals here, formatting them is left
+  // to the writer thread.
+  VCDStep step;
+  step.time = currentTime.getTime();
+  llvm::sort(vcdChanged);
+  for (auto sigIndex : vcdChanged) {
+    isVCDChanged[sigIndex] = false;
+    auto &sig = state->signals[sigIndex];
+    auto *value = sig.getValue();
+    auto size = sig.getSize();
+    auto &last = vcdLastValue[sigIndex];
+    if (!last.empty() && std::equal(last.begin(), last.end(), value))
+      continue;
+    last.assign(value, value + size);
+    step.changes.push_back({sigIndex, step.bytes.size()});
+    step.bytes.insert(step.bytes.end(), value, value + size);
+  }
+  vcdChanged.clear();
+
+  if (step.changes.empty())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(vcdMutex);
+    vcdSteps.push_back(std::move(step));
+  }
+  vcdCondition.notify_one();
+}
+
+void Trace::runVCDWriter() {
+  std::unique_lock<std::mutex> lock(vcdMutex);
+  while (true) {
+    vcdCondition.wait(lock, [&] { return vcdDone || !vcdSteps.empty(); });
+    if (vcdSteps.empty())
+      return;
+    auto step = std::move(vcdSteps.front());
+    vcdSteps.pop_front();
+    lock.unlock();
+
+    out << '#' << step.time << '\n';
+    for (auto [sigIndex, offset] : step.changes) {
+      out << 'b';
+      // Print the bits from the most significant one.
+      for (auto i = state->signals[sigIndex].getSize(); i > 0; --i) {
+        auto byte = step.bytes[offset + i - 1];
+        for (int bit = 7; bit >= 0; --bit)
+          out << ((byte >> bit) & 1 ? '1' : '0');
+      }
+      out << ' ' << vcdIds[sigIndex] << '\n';
+    }
+
+    lock.lock();
+  }
+}
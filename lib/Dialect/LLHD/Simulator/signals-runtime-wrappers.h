@@ -36,13 +36,18 @@ void addSigArrayElements(circt::llhd::sim::State *state, unsigned index,
 void addSigStructElement(circt::llhd::sim::State *state, unsigned index,
                          unsigned offset, unsigned size);
 
-/// Add allocated constructs to a process instance.
+/// Add allocated constructs of `size` bytes to a process instance.
 void allocProc(circt::llhd::sim::State *state, char *owner,
-               circt::llhd::sim::ProcState *procState);
+               circt::llhd::sim::ProcState *procState, int64_t size);
 
-/// Add allocated entity state to the given instance.
+/// Add allocated entity state of `size` bytes to the given instance.
 void allocEntity(circt::llhd::sim::State *state, char *owner,
-                 uint8_t *entityState);
+                 uint8_t *entityState, int64_t size);
+
+/// Record that the state of a process instance holds a signal struct at byte
+/// `offset`.
+void addProcPersistedSignal(circt::llhd::sim::State *state, char *owner,
+                            int64_t offset);
 
 /// Drive a value onto a signal.
 void driveSignal(circt::llhd::sim::State *state,
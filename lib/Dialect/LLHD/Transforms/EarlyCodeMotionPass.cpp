@@ -25,18 +25,6 @@ struct EarlyCodeMotionPass
 };
 } // namespace
 
-/// Calculate intersection of two vectors, returns a new vector
-static SmallVector<Block *, 8> intersection(SmallVectorImpl<Block *> &v1,
-                                            SmallVectorImpl<Block *> &v2) {
-  SmallVector<Block *, 8> res;
-  std::sort(v1.begin(), v1.end());
-  std::sort(v2.begin(), v2.end());
-
-  std::set_intersection(v1.begin(), v1.end(), v2.begin(), v2.end(),
-                        std::back_inserter(res));
-  return res;
-}
-
 void EarlyCodeMotionPass::runOnOperation() {
   llhd::ProcOp proc = getOperation();
   llhd::TemporalRegionAnalysis trAnalysis = llhd::TemporalRegionAnalysis(proc);
@@ -63,48 +51,42 @@ void EarlyCodeMotionPass::runOnOperation() {
            op.hasTrait<OpTrait::IsTerminator>()))
         continue;
 
-      SmallVector<Block *, 8> validPlacements;
-      // Initialize validPlacements to all blocks in the process
-      for (Block &b : proc.getBlocks())
-        validPlacements.push_back(&b);
-
-      // Delete all blocks in validPlacements that are not common to all
-      // operands
+      // The valid placements are the blocks dominated by the blocks defining
+      // all operands. Since these blocks all dominate the operation, they form
+      // a chain in the dominator tree, and the valid placements are the blocks
+      // dominated by the innermost one.
+      Block *domBlock = &entryBlock;
+      bool hasValidPlacement = true;
       for (Value operand : op.getOperands()) {
-        SmallVector<Block *, 8> dominationSet;
-        Block *instBlock = nullptr;
-        if (BlockArgument arg = operand.dyn_cast<BlockArgument>()) {
-          instBlock = arg.getParentBlock();
-        } else {
-          instBlock = operand.getDefiningOp()->getBlock();
+        Block *instBlock = operand.getParentBlock();
+        if (dom.dominates(domBlock, instBlock)) {
+          domBlock = instBlock;
+        } else if (!dom.dominates(instBlock, domBlock)) {
+          hasValidPlacement = false;
+          break;
         }
-
-        for (Block &b : proc.getBlocks()) {
-          if (dom.dominates(instBlock, &b))
-            dominationSet.push_back(&b);
-        }
-        validPlacements = intersection(dominationSet, validPlacements);
-      }
-
-      // The probe instruction has to stay in the same temporal region
-      if (isa<llhd::PrbOp>(op)) {
-        SmallVector<Block *, 8> blocksInTR =
-            trAnalysis.getBlocksInTR(trAnalysis.getBlockTR(block));
-        validPlacements = intersection(validPlacements, blocksInTR);
       }
-
-      if (validPlacements.empty())
+      if (!hasValidPlacement)
         continue;
 
       // Move the instruction to the block which is the closest to the entry
-      // block (and valid)
-      unsigned minBBdist = -1;
+      // block (and valid). Every path from the entry block to a valid
+      // placement passes through the dominating block, which is therefore the
+      // closest one.
       Block *minBB = nullptr;
-      for (Block *b : validPlacements) {
-        if (!entryDistance.count(b))
-          continue;
-        if (entryDistance[b] < minBBdist) {
-          minBBdist = entryDistance[b];
+      if (!isa<llhd::PrbOp>(op)) {
+        if (entryDistance.count(domBlock))
+          minBB = domBlock;
+      } else {
+        // The probe instruction has to stay in the same temporal region
+        unsigned minBBdist = -1;
+        for (Block *b :
+             trAnalysis.getBlocksInTR(trAnalysis.getBlockTR(block))) {
+          auto it = entryDistance.find(b);
+          if (it == entryDistance.end() || it->second >= minBBdist ||
+              !dom.dominates(domBlock, b))
+            continue;
+          minBBdist = it->second;
           minBB = b;
         }
       }
@@ -0,0 +1,90 @@
+//===- InlineEntitiesPass.cpp - Flatten combinational entities ------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Implement a pass that inlines the instances of purely combinational entities
+// into the entity instantiating them.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetails.h"
+#include "circt/Dialect/LLHD/IR/LLHDOps.h"
+#include "circt/Dialect/LLHD/Transforms/Passes.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+
+using namespace mlir;
+using namespace circt;
+
+namespace {
+struct InlineEntitiesPass
+    : public llhd::InlineEntitiesBase<InlineEntitiesPass> {
+  void runOnOperation() override;
+};
+} // namespace
+
+/// Return true if `entity` neither owns any signals or state, nor
+/// instantiates other units, i.e. if it only probes and drives the signals
+/// passed to it.
+static bool isCombinational(llhd::EntityOp entity) {
+  return llvm::all_of(entity.getBody().front(), [](Operation &op) {
+    if (isa<llhd::PrbOp, llhd::DrvOp>(op))
+      return true;
+    return op.getNumRegions() == 0 && MemoryEffectOpInterface::hasNoEffect(&op);
+  });
+}
+
+/// Replace `inst` with a copy of the body of `entity`.
+static void inlineInstance(llhd::InstOp inst, llhd::EntityOp entity) {
+  auto &body = entity.getBody().front();
+  BlockAndValueMapping mapping;
+  mapping.map(body.getArguments(), inst.getOperands());
+
+  // The body is a graph region, so operations may use values defined after
+  // them. Only remap the operands once all operations have been cloned.
+  OpBuilder builder(inst);
+  SmallVector<Operation *> clones;
+  for (auto &op : body) {
+    auto *clone = builder.cloneWithoutRegions(op);
+    mapping.map(op.getResults(), clone->getResults());
+    clones.push_back(clone);
+  }
+  for (auto *clone : clones)
+    for (auto &operand : clone->getOpOperands())
+      operand.set(mapping.lookupOrDefault(operand.get()));
+
+  inst.erase();
+}
+
+void InlineEntitiesPass::runOnOperation() {
+  ModuleOp module = getOperation();
+  SymbolTable symbolTable(module);
+
+  // Only inline instances of entities that are combinational already. Their
+  // parents may become combinational in turn, which is picked up by the next
+  // iteration.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    SmallVector<llhd::InstOp> insts;
+    module.walk([&](llhd::InstOp inst) { insts.push_back(inst); });
+    for (auto inst : insts) {
+      auto entity = symbolTable.lookup<llhd::EntityOp>(inst.getCallee());
+      if (!entity || entity == inst->getParentOp() || !isCombinational(entity))
+        continue;
+      inlineInstance(inst, entity);
+      ++numInstancesInlined;
+      changed = true;
+    }
+  }
+}
+
+std::unique_ptr<OperationPass<ModuleOp>>
+circt::llhd::createInlineEntitiesPass() {
+  return std::make_unique<InlineEntitiesPass>();
+}
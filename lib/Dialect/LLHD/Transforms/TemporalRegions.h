@@ -31,7 +31,7 @@ struct TemporalRegionAnalysis {
   unsigned getNumTemporalRegions() { return numTRs; }
 
   int getBlockTR(Block *);
-  SmallVector<Block *, 8> getBlocksInTR(int);
+  ArrayRef<Block *> getBlocksInTR(int);
 
   SmallVector<Block *, 8> getExitingBlocksInTR(int);
   Block *getTREntryBlock(int);
@@ -19,54 +19,34 @@ using namespace msft;
 //===----------------------------------------------------------------------===//
 // PrimitiveDB.
 //===----------------------------------------------------------------------===//
-// NOTE: Nothing in this implementation is in any way the most optimal
-// implementation. We put off deciding what the correct data structure is until
-// we have a better handle of the operations it must accelerate. Performance is
-// not an immediate goal.
-//===----------------------------------------------------------------------===//
 
-PrimitiveDB::PrimitiveDB(MLIRContext *ctxt) : ctxt(ctxt) {}
+PrimitiveDB::PrimitiveDB(MLIRContext *) {}
 
 /// Assign an instance to a primitive. Return false if another instance is
 /// already placed at that location.
 LogicalResult PrimitiveDB::addPrimitive(PhysLocationAttr loc) {
-  DenseSet<PrimitiveType> &primsAtLoc = getLeaf(loc);
-  PrimitiveType prim = loc.getPrimitiveType().getValue();
-  if (primsAtLoc.contains(prim))
-    return failure();
-  primsAtLoc.insert(prim);
-  return success();
+  return success(locations.insert(loc).second);
 }
 
-/// Assign an instance to a primitive. Return false if another instance is
-/// already placed at that location.
 /// Check to see if a primitive exists.
-bool PrimitiveDB::isValidLocation(PhysLocationAttr loc) {
-  DenseSet<PrimitiveType> primsAtLoc = getLeaf(loc);
-  return primsAtLoc.contains(loc.getPrimitiveType().getValue());
-}
-
-PrimitiveDB::DimPrimitiveType &PrimitiveDB::getLeaf(PhysLocationAttr loc) {
-  return placements[loc.getX()][loc.getY()][loc.getNum()];
+bool PrimitiveDB::isValidLocation(PhysLocationAttr loc) const {
+  return locations.contains(loc);
 }
 
 void PrimitiveDB::foreach (
     function_ref<void(PhysLocationAttr)> callback) const {
-  for (auto x : placements)
-    for (auto y : x.second)
-      for (auto n : y.second)
-        for (auto p : n.second)
-          callback(PhysLocationAttr::get(ctxt, PrimitiveTypeAttr::get(ctxt, p),
-                                         x.first, y.first, n.first));
+  for (PhysLocationAttr loc : locations)
+    callback(loc);
 }
 
 //===----------------------------------------------------------------------===//
 // PlacementDB.
 //===----------------------------------------------------------------------===//
-// NOTE: Nothing in this implementation is in any way the most optimal
-// implementation. We put off deciding what the correct data structure is until
-// we have a better handle of the operations it must accelerate. Performance is
-// not an immediate goal.
+// The cells are kept sorted by column, row and number to walk them in order
+// and within bounds without filtering. Placement scripts issue many point and
+// nearest free queries, so every location is additionally indexed by its
+// (uniqued) attribute and the unoccupied cells of every column are kept in
+// sorted sets.
 //===----------------------------------------------------------------------===//
 
 PlacementDB::PlacementDB(mlir::ModuleOp topMod)
@@ -76,7 +56,7 @@ PlacementDB::PlacementDB(mlir::ModuleOp topMod)
 PlacementDB::PlacementDB(mlir::ModuleOp topMod, const PrimitiveDB &seed)
     : ctxt(topMod->getContext()), topMod(topMod), seeded(false) {
 
-  seed.foreach ([this](PhysLocationAttr loc) { (void)getLeaf(loc); });
+  seed.foreach ([this](PhysLocationAttr loc) { (void)addCell(loc); });
   seeded = true;
   addDesignPlacements();
 }
@@ -112,6 +92,60 @@ PDRegPhysLocationOp PlacementDB::place(DynamicInstanceOp inst,
   return locOp;
 }
 
+SmallVector<DynInstDataOpInterface>
+PlacementDB::placeAll(ArrayRef<PlacementRequest> requests, Location srcLoc) {
+  SmallVector<DynInstDataOpInterface> results;
+  results.reserve(requests.size());
+  SmallVector<PlacementCell *> leaves;
+  for (const PlacementRequest &req : requests) {
+    // Check all the locations before building anything, such that conflicts
+    // don't build and erase ops.
+    PhysLocationAttr physLoc = req.loc.dyn_cast<PhysLocationAttr>();
+    ArrayRef<PhysLocationAttr> locs =
+        physLoc ? ArrayRef<PhysLocationAttr>(physLoc)
+                : req.loc.cast<LocationVectorAttr>().getLocs();
+    leaves.clear();
+    bool available = llvm::all_of(locs, [&](PhysLocationAttr loc) {
+      if (!loc)
+        return true;
+      PlacementCell *leaf = getLeaf(loc);
+      if (!leaf) {
+        emitError(srcLoc, "Could not apply placement. Invalid location: ")
+            << loc;
+        return false;
+      }
+      if (leaf->locOp || llvm::is_contained(leaves, leaf)) {
+        emitError(srcLoc, "Could not apply placement ")
+            << loc << ". Position already occupied";
+        return false;
+      }
+      leaves.push_back(leaf);
+      return true;
+    });
+    if (!available) {
+      results.push_back({});
+      continue;
+    }
+
+    OpBuilder builder(req.inst.getBody());
+    DynInstDataOpInterface op;
+    if (physLoc) {
+      StringAttr subPathAttr;
+      if (!req.subPath.empty())
+        subPathAttr = builder.getStringAttr(req.subPath);
+      op = builder.create<PDPhysLocationOp>(srcLoc, physLoc, subPathAttr,
+                                            FlatSymbolRefAttr());
+    } else {
+      op = builder.create<PDRegPhysLocationOp>(
+          srcLoc, req.loc.cast<LocationVectorAttr>(), FlatSymbolRefAttr());
+    }
+    for (PlacementCell *leaf : leaves)
+      setOccupant(leaf, op);
+    results.push_back(op);
+  }
+  return results;
+}
+
 LogicalResult PlacementDB::insertPlacement(DynInstDataOpInterface op,
                                            PhysLocationAttr loc) {
   if (!loc)
@@ -126,7 +160,7 @@ LogicalResult PlacementDB::insertPlacement(DynInstDataOpInterface op,
            << cast<DynamicInstanceOp>(leaf->locOp->getParentOp())
                   .globalRefPath();
 
-  leaf->locOp = op;
+  setOccupant(leaf, op);
   return success();
 }
 
@@ -254,7 +288,7 @@ void PlacementDB::removePlacement(DynInstDataOpInterface op,
   PlacementCell *leaf = getLeaf(loc);
   assert(leaf && "Could not find op at location specified by op");
   assert(leaf->locOp == op);
-  leaf->locOp = {};
+  setOccupant(leaf, {});
 }
 
 LogicalResult PlacementDB::movePlacementCheck(DynInstDataOpInterface op,
@@ -292,57 +326,79 @@ void PlacementDB::movePlacement(DynInstDataOpInterface op,
     return;
   PlacementCell *oldLeaf = getLeaf(from);
   PlacementCell *newLeaf = getLeaf(to);
-  newLeaf->locOp = op;
-  oldLeaf->locOp = {};
+  setOccupant(newLeaf, op);
+  setOccupant(oldLeaf, {});
 }
 
 /// Lookup the instance at a particular location.
-DynInstDataOpInterface PlacementDB::getInstanceAt(PhysLocationAttr loc) {
-  auto innerMap = placements[loc.getX()][loc.getY()][loc.getNum()];
-  auto instF = innerMap.find(loc.getPrimitiveType().getValue());
-  if (instF == innerMap.end())
+DynInstDataOpInterface
+PlacementDB::getInstanceAt(PhysLocationAttr loc) const {
+  PlacementCell *cell = cells.lookup(loc);
+  if (!cell)
     return {};
-  if (!instF->getSecond().locOp)
-    return {};
-  return instF->getSecond().locOp;
+  return cell->locOp;
 }
 
 PhysLocationAttr PlacementDB::getNearestFreeInColumn(PrimitiveType prim,
                                                      uint64_t columnNum,
                                                      uint64_t nearestToY) {
-  // Simplest possible algorithm.
-  PhysLocationAttr nearest = {};
-  walkPlacements(
-      [&nearest, nearestToY](PhysLocationAttr loc, Operation *locOp) {
-        if (locOp)
-          return;
-        if (!nearest) {
-          nearest = loc;
-          return;
-        }
-        int64_t curDist =
-            std::abs((int64_t)nearestToY - (int64_t)nearest.getY());
-        int64_t replDist = std::abs((int64_t)nearestToY - (int64_t)loc.getY());
-        if (replDist < curDist)
-          nearest = loc;
-      },
-      std::make_tuple(columnNum, columnNum, -1, -1), prim);
-  return nearest;
+  auto freeF = freeCells.find({columnNum, prim});
+  if (freeF == freeCells.end() || freeF->second.empty())
+    return {};
+  FreeCells &free = freeF->second;
+
+  // The nearest free cell is either the first one at or above 'nearestToY',
+  // or the last one below it.
+  auto above = free.lower_bound({nearestToY, 0});
+  auto nearest = above;
+  if (above == free.end() ||
+      (above != free.begin() &&
+       nearestToY - std::prev(above)->first <= above->first - nearestToY))
+    nearest = std::prev(above);
+
+  Column &column = placements[columnNum];
+  return column.find({nearest->first, nearest->second, prim})->second.loc;
 }
 
 PlacementDB::PlacementCell *PlacementDB::getLeaf(PhysLocationAttr loc) {
+  if (PlacementCell *cell = cells.lookup(loc))
+    return cell;
+  if (seeded)
+    return {};
+  return addCell(loc);
+}
+
+PlacementDB::PlacementCell *PlacementDB::addCell(PhysLocationAttr loc) {
   PrimitiveType primType = loc.getPrimitiveType().getValue();
+  PlacementCell &cell =
+      placements[loc.getX()][{loc.getY(), loc.getNum(), primType}];
+  cell.loc = loc;
+  cells[loc] = &cell;
+  freeCells[{loc.getX(), primType}].insert({loc.getY(), loc.getNum()});
+  return &cell;
+}
 
-  DimNumMap &nums = placements[loc.getX()][loc.getY()];
-  if (!seeded)
-    return &nums[loc.getNum()][primType];
-  if (!nums.count(loc.getNum()))
-    return {};
+void PlacementDB::setOccupant(PlacementCell *cell, DynInstDataOpInterface op) {
+  PhysLocationAttr loc = cell->loc;
+  FreeCells &free = freeCells[{loc.getX(), loc.getPrimitiveType().getValue()}];
+  if (op)
+    free.erase({loc.getY(), loc.getNum()});
+  else
+    free.insert({loc.getY(), loc.getNum()});
+  cell->locOp = op;
+}
 
-  DimDevType &primitives = nums[loc.getNum()];
-  if (primitives.count(primType) == 0)
-    return {};
-  return &primitives[primType];
+/// Visit the elements of the sorted 'range' in 'direction'.
+template <typename Range, typename Callback>
+static void walkInDirection(Range range, PlacementDB::Direction direction,
+                            Callback callback) {
+  if (direction == PlacementDB::Direction::DESC) {
+    for (auto &entry : llvm::reverse(range))
+      callback(entry);
+    return;
+  }
+  for (auto &entry : range)
+    callback(entry);
 }
 
 /// Walker for placements.
@@ -350,73 +406,34 @@ void PlacementDB::walkPlacements(
     function_ref<void(PhysLocationAttr, DynInstDataOpInterface)> callback,
     std::tuple<int64_t, int64_t, int64_t, int64_t> bounds,
     Optional<PrimitiveType> primType, Optional<WalkOrder> walkOrder) {
+  constexpr uint64_t unbounded = std::numeric_limits<uint64_t>::max();
   uint64_t xmin = std::get<0>(bounds) < 0 ? 0 : std::get<0>(bounds);
-  uint64_t xmax = std::get<1>(bounds) < 0 ? std::numeric_limits<uint64_t>::max()
-                                          : (uint64_t)std::get<1>(bounds);
+  uint64_t xmax =
+      std::get<1>(bounds) < 0 ? unbounded : (uint64_t)std::get<1>(bounds);
   uint64_t ymin = std::get<2>(bounds) < 0 ? 0 : std::get<2>(bounds);
-  uint64_t ymax = std::get<3>(bounds) < 0 ? std::numeric_limits<uint64_t>::max()
-                                          : (uint64_t)std::get<3>(bounds);
-
-  // TODO: Since the data structures we're using aren't sorted, the best we can
-  // do is iterate and filter. If a specific order is requested, we sort the
-  // keys by that as we go. Once we get to performance, we'll figure out the
-  // right data structure.
-
-  auto maybeSort = [](auto &container, auto direction) {
-    if (!direction.has_value())
-      return;
-    if (*direction == Direction::NONE)
-      return;
-
-    llvm::sort(container, [direction](auto colA, auto colB) {
-      if (*direction == Direction::ASC)
-        return colA.first < colB.first;
-
-      return colA.first > colB.first;
+  uint64_t ymax =
+      std::get<3>(bounds) < 0 ? unbounded : (uint64_t)std::get<3>(bounds);
+  WalkOrder order =
+      walkOrder.value_or(WalkOrder{Direction::NONE, Direction::NONE});
+
+  // Both the columns and the cells within them are sorted, hence the bounds
+  // translate into ranges of the maps.
+  auto colsEnd =
+      xmax == unbounded ? placements.end() : placements.upper_bound(xmax);
+  auto cols = llvm::make_range(placements.lower_bound(xmin), colsEnd);
+  walkInDirection(cols, order.columns, [&](auto &col) {
+    Column &column = col.second;
+    auto rowsEnd = ymax == unbounded
+                       ? column.end()
+                       : column.lower_bound({ymax + 1, 0, PrimitiveType()});
+    auto rows = llvm::make_range(column.lower_bound({ymin, 0, PrimitiveType()}),
+                                 rowsEnd);
+    walkInDirection(rows, order.rows, [&](auto &entry) {
+      if (primType && std::get<2>(entry.first) != *primType)
+        return;
+      callback(entry.second.loc, entry.second.locOp);
     });
-  };
-
-  // X loop.
-  SmallVector<std::pair<size_t, DimYMap>> cols(placements.begin(),
-                                               placements.end());
-  maybeSort(cols, walkOrder.transform([](auto wo) { return wo.columns; }));
-  for (auto colF : cols) {
-    size_t x = colF.first;
-    if (x < xmin || x > xmax)
-      continue;
-    DimYMap yMap = colF.second;
-
-    // Y loop.
-    SmallVector<std::pair<size_t, DimNumMap>> rows(yMap.begin(), yMap.end());
-    maybeSort(rows, walkOrder.transform([](auto wo) { return wo.rows; }));
-    for (auto rowF : rows) {
-      size_t y = rowF.first;
-      if (y < ymin || y > ymax)
-        continue;
-      DimNumMap numMap = rowF.second;
-
-      // Num loop.
-      for (auto numF = numMap.begin(), numE = numMap.end(); numF != numE;
-           ++numF) {
-        size_t num = numF->getFirst();
-        DimDevType devMap = numF->getSecond();
-
-        // DevType loop.
-        for (auto devF = devMap.begin(), devE = devMap.end(); devF != devE;
-             ++devF) {
-          PrimitiveType devtype = devF->getFirst();
-          if (primType && devtype != *primType)
-            continue;
-          PlacementCell &inst = devF->getSecond();
-
-          // Marshall and run the callback.
-          PhysLocationAttr loc = PhysLocationAttr::get(
-              ctxt, PrimitiveTypeAttr::get(ctxt, devtype), x, y, num);
-          callback(loc, inst.locOp);
-        }
-      }
-    }
-  }
+  });
 }
 
 /// Walk the region placement information.
@@ -22,6 +22,7 @@
 #include "circt/Dialect/Seq/SeqOps.h"
 #include "circt/Support/LLVM.h"
 #include "mlir/IR/Builders.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Tools/mlir-translate/Translation.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/TypeSwitch.h"
@@ -76,22 +77,37 @@ Operation *TclEmitter::getDefinition(FlatSymbolRefAttr sym) {
   return topLevelSymbols.getDefinition(sym);
 }
 
+/// The number of ops whose Tcl is formatted as a unit on one thread.
+static constexpr size_t kOpsPerShard = 256;
+
 // TODO: Currently assumes Stratix 10 and QuartusPro. Make more general.
 namespace {
+/// The Tcl of a contiguous range of the ops of one instance. Shards are
+/// formatted in parallel, hence the symbol references are collected locally
+/// and only numbered once the shards are concatenated.
+struct TclShard {
+  std::string text;
+  /// The offsets into 'text' at which the placeholders of the corresponding
+  /// 'symbolRefs' go.
+  SmallVector<size_t> refOffsets;
+  SmallVector<Attribute> symbolRefs;
+  SmallVector<GlobalRefOp> usedRefs;
+};
+
 /// Utility struct to assist in output and track other relevent state which are
 /// not specific to the entity hierarchy (global WRT to the entity hierarchy).
 struct TclOutputState {
-  TclOutputState(TclEmitter &emitter, llvm::raw_ostream &os)
-      : os(os), emitter(emitter) {}
+  TclOutputState(TclEmitter &emitter, TclShard &shard)
+      : os(shard.text), emitter(emitter), shard(shard) {}
 
-  llvm::raw_ostream &os;
+  llvm::raw_string_ostream os;
   llvm::raw_ostream &indent() {
     os.indent(2);
     return os;
   };
 
   TclEmitter &emitter;
-  SmallVector<Attribute> symbolRefs;
+  TclShard &shard;
 
   void emit(PhysLocationAttr);
   LogicalResult emitLocationAssignment(DynInstDataOpInterface refOp,
@@ -112,7 +128,7 @@ struct TclOutputState {
     auto ref = dyn_cast_or_null<hw::GlobalRefOp>(
         emitter.getDefinition(op.getGlobalRefSym()));
     if (ref)
-      emitter.usedRef(ref);
+      shard.usedRefs.push_back(ref);
     else
       op.emitOpError("could not find hw.globalRef named ")
           << op.getGlobalRefSym();
@@ -122,12 +138,10 @@ struct TclOutputState {
 } // anonymous namespace
 
 void TclOutputState::emitInnerRefPart(hw::InnerRefAttr innerRef) {
-  // We append new symbolRefs to the state, so s.symbolRefs.size() is the
-  // index of the InnerRefAttr we are about to add.
-  os << "{{" << symbolRefs.size() << "}}";
-
-  // Append a new inner reference for the template above.
-  symbolRefs.push_back(innerRef);
+  // Leave a hole for the "{{index}}" placeholder, which is only known once
+  // the preceding shards are numbered.
+  shard.refOffsets.push_back(os.tell());
+  shard.symbolRefs.push_back(innerRef);
 }
 
 void TclOutputState::emitPath(hw::GlobalRefOp ref,
@@ -284,38 +298,62 @@ LogicalResult TclEmitter::emit(Operation *hwMod, StringRef outputFile) {
   if (failed(populate()))
     return failure();
 
-  // Build up the output Tcl, tracking symbol references in state.
+  // Split the ops of every "instance" of 'hwMod' into shards and format the
+  // shards in parallel.
+  auto &tclOpsForInstances = tclOpsForModInstance[hwMod];
+  SmallVector<std::pair<size_t, ArrayRef<DynInstDataOpInterface>>> ranges;
+  for (auto [instIdx, tclOpsForInstancesKV] :
+       llvm::enumerate(tclOpsForInstances)) {
+    ArrayRef<DynInstDataOpInterface> tclOpsForMod = tclOpsForInstancesKV.second;
+    for (size_t i = 0, e = tclOpsForMod.size(); i < e; i += kOpsPerShard)
+      ranges.push_back({instIdx, tclOpsForMod.slice(
+                                     i, std::min(kOpsPerShard, e - i))});
+  }
+  SmallVector<TclShard> shards(ranges.size());
+  mlir::parallelFor(hwMod->getContext(), 0, ranges.size(), [&](size_t i) {
+    TclOutputState state(*this, shards[i]);
+    // Loop through the ops relevant to the specified root module "instance".
+    for (Operation *tclOp : ranges[i].second)
+      (void)TypeSwitch<Operation *, LogicalResult>(tclOp)
+          .Case([&](PDPhysLocationOp op) { return state.emit(op); })
+          .Case([&](PDRegPhysLocationOp op) { return state.emit(op); })
+          .Case([&](PDPhysRegionOp op) { return state.emit(op); })
+          .Case([&](DynamicInstanceVerbatimAttrOp op) {
+            return state.emit(op);
+          })
+          .Default([](Operation *op) {
+            return op->emitOpError("could not determine how to output tcl");
+          });
+  });
+
+  // Concatenate the shards in order, producing a tcl proc for each
+  // "instance" and numbering the symbol references.
   std::string s;
   llvm::raw_string_ostream os(s);
-  TclOutputState state(*this, os);
-
-  // Iterate through all the "instances" for 'hwMod' and produce a tcl proc for
-  // each one.
-  for (auto tclOpsForInstancesKV : tclOpsForModInstance[hwMod]) {
+  SmallVector<Attribute> symbolRefs;
+  size_t shardIdx = 0;
+  for (auto [instIdx, tclOpsForInstancesKV] :
+       llvm::enumerate(tclOpsForInstances)) {
     StringAttr instName = tclOpsForInstancesKV.first;
-    os << "proc {{" << state.symbolRefs.size() << "}}";
+    os << "proc {{" << symbolRefs.size() << "}}";
     if (instName)
       os << '_' << instName.getValue();
     os << "_config { parent } {\n";
-    state.symbolRefs.push_back(SymbolRefAttr::get(hwMod));
-
-    // Loop through the ops relevant to the specified root module "instance".
-    LogicalResult ret = success();
-    auto &tclOpsForMod = tclOpsForInstancesKV.second;
-    for (Operation *tclOp : tclOpsForMod) {
-      LogicalResult rc =
-          TypeSwitch<Operation *, LogicalResult>(tclOp)
-              .Case([&](PDPhysLocationOp op) { return state.emit(op); })
-              .Case([&](PDRegPhysLocationOp op) { return state.emit(op); })
-              .Case([&](PDPhysRegionOp op) { return state.emit(op); })
-              .Case([&](DynamicInstanceVerbatimAttrOp op) {
-                return state.emit(op);
-              })
-              .Default([](Operation *op) {
-                return op->emitOpError("could not determine how to output tcl");
-              });
-      if (failed(rc))
-        ret = failure();
+    symbolRefs.push_back(SymbolRefAttr::get(hwMod));
+
+    for (; shardIdx < shards.size() && ranges[shardIdx].first == instIdx;
+         ++shardIdx) {
+      TclShard &shard = shards[shardIdx];
+      StringRef text = shard.text;
+      size_t pos = 0;
+      for (auto [offset, ref] : llvm::zip(shard.refOffsets, shard.symbolRefs)) {
+        os << text.slice(pos, offset) << "{{" << symbolRefs.size() << "}}";
+        symbolRefs.push_back(ref);
+        pos = offset;
+      }
+      os << text.drop_front(pos);
+      for (GlobalRefOp ref : shard.usedRefs)
+        usedRef(ref);
     }
     os << "}\n\n";
   }
@@ -324,7 +362,7 @@ LogicalResult TclEmitter::emit(Operation *hwMod, StringRef outputFile) {
   OpBuilder builder = OpBuilder::atBlockEnd(hwMod->getBlock());
   auto verbatim = builder.create<sv::VerbatimOp>(
       builder.getUnknownLoc(), os.str(), ValueRange{},
-      builder.getArrayAttr(state.symbolRefs));
+      builder.getArrayAttr(symbolRefs));
 
   // When requested, give the verbatim op an output file.
   if (!outputFile.empty()) {
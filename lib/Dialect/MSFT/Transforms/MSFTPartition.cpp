@@ -25,6 +25,8 @@
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
+#include <queue>
+
 using namespace circt;
 using namespace msft;
 
@@ -48,6 +50,14 @@ private:
   void partition(MSFTModuleOp mod);
   MSFTModuleOp partition(DesignPartitionOp part, Block *partBlock);
 
+  /// Tag the untagged operations of 'mod' with its design partitions, keeping
+  /// the partitions within the budget.
+  void autoPartition(MSFTModuleOp mod);
+  /// Get the number of operations 'op' amounts to, looking through instances.
+  uint64_t getWeight(Operation *op);
+  /// The memoized weights of the modules.
+  DenseMap<Operation *, uint64_t> moduleWeights;
+
   void bubbleUp(MSFTModuleOp mod, Block *ops);
   void bubbleUpGlobalRefs(Operation *op, StringAttr parentMod,
                           StringAttr parentName,
@@ -82,6 +92,8 @@ void PartitionPass::runOnOperation() {
     (void)mlir::applyPatternsAndFoldGreedily(mod,
                                              mlir::FrozenRewritePatternSet());
     // Do the partitioning.
+    if (budget != 0)
+      autoPartition(mod);
     partition(mod);
     // Cleanup whatever mess we made.
     (void)mlir::applyPatternsAndFoldGreedily(mod,
@@ -229,6 +241,386 @@ void copyInto(MSFTModuleOp mod, DenseMap<SymbolRefAttr, Block *> &perPartBlocks,
   copyIntoPart(nonLocalTaggedOps, nonLocalBlock, true);
 }
 
+//===----------------------------------------------------------------------===//
+// Automatic partitioning.
+//===----------------------------------------------------------------------===//
+//
+// The operations of a module are assigned to its partitions with a multi-level
+// hypergraph partitioner: strongly connected operations are repeatedly
+// contracted, the coarsest hypergraph is partitioned by growing each partition
+// along its connections, and the assignment is refined with greedy moves while
+// projecting it back to the original operations.
+//
+//===----------------------------------------------------------------------===//
+
+/// Marks a node which may be assigned to any block.
+static constexpr int kFree = -1;
+/// Coarsening stops once there are at most this many nodes per block.
+static constexpr size_t kCoarseNodesPerBlock = 16;
+/// Nets with more pins are ignored when matching nodes, since they connect
+/// too many nodes to indicate which belong together.
+static constexpr size_t kMaxMatchingNetSize = 64;
+/// The maximum number of refinement passes on every level.
+static constexpr unsigned kNumRefinementPasses = 8;
+
+namespace {
+/// A hypergraph of the operations of a module, in which the nets are the values
+/// connecting them. Block 0 is the module itself and blocks 1 to N are its
+/// partitions. Node 0 stands for all the operations which stay in the module.
+struct Hypergraph {
+  size_t size() const { return weights.size(); }
+
+  unsigned addNode(uint64_t weight, int fixedBlock) {
+    weights.push_back(weight);
+    fixed.push_back(fixedBlock);
+    nodeNets.emplace_back();
+    return weights.size() - 1;
+  }
+
+  /// Add a net between the sorted and unique 'pins'. Nets with fewer than two
+  /// pins are dropped, since they can't be cut.
+  void addNet(ArrayRef<unsigned> pins, uint64_t weight) {
+    if (pins.size() < 2)
+      return;
+    for (unsigned pin : pins)
+      nodeNets[pin].push_back(nets.size());
+    nets.emplace_back(pins.begin(), pins.end());
+    netWeights.push_back(weight);
+  }
+
+  SmallVector<uint64_t> weights;
+  /// The block a node is fixed to, or kFree.
+  SmallVector<int> fixed;
+  SmallVector<SmallVector<unsigned, 4>> nets;
+  SmallVector<uint64_t> netWeights;
+  SmallVector<SmallVector<unsigned, 4>> nodeNets;
+};
+} // anonymous namespace
+
+/// Contract pairs of strongly connected free nodes which together fit into
+/// 'budget'. Fills 'coarseOf' with the coarse node of every node.
+static Hypergraph coarsen(const Hypergraph &graph, uint64_t budget,
+                          SmallVectorImpl<unsigned> &coarseOf) {
+  constexpr unsigned unmatched = ~0u;
+  Hypergraph coarse;
+  coarseOf.assign(graph.size(), unmatched);
+  DenseMap<unsigned, double> scores;
+  for (unsigned u = 0, e = graph.size(); u < e; ++u) {
+    if (coarseOf[u] != unmatched)
+      continue;
+    coarseOf[u] = coarse.addNode(graph.weights[u], graph.fixed[u]);
+    if (graph.fixed[u] != kFree)
+      continue;
+
+    // Match 'u' with the unmatched neighbor it shares the most wires with,
+    // distributing the weight of every net over its pins.
+    scores.clear();
+    for (unsigned net : graph.nodeNets[u]) {
+      ArrayRef<unsigned> pins = graph.nets[net];
+      if (pins.size() > kMaxMatchingNetSize)
+        continue;
+      for (unsigned v : pins)
+        if (v != u && coarseOf[v] == unmatched && graph.fixed[v] == kFree &&
+            graph.weights[u] + graph.weights[v] <= budget)
+          scores[v] += (double)graph.netWeights[net] / (pins.size() - 1);
+    }
+    unsigned best = unmatched;
+    double bestScore = 0;
+    for (auto [v, score] : scores)
+      if (score > bestScore || (score == bestScore && v < best)) {
+        best = v;
+        bestScore = score;
+      }
+    if (best == unmatched)
+      continue;
+    coarseOf[best] = coarseOf[u];
+    coarse.weights[coarseOf[u]] += graph.weights[best];
+  }
+
+  SmallVector<unsigned, 4> coarsePins;
+  for (auto [pins, weight] : llvm::zip(graph.nets, graph.netWeights)) {
+    coarsePins.clear();
+    for (unsigned pin : pins)
+      coarsePins.push_back(coarseOf[pin]);
+    llvm::sort(coarsePins);
+    coarsePins.erase(std::unique(coarsePins.begin(), coarsePins.end()),
+                     coarsePins.end());
+    coarse.addNet(coarsePins, weight);
+  }
+  return coarse;
+}
+
+/// Assign the nodes to blocks by growing one partition after the other along
+/// the nets, starting from the heaviest unassigned node which fits. Nodes which
+/// don't fit anywhere stay in block 0.
+static SmallVector<unsigned> initialPartition(const Hypergraph &graph,
+                                              unsigned numBlocks,
+                                              uint64_t budget) {
+  SmallVector<unsigned> blocks(graph.size(), 0);
+  SmallVector<bool> assigned(graph.size(), false);
+  SmallVector<uint64_t> loads(numBlocks, 0);
+  SmallVector<unsigned> seeds;
+  for (unsigned u = 0, e = graph.size(); u < e; ++u) {
+    if (graph.fixed[u] == kFree) {
+      seeds.push_back(u);
+      continue;
+    }
+    blocks[u] = graph.fixed[u];
+    assigned[u] = true;
+    loads[blocks[u]] += graph.weights[u];
+  }
+  llvm::stable_sort(seeds, [&](unsigned a, unsigned b) {
+    return graph.weights[a] > graph.weights[b];
+  });
+
+  for (unsigned block = 1; block < numBlocks; ++block) {
+    // The wires every unassigned node shares with the block, with a queue of
+    // the best connected ones. Entries become stale as connections grow.
+    DenseMap<unsigned, uint64_t> connections;
+    std::priority_queue<std::pair<uint64_t, unsigned>> queue;
+    auto connect = [&](unsigned u) {
+      for (unsigned net : graph.nodeNets[u])
+        for (unsigned v : graph.nets[net])
+          if (!assigned[v]) {
+            uint64_t &connection = connections[v];
+            connection += graph.netWeights[net];
+            queue.push({connection, v});
+          }
+    };
+    auto assign = [&](unsigned u) {
+      blocks[u] = block;
+      assigned[u] = true;
+      loads[block] += graph.weights[u];
+      connect(u);
+    };
+    for (unsigned u = 0, e = graph.size(); u < e; ++u)
+      if (graph.fixed[u] == (int)block)
+        connect(u);
+
+    // Loads only grow, so a seed which doesn't fit never will.
+    auto *nextSeed = seeds.begin();
+    while (true) {
+      bool grown = false;
+      while (!queue.empty() && !grown) {
+        auto [connection, v] = queue.top();
+        queue.pop();
+        if (assigned[v] || connection != connections[v] ||
+            loads[block] + graph.weights[v] > budget)
+          continue;
+        assign(v);
+        grown = true;
+      }
+      if (grown)
+        continue;
+      while (nextSeed != seeds.end() &&
+             (assigned[*nextSeed] ||
+              loads[block] + graph.weights[*nextSeed] > budget))
+        ++nextSeed;
+      if (nextSeed == seeds.end())
+        break;
+      assign(*nextSeed);
+    }
+  }
+  return blocks;
+}
+
+/// Greedily move free nodes into the partition which reduces the number of
+/// bits crossing block boundaries the most, as long as it fits. Nodes never
+/// move back into block 0.
+static void refine(const Hypergraph &graph, SmallVectorImpl<unsigned> &blocks,
+                   unsigned numBlocks, uint64_t budget) {
+  SmallVector<uint64_t> loads(numBlocks, 0);
+  for (unsigned u = 0, e = graph.size(); u < e; ++u)
+    loads[blocks[u]] += graph.weights[u];
+  // The number of pins of every net in every block.
+  SmallVector<SmallVector<unsigned, 4>> pinCounts(
+      graph.nets.size(), SmallVector<unsigned, 4>(numBlocks, 0));
+  for (auto [net, pins] : llvm::enumerate(graph.nets))
+    for (unsigned pin : pins)
+      ++pinCounts[net][blocks[pin]];
+
+  SmallVector<int64_t> gains(numBlocks);
+  for (unsigned pass = 0; pass < kNumRefinementPasses; ++pass) {
+    bool improved = false;
+    for (unsigned u = 0, e = graph.size(); u < e; ++u) {
+      if (graph.fixed[u] != kFree)
+        continue;
+
+      // Leaving 'from' uncuts the nets of which 'u' is the last pin in it, and
+      // entering another block cuts those which have no pin in there yet.
+      unsigned from = blocks[u];
+      int64_t leaveGain = 0, totalWeight = 0;
+      std::fill(gains.begin(), gains.end(), 0);
+      for (unsigned net : graph.nodeNets[u]) {
+        int64_t weight = graph.netWeights[net];
+        totalWeight += weight;
+        if (pinCounts[net][from] == 1)
+          leaveGain += weight;
+        for (unsigned block = 1; block < numBlocks; ++block)
+          if (block != from && pinCounts[net][block] != 0)
+            gains[block] += weight;
+      }
+      unsigned best = from;
+      int64_t bestGain = 0;
+      for (unsigned block = 1; block < numBlocks; ++block) {
+        int64_t gain = leaveGain + gains[block] - totalWeight;
+        if (block != from && gain > bestGain &&
+            loads[block] + graph.weights[u] <= budget) {
+          best = block;
+          bestGain = gain;
+        }
+      }
+      if (best == from)
+        continue;
+
+      for (unsigned net : graph.nodeNets[u]) {
+        --pinCounts[net][from];
+        ++pinCounts[net][best];
+      }
+      loads[from] -= graph.weights[u];
+      loads[best] += graph.weights[u];
+      blocks[u] = best;
+      improved = true;
+    }
+    if (!improved)
+      break;
+  }
+}
+
+/// Partition 'graph' into 'numBlocks' blocks, of which all but block 0 are
+/// limited to 'budget'.
+static SmallVector<unsigned> partitionHypergraph(Hypergraph graph,
+                                                 unsigned numBlocks,
+                                                 uint64_t budget) {
+  SmallVector<Hypergraph> levels;
+  SmallVector<SmallVector<unsigned>> coarseOfs;
+  levels.push_back(std::move(graph));
+  while (levels.back().size() > kCoarseNodesPerBlock * numBlocks) {
+    SmallVector<unsigned> coarseOf;
+    Hypergraph coarse = coarsen(levels.back(), budget, coarseOf);
+    // Stop once the matching hardly makes progress.
+    if (coarse.size() * 10 > levels.back().size() * 9)
+      break;
+    levels.push_back(std::move(coarse));
+    coarseOfs.push_back(std::move(coarseOf));
+  }
+
+  SmallVector<unsigned> blocks =
+      initialPartition(levels.back(), numBlocks, budget);
+  refine(levels.back(), blocks, numBlocks, budget);
+  for (size_t level = levels.size() - 1; level > 0; --level) {
+    const Hypergraph &fine = levels[level - 1];
+    SmallVector<unsigned> fineBlocks(fine.size());
+    for (unsigned u = 0, e = fine.size(); u < e; ++u)
+      fineBlocks[u] = blocks[coarseOfs[level - 1][u]];
+    blocks = std::move(fineBlocks);
+    refine(fine, blocks, numBlocks, budget);
+  }
+  return blocks;
+}
+
+uint64_t PartitionPass::getWeight(Operation *op) { // NOLINT(misc-no-recursion)
+  auto inst = dyn_cast<InstanceOp>(op);
+  if (!inst)
+    return 1;
+  FlatSymbolRefAttr modName = inst.getModuleNameAttr();
+  Operation *modOp = topLevelSyms.getDefinition(modName);
+  if (!modOp) // Modules created by this pass aren't in the cache.
+    modOp = SymbolTable::lookupNearestSymbolFrom(inst, modName);
+  auto mod = dyn_cast_or_null<MSFTModuleOp>(modOp);
+  if (!mod)
+    return 1;
+
+  auto weightF = moduleWeights.find(mod);
+  if (weightF != moduleWeights.end())
+    return weightF->second;
+  uint64_t weight = 0;
+  for (Operation &childOp : *mod.getBodyBlock())
+    if (!isWireManipulationOp(&childOp) && !isa<OutputOp>(childOp))
+      weight += getWeight(&childOp);
+  return moduleWeights[mod] = std::max<uint64_t>(weight, 1);
+}
+
+void PartitionPass::autoPartition(MSFTModuleOp mod) {
+  auto modSymbol = SymbolTable::getSymbolName(mod);
+  DenseMap<SymbolRefAttr, unsigned> partBlocks;
+  SmallVector<SymbolRefAttr> partRefs;
+  for (auto part : mod.getOps<DesignPartitionOp>()) {
+    SymbolRefAttr partRef =
+        SymbolRefAttr::get(modSymbol, {SymbolRefAttr::get(part)});
+    partRefs.push_back(partRef);
+    partBlocks[partRef] = partRefs.size();
+  }
+  if (partRefs.empty())
+    return;
+
+  // The children have been partitioned already, so their weights are final.
+  moduleWeights.clear();
+
+  // Every operation becomes a node, except for the wire manipulation ops which
+  // follow the operations they connect. Operations tagged for a partition of
+  // this module stay there, everything else which can't move belongs to node
+  // 0.
+  Block *body = mod.getBodyBlock();
+  Hypergraph graph;
+  SmallVector<Operation *> nodeOps;
+  nodeOps.push_back(nullptr);
+  (void)graph.addNode(0, 0);
+  DenseMap<Operation *, unsigned> nodes;
+  for (Operation &op : *body) {
+    if (isWireManipulationOp(&op))
+      continue;
+    unsigned node = 0;
+    if (auto partRef = getPart(&op)) {
+      auto blockF = partBlocks.find(partRef);
+      if (blockF != partBlocks.end())
+        node = graph.addNode(getWeight(&op), blockF->second);
+    } else if (!isa<OutputOp, DesignPartitionOp>(op)) {
+      node = graph.addNode(getWeight(&op), kFree);
+    }
+    if (node != 0)
+      nodeOps.push_back(&op);
+    nodes[&op] = node;
+  }
+
+  // Every result connects its producer to its consumers, looking through wire
+  // manipulation ops. Nets are weighted by their number of bits.
+  SmallVector<unsigned, 4> pins;
+  SmallVector<Value> worklist;
+  SmallPtrSet<Operation *, 8> visited;
+  for (Operation &op : *body) {
+    if (isWireManipulationOp(&op))
+      continue;
+    for (Value result : op.getResults()) {
+      pins.assign({nodes.lookup(&op)});
+      worklist.assign({result});
+      visited.clear();
+      while (!worklist.empty()) {
+        Value value = worklist.pop_back_val();
+        for (Operation *user : value.getUsers()) {
+          Operation *userOp = body->findAncestorOpInBlock(*user);
+          if (!userOp)
+            continue;
+          if (!isWireManipulationOp(userOp))
+            pins.push_back(nodes.lookup(userOp));
+          else if (visited.insert(userOp).second)
+            worklist.append(userOp->result_begin(), userOp->result_end());
+        }
+      }
+      llvm::sort(pins);
+      pins.erase(std::unique(pins.begin(), pins.end()), pins.end());
+      int64_t width = hw::getBitWidth(result.getType());
+      graph.addNet(pins, width > 0 ? width : 1);
+    }
+  }
+
+  SmallVector<unsigned> blocks =
+      partitionHypergraph(std::move(graph), partRefs.size() + 1, budget);
+  for (auto [op, block] : llvm::zip(nodeOps, blocks))
+    if (op && block != 0 && !getPart(op))
+      op->setAttr("targetDesignPartition", partRefs[block - 1]);
+}
+
 void PartitionPass::partition(MSFTModuleOp mod) {
   auto modSymbol = SymbolTable::getSymbolName(mod);
 
@@ -92,6 +92,38 @@ PackedType SimpleBitVectorType::getType(MLIRContext *context) const {
   return intType;
 }
 
+//===----------------------------------------------------------------------===//
+// Inner Type Storage
+//===----------------------------------------------------------------------===//
+
+namespace circt {
+namespace moore {
+namespace detail {
+
+/// Common storage of the types that wrap an inner type, i.e. dimensions and
+/// indirections. The inner type's domain, sign, and bit size are computed once
+/// when the wrapping type is created, such that queries on deeply nested types
+/// do not have to walk down to the core type every time.
+struct InnerTypeStorage : TypeStorage {
+  InnerTypeStorage(UnpackedType inner)
+      : inner(inner), innerDomain(inner.getDomain()),
+        innerSign(inner.getSign()), innerBitSize(inner.getBitSize()) {}
+
+  UnpackedType inner;
+  Domain innerDomain;
+  Sign innerSign;
+  Optional<unsigned> innerBitSize;
+};
+
+} // namespace detail
+} // namespace moore
+} // namespace circt
+
+/// Get the storage of a dimension or indirection type.
+static const detail::InnerTypeStorage &getInnerTypeStorage(Type type) {
+  return *static_cast<const detail::InnerTypeStorage *>(type.getImpl());
+}
+
 //===----------------------------------------------------------------------===//
 // Unpacked Type
 //===----------------------------------------------------------------------===//
@@ -114,7 +146,7 @@ Domain UnpackedType::getDomain() const {
   return TypeSwitch<UnpackedType, Domain>(*this)
       .Case<PackedType>([](auto type) { return type.getDomain(); })
       .Case<UnpackedIndirectType, UnpackedDim>(
-          [&](auto type) { return type.getInner().getDomain(); })
+          [&](auto type) { return getInnerTypeStorage(type).innerDomain; })
       .Case<UnpackedStructType>(
           [](auto type) { return type.getStruct().domain; })
       .Default([](auto) { return Domain::TwoValued; });
@@ -124,7 +156,7 @@ Sign UnpackedType::getSign() const {
   return TypeSwitch<UnpackedType, Sign>(*this)
       .Case<PackedType>([](auto type) { return type.getSign(); })
       .Case<UnpackedIndirectType, UnpackedDim>(
-          [&](auto type) { return type.getInner().getSign(); })
+          [&](auto type) { return getInnerTypeStorage(type).innerSign; })
       .Default([](auto) { return Sign::Unsigned; });
 }
 
@@ -133,17 +165,17 @@ Optional<unsigned> UnpackedType::getBitSize() const {
       .Case<PackedType, RealType>([](auto type) { return type.getBitSize(); })
       .Case<UnpackedUnsizedDim>([](auto) { return Optional<unsigned>{}; })
       .Case<UnpackedArrayDim>([](auto type) -> Optional<unsigned> {
-        if (auto size = type.getInner().getBitSize())
+        if (auto size = getInnerTypeStorage(type).innerBitSize)
           return (*size) * type.getSize();
         return {};
       })
       .Case<UnpackedRangeDim>([](auto type) -> Optional<unsigned> {
-        if (auto size = type.getInner().getBitSize())
+        if (auto size = getInnerTypeStorage(type).innerBitSize)
           return (*size) * type.getRange().size;
         return {};
       })
       .Case<UnpackedIndirectType>(
-          [](auto type) { return type.getInner().getBitSize(); })
+          [](auto type) { return getInnerTypeStorage(type).innerBitSize; })
       .Case<UnpackedStructType>(
           [](auto type) { return type.getStruct().bitSize; })
       .Default([](auto) { return llvm::None; });
@@ -257,7 +289,7 @@ Domain PackedType::getDomain() const {
       .Case<VoidType>([](auto) { return Domain::TwoValued; })
       .Case<IntType>([&](auto type) { return type.getDomain(); })
       .Case<PackedIndirectType, PackedDim>(
-          [&](auto type) { return type.getInner().getDomain(); })
+          [&](auto type) { return getInnerTypeStorage(type).innerDomain; })
       .Case<EnumType>([](auto type) { return type.getBase().getDomain(); })
       .Case<PackedStructType>(
           [](auto type) { return type.getStruct().domain; });
@@ -269,7 +301,7 @@ Sign PackedType::getSign() const {
       .Case<IntType, PackedStructType>(
           [&](auto type) { return type.getSign(); })
       .Case<PackedIndirectType, PackedDim>(
-          [&](auto type) { return type.getInner().getSign(); })
+          [&](auto type) { return getInnerTypeStorage(type).innerSign; })
       .Case<EnumType>([](auto type) { return type.getBase().getSign(); });
 }
 
@@ -279,12 +311,12 @@ Optional<unsigned> PackedType::getBitSize() const {
       .Case<IntType>([](auto type) { return type.getBitSize(); })
       .Case<PackedUnsizedDim>([](auto) { return Optional<unsigned>{}; })
       .Case<PackedRangeDim>([](auto type) -> Optional<unsigned> {
-        if (auto size = type.getInner().getBitSize())
+        if (auto size = getInnerTypeStorage(type).innerBitSize)
           return (*size) * type.getRange().size;
         return {};
       })
       .Case<PackedIndirectType>(
-          [](auto type) { return type.getInner().getBitSize(); })
+          [](auto type) { return getInnerTypeStorage(type).innerBitSize; })
       .Case<EnumType>([](auto type) { return type.getBase().getBitSize(); })
       .Case<PackedStructType>(
           [](auto type) { return type.getStruct().bitSize; });
@@ -566,14 +598,15 @@ namespace circt {
 namespace moore {
 namespace detail {
 
-struct IndirectTypeStorage : TypeStorage {
+struct IndirectTypeStorage : InnerTypeStorage {
   using KeyTy = std::tuple<UnpackedType, StringAttr, LocationAttr>;
 
   IndirectTypeStorage(KeyTy key)
       : IndirectTypeStorage(std::get<0>(key), std::get<1>(key),
                             std::get<2>(key)) {}
   IndirectTypeStorage(UnpackedType inner, StringAttr name, LocationAttr loc)
-      : inner(inner), name(name), loc(loc) {}
+      : InnerTypeStorage(inner), fullyResolved(inner.fullyResolved()),
+        name(name), loc(loc) {}
   bool operator==(const KeyTy &key) const {
     return std::get<0>(key) == inner && std::get<1>(key) == name &&
            std::get<2>(key) == loc;
@@ -584,7 +617,7 @@ struct IndirectTypeStorage : TypeStorage {
         IndirectTypeStorage(key);
   }
 
-  UnpackedType inner;
+  UnpackedType fullyResolved;
   StringAttr name;
   LocationAttr loc;
 };
@@ -593,6 +626,10 @@ UnpackedType getIndirectTypeInner(const TypeStorage *impl) {
   return static_cast<const IndirectTypeStorage *>(impl)->inner;
 }
 
+UnpackedType getIndirectTypeFullyResolved(const TypeStorage *impl) {
+  return static_cast<const IndirectTypeStorage *>(impl)->fullyResolved;
+}
+
 Location getIndirectTypeLoc(const TypeStorage *impl) {
   return static_cast<const IndirectTypeStorage *>(impl)->loc;
 }
@@ -639,10 +676,10 @@ namespace circt {
 namespace moore {
 namespace detail {
 
-struct DimStorage : TypeStorage {
+struct DimStorage : InnerTypeStorage {
   using KeyTy = UnpackedType;
 
-  DimStorage(KeyTy key) : inner(key) {}
+  DimStorage(KeyTy key) : InnerTypeStorage(key) {}
   bool operator==(const KeyTy &key) const { return key == inner; }
   static DimStorage *construct(TypeStorageAllocator &allocator,
                                const KeyTy &key) {
@@ -693,7 +730,6 @@ struct DimStorage : TypeStorage {
     assert(succeeded(result));
   }
 
-  UnpackedType inner;
   UnpackedType resolved;
   UnpackedType fullyResolved;
 };
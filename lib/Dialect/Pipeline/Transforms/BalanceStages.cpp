@@ -0,0 +1,172 @@
+//===- BalanceStages.cpp - Stage balancing pass -----------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Contains the definitions of the stage balancing pass, which redistributes
+// the operations of a pipeline across its stages such that the longest
+// combinational path within any stage becomes as short as possible.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetails.h"
+#include "circt/Scheduling/Algorithms.h"
+#include "circt/Scheduling/Utilities.h"
+
+using namespace mlir;
+using namespace circt;
+using namespace pipeline;
+using namespace scheduling;
+
+/// The number of bisection steps taken to narrow down the smallest feasible
+/// stage delay.
+static constexpr unsigned kNumSearchSteps = 24;
+
+/// Returns the combinational delay of 'op' in the unit delay model, in which
+/// every operation takes one logic level, except for constants and operations
+/// which merely rewire bits.
+static float getDelay(Operation *op) {
+  if (op->hasTrait<OpTrait::ConstantLike>() ||
+      isa<comb::ExtractOp, comb::ConcatOp, hw::BitcastOp, ReturnOp>(op))
+    return 0.0f;
+  return 1.0f;
+}
+
+/// Returns the longest combinational path in 'prob' w.r.t. its current start
+/// times, i.e. the delay of the slowest stage.
+static float getMaxStageDelay(ChainingProblem &prob) {
+  float maxDelay = 0.0f;
+  for (auto *op : prob.getOperations()) {
+    auto opr = *prob.getLinkedOperatorType(op);
+    maxDelay = std::max(maxDelay, *prob.getStartTimeInCycle(op) +
+                                      *prob.getOutgoingDelay(opr));
+  }
+  return maxDelay;
+}
+
+namespace {
+
+class BalanceStagesPass : public BalanceStagesBase<BalanceStagesPass> {
+public:
+  void runOnOperation() override;
+};
+
+} // end anonymous namespace
+
+void BalanceStagesPass::runOnOperation() {
+  auto pipeline = getOperation();
+  Block *body = pipeline.getBodyBlock();
+  Operation *returnOp = body->getTerminator();
+
+  // Determine the stage that every operation currently belongs to.
+  SmallVector<PipelineStageOp> stages;
+  SmallVector<Operation *> ops;
+  DenseMap<Operation *, unsigned> oldStages;
+  for (auto &op : *body) {
+    if (auto stage = dyn_cast<PipelineStageOp>(op)) {
+      stages.push_back(stage);
+      continue;
+    }
+    // Once registers are materialized, the stages are fixed. Operations with
+    // regions are opaque to the delay model.
+    if (isa<PipelineStageRegisterOp>(op) || op.getNumRegions() != 0)
+      return markAllAnalysesPreserved();
+    ops.push_back(&op);
+    oldStages[&op] = stages.size();
+  }
+  if (stages.empty())
+    return markAllAnalysesPreserved();
+
+  // Operations using the valid signal of a stage cannot move across it.
+  for (auto stage : stages)
+    for (auto *user : stage.getValid().getUsers())
+      if (!isa<PipelineStageOp, ReturnOp>(user))
+        return markAllAnalysesPreserved();
+
+  // Model the body as a chaining problem of purely combinational operations,
+  // in which the time steps correspond to the stages. The auxiliary
+  // dependences keep all operations in front of the return.
+  auto prob = ChainingProblem::get(pipeline);
+  for (auto *op : ops) {
+    auto opr = prob.getOrInsertOperatorType(op->getName().getStringRef());
+    prob.setLatency(opr, 0);
+    prob.setIncomingDelay(opr, getDelay(op));
+    prob.setOutgoingDelay(opr, getDelay(op));
+    prob.insertOperation(op);
+    prob.setLinkedOperatorType(op, opr);
+  }
+  for (auto *op : ops) {
+    if (op == returnOp)
+      continue;
+    if (failed(prob.insertDependence({op, returnOp})))
+      return signalPassFailure();
+    for (auto operand : op->getOperands())
+      if (auto *def = operand.getDefiningOp();
+          def && oldStages.count(def) && oldStages[def] > oldStages[op])
+        return markAllAnalysesPreserved(); // Not a valid staging to begin with.
+  }
+  if (failed(prob.check()))
+    return signalPassFailure();
+
+  // The current stage delay is an upper bound for the achievable delay, and
+  // the critical path evenly spread over all stages is a lower bound.
+  for (auto *op : ops)
+    prob.setStartTime(op, oldStages[op]);
+  if (failed(computeStartTimesInCycle(prob)))
+    return signalPassFailure();
+  float oldDelay = getMaxStageDelay(prob);
+
+  for (auto *op : ops)
+    prob.setStartTime(op, 0);
+  if (failed(computeStartTimesInCycle(prob)))
+    return signalPassFailure();
+  float criticalPath = getMaxStageDelay(prob);
+
+  float maxOpDelay = 0.0f;
+  for (auto *op : ops)
+    maxOpDelay = std::max(maxOpDelay, getDelay(op));
+
+  unsigned numStages = stages.size();
+  auto fits = [&](float cycleTime) {
+    if (failed(scheduleSimplex(prob, returnOp, cycleTime)))
+      return false;
+    return *prob.getStartTime(returnOp) <= numStages;
+  };
+
+  // Bisect the smallest stage delay with which the operations still fit into
+  // the given number of stages.
+  float low = std::max(maxOpDelay, criticalPath / (numStages + 1));
+  float high = oldDelay;
+  if (low >= high)
+    return markAllAnalysesPreserved();
+  if (!fits(low)) {
+    for (unsigned i = 0; i < kNumSearchSteps; ++i) {
+      float mid = (low + high) / 2;
+      if (fits(mid))
+        high = mid;
+      else
+        low = mid;
+    }
+    if (!fits(high) || getMaxStageDelay(prob) >= oldDelay)
+      return markAllAnalysesPreserved();
+  }
+
+  // Move the operations behind the stage matching their start time. Moving
+  // all of them in their original order keeps that order within each stage.
+  for (auto *op : ops) {
+    if (op == returnOp)
+      continue;
+    unsigned newStage = *prob.getStartTime(op);
+    op->moveBefore(newStage < numStages ? stages[newStage].getOperation()
+                                        : returnOp);
+    if (newStage != oldStages[op])
+      ++numOpsMoved;
+  }
+}
+
+std::unique_ptr<mlir::Pass> circt::pipeline::createBalanceStagesPass() {
+  return std::make_unique<BalanceStagesPass>();
+}
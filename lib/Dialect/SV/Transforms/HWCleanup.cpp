@@ -17,6 +17,7 @@
 #include "circt/Dialect/HW/HWOps.h"
 #include "circt/Dialect/SV/SVAttributes.h"
 #include "circt/Dialect/SV/SVPasses.h"
+#include "llvm/ADT/TypeSwitch.h"
 
 using namespace circt;
 
@@ -88,6 +89,15 @@ static void mergeRegions(Region *region1, Region *region2) {
   }
 }
 
+/// Return the macro checked by an ifdef operation, or null if the operation is
+/// not an ifdef.
+static Attribute getIfDefCond(Operation &op) {
+  return TypeSwitch<Operation *, Attribute>(&op)
+      .Case<sv::IfDefOp, sv::IfDefProceduralOp>(
+          [](auto ifdef) { return ifdef.getCondAttr(); })
+      .Default([](auto) { return Attribute(); });
+}
+
 //===----------------------------------------------------------------------===//
 // HWCleanupPass
 //===----------------------------------------------------------------------===//
@@ -99,6 +109,7 @@ struct HWCleanupPass : public sv::HWCleanupBase<HWCleanupPass> {
   void runOnRegionsInOp(Operation &op);
   void runOnGraphRegion(Region &region);
   void runOnProceduralRegion(Region &region);
+  void inlineKnownIfDefs(Block &body);
 
 private:
   /// Inline all regions from the second operation into the first and delete the
@@ -116,6 +127,11 @@ private:
   }
 
   bool anythingChanged;
+
+  /// The macros which are known to be defined (true) or undefined (false)
+  /// within the regions currently being processed, because an enclosing ifdef
+  /// checks them.
+  DenseMap<Attribute, bool> knownMacros;
 };
 } // end anonymous namespace
 
@@ -134,6 +150,32 @@ void HWCleanupPass::runOnOperation() {
 /// Recursively process all of the regions in the specified op, dispatching to
 /// graph or procedural processing as appropriate.
 void HWCleanupPass::runOnRegionsInOp(Operation &op) {
+  // Within the regions of an ifdef, its macro is known to be defined or
+  // undefined, unless a verbatim operation in the regions defines or undefines
+  // it. Nested ifdefs with the same macro have already been inlined, unless
+  // they carry SV attributes.
+  auto cond = getIfDefCond(op);
+  if (cond && !knownMacros.count(cond)) {
+    bool hasVerbatim = op.walk([](Operation *nested) {
+                           return isa<sv::VerbatimOp>(nested)
+                                      ? WalkResult::interrupt()
+                                      : WalkResult::advance();
+                         }).wasInterrupted();
+    if (!hasVerbatim) {
+      bool isDefined = true;
+      for (auto &region : op.getRegions()) {
+        knownMacros[cond] = isDefined;
+        isDefined = false;
+        if (op.hasTrait<sv::ProceduralRegion>())
+          runOnProceduralRegion(region);
+        else
+          runOnGraphRegion(region);
+      }
+      knownMacros.erase(cond);
+      return;
+    }
+  }
+
   if (op.hasTrait<sv::ProceduralRegion>()) {
     for (auto &region : op.getRegions())
       runOnProceduralRegion(region);
@@ -148,6 +190,7 @@ void HWCleanupPass::runOnGraphRegion(Region &region) {
   if (region.getBlocks().size() != 1)
     return;
   Block &body = region.front();
+  inlineKnownIfDefs(body);
 
   // A set of operations in the current block which are mergable. Any
   // operation in this set is a candidate for another similar operation to
@@ -211,6 +254,7 @@ void HWCleanupPass::runOnProceduralRegion(Region &region) {
   if (region.getBlocks().size() != 1)
     return;
   Block &body = region.front();
+  inlineKnownIfDefs(body);
 
   Operation *lastSideEffectingOp = nullptr;
   for (Operation &op : llvm::make_early_inc_range(body)) {
@@ -249,6 +293,34 @@ void HWCleanupPass::runOnProceduralRegion(Region &region) {
   }
 }
 
+/// Replace the ifdefs in the block which check a macro whose state is already
+/// known from an enclosing ifdef with the contents of the region that is taken.
+/// The contents are processed as well, since they may contain further ifdefs.
+void HWCleanupPass::inlineKnownIfDefs(Block &body) {
+  if (knownMacros.empty())
+    return;
+  for (auto it = body.begin(); it != body.end();) {
+    Operation &op = *it;
+    auto cond = getIfDefCond(op);
+    auto known = cond ? knownMacros.find(cond) : knownMacros.end();
+    if (known == knownMacros.end() || sv::hasSVAttributes(&op)) {
+      ++it;
+      continue;
+    }
+
+    auto next = std::next(it);
+    auto &region = op.getRegion(known->second ? 0 : 1);
+    if (!region.empty() && !region.front().empty()) {
+      auto &ops = region.front().getOperations();
+      next = ops.begin();
+      body.getOperations().splice(it, ops);
+    }
+    op.erase();
+    it = next;
+    anythingChanged = true;
+  }
+}
+
 std::unique_ptr<Pass> circt::sv::createHWCleanupPass() {
   return std::make_unique<HWCleanupPass>();
 }
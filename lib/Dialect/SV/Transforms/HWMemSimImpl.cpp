@@ -18,6 +18,7 @@
 #include "circt/Dialect/HW/Namespace.h"
 #include "circt/Dialect/SV/SVPasses.h"
 #include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/IR/Threading.h"
 #include "llvm/ADT/TypeSwitch.h"
 
 using namespace circt;
@@ -574,7 +575,9 @@ void HWMemSimImpl::generateMemory(HWModuleOp op, FirMemory mem) {
 void HWMemSimImplPass::runOnOperation() {
   auto topModule = getOperation().getBody();
 
-  SmallVector<HWModuleGeneratedOp> toErase;
+  // Replace each generated memory with an empty module or an extern module.
+  // The bodies of the new modules are filled in afterwards, in parallel.
+  SmallVector<std::pair<HWModuleOp, FirMemory>> toGenerate;
   bool anythingChanged = false;
 
   for (auto op :
@@ -607,10 +610,7 @@ void HWMemSimImplPass::runOnOperation() {
           newModule->setAttr("output_file", outdir);
         newModule.setCommentAttr(
             builder.getStringAttr("VCS coverage exclude_file"));
-
-        HWMemSimImpl(ignoreReadEnableMem, stripMuxPragmas,
-                     disableMemRandomization, disableRegRandomization)
-            .generateMemory(newModule, mem);
+        toGenerate.push_back({newModule, mem});
       }
 
       oldModule.erase();
@@ -618,6 +618,13 @@ void HWMemSimImplPass::runOnOperation() {
     }
   }
 
+  // Generating a simulation model only touches the body of its own module.
+  mlir::parallelForEach(&getContext(), toGenerate, [&](auto &it) {
+    HWMemSimImpl(ignoreReadEnableMem, stripMuxPragmas, disableMemRandomization,
+                 disableRegRandomization)
+        .generateMemory(it.first, it.second);
+  });
+
   if (!anythingChanged)
     markAllAnalysesPreserved();
 }
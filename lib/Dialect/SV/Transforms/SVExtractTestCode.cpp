@@ -21,6 +21,7 @@
 #include "circt/Dialect/SV/SVPasses.h"
 #include "mlir/IR/BlockAndValueMapping.h"
 #include "mlir/IR/Builders.h"
+#include "mlir/IR/Threading.h"
 
 #include <set>
 
@@ -238,12 +239,13 @@ static StringRef getNameForPort(Value val, ArrayAttr modulePorts) {
 }
 
 // Given a set of values, construct a module and bind instance of that module
-// that passes those values through.  Returns the new module and the instance
-// pointing to it.
-static hw::HWModuleOp
+// that passes those values through.  Returns the new module and the bind of the
+// instance pointing to it.  Both are created detached: only the instance is
+// added to `op`, such that this may run concurrently for different modules.
+static std::pair<hw::HWModuleOp, sv::BindOp>
 createModuleForCut(hw::HWModuleOp op, SetVector<Value> &inputs,
                    BlockAndValueMapping &cutMap, StringRef suffix,
-                   Attribute path, Attribute fileName, BindTable &bindTable) {
+                   Attribute path, Attribute fileName) {
   // Filter duplicates and track duplicate reads of elements so we don't
   // make ports for them
   SmallVector<Value> realInputs;
@@ -262,8 +264,9 @@ createModuleForCut(hw::HWModuleOp op, SetVector<Value> &inputs,
     realInputs.push_back(v);
   }
 
-  // Create the extracted module right next to the original one.
-  OpBuilder b(op);
+  // Create the extracted module detached, it is later inserted right next to
+  // the original one.
+  OpBuilder b(op.getContext());
 
   // Construct the ports, this is just the input Values
   SmallVector<hw::PortInfo> ports;
@@ -299,15 +302,13 @@ createModuleForCut(hw::HWModuleOp op, SetVector<Value> &inputs,
       b.getStringAttr(
           ("__ETC_" + getVerilogModuleNameAttr(op).getValue() + suffix).str()));
   inst->setAttr("doNotPrint", b.getBoolAttr(true));
-  b = OpBuilder::atBlockEnd(
-      &op->getParentOfType<mlir::ModuleOp>()->getRegion(0).front());
 
+  b = OpBuilder(op.getContext());
   auto bindOp = b.create<sv::BindOp>(op.getLoc(), op.getNameAttr(),
                                      inst.getInnerSymAttr());
-  bindTable[op.getNameAttr()][inst.getInnerSymAttr()] = bindOp;
   if (fileName)
     bindOp->setAttr("output_file", fileName);
-  return newMod;
+  return {newMod, bindOp};
 }
 
 // Some blocks have terminators, some don't
@@ -356,12 +357,12 @@ static void updateOoOArgs(SmallVectorImpl<Operation *> &lateBoundOps,
 }
 
 // Do the cloning, which is just a pre-order traversal over the module looking
-// for marked ops.
+// for marked ops.  Migrated instances are added to `instances`, to be recorded
+// as instances within the new module in the instance graph.
 static void migrateOps(hw::HWModuleOp oldMod, hw::HWModuleOp newMod,
                        SetVector<Operation *> &depOps,
                        BlockAndValueMapping &cutMap,
-                       hw::InstanceGraph &instanceGraph) {
-  hw::InstanceGraphNode *newModNode = instanceGraph.lookup(newMod);
+                       SmallVectorImpl<hw::InstanceOp> &instances) {
   SmallVector<Operation *, 16> lateBoundOps;
   OpBuilder b = OpBuilder::atBlockBegin(newMod.getBodyBlock());
   oldMod.walk<WalkOrder::PreOrder>([&](Operation *op) {
@@ -371,11 +372,8 @@ static void migrateOps(hw::HWModuleOp oldMod, hw::HWModuleOp newMod,
       addBlockMapping(cutMap, op, newOp);
       if (hasOoOArgs(newMod, newOp))
         lateBoundOps.push_back(newOp);
-      if (auto instance = dyn_cast<hw::InstanceOp>(op)) {
-        hw::InstanceGraphNode *instMod =
-            instanceGraph.lookup(instance.getModuleNameAttr().getAttr());
-        newModNode->addInstance(instance, instMod);
-      }
+      if (auto instance = dyn_cast<hw::InstanceOp>(op))
+        instances.push_back(instance);
     }
   });
   updateOoOArgs(lateBoundOps, cutMap);
@@ -417,9 +415,10 @@ static void inlineInputOnly(hw::HWModuleOp oldMod,
       continue;
     }
 
-    // If the instance had a symbol, we can't inline it without more work.
+    // If the instance had a symbol, we can't inline it without more work.  If
+    // it was itself extracted from its parent, there is nothing to inline into.
     hw::InstanceOp inst = cast<hw::InstanceOp>(instLike.getOperation());
-    if (inst.getInnerSym().has_value()) {
+    if (inst.getInnerSym().has_value() || !inst->getBlock()) {
       allInlined = false;
       continue;
     }
@@ -496,6 +495,37 @@ static void inlineInputOnly(hw::HWModuleOp oldMod,
 
 namespace {
 
+/// Test code of one kind extracted from a module.  The new module and its bind
+/// are built detached, and are only added to the IR and the instance graph once
+/// all modules have been processed.
+struct ExtractedCode {
+  hw::HWModuleOp module;
+  sv::BindOp bind;
+
+  /// Instances migrated into `module`.
+  SmallVector<hw::InstanceOp> instances;
+};
+
+/// The result of extracting all test code from a module.
+struct ModuleExtraction {
+  SmallVector<ExtractedCode, 3> extracted;
+
+  /// Extracted instances, their forward dataflow, and anything else to erase
+  /// once the module has been fully processed.
+  SmallPtrSet<Operation *, 32> opsToErase;
+
+  /// Roots moved into an extracted module.  They are removed from the module
+  /// right away, but only destroyed once the instance graph has been updated.
+  SmallVector<Operation *> removedRoots;
+
+  /// Map from module name to set of instances extracted from this module.
+  DenseMap<StringAttr, SmallPtrSet<Operation *, 32>> extractedInstances;
+
+  size_t numOpsExtracted = 0;
+  size_t numOpsErased = 0;
+  bool failed = false;
+};
+
 struct SVExtractTestCodeImplPass
     : public SVExtractTestCodeBase<SVExtractTestCodeImplPass> {
   SVExtractTestCodeImplPass(bool disableInstanceExtraction,
@@ -507,10 +537,11 @@ struct SVExtractTestCodeImplPass
 
 private:
   // Run the extraction on a module, and return true if test code was extracted.
+  // This only modifies `module` itself and records everything else in
+  // `result`, such that it can run concurrently for different modules.
   bool doModule(hw::HWModuleOp module, std::function<bool(Operation *)> fn,
                 StringRef suffix, Attribute path, Attribute bindFile,
-                BindTable &bindTable,
-                SmallPtrSetImpl<Operation *> &opsToErase) {
+                ModuleExtraction &result) {
     bool hasError = false;
     // Find Operations of interest.
     SetVector<Operation *> roots;
@@ -524,7 +555,7 @@ private:
       }
     });
     if (hasError) {
-      signalPassFailure();
+      result.failed = true;
       return false;
     }
     // No Ops?  No problem.
@@ -546,31 +577,68 @@ private:
     // Find instances that directly feed the clone set, and add them if
     // possible.
     if (!disableInstanceExtraction)
-      addInstancesToCloneSet(inputs, opsToClone, opsToErase,
-                             extractedInstances);
-    numOpsExtracted += opsToClone.size();
-    numOpsErased += opsToErase.size();
+      addInstancesToCloneSet(inputs, opsToClone, result.opsToErase,
+                             result.extractedInstances);
+    result.numOpsExtracted += opsToClone.size();
+    result.numOpsErased += result.opsToErase.size();
 
     // Make a module to contain the clone set, with arguments being the cut
     BlockAndValueMapping cutMap;
-    auto bmod = createModuleForCut(module, inputs, cutMap, suffix, path,
-                                   bindFile, bindTable);
-
-    // Register the newly created module in the instance graph.
-    instanceGraph->addModule(bmod);
+    auto &code = result.extracted.emplace_back();
+    std::tie(code.module, code.bind) =
+        createModuleForCut(module, inputs, cutMap, suffix, path, bindFile);
 
     // do the clone
-    migrateOps(module, bmod, opsToClone, cutMap, *instanceGraph);
+    migrateOps(module, code.module, opsToClone, cutMap, code.instances);
 
-    // erase old operations of interest eagerly, removing from erase set.
+    // remove old operations of interest eagerly, removing from erase set.
+    // Instances among them are recorded in the instance graph later on, so
+    // they are only destroyed after that.
     for (auto *op : roots) {
-      opsToErase.erase(op);
-      op->erase();
+      result.opsToErase.erase(op);
+      op->dropAllReferences();
+      op->remove();
+      result.removedRoots.push_back(op);
     }
 
     return true;
   }
 
+  // Add the modules and binds extracted from `module` to the IR and the
+  // instance graph.
+  void finalizeModule(hw::HWModuleOp module, ModuleExtraction &result,
+                      BindTable &bindTable) {
+    auto *topLevelModule = module->getBlock();
+    for (auto &code : result.extracted) {
+      // Insert the extracted module right next to the original one, and the
+      // bind at the end of the design.
+      topLevelModule->getOperations().insert(module->getIterator(),
+                                             code.module);
+      topLevelModule->push_back(code.bind);
+      bindTable[module.getNameAttr()][code.bind.getInstanceAttr().getName()] =
+          code.bind;
+
+      // Register the newly created module and its instances in the instance
+      // graph.
+      auto *node = instanceGraph->addModule(code.module);
+      for (auto instance : code.instances)
+        node->addInstance(
+            instance,
+            instanceGraph->lookup(instance.getModuleNameAttr().getAttr()));
+    }
+
+    for (auto *op : result.removedRoots)
+      op->erase();
+
+    for (auto &[moduleName, instances] : result.extractedInstances)
+      extractedInstances[moduleName].insert(instances.begin(),
+                                            instances.end());
+    numOpsExtracted += result.numOpsExtracted;
+    numOpsErased += result.numOpsErased;
+    if (result.failed)
+      signalPassFailure();
+  }
+
   // Move any modules that had all instances extracted to the testbench path.
   void maybeMoveExtractedModules(hw::InstanceGraph &instanceGraph,
                                  Attribute testBenchDir) {
@@ -672,47 +740,63 @@ void SVExtractTestCodeImplPass::runOnOperation() {
     return isa<CoverOp>(op) || isa<CoverConcurrentOp>(op);
   };
 
-  BindTable bindTable;
-  for (auto &op : llvm::make_early_inc_range(topLevelModule->getOperations())) {
-    if (auto rtlmod = dyn_cast<hw::HWModuleOp>(op)) {
-      // Extract two sets of ops to different modules.  This will add modules,
-      // but not affect modules in the symbol table.  If any instance of the
-      // module is bound, then extraction is skipped.  This avoids problems
-      // where certain simulators dislike having binds that target bound
-      // modules.
-      if (isBound(rtlmod, *instanceGraph))
-        continue;
+  // Collect the modules to extract test code from.  Being bound is only ever
+  // introduced by this pass for the extracted modules, so this can be decided
+  // for all modules up front.
+  SmallVector<hw::HWModuleOp> modules;
+  for (auto rtlmod : topLevelModule->getOps<hw::HWModuleOp>()) {
+    // Extract two sets of ops to different modules.  This will add modules,
+    // but not affect modules in the symbol table.  If any instance of the
+    // module is bound, then extraction is skipped.  This avoids problems
+    // where certain simulators dislike having binds that target bound
+    // modules.
+    if (isBound(rtlmod, *instanceGraph))
+      continue;
 
-      // In the module is in test harness, we don't have to extract from it.
-      if (rtlmod->hasAttr("firrtl.extract.do_not_extract")) {
-        rtlmod->removeAttr("firrtl.extract.do_not_extract");
-        continue;
-      }
+    // In the module is in test harness, we don't have to extract from it.
+    if (rtlmod->hasAttr("firrtl.extract.do_not_extract")) {
+      rtlmod->removeAttr("firrtl.extract.do_not_extract");
+      continue;
+    }
+    modules.push_back(rtlmod);
+  }
 
-      SmallPtrSet<Operation *, 32> opsToErase;
-      bool anyThingExtracted = false;
-      anyThingExtracted |= doModule(rtlmod, isAssert, "_assert", assertDir,
-                                    assertBindFile, bindTable, opsToErase);
-      anyThingExtracted |= doModule(rtlmod, isAssume, "_assume", assumeDir,
-                                    assumeBindFile, bindTable, opsToErase);
-      anyThingExtracted |= doModule(rtlmod, isCover, "_cover", coverDir,
-                                    coverBindFile, bindTable, opsToErase);
-
-      // Inline any modules that only have inputs for test code.
-      if (!disableModuleInlining && anyThingExtracted)
-        inlineInputOnly(rtlmod, *instanceGraph, bindTable, opsToErase);
-
-      // Erase any instances that were extracted, and their forward dataflow.
-      // Also erase old instances that were inlined and can now be cleaned up.
-      // Parts of the forward dataflow may have been nested under other ops to
-      // erase, so as we visit ops to erase, we remove them and all their
-      // children from the set of ops to erase until nothing is left.
-      while (!opsToErase.empty()) {
-        Operation *op = *opsToErase.begin();
-        op->walk([&](Operation *erasedOp) { opsToErase.erase(erasedOp); });
-        op->dropAllUses();
-        op->erase();
-      }
+  // Slice and extract the test code of each module in parallel.  This only
+  // touches the module itself; the new modules and binds are built detached.
+  SmallVector<ModuleExtraction> results(modules.size());
+  mlir::ParallelDiagnosticHandler diagHandler(&getContext());
+  mlir::parallelFor(&getContext(), 0, modules.size(), [&](size_t i) {
+    diagHandler.setOrderIDForThread(i);
+    auto rtlmod = modules[i];
+    auto &result = results[i];
+    doModule(rtlmod, isAssert, "_assert", assertDir, assertBindFile, result);
+    doModule(rtlmod, isAssume, "_assume", assumeDir, assumeBindFile, result);
+    doModule(rtlmod, isCover, "_cover", coverDir, coverBindFile, result);
+    diagHandler.eraseOrderIDForThread();
+  });
+
+  // Insert the extracted modules and update the instance graph, then do the
+  // cross-module inlining and cleanup serially in module order.
+  BindTable bindTable;
+  for (auto [rtlmod, result] : llvm::zip(modules, results)) {
+    bool anyThingExtracted = !result.extracted.empty();
+    finalizeModule(rtlmod, result, bindTable);
+
+    // Inline any modules that only have inputs for test code.
+    auto &opsToErase = result.opsToErase;
+    if (!disableModuleInlining && anyThingExtracted)
+      inlineInputOnly(rtlmod, *instanceGraph, bindTable, opsToErase);
+
+    // Erase any instances that were extracted, and their forward dataflow.
+    // Also erase old instances that were inlined and can now be cleaned up.
+    // Parts of the forward dataflow may have been nested under other ops to
+    // erase, so as we visit ops to erase, we remove them and all their
+    // children from the set of ops to erase until nothing is left.
+    while (!opsToErase.empty()) {
+      Operation *op = *opsToErase.begin();
+      op->walk([&](Operation *erasedOp) { opsToErase.erase(erasedOp); });
+      op->dropAllUses();
+      op->erase();
     }
   }
 
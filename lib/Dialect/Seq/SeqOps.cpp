@@ -198,7 +198,11 @@ void HLMemOp::build(OpBuilder &builder, OperationState &result, Value clk,
 //===----------------------------------------------------------------------===//
 // CompRegOp
 
-ParseResult CompRegOp::parse(OpAsmParser &parser, OperationState &result) {
+/// Parse the operands shared by CompRegOp and CompRegClockEnabledOp: the
+/// input, the clock, optionally the clock enable, and an optional reset and
+/// reset value.
+static ParseResult parseCompReg(OpAsmParser &parser, OperationState &result,
+                                bool clockEnabled) {
   llvm::SMLoc loc = parser.getCurrentLocation();
 
   if (succeeded(parser.parseOptionalKeyword("sym"))) {
@@ -210,21 +214,21 @@ ParseResult CompRegOp::parse(OpAsmParser &parser, OperationState &result) {
   SmallVector<OpAsmParser::UnresolvedOperand, 4> operands;
   if (parser.parseOperandList(operands))
     return failure();
+  // The number of operands before the optional reset.
+  size_t numRequired = clockEnabled ? 3 : 2;
   switch (operands.size()) {
   case 0:
     return parser.emitError(loc, "expected operands");
   case 1:
     return parser.emitError(loc, "expected clock operand");
-  case 2:
-    // No reset.
-    break;
-  case 3:
-    return parser.emitError(loc, "expected resetValue operand");
-  case 4:
-    // reset and reset value included.
-    break;
   default:
-    return parser.emitError(loc, "too many operands");
+    if (operands.size() < numRequired)
+      return parser.emitError(loc, "expected clock enable operand");
+    if (operands.size() == numRequired + 1)
+      return parser.emitError(loc, "expected resetValue operand");
+    if (operands.size() > numRequired + 2)
+      return parser.emitError(loc, "too many operands");
+    break;
   }
 
   Type ty;
@@ -236,33 +240,52 @@ ParseResult CompRegOp::parse(OpAsmParser &parser, OperationState &result) {
   setNameFromResult(parser, result);
 
   result.addTypes({ty});
-  if (operands.size() == 2)
-    return parser.resolveOperands(operands, {ty, i1}, loc, result.operands);
-  else
-    return parser.resolveOperands(operands, {ty, i1, i1, ty}, loc,
-                                  result.operands);
+  SmallVector<Type, 5> types{ty, i1};
+  if (clockEnabled)
+    types.push_back(i1);
+  if (operands.size() > numRequired)
+    types.append({i1, ty});
+  return parser.resolveOperands(operands, types, loc, result.operands);
 }
 
-void CompRegOp::print(::mlir::OpAsmPrinter &p) {
+template <typename OpTy>
+static void printCompReg(OpAsmPrinter &p, OpTy reg) {
   SmallVector<StringRef> elidedAttrs;
-  if (auto sym = getSymName()) {
+  if (auto sym = reg.getSymName()) {
     elidedAttrs.push_back("sym_name");
     p << ' ' << "sym ";
     p.printSymbolName(*sym);
   }
 
-  p << ' ' << getInput() << ", " << getClk();
-  if (getReset())
-    p << ", " << getReset() << ", " << getResetValue() << ' ';
+  p << ' ' << reg.getInput() << ", " << reg.getClk();
+  if constexpr (std::is_same_v<OpTy, CompRegClockEnabledOp>)
+    p << ", " << reg.getClockEnable();
+  if (reg.getReset())
+    p << ", " << reg.getReset() << ", " << reg.getResetValue() << ' ';
 
   // Determine if 'name' can be elided.
-  if (canElideName(p, *this))
+  if (canElideName(p, reg))
     elidedAttrs.push_back("name");
 
-  p.printOptionalAttrDict((*this)->getAttrs(), elidedAttrs);
-  p << " : " << getInput().getType();
+  p.printOptionalAttrDict(reg->getAttrs(), elidedAttrs);
+  p << " : " << reg.getInput().getType();
+}
+
+template <typename OpTy>
+static LogicalResult verifyCompReg(OpTy reg) {
+  if ((reg.getReset() && !reg.getResetValue()) ||
+      (!reg.getReset() && reg.getResetValue()))
+    return reg.emitOpError(
+        "either reset and resetValue or neither must be specified");
+  return success();
+}
+
+ParseResult CompRegOp::parse(OpAsmParser &parser, OperationState &result) {
+  return parseCompReg(parser, result, /*clockEnabled=*/false);
 }
 
+void CompRegOp::print(::mlir::OpAsmPrinter &p) { printCompReg(p, *this); }
+
 /// Suggest a name for each result value based on the saved result names
 /// attribute.
 void CompRegOp::getAsmResultNames(OpAsmSetValueNameFn setNameFn) {
@@ -271,13 +294,27 @@ void CompRegOp::getAsmResultNames(OpAsmSetValueNameFn setNameFn) {
     setNameFn(getResult(), getName());
 }
 
-LogicalResult CompRegOp::verify() {
-  if ((getReset() && !getResetValue()) || (!getReset() && getResetValue()))
-    return emitOpError(
-        "either reset and resetValue or neither must be specified");
-  return success();
+LogicalResult CompRegOp::verify() { return verifyCompReg(*this); }
+
+//===----------------------------------------------------------------------===//
+// CompRegClockEnabledOp
+
+ParseResult CompRegClockEnabledOp::parse(OpAsmParser &parser,
+                                         OperationState &result) {
+  return parseCompReg(parser, result, /*clockEnabled=*/true);
 }
 
+void CompRegClockEnabledOp::print(::mlir::OpAsmPrinter &p) {
+  printCompReg(p, *this);
+}
+
+void CompRegClockEnabledOp::getAsmResultNames(OpAsmSetValueNameFn setNameFn) {
+  if (!getName().empty())
+    setNameFn(getResult(), getName());
+}
+
+LogicalResult CompRegClockEnabledOp::verify() { return verifyCompReg(*this); }
+
 //===----------------------------------------------------------------------===//
 // FirRegOp
 
@@ -0,0 +1,99 @@
+//===- InferClockEnables.cpp - Make register enables explicit -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass detects registers which feed their own value back through a mux,
+// `reg = compreg mux(en, next, reg)`, and turns them into clock enabled
+// registers, `reg = compreg.ce next, en`.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetails.h"
+#include "circt/Dialect/Comb/CombOps.h"
+#include "circt/Dialect/HW/HWOps.h"
+#include "circt/Dialect/Seq/SeqOps.h"
+#include "circt/Dialect/Seq/SeqPasses.h"
+#include "mlir/IR/Builders.h"
+
+using namespace mlir;
+using namespace circt;
+using namespace seq;
+
+namespace {
+struct InferClockEnablesPass
+    : public InferClockEnablesBase<InferClockEnablesPass> {
+  void runOnOperation() override;
+
+private:
+  CompRegClockEnabledOp inferClockEnable(CompRegOp reg);
+};
+} // anonymous namespace
+
+/// If the input of `reg` is a mux selecting between a next value and the
+/// current value of the register, replace it with a clock enabled register.
+/// Return the new register, or null if `reg` has no such feedback.
+CompRegClockEnabledOp InferClockEnablesPass::inferClockEnable(CompRegOp reg) {
+  auto mux = reg.getInput().getDefiningOp<comb::MuxOp>();
+  if (!mux)
+    return {};
+
+  OpBuilder builder(reg);
+  Value enable, next;
+  if (mux.getFalseValue() == reg.getResult()) {
+    enable = mux.getCond();
+    next = mux.getTrueValue();
+  } else if (mux.getTrueValue() == reg.getResult()) {
+    auto allOnes = builder.create<hw::ConstantOp>(mux.getLoc(), APInt(1, 1));
+    enable = builder.createOrFold<comb::XorOp>(mux.getLoc(), mux.getCond(),
+                                               allOnes, mux.getTwoState());
+    next = mux.getFalseValue();
+  } else {
+    return {};
+  }
+
+  auto newReg = builder.create<CompRegClockEnabledOp>(
+      reg.getLoc(), next, reg.getClk(), enable, reg.getNameAttr(),
+      reg.getReset(), reg.getResetValue(), reg.getSymNameAttr());
+  newReg->setDialectAttrs(reg->getDialectAttrs());
+  reg.getResult().replaceAllUsesWith(newReg.getResult());
+  reg.erase();
+  if (mux->use_empty())
+    mux.erase();
+  ++numEnablesInferred;
+  return newReg;
+}
+
+void InferClockEnablesPass::runOnOperation() {
+  SmallVector<CompRegOp> regs(getOperation().getOps<CompRegOp>());
+  SmallVector<CompRegClockEnabledOp> newRegs;
+  for (auto reg : regs)
+    if (auto newReg = inferClockEnable(reg))
+      newRegs.push_back(newReg);
+
+  if (newRegs.empty())
+    return markAllAnalysesPreserved();
+
+  if (!groupRegisters)
+    return;
+
+  // Move registers sharing a clock, enable and reset next to each other.  The
+  // always blocks and enable checks they are lowered to are then adjacent as
+  // well, which lets cleanups merge them into as few blocks as possible.
+  using GroupKey = std::tuple<Value, Value, Value>;
+  llvm::SmallDenseMap<GroupKey, Operation *> lastInGroup;
+  for (auto reg : newRegs) {
+    auto &last = lastInGroup[{reg.getClk(), reg.getClockEnable(),
+                              reg.getReset()}];
+    if (last && reg->getBlock() == last->getBlock())
+      reg->moveAfter(last);
+    last = reg;
+  }
+}
+
+std::unique_ptr<Pass> circt::seq::createInferClockEnablesPass() {
+  return std::make_unique<InferClockEnablesPass>();
+}
@@ -7,14 +7,19 @@
 //===----------------------------------------------------------------------===//
 //
 // This pass pattern matches lowering patterns on seq.hlmem ops and referencing
-// ports.
+// ports. If the `lowerHLMemToSimModels` lowering option is set, memories are
+// instead replaced by instances of FIRRTL memory generator modules, for which
+// HWMemSimImpl emits its behavioral simulation model.
 //
 //===----------------------------------------------------------------------===//
 
 #include "PassDetails.h"
+#include "circt/Dialect/HW/HWAttributes.h"
 #include "circt/Dialect/SV/SVOps.h"
 #include "circt/Dialect/Seq/SeqOps.h"
 #include "circt/Dialect/Seq/SeqPasses.h"
+#include "circt/Support/LoweringOptions.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "llvm/ADT/TypeSwitch.h"
 
@@ -148,6 +153,200 @@ public:
   }
 };
 
+/// Lowers memories to instances of FIRRTL memory generator modules, which
+/// HWMemSimImpl turns into behavioral simulation models with an always block
+/// per port. Memories with the same configuration share a generated module.
+class SimModelLowering {
+public:
+  SimModelLowering(mlir::ModuleOp top) : top(top), symbolTable(top) {}
+
+  /// Replace `mem` and its ports with an instance of a simulation model. Fails
+  /// without changing the IR if the memory has no FIRRTL memory equivalent.
+  LogicalResult lower(seq::HLMemOp mem);
+
+private:
+  /// The data width, depth, number of read and write ports, and read and
+  /// write latency of a memory.
+  using ModelConfig =
+      std::tuple<unsigned, uint64_t, unsigned, unsigned, unsigned, unsigned>;
+
+  hw::HWModuleGeneratedOp getOrCreateModel(seq::HLMemOp mem,
+                                           const ModelConfig &config);
+  FlatSymbolRefAttr getOrCreateSchema(Location loc);
+
+  mlir::ModuleOp top;
+  SymbolTable symbolTable;
+  FlatSymbolRefAttr schema;
+  DenseMap<ModelConfig, hw::HWModuleGeneratedOp> models;
+};
+
+} // namespace
+
+LogicalResult SimModelLowering::lower(seq::HLMemOp mem) {
+  // Only support unidimensional memories of non-zero width integers.
+  auto memType = mem.getMemType();
+  if (memType.getShape().size() != 1)
+    return failure();
+  auto dataType = memType.getElementType().dyn_cast<IntegerType>();
+  if (!dataType || dataType.getWidth() == 0)
+    return failure();
+  uint64_t depth = memType.getShape()[0];
+  auto addrType = IntegerType::get(mem.getContext(),
+                                   std::max(1U, llvm::Log2_64_Ceil(depth)));
+
+  // FIRRTL memories have a single read and write latency for all ports.
+  SmallVector<seq::ReadPortOp> readOps;
+  SmallVector<seq::WritePortOp> writeOps;
+  Optional<unsigned> readLatency, writeLatency;
+  for (auto *user : mem.getHandle().getUsers()) {
+    if (user->getBlock() != mem->getBlock())
+      return failure();
+    if (auto readOp = dyn_cast<seq::ReadPortOp>(user)) {
+      if (readOp.getAddresses()[0].getType() != addrType ||
+          readLatency.value_or(readOp.getLatency()) != readOp.getLatency())
+        return failure();
+      readLatency = readOp.getLatency();
+      readOps.push_back(readOp);
+    } else if (auto writeOp = dyn_cast<seq::WritePortOp>(user)) {
+      if (writeOp.getAddresses()[0].getType() != addrType ||
+          writeOp.getLatency() == 0 ||
+          writeLatency.value_or(writeOp.getLatency()) != writeOp.getLatency())
+        return failure();
+      writeLatency = writeOp.getLatency();
+      writeOps.push_back(writeOp);
+    } else {
+      return failure();
+    }
+  }
+
+  // Number the ports in the order they appear in the module.
+  auto isBefore = [](auto lhs, auto rhs) {
+    return lhs->isBeforeInBlock(rhs.getOperation());
+  };
+  llvm::sort(readOps, isBefore);
+  llvm::sort(writeOps, isBefore);
+
+  auto model = getOrCreateModel(
+      mem, {dataType.getWidth(), depth, static_cast<unsigned>(readOps.size()),
+            static_cast<unsigned>(writeOps.size()), readLatency.value_or(0),
+            writeLatency.value_or(1)});
+
+  // Connect the ports in the order of the generated module. The reset of the
+  // memory has no effect on its contents and is dropped.
+  OpBuilder builder(mem);
+  auto loc = mem.getLoc();
+  auto clk = mem.getClk();
+  SmallVector<Value> inputs;
+  for (auto readOp : readOps) {
+    Value en = readOp.getRdEn();
+    if (!en)
+      en = builder.create<hw::ConstantOp>(
+          loc, builder.getIntegerAttr(builder.getI1Type(), 1));
+    inputs.append({readOp.getAddresses()[0], en, clk});
+  }
+  for (auto writeOp : writeOps)
+    inputs.append({writeOp.getAddresses()[0], writeOp.getWrEn(), clk,
+                   writeOp.getInData()});
+  auto instance = builder.create<hw::InstanceOp>(loc, model, mem.getNameAttr(),
+                                                 inputs);
+
+  for (auto [readOp, readData] : llvm::zip(readOps, instance.getResults()))
+    readOp.getReadData().replaceAllUsesWith(readData);
+  for (auto readOp : readOps)
+    readOp.erase();
+  for (auto writeOp : writeOps)
+    writeOp.erase();
+  mem.erase();
+  return success();
+}
+
+hw::HWModuleGeneratedOp
+SimModelLowering::getOrCreateModel(seq::HLMemOp mem,
+                                   const ModelConfig &config) {
+  auto &model = models[config];
+  if (model)
+    return model;
+
+  auto [width, depth, numReadPorts, numWritePorts, readLatency, writeLatency] =
+      config;
+  auto *context = mem.getContext();
+  OpBuilder builder(context);
+  Type b1Type = builder.getI1Type();
+  Type dataType = builder.getIntegerType(width);
+  Type addrType =
+      builder.getIntegerType(std::max(1U, llvm::Log2_64_Ceil(depth)));
+
+  // Use the port names and attributes of the memories lowered from FIRRTL.
+  SmallVector<hw::PortInfo> ports;
+  size_t inputPin = 0;
+  size_t outputPin = 0;
+  auto addInput = [&](const Twine &name, Type type) {
+    ports.push_back({builder.getStringAttr(name), hw::PortDirection::INPUT,
+                     type, inputPin++});
+  };
+  for (unsigned i = 0; i != numReadPorts; ++i) {
+    addInput("R" + Twine(i) + "_addr", addrType);
+    addInput("R" + Twine(i) + "_en", b1Type);
+    addInput("R" + Twine(i) + "_clk", b1Type);
+    ports.push_back({builder.getStringAttr("R" + Twine(i) + "_data"),
+                     hw::PortDirection::OUTPUT, dataType, outputPin++});
+  }
+  for (unsigned i = 0; i != numWritePorts; ++i) {
+    addInput("W" + Twine(i) + "_addr", addrType);
+    addInput("W" + Twine(i) + "_en", b1Type);
+    addInput("W" + Twine(i) + "_clk", b1Type);
+    addInput("W" + Twine(i) + "_data", dataType);
+  }
+
+  NamedAttribute genAttrs[] = {
+      builder.getNamedAttr("depth", builder.getI64IntegerAttr(depth)),
+      builder.getNamedAttr("numReadPorts",
+                           builder.getUI32IntegerAttr(numReadPorts)),
+      builder.getNamedAttr("numWritePorts",
+                           builder.getUI32IntegerAttr(numWritePorts)),
+      builder.getNamedAttr("numReadWritePorts",
+                           builder.getUI32IntegerAttr(0)),
+      builder.getNamedAttr("readLatency",
+                           builder.getUI32IntegerAttr(readLatency)),
+      builder.getNamedAttr("writeLatency",
+                           builder.getUI32IntegerAttr(writeLatency)),
+      builder.getNamedAttr("width", builder.getUI32IntegerAttr(width)),
+      builder.getNamedAttr("maskGran", builder.getUI32IntegerAttr(width)),
+      builder.getNamedAttr("readUnderWrite", builder.getUI32IntegerAttr(0)),
+      builder.getNamedAttr("writeUnderWrite",
+                           hw::WUWAttr::get(context, hw::WUW::Undefined)),
+      builder.getNamedAttr("writeClockIDs", builder.getI32ArrayAttr({}))};
+
+  model = builder.create<hw::HWModuleGeneratedOp>(
+      mem.getLoc(), getOrCreateSchema(mem.getLoc()),
+      builder.getStringAttr(mem.getName() + "_simModel"), ports, StringRef(),
+      ArrayAttr(), genAttrs);
+  symbolTable.insert(model);
+  return model;
+}
+
+FlatSymbolRefAttr SimModelLowering::getOrCreateSchema(Location loc) {
+  if (schema)
+    return schema;
+
+  // Reuse the schema of the memories lowered from FIRRTL, if there is one.
+  for (auto schemaOp : top.getOps<hw::HWGeneratorSchemaOp>())
+    if (schemaOp.getDescriptor() == "FIRRTL_Memory")
+      return schema = FlatSymbolRefAttr::get(schemaOp);
+
+  OpBuilder builder(top.getContext());
+  std::array<StringRef, 11> schemaFields = {
+      "depth",          "numReadPorts",    "numWritePorts", "numReadWritePorts",
+      "readLatency",    "writeLatency",    "width",         "maskGran",
+      "readUnderWrite", "writeUnderWrite", "writeClockIDs"};
+  auto schemaOp = builder.create<hw::HWGeneratorSchemaOp>(
+      loc, "FIRRTLMem", "FIRRTL_Memory",
+      builder.getStrArrayAttr(schemaFields));
+  symbolTable.insert(schemaOp);
+  return schema = FlatSymbolRefAttr::get(schemaOp);
+}
+
+namespace {
 struct LowerSeqHLMemPass : public LowerSeqHLMemBase<LowerSeqHLMemPass> {
   void runOnOperation() override;
 };
@@ -155,7 +354,18 @@ struct LowerSeqHLMemPass : public LowerSeqHLMemBase<LowerSeqHLMemPass> {
 } // namespace
 
 void LowerSeqHLMemPass::runOnOperation() {
-  hw::HWModuleOp top = getOperation();
+  mlir::ModuleOp top = getOperation();
+  SmallVector<hw::HWModuleOp> modules(top.getOps<hw::HWModuleOp>());
+
+  // Replace the memories with simulation models if requested. Memories which
+  // cannot be expressed as FIRRTL memories fall back to the patterns below.
+  if (LoweringOptions(top).lowerHLMemToSimModels) {
+    SimModelLowering simModelLowering(top);
+    for (auto module : modules)
+      for (auto mem :
+           llvm::make_early_inc_range(module.getOps<seq::HLMemOp>()))
+        (void)simModelLowering.lower(mem);
+  }
 
   MLIRContext &ctxt = getContext();
   ConversionTarget target(ctxt);
@@ -163,10 +373,16 @@ void LowerSeqHLMemPass::runOnOperation() {
   // Lowering patterns must lower away all HLMem-related operations.
   target.addIllegalOp<seq::HLMemOp, seq::ReadPortOp, seq::WritePortOp>();
   target.addLegalDialect<sv::SVDialect, seq::SeqDialect>();
-  RewritePatternSet patterns(&ctxt);
-  patterns.add<SimpleBehavioralMemoryLowering>(&ctxt);
+  RewritePatternSet patternSet(&ctxt);
+  patternSet.add<SimpleBehavioralMemoryLowering>(&ctxt);
+  FrozenRewritePatternSet patterns(std::move(patternSet));
 
-  if (failed(applyPartialConversion(top, target, std::move(patterns))))
+  // The modules are lowered independently of each other.
+  auto result = mlir::failableParallelForEach(
+      &ctxt, modules, [&](hw::HWModuleOp module) {
+        return applyPartialConversion(module, target, patterns);
+      });
+  if (failed(result))
     signalPassFailure();
 }
 
@@ -37,18 +37,31 @@ struct SeqToSVPass : public LowerSeqToSVBase<SeqToSVPass> {
 struct SeqFIRRTLToSVPass : public LowerSeqFIRRTLToSVBase<SeqFIRRTLToSVPass> {
   void runOnOperation() override;
   using LowerSeqFIRRTLToSVBase<SeqFIRRTLToSVPass>::disableRegRandomization;
+  using LowerSeqFIRRTLToSVBase<SeqFIRRTLToSVPass>::randomInitLoop;
 };
 } // anonymous namespace
 
 namespace {
-/// Lower CompRegOp to `sv.reg` and `sv.alwaysff`. Use a posedge clock and
-/// synchronous reset.
-struct CompRegLower : public OpConversionPattern<CompRegOp> {
+/// The `sv.alwaysff` created for each clock and reset within a block, used to
+/// merge the registers of a clock domain into a single block.
+using AlwaysFFKeyType = std::tuple<Block *, Value, Value>;
+using AlwaysFFMap = llvm::DenseMap<AlwaysFFKeyType, sv::AlwaysFFOp>;
+
+/// Lower CompRegOp and CompRegClockEnabledOp to `sv.reg` and `sv.alwaysff`.
+/// Use a posedge clock and synchronous reset.  The clock enable becomes an
+/// `sv.if` around the assignment of the next value.  If `alwaysBlocks` is
+/// set, registers sharing a clock and reset are all assigned in the first
+/// `sv.alwaysff` created for them.
+template <typename OpTy>
+struct CompRegLower : public OpConversionPattern<OpTy> {
 public:
-  using OpConversionPattern::OpConversionPattern;
+  using OpAdaptor = typename OpConversionPattern<OpTy>::OpAdaptor;
+
+  CompRegLower(MLIRContext *context, AlwaysFFMap *alwaysBlocks)
+      : OpConversionPattern<OpTy>(context), alwaysBlocks(alwaysBlocks) {}
 
   LogicalResult
-  matchAndRewrite(CompRegOp reg, OpAdaptor adaptor,
+  matchAndRewrite(OpTy reg, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const final {
     Location loc = reg.getLoc();
 
@@ -65,24 +78,65 @@ public:
       circt::sv::setSVAttributes(svReg, attribute);
 
     auto regVal = rewriter.create<sv::ReadInOutOp>(loc, svReg);
-    if (reg.getReset() && reg.getResetValue()) {
-      rewriter.create<sv::AlwaysFFOp>(
+    auto assignValue = [&]() {
+      auto assign = [&]() {
+        rewriter.create<sv::PAssignOp>(loc, svReg, reg.getInput());
+      };
+      if constexpr (std::is_same_v<OpTy, CompRegClockEnabledOp>) {
+        // Share the check with the previous register if it has the same
+        // enable.
+        auto *block = rewriter.getInsertionBlock();
+        auto lastIf =
+            block->empty() ? sv::IfOp() : dyn_cast<sv::IfOp>(block->back());
+        if (lastIf && lastIf.getCond() == reg.getClockEnable()) {
+          OpBuilder::InsertionGuard guard(rewriter);
+          rewriter.setInsertionPointToEnd(lastIf.getThenBlock());
+          assign();
+        } else {
+          rewriter.create<sv::IfOp>(loc, reg.getClockEnable(), assign);
+        }
+      } else {
+        assign();
+      }
+    };
+    auto assignResetValue = [&]() {
+      rewriter.create<sv::PAssignOp>(loc, svReg, reg.getResetValue());
+    };
+    bool hasReset = reg.getReset() && reg.getResetValue();
+
+    sv::AlwaysFFOp *alwaysFF = nullptr;
+    if (alwaysBlocks)
+      alwaysFF = &(*alwaysBlocks)[{reg->getBlock(), reg.getClk(),
+                                   hasReset ? reg.getReset() : Value()}];
+
+    if (alwaysFF && *alwaysFF) {
+      OpBuilder::InsertionGuard guard(rewriter);
+      rewriter.setInsertionPointToEnd(alwaysFF->getBodyBlock());
+      assignValue();
+      if (hasReset) {
+        rewriter.setInsertionPointToEnd(alwaysFF->getResetBlock());
+        assignResetValue();
+      }
+    } else if (hasReset) {
+      auto newAlwaysFF = rewriter.create<sv::AlwaysFFOp>(
           loc, sv::EventControl::AtPosEdge, reg.getClk(), ResetType::SyncReset,
-          sv::EventControl::AtPosEdge, reg.getReset(),
-          [&]() { rewriter.create<sv::PAssignOp>(loc, svReg, reg.getInput()); },
-          [&]() {
-            rewriter.create<sv::PAssignOp>(loc, svReg, reg.getResetValue());
-          });
+          sv::EventControl::AtPosEdge, reg.getReset(), assignValue,
+          assignResetValue);
+      if (alwaysFF)
+        *alwaysFF = newAlwaysFF;
     } else {
-      rewriter.create<sv::AlwaysFFOp>(
-          loc, sv::EventControl::AtPosEdge, reg.getClk(), [&]() {
-            rewriter.create<sv::PAssignOp>(loc, svReg, reg.getInput());
-          });
+      auto newAlwaysFF = rewriter.create<sv::AlwaysFFOp>(
+          loc, sv::EventControl::AtPosEdge, reg.getClk(), assignValue);
+      if (alwaysFF)
+        *alwaysFF = newAlwaysFF;
     }
 
     rewriter.replaceOp(reg, {regVal});
     return success();
   }
+
+private:
+  AlwaysFFMap *alwaysBlocks;
 };
 } // namespace
 
@@ -90,8 +144,10 @@ namespace {
 /// Lower FirRegOp to `sv.reg` and `sv.always`.
 class FirRegLower {
 public:
-  FirRegLower(hw::HWModuleOp module, bool disableRegRandomization = false)
-      : module(module), disableRegRandomization(disableRegRandomization){};
+  FirRegLower(hw::HWModuleOp module, bool disableRegRandomization = false,
+              bool randomInitLoop = false)
+      : module(module), disableRegRandomization(disableRegRandomization),
+        randomInitLoop(randomInitLoop){};
 
   void lower();
 
@@ -108,6 +164,9 @@ private:
 
   void initialize(OpBuilder &builder, RegLowerInfo reg, ArrayRef<Value> rands);
 
+  void createRandomArray(ImplicitLocOpBuilder &builder, uint64_t numRandoms,
+                         SmallVectorImpl<Value> &rands);
+
   void createTree(OpBuilder &builder, Value reg, Value term, Value next);
 
   void addToAlwaysBlock(Block *block, sv::EventControl clockEdge, Value clock,
@@ -146,6 +205,10 @@ private:
   hw::HWModuleOp module;
 
   bool disableRegRandomization;
+
+  /// Fill the random values in a loop over a single array, instead of
+  /// assigning each of them in its own statement.
+  bool randomInitLoop;
 };
 } // namespace
 
@@ -230,15 +293,19 @@ void FirRegLower::lower() {
             builder.create<sv::IfDefProceduralOp>(randInitRef, [&] {
               // Create randomization vector
               SmallVector<Value> randValues;
-              for (uint64_t x = 0; x < (maxBit + 31) / 32; ++x) {
-                auto lhs =
-                    builder.create<sv::LogicOp>(loc, builder.getIntegerType(32),
-                                                "_RANDOM_" + llvm::utostr(x));
-                auto rhs = builder.create<sv::MacroRefExprSEOp>(
-                    loc, builder.getIntegerType(32), "RANDOM");
-                builder.create<sv::BPAssignOp>(loc, lhs, rhs);
-                randValues.push_back(lhs.getResult());
-              }
+              uint64_t numRandoms = (maxBit + 31) / 32;
+              if (randomInitLoop)
+                createRandomArray(builder, numRandoms, randValues);
+              else
+                for (uint64_t x = 0; x < numRandoms; ++x) {
+                  auto lhs = builder.create<sv::LogicOp>(
+                      loc, builder.getIntegerType(32),
+                      "_RANDOM_" + llvm::utostr(x));
+                  auto rhs = builder.create<sv::MacroRefExprSEOp>(
+                      loc, builder.getIntegerType(32), "RANDOM");
+                  builder.create<sv::BPAssignOp>(loc, lhs, rhs);
+                  randValues.push_back(lhs.getResult());
+                }
 
               // Create initialisers for all registers.
               for (auto &svReg : toInit) {
@@ -247,6 +314,12 @@ void FirRegLower::lower() {
                 if (svReg.asyncResetSignal)
                   resets[svReg.asyncResetSignal].emplace_back(svReg);
               }
+
+              // Drop the elements of the random array no register reads.
+              if (randomInitLoop)
+                for (auto rand : randValues)
+                  if (rand.use_empty())
+                    rand.getDefiningOp()->erase();
             });
 
             if (!resets.empty()) {
@@ -427,6 +500,37 @@ void FirRegLower::initialize(OpBuilder &builder, RegLowerInfo reg,
   builder.create<sv::BPAssignOp>(loc, reg.reg, bitcast);
 }
 
+/// Declare an array of `numRandoms` random values, which is filled by a single
+/// loop, and return an element of it for each random value in `rands`.
+///
+///   logic [31:0] _RANDOM[0:numRandoms-1];
+///   for (logic [N:0] i = 0; i < numRandoms; i += 1) begin
+///     _RANDOM[i] = `RANDOM;
+///   end
+void FirRegLower::createRandomArray(ImplicitLocOpBuilder &builder,
+                                    uint64_t numRandoms,
+                                    SmallVectorImpl<Value> &rands) {
+  if (!numRandoms)
+    return;
+  auto i32Type = builder.getIntegerType(32);
+  auto array = builder.create<sv::LogicOp>(
+      hw::UnpackedArrayType::get(i32Type, numRandoms), "_RANDOM");
+
+  // The loop variable has to be able to hold `numRandoms` itself.
+  auto loopWidth = llvm::Log2_64_Ceil(numRandoms + 1);
+  builder.create<sv::VerbatimOp>(
+      builder.getStringAttr("for (logic [" + Twine(loopWidth - 1) +
+                            ":0] i = 0; i < " + Twine(numRandoms) +
+                            "; i += 1) begin\n  {{0}}[i] = `RANDOM;\nend"),
+      ValueRange{array}, builder.getArrayAttr({}));
+
+  auto indexWidth = std::max(1u, llvm::Log2_64_Ceil(numRandoms));
+  for (uint64_t x = 0; x < numRandoms; ++x) {
+    auto index = getOrCreateConstant(builder.getLoc(), APInt(indexWidth, x));
+    rands.push_back(builder.create<sv::ArrayIndexInOutOp>(array, index));
+  }
+}
+
 void FirRegLower::addToAlwaysBlock(Block *block, sv::EventControl clockEdge,
                                    Value clock,
                                    std::function<void(OpBuilder &)> body,
@@ -505,7 +609,10 @@ void SeqToSVPass::runOnOperation() {
   target.addIllegalDialect<SeqDialect>();
   target.addLegalDialect<sv::SVDialect>();
   RewritePatternSet patterns(&ctxt);
-  patterns.add<CompRegLower>(&ctxt);
+  AlwaysFFMap alwaysBlocks;
+  auto *alwaysBlocksPtr = mergeAlwaysBlocks ? &alwaysBlocks : nullptr;
+  patterns.add<CompRegLower<CompRegOp>, CompRegLower<CompRegClockEnabledOp>>(
+      &ctxt, alwaysBlocksPtr);
 
   if (failed(applyPartialConversion(top, target, std::move(patterns))))
     signalPassFailure();
@@ -513,7 +620,7 @@ void SeqToSVPass::runOnOperation() {
 
 void SeqFIRRTLToSVPass::runOnOperation() {
   hw::HWModuleOp module = getOperation();
-  FirRegLower(module, disableRegRandomization).lower();
+  FirRegLower(module, disableRegRandomization, randomInitLoop).lower();
 }
 
 std::unique_ptr<Pass> circt::seq::createSeqLowerToSVPass() {
@@ -521,9 +628,12 @@ std::unique_ptr<Pass> circt::seq::createSeqLowerToSVPass() {
 }
 
 std::unique_ptr<Pass>
-circt::seq::createSeqFIRRTLLowerToSVPass(bool disableRegRandomization) {
+circt::seq::createSeqFIRRTLLowerToSVPass(bool disableRegRandomization,
+                                         bool randomInitLoop) {
   auto pass = std::make_unique<SeqFIRRTLToSVPass>();
   if (disableRegRandomization)
     pass->disableRegRandomization = disableRegRandomization;
+  if (randomInitLoop)
+    pass->randomInitLoop = randomInitLoop;
   return pass;
 }
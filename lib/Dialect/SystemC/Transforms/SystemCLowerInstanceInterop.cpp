@@ -59,11 +59,25 @@ public:
                                                           InteropMechanism::CPP)
                       .getStates()[0];
 
-    insertStateInitialization(rewriter, loc, state);
+    // Inputs driven by constants only have to be assigned once after
+    // allocating the verilated module instead of on every update.
+    SmallVector<std::pair<StringAttr, Operation *>> constantInputs;
+    SmallVector<std::pair<StringAttr, Value>> updatedInputs;
+    for (auto [name, input] :
+         llvm::zip(adaptor.getInputNames(), adaptor.getInputs())) {
+      auto nameAttr = name.cast<StringAttr>();
+      Operation *defOp = input.getDefiningOp();
+      if (defOp && defOp->hasTrait<OpTrait::ConstantLike>())
+        constantInputs.push_back({nameAttr, defOp});
+      else
+        updatedInputs.push_back({nameAttr, input});
+    }
+
+    insertStateInitialization(rewriter, loc, state, constantInputs);
 
-    ValueRange results = insertUpdateLogic(
-        rewriter, loc, state, adaptor.getInputs(), op.getResults(),
-        adaptor.getInputNames(), adaptor.getResultNames());
+    SmallVector<Value> results =
+        insertUpdateLogic(rewriter, loc, state, updatedInputs, op.getResults(),
+                          adaptor.getResultNames());
 
     insertStateDeallocation(rewriter, loc, state);
 
@@ -75,39 +89,60 @@ public:
 
 private:
   /// Insert a interop init operation to allocate an instance of the verilated
-  /// module on the heap and let the above requested pointer point to it.
-  void insertStateInitialization(PatternRewriter &rewriter, Location loc,
-                                 Value state) const {
+  /// module on the heap and let the above requested pointer point to it. Also
+  /// assign the constant inputs to the input ports of the new instance.
+  void insertStateInitialization(
+      PatternRewriter &rewriter, Location loc, Value state,
+      ArrayRef<std::pair<StringAttr, Operation *>> constantInputs) const {
     auto initOp = rewriter.create<interop::ProceduralInitOp>(
         loc, state, InteropMechanism::CPP);
 
     OpBuilder initBuilder = OpBuilder::atBlockBegin(initOp.getBody());
     Value newState =
         initBuilder.create<NewOp>(loc, state.getType(), ValueRange());
+    for (auto [name, constOp] : constantInputs) {
+      Value constant = initBuilder.clone(*constOp)->getResult(0);
+      Value member = initBuilder.create<MemberAccessOp>(
+          loc, constant.getType(), newState, name, MemberAccessKind::Arrow);
+      initBuilder.create<AssignOp>(loc, member, constant);
+    }
     initBuilder.create<interop::ReturnOp>(loc, newState);
   }
 
   /// Create an update interop operation to assign the input values to the input
   /// ports of the verilated module, call 'eval', and read the output ports of
-  /// the verilated module.
-  ValueRange insertUpdateLogic(PatternRewriter &rewriter, Location loc,
-                               Value stateValue, ValueRange inputValues,
-                               ValueRange resultValues, ArrayAttr inputNames,
-                               ArrayAttr resultNames) const {
+  /// the verilated module. Values driving several ports are only passed to the
+  /// update operation once, and output ports without users are not read.
+  /// Returns the replacement values for `resultValues`, which are null for
+  /// unread output ports.
+  SmallVector<Value>
+  insertUpdateLogic(PatternRewriter &rewriter, Location loc, Value stateValue,
+                    ArrayRef<std::pair<StringAttr, Value>> inputs,
+                    ValueRange resultValues, ArrayAttr resultNames) const {
+    SmallVector<Value> inputValues;
+    DenseMap<Value, unsigned> inputIndices;
+    for (auto [name, input] : inputs)
+      if (inputIndices.insert({input, inputValues.size()}).second)
+        inputValues.push_back(input);
+
+    SmallVector<Type> resultTypes;
+    for (Value result : resultValues)
+      if (!result.use_empty())
+        resultTypes.push_back(result.getType());
+
     auto updateOp = rewriter.create<interop::ProceduralUpdateOp>(
-        loc, resultValues.getTypes(), inputValues, stateValue,
-        InteropMechanism::CPP);
+        loc, resultTypes, inputValues, stateValue, InteropMechanism::CPP);
 
     OpBuilder updateBuilder = OpBuilder::atBlockBegin(updateOp.getBody());
 
     // Write to the verilated module's input ports.
     Value state = updateOp.getBody()->getArguments().front();
-    for (size_t i = 0; i < inputValues.size(); ++i) {
+    for (auto [name, input] : inputs) {
       Value member = updateBuilder.create<MemberAccessOp>(
-          loc, inputValues[i].getType(), state,
-          inputNames[i].cast<StringAttr>(), MemberAccessKind::Arrow);
-      updateBuilder.create<AssignOp>(loc, member,
-                                     updateOp.getBody()->getArgument(i + 1));
+          loc, input.getType(), state, name, MemberAccessKind::Arrow);
+      updateBuilder.create<AssignOp>(
+          loc, member,
+          updateOp.getBody()->getArgument(inputIndices.lookup(input) + 1));
     }
 
     // Call 'eval'.
@@ -123,6 +158,8 @@ private:
     // Read the verilated module's output ports.
     SmallVector<Value> results;
     for (size_t i = 0; i < resultValues.size(); ++i) {
+      if (resultValues[i].use_empty())
+        continue;
       results.push_back(updateBuilder.create<MemberAccessOp>(
           loc, resultValues[i].getType(), state,
           resultNames[i].cast<StringAttr>().getValue(),
@@ -131,7 +168,11 @@ private:
 
     updateBuilder.create<interop::ReturnOp>(loc, results);
 
-    return updateOp->getResults();
+    SmallVector<Value> replacements;
+    auto updateResults = updateOp->getResults().begin();
+    for (Value result : resultValues)
+      replacements.push_back(result.use_empty() ? Value() : *updateResults++);
+    return replacements;
   }
 
   /// Deallocate the memory allocated in the interop init operation.
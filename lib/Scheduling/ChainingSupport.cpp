@@ -15,6 +15,9 @@
 #include "circt/Scheduling/Utilities.h"
 
 #include "mlir/IR/Operation.h"
+#include "llvm/ADT/BitVector.h"
+
+#include <queue>
 
 using namespace circt;
 using namespace circt::scheduling;
@@ -91,41 +94,104 @@ LogicalResult scheduling::computeChainBreakingDependences(
 }
 
 LogicalResult scheduling::computeStartTimesInCycle(ChainingProblem &prob) {
-  return handleOperationsInTopologicalOrder(prob, [&](Operation *op) {
-    // `op` will start within its abstract time step as soon as all operand
-    // values have reached it.
-    unsigned startTime = *prob.getStartTime(op);
-    float startTimeInCycle = 0.0f;
-
-    for (auto dep : prob.getDependences(op)) {
-      // Skip auxiliary deps, as these don't carry values.
-      if (dep.isAuxiliary())
-        continue;
+  return StartTimesInCycleTracker(prob).compute();
+}
 
-      Operation *pred = dep.getSource();
-      auto predStartTimeInCycle = prob.getStartTimeInCycle(pred);
-      if (!predStartTimeInCycle)
-        return failure(); // Predecessor hasn't been handled yet.
+float StartTimesInCycleTracker::computeStartTimeInCycle(Operation *op) {
+  // `op` will start within its abstract time step as soon as all operand
+  // values have reached it.
+  unsigned startTime = *prob.getStartTime(op);
+  float startTimeInCycle = 0.0f;
+
+  for (auto dep : prob.getDependences(op)) {
+    // Skip auxiliary deps, as these don't carry values.
+    if (dep.isAuxiliary())
+      continue;
+
+    Operation *pred = dep.getSource();
+    auto predOpr = *prob.getLinkedOperatorType(pred);
+    unsigned predStartTime = *prob.getStartTime(pred);
+    unsigned predEndTime = predStartTime + *prob.getLatency(predOpr);
+
+    if (predEndTime < startTime)
+      // Incoming value is completely registered/available with the beginning
+      // of the cycle.
+      continue;
+
+    // So, `pred` ends in the same cycle as `op` starts.
+    assert(predEndTime == startTime);
+    // If `pred` uses a multi-cycle operator, only its outgoing delay counts.
+    float predEndTimeInCycle =
+        (predStartTime == predEndTime ? *prob.getStartTimeInCycle(pred)
+                                      : 0.0f) +
+        *prob.getOutgoingDelay(predOpr);
+    startTimeInCycle = std::max(predEndTimeInCycle, startTimeInCycle);
+  }
+
+  return startTimeInCycle;
+}
 
-      auto predOpr = *prob.getLinkedOperatorType(pred);
-      unsigned predStartTime = *prob.getStartTime(pred);
-      unsigned predEndTime = predStartTime + *prob.getLatency(predOpr);
+LogicalResult StartTimesInCycleTracker::compute() {
+  order.clear();
+  positions.clear();
+  successors.clear();
 
-      if (predEndTime < startTime)
-        // Incoming value is completely registered/available with the beginning
-        // of the cycle.
+  // Order the operations topologically w.r.t. the value-carrying dependences.
+  DenseMap<Operation *, unsigned> numUnorderedPreds;
+  for (auto *op : prob.getOperations()) {
+    unsigned &numPreds = numUnorderedPreds[op];
+    for (auto dep : prob.getDependences(op)) {
+      if (dep.isAuxiliary())
         continue;
-
-      // So, `pred` ends in the same cycle as `op` starts.
-      assert(predEndTime == startTime);
-      // If `pred` uses a multi-cycle operator, only its outgoing delay counts.
-      float predEndTimeInCycle =
-          (predStartTime == predEndTime ? *predStartTimeInCycle : 0.0f) +
-          *prob.getOutgoingDelay(predOpr);
-      startTimeInCycle = std::max(predEndTimeInCycle, startTimeInCycle);
+      successors[dep.getSource()].push_back(op);
+      ++numPreds;
     }
+    if (numPreds == 0)
+      order.push_back(op);
+  }
+  for (unsigned i = 0; i < order.size(); ++i)
+    for (auto *succ : successors[order[i]])
+      if (--numUnorderedPreds[succ] == 0)
+        order.push_back(succ);
+  if (order.size() != prob.getOperations().size())
+    return prob.getContainingOp()->emitError() << "dependence cycle detected";
+
+  for (auto it : llvm::enumerate(order)) {
+    positions[it.value()] = it.index();
+    prob.setStartTimeInCycle(it.value(), computeStartTimeInCycle(it.value()));
+  }
+  return success();
+}
 
-    prob.setStartTimeInCycle(op, startTimeInCycle);
-    return success();
-  });
+void StartTimesInCycleTracker::update(Operation *op) {
+  assert(positions.count(op) && "operation unknown to the tracker");
+
+  // Revisit the affected operations in topological order, such that each of
+  // them is recomputed at most once. The successors of `op` are affected in
+  // any case, as they compare their own start times to `op`'s end time.
+  llvm::BitVector queued(order.size());
+  std::priority_queue<unsigned, std::vector<unsigned>, std::greater<unsigned>>
+      worklist;
+  auto enqueue = [&](Operation *affected) {
+    unsigned pos = positions[affected];
+    if (!queued.test(pos)) {
+      queued.set(pos);
+      worklist.push(pos);
+    }
+  };
+  enqueue(op);
+  for (auto *succ : successors[op])
+    enqueue(succ);
+
+  while (!worklist.empty()) {
+    Operation *curr = order[worklist.top()];
+    worklist.pop();
+
+    float startTimeInCycle = computeStartTimeInCycle(curr);
+    if (startTimeInCycle == *prob.getStartTimeInCycle(curr))
+      continue;
+    prob.setStartTimeInCycle(curr, startTimeInCycle);
+    for (auto *succ : successors[curr])
+      enqueue(succ);
+  }
 }
@@ -0,0 +1,129 @@
+//===- ListScheduler.cpp - Priority-driven list scheduler -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Implementation of a resource-constrained list scheduler for acyclic problems.
+//
+//===----------------------------------------------------------------------===//
+
+#include "circt/Scheduling/Algorithms.h"
+#include "circt/Scheduling/Utilities.h"
+
+#include "llvm/ADT/DenseMap.h"
+
+#include <queue>
+
+using namespace circt;
+using namespace circt::scheduling;
+
+/// Schedule the operations of the acyclic \p prob in the order of their
+/// earliest start times. Among the operations ready at the same time, those
+/// with the least mobility, i.e. on the longest path to the end of the
+/// schedule, are placed first. \p getLimit returns the number of operations
+/// linked to an operator type that may start in the same time step, or 0 if
+/// that is unlimited. The \p chainBreakers require one more time step between
+/// their endpoints than a regular dependence.
+static LogicalResult
+scheduleByPriority(Problem &prob,
+                   ArrayRef<Problem::Dependence> chainBreakers,
+                   function_ref<unsigned(Problem::OperatorType)> getLimit) {
+  auto &ops = prob.getOperations();
+  unsigned nOps = ops.size();
+  DenseMap<Operation *, unsigned> indices;
+  for (unsigned i = 0; i < nOps; ++i)
+    indices[ops[i]] = i;
+
+  // Collect the successors of each operation, along with the minimum number
+  // of time steps between them.
+  SmallVector<SmallVector<std::pair<unsigned, unsigned>>> successors(nOps);
+  SmallVector<unsigned> nPredecessors(nOps, 0);
+  auto addEdge = [&](Operation *src, Operation *dst, unsigned extra) {
+    unsigned latency = *prob.getLatency(*prob.getLinkedOperatorType(src));
+    successors[indices[src]].push_back({indices[dst], latency + extra});
+    ++nPredecessors[indices[dst]];
+  };
+  for (auto *op : ops)
+    for (auto &dep : prob.getDependences(op))
+      addEdge(dep.getSource(), op, 0);
+  for (auto &dep : chainBreakers)
+    addEdge(dep.getSource(), dep.getDestination(), 1);
+
+  // Determine a topological order.
+  SmallVector<unsigned> order;
+  SmallVector<unsigned> nUnordered(nPredecessors);
+  for (unsigned i = 0; i < nOps; ++i)
+    if (nUnordered[i] == 0)
+      order.push_back(i);
+  for (unsigned next = 0; next < order.size(); ++next)
+    for (auto &succ : successors[order[next]])
+      if (--nUnordered[succ.first] == 0)
+        order.push_back(succ.first);
+  if (order.size() != nOps)
+    return prob.getContainingOp()->emitError() << "dependence cycle detected";
+
+  // The height of an operation is the length of the longest path from its
+  // start to the end of the schedule. The higher the operation, the smaller is
+  // its ALAP start time.
+  SmallVector<unsigned> heights(nOps, 0);
+  for (unsigned i : llvm::reverse(order))
+    for (auto &succ : successors[i])
+      heights[i] = std::max(heights[i], succ.second + heights[succ.first]);
+
+  // Operations become ready once all of their predecessors are scheduled.
+  // Start times only ever grow along the dependences, so the ready operations
+  // leave the queue ordered by their earliest start times.
+  SmallVector<unsigned> earliest(nOps, 0);
+  using Entry = std::tuple<unsigned, int, unsigned>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> ready;
+  for (unsigned i = 0; i < nOps; ++i)
+    if (nPredecessors[i] == 0)
+      ready.push({0, -(int)heights[i], i});
+
+  // The number of operations using an operator type in a particular time step.
+  DenseMap<std::pair<Problem::OperatorType, unsigned>, unsigned>
+      reservationTable;
+  while (!ready.empty()) {
+    unsigned i = std::get<2>(ready.top());
+    ready.pop();
+
+    Operation *op = ops[i];
+    auto opr = *prob.getLinkedOperatorType(op);
+    unsigned startTime = earliest[i];
+    if (unsigned limit = getLimit(opr)) {
+      while (reservationTable.lookup({opr, startTime}) >= limit)
+        ++startTime;
+      ++reservationTable[{opr, startTime}];
+    }
+    prob.setStartTime(op, startTime);
+
+    for (auto &succ : successors[i]) {
+      unsigned j = succ.first;
+      earliest[j] = std::max(earliest[j], startTime + succ.second);
+      if (--nPredecessors[j] == 0)
+        ready.push({earliest[j], -(int)heights[j], j});
+    }
+  }
+
+  return success();
+}
+
+LogicalResult scheduling::scheduleList(SharedOperatorsProblem &prob) {
+  return scheduleByPriority(prob, {}, [&](Problem::OperatorType opr) {
+    return prob.getLimit(opr).value_or(0);
+  });
+}
+
+LogicalResult scheduling::scheduleList(ChainingProblem &prob,
+                                       float cycleTime) {
+  SmallVector<Problem::Dependence> chainBreakers;
+  if (failed(computeChainBreakingDependences(prob, cycleTime, chainBreakers)) ||
+      failed(scheduleByPriority(prob, chainBreakers,
+                                [](Problem::OperatorType) { return 0u; })))
+    return failure();
+
+  return computeStartTimesInCycle(prob);
+}
@@ -36,17 +36,18 @@ LogicalResult Problem::insertDependence(Dependence dep) {
   // record auxiliary dependences explicitly
   if (dep.isAuxiliary())
     auxDependences[dst].insert(src);
+  dependenceNumbering.getOrInsert(dep);
 
   // auto-register the endpoints
-  operations.insert(src);
-  operations.insert(dst);
+  insertOperation(src);
+  insertOperation(dst);
 
   return success();
 }
 
 Problem::OperatorType Problem::getOrInsertOperatorType(StringRef name) {
   auto opr = OperatorType::get(containingOp->getContext(), name);
-  operatorTypes.insert(opr);
+  insertOperatorType(opr);
   return opr;
 }
 
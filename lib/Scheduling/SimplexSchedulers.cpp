@@ -14,7 +14,9 @@
 #include "circt/Scheduling/Algorithms.h"
 #include "circt/Scheduling/Utilities.h"
 
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/Operation.h"
+#include "mlir/IR/Threading.h"
 
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/Debug.h"
@@ -85,7 +87,11 @@ protected:
   ///  firstNonBasicVariableColumn ^
   ///                              ─────────── ──────────
   ///                       nonBasicVariables   basicVariables
-  SmallVector<SmallVector<int>> tableau;
+  ///
+  /// The explicitly stored part is kept in a single row-major buffer of
+  /// `nRows` * `nColumns` entries, such that the row operations in the pivot
+  /// step walk contiguous memory.
+  SmallVector<int> tableau;
 
   /// During the pivot operation, one column in the elided part of the tableau
   /// is modified; this vector temporarily catches the changes.
@@ -148,10 +154,10 @@ protected:
   SmallVector<Problem::Dependence> additionalConstraints;
 
   virtual Problem &getProblem() = 0;
-  virtual bool fillObjectiveRow(SmallVector<int> &row, unsigned obj);
-  virtual void fillConstraintRow(SmallVector<int> &row,
+  virtual bool fillObjectiveRow(MutableArrayRef<int> row, unsigned obj);
+  virtual void fillConstraintRow(MutableArrayRef<int> row,
                                  Problem::Dependence dep);
-  virtual void fillAdditionalConstraintRow(SmallVector<int> &row,
+  virtual void fillAdditionalConstraintRow(MutableArrayRef<int> row,
                                            Problem::Dependence dep);
   void buildTableau();
 
@@ -174,6 +180,13 @@ protected:
   void moveBy(unsigned startTimeVariable, unsigned amount);
   unsigned getStartTime(unsigned startTimeVariable);
 
+  MutableArrayRef<int> getRow(unsigned row) {
+    return MutableArrayRef<int>(tableau).slice(row * nColumns, nColumns);
+  }
+  int &getEntry(unsigned row, unsigned column) {
+    return tableau[row * nColumns + column];
+  }
+
   LogicalResult checkLastOp();
   void dumpTableau();
 
@@ -209,7 +222,7 @@ private:
 
 protected:
   Problem &getProblem() override { return prob; }
-  void fillConstraintRow(SmallVector<int> &row,
+  void fillConstraintRow(MutableArrayRef<int> row,
                          Problem::Dependence dep) override;
 
 public:
@@ -252,6 +265,7 @@ private:
   };
 
   ModuloProblem &prob;
+  unsigned minII;
   SmallVector<unsigned> asapTimes, alapTimes;
   SmallVector<Operation *> unscheduled, scheduled;
   MRT mrt;
@@ -259,14 +273,16 @@ private:
 protected:
   Problem &getProblem() override { return prob; }
   enum { OBJ_LATENCY = 0, OBJ_AXAP /* i.e. either ASAP or ALAP */ };
-  bool fillObjectiveRow(SmallVector<int> &row, unsigned obj) override;
+  bool fillObjectiveRow(MutableArrayRef<int> row, unsigned obj) override;
   void updateMargins();
   void incrementII();
   void scheduleOperation(Operation *n);
 
 public:
-  ModuloSimplexScheduler(ModuloProblem &prob, Operation *lastOp)
-      : CyclicSimplexScheduler(prob, lastOp), prob(prob), mrt(*this) {}
+  ModuloSimplexScheduler(ModuloProblem &prob, Operation *lastOp,
+                         unsigned minII = 1)
+      : CyclicSimplexScheduler(prob, lastOp), prob(prob), minII(minII),
+        mrt(*this) {}
   LogicalResult schedule() override;
 };
 
@@ -279,7 +295,7 @@ private:
 
 protected:
   Problem &getProblem() override { return prob; }
-  void fillAdditionalConstraintRow(SmallVector<int> &row,
+  void fillAdditionalConstraintRow(MutableArrayRef<int> row,
                                    Problem::Dependence dep) override;
 
 public:
@@ -295,7 +311,7 @@ public:
 // SimplexSchedulerBase
 //===----------------------------------------------------------------------===//
 
-bool SimplexSchedulerBase::fillObjectiveRow(SmallVector<int> &row,
+bool SimplexSchedulerBase::fillObjectiveRow(MutableArrayRef<int> row,
                                             unsigned obj) {
   assert(obj == 0);
   // Minimize start time of user-specified last operation.
@@ -303,7 +319,7 @@ bool SimplexSchedulerBase::fillObjectiveRow(SmallVector<int> &row,
   return false;
 }
 
-void SimplexSchedulerBase::fillConstraintRow(SmallVector<int> &row,
+void SimplexSchedulerBase::fillConstraintRow(MutableArrayRef<int> row,
                                              Problem::Dependence dep) {
   auto &prob = getProblem();
   Operation *src = dep.getSource();
@@ -317,7 +333,7 @@ void SimplexSchedulerBase::fillConstraintRow(SmallVector<int> &row,
 }
 
 void SimplexSchedulerBase::fillAdditionalConstraintRow(
-    SmallVector<int> &row, Problem::Dependence dep) {
+    MutableArrayRef<int> row, Problem::Dependence dep) {
   // Handling is subclass-specific, so do nothing by default.
   (void)row;
   (void)dep;
@@ -343,16 +359,18 @@ void SimplexSchedulerBase::buildTableau() {
   nColumns = nParameters + nonBasicVariables.size();
 
   // Helper to grow both the tableau and the implicit column vector.
-  auto addRow = [&]() -> SmallVector<int> & {
+  nRows = 0;
+  auto addRow = [&]() -> MutableArrayRef<int> {
     implicitBasicVariableColumnVector.push_back(0);
-    return tableau.emplace_back(nColumns, 0);
+    tableau.append(nColumns, 0);
+    return getRow(nRows++);
   };
 
   // Set up the objective rows.
   nObjectives = 0;
   bool hasMoreObjectives;
   do {
-    auto &objRowVec = addRow();
+    auto objRowVec = addRow();
     hasMoreObjectives = fillObjectiveRow(objRowVec, nObjectives);
     ++nObjectives;
   } while (hasMoreObjectives);
@@ -360,25 +378,25 @@ void SimplexSchedulerBase::buildTableau() {
   // Now set up rows/constraints for the dependences.
   for (auto *op : prob.getOperations()) {
     for (auto &dep : prob.getDependences(op)) {
-      auto &consRowVec = addRow();
+      auto consRowVec = addRow();
       fillConstraintRow(consRowVec, dep);
       basicVariables.push_back(var);
       ++var;
     }
   }
   for (auto &dep : additionalConstraints) {
-    auto &consRowVec = addRow();
+    auto consRowVec = addRow();
     fillAdditionalConstraintRow(consRowVec, dep);
     basicVariables.push_back(var);
     ++var;
   }
 
   // one row per objective + one row per dependence
-  nRows = tableau.size();
+  assert(tableau.size() == nRows * nColumns);
 }
 
 int SimplexSchedulerBase::getParametricConstant(unsigned row) {
-  auto &rowVec = tableau[row];
+  auto rowVec = getRow(row);
   // Compute the dot-product ~B[row] * u between the constant matrix and the
   // parameter vector.
   return rowVec[parameter1Column] + rowVec[parameterSColumn] * parameterS +
@@ -389,7 +407,7 @@ SmallVector<int> SimplexSchedulerBase::getObjectiveVector(unsigned column) {
   SmallVector<int> objVec;
   // Extract the column vector C^T[column] from the cost matrix.
   for (unsigned obj = 0; obj < nObjectives; ++obj)
-    objVec.push_back(tableau[obj][column]);
+    objVec.push_back(getEntry(obj, column));
   return objVec;
 }
 
@@ -417,7 +435,7 @@ SimplexSchedulerBase::findDualPivotColumn(unsigned pivotRow,
             nonBasicVariables[col - firstNonBasicVariableColumn]))
       continue;
 
-    int pivotCand = tableau[pivotRow][col];
+    int pivotCand = getEntry(pivotRow, col);
     // Only negative candidates bring us closer to the optimal solution.
     // However, when freezing variables to a certain value, we accept that the
     // value of the objective function degrades.
@@ -427,7 +445,7 @@ SimplexSchedulerBase::findDualPivotColumn(unsigned pivotRow,
 
       SmallVector<int> quot;
       for (unsigned obj = 0; obj < nObjectives; ++obj)
-        quot.push_back(tableau[obj][col] / pivotCand);
+        quot.push_back(getEntry(obj, col) / pivotCand);
 
       if (std::lexicographical_compare(maxQuot.begin(), maxQuot.end(),
                                        quot.begin(), quot.end())) {
@@ -467,7 +485,7 @@ SimplexSchedulerBase::findPrimalPivotRow(unsigned pivotColumn) {
   // minimum of the quotient:
   //   parametricConstant(row) / pivotCand
   for (unsigned row = firstConstraintRow; row < nRows; ++row) {
-    int pivotCand = tableau[row][pivotColumn];
+    int pivotCand = getEntry(row, pivotColumn);
     if (pivotCand > 0) {
       // The constraint matrix has only {-1, 0, 1} entries by construction.
       assert(pivotCand == 1);
@@ -484,8 +502,8 @@ SimplexSchedulerBase::findPrimalPivotRow(unsigned pivotColumn) {
 
 void SimplexSchedulerBase::multiplyRow(unsigned row, int factor) {
   assert(factor != 0);
-  for (unsigned col = 0; col < nColumns; ++col)
-    tableau[row][col] *= factor;
+  for (int &elem : getRow(row))
+    elem *= factor;
   // Also multiply the corresponding entry in the temporary column vector.
   implicitBasicVariableColumnVector[row] *= factor;
 }
@@ -493,8 +511,11 @@ void SimplexSchedulerBase::multiplyRow(unsigned row, int factor) {
 void SimplexSchedulerBase::addMultipleOfRow(unsigned sourceRow, int factor,
                                             unsigned targetRow) {
   assert(factor != 0 && sourceRow != targetRow);
+  // The rows never overlap, which allows the compiler to vectorize this loop.
+  const int *__restrict source = getRow(sourceRow).data();
+  int *__restrict target = getRow(targetRow).data();
   for (unsigned col = 0; col < nColumns; ++col)
-    tableau[targetRow][col] += tableau[sourceRow][col] * factor;
+    target[col] += source[col] * factor;
   // Again, perform row operation on the temporary column vector as well.
   implicitBasicVariableColumnVector[targetRow] +=
       implicitBasicVariableColumnVector[sourceRow] * factor;
@@ -509,29 +530,44 @@ void SimplexSchedulerBase::pivot(unsigned pivotRow, unsigned pivotColumn) {
   // The implicit columns are part of an identity matrix.
   implicitBasicVariableColumnVector[pivotRow] = 1;
 
-  int pivotElem = tableau[pivotRow][pivotColumn];
+  int pivotElem = getEntry(pivotRow, pivotColumn);
   // The constraint matrix has only {-1, 0, 1} entries by construction.
   assert(pivotElem * pivotElem == 1);
   // Make `tableau[pivotRow][pivotColumn]` := 1
   multiplyRow(pivotRow, 1 / pivotElem);
 
+  // Constraint rows only have a handful of non-zero entries, so if the pivot
+  // row is sparse, only update the columns in which it is non-zero.
+  SmallVector<unsigned> nonZeroColumns;
+  for (unsigned col = 0; col < nColumns; ++col)
+    if (getEntry(pivotRow, col) != 0)
+      nonZeroColumns.push_back(col);
+  bool isSparse = nonZeroColumns.size() * 4 < nColumns;
+
   for (unsigned row = 0; row < nRows; ++row) {
     if (row == pivotRow)
       continue;
 
-    int elem = tableau[row][pivotColumn];
+    int elem = getEntry(row, pivotColumn);
     if (elem == 0)
       continue; // nothing to do
 
     // Make `tableau[row][pivotColumn]` := 0.
-    addMultipleOfRow(pivotRow, -elem, row);
+    if (!isSparse) {
+      addMultipleOfRow(pivotRow, -elem, row);
+      continue;
+    }
+    for (unsigned col : nonZeroColumns)
+      getEntry(row, col) -= getEntry(pivotRow, col) * elem;
+    implicitBasicVariableColumnVector[row] -=
+        implicitBasicVariableColumnVector[pivotRow] * elem;
   }
 
   // Swap the pivot column with the implicitly constructed column vector.
   // We really only need to copy in one direction here, as the former pivot
   // column is a unit vector, which is not stored explicitly.
   for (unsigned row = 0; row < nRows; ++row) {
-    tableau[row][pivotColumn] = implicitBasicVariableColumnVector[row];
+    getEntry(row, pivotColumn) = implicitBasicVariableColumnVector[row];
     implicitBasicVariableColumnVector[row] = 0; // Reset for next pivot step.
   }
 
@@ -565,8 +601,8 @@ LogicalResult SimplexSchedulerBase::solveTableau() {
     // positive entries, and the problem is in principle infeasible. However, if
     // the entry in the `parameterTColumn` is positive, we can make the LP
     // feasible again by increasing the II.
-    int entry1Col = tableau[*pivotRow][parameter1Column];
-    int entryTCol = tableau[*pivotRow][parameterTColumn];
+    int entry1Col = getEntry(*pivotRow, parameter1Column);
+    int entryTCol = getEntry(*pivotRow, parameterTColumn);
     if (entryTCol > 0) {
       // The negation of `entry1Col` is not in the paper. I think this is an
       // oversight, because `entry1Col` certainly is negative (otherwise the row
@@ -648,7 +684,7 @@ unsigned SimplexSchedulerBase::freeze(unsigned startTimeVariable,
 void SimplexSchedulerBase::translate(unsigned column, int factor1, int factorS,
                                      int factorT) {
   for (unsigned row = 0; row < nRows; ++row) {
-    auto &rowVec = tableau[row];
+    auto rowVec = getRow(row);
     int elem = rowVec[column];
     if (elem == 0)
       continue;
@@ -759,7 +795,7 @@ void SimplexSchedulerBase::dumpTableau() {
     for (unsigned j = 0; j < nColumns; ++j) {
       if (j == firstNonBasicVariableColumn)
         dbgs() << " |";
-      dbgs() << format(" %3d", tableau[i][j]);
+      dbgs() << format(" %3d", getEntry(i, j));
     }
     if (i >= firstConstraintRow)
       dbgs() << format(" |< %2d", basicVariables[i - firstConstraintRow]);
@@ -808,7 +844,7 @@ LogicalResult SimplexScheduler::schedule() {
 // CyclicSimplexScheduler
 //===----------------------------------------------------------------------===//
 
-void CyclicSimplexScheduler::fillConstraintRow(SmallVector<int> &row,
+void CyclicSimplexScheduler::fillConstraintRow(MutableArrayRef<int> row,
                                                Problem::Dependence dep) {
   SimplexSchedulerBase::fillConstraintRow(row, dep);
   if (auto dist = prob.getDistance(dep))
@@ -941,6 +977,21 @@ LogicalResult SharedOperatorsSimplexScheduler::schedule() {
 // ModuloSimplexScheduler
 //===----------------------------------------------------------------------===//
 
+/// The operations using an operator type need at least as many slots in the
+/// MRT as there are operations per operator instance.
+static unsigned computeResMII(ModuloProblem &prob) {
+  SmallDenseMap<Problem::OperatorType, unsigned> nLimitedUses;
+  for (auto *op : prob.getOperations())
+    if (isLimited(op, prob))
+      ++nLimitedUses[*prob.getLinkedOperatorType(op)];
+  unsigned resMII = 1;
+  for (auto &kv : nLimitedUses) {
+    unsigned limit = *prob.getLimit(kv.getFirst());
+    resMII = std::max(resMII, (kv.getSecond() + limit - 1) / limit);
+  }
+  return resMII;
+}
+
 LogicalResult ModuloSimplexScheduler::MRT::enter(Operation *op,
                                                  unsigned timeStep) {
   auto opr = *sched.prob.getLinkedOperatorType(op);
@@ -969,7 +1020,7 @@ void ModuloSimplexScheduler::MRT::release(Operation *op) {
   revTab.erase(it);
 }
 
-bool ModuloSimplexScheduler::fillObjectiveRow(SmallVector<int> &row,
+bool ModuloSimplexScheduler::fillObjectiveRow(MutableArrayRef<int> row,
                                               unsigned obj) {
   switch (obj) {
   case OBJ_LATENCY:
@@ -1136,6 +1187,17 @@ LogicalResult ModuloSimplexScheduler::schedule() {
     if (isLimited(op, prob))
       unscheduled.push_back(op);
 
+  // Raise the II to its resource-constrained lower bound (or the requested
+  // minimum) right away, and re-solve starting from the current basis, instead
+  // of reaching it one resource conflict at a time below.
+  unsigned lowerII = std::max(computeResMII(prob), minII);
+  if ((int)lowerII > parameterT) {
+    LLVM_DEBUG(dbgs() << "Increasing II to lower bound " << lowerII << '\n');
+    parameterT = lowerII;
+    if (failed(solveTableau()))
+      return prob.getContainingOp()->emitError() << "problem is infeasible";
+  }
+
   // Main loop: Iteratively fix limited operations to time steps.
   while (!unscheduled.empty()) {
     // Update ASAP/ALAP times.
@@ -1176,7 +1238,7 @@ LogicalResult ModuloSimplexScheduler::schedule() {
 //===----------------------------------------------------------------------===//
 
 void ChainingSimplexScheduler::fillAdditionalConstraintRow(
-    SmallVector<int> &row, Problem::Dependence dep) {
+    MutableArrayRef<int> row, Problem::Dependence dep) {
   fillConstraintRow(row, dep);
   // One _extra_ time step breaks the chain (note that the latency is negative
   // in the tableau).
@@ -1240,6 +1302,77 @@ LogicalResult scheduling::scheduleSimplex(ModuloProblem &prob,
   return simplex.schedule();
 }
 
+LogicalResult scheduling::scheduleSimplex(ModuloProblem &prob,
+                                          Operation *lastOp,
+                                          unsigned numCandidates) {
+  if (numCandidates < 2)
+    return scheduleSimplex(prob, lastOp);
+
+  // Every scheduled operation increments the II at most once, so starting
+  // the heuristic at `lowII` yields an II of at most `highII`, unless the
+  // recurrences require more.
+  unsigned nLimited = llvm::count_if(
+      prob.getOperations(), [&](Operation *op) { return isLimited(op, prob); });
+  unsigned lowII = computeResMII(prob);
+  unsigned highII = lowII + nLimited;
+
+  // Search for the smallest II whose candidate does not have to increment it.
+  // Each round spreads the candidates over the remaining interval, and each
+  // candidate schedules its own copy of the problem. A candidate ending up
+  // above its initial II rules out all smaller initial IIs, and the best II
+  // found so far bounds the interval from above.
+  Optional<ModuloProblem> best;
+  unsigned bestII = std::numeric_limits<unsigned>::max();
+  {
+    // The candidates only fail for infeasible problems, which the serial run
+    // below then diagnoses once.
+    Location loc = prob.getContainingOp()->getLoc();
+    MLIRContext *ctx = loc.getContext();
+    ScopedDiagnosticHandler silenceCandidates(ctx, [&](Diagnostic &diag) {
+      return success(diag.getLocation() == loc);
+    });
+
+    while (lowII <= highII) {
+      SmallVector<unsigned> candidateIIs;
+      for (unsigned i = 0; i < numCandidates; ++i) {
+        unsigned ii = lowII + (highII - lowII) * i / (numCandidates - 1);
+        if (candidateIIs.empty() || candidateIIs.back() != ii)
+          candidateIIs.push_back(ii);
+      }
+
+      SmallVector<Optional<ModuloProblem>> candidates(candidateIIs.size());
+      parallelFor(ctx, 0, candidateIIs.size(), [&](size_t i) {
+        auto &candidate = candidates[i];
+        candidate.emplace(prob);
+        ModuloSimplexScheduler simplex(*candidate, lastOp, candidateIIs[i]);
+        if (failed(simplex.schedule()))
+          candidate.reset();
+      });
+      if (llvm::any_of(candidates, [](auto &c) { return !c.has_value(); }))
+        break;
+
+      for (unsigned i = 0, e = candidateIIs.size(); i < e; ++i) {
+        unsigned ii = *candidates[i]->getInitiationInterval();
+        if (ii > candidateIIs[i] && candidateIIs[i] < bestII)
+          lowII = std::max(lowII, candidateIIs[i] + 1);
+        if (ii < bestII) {
+          bestII = ii;
+          best.emplace(*candidates[i]);
+        }
+      }
+      highII = std::min(highII, bestII - 1);
+    }
+  }
+
+  if (!best)
+    return scheduleSimplex(prob, lastOp);
+
+  prob.setInitiationInterval(bestII);
+  for (auto *op : prob.getOperations())
+    prob.setStartTime(op, *best->getStartTime(op));
+  return success();
+}
+
 LogicalResult scheduling::scheduleSimplex(ChainingProblem &prob,
                                           Operation *lastOp, float cycleTime) {
   ChainingSimplexScheduler simplex(prob, lastOp, cycleTime);
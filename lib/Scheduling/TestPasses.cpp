@@ -12,6 +12,7 @@
 
 #include "circt/Dialect/SSP/Utilities.h"
 #include "circt/Scheduling/Algorithms.h"
+#include "circt/Scheduling/Utilities.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Builders.h"
@@ -279,6 +280,61 @@ void TestChainingProblemPass::runOnOperation() {
   }
 }
 
+namespace {
+struct TestStartTimesInCyclePass
+    : public PassWrapper<TestStartTimesInCyclePass,
+                         OperationPass<func::FuncOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(TestStartTimesInCyclePass)
+
+  void runOnOperation() override;
+  StringRef getArgument() const override {
+    return "test-start-times-in-cycle";
+  }
+  StringRef getDescription() const override {
+    return "Emit incrementally updated start times in cycle as attributes";
+  }
+};
+} // namespace
+
+void TestStartTimesInCyclePass::runOnOperation() {
+  auto func = getOperation();
+  OpBuilder builder(func.getContext());
+
+  auto prob = ChainingProblem::get(func);
+  constructProblem(prob, func);
+  constructChainingProblem(prob, func);
+  assert(succeeded(prob.check()));
+
+  // Start from the schedule given in the test case ...
+  for (auto *op : prob.getOperations())
+    if (auto startTimeAttr = op->getAttrOfType<IntegerAttr>("problemStartTime"))
+      prob.setStartTime(op, startTimeAttr.getInt());
+  StartTimesInCycleTracker tracker(prob);
+  if (failed(tracker.compute()))
+    return signalPassFailure();
+
+  // ... and move the operations one by one to their new start times.
+  for (auto *op : prob.getOperations()) {
+    if (auto moveToAttr = op->getAttrOfType<IntegerAttr>("moveTo")) {
+      prob.setStartTime(op, moveToAttr.getInt());
+      tracker.update(op);
+    }
+  }
+
+  // The incremental updates must agree with a computation from scratch.
+  auto reference = prob;
+  if (failed(computeStartTimesInCycle(reference)))
+    return signalPassFailure();
+  for (auto *op : prob.getOperations()) {
+    if (*prob.getStartTimeInCycle(op) != *reference.getStartTimeInCycle(op)) {
+      op->emitError("incrementally updated start time in cycle is stale");
+      return signalPassFailure();
+    }
+    op->setAttr("startTimeInCycle",
+                builder.getF32FloatAttr(*prob.getStartTimeInCycle(op)));
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // SharedOperatorsProblem
 //===----------------------------------------------------------------------===//
@@ -406,6 +462,83 @@ void TestASAPSchedulerPass::runOnOperation() {
   emitSchedule(prob, "asapStartTime", builder);
 }
 
+//===----------------------------------------------------------------------===//
+// ListScheduler
+//===----------------------------------------------------------------------===//
+
+namespace {
+struct TestListSchedulerPass
+    : public PassWrapper<TestListSchedulerPass, OperationPass<func::FuncOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(TestListSchedulerPass)
+
+  TestListSchedulerPass() = default;
+  TestListSchedulerPass(const TestListSchedulerPass &) {}
+  Option<std::string> problemToTest{*this, "with",
+                                    llvm::cl::init("SharedOperatorsProblem")};
+  void runOnOperation() override;
+  StringRef getArgument() const override { return "test-list-scheduler"; }
+  StringRef getDescription() const override {
+    return "Emit a list scheduler's solution as attributes";
+  }
+};
+} // anonymous namespace
+
+void TestListSchedulerPass::runOnOperation() {
+  auto func = getOperation();
+  OpBuilder builder(func.getContext());
+
+  if (problemToTest == "SharedOperatorsProblem") {
+    auto prob = SharedOperatorsProblem::get(func);
+    constructProblem(prob, func);
+    constructSharedOperatorsProblem(prob, func);
+    assert(succeeded(prob.check()));
+
+    if (failed(scheduleList(prob))) {
+      func->emitError("scheduling failed");
+      return signalPassFailure();
+    }
+
+    if (failed(prob.verify())) {
+      func->emitError("schedule verification failed");
+      return signalPassFailure();
+    }
+
+    emitSchedule(prob, "listStartTime", builder);
+    return;
+  }
+
+  if (problemToTest == "ChainingProblem") {
+    auto prob = ChainingProblem::get(func);
+    constructProblem(prob, func);
+    constructChainingProblem(prob, func);
+    assert(succeeded(prob.check()));
+
+    auto cycleTimeAttr = func->getAttrOfType<FloatAttr>("cycletime");
+    assert(cycleTimeAttr);
+    float cycleTime = cycleTimeAttr.getValueAsDouble();
+
+    if (failed(scheduleList(prob, cycleTime))) {
+      func->emitError("scheduling failed");
+      return signalPassFailure();
+    }
+
+    if (failed(prob.verify())) {
+      func->emitError("schedule verification failed");
+      return signalPassFailure();
+    }
+
+    emitSchedule(prob, "listStartTime", builder);
+    for (auto *op : prob.getOperations()) {
+      float startTimeInCycle = *prob.getStartTimeInCycle(op);
+      op->setAttr("listStartTimeInCycle",
+                  builder.getF32FloatAttr(startTimeInCycle));
+    }
+    return;
+  }
+
+  llvm_unreachable("Unsupported scheduling problem");
+}
+
 //===----------------------------------------------------------------------===//
 // SimplexScheduler
 //===----------------------------------------------------------------------===//
@@ -419,6 +552,7 @@ struct TestSimplexSchedulerPass
   TestSimplexSchedulerPass() = default;
   TestSimplexSchedulerPass(const TestSimplexSchedulerPass &) {}
   Option<std::string> problemToTest{*this, "with", llvm::cl::init("Problem")};
+  Option<unsigned> iiCandidates{*this, "ii-candidates", llvm::cl::init(1)};
   void runOnOperation() override;
   StringRef getArgument() const override { return "test-simplex-scheduler"; }
   StringRef getDescription() const override {
@@ -500,7 +634,7 @@ void TestSimplexSchedulerPass::runOnOperation() {
     constructSharedOperatorsProblem(prob, func);
     assert(succeeded(prob.check()));
 
-    if (failed(scheduleSimplex(prob, lastOp))) {
+    if (failed(scheduleSimplex(prob, lastOp, iiCandidates))) {
       func->emitError("scheduling failed");
       return signalPassFailure();
     }
@@ -751,6 +885,9 @@ void registerSchedulingTestPasses() {
   mlir::registerPass([]() -> std::unique_ptr<::mlir::Pass> {
     return std::make_unique<TestChainingProblemPass>();
   });
+  mlir::registerPass([]() -> std::unique_ptr<::mlir::Pass> {
+    return std::make_unique<TestStartTimesInCyclePass>();
+  });
   mlir::registerPass([]() -> std::unique_ptr<::mlir::Pass> {
     return std::make_unique<TestSharedOperatorsProblemPass>();
   });
@@ -760,6 +897,9 @@ void registerSchedulingTestPasses() {
   mlir::registerPass([]() -> std::unique_ptr<::mlir::Pass> {
     return std::make_unique<TestASAPSchedulerPass>();
   });
+  mlir::registerPass([]() -> std::unique_ptr<::mlir::Pass> {
+    return std::make_unique<TestListSchedulerPass>();
+  });
   mlir::registerPass([]() -> std::unique_ptr<::mlir::Pass> {
     return std::make_unique<TestSimplexSchedulerPass>();
   });
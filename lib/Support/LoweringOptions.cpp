@@ -46,6 +46,7 @@ parseWireSpillingHeuristic(StringRef option) {
              llvm::Optional<LoweringOptions::WireSpillingHeuristic>>(option)
       .Case("spillLargeTermsWithNamehints",
             LoweringOptions::SpillLargeTermsWithNamehints)
+      .Case("spillDeepExpressions", LoweringOptions::SpillDeepExpressions)
       .Default(llvm::None);
 }
 
@@ -95,11 +96,14 @@ void LoweringOptions::parse(StringRef text, ErrorHandlerT errorHandler) {
       disallowExpressionInliningInPorts = true;
     } else if (option == "disallowMuxInlining") {
       disallowMuxInlining = true;
+    } else if (option == "lowerHLMemToSimModels") {
+      lowerHLMemToSimModels = true;
     } else if (option.consume_front("wireSpillingHeuristic=")) {
       if (auto heuristic = parseWireSpillingHeuristic(option)) {
         wireSpillingHeuristicSet |= *heuristic;
       } else {
-        errorHandler("expected ''spillLargeTermsWithNamehints'");
+        errorHandler("expected 'spillLargeTermsWithNamehints' or "
+                     "'spillDeepExpressions'");
       }
     } else if (option.consume_front("wireSpillingNamehintTermLimit=")) {
       if (option.getAsInteger(10, wireSpillingNamehintTermLimit)) {
@@ -107,6 +111,11 @@ void LoweringOptions::parse(StringRef text, ErrorHandlerT errorHandler) {
             "expected integer for number of namehint heurstic term limit");
         wireSpillingNamehintTermLimit = DEFAULT_NAMEHINT_TERM_LIMIT;
       }
+    } else if (option.consume_front("wireSpillingDepthLimit=")) {
+      if (option.getAsInteger(10, wireSpillingDepthLimit)) {
+        errorHandler("expected integer for expression depth limit");
+        wireSpillingDepthLimit = DEFAULT_DEPTH_LIMIT;
+      }
     } else {
       errorHandler(llvm::Twine("unknown style option \'") + option + "\'");
       // We continue parsing options after a failure.
@@ -142,16 +151,24 @@ std::string LoweringOptions::toString() const {
   if (isWireSpillingHeuristicEnabled(
           WireSpillingHeuristic::SpillLargeTermsWithNamehints))
     options += "wireSpillingHeuristic=spillLargeTermsWithNamehints,";
+  if (isWireSpillingHeuristicEnabled(
+          WireSpillingHeuristic::SpillDeepExpressions))
+    options += "wireSpillingHeuristic=spillDeepExpressions,";
   if (disallowExpressionInliningInPorts)
     options += "disallowExpressionInliningInPorts,";
   if (disallowMuxInlining)
     options += "disallowMuxInlining,";
+  if (lowerHLMemToSimModels)
+    options += "lowerHLMemToSimModels,";
 
   if (emittedLineLength != DEFAULT_LINE_LENGTH)
     options += "emittedLineLength=" + std::to_string(emittedLineLength) + ',';
   if (maximumNumberOfTermsPerExpression != DEFAULT_TERM_LIMIT)
     options += "maximumNumberOfTermsPerExpression=" +
                std::to_string(maximumNumberOfTermsPerExpression) + ',';
+  if (wireSpillingDepthLimit != DEFAULT_DEPTH_LIMIT)
+    options += "wireSpillingDepthLimit=" +
+               std::to_string(wireSpillingDepthLimit) + ',';
 
   // Remove a trailing comma if present.
   if (!options.empty()) {
@@ -0,0 +1,149 @@
+//===- PatternProfiler.cpp - Rewrite pattern profiling ----------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a profiler which counts how often rewrite patterns are
+// tried and succeed, and how much time is spent in them.
+//
+//===----------------------------------------------------------------------===//
+
+#include "circt/Support/PatternProfiler.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+
+#include <chrono>
+
+using namespace mlir;
+using namespace circt;
+
+namespace {
+/// A pattern which forwards to another one and records the time spent in it.
+struct ProfiledPattern : public RewritePattern {
+  /// Create a pattern matching the same operations as `pattern`, as described
+  /// by the leading constructor arguments of `RewritePattern`.
+  template <typename... Args>
+  ProfiledPattern(std::unique_ptr<RewritePattern> pattern,
+                  PatternProfiler::Entry &entry, Args &&...args)
+      : RewritePattern(std::forward<Args>(args)..., pattern->getBenefit(),
+                       pattern->getContext(), getGeneratedNames(*pattern)),
+        pattern(std::move(pattern)), entry(entry) {
+    setDebugName(this->pattern->getDebugName());
+    addDebugLabels(this->pattern->getDebugLabels());
+    setHasBoundedRewriteRecursion(
+        this->pattern->hasBoundedRewriteRecursion());
+  }
+
+  /// Wrap `pattern` into a profiled pattern that matches the same operations.
+  static std::unique_ptr<RewritePattern>
+  wrap(std::unique_ptr<RewritePattern> pattern, PatternProfiler::Entry &entry) {
+    if (auto rootKind = pattern->getRootKind())
+      return std::make_unique<ProfiledPattern>(std::move(pattern), entry,
+                                               rootKind->getStringRef());
+    if (auto interfaceID = pattern->getRootInterfaceID())
+      return std::make_unique<ProfiledPattern>(
+          std::move(pattern), entry, MatchInterfaceOpTypeTag(), *interfaceID);
+    if (auto traitID = pattern->getRootTraitID())
+      return std::make_unique<ProfiledPattern>(
+          std::move(pattern), entry, MatchTraitOpTypeTag(), *traitID);
+    return std::make_unique<ProfiledPattern>(std::move(pattern), entry,
+                                             MatchAnyOpTypeTag());
+  }
+
+  LogicalResult matchAndRewrite(Operation *op,
+                                PatternRewriter &rewriter) const override {
+    auto start = std::chrono::steady_clock::now();
+    auto result = pattern->matchAndRewrite(op, rewriter);
+    auto duration = std::chrono::steady_clock::now() - start;
+    entry.numAttempts.fetch_add(1, std::memory_order_relaxed);
+    if (succeeded(result))
+      entry.numSuccesses.fetch_add(1, std::memory_order_relaxed);
+    entry.nanoseconds.fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+        std::memory_order_relaxed);
+    return result;
+  }
+
+private:
+  static SmallVector<StringRef> getGeneratedNames(RewritePattern &pattern) {
+    SmallVector<StringRef> names;
+    for (auto name : pattern.getGeneratedOps())
+      names.push_back(name.getStringRef());
+    return names;
+  }
+
+  std::unique_ptr<RewritePattern> pattern;
+  PatternProfiler::Entry &entry;
+};
+} // namespace
+
+void PatternProfiler::instrument(RewritePatternSet &patterns) {
+  for (auto &pattern : patterns.getNativePatterns()) {
+    // Patterns created from plain functions, such as most canonicalizers, have
+    // no debug name and are told apart by their root operation only.
+    std::string rootName = "<any>";
+    if (auto rootKind = pattern->getRootKind())
+      rootName = rootKind->getStringRef().str();
+    StringRef name = pattern->getDebugName();
+    auto &entry = getEntry(name.empty() ? "<anonymous>" : name, rootName);
+    pattern = ProfiledPattern::wrap(std::move(pattern), entry);
+  }
+}
+
+PatternProfiler::Entry &PatternProfiler::getEntry(StringRef pattern,
+                                                  StringRef rootName) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &entry = entries[(pattern + Twine('\0') + rootName).str()];
+  if (!entry) {
+    entry = std::make_unique<Entry>();
+    entry->pattern = pattern.str();
+    entry->rootName = rootName.str();
+  }
+  return *entry;
+}
+
+bool PatternProfiler::empty() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return llvm::none_of(entries, [](auto &entry) {
+    return entry.second->numAttempts.load() != 0;
+  });
+}
+
+void PatternProfiler::print(llvm::raw_ostream &os) {
+  std::lock_guard<std::mutex> lock(mutex);
+  SmallVector<Entry *> sorted;
+  uint64_t totalNanoseconds = 0;
+  for (auto &entry : entries) {
+    if (entry.second->numAttempts.load() == 0)
+      continue;
+    sorted.push_back(entry.second.get());
+    totalNanoseconds += entry.second->nanoseconds.load();
+  }
+  llvm::stable_sort(sorted, [](Entry *a, Entry *b) {
+    return a->nanoseconds.load() > b->nanoseconds.load();
+  });
+
+  os << "===" << std::string(73, '-') << "===\n"
+     << "                         Pattern Profiling Report\n"
+     << "===" << std::string(73, '-') << "===\n"
+     << "  Total pattern time: "
+     << llvm::format("%.4f", totalNanoseconds * 1e-9) << " seconds\n\n"
+     << "   Time (s)   (%)    Attempts   Successes  Pattern (root)\n";
+  for (auto *entry : sorted) {
+    uint64_t nanoseconds = entry->nanoseconds.load();
+    double percent =
+        totalNanoseconds ? nanoseconds * 100.0 / totalNanoseconds : 0.0;
+    os << llvm::format("  %9.4f  %5.1f%%  %10llu  %10llu  ", nanoseconds * 1e-9,
+                       percent,
+                       (unsigned long long)entry->numAttempts.load(),
+                       (unsigned long long)entry->numSuccesses.load())
+       << entry->pattern << " (" << entry->rootName << ")\n";
+  }
+}
+
+static llvm::ManagedStatic<PatternProfiler> globalProfiler;
+
+PatternProfiler &PatternProfiler::getGlobal() { return *globalProfiler; }
@@ -129,7 +129,8 @@ void PrettyPrinter::rebaseIfNeeded() {
   if (uint32_t(leftTotal) > rebaseThreshold) {
     // Plan: reset leftTotal to '1', adjust all accordingly.
     auto adjust = leftTotal - 1;
-    for (auto &scanIndex : scanStack) {
+    for (size_t i = 0, e = scanStack.size(); i != e; ++i) {
+      auto &scanIndex = scanStack[i];
       assert(scanIndex >= tokenOffset);
       auto &t = tokens[scanIndex - tokenOffset];
       if (isa<BreakToken, BeginToken>(&t.token)) {
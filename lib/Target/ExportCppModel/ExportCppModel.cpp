@@ -0,0 +1,570 @@
+//===- ExportCppModel.cpp - Cycle-based C++ model emitter -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Emits a flattened HW module with Comb logic and Seq registers as a levelized,
+// cycle-based C++ model. Every value is held in a 64-bit machine word, and the
+// combinational logic is evaluated once per cycle in topological order, which
+// avoids the round trip through Verilog for fast simulation.
+//
+//===----------------------------------------------------------------------===//
+
+#include "circt/Target/ExportCppModel.h"
+#include "circt/Dialect/Comb/CombOps.h"
+#include "circt/Dialect/HW/HWOps.h"
+#include "circt/Dialect/Seq/SeqDialect.h"
+#include "circt/Dialect/Seq/SeqOps.h"
+#include "circt/Support/Namespace.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Tools/mlir-translate/Translation.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "llvm/Support/Format.h"
+
+using namespace circt;
+using namespace circt::ExportCppModel;
+
+/// The functions the emitted models share. They are guarded such that several
+/// models can be included into the same translation unit.
+static constexpr const char *supportCode = R"(#include <cstdint>
+
+#ifndef CIRCT_CPP_MODEL_SUPPORT
+#define CIRCT_CPP_MODEL_SUPPORT
+namespace circt_model {
+inline int64_t sext(uint64_t a, unsigned w) {
+  return w >= 64 ? int64_t(a) : int64_t(a << (64 - w)) >> (64 - w);
+}
+inline uint64_t mask(unsigned w) {
+  return w >= 64 ? ~UINT64_C(0) : (UINT64_C(1) << w) - 1;
+}
+inline uint64_t divu(uint64_t a, uint64_t b) { return b ? a / b : 0; }
+inline uint64_t modu(uint64_t a, uint64_t b) { return b ? a % b : 0; }
+inline uint64_t divs(uint64_t a, uint64_t b, unsigned w) {
+  int64_t sa = sext(a, w), sb = sext(b, w);
+  if (sb == 0)
+    return 0;
+  if (sb == -1)
+    return (0 - a) & mask(w);
+  return uint64_t(sa / sb) & mask(w);
+}
+inline uint64_t mods(uint64_t a, uint64_t b, unsigned w) {
+  int64_t sa = sext(a, w), sb = sext(b, w);
+  if (sb == 0 || sb == -1)
+    return 0;
+  return uint64_t(sa % sb) & mask(w);
+}
+inline uint64_t shl(uint64_t a, uint64_t b, unsigned w) {
+  return b >= w ? 0 : (a << b) & mask(w);
+}
+inline uint64_t shru(uint64_t a, uint64_t b, unsigned w) {
+  return b >= w ? 0 : a >> b;
+}
+inline uint64_t shrs(uint64_t a, uint64_t b, unsigned w) {
+  return uint64_t(sext(a, w) >> (b >= w ? w - 1 : b)) & mask(w);
+}
+inline uint64_t parity(uint64_t a) {
+  for (unsigned shift = 32; shift; shift /= 2)
+    a ^= a >> shift;
+  return a & 1;
+}
+} // namespace circt_model
+#endif // CIRCT_CPP_MODEL_SUPPORT
+)";
+
+/// Returns the width of 'type' if it is an integer type that fits into a
+/// machine word.
+static Optional<unsigned> getWordWidth(Type type) {
+  auto intType = type.dyn_cast<IntegerType>();
+  if (!intType || intType.getWidth() == 0 || intType.getWidth() > 64)
+    return None;
+  return intType.getWidth();
+}
+
+static unsigned getWidth(Value value) {
+  return value.getType().cast<IntegerType>().getWidth();
+}
+
+/// Returns the smallest unsigned integer type which holds 'width' bits.
+static StringRef getStorageType(unsigned width) {
+  if (width <= 8)
+    return "uint8_t";
+  if (width <= 16)
+    return "uint16_t";
+  if (width <= 32)
+    return "uint32_t";
+  return "uint64_t";
+}
+
+static std::string getLiteral(uint64_t value) {
+  std::string literal;
+  llvm::raw_string_ostream(literal) << "UINT64_C(" << llvm::format_hex(value, 0)
+                                    << ")";
+  return literal;
+}
+
+static std::string getMask(unsigned width) {
+  return getLiteral(width >= 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1);
+}
+
+namespace {
+/// A register of the model, whose next value is computed by `eval` and
+/// committed by `step`.
+struct Register {
+  Operation *op;
+  Value next;
+  Value reset;
+  Value resetValue;
+  std::string name;
+  std::string nextName;
+};
+
+class ModelEmitter {
+public:
+  ModelEmitter(hw::HWModuleOp module, raw_ostream &os)
+      : module(module), os(os) {}
+
+  LogicalResult emit();
+
+private:
+  LogicalResult collect();
+  LogicalResult levelize();
+  LogicalResult emitExpr(Operation *op, raw_ostream &expr);
+  std::string getExpr(Value value) const;
+  std::string getMemberName(StringRef name);
+
+  hw::HWModuleOp module;
+  raw_ostream &os;
+
+  Namespace names;
+  SmallVector<std::pair<BlockArgument, std::string>> inputs;
+  SmallVector<std::pair<Value, std::string>> outputs;
+  SmallVector<Register> registers;
+
+  /// The combinational operations in the order they are evaluated.
+  SmallVector<Operation *> schedule;
+  /// The C++ expressions of the values, which are literals, members or locals.
+  DenseMap<Value, std::string> exprs;
+};
+} // namespace
+
+std::string ModelEmitter::getMemberName(StringRef name) {
+  std::string legal;
+  for (char c : name)
+    legal += llvm::isAlnum(c) ? c : '_';
+  if (legal.empty() || llvm::isDigit(legal.front()))
+    legal.insert(0, "_");
+  return names.newName(legal).str();
+}
+
+std::string ModelEmitter::getExpr(Value value) const {
+  return exprs.lookup(value);
+}
+
+/// Classifies the operations of the module and names the members of the model.
+LogicalResult ModelEmitter::collect() {
+  // Reserve the names of the members, locals and keywords the model uses.
+  for (StringRef reserved :
+       {"eval", "step", "circt_model", "auto", "bool", "break", "case", "char",
+        "class", "const", "continue", "default", "delete", "do", "double",
+        "else", "enum", "float", "for", "goto", "if", "int", "long", "new",
+        "private", "public", "return", "short", "signed", "sizeof", "static",
+        "struct", "switch", "this", "unsigned", "void", "while"})
+    names.newName(reserved);
+
+  auto portInfo = getModulePortInfo(module);
+  Block *body = module.getBodyBlock();
+  for (auto &port : portInfo.inputs) {
+    if (port.isInOut() || !getWordWidth(port.type))
+      return module.emitError("port '")
+             << port.getName() << "' of type " << port.type
+             << " is not supported by the cycle-based model";
+    auto arg = body->getArgument(port.argNum);
+    inputs.push_back({arg, getMemberName(port.getName())});
+    exprs[arg] = "uint64_t(" + inputs.back().second + ")";
+  }
+  auto outputOp = cast<hw::OutputOp>(body->getTerminator());
+  for (auto &port : portInfo.outputs) {
+    if (!getWordWidth(port.type))
+      return module.emitError("port '")
+             << port.getName() << "' of type " << port.type
+             << " is not supported by the cycle-based model";
+    outputs.push_back(
+        {outputOp.getOperand(port.argNum), getMemberName(port.getName())});
+  }
+
+  Value clock;
+  for (auto &op : body->without_terminator()) {
+    for (auto type : op.getResultTypes())
+      if (!getWordWidth(type))
+        return op.emitError("values of type ")
+               << type << " are not supported by the cycle-based model";
+
+    auto result =
+        TypeSwitch<Operation *, LogicalResult>(&op)
+            .Case<hw::ConstantOp>([&](auto constOp) {
+              exprs[constOp] = getLiteral(constOp.getValue().getZExtValue());
+              return success();
+            })
+            .Case<seq::CompRegOp, seq::FirRegOp>([&](auto regOp)
+                                                     -> LogicalResult {
+              if (clock && regOp.getClk() != clock)
+                return regOp.emitError("registers with different clocks are "
+                                       "not supported by the cycle-based "
+                                       "model");
+              clock = regOp.getClk();
+              Register reg;
+              reg.op = regOp;
+              reg.reset = regOp.getReset();
+              reg.resetValue = regOp.getResetValue();
+              if constexpr (std::is_same_v<decltype(regOp), seq::FirRegOp>) {
+                if (regOp.getIsAsync())
+                  return regOp.emitError("asynchronous resets are not "
+                                         "supported by the cycle-based model");
+                reg.next = regOp.getNext();
+              } else {
+                reg.next = regOp.getInput();
+              }
+              StringRef name = regOp.getName();
+              reg.name = getMemberName(name.empty() ? "reg" : name);
+              reg.nextName = getMemberName(reg.name + "_next");
+              exprs[regOp] = "uint64_t(" + reg.name + ")";
+              registers.push_back(std::move(reg));
+              return success();
+            })
+            .Case<hw::InstanceOp>([&](auto instOp) {
+              return instOp.emitError("instances are not supported by the "
+                                      "cycle-based model, flatten the design "
+                                      "first");
+            })
+            .Default([&](Operation *op) -> LogicalResult {
+              if (isa<comb::CombDialect>(op->getDialect()))
+                return success();
+              return op->emitError("operation not supported by the "
+                                   "cycle-based model");
+            });
+    if (failed(result))
+      return failure();
+  }
+  return success();
+}
+
+/// Orders the combinational operations such that every operation is evaluated
+/// after its operands. Registers and inputs break the dependencies, hence any
+/// remaining cycle is a combinational loop.
+LogicalResult ModelEmitter::levelize() {
+  enum class State { Unvisited, Visiting, Done };
+  DenseMap<Operation *, State> states;
+  auto isNode = [&](Operation *op) {
+    return op && op->getBlock() == module.getBodyBlock() &&
+           isa<comb::CombDialect>(op->getDialect());
+  };
+
+  SmallVector<std::pair<Operation *, unsigned>> stack;
+  for (auto &root : module.getBodyBlock()->without_terminator()) {
+    if (!isNode(&root) || states.lookup(&root) != State::Unvisited)
+      continue;
+    states[&root] = State::Visiting;
+    stack.push_back({&root, 0});
+    while (!stack.empty()) {
+      auto [op, operandIdx] = stack.back();
+      if (operandIdx == op->getNumOperands()) {
+        states[op] = State::Done;
+        schedule.push_back(op);
+        stack.pop_back();
+        continue;
+      }
+      ++stack.back().second;
+      auto *def = op->getOperand(operandIdx).getDefiningOp();
+      if (!isNode(def))
+        continue;
+      auto state = states.lookup(def);
+      if (state == State::Done)
+        continue;
+      if (state == State::Visiting)
+        return def->emitError("combinational loop in cycle-based model");
+      states[def] = State::Visiting;
+      stack.push_back({def, 0});
+    }
+  }
+  return success();
+}
+
+/// Emits the value of the combinational operation 'op' as a C++ expression.
+/// Operands are masked to their width, and so is the expression.
+LogicalResult ModelEmitter::emitExpr(Operation *op, raw_ostream &expr) {
+  unsigned width = getWidth(op->getResult(0));
+  auto operand = [&](unsigned idx) { return getExpr(op->getOperand(idx)); };
+  auto variadic = [&](StringRef separator, bool masked) {
+    if (masked)
+      expr << "(";
+    llvm::interleave(
+        op->getOperands(), expr, [&](Value value) { expr << getExpr(value); },
+        separator);
+    if (masked)
+      expr << ") & " << getMask(width);
+  };
+  auto call = [&](StringRef function, bool withWidth) {
+    expr << "circt_model::" << function << "(" << operand(0) << ", "
+         << operand(1);
+    if (withWidth)
+      expr << ", " << width << "u";
+    expr << ")";
+  };
+
+  return TypeSwitch<Operation *, LogicalResult>(op)
+      .Case<comb::AddOp>([&](auto) {
+        variadic(" + ", width < 64);
+        return success();
+      })
+      .Case<comb::MulOp>([&](auto) {
+        variadic(" * ", width < 64);
+        return success();
+      })
+      .Case<comb::SubOp>([&](auto) {
+        expr << "(" << operand(0) << " - " << operand(1) << ") & "
+             << getMask(width);
+        return success();
+      })
+      .Case<comb::AndOp>([&](auto) {
+        variadic(" & ", false);
+        return success();
+      })
+      .Case<comb::OrOp>([&](auto) {
+        variadic(" | ", false);
+        return success();
+      })
+      .Case<comb::XorOp>([&](auto) {
+        variadic(" ^ ", false);
+        return success();
+      })
+      .Case<comb::DivUOp>([&](auto) {
+        call("divu", false);
+        return success();
+      })
+      .Case<comb::ModUOp>([&](auto) {
+        call("modu", false);
+        return success();
+      })
+      .Case<comb::DivSOp>([&](auto) {
+        call("divs", true);
+        return success();
+      })
+      .Case<comb::ModSOp>([&](auto) {
+        call("mods", true);
+        return success();
+      })
+      .Case<comb::ShlOp>([&](auto) {
+        call("shl", true);
+        return success();
+      })
+      .Case<comb::ShrUOp>([&](auto) {
+        call("shru", true);
+        return success();
+      })
+      .Case<comb::ShrSOp>([&](auto) {
+        call("shrs", true);
+        return success();
+      })
+      .Case<comb::ParityOp>([&](auto) {
+        expr << "circt_model::parity(" << operand(0) << ")";
+        return success();
+      })
+      .Case<comb::ICmpOp>([&](comb::ICmpOp cmpOp) {
+        unsigned operandWidth = getWidth(cmpOp.getLhs());
+        auto lhs = operand(0), rhs = operand(1);
+        auto sext = [&](StringRef value) {
+          return ("circt_model::sext(" + value + ", " +
+                  std::to_string(operandWidth) + "u)")
+              .str();
+        };
+        using comb::ICmpPredicate;
+        StringRef cmp;
+        bool isSigned = false;
+        switch (cmpOp.getPredicate()) {
+        case ICmpPredicate::eq:
+        case ICmpPredicate::ceq:
+        case ICmpPredicate::weq:
+          cmp = "==";
+          break;
+        case ICmpPredicate::ne:
+        case ICmpPredicate::cne:
+        case ICmpPredicate::wne:
+          cmp = "!=";
+          break;
+        case ICmpPredicate::slt:
+          isSigned = true;
+          LLVM_FALLTHROUGH;
+        case ICmpPredicate::ult:
+          cmp = "<";
+          break;
+        case ICmpPredicate::sle:
+          isSigned = true;
+          LLVM_FALLTHROUGH;
+        case ICmpPredicate::ule:
+          cmp = "<=";
+          break;
+        case ICmpPredicate::sgt:
+          isSigned = true;
+          LLVM_FALLTHROUGH;
+        case ICmpPredicate::ugt:
+          cmp = ">";
+          break;
+        case ICmpPredicate::sge:
+          isSigned = true;
+          LLVM_FALLTHROUGH;
+        case ICmpPredicate::uge:
+          cmp = ">=";
+          break;
+        }
+        if (isSigned) {
+          lhs = sext(lhs);
+          rhs = sext(rhs);
+        }
+        expr << "uint64_t(" << lhs << " " << cmp << " " << rhs << ")";
+        return success();
+      })
+      .Case<comb::ExtractOp>([&](comb::ExtractOp extractOp) {
+        expr << "(" << operand(0) << " >> " << extractOp.getLowBit() << ") & "
+             << getMask(width);
+        return success();
+      })
+      .Case<comb::ConcatOp>([&](auto) {
+        // The first operand holds the most significant bits.
+        unsigned shift = width;
+        llvm::interleave(
+            op->getOperands(), expr,
+            [&](Value value) {
+              shift -= getWidth(value);
+              expr << "(" << getExpr(value) << " << " << shift << ")";
+            },
+            " | ");
+        return success();
+      })
+      .Case<comb::ReplicateOp>([&](comb::ReplicateOp replicateOp) {
+        unsigned operandWidth = getWidth(replicateOp.getInput());
+        auto input = operand(0);
+        for (unsigned shift = 0; shift < width; shift += operandWidth)
+          expr << (shift ? " | " : "") << "(" << input << " << " << shift
+               << ")";
+        return success();
+      })
+      .Case<comb::MuxOp>([&](auto) {
+        expr << "(" << operand(0) << " ? " << operand(1) << " : "
+             << operand(2) << ")";
+        return success();
+      })
+      .Default([&](Operation *op) {
+        return op->emitError("operation not supported by the cycle-based "
+                             "model");
+      });
+}
+
+LogicalResult ModelEmitter::emit() {
+  if (failed(collect()) || failed(levelize()))
+    return failure();
+
+  // Emit the expressions up front, such that no partial model is emitted if an
+  // operation is not supported.
+  SmallVector<std::string> locals;
+  for (auto *op : schedule) {
+    std::string expr;
+    llvm::raw_string_ostream exprStream(expr);
+    if (failed(emitExpr(op, exprStream)))
+      return failure();
+    exprs[op->getResult(0)] = "_v" + std::to_string(locals.size());
+    locals.push_back(std::move(expr));
+  }
+
+  auto emitMember = [&](Value value, StringRef name) {
+    os << "  " << getStorageType(getWidth(value)) << " " << name << " = 0;\n";
+  };
+
+  os << "// Cycle-based model of the HW module '" << module.getName()
+     << "'.\n";
+  os << supportCode << "\n";
+  os << "struct " << getMemberName(module.getName()) << " {\n";
+  os << "  // Inputs. They have to be within the range of their width.\n";
+  for (auto &[arg, name] : inputs)
+    emitMember(arg, name);
+  os << "  // Outputs.\n";
+  for (auto &[value, name] : outputs)
+    emitMember(value, name);
+  os << "  // Registers.\n";
+  for (auto &reg : registers)
+    emitMember(reg.op->getResult(0), reg.name);
+
+  os << "\n  /// Computes the outputs and the next values of the registers "
+        "from the\n  /// inputs and the current values of the registers.\n";
+  os << "  void eval() {\n";
+  for (auto local : llvm::enumerate(locals))
+    os << "    const uint64_t _v" << local.index() << " = " << local.value()
+       << ";\n";
+  for (auto &[value, name] : outputs)
+    os << "    " << name << " = " << getExpr(value) << ";\n";
+  for (auto &reg : registers) {
+    os << "    " << reg.nextName << " = ";
+    if (reg.reset)
+      os << getExpr(reg.reset) << " ? " << getExpr(reg.resetValue) << " : ";
+    os << getExpr(reg.next) << ";\n";
+  }
+  os << "  }\n\n";
+
+  os << "  /// Advances the model by one rising edge of the clock.\n";
+  os << "  void step() {\n";
+  os << "    eval();\n";
+  for (auto &reg : registers)
+    os << "    " << reg.name << " = " << reg.nextName << ";\n";
+  os << "    eval();\n";
+  os << "  }\n";
+
+  if (!registers.empty()) {
+    os << "\nprivate:\n";
+    for (auto &reg : registers)
+      emitMember(reg.op->getResult(0), reg.nextName);
+  }
+  os << "};\n";
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// Emitter entry point
+//===----------------------------------------------------------------------===//
+
+LogicalResult ExportCppModel::exportCppModel(ModuleOp module,
+                                             llvm::raw_ostream &os,
+                                             StringRef top) {
+  hw::HWModuleOp topModule;
+  for (auto hwModule : module.getOps<hw::HWModuleOp>()) {
+    if (!top.empty() && hwModule.getName() != top)
+      continue;
+    if (topModule)
+      return module.emitError("multiple HW modules, select the one to emit "
+                              "with --cpp-model-top");
+    topModule = hwModule;
+  }
+  if (!topModule)
+    return module.emitError("no HW module to emit");
+  return ModelEmitter(topModule, os).emit();
+}
+
+//===----------------------------------------------------------------------===//
+// circt-translate registration
+//===----------------------------------------------------------------------===//
+
+void ExportCppModel::registerExportCppModelTranslation() {
+  static llvm::cl::opt<std::string> top(
+      "cpp-model-top", llvm::cl::desc("The HW module to emit a model of"),
+      llvm::cl::init(""));
+
+  static mlir::TranslateFromMLIRRegistration toCppModel(
+      "export-cpp-model", "export a cycle-based C++ model",
+      [](ModuleOp module, raw_ostream &output) {
+        return ExportCppModel::exportCppModel(module, output, top);
+      },
+      [](mlir::DialectRegistry &registry) {
+        registry.insert<hw::HWDialect, comb::CombDialect, seq::SeqDialect>();
+      });
+}
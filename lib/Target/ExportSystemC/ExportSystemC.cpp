@@ -18,11 +18,13 @@
 #include "circt/Dialect/SystemC/SystemCDialect.h"
 #include "mlir/Dialect/EmitC/IR/EmitC.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Support/FileUtilities.h"
 #include "mlir/Tools/mlir-translate/Translation.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ToolOutputFile.h"
+#include <atomic>
 #include <regex>
 
 using namespace circt;
@@ -41,10 +43,33 @@ static std::string pathToMacroName(StringRef path) {
   return std::regex_replace(str, std::regex("[^a-zA-Z0-9_$]+"), "");
 }
 
+namespace {
+/// The emission patterns, which are frozen once and shared by all files
+/// emitted from a module.
+struct EmissionPatterns {
+  explicit EmissionPatterns(MLIRContext *context) {
+    OpEmissionPatternSet opSet;
+    registerAllOpEmitters(opSet, context);
+    opPatterns = FrozenOpEmissionPatternSet(std::move(opSet));
+    TypeEmissionPatternSet typeSet;
+    registerAllTypeEmitters(typeSet);
+    typePatterns = FrozenTypeEmissionPatternSet(std::move(typeSet));
+    AttrEmissionPatternSet attrSet;
+    registerAllAttrEmitters(attrSet);
+    attrPatterns = FrozenAttrEmissionPatternSet(std::move(attrSet));
+  }
+
+  FrozenOpEmissionPatternSet opPatterns;
+  FrozenTypeEmissionPatternSet typePatterns;
+  FrozenAttrEmissionPatternSet attrPatterns;
+};
+} // namespace
+
 /// Emits the given operation to a file represented by the passed ostream and
 /// file-path.
 static LogicalResult emitFile(ArrayRef<Operation *> operations,
-                              StringRef filePath, raw_ostream &os) {
+                              StringRef filePath, raw_ostream &os,
+                              const EmissionPatterns &patterns) {
   mlir::raw_indented_ostream ios(os);
 
   ios << "// " << filePath << "\n";
@@ -55,14 +80,8 @@ static LogicalResult emitFile(ArrayRef<Operation *> operations,
   bool failed = false;
 
   if (!operations.empty()) {
-    OpEmissionPatternSet opPatterns;
-    registerAllOpEmitters(opPatterns, operations[0]->getContext());
-    TypeEmissionPatternSet typePatterns;
-    registerAllTypeEmitters(typePatterns);
-    AttrEmissionPatternSet attrPatterns;
-    registerAllAttrEmitters(attrPatterns);
-    EmissionPrinter printer(ios, opPatterns, typePatterns, attrPatterns,
-                            operations[0]->getLoc());
+    EmissionPrinter printer(ios, patterns.opPatterns, patterns.typePatterns,
+                            patterns.attrPatterns, operations[0]->getLoc());
 
     for (auto *op : operations)
       printer.emitOp(op);
@@ -81,7 +100,8 @@ static LogicalResult emitFile(ArrayRef<Operation *> operations,
 
 LogicalResult ExportSystemC::exportSystemC(ModuleOp module,
                                            llvm::raw_ostream &os) {
-  return emitFile({module}, "stdout.h", os);
+  EmissionPatterns patterns(module.getContext());
+  return emitFile({module}, "stdout.h", os, patterns);
 }
 
 LogicalResult ExportSystemC::exportSplitSystemC(ModuleOp module,
@@ -90,35 +110,53 @@ LogicalResult ExportSystemC::exportSplitSystemC(ModuleOp module,
   SmallVector<Operation *> includes;
   module->walk([&](mlir::emitc::IncludeOp op) { includes.push_back(op); });
 
-  for (Operation &op : module.getRegion().front()) {
-    if (auto symbolOp = dyn_cast<mlir::SymbolOpInterface>(op)) {
-      // Create the output directory if needed.
-      if (std::error_code error = llvm::sys::fs::create_directories(directory))
-        return module.emitError("cannot create output directory \"")
-               << directory << "\": " << error.message();
-
-      // Open or create the output file.
-      std::string fileName = symbolOp.getName().str() + ".h";
-      SmallString<128> filePath(directory);
-      llvm::sys::path::append(filePath, fileName);
-      std::string errorMessage;
-      auto output = mlir::openOutputFile(filePath, &errorMessage);
-      if (!output)
-        return module.emitError(errorMessage);
-
+  SmallVector<mlir::SymbolOpInterface> symbolOps(
+      module.getRegion().front().getOps<mlir::SymbolOpInterface>());
+  if (symbolOps.empty())
+    return success();
+
+  // Create the output directory up front, such that the workers below only
+  // have to open and write their files.
+  if (std::error_code error = llvm::sys::fs::create_directories(directory))
+    return module.emitError("cannot create output directory \"")
+           << directory << "\": " << error.message();
+
+  // Emit each file in parallel if the context enables it. Files only read the
+  // IR, and diagnostics are reported in the order of the files, regardless of
+  // which worker produced them.
+  auto *context = module.getContext();
+  EmissionPatterns patterns(context);
+  mlir::ParallelDiagnosticHandler diagHandler(context);
+  std::atomic<bool> encounteredError(false);
+  mlir::parallelFor(context, 0, symbolOps.size(), [&](size_t i) {
+    diagHandler.setOrderIDForThread(i);
+    auto symbolOp = symbolOps[i];
+
+    // Open or create the output file.
+    std::string fileName = symbolOp.getName().str() + ".h";
+    SmallString<128> filePath(directory);
+    llvm::sys::path::append(filePath, fileName);
+    std::string errorMessage;
+    auto output = mlir::openOutputFile(filePath, &errorMessage);
+    if (!output) {
+      module.emitError(errorMessage);
+      encounteredError = true;
+    } else {
       // Emit the content to the file.
       SmallVector<Operation *> opsInThisFile(includes);
       opsInThisFile.push_back(symbolOp);
-      if (failed(emitFile(opsInThisFile, filePath, output->os())))
-        return symbolOp->emitError("failed to emit to file \"")
-               << filePath << "\"";
-
-      // Do not delete the file if emission was successful.
-      output->keep();
+      if (failed(emitFile(opsInThisFile, filePath, output->os(), patterns))) {
+        symbolOp->emitError("failed to emit to file \"") << filePath << "\"";
+        encounteredError = true;
+      } else {
+        // Do not delete the file if emission was successful.
+        output->keep();
+      }
     }
-  }
+    diagHandler.eraseOrderIDForThread();
+  });
 
-  return success();
+  return failure(encounteredError);
 }
 
 //===----------------------------------------------------------------------===//
@@ -0,0 +1,269 @@
+//===- PartitionMemRefs.cpp - MemRef partitioning pass ----------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Contains the definitions of the MemRef partitioning pass, which splits local
+// memories into several banks that can be accessed concurrently.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "circt/Transforms/Passes.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace mlir;
+using namespace circt;
+
+namespace {
+enum class PartitionScheme { Cyclic, Block };
+
+/// The inclusive range of values an index may take.
+struct IndexRange {
+  int64_t min;
+  int64_t max;
+};
+
+/// The geometry of a partitioned memory dimension.
+struct Partitioning {
+  PartitionScheme scheme;
+  int64_t factor;
+  int64_t bankSize;
+};
+} // namespace
+
+/// Returns the range of 'expr' given the ranges of its dimensions and symbols,
+/// if it is a linear combination of them.
+static Optional<IndexRange>
+getRange(AffineExpr expr, ArrayRef<Optional<IndexRange>> operandRanges,
+         unsigned numDims) {
+  if (auto constant = expr.dyn_cast<AffineConstantExpr>())
+    return IndexRange{constant.getValue(), constant.getValue()};
+  if (auto dim = expr.dyn_cast<AffineDimExpr>())
+    return operandRanges[dim.getPosition()];
+  if (auto symbol = expr.dyn_cast<AffineSymbolExpr>())
+    return operandRanges[numDims + symbol.getPosition()];
+
+  auto binary = expr.dyn_cast<AffineBinaryOpExpr>();
+  if (!binary)
+    return None;
+  auto lhs = getRange(binary.getLHS(), operandRanges, numDims);
+  auto rhs = getRange(binary.getRHS(), operandRanges, numDims);
+  if (!lhs || !rhs)
+    return None;
+
+  switch (expr.getKind()) {
+  case AffineExprKind::Add:
+    return IndexRange{lhs->min + rhs->min, lhs->max + rhs->max};
+  case AffineExprKind::Mul: {
+    // The right-hand side of a multiplication is always the constant.
+    if (rhs->min != rhs->max)
+      return None;
+    int64_t factor = rhs->min;
+    if (factor >= 0)
+      return IndexRange{lhs->min * factor, lhs->max * factor};
+    return IndexRange{lhs->max * factor, lhs->min * factor};
+  }
+  default:
+    return None;
+  }
+}
+
+/// Returns the bank that the index 'expr' of an access with 'mapOperands'
+/// falls into, if it is the same for all values of the operands.
+static Optional<int64_t> getBank(AffineExpr expr, unsigned numDims,
+                                 unsigned numSymbols, ValueRange mapOperands,
+                                 const Partitioning &partitioning) {
+  if (partitioning.scheme == PartitionScheme::Cyclic) {
+    // Express the induction variables of the enclosing loops by their lower
+    // bound and step, which exposes unrolled accesses to the simplification.
+    SmallVector<AffineExpr> dimReplacements;
+    for (unsigned i = 0; i < numDims; ++i) {
+      AffineExpr dim = getAffineDimExpr(i, expr.getContext());
+      auto forOp = getForInductionVarOwner(mapOperands[i]);
+      if (forOp && forOp.hasConstantLowerBound())
+        dimReplacements.push_back(forOp.getConstantLowerBound() +
+                                  dim * forOp.getStep());
+      else
+        dimReplacements.push_back(dim);
+    }
+    AffineExpr bankExpr = expr.replaceDims(dimReplacements) %
+                          partitioning.factor;
+    bankExpr = simplifyAffineExpr(bankExpr, numDims, numSymbols);
+    if (auto constant = bankExpr.dyn_cast<AffineConstantExpr>())
+      return constant.getValue();
+    return None;
+  }
+
+  // Under the block scheme, the range of the index has to lie within a single
+  // bank.
+  SmallVector<Optional<IndexRange>> operandRanges;
+  for (Value operand : mapOperands) {
+    if (auto forOp = getForInductionVarOwner(operand);
+        forOp && forOp.hasConstantBounds())
+      operandRanges.push_back(IndexRange{forOp.getConstantLowerBound(),
+                                         forOp.getConstantUpperBound() - 1});
+    else if (auto constantOp = operand.getDefiningOp<arith::ConstantIndexOp>())
+      operandRanges.push_back(
+          IndexRange{constantOp.value(), constantOp.value()});
+    else
+      operandRanges.push_back(None);
+  }
+  auto range = getRange(expr, operandRanges, numDims);
+  if (!range || range->min < 0)
+    return None;
+  int64_t bank = range->min / partitioning.bankSize;
+  if (range->max / partitioning.bankSize != bank)
+    return None;
+  return bank;
+}
+
+/// Returns the index within 'bank' of the index 'expr'.
+static AffineExpr getOffset(AffineExpr expr, int64_t bank,
+                            const Partitioning &partitioning) {
+  if (partitioning.scheme == PartitionScheme::Cyclic)
+    return expr.floorDiv(partitioning.factor);
+  return expr - bank * partitioning.bankSize;
+}
+
+/// Partitions the innermost dimension of the memory allocated by 'alloc'.
+/// Returns failure and leaves the IR untouched if the bank of any access to the
+/// memory cannot be determined statically.
+static LogicalResult partitionMemory(Operation *alloc,
+                                     ArrayRef<PartitionScheme> schemes,
+                                     int64_t factor) {
+  Value memref = alloc->getResult(0);
+  auto type = memref.getType().cast<MemRefType>();
+  if (!type.hasStaticShape() || type.getRank() == 0 ||
+      !type.getLayout().isIdentity())
+    return failure();
+  unsigned dim = type.getRank() - 1;
+  int64_t size = type.getDimSize(dim);
+  if (size < factor)
+    return failure();
+  int64_t bankSize = llvm::divideCeil(size, factor);
+
+  // Find a scheme under which every access targets a known bank.
+  SmallVector<std::pair<Operation *, int64_t>> accesses;
+  Optional<Partitioning> partitioning;
+  for (auto scheme : schemes) {
+    Partitioning candidate{scheme, factor, bankSize};
+    accesses.clear();
+    bool allKnown = llvm::all_of(memref.getUsers(), [&](Operation *user) {
+      if (isa<memref::DeallocOp>(user))
+        return true;
+      AffineMap map;
+      ValueRange mapOperands;
+      if (auto load = dyn_cast<AffineLoadOp>(user)) {
+        map = load.getAffineMap();
+        mapOperands = load.getMapOperands();
+      } else if (auto store = dyn_cast<AffineStoreOp>(user);
+                 store && store.getMemRef() == memref) {
+        map = store.getAffineMap();
+        mapOperands = store.getMapOperands();
+      } else {
+        return false;
+      }
+      auto bank = getBank(map.getResult(dim), map.getNumDims(),
+                          map.getNumSymbols(), mapOperands, candidate);
+      if (!bank)
+        return false;
+      accesses.push_back({user, *bank});
+      return true;
+    });
+    if (allKnown) {
+      partitioning = candidate;
+      break;
+    }
+  }
+  if (!partitioning)
+    return failure();
+
+  // Create the banks.
+  OpBuilder builder(alloc);
+  SmallVector<int64_t> bankShape(type.getShape());
+  bankShape[dim] = bankSize;
+  MemRefType bankType = MemRefType::Builder(type).setShape(bankShape);
+  SmallVector<Value> banks;
+  for (int64_t i = 0; i < factor; ++i) {
+    Operation *bank = builder.clone(*alloc);
+    bank->getResult(0).setType(bankType);
+    banks.push_back(bank->getResult(0));
+  }
+
+  // Redirect the accesses to their banks.
+  for (auto [user, bank] : accesses) {
+    builder.setInsertionPoint(user);
+    auto getBankMap = [&](AffineMap map) {
+      SmallVector<AffineExpr> results(map.getResults());
+      results[dim] =
+          simplifyAffineExpr(getOffset(results[dim], bank, *partitioning),
+                             map.getNumDims(), map.getNumSymbols());
+      return AffineMap::get(map.getNumDims(), map.getNumSymbols(), results,
+                            map.getContext());
+    };
+    if (auto load = dyn_cast<AffineLoadOp>(user)) {
+      auto bankLoad = builder.create<AffineLoadOp>(
+          load.getLoc(), banks[bank], getBankMap(load.getAffineMap()),
+          load.getMapOperands());
+      load.replaceAllUsesWith(bankLoad.getResult());
+    } else {
+      auto store = cast<AffineStoreOp>(user);
+      builder.create<AffineStoreOp>(store.getLoc(), store.getValueToStore(),
+                                    banks[bank],
+                                    getBankMap(store.getAffineMap()),
+                                    store.getMapOperands());
+    }
+    user->erase();
+  }
+
+  for (auto *user : llvm::make_early_inc_range(memref.getUsers())) {
+    auto dealloc = cast<memref::DeallocOp>(user);
+    builder.setInsertionPoint(dealloc);
+    for (auto bank : banks)
+      builder.create<memref::DeallocOp>(dealloc.getLoc(), bank);
+    dealloc.erase();
+  }
+  alloc->erase();
+  return success();
+}
+
+namespace {
+struct PartitionMemRefPass : public PartitionMemRefBase<PartitionMemRefPass> {
+  void runOnOperation() override {
+    auto schemes =
+        llvm::StringSwitch<SmallVector<PartitionScheme>>(scheme)
+            .Case("cyclic", {PartitionScheme::Cyclic})
+            .Case("block", {PartitionScheme::Block})
+            .Case("auto", {PartitionScheme::Cyclic, PartitionScheme::Block})
+            .Default({});
+    if (schemes.empty()) {
+      getOperation().emitError() << "unknown partitioning scheme '" << scheme
+                                 << "'";
+      return signalPassFailure();
+    }
+    if (factor < 2)
+      return markAllAnalysesPreserved();
+
+    SmallVector<Operation *> allocs;
+    getOperation().walk([&](Operation *op) {
+      if (isa<memref::AllocOp, memref::AllocaOp>(op))
+        allocs.push_back(op);
+    });
+    for (auto *alloc : allocs)
+      (void)partitionMemory(alloc, schemes, factor);
+  }
+};
+} // namespace
+
+std::unique_ptr<mlir::Pass> circt::createPartitionMemRefPass() {
+  return std::make_unique<PartitionMemRefPass>();
+}
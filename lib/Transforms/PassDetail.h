@@ -16,6 +16,7 @@
 #include "mlir/Transforms/Passes.h"
 
 namespace mlir {
+class AffineDialect;
 class MemrefDialect;
 
 // Forward declaration from Dialect.h
@@ -0,0 +1,64 @@
+//===- ProfileCanonicalize.cpp - Profiling canonicalizer --------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Contains the definitions of the profiling canonicalizer pass, which applies
+// the canonicalization patterns of all loaded dialects and operations and
+// records the time spent in every pattern.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "circt/Support/PatternProfiler.h"
+#include "circt/Transforms/Passes.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+using namespace mlir;
+using namespace circt;
+
+namespace {
+struct ProfileCanonicalizePass
+    : public ProfileCanonicalizeBase<ProfileCanonicalizePass> {
+  ProfileCanonicalizePass() = default;
+  ProfileCanonicalizePass(const GreedyRewriteConfig &config) {
+    topDownProcessingEnabled = config.useTopDownTraversal;
+    enableRegionSimplification = config.enableRegionSimplification;
+    maxIterations = config.maxIterations;
+  }
+
+  LogicalResult initialize(MLIRContext *context) override {
+    RewritePatternSet owningPatterns(context);
+    for (auto *dialect : context->getLoadedDialects())
+      dialect->getCanonicalizationPatterns(owningPatterns);
+    for (auto op : context->getRegisteredOperations())
+      op.getCanonicalizationPatterns(owningPatterns, context);
+    PatternProfiler::getGlobal().instrument(owningPatterns);
+    patterns = FrozenRewritePatternSet(std::move(owningPatterns));
+    return success();
+  }
+
+  void runOnOperation() override {
+    GreedyRewriteConfig config;
+    config.useTopDownTraversal = topDownProcessingEnabled;
+    config.enableRegionSimplification = enableRegionSimplification;
+    config.maxIterations = maxIterations;
+    (void)applyPatternsAndFoldGreedily(getOperation()->getRegions(), patterns,
+                                       config);
+  }
+
+  FrozenRewritePatternSet patterns;
+};
+} // namespace
+
+std::unique_ptr<mlir::Pass> circt::createProfileCanonicalizePass() {
+  return std::make_unique<ProfileCanonicalizePass>();
+}
+
+std::unique_ptr<mlir::Pass>
+circt::createProfileCanonicalizePass(const GreedyRewriteConfig &config) {
+  return std::make_unique<ProfileCanonicalizePass>(config);
+}
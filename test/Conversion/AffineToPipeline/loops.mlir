@@ -98,3 +98,35 @@ func.func @affine_dimension(%arg0: i32) -> i32 {
   }
   return %1 : i32
 }
+
+// The loop nest is flattened into a single pipeline, which recovers the
+// original induction variables from its own.
+// CHECK-LABEL: func @nested
+func.func @nested(%arg0 : memref<4x8xindex>) {
+  // CHECK: pipeline.while II = {{[0-9]+}} trip_count = 32
+  // CHECK:   pipeline.while.stage
+  // CHECK-DAG: arith.divsi
+  // CHECK-DAG: arith.remsi
+  // CHECK:   memref.store
+  // CHECK-NOT: affine.for
+  affine.for %arg1 = 0 to 4 {
+    affine.for %arg2 = 0 to 8 {
+      affine.store %arg2, %arg0[%arg1, %arg2] : memref<4x8xindex>
+    }
+  }
+  return
+}
+
+// Nests with non-constant bounds are not flattened.
+// CHECK-LABEL: func @nested_dynamic
+// CHECK: affine.for
+// CHECK: affine.for
+// CHECK-NOT: pipeline.while
+func.func @nested_dynamic(%arg0 : memref<4x8xindex>, %arg1 : index) {
+  affine.for %arg2 = 0 to %arg1 {
+    affine.for %arg3 = 0 to 8 {
+      affine.store %arg3, %arg0[%arg2, %arg3] : memref<4x8xindex>
+    }
+  }
+  return
+}
@@ -0,0 +1,64 @@
+// RUN: circt-opt %s --convert-comb-to-llvm=vectorize-width=64 | FileCheck %s
+
+// CHECK-LABEL: convert_wide_bitwise
+// CHECK-SAME: %[[A:.*]]: i256, %[[B:.*]]: i256, %[[C:.*]]: i256
+func.func @convert_wide_bitwise(%a : i256, %b : i256, %c : i256) {
+  // CHECK-NEXT: %[[VA:.*]] = llvm.bitcast %[[A]] : i256 to vector<4xi64>
+  // CHECK-NEXT: %[[VB:.*]] = llvm.bitcast %[[B]] : i256 to vector<4xi64>
+  // CHECK-NEXT: %[[AB:.*]] = llvm.and %[[VA]], %[[VB]] : vector<4xi64>
+  // CHECK-NEXT: %[[VC:.*]] = llvm.bitcast %[[C]] : i256 to vector<4xi64>
+  // CHECK-NEXT: %[[ABC:.*]] = llvm.and %[[AB]], %[[VC]] : vector<4xi64>
+  // CHECK-NEXT: llvm.bitcast %[[ABC]] : vector<4xi64> to i256
+  %0 = comb.and %a, %b, %c : i256
+  // CHECK: llvm.or %{{.*}}, %{{.*}} : vector<4xi64>
+  %1 = comb.or %a, %b : i256
+  // CHECK: llvm.xor %{{.*}}, %{{.*}} : vector<4xi64>
+  %2 = comb.xor %a, %b : i256
+  return
+}
+
+// Integers which are not made of whole words, or not wider than the
+// threshold, keep the scalar lowering.
+// CHECK-LABEL: convert_narrow_bitwise
+func.func @convert_narrow_bitwise(%a : i200, %b : i64) {
+  // CHECK-NEXT: llvm.and %{{.*}}, %{{.*}} : i200
+  %0 = comb.and %a, %a : i200
+  // CHECK-NEXT: llvm.and %{{.*}}, %{{.*}} : i64
+  %1 = comb.and %b, %b : i64
+  return
+}
+
+// CHECK-LABEL: convert_wide_extract
+// CHECK-SAME: %[[A:.*]]: i256
+func.func @convert_wide_extract(%a : i256) {
+  // CHECK-NEXT: %[[V:.*]] = llvm.bitcast %[[A]] : i256 to vector<4xi64>
+  // CHECK-NEXT: %[[IDX:.*]] = llvm.mlir.constant(1 : i32) : i32
+  // CHECK-NEXT: llvm.extractelement %[[V]][%[[IDX]] : i32] : vector<4xi64>
+  %0 = comb.extract %a from 64 : (i256) -> i64
+  // CHECK: llvm.extractelement
+  // CHECK: llvm.extractelement
+  // CHECK: llvm.mlir.undef : vector<2xi64>
+  // CHECK: llvm.insertelement
+  // CHECK: llvm.insertelement
+  // CHECK: llvm.bitcast %{{.*}} : vector<2xi64> to i128
+  %1 = comb.extract %a from 128 : (i256) -> i128
+  // CHECK: llvm.lshr %{{.*}}, %{{.*}} : i256
+  // CHECK: llvm.trunc %{{.*}} : i256 to i64
+  %2 = comb.extract %a from 3 : (i256) -> i64
+  return
+}
+
+// CHECK-LABEL: convert_wide_concat
+// CHECK-SAME: %[[A:.*]]: i64, %[[B:.*]]: i128
+func.func @convert_wide_concat(%a : i64, %b : i128) {
+  // CHECK-NEXT: %[[VB:.*]] = llvm.bitcast %[[B]] : i128 to vector<2xi64>
+  // CHECK: %[[B0:.*]] = llvm.extractelement %[[VB]]
+  // CHECK: %[[B1:.*]] = llvm.extractelement %[[VB]]
+  // CHECK: %[[U:.*]] = llvm.mlir.undef : vector<3xi64>
+  // CHECK: %[[V0:.*]] = llvm.insertelement %[[B0]], %[[U]]
+  // CHECK: %[[V1:.*]] = llvm.insertelement %[[B1]], %[[V0]]
+  // CHECK: %[[V2:.*]] = llvm.insertelement %[[A]], %[[V1]]
+  // CHECK-NEXT: llvm.bitcast %[[V2]] : vector<3xi64> to i192
+  %0 = comb.concat %a, %b : i64, i128
+  return
+}
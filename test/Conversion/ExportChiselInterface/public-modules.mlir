@@ -0,0 +1,31 @@
+// RUN: circt-opt %s --export-chisel-interface | FileCheck %s
+// RUN: rm -rf %t
+// RUN: circt-opt %s --export-split-chisel-interface='dir-name=%t'
+// RUN: FileCheck %s --check-prefix=FOO --input-file=%t/Foo.scala
+// RUN: FileCheck %s --check-prefix=BAR --input-file=%t/Bar.scala
+// RUN: not ls %t/Baz.scala
+
+// CHECK-LABEL: package shelf.foo
+// CHECK-LABEL: class Foo extends ExtModule {
+// CHECK-NEXT:    val a = IO(Input(UInt(1.W)))
+// CHECK-NEXT:  }
+// CHECK-EMPTY:
+// CHECK-NEXT:  class Bar extends ExtModule {
+// CHECK-NEXT:    val b = IO(Output(UInt(2.W)))
+// CHECK-NEXT:  }
+// CHECK-NOT:   class Baz
+
+// FOO-LABEL: package shelf.foo
+// FOO-LABEL: class Foo extends ExtModule {
+// FOO-NEXT:    val a = IO(Input(UInt(1.W)))
+// FOO-NEXT:  }
+
+// BAR-LABEL: package shelf.foo
+// BAR-LABEL: class Bar extends ExtModule {
+// BAR-NEXT:    val b = IO(Output(UInt(2.W)))
+// BAR-NEXT:  }
+firrtl.circuit "Foo" {
+  firrtl.module @Bar(out %b: !firrtl.uint<2>) {}
+  firrtl.module private @Baz(in %c: !firrtl.uint<3>) {}
+  firrtl.module @Foo(in %a: !firrtl.uint<1>) {}
+}
@@ -0,0 +1,34 @@
+// RUN: circt-opt %s -export-verilog='stats-file=%t.json' -o /dev/null > /dev/null
+// RUN: FileCheck %s --input-file=%t.json
+
+// CHECK:      [
+// CHECK-NEXT:   {
+// CHECK-NEXT:     "module": "Leaf",
+// CHECK-NEXT:     "wallTime": {{[0-9.e+-]+}},
+// CHECK-NEXT:     "bytesEmitted": {{[1-9][0-9]*}},
+// CHECK-NEXT:     "declarations": 0,
+// CHECK-NEXT:     "temporaries": 0,
+// CHECK-NEXT:     "maxExpressionDepth": 2
+// CHECK-NEXT:   },
+hw.module @Leaf(%a: i4, %b: i4, %c: i4) -> (out: i4) {
+  %0 = comb.xor %a, %b : i4
+  %1 = comb.add %0, %c : i4
+  hw.output %1 : i4
+}
+
+// CHECK-NEXT:   {
+// CHECK-NEXT:     "module": "Top",
+// CHECK-NEXT:     "wallTime": {{[0-9.e+-]+}},
+// CHECK-NEXT:     "bytesEmitted": {{[1-9][0-9]*}},
+// CHECK-NEXT:     "declarations": 1,
+// CHECK-NEXT:     "temporaries": 0,
+// CHECK-NEXT:     "maxExpressionDepth": 2
+// CHECK-NEXT:   }
+// CHECK-NEXT: ]
+hw.module @Top(%a: i4) -> (out: i4) {
+  %w = sv.wire : !hw.inout<i4>
+  sv.assign %w, %a : i4
+  %0 = sv.read_inout %w : !hw.inout<i4>
+  %1 = comb.and %0, %a : i4
+  hw.output %1 : i4
+}
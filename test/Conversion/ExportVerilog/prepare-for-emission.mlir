@@ -177,3 +177,26 @@ module attributes {circt.loweringOptions =
     hw.output %2 : i8
   }
 }
+
+// -----
+module attributes {circt.loweringOptions =
+                  "wireSpillingHeuristic=spillDeepExpressions,wireSpillingDepthLimit=2"} {
+  // CHECK-LABEL: deepExpressions
+  hw.module @deepExpressions(%a: i8, %b: i8) -> (c: i8) {
+    // The third nested add exceeds the depth limit and is spilled, such that
+    // the depth count restarts for its user.
+    // CHECK:      %0 = comb.add %a, %b
+    // CHECK-NEXT: %1 = comb.add %0, %a
+    // CHECK-NEXT: %2 = comb.add %1, %b
+    // CHECK-NEXT: %[[wire:.+]] = sv.wire
+    // CHECK-NEXT: sv.assign %[[wire]], %2
+    // CHECK-NEXT: %[[read:.+]] = sv.read_inout %[[wire]]
+    // CHECK-NEXT: %[[add:.+]] = comb.add %[[read]], %a
+    // CHECK-NEXT: hw.output %[[add]]
+    %0 = comb.add %a, %b : i8
+    %1 = comb.add %0, %a : i8
+    %2 = comb.add %1, %b : i8
+    %3 = comb.add %2, %a : i8
+    hw.output %3 : i8
+  }
+}
@@ -0,0 +1,23 @@
+// RUN: rm -rf %t.dir
+// RUN: circt-opt %s --export-split-verilog='dir-name=%t.dir skip-unchanged-files=true'
+// Backdate an unchanged file and clobber another one, then emit again.  Only
+// the clobbered file may be rewritten.
+// RUN: touch -t 200001010000 %t.dir/Foo.sv
+// RUN: echo "stale" > %t.dir/Bar.sv
+// RUN: circt-opt %s --export-split-verilog='dir-name=%t.dir skip-unchanged-files=true'
+// RUN: test %t.dir/Foo.sv -ot %t.dir/Bar.sv
+// RUN: FileCheck %s --check-prefix=BAR --input-file=%t.dir/Bar.sv
+// RUN: FileCheck %s --check-prefix=LIST --input-file=%t.dir/filelist.f
+
+// LIST: Foo.sv
+// LIST-NEXT: Bar.sv
+
+hw.module @Foo() -> () {
+  hw.output
+}
+
+// BAR-NOT: stale
+// BAR: module Bar
+hw.module @Bar() -> () {
+  hw.output
+}
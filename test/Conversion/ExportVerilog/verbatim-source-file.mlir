@@ -0,0 +1,16 @@
+// RUN: split-file %s %t
+// RUN: cd %t
+// RUN: circt-opt --export-verilog --verify-diagnostics Top.mlir | FileCheck Top.mlir
+// RUN: circt-opt --export-verilog --verify-diagnostics Missing.mlir
+
+//--- Source.sv
+module Source({{0}});
+endmodule
+//--- Top.mlir
+// The contents of the source file are copied without substitutions.
+// CHECK-LABEL: module Source({{[{][{]}}0{{[}][}]}});
+// CHECK-NEXT:  endmodule
+sv.verbatim "" {sv.verbatim.source_file = "Source.sv"}
+//--- Missing.mlir
+// expected-error @+1 {{'sv.verbatim' op cannot read source file 'Missing.sv'}}
+sv.verbatim "" {sv.verbatim.source_file = "Missing.sv"}
@@ -0,0 +1,129 @@
+// RUN: circt-opt -convert-fsm-to-sv='state-encoding=one-hot' %s | FileCheck %s --check-prefix=ONEHOT
+// RUN: circt-opt -convert-fsm-to-sv='state-encoding=gray' %s | FileCheck %s --check-prefix=GRAY
+// RUN: circt-opt -convert-fsm-to-sv='state-encoding=auto' %s | FileCheck %s --check-prefix=AUTO
+
+// ONEHOT-NOT:   hw.typedecl
+// ONEHOT-LABEL: hw.module @counter
+// ONEHOT:         hw.constant 1 : i5
+// ONEHOT:         %to_A = sv.reg sym @A
+// ONEHOT:         hw.constant 2 : i5
+// ONEHOT:         hw.constant 4 : i5
+// ONEHOT:         hw.constant 8 : i5
+// ONEHOT:         hw.constant -16 : i5
+// ONEHOT:         %to_E = sv.reg sym @E
+// ONEHOT:         %state_reg = seq.compreg {{.+}} : i5
+// ONEHOT:         sv.case %state_reg : i5
+// ONEHOT-NEXT:    case b00001: {
+// ONEHOT:         case b00010: {
+// ONEHOT:         case b00100: {
+// ONEHOT:         case b01000: {
+// ONEHOT:         case b10000: {
+
+// GRAY-LABEL: hw.module @counter
+// GRAY:         hw.constant 0 : i3
+// GRAY:         hw.constant 1 : i3
+// GRAY:         hw.constant 3 : i3
+// GRAY:         hw.constant 2 : i3
+// GRAY:         hw.constant -2 : i3
+// GRAY:         %state_reg = seq.compreg {{.+}} : i3
+// GRAY:         sv.case %state_reg : i3
+// GRAY-NEXT:    case b000: {
+// GRAY:         case b001: {
+// GRAY:         case b011: {
+// GRAY:         case b010: {
+// GRAY:         case b110: {
+
+// Machines which only advance to their next state are Gray encoded, sparse
+// machines are one-hot encoded and small machines use an enum.
+// AUTO:       hw.typedecl @small_state_t : !hw.enum<IDLE, BUSY>
+// AUTO-LABEL: hw.module @counter
+// AUTO:         %state_reg = seq.compreg {{.+}} : i3
+// AUTO-LABEL: hw.module @dispatch
+// AUTO:         %state_reg = seq.compreg {{.+}} : i5
+// AUTO-LABEL: hw.module @small
+// AUTO:         %state_reg = seq.compreg {{.+}} : !hw.typealias<@fsm_enum_typedecls::@small_state_t, !hw.enum<IDLE, BUSY>>
+
+fsm.machine @counter(%en: i1) -> (i8) attributes {initialState = "A"} {
+  %c0 = hw.constant 0 : i8
+  fsm.state @A output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @B guard {
+      fsm.return %en
+    }
+  }
+  fsm.state @B output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @C
+  }
+  fsm.state @C output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @D
+  }
+  fsm.state @D output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @E
+  }
+  fsm.state @E output {
+    %c1 = hw.constant 1 : i8
+    fsm.output %c1 : i8
+  } transitions {
+    fsm.transition @A
+  }
+}
+
+fsm.machine @dispatch(%sel: i1) -> (i8) attributes {initialState = "A"} {
+  %c0 = hw.constant 0 : i8
+  %c1 = hw.constant 1 : i8
+  fsm.state @A output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @B guard {
+      fsm.return %sel
+    }
+    fsm.transition @C
+  }
+  fsm.state @B output {
+    fsm.output %c1 : i8
+  } transitions {
+    fsm.transition @A
+  }
+  fsm.state @C output {
+    fsm.output %c1 : i8
+  } transitions {
+    fsm.transition @D
+  }
+  fsm.state @D output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @E guard {
+      fsm.return %sel
+    }
+    fsm.transition @A
+  }
+  fsm.state @E output {
+    fsm.output %c1 : i8
+  } transitions {
+    fsm.transition @A
+  }
+}
+
+fsm.machine @small(%go: i1) -> (i1) attributes {initialState = "IDLE"} {
+  %true = hw.constant true
+  %false = hw.constant false
+  fsm.state @IDLE output {
+    fsm.output %false : i1
+  } transitions {
+    fsm.transition @BUSY guard {
+      fsm.return %go
+    }
+  }
+  fsm.state @BUSY output {
+    fsm.output %true : i1
+  } transitions {
+    fsm.transition @IDLE
+  }
+}
@@ -126,34 +126,24 @@ hw.module @mul(%op0: i32, %op1: i32) -> (sisi: i32, siui: i32, uisi: i32, uiui:
 
 // CHECK:  %[[SIGN_BIT_OP0:.*]] = comb.extract %op0 from 31 : (i32) -> i1
 // CHECK:  %[[SIGN_EXTEND:.*]] = comb.replicate %[[SIGN_BIT_OP0]] : (i1) -> i32
-// CHECK:  %[[OP0_PADDED:.*]] = comb.concat %[[SIGN_EXTEND]], %op0 : i32, i32
+// CHECK:  %[[OP0_SEXT:.*]] = comb.concat %[[SIGN_EXTEND]], %op0 : i32, i32
 // CHECK:  %[[SIGN_BIT_OP1:.*]] = comb.extract %op1 from 31 : (i32) -> i1
 // CHECK:  %[[SIGN_EXTEND:.*]] = comb.replicate %[[SIGN_BIT_OP1]] : (i1) -> i32
-// CHECK:  %[[OP1_PADDED:.*]] = comb.concat %[[SIGN_EXTEND]], %op1 : i32, i32
-// CHECK:  %[[SISI_RES:.*]] = comb.mul %[[OP0_PADDED]], %[[OP1_PADDED]] : i64
+// CHECK:  %[[OP1_SEXT:.*]] = comb.concat %[[SIGN_EXTEND]], %op1 : i32, i32
+// CHECK:  %[[SISI_RES:.*]] = comb.mul %[[OP0_SEXT]], %[[OP1_SEXT]] : i64
   %sisi = hwarith.mul %op0Signed, %op1Signed : (si32, si32) -> si64
 
-// CHECK:  %[[SIGN_BIT_OP0:.*]] = comb.extract %op0 from 31 : (i32) -> i1
-// CHECK:  %[[SIGN_EXTEND:.*]] = comb.replicate %[[SIGN_BIT_OP0]] : (i1) -> i32
-// CHECK:  %[[OP0_PADDED:.*]] = comb.concat %[[SIGN_EXTEND]], %op0 : i32, i32
 // CHECK:  %[[ZERO_EXTEND:.*]] = hw.constant 0 : i32
-// CHECK:  %[[OP1_PADDED:.*]] = comb.concat %[[ZERO_EXTEND]], %op1 : i32, i32
-// CHECK:  %[[SIUI_RES:.*]] = comb.mul %[[OP0_PADDED]], %[[OP1_PADDED]] : i64
+// CHECK:  %[[OP1_ZEXT:.*]] = comb.concat %[[ZERO_EXTEND]], %op1 : i32, i32
+// CHECK:  %[[SIUI_RES:.*]] = comb.mul %[[OP0_SEXT]], %[[OP1_ZEXT]] : i64
   %siui = hwarith.mul %op0Signed, %op1Unsigned : (si32, ui32) -> si64
 
 // CHECK:  %[[ZERO_EXTEND:.*]] = hw.constant 0 : i32
-// CHECK:  %[[OP0_PADDED:.*]] = comb.concat %[[ZERO_EXTEND]], %op0 : i32, i32
-// CHECK:  %[[SIGN_BIT_OP1:.*]] = comb.extract %op1 from 31 : (i32) -> i1
-// CHECK:  %[[SIGN_EXTEND:.*]] = comb.replicate %[[SIGN_BIT_OP1]] : (i1) -> i32
-// CHECK:  %[[OP1_PADDED:.*]] = comb.concat %[[SIGN_EXTEND]], %op1 : i32, i32
-// CHECK:  %[[UISI_RES:.*]] = comb.mul %[[OP0_PADDED]], %[[OP1_PADDED]] : i64
+// CHECK:  %[[OP0_ZEXT:.*]] = comb.concat %[[ZERO_EXTEND]], %op0 : i32, i32
+// CHECK:  %[[UISI_RES:.*]] = comb.mul %[[OP0_ZEXT]], %[[OP1_SEXT]] : i64
   %uisi = hwarith.mul %op0Unsigned, %op1Signed : (ui32, si32) -> si64
 
-// CHECK:  %[[ZERO_EXTEND:.*]] = hw.constant 0 : i32
-// CHECK:  %[[OP0_PADDED:.*]] = comb.concat %[[ZERO_EXTEND]], %op0 : i32, i32
-// CHECK:  %[[ZERO_EXTEND:.*]] = hw.constant 0 : i32
-// CHECK:  %[[OP1_PADDED:.*]] = comb.concat %[[ZERO_EXTEND]], %op1 : i32, i32
-// CHECK:  %[[UIUI_RES:.*]] = comb.mul %[[OP0_PADDED]], %[[OP1_PADDED]] : i64
+// CHECK:  %[[UIUI_RES:.*]] = comb.mul %[[OP0_ZEXT]], %[[OP1_ZEXT]] : i64
   %uiui = hwarith.mul %op0Unsigned, %op1Unsigned : (ui32, ui32) -> ui64
 
 // CHECK:  %[[SISI_OUT:.*]] = comb.extract %[[SISI_RES]] from 0 : (i64) -> i32
@@ -179,25 +169,21 @@ hw.module @div(%op0: i32, %op1: i32) -> (sisi: i32, siui: i32, uisi: i32, uiui:
   %op1Unsigned = hwarith.cast %op1 : (i32) -> ui32
 
 // CHECK:   %[[SIGN_BIT_OP0:.*]] = comb.extract %op0 from 31 : (i32) -> i1
-// CHECK:   %[[OP0_PADDED:.*]] = comb.concat %[[SIGN_BIT_OP0]], %op0 : i1, i32
+// CHECK:   %[[OP0_SEXT:.*]] = comb.concat %[[SIGN_BIT_OP0]], %op0 : i1, i32
 // CHECK:   %[[SIGN_BIT_OP1:.*]] = comb.extract %op1 from 31 : (i32) -> i1
-// CHECK:   %[[OP1_PADDED:.*]] = comb.concat %[[SIGN_BIT_OP1]], %op1 : i1, i32
-// CHECK:   %[[SISI_RES:.*]] = comb.divs %[[OP0_PADDED]], %[[OP1_PADDED]] : i33
+// CHECK:   %[[OP1_SEXT:.*]] = comb.concat %[[SIGN_BIT_OP1]], %op1 : i1, i32
+// CHECK:   %[[SISI_RES:.*]] = comb.divs %[[OP0_SEXT]], %[[OP1_SEXT]] : i33
   %sisi = hwarith.div %op0Signed, %op1Signed : (si32, si32) -> si33
 
-// CHECK:   %[[SIGN_BIT_OP0:.*]] = comb.extract %op0 from 31 : (i32) -> i1
-// CHECK:   %[[OP0_PADDED:.*]] = comb.concat %[[SIGN_BIT_OP0]], %op0 : i1, i32
 // CHECK:   %[[ZERO_EXTEND:.*]] = hw.constant false
-// CHECK:   %[[OP1_PADDED:.*]] = comb.concat %[[ZERO_EXTEND]], %op1 : i1, i32
-// CHECK:   %[[SIUI_RES_IMM:.*]] = comb.divs %[[OP0_PADDED]], %[[OP1_PADDED]] : i33
+// CHECK:   %[[OP1_ZEXT:.*]] = comb.concat %[[ZERO_EXTEND]], %op1 : i1, i32
+// CHECK:   %[[SIUI_RES_IMM:.*]] = comb.divs %[[OP0_SEXT]], %[[OP1_ZEXT]] : i33
 // CHECK:   %[[SIUI_RES:.*]] = comb.extract %[[SIUI_RES_IMM]] from 0 : (i33) -> i32
   %siui = hwarith.div %op0Signed, %op1Unsigned : (si32, ui32) -> si32
 
 // CHECK:   %[[ZERO_EXTEND:.*]] = hw.constant false
-// CHECK:   %[[OP0_PADDED:.*]] = comb.concat %[[ZERO_EXTEND]], %op0 : i1, i32
-// CHECK:   %[[SIGN_BIT_OP1:.*]] = comb.extract %op1 from 31 : (i32) -> i1
-// CHECK:   %[[OP1_PADDED:.*]] = comb.concat %[[SIGN_BIT_OP1]], %op1 : i1, i32
-// CHECK:   %[[UISI_RES:.*]] = comb.divs %[[OP0_PADDED]], %[[OP1_PADDED]] : i33
+// CHECK:   %[[OP0_ZEXT:.*]] = comb.concat %[[ZERO_EXTEND]], %op0 : i1, i32
+// CHECK:   %[[UISI_RES:.*]] = comb.divs %[[OP0_ZEXT]], %[[OP1_SEXT]] : i33
   %uisi = hwarith.div %op0Unsigned, %op1Signed : (ui32, si32) -> si33
 
 // CHECK:   %[[UIUI_RES:.*]] = comb.divu %op0, %op1 : i32
@@ -276,13 +262,11 @@ hw.module @icmp_mixed_width(%op0: i5, %op1: i7) -> (sisi: i1, siui: i1, uisi: i1
   %siui = hwarith.icmp lt %op0Signed, %op1Unsigned : si5, ui7
 
 // CHECK:   %[[ZERO_EXTEND:.*]] = hw.constant 0 : i2
-// CHECK:   %[[OP0_PADDED:.*]] = comb.concat %[[ZERO_EXTEND]], %op0 : i2, i5
-// CHECK:   %[[UISI_OUT:.*]] = comb.icmp slt %[[OP0_PADDED]], %op1 : i7
+// CHECK:   %[[OP0_ZEXT:.*]] = comb.concat %[[ZERO_EXTEND]], %op0 : i2, i5
+// CHECK:   %[[UISI_OUT:.*]] = comb.icmp slt %[[OP0_ZEXT]], %op1 : i7
   %uisi = hwarith.icmp lt %op0Unsigned, %op1Signed : ui5, si7
 
-// CHECK:   %[[ZERO_EXTEND:.*]] = hw.constant 0 : i2
-// CHECK:   %[[OP0_PADDED:.*]] = comb.concat %[[ZERO_EXTEND]], %op0 : i2, i5
-// CHECK:   %[[UIUI_OUT:.*]] = comb.icmp ult %[[OP0_PADDED]], %op1 : i7
+// CHECK:   %[[UIUI_OUT:.*]] = comb.icmp ult %[[OP0_ZEXT]], %op1 : i7
   %uiui = hwarith.icmp lt %op0Unsigned, %op1Unsigned : ui5, ui7
 
   %sisiOut = hwarith.cast %sisi : (ui1) -> i1
@@ -333,9 +317,7 @@ msft.module.extern @externModule(%a: ui8, %b: ui8) -> (out: !hw.struct<foo: !hw.
 // CHECK-LABEL:   hw.module @backedges() {
 // CHECK-NEXT:      %[[VAL_0:.*]] = hw.constant false
 // CHECK-NEXT:      %[[VAL_1:.*]] = comb.concat %[[VAL_0]], %[[VAL_2:.*]] : i1, i1
-// CHECK-NEXT:      %[[VAL_3:.*]] = hw.constant false
-// CHECK-NEXT:      %[[VAL_4:.*]] = comb.concat %[[VAL_3]], %[[VAL_2]] : i1, i1
-// CHECK-NEXT:      %[[VAL_5:.*]] = comb.add %[[VAL_1]], %[[VAL_4]] : i2
+// CHECK-NEXT:      %[[VAL_3:.*]] = comb.add %[[VAL_1]], %[[VAL_1]] : i2
 // CHECK-NEXT:      %[[VAL_2]] = hw.constant true
 // CHECK-NEXT:      hw.output
 // CHECK-NEXT:    }
@@ -343,3 +325,23 @@ hw.module @backedges() {
   %res = hwarith.add %arg, %arg : (ui1, ui1) -> ui2
   %arg = hwarith.constant 1 : ui1
 }
+
+// -----
+
+// Extensions of a value are shared between users, and extensions of an
+// extended value are created from the original value.
+// CHECK-LABEL: hw.module @sharedExtensions(%a: i4, %b: i8) -> (out0: i9, out1: i9) {
+// CHECK:         %[[ZEROS:.*]] = hw.constant 0 : i5
+// CHECK-NEXT:    %[[A_EXT:.*]] = comb.concat %[[ZEROS]], %a : i5, i4
+// CHECK-NEXT:    %[[FALSE:.*]] = hw.constant false
+// CHECK-NEXT:    %[[B_EXT:.*]] = comb.concat %[[FALSE]], %b : i1, i8
+// CHECK-NEXT:    %[[OUT0:.*]] = comb.add %[[A_EXT]], %[[B_EXT]] : i9
+// CHECK-NEXT:    %[[OUT1:.*]] = comb.sub %[[A_EXT]], %[[B_EXT]] : i9
+// CHECK-NEXT:    hw.output %[[OUT0]], %[[OUT1]] : i9, i9
+// CHECK-NEXT:  }
+hw.module @sharedExtensions(%a: ui4, %b: ui8) -> (out0: ui9, out1: si9) {
+  %0 = hwarith.cast %a : (ui4) -> ui8
+  %1 = hwarith.add %0, %b : (ui8, ui8) -> ui9
+  %2 = hwarith.sub %0, %b : (ui8, ui8) -> si9
+  hw.output %1, %2 : ui9, si9
+}
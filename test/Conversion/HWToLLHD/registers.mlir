@@ -0,0 +1,28 @@
+// RUN: circt-opt --convert-hw-to-llhd %s | FileCheck %s
+
+// CHECK-LABEL: llhd.entity @Register
+// CHECK-SAME: (%[[CLK:.+]] : !llhd.sig<i1>, %[[D:.+]] : !llhd.sig<i8>) ->
+// CHECK-SAME: (%[[OUT:.+]] : !llhd.sig<i8>)
+hw.module @Register(%clk: i1, %d: i8) -> (q: i8) {
+  // CHECK-DAG: %[[CLKV:.+]] = llhd.prb %[[CLK]]
+  // CHECK-DAG: %[[DV:.+]] = llhd.prb %[[D]]
+  // CHECK-DAG: %[[ZERO:.+]] = hw.constant 0 : i8
+  // CHECK: %[[Q:.+]] = llhd.sig "q" %[[ZERO]] : i8
+  // CHECK: %[[T:.+]] = llhd.constant_time #llhd.time<0ns, 1d, 0e>
+  // CHECK: llhd.reg %[[Q]], (%[[DV]], "rise" %[[CLKV]] after %[[T]] : i8) : !llhd.sig<i8>
+  // CHECK: %[[QV:.+]] = llhd.prb %[[Q]]
+  // CHECK: llhd.drv %[[OUT]], %[[QV]]
+  %q = seq.compreg %d, %clk : i8
+  hw.output %q : i8
+}
+
+// The synchronous reset takes precedence on the same clock edge.
+// CHECK-LABEL: llhd.entity @ResetRegister
+hw.module @ResetRegister(%clk: i1, %rst: i1, %d: i8) -> (q: i8) {
+  // CHECK: %[[INIT:.+]] = hw.constant 42 : i8
+  // CHECK: %[[Q:.+]] = llhd.sig "q"
+  // CHECK: llhd.reg %[[Q]], (%[[INIT]], "rise" %{{.+}} after %{{.+}} if %{{.+}} : i8), (%{{.+}}, "rise" %{{.+}} after %{{.+}} : i8) : !llhd.sig<i8>
+  %c42_i8 = hw.constant 42 : i8
+  %q = seq.compreg %d, %clk, %rst, %c42_i8 : i8
+  hw.output %q : i8
+}
@@ -42,6 +42,45 @@ hw.module @adder (%a: i32, %b: i32) -> (sum: i32) {
 // CHECK-NEXT: }
 }
 
+// CHECK-LABEL: systemc.module @disjointCones
+hw.module @disjointCones (%a: i32, %b: i32, %c: i32) -> (sum: i32, prod: i32, zero: i32) {
+  // CHECK-NEXT: systemc.ctor {
+  // CHECK-NEXT:   systemc.method %innerLogic_sum
+  // CHECK-NEXT:   systemc.sensitive %a, %b : !systemc.in<!systemc.uint<32>>, !systemc.in<!systemc.uint<32>>
+  // CHECK-NEXT:   systemc.method %innerLogic_prod
+  // CHECK-NEXT:   systemc.sensitive %a, %c : !systemc.in<!systemc.uint<32>>, !systemc.in<!systemc.uint<32>>
+  // CHECK-NEXT:   systemc.method %innerLogic_zero
+  // CHECK-NEXT: }
+  // CHECK-NEXT: %innerLogic_sum = systemc.func  {
+  // CHECK-NEXT:   [[A:%.+]] = systemc.signal.read %a : !systemc.in<!systemc.uint<32>>
+  // CHECK-NEXT:   [[AC:%.+]] = systemc.convert [[A]] : (!systemc.uint<32>) -> i32
+  // CHECK-NEXT:   [[B:%.+]] = systemc.signal.read %b : !systemc.in<!systemc.uint<32>>
+  // CHECK-NEXT:   [[BC:%.+]] = systemc.convert [[B]] : (!systemc.uint<32>) -> i32
+  // CHECK-NEXT:   [[SUM:%.+]] = comb.add [[AC]], [[BC]] : i32
+  // CHECK-NEXT:   [[SUMC:%.+]] = systemc.convert [[SUM]] : (i32) -> !systemc.uint<32>
+  // CHECK-NEXT:   systemc.signal.write %sum, [[SUMC]] : !systemc.out<!systemc.uint<32>>
+  // CHECK-NEXT: }
+  // CHECK-NEXT: %innerLogic_prod = systemc.func  {
+  // CHECK-NEXT:   [[A:%.+]] = systemc.signal.read %a : !systemc.in<!systemc.uint<32>>
+  // CHECK-NEXT:   [[AC:%.+]] = systemc.convert [[A]] : (!systemc.uint<32>) -> i32
+  // CHECK-NEXT:   [[C:%.+]] = systemc.signal.read %c : !systemc.in<!systemc.uint<32>>
+  // CHECK-NEXT:   [[CC:%.+]] = systemc.convert [[C]] : (!systemc.uint<32>) -> i32
+  // CHECK-NEXT:   [[PROD:%.+]] = comb.mul [[AC]], [[CC]] : i32
+  // CHECK-NEXT:   [[PRODC:%.+]] = systemc.convert [[PROD]] : (i32) -> !systemc.uint<32>
+  // CHECK-NEXT:   systemc.signal.write %prod, [[PRODC]] : !systemc.out<!systemc.uint<32>>
+  // CHECK-NEXT: }
+  // CHECK-NEXT: %innerLogic_zero = systemc.func  {
+  // CHECK-NEXT:   %c0_i32 = hw.constant 0 : i32
+  // CHECK-NEXT:   [[CAST:%.+]] = systemc.convert %c0_i32 : (i32) -> !systemc.uint<32>
+  // CHECK-NEXT:   systemc.signal.write %zero, [[CAST]] : !systemc.out<!systemc.uint<32>>
+  // CHECK-NEXT: }
+  %0 = comb.add %a, %b : i32
+  %1 = comb.mul %a, %c : i32
+  %2 = hw.constant 0 : i32
+  hw.output %0, %1, %2 : i32, i32, i32
+// CHECK-NEXT: }
+}
+
 // CHECK-LABEL: systemc.module private @moduleVisibility
 hw.module private @moduleVisibility () -> () {}
 
@@ -0,0 +1,49 @@
+// RUN: circt-opt -lower-handshake-to-hw="buffer-implementation=pipeline" --split-input-file %s | FileCheck %s --check-prefix=PIPELINE
+// RUN: circt-opt -lower-handshake-to-hw="sram-buffer-threshold=8" --split-input-file %s | FileCheck %s --check-prefix=SRAM
+
+// A pipeline buffer has a single valid and data register per slot, and its
+// ready signal is combinational.
+// PIPELINE-LABEL:   hw.module @handshake_buffer_in_ui32_out_ui32_2slots_seq(
+// PIPELINE-SAME:          %[[IN:.*]]: !esi.channel<i32>, %[[CLOCK:.*]]: i1, %[[RESET:.*]]: i1) -> (out0: !esi.channel<i32>) {
+// PIPELINE:           %[[DATA_IN:.*]], %[[VALID_IN:.*]] = esi.unwrap.vr %[[IN]], %[[READY_IN:.*]] : i32
+// PIPELINE:           %[[CHANNEL:.*]], %[[READY_OUT:.*]] = esi.wrap.vr %[[DATA1:.*]], %[[VALID1:.*]] : i32
+// PIPELINE:           %[[VALID0:.*]] = seq.compreg %{{.*}}, %[[CLOCK]], %[[RESET]], %false  : i1
+// PIPELINE:           %[[READY_IN]] = comb.or %{{.*}}, %[[READY1:.*]] : i1
+// PIPELINE:           %[[DATA0:.*]] = seq.compreg %{{.*}}, %[[CLOCK]], %[[RESET]], %c0_i32  : i32
+// PIPELINE:           %[[VALID1]] = seq.compreg %{{.*}}, %[[CLOCK]], %[[RESET]], %false  : i1
+// PIPELINE:           %[[READY1]] = comb.or %{{.*}}, %[[READY_OUT]] : i1
+// PIPELINE:           %[[DATA1]] = seq.compreg %{{.*}}, %[[CLOCK]], %[[RESET]], %c0_i32  : i32
+// PIPELINE-NOT:       seq.compreg
+// PIPELINE:           hw.output %[[CHANNEL]] : !esi.channel<i32>
+
+// Buffers below the threshold keep their registers.
+// SRAM-LABEL:   hw.module @handshake_buffer_in_ui32_out_ui32_2slots_seq(
+// SRAM-NOT:       seq.hlmem
+// SRAM:           hw.output
+handshake.func @test_pipeline(%arg0: i32, %arg1: none, ...) -> (i32, none) {
+  %0 = buffer [2] seq %arg0 : i32
+  return %0, %arg1 : i32, none
+}
+
+// -----
+
+// Deep buffers are circular FIFOs on top of a memory.
+// SRAM-LABEL:   hw.module @handshake_buffer_in_ui32_out_ui32_10slots_seq(
+// SRAM-SAME:          %[[IN:.*]]: !esi.channel<i32>, %[[CLOCK:.*]]: i1, %[[RESET:.*]]: i1) -> (out0: !esi.channel<i32>) {
+// SRAM:           %[[DATA_IN:.*]], %[[VALID_IN:.*]] = esi.unwrap.vr %[[IN]], %[[NOT_FULL:.*]] : i32
+// SRAM:           %[[CHANNEL:.*]], %[[READY_OUT:.*]] = esi.wrap.vr %[[DATA_OUT:.*]], %[[NOT_EMPTY:.*]] : i32
+// SRAM:           %[[COUNT:.*]] = seq.compreg %{{.*}}, %[[CLOCK]], %[[RESET]], %{{.*}}  : i4
+// SRAM:           %[[NOT_EMPTY]] = comb.icmp ne, %[[COUNT]], %{{.*}} : i4
+// SRAM:           %[[NOT_FULL]] = comb.icmp ne, %[[COUNT]], %{{.*}} : i4
+// SRAM:           %[[WRITE:.*]] = comb.and %[[VALID_IN]], %[[NOT_FULL]] : i1
+// SRAM:           %[[READ:.*]] = comb.and %[[READY_OUT]], %[[NOT_EMPTY]] : i1
+// SRAM:           %[[WRITE_PTR:.*]] = seq.compreg %{{.*}}, %[[CLOCK]], %[[RESET]], %{{.*}}  : i4
+// SRAM:           %[[READ_PTR:.*]] = seq.compreg %{{.*}}, %[[CLOCK]], %[[RESET]], %{{.*}}  : i4
+// SRAM:           %[[MEM:.*]] = seq.hlmem @_handshake_fifo %[[CLOCK]], %[[RESET]] : <10xi32>
+// SRAM:           seq.write %[[MEM]][%[[WRITE_PTR]]] %[[DATA_IN]] wren %[[WRITE]] {{.*}}: !seq.hlmem<10xi32>
+// SRAM:           %[[DATA_OUT]] = seq.read %[[MEM]][%[[READ_PTR]]] rden %[[NOT_EMPTY]] {{.*}}: !seq.hlmem<10xi32>
+// SRAM:           hw.output %[[CHANNEL]] : !esi.channel<i32>
+handshake.func @test_sram(%arg0: i32, %arg1: none, ...) -> (i32, none) {
+  %0 = buffer [10] seq %arg0 : i32
+  return %0, %arg1 : i32, none
+}
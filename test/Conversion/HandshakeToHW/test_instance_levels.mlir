@@ -0,0 +1,29 @@
+// RUN: circt-opt -lower-handshake-to-hw %s | FileCheck %s
+// RUN: circt-opt -lower-handshake-to-hw --mlir-disable-threading %s | FileCheck %s
+
+// The independent functions @left and @right are lowered together, and the
+// fork they both use is only emitted once.
+
+// CHECK:     hw.module @handshake_fork_1ins_2outs_ctrl(
+// CHECK-NOT: hw.module @handshake_fork_1ins_2outs_ctrl(
+// CHECK:     hw.module @left(
+// CHECK:     hw.module @right(
+// CHECK:     hw.module @top(
+// CHECK:       hw.instance "left0" @left(
+// CHECK:       hw.instance "right0" @right(
+
+handshake.func @left(%ctrl : none) -> (none, none) {
+  %0:2 = fork [2] %ctrl : none
+  return %0#0, %0#1 : none, none
+}
+
+handshake.func @right(%ctrl : none) -> (none, none) {
+  %0:2 = fork [2] %ctrl : none
+  return %0#0, %0#1 : none, none
+}
+
+handshake.func @top(%a : none, %b : none) -> (none, none, none, none) {
+  %0:2 = instance @left(%a) : (none) -> (none, none)
+  %1:2 = instance @right(%b) : (none) -> (none, none)
+  return %0#0, %0#1, %1#0, %1#1 : none, none, none, none
+}
@@ -0,0 +1,59 @@
+// RUN: circt-opt %s --lower-scf-to-calyx=max-parallel-groups=2 -canonicalize -split-input-file | FileCheck %s
+
+// The stores to @mem_0 conflict, while the others are independent. At most
+// two of them run at once.
+
+// CHECK-LABEL: calyx.component @main
+// CHECK:         calyx.control
+// CHECK-NEXT:      calyx.seq
+// CHECK-NEXT:        calyx.par
+// CHECK-NEXT:          calyx.enable @bb0_0
+// CHECK-NEXT:          calyx.enable @bb0_1
+// CHECK-NEXT:        }
+// CHECK-NEXT:        calyx.par
+// CHECK-NEXT:          calyx.enable @bb0_2
+// CHECK-NEXT:          calyx.enable @bb0_3
+// CHECK-NEXT:        }
+// CHECK-NEXT:      }
+// CHECK-NEXT:    }
+module {
+  func.func @main(%a0 : i32, %a1 : i32) {
+    %0 = memref.alloc() : memref<4xi32>
+    %1 = memref.alloc() : memref<4xi32>
+    %2 = memref.alloc() : memref<4xi32>
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    memref.store %a0, %0[%c0] : memref<4xi32>
+    memref.store %a1, %1[%c0] : memref<4xi32>
+    memref.store %a0, %2[%c0] : memref<4xi32>
+    memref.store %a1, %0[%c1] : memref<4xi32>
+    return
+  }
+}
+
+// -----
+
+// A load into a register must complete before the register is read.
+
+// CHECK-LABEL: calyx.component @main
+// CHECK:         calyx.control
+// CHECK-NEXT:      calyx.seq
+// CHECK-NEXT:        calyx.enable @bb0_0
+// CHECK-NEXT:        calyx.enable @bb0_1
+// CHECK-NEXT:        calyx.enable @bb0_3
+// CHECK-NEXT:        calyx.enable @ret_assign_0
+// CHECK-NEXT:      }
+// CHECK-NEXT:    }
+module {
+  func.func @main(%a0 : i32) -> i32 {
+    %0 = memref.alloc() : memref<4xi32>
+    %1 = memref.alloc() : memref<4xi32>
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %2 = memref.load %0[%c0] : memref<4xi32>
+    %3 = memref.load %0[%c1] : memref<4xi32>
+    %4 = arith.addi %2, %3 : i32
+    memref.store %4, %1[%c0] : memref<4xi32>
+    return %4 : i32
+  }
+}
@@ -19,7 +19,7 @@
 // CHECK-NEXT:         calyx.assign %std_lsh_0.right = %in0 : i32
 // CHECK-NEXT:         calyx.assign %std_sub_0.right = %std_add_0.out : i32
 // CHECK-NEXT:         calyx.group_done %ret_arg0_reg.done : i1
-// CHECK-NEXT:       }
+// CHECK-NEXT:       } {static = 1 : i64}
 // CHECK-NEXT:     }
 // CHECK-NEXT:     calyx.control  {
 // CHECK-NEXT:       calyx.seq  {
@@ -0,0 +1,87 @@
+// RUN: circt-opt -pass-pipeline='calyx.component(calyx-cell-sharing)' %s | FileCheck %s
+
+module attributes {calyx.entrypoint = "main"} {
+  // The groups using @add0 and @add1 run one after another.
+  // CHECK-LABEL: calyx.component @main
+  // CHECK:         calyx.std_add @add0
+  // CHECK-NOT:     calyx.std_add @add1
+  // CHECK-LABEL:   calyx.group @second
+  // CHECK-NEXT:      calyx.assign %add0.left = %b.out : i32
+  // CHECK-NEXT:      calyx.assign %add0.right = %b.out : i32
+  // CHECK-NEXT:      calyx.assign %a.in = %add0.out : i32
+  calyx.component @main(%in: i32, %go: i1 {go}, %clk: i1 {clk}, %reset: i1 {reset}) -> (%done: i1 {done}) {
+    %true = hw.constant true
+    %a.in, %a.write_en, %a.clk, %a.reset, %a.out, %a.done = calyx.register @a : i32, i1, i1, i1, i32, i1
+    %b.in, %b.write_en, %b.clk, %b.reset, %b.out, %b.done = calyx.register @b : i32, i1, i1, i1, i32, i1
+    %add0.left, %add0.right, %add0.out = calyx.std_add @add0 : i32, i32, i32
+    %add1.left, %add1.right, %add1.out = calyx.std_add @add1 : i32, i32, i32
+    calyx.wires {
+      calyx.group @first {
+        calyx.assign %add0.left = %in : i32
+        calyx.assign %add0.right = %in : i32
+        calyx.assign %b.in = %add0.out : i32
+        calyx.assign %b.write_en = %true : i1
+        calyx.group_done %b.done : i1
+      }
+      calyx.group @second {
+        calyx.assign %add1.left = %b.out : i32
+        calyx.assign %add1.right = %b.out : i32
+        calyx.assign %a.in = %add1.out : i32
+        calyx.assign %a.write_en = %true : i1
+        calyx.group_done %a.done : i1
+      }
+    }
+    calyx.control {
+      calyx.seq {
+        calyx.enable @first
+        calyx.enable @second
+      }
+    }
+  }
+
+  // The groups using @add0 and @add1 run in parallel, and @add2 drives a
+  // condition.
+  // CHECK-LABEL: calyx.component @par
+  // CHECK-DAG:     calyx.std_add @add0
+  // CHECK-DAG:     calyx.std_add @add1
+  // CHECK-DAG:     calyx.std_add @add2
+  calyx.component @par(%in: i32, %go: i1 {go}, %clk: i1 {clk}, %reset: i1 {reset}) -> (%done: i1 {done}) {
+    %true = hw.constant true
+    %a.in, %a.write_en, %a.clk, %a.reset, %a.out, %a.done = calyx.register @a : i32, i1, i1, i1, i32, i1
+    %b.in, %b.write_en, %b.clk, %b.reset, %b.out, %b.done = calyx.register @b : i32, i1, i1, i1, i32, i1
+    %add0.left, %add0.right, %add0.out = calyx.std_add @add0 : i32, i32, i32
+    %add1.left, %add1.right, %add1.out = calyx.std_add @add1 : i32, i32, i32
+    %add2.left, %add2.right, %add2.out = calyx.std_add @add2 : i32, i32, i32
+    %eq.left, %eq.right, %eq.out = calyx.std_eq @eq : i32, i32, i1
+    calyx.wires {
+      calyx.group @first {
+        calyx.assign %add0.left = %in : i32
+        calyx.assign %add0.right = %in : i32
+        calyx.assign %a.in = %add0.out : i32
+        calyx.assign %a.write_en = %true : i1
+        calyx.group_done %a.done : i1
+      }
+      calyx.group @second {
+        calyx.assign %add1.left = %in : i32
+        calyx.assign %add1.right = %in : i32
+        calyx.assign %b.in = %add1.out : i32
+        calyx.assign %b.write_en = %true : i1
+        calyx.group_done %b.done : i1
+      }
+      calyx.comb_group @cond {
+        calyx.assign %add2.left = %in : i32
+        calyx.assign %add2.right = %in : i32
+        calyx.assign %eq.left = %add2.out : i32
+        calyx.assign %eq.right = %in : i32
+      }
+    }
+    calyx.control {
+      calyx.if %eq.out with @cond {
+        calyx.par {
+          calyx.enable @first
+          calyx.enable @second
+        }
+      }
+    }
+  }
+}
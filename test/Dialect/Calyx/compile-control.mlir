@@ -64,4 +64,50 @@ module attributes {calyx.entrypoint = "main"} {
       }
     }
   }
+
+  // Static groups are active for as many steps as they take, and the fsm
+  // moves on without waiting for their done signal.
+  // CHECK-LABEL: calyx.component @static
+  calyx.component @static(%go : i1 {go}, %reset : i1 {reset}, %clk : i1 {clk}) -> (%done : i1 {done}) {
+    %r.in, %r.write_en, %r.clk, %r.reset, %r.out, %r.done = calyx.register @r : i8, i1, i1, i1, i8, i1
+    %true = hw.constant true
+    %c1_i8 = hw.constant 1 : i8
+    calyx.wires {
+      %undef = calyx.undef : i1
+      // CHECK:     %[[A_ACTIVE:.+]] = comb.icmp eq %fsm_reg.out, {{.+}} : i2
+      // CHECK-NOT: comb.xor
+      // CHECK:     %A.go = calyx.group_go %[[A_ACTIVE]] ? {{.+}} : i1
+      calyx.group @A {
+        %A.go = calyx.group_go %undef : i1
+        calyx.assign %r.in = %A.go ? %c1_i8 : i8
+        calyx.assign %r.write_en = %A.go ? %true : i1
+        calyx.group_done %r.done : i1
+      } {static = 1 : i64}
+
+      // CHECK:     %[[B_BEGUN:.+]] = comb.icmp uge %fsm_reg.out, {{.+}} : i2
+      // CHECK:     %[[B_NOT_ENDED:.+]] = comb.icmp ult %fsm_reg.out, {{.+}} : i2
+      // CHECK:     %[[B_ACTIVE:.+]] = comb.and %[[B_BEGUN]], %[[B_NOT_ENDED]] : i1
+      // CHECK:     %B.go = calyx.group_go %[[B_ACTIVE]] ? {{.+}} : i1
+      calyx.group @B {
+        %B.go = calyx.group_go %undef : i1
+        calyx.assign %r.in = %B.go ? %r.out : i8
+        calyx.assign %r.write_en = %B.go ? %true : i1
+        calyx.group_done %r.done : i1
+      } {static = 2 : i64}
+
+      // CHECK:     %[[B_STEP:.+]] = comb.add %fsm_reg.out, {{.+}} : i2
+      // CHECK-LABEL: calyx.group @seq {
+      // CHECK-NEXT:    calyx.assign %fsm_reg.in = %[[A_ACTIVE]] ? {{.+}} : i2
+      // CHECK-NEXT:    calyx.assign %fsm_reg.write_en = %[[A_ACTIVE]] ? {{.+}} : i1
+      // CHECK-NEXT:    calyx.assign %fsm_reg.in = %[[B_ACTIVE]] ? %[[B_STEP]] : i2
+      // CHECK-NEXT:    calyx.assign %fsm_reg.write_en = %[[B_ACTIVE]] ? {{.+}} : i1
+    }
+
+    calyx.control {
+      calyx.seq {
+        calyx.enable @A
+        calyx.enable @B
+      }
+    }
+  }
 }
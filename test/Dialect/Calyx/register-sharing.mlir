@@ -0,0 +1,159 @@
+// RUN: circt-opt -pass-pipeline='calyx.component(calyx-register-sharing)' %s | FileCheck %s
+
+module attributes {calyx.entrypoint = "main"} {
+  // The live ranges of @a and @d are disjoint, while @c is read by a
+  // continuous assignment.
+  // CHECK-LABEL: calyx.component @main
+  // CHECK-DAG:     calyx.register @a
+  // CHECK-DAG:     calyx.register @b
+  // CHECK-DAG:     calyx.register @c
+  // CHECK-NOT:     calyx.register @d
+  // CHECK-LABEL:   calyx.group @bToD
+  // CHECK-NEXT:      calyx.assign %a.in = %b.out : i32
+  // CHECK-NEXT:      calyx.assign %a.write_en = %true : i1
+  // CHECK-NEXT:      calyx.group_done %a.done : i1
+  // CHECK-LABEL:   calyx.group @dToC
+  // CHECK-NEXT:      calyx.assign %c.in = %a.out : i32
+  calyx.component @main(%in: i32, %go: i1 {go}, %clk: i1 {clk}, %reset: i1 {reset}) -> (%out: i32, %done: i1 {done}) {
+    %true = hw.constant true
+    %a.in, %a.write_en, %a.clk, %a.reset, %a.out, %a.done = calyx.register @a : i32, i1, i1, i1, i32, i1
+    %b.in, %b.write_en, %b.clk, %b.reset, %b.out, %b.done = calyx.register @b : i32, i1, i1, i1, i32, i1
+    %c.in, %c.write_en, %c.clk, %c.reset, %c.out, %c.done = calyx.register @c : i32, i1, i1, i1, i32, i1
+    %d.in, %d.write_en, %d.clk, %d.reset, %d.out, %d.done = calyx.register @d : i32, i1, i1, i1, i32, i1
+    calyx.wires {
+      calyx.assign %out = %c.out : i32
+      calyx.group @inToA {
+        calyx.assign %a.in = %in : i32
+        calyx.assign %a.write_en = %true : i1
+        calyx.group_done %a.done : i1
+      }
+      calyx.group @aToB {
+        calyx.assign %b.in = %a.out : i32
+        calyx.assign %b.write_en = %true : i1
+        calyx.group_done %b.done : i1
+      }
+      calyx.group @bToD {
+        calyx.assign %d.in = %b.out : i32
+        calyx.assign %d.write_en = %true : i1
+        calyx.group_done %d.done : i1
+      }
+      calyx.group @dToC {
+        calyx.assign %c.in = %d.out : i32
+        calyx.assign %c.write_en = %true : i1
+        calyx.group_done %c.done : i1
+      }
+    }
+    calyx.control {
+      calyx.seq {
+        calyx.enable @inToA
+        calyx.enable @aToB
+        calyx.enable @bToD
+        calyx.enable @dToC
+      }
+    }
+  }
+
+  // Registers written in different arms of a par are live at the same time.
+  // CHECK-LABEL: calyx.component @par
+  // CHECK-DAG:     calyx.register @a
+  // CHECK-DAG:     calyx.register @b
+  calyx.component @par(%in: i32, %go: i1 {go}, %clk: i1 {clk}, %reset: i1 {reset}) -> (%done: i1 {done}) {
+    %true = hw.constant true
+    %a.in, %a.write_en, %a.clk, %a.reset, %a.out, %a.done = calyx.register @a : i32, i1, i1, i1, i32, i1
+    %b.in, %b.write_en, %b.clk, %b.reset, %b.out, %b.done = calyx.register @b : i32, i1, i1, i1, i32, i1
+    calyx.wires {
+      calyx.group @writeA {
+        calyx.assign %a.in = %in : i32
+        calyx.assign %a.write_en = %true : i1
+        calyx.group_done %a.done : i1
+      }
+      calyx.group @readA {
+        calyx.assign %a.in = %a.out : i32
+        calyx.assign %a.write_en = %true : i1
+        calyx.group_done %a.done : i1
+      }
+      calyx.group @writeB {
+        calyx.assign %b.in = %in : i32
+        calyx.assign %b.write_en = %true : i1
+        calyx.group_done %b.done : i1
+      }
+      calyx.group @readB {
+        calyx.assign %b.in = %b.out : i32
+        calyx.assign %b.write_en = %true : i1
+        calyx.group_done %b.done : i1
+      }
+    }
+    calyx.control {
+      calyx.par {
+        calyx.seq {
+          calyx.enable @writeA
+          calyx.enable @readA
+        }
+        calyx.seq {
+          calyx.enable @writeB
+          calyx.enable @readB
+        }
+      }
+    }
+  }
+
+  // The loop-carried @i is live throughout the loop, whereas @t1 and @t2 are
+  // only live within an iteration.
+  // CHECK-LABEL: calyx.component @loop
+  // CHECK-DAG:     calyx.register @i
+  // CHECK-DAG:     calyx.register @t1
+  // CHECK-NOT:     calyx.register @t2
+  // CHECK-LABEL:   calyx.group @writeT2
+  // CHECK-NEXT:      calyx.assign %t1.in = %i.out : i32
+  calyx.component @loop(%in: i32, %go: i1 {go}, %clk: i1 {clk}, %reset: i1 {reset}) -> (%done: i1 {done}) {
+    %true = hw.constant true
+    %i.in, %i.write_en, %i.clk, %i.reset, %i.out, %i.done = calyx.register @i : i32, i1, i1, i1, i32, i1
+    %t1.in, %t1.write_en, %t1.clk, %t1.reset, %t1.out, %t1.done = calyx.register @t1 : i32, i1, i1, i1, i32, i1
+    %t2.in, %t2.write_en, %t2.clk, %t2.reset, %t2.out, %t2.done = calyx.register @t2 : i32, i1, i1, i1, i32, i1
+    %lt.left, %lt.right, %lt.out = calyx.std_lt @lt : i32, i32, i1
+    calyx.wires {
+      calyx.group @init {
+        calyx.assign %i.in = %in : i32
+        calyx.assign %i.write_en = %true : i1
+        calyx.group_done %i.done : i1
+      }
+      calyx.comb_group @cond {
+        calyx.assign %lt.left = %i.out : i32
+        calyx.assign %lt.right = %in : i32
+      }
+      calyx.group @writeT1 {
+        calyx.assign %t1.in = %i.out : i32
+        calyx.assign %t1.write_en = %true : i1
+        calyx.group_done %t1.done : i1
+      }
+      calyx.group @readT1 {
+        calyx.assign %i.in = %t1.out : i32
+        calyx.assign %i.write_en = %true : i1
+        calyx.group_done %i.done : i1
+      }
+      calyx.group @writeT2 {
+        calyx.assign %t2.in = %i.out : i32
+        calyx.assign %t2.write_en = %true : i1
+        calyx.group_done %t2.done : i1
+      }
+      calyx.group @readT2 {
+        calyx.assign %i.in = %t2.out : i32
+        calyx.assign %i.write_en = %true : i1
+        calyx.group_done %i.done : i1
+      }
+    }
+    calyx.control {
+      calyx.seq {
+        calyx.enable @init
+        calyx.while %lt.out with @cond {
+          calyx.seq {
+            calyx.enable @writeT1
+            calyx.enable @readT1
+            calyx.enable @writeT2
+            calyx.enable @readT2
+          }
+        }
+      }
+    }
+  }
+}
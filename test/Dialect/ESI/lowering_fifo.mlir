@@ -0,0 +1,24 @@
+// RUN: circt-opt %s --lower-esi-to-physical=fifo-depth-threshold=4 -verify-diagnostics | circt-opt -verify-diagnostics | FileCheck %s
+// RUN: circt-opt %s --lower-esi-to-physical=fifo-depth-threshold=4 --lower-esi-ports --lower-esi-to-hw -verify-diagnostics | circt-opt -verify-diagnostics | FileCheck --check-prefix=HW %s
+
+// CHECK-LABEL: hw.module @buffers
+hw.module @buffers(%clk: i1, %rst: i1, %a: !esi.channel<i4>) -> (x: !esi.channel<i4>) {
+  // Buffers shallower than the threshold still become pipeline stages.
+  // CHECK-NEXT: %0 = esi.stage %clk, %rst, %a {name = "shallow_stage0"} : i4
+  // CHECK-NEXT: %1 = esi.stage %clk, %rst, %0 {name = "shallow_stage1"} : i4
+  %0 = esi.buffer %clk, %rst, %a {stages = 2, name = "shallow"} : i4
+
+  // CHECK-NEXT: %2 = esi.fifo %clk, %rst, %1 {depth = 16 : i64, name = "deep"} : i4
+  %1 = esi.buffer %clk, %rst, %0 {stages = 16, name = "deep"} : i4
+
+  // CHECK-NEXT: hw.output %2 : !esi.channel<i4>
+  hw.output %1 : !esi.channel<i4>
+}
+
+// HW-DAG: hw.module.extern @ESI_PipelineStage(
+// HW-DAG: hw.module.extern @ESI_FIFO(%clk: i1, %rst: i1, %a: i4, %a_valid: i1, %x_ready: i1) -> (a_ready: i1, x: i4, x_valid: i1)
+// HW-LABEL: hw.module @buffers
+// HW:         %shallow_stage0.a_ready, %shallow_stage0.x, %shallow_stage0.x_valid = hw.instance "shallow_stage0" @ESI_PipelineStage<WIDTH: ui32 = 4>
+// HW:         %shallow_stage1.a_ready, %shallow_stage1.x, %shallow_stage1.x_valid = hw.instance "shallow_stage1" @ESI_PipelineStage<WIDTH: ui32 = 4>
+// HW:         %deep.a_ready, %deep.x, %deep.x_valid = hw.instance "deep" @ESI_FIFO<WIDTH: ui32 = 4, DEPTH: ui32 = 16>(clk: %clk: i1, rst: %rst: i1, a: %shallow_stage1.x: i4, a_valid: %shallow_stage1.x_valid: i1, x_ready: %x_ready: i1) -> (a_ready: i1, x: i4, x_valid: i1)
+// HW:         hw.output %deep.x, %deep.x_valid, %shallow_stage0.a_ready : i4, i1, i1
@@ -2,6 +2,7 @@
 // RUN: cd %t
 // RUN: circt-opt --pass-pipeline='firrtl.circuit(firrtl-blackbox-reader)' Foo.mlir | FileCheck Foo.mlir
 // RUN: circt-opt --pass-pipeline='firrtl.circuit(firrtl-blackbox-reader)' NoDUT.mlir | FileCheck NoDUT.mlir
+// RUN: circt-opt --pass-pipeline='firrtl.circuit(firrtl-blackbox-reader{reference-files=true})' Ref.mlir | FileCheck Ref.mlir
 
 //--- Baz.sv
 /* Baz */
@@ -79,3 +80,17 @@ firrtl.circuit "NoDUT" attributes {annotations = [
   // CHECK-SAME:   #hw.output_file<".{{/|\\\\}}NoDUTBlackBox.sv">
   // CHECK:      sv.verbatim "NoDUTBlackBox.sv"
 }
+//--- Ref.mlir
+// Check that path annotations can refer to their files instead of loading
+// them.
+//
+// CHECK: firrtl.circuit "Ref"
+firrtl.circuit "Ref" {
+  firrtl.extmodule @Baz() attributes {annotations = [{class = "firrtl.transforms.BlackBoxPathAnno", path = "Baz.sv"}]}
+  firrtl.module @Ref() {
+    firrtl.instance baz @Baz()
+  }
+  // CHECK:      sv.verbatim ""
+  // CHECK-SAME:   output_file = #hw.output_file<".{{/|\\\\}}Baz.sv">
+  // CHECK-SAME:   sv.verbatim.source_file = "{{.*}}Baz.sv"
+}
@@ -0,0 +1,43 @@
+// RUN: rm -f %t.json
+// RUN: circt-opt --pass-pipeline='firrtl.circuit(firrtl-dedup{cache-file=%t.json cache-key=k1})' %s | FileCheck %s
+// RUN: FileCheck %s --check-prefix=CACHE < %t.json
+
+// A cache written for the same key is replayed, even if it kept identical
+// modules apart.
+// RUN: echo '{"key": "k2", "modules": {"Foo": "Foo", "Bar": "Bar", "Top": "Top"}}' > %t.json
+// RUN: circt-opt --pass-pipeline='firrtl.circuit(firrtl-dedup{cache-file=%t.json cache-key=k2})' %s | FileCheck %s --check-prefix=REPLAY
+
+// A cache written for a different key is ignored and overwritten.
+// RUN: circt-opt --pass-pipeline='firrtl.circuit(firrtl-dedup{cache-file=%t.json cache-key=k1})' %s | FileCheck %s
+// RUN: FileCheck %s --check-prefix=CACHE < %t.json
+
+// A cache which does not describe the circuit is ignored.
+// RUN: echo '{"key": "k3", "modules": {"Foo": "Foo", "Top": "Top"}}' > %t.json
+// RUN: circt-opt --pass-pipeline='firrtl.circuit(firrtl-dedup{cache-file=%t.json cache-key=k3})' %s | FileCheck %s
+
+// CHECK-LABEL: firrtl.circuit "Top"
+// CHECK:         firrtl.module @Foo
+// CHECK-NOT:     firrtl.module @Bar
+// CHECK:         firrtl.module @Top
+// CHECK-NEXT:      firrtl.instance foo @Foo
+// CHECK-NEXT:      firrtl.instance bar @Foo
+
+// CACHE:     "key": "k1"
+// CACHE-DAG: "Foo": "Foo"
+// CACHE-DAG: "Bar": "Foo"
+// CACHE-DAG: "Top": "Top"
+
+// REPLAY-LABEL: firrtl.circuit "Top"
+// REPLAY:         firrtl.module @Foo
+// REPLAY:         firrtl.module @Bar
+// REPLAY:         firrtl.module @Top
+// REPLAY-NEXT:      firrtl.instance foo @Foo
+// REPLAY-NEXT:      firrtl.instance bar @Bar
+firrtl.circuit "Top" {
+  firrtl.module @Foo() { }
+  firrtl.module @Bar() { }
+  firrtl.module @Top() {
+    firrtl.instance foo @Foo()
+    firrtl.instance bar @Bar()
+  }
+}
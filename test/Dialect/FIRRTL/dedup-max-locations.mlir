@@ -0,0 +1,23 @@
+// RUN: circt-opt -mlir-print-debuginfo -mlir-print-local-scope -pass-pipeline='firrtl.circuit(firrtl-dedup{max-merged-locs=2})' %s | FileCheck %s
+
+firrtl.circuit "Test" {
+// CHECK-LABEL: @Dedup0()
+firrtl.module @Dedup0() {
+  // CHECK: %w = firrtl.wire  : !firrtl.uint<1> loc(fused["foo", "bar"])
+  %w = firrtl.wire : !firrtl.uint<1> loc("foo")
+} loc("dedup0")
+// CHECK: loc(fused["dedup0", "dedup1"])
+// CHECK-NOT: @Dedup1()
+firrtl.module @Dedup1() {
+  %w = firrtl.wire : !firrtl.uint<1> loc("bar")
+} loc("dedup1")
+// CHECK-NOT: @Dedup2()
+firrtl.module @Dedup2() {
+  %w = firrtl.wire : !firrtl.uint<1> loc("baz")
+} loc("dedup2")
+firrtl.module @Test() {
+  firrtl.instance dedup0 @Dedup0()
+  firrtl.instance dedup1 @Dedup1()
+  firrtl.instance dedup2 @Dedup2()
+}
+}
@@ -1,4 +1,5 @@
 // RUN: circt-opt --pass-pipeline='firrtl.circuit(firrtl-dedup)' %s -mlir-print-debuginfo | FileCheck %s
+// RUN: circt-opt --pass-pipeline='firrtl.circuit(firrtl-dedup{fast-hash=true})' %s -mlir-print-debuginfo | FileCheck %s
 
 // CHECK-LABEL: firrtl.circuit "Empty"
 firrtl.circuit "Empty" {
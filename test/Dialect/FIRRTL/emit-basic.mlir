@@ -1,6 +1,7 @@
 // RUN: circt-translate --export-firrtl --verify-diagnostics %s -o %t
 // RUN: cat %t | FileCheck %s --strict-whitespace
 // RUN: circt-translate --import-firrtl %t --mlir-print-debuginfo | circt-translate --export-firrtl | diff - %t
+// RUN: circt-translate --export-firrtl --mlir-disable-threading %s | diff - %t
 
 // CHECK-LABEL: circuit Foo :
 firrtl.circuit "Foo" {
@@ -0,0 +1,47 @@
+// RUN: circt-opt --pass-pipeline='firrtl.circuit(firrtl-extract-partition{root=Sub black-boxes=Leaf})' %s | FileCheck %s
+// RUN: circt-opt --pass-pipeline='firrtl.circuit(firrtl-extract-partition{black-boxes=Sub})' %s | FileCheck %s --check-prefix=TOP
+
+// CHECK-LABEL: firrtl.circuit "Sub"
+// TOP-LABEL: firrtl.circuit "Top"
+firrtl.circuit "Top" {
+  // CHECK-NOT: @nla_top
+  // CHECK: hw.hierpath private @nla_sub [@Sub::@other, @Other::@w]
+  // CHECK-NOT: @nla_leaf
+  // TOP-NOT: hw.hierpath
+  hw.hierpath private @nla_top [@Top::@sub, @Sub::@other, @Other::@w]
+  hw.hierpath private @nla_sub [@Sub::@other, @Other::@w]
+  hw.hierpath private @nla_leaf [@Sub::@leaf, @Leaf::@w]
+
+  // CHECK: firrtl.extmodule private @Leaf(in a: !firrtl.uint<1>, out b: !firrtl.uint<1>) attributes {defname = "Leaf"}
+  // TOP-NOT: @Leaf
+  firrtl.module private @Leaf(in %a: !firrtl.uint<1> [{class = "foo"}],
+                              out %b: !firrtl.uint<1>) {
+    %w = firrtl.wire sym @w {annotations = [{circt.nonlocal = @nla_leaf, class = "bar"}]} : !firrtl.uint<1>
+    firrtl.strictconnect %w, %a : !firrtl.uint<1>
+    firrtl.strictconnect %b, %w : !firrtl.uint<1>
+  }
+
+  // CHECK: firrtl.module private @Other
+  // CHECK-NEXT: firrtl.wire sym @w {annotations = [{circt.nonlocal = @nla_sub, class = "baz"}]}
+  // TOP-NOT: @Other
+  firrtl.module private @Other() {
+    %w = firrtl.wire sym @w {annotations = [{circt.nonlocal = @nla_top, class = "qux"}, {circt.nonlocal = @nla_sub, class = "baz"}]} : !firrtl.uint<1>
+  }
+
+  // CHECK: firrtl.module @Sub(
+  // TOP: firrtl.extmodule private @Sub(in a: !firrtl.uint<1>, out b: !firrtl.uint<1>) attributes {defname = "Sub"}
+  firrtl.module private @Sub(in %a: !firrtl.uint<1>, out %b: !firrtl.uint<1>) {
+    firrtl.instance other sym @other @Other()
+    %leaf_a, %leaf_b = firrtl.instance leaf sym @leaf @Leaf(in a: !firrtl.uint<1>, out b: !firrtl.uint<1>)
+    firrtl.strictconnect %leaf_a, %a : !firrtl.uint<1>
+    firrtl.strictconnect %b, %leaf_b : !firrtl.uint<1>
+  }
+
+  // CHECK-NOT: @Top
+  // TOP: firrtl.module @Top
+  firrtl.module @Top(in %a: !firrtl.uint<1>, out %b: !firrtl.uint<1>) {
+    %sub_a, %sub_b = firrtl.instance sub sym @sub @Sub(in a: !firrtl.uint<1>, out b: !firrtl.uint<1>)
+    firrtl.strictconnect %sub_a, %a : !firrtl.uint<1>
+    firrtl.strictconnect %b, %sub_b : !firrtl.uint<1>
+  }
+}
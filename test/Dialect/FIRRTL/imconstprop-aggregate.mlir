@@ -1,7 +1,7 @@
 // RUN: circt-opt -pass-pipeline='firrtl.circuit(firrtl-imconstprop)' --split-input-file  %s | FileCheck %s
 
 // This contains a lot of tests which should be caught by IMCP.
-// For now, we are checking that the aggregates don't cause the pass to error out.
+// Constants are propagated through the ground fields of aggregates.
 
 firrtl.circuit "VectorPropagation1" {
   // CHECK-LABEL: @VectorPropagation1
@@ -14,6 +14,8 @@ firrtl.circuit "VectorPropagation1" {
     firrtl.strictconnect %1, %c1_ui1 : !firrtl.uint<1>
     %2 = firrtl.xor %0, %1 : (!firrtl.uint<1>, !firrtl.uint<1>) -> !firrtl.uint<1>
     firrtl.strictconnect %b, %2 : !firrtl.uint<1>
+    // CHECK-NOT: firrtl.reg
+    // CHECK: firrtl.strictconnect %b, %c0_ui1{{.*}} : !firrtl.uint<1>
   }
 }
 
@@ -62,6 +64,10 @@ firrtl.circuit "VectorPropagation2" {
     firrtl.strictconnect %b2, %10 : !firrtl.uint<6>
     %11 = firrtl.xor %7, %5 : (!firrtl.uint<6>, !firrtl.uint<6>) -> !firrtl.uint<6>
     firrtl.strictconnect %b3, %11 : !firrtl.uint<6>
+    // CHECK-NOT: firrtl.reg
+    // CHECK: firrtl.strictconnect %b1, %c5_ui6
+    // CHECK-NEXT: firrtl.strictconnect %b2, %c34_ui6
+    // CHECK-NEXT: firrtl.strictconnect %b3, %c24_ui6
   }
 }
 
@@ -83,6 +89,8 @@ firrtl.circuit "BundlePropagation1"   {
     %3 = firrtl.xor %0, %1 : (!firrtl.uint<3>, !firrtl.uint<3>) -> !firrtl.uint<3>
     %4 = firrtl.xor %3, %2 : (!firrtl.uint<3>, !firrtl.uint<3>) -> !firrtl.uint<3>
     firrtl.strictconnect %result, %4 : !firrtl.uint<3>
+    // CHECK-NOT: firrtl.reg
+    // CHECK: firrtl.strictconnect %result, %c7_ui3
   }
 }
 
@@ -122,6 +130,9 @@ firrtl.circuit "AggregateAsyncReset" {
     firrtl.strictconnect %3, %c2_ui3 : !firrtl.uint<3>
     firrtl.strictconnect %res1, %2 : !firrtl.uint<3>
     firrtl.strictconnect %res2, %3 : !firrtl.uint<3>
+    // The reset value and the connect disagree on the first element only.
+    // CHECK: firrtl.strictconnect %res1, %2 : !firrtl.uint<3>
+    // CHECK-NEXT: firrtl.strictconnect %res2, %c2_ui3{{.*}} : !firrtl.uint<3>
   }
 }
 
@@ -138,12 +149,14 @@ firrtl.circuit "AggregateRegReset" {
     %1 = firrtl.subindex %reg[0] : !firrtl.vector<uint<1>, 1>
     firrtl.strictconnect %1, %true : !firrtl.uint<1>
     firrtl.strictconnect %out, %1 : !firrtl.uint<1>
+    // CHECK: firrtl.strictconnect %out, %c1_ui1{{.*}} : !firrtl.uint<1>
   }
 }
 
 // -----
 
 firrtl.circuit "DontTouchAggregate" {
+  // CHECK-LABEL: @DontTouchAggregate
   firrtl.module @DontTouchAggregate(in %clock: !firrtl.clock, out %out1: !firrtl.uint<1>, out %out2: !firrtl.uint<1>) {
     // fieldID 1 means the first element. Check that we don't propagate througth it.
     %init = firrtl.wire sym @dntSym: !firrtl.vector<uint<1>, 2>
@@ -155,6 +168,8 @@ firrtl.circuit "DontTouchAggregate" {
 
     firrtl.strictconnect %out1, %0 : !firrtl.uint<1>
     firrtl.strictconnect %out2, %1 : !firrtl.uint<1>
+    // CHECK: firrtl.strictconnect %out1, %0 : !firrtl.uint<1>
+    // CHECK-NEXT: firrtl.strictconnect %out2, %1 : !firrtl.uint<1>
   }
 }
 
@@ -178,6 +193,8 @@ firrtl.circuit "OutPortTop" {
     %1 = firrtl.subindex %c_out[1] : !firrtl.vector<uint<1>, 2>
     firrtl.strictconnect %out1, %0 : !firrtl.uint<1>
     firrtl.strictconnect %out2, %1 : !firrtl.uint<1>
+    // CHECK: firrtl.strictconnect %out1, %0 : !firrtl.uint<1>
+    // CHECK-NEXT: firrtl.strictconnect %out2, %1 : !firrtl.uint<1>
   }
 }
 
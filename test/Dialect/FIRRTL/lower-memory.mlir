@@ -79,6 +79,24 @@ firrtl.module @Dedup() {
 // CHECK-NEXT: firrtl.instance mem0_ext @mem0_ext
 }
 
+// Test that memories which only differ in their read-under-write behavior are
+// deduplicated, since the memory modules do not record it.
+// CHECK-LABEL: firrtl.circuit "DedupRUW"
+firrtl.circuit "DedupRUW" {
+firrtl.module @DedupRUW() {
+  %mem0_write = firrtl.mem Old {depth = 12 : i64, name = "mem0", portNames = ["write"], readLatency = 1 : i32, writeLatency = 1 : i32} : !firrtl.bundle<addr: uint<4>, en: uint<1>, clk: clock, data: uint<42>, mask: uint<1>>
+  %mem1_write = firrtl.mem New {depth = 12 : i64, name = "mem1", portNames = ["write"], readLatency = 1 : i32, writeLatency = 1 : i32} : !firrtl.bundle<addr: uint<4>, en: uint<1>, clk: clock, data: uint<42>, mask: uint<1>>
+}
+// CHECK: firrtl.module private @mem0
+// CHECK-NEXT: firrtl.instance mem0_ext  @mem0_ext
+
+// CHECK: firrtl.memmodule private @mem0_ext
+// CHECK-NOT: firrtl.memmodule
+
+// CHECK: firrtl.module private @mem1
+// CHECK-NEXT: firrtl.instance mem0_ext @mem0_ext
+}
+
 // Test that memories in the testharness are not deduped with other memories in
 // the test harness.
 // CHECK-LABEL: firrtl.circuit "NoTestharnessDedup0"
@@ -20,4 +20,26 @@ firrtl.circuit "TopLevel" {
   // 1D_VEC: %a_0: !firrtl.uint<1>
   firrtl.module private @Bar(in %a: !firrtl.vector<uint<1>, 1>) {
   }
+
+  // CHECK-LABEL: @DynamicIndex
+  // VEC-LABEL: @DynamicIndex
+  // 1D_VEC-LABEL: @DynamicIndex
+  firrtl.module private @DynamicIndex(in %i: !firrtl.uint<2>,
+                                      in %a: !firrtl.vector<uint<1>, 4>,
+                                      in %b: !firrtl.vector<bundle<x: uint<1>>, 4>,
+                                      out %c: !firrtl.uint<1>,
+                                      out %d: !firrtl.uint<1>) {
+    // CHECK: firrtl.subaccess %a[%i]
+    // VEC: firrtl.subaccess %a[%i]
+    // 1D_VEC: firrtl.subaccess %a[%i]
+    %0 = firrtl.subaccess %a[%i] : !firrtl.vector<uint<1>, 4>, !firrtl.uint<2>
+    firrtl.strictconnect %c, %0 : !firrtl.uint<1>
+    // CHECK: %[[b:.+]] = firrtl.subaccess %b[%i]
+    // CHECK: firrtl.subfield %[[b]](0)
+    // VEC: firrtl.multibit_mux %i, %b_3_x, %b_2_x, %b_1_x, %b_0_x
+    // 1D_VEC: firrtl.multibit_mux %i, %b_3_x, %b_2_x, %b_1_x, %b_0_x
+    %1 = firrtl.subaccess %b[%i] : !firrtl.vector<bundle<x: uint<1>>, 4>, !firrtl.uint<2>
+    %2 = firrtl.subfield %1(0) : (!firrtl.bundle<x: uint<1>>) -> !firrtl.uint<1>
+    firrtl.strictconnect %d, %2 : !firrtl.uint<1>
+  }
 }
@@ -523,3 +523,30 @@ firrtl.circuit "Top" {
     firrtl.strictconnect %a, %0 : !firrtl.uint<1>
   }
 }
+
+// -----
+
+// Test resolves which share a path to the same reference
+// CHECK-LABEL: firrtl.circuit "Top" {
+firrtl.circuit "Top" {
+  firrtl.module @XmrSrcMod(out %_a: !firrtl.ref<uint<1>>) {
+    %zero = firrtl.constant 0 : !firrtl.uint<1>
+    %1 = firrtl.ref.send %zero : !firrtl.uint<1>
+    firrtl.strictconnect %_a, %1 : !firrtl.ref<uint<1>>
+  }
+  firrtl.module @Bar(out %_a: !firrtl.ref<uint<1>>, out %_b: !firrtl.ref<uint<1>>) {
+    %xmr   = firrtl.instance bar sym @barXMR @XmrSrcMod(out _a: !firrtl.ref<uint<1>>)
+    firrtl.strictconnect %_a, %xmr : !firrtl.ref<uint<1>>
+    firrtl.strictconnect %_b, %xmr : !firrtl.ref<uint<1>>
+  }
+  firrtl.module @Top(out %a: !firrtl.uint<1>, out %b: !firrtl.uint<1>, out %c: !firrtl.uint<1>) {
+    %bar_a, %bar_b = firrtl.instance bar sym @bar  @Bar(out _a: !firrtl.ref<uint<1>>, out _b: !firrtl.ref<uint<1>>)
+    %0 = firrtl.ref.resolve %bar_a : !firrtl.ref<uint<1>>
+    %1 = firrtl.ref.resolve %bar_a : !firrtl.ref<uint<1>>
+    %2 = firrtl.ref.resolve %bar_b : !firrtl.ref<uint<1>>
+    // CHECK-COUNT-3{LITERAL}: firrtl.verbatim.expr "{{0}}.{{1}}.{{2}}.{{3}}" : () -> !firrtl.uint<1> {symbols = [@Top, #hw.innerNameRef<@Top::@bar>, #hw.innerNameRef<@Bar::@barXMR>, #hw.innerNameRef<@XmrSrcMod::@xmr_sym>]}
+    firrtl.strictconnect %a, %0 : !firrtl.uint<1>
+    firrtl.strictconnect %b, %1 : !firrtl.uint<1>
+    firrtl.strictconnect %c, %2 : !firrtl.uint<1>
+  }
+}
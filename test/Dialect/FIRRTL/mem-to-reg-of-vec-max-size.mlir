@@ -0,0 +1,28 @@
+// RUN: circt-opt -pass-pipeline='firrtl.circuit(firrtl-mem-to-reg-of-vec{max-size=64})' %s | FileCheck  %s
+
+// Check that memories with more than 64 bits are kept as memories.
+firrtl.circuit "MaxSize" attributes {annotations = [{class = "sifive.enterprise.firrtl.ConvertMemToRegOfVecAnnotation$"}]}{
+  // CHECK-LABEL: firrtl.module public @MaxSize
+  firrtl.module public @MaxSize() attributes {annotations = [
+    {class = "sifive.enterprise.firrtl.MarkDUTAnnotation"}
+  ]} {
+    // CHECK-NOT: firrtl.mem {{.*}}name = "small"
+    // CHECK: %small = firrtl.reg {{.+}} : !firrtl.vector<uint<8>, 8>
+    %small_read = firrtl.mem Undefined {
+      depth = 8 : i64,
+      name = "small",
+      portNames = ["read"],
+      readLatency = 0 : i32,
+      writeLatency = 1 : i32
+    } : !firrtl.bundle<addr: uint<3>, en: uint<1>, clk: clock, data flip: uint<8>>
+    // CHECK-NOT: firrtl.reg {{.+}} : !firrtl.vector<uint<8>, 9>
+    // CHECK: firrtl.mem Undefined {{.*}}name = "large"
+    %large_read = firrtl.mem Undefined {
+      depth = 9 : i64,
+      name = "large",
+      portNames = ["read"],
+      readLatency = 0 : i32,
+      writeLatency = 1 : i32
+    } : !firrtl.bundle<addr: uint<4>, en: uint<1>, clk: clock, data flip: uint<8>>
+  }
+}
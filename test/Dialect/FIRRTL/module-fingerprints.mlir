@@ -0,0 +1,19 @@
+// RUN: circt-opt --pass-pipeline='firrtl.circuit(firrtl-module-fingerprints{file=fingerprints.json})' %s | FileCheck %s
+
+// Every module gets an entry, including ones which only differ by name.
+// CHECK-LABEL: firrtl.circuit "Top"
+// CHECK:       sv.verbatim "[\0A  {\0A    \22module\22: \22Foo\22,\0A    \22hash\22: \22{{[0-9a-f]+}}\22\0A  },\0A  {\0A    \22module\22: \22Bar\22,\0A    \22hash\22: \22{{[0-9a-f]+}}\22\0A  },\0A  {\0A    \22module\22: \22Top\22,\0A    \22hash\22: \22{{[0-9a-f]+}}\22\0A  }\0A]"
+// CHECK-SAME:  {output_file = #hw.output_file<"fingerprints.json", excludeFromFileList>}
+firrtl.circuit "Top" {
+  firrtl.module @Foo(in %a: !firrtl.uint<1>, out %b: !firrtl.uint<1>) {
+    firrtl.strictconnect %b, %a : !firrtl.uint<1>
+  }
+  firrtl.module @Bar(in %a: !firrtl.uint<1>, out %b: !firrtl.uint<1>) {
+    firrtl.strictconnect %b, %a : !firrtl.uint<1>
+  }
+  firrtl.module @Top(in %a: !firrtl.uint<1>, out %b: !firrtl.uint<1>) {
+    %foo_a, %foo_b = firrtl.instance foo @Foo(in a: !firrtl.uint<1>, out b: !firrtl.uint<1>)
+    firrtl.strictconnect %foo_a, %a : !firrtl.uint<1>
+    firrtl.strictconnect %b, %foo_b : !firrtl.uint<1>
+  }
+}
@@ -180,3 +180,36 @@ firrtl.circuit "UnusedOutput"  {
     firrtl.strictconnect %b, %singleDriver_b : !firrtl.uint<1>
   }
 }
+
+// -----
+
+// Check that an output port is removed if it only drives unused output ports
+// of the instantiating modules.
+// CHECK-LABEL: "UnusedOutputChain"
+firrtl.circuit "UnusedOutputChain"  {
+  // CHECK: firrtl.module private @Leaf(in %a: !firrtl.uint<1>) {
+  firrtl.module private @Leaf(in %a: !firrtl.uint<1>, out %b: !firrtl.uint<1>) {
+    // CHECK-NEXT: %[[b_wire:.+]] = firrtl.wire
+    // CHECK-NEXT: %[[not_a:.+]] = firrtl.not %a
+    %0 = firrtl.not %a : (!firrtl.uint<1>) -> !firrtl.uint<1>
+    // CHECK-NEXT: firrtl.strictconnect %[[b_wire]], %[[not_a]]
+    firrtl.strictconnect %b, %0 : !firrtl.uint<1>
+  }
+  // CHECK: firrtl.module private @Mid(in %a: !firrtl.uint<1>) {
+  firrtl.module private @Mid(in %a: !firrtl.uint<1>, out %b: !firrtl.uint<1>) {
+    // CHECK-NEXT: %[[b_wire:.+]] = firrtl.wire
+    // CHECK-NEXT: %[[invalid:.+]] = firrtl.invalidvalue
+    // CHECK-NEXT: %leaf_a = firrtl.instance leaf @Leaf(in a: !firrtl.uint<1>)
+    %leaf_a, %leaf_b = firrtl.instance leaf @Leaf(in a: !firrtl.uint<1>, out b: !firrtl.uint<1>)
+    firrtl.strictconnect %leaf_a, %a : !firrtl.uint<1>
+    // CHECK-NEXT: firrtl.strictconnect %leaf_a, %a
+    // CHECK-NEXT: firrtl.strictconnect %[[b_wire]], %[[invalid]]
+    firrtl.strictconnect %b, %leaf_b : !firrtl.uint<1>
+  }
+  // CHECK-LABEL: firrtl.module @UnusedOutputChain
+  firrtl.module @UnusedOutputChain(in %a: !firrtl.uint<1>) {
+    // CHECK-NEXT: %mid_a = firrtl.instance mid @Mid(in a: !firrtl.uint<1>)
+    %mid_a, %mid_b = firrtl.instance mid @Mid(in a: !firrtl.uint<1>, out b: !firrtl.uint<1>)
+    firrtl.strictconnect %mid_a, %a : !firrtl.uint<1>
+  }
+}
@@ -0,0 +1,84 @@
+// RUN: circt-opt -fsm-minimize-states %s | FileCheck %s
+
+// B and D produce the same output and both return to the initial state on the
+// same condition, so D is merged into B. A and C differ in their outputs.
+
+// CHECK-LABEL: fsm.machine @merge
+// CHECK:         fsm.state @A
+// CHECK:           fsm.transition @B
+// CHECK:         fsm.state @B
+// CHECK:           fsm.transition @C
+// CHECK:         fsm.state @C
+// CHECK:           fsm.transition @B
+// CHECK-NOT:     fsm.state @D
+fsm.machine @merge(%go: i1) -> (i8) attributes {initialState = "A"} {
+  %c0 = hw.constant 0 : i8
+  %c1 = hw.constant 1 : i8
+  %c2 = hw.constant 2 : i8
+  fsm.state @A output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @B
+  }
+  fsm.state @B output {
+    fsm.output %c1 : i8
+  } transitions {
+    fsm.transition @C guard {
+      fsm.return %go
+    }
+  }
+  fsm.state @C output {
+    fsm.output %c2 : i8
+  } transitions {
+    fsm.transition @D
+  }
+  fsm.state @D output {
+    fsm.output %c1 : i8
+  } transitions {
+    fsm.transition @C guard {
+      fsm.return %go
+    }
+  }
+}
+
+// The initial state is kept as the representative of its class, and states
+// that only become distinguishable after a few steps are kept apart.
+
+// CHECK-LABEL: fsm.machine @keep_initial
+// CHECK:         fsm.state @A
+// CHECK:           fsm.transition @A
+// CHECK-NOT:     fsm.state @B
+// CHECK:         fsm.state @C
+// CHECK:           fsm.transition @D
+// CHECK:         fsm.state @D
+// CHECK:           fsm.transition @E
+// CHECK:         fsm.state @E
+fsm.machine @keep_initial(%go: i1) -> (i8) attributes {initialState = "A"} {
+  %c0 = hw.constant 0 : i8
+  %c1 = hw.constant 1 : i8
+  fsm.state @B output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @A
+  }
+  fsm.state @A output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @B
+  }
+  fsm.state @C output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @D
+  }
+  fsm.state @D output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @E
+  }
+  fsm.state @E output {
+    fsm.output %c1 : i8
+  } transitions {
+    fsm.transition @E
+  }
+}
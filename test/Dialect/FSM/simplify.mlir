@@ -0,0 +1,90 @@
+// RUN: circt-opt -fsm-simplify %s | FileCheck %s
+
+// CHECK-LABEL: fsm.machine @prune
+// CHECK:         fsm.state @A output
+// CHECK:         } transitions {
+// CHECK-NEXT:      fsm.transition @B guard {
+// CHECK-NEXT:        %[[OR:.+]] = comb.or %a, %b : i1
+// CHECK-NEXT:        fsm.return %[[OR]]
+// CHECK-NEXT:      }
+// CHECK-NEXT:    }
+// CHECK:         fsm.state @B output
+// CHECK:         } transitions {
+// CHECK-NEXT:      fsm.transition @A{{$}}
+// CHECK-NEXT:    }
+// CHECK-NOT:     fsm.state @C
+// CHECK-NOT:     fsm.state @D
+fsm.machine @prune(%a: i1, %b: i1) -> (i8) attributes {initialState = "A"} {
+  %c0 = hw.constant 0 : i8
+  // The transitions into B are merged, the one into C is never taken and
+  // the trailing transition into A itself does not leave the state.
+  fsm.state @A output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @B guard {
+      fsm.return %a
+    }
+    fsm.transition @C guard {
+      %false = hw.constant false
+      %0 = comb.and %a, %false : i1
+      fsm.return %0
+    }
+    fsm.transition @B guard {
+      fsm.return %b
+    }
+    fsm.transition @A
+  }
+  // The guard of the first transition folds to true, so the second one is
+  // dead. D only becomes unreachable once C is removed.
+  fsm.state @B output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @A guard {
+      %true = hw.constant true
+      %0 = comb.or %a, %true : i1
+      fsm.return %0
+    }
+    fsm.transition @D
+  }
+  fsm.state @C output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @D
+  }
+  fsm.state @D output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @A
+  }
+}
+
+// Transitions with actions are not merged.
+// CHECK-LABEL: fsm.machine @actions
+// CHECK:         fsm.transition @B guard
+// CHECK:           fsm.update
+// CHECK:         fsm.transition @B guard
+// CHECK-NOT:     fsm.transition
+// CHECK:         fsm.state @B
+fsm.machine @actions(%a: i1, %b: i1) -> (i8) attributes {initialState = "A"} {
+  %c0 = hw.constant 0 : i8
+  %c1 = hw.constant 1 : i8
+  %cnt = fsm.variable "cnt" {initValue = 0 : i8} : i8
+  fsm.state @A output {
+    fsm.output %cnt : i8
+  } transitions {
+    fsm.transition @B guard {
+      fsm.return %a
+    } action {
+      fsm.update %cnt, %c1 : i8
+    }
+    fsm.transition @B guard {
+      fsm.return %b
+    }
+    fsm.transition @A
+  }
+  fsm.state @B output {
+    fsm.output %c0 : i8
+  } transitions {
+    fsm.transition @A
+  }
+}
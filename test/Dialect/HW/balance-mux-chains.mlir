@@ -0,0 +1,26 @@
+// RUN: circt-opt %s --pass-pipeline='hw.module(hw-balance-mux-chains{max-depth=2})' | FileCheck %s
+
+// CHECK-LABEL: hw.module @Chain
+hw.module @Chain(%c0: i1, %c1: i1, %c2: i1, %c3: i1, %v0: i8, %v1: i8, %v2: i8, %v3: i8, %d: i8) -> (out: i8) {
+  // CHECK-NEXT: [[ANY:%.+]] = comb.or %c0, %c1 : i1
+  // CHECK-NEXT: [[LHS:%.+]] = comb.mux %c0, %v0, %v1 : i8
+  // CHECK-NEXT: [[LEAF:%.+]] = comb.mux %c3, %v3, %d : i8
+  // CHECK-NEXT: [[RHS:%.+]] = comb.mux %c2, %v2, [[LEAF]] : i8
+  // CHECK-NEXT: [[ROOT:%.+]] = comb.mux [[ANY]], [[LHS]], [[RHS]] {sv.namehint = "sel"} : i8
+  // CHECK-NEXT: hw.output [[ROOT]] : i8
+  %0 = comb.mux %c3, %v3, %d : i8
+  %1 = comb.mux %c2, %v2, %0 : i8
+  %2 = comb.mux %c1, %v1, %1 : i8
+  %3 = comb.mux %c0, %v0, %2 {sv.namehint = "sel"} : i8
+  hw.output %3 : i8
+}
+
+// Chains within the depth limit are left alone.
+// CHECK-LABEL: hw.module @Short
+hw.module @Short(%c0: i1, %c1: i1, %v0: i8, %v1: i8, %d: i8) -> (out: i8) {
+  // CHECK-NEXT: [[INNER:%.+]] = comb.mux %c1, %v1, %d : i8
+  // CHECK-NEXT: comb.mux %c0, %v0, [[INNER]] : i8
+  %0 = comb.mux %c1, %v1, %d : i8
+  %1 = comb.mux %c0, %v0, %0 : i8
+  hw.output %1 : i8
+}
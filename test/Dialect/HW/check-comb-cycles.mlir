@@ -0,0 +1,70 @@
+// RUN: circt-opt %s --split-input-file --verify-diagnostics --hw-check-comb-cycles | FileCheck %s
+
+// The paths through the instance do not loop back on themselves.
+// CHECK-LABEL: hw.module @NoCycle
+hw.module @Thru(%in1: i1, %in2: i1) -> (out1: i1, out2: i1) {
+  hw.output %in1, %in2 : i1, i1
+}
+hw.module @NoCycle(%a: i1) -> (b: i1) {
+  %w = sv.wire : !hw.inout<i1>
+  %r = sv.read_inout %w : !hw.inout<i1>
+  %out1, %out2 = hw.instance "thru" @Thru(in1: %a: i1, in2: %r: i1) -> (out1: i1, out2: i1)
+  sv.assign %w, %out1 : i1
+  hw.output %out2 : i1
+}
+
+// -----
+
+// Registers break the cycle.
+// CHECK-LABEL: hw.module @Register
+hw.module @Register(%clk: i1, %a: i1) -> (b: i1) {
+  %q = seq.compreg %x, %clk : i1
+  %x = comb.and %q, %a : i1
+  hw.output %x : i1
+}
+
+// -----
+
+hw.module @Thru(%in: i1) -> (out: i1) {
+  hw.output %in : i1
+}
+
+// expected-error @+1 {{detected combinational cycle in a HW module}}
+hw.module @ThroughInstance(%a: i1) -> (b: i1) {
+  // expected-note @+1 {{this operation is part of the combinational cycle}}
+  %w = sv.wire : !hw.inout<i1>
+  // expected-note @+1 {{this operation is part of the combinational cycle}}
+  %r = sv.read_inout %w : !hw.inout<i1>
+  // expected-note @+1 {{this operation is part of the combinational cycle}}
+  %out = hw.instance "thru" @Thru(in: %r: i1) -> (out: i1)
+  // expected-note @+1 {{this operation is part of the combinational cycle}}
+  %x = comb.and %out, %a : i1
+  sv.assign %w, %x : i1
+  hw.output %x : i1
+}
+
+// -----
+
+// External modules are assumed not to have combinational paths.
+// CHECK-LABEL: hw.module @ThroughExternal
+hw.module.extern @Ext(%in: i1) -> (out: i1)
+hw.module @ThroughExternal() {
+  %w = sv.wire : !hw.inout<i1>
+  %r = sv.read_inout %w : !hw.inout<i1>
+  %out = hw.instance "ext" @Ext(in: %r: i1) -> (out: i1)
+  sv.assign %w, %out : i1
+}
+
+// -----
+
+// Cycles which do not reach any output are detected as well.
+// expected-error @+1 {{detected combinational cycle in a HW module}}
+hw.module @Unobserved(%c: i1) {
+  // expected-note @+1 {{this operation is part of the combinational cycle}}
+  %w = sv.wire : !hw.inout<i1>
+  // expected-note @+1 {{this operation is part of the combinational cycle}}
+  %r = sv.read_inout %w : !hw.inout<i1>
+  // expected-note @+1 {{this operation is part of the combinational cycle}}
+  %x = comb.xor %r, %c : i1
+  sv.assign %w, %x : i1
+}
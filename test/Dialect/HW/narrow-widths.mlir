@@ -0,0 +1,58 @@
+// RUN: circt-opt %s --split-input-file --pass-pipeline='hw.module(hw-narrow-widths)' | FileCheck %s
+
+// The upper bits of the adders are never observed through the truncating
+// extract, so the whole chain is narrowed.
+// CHECK-LABEL: hw.module @AddChain
+hw.module @AddChain(%a: i32, %b: i32, %c: i32) -> (out: i8) {
+  // CHECK-DAG: [[A:%.+]] = comb.extract %a from 0 : (i32) -> i8
+  // CHECK-DAG: [[B:%.+]] = comb.extract %b from 0 : (i32) -> i8
+  // CHECK-DAG: [[C:%.+]] = comb.extract %c from 0 : (i32) -> i8
+  // CHECK-DAG: [[ADD0:%.+]] = comb.add [[A]], [[B]] : i8
+  // CHECK-DAG: [[ADD1:%.+]] = comb.add {{.+}}, [[C]] : i8
+  // CHECK: hw.output
+  %0 = comb.add %a, %b : i32
+  %1 = comb.add %0, %c : i32
+  %2 = comb.extract %1 from 0 : (i32) -> i8
+  hw.output %2 : i8
+}
+
+// -----
+
+// Bitwise operations and muxes also drop undemanded low bits.
+// CHECK-LABEL: hw.module @MuxMiddle
+hw.module @MuxMiddle(%cond: i1, %a: i16, %b: i16) -> (out: i4) {
+  // CHECK-DAG: [[A:%.+]] = comb.extract %a from 4 : (i16) -> i4
+  // CHECK-DAG: [[B:%.+]] = comb.extract %b from 4 : (i16) -> i4
+  // CHECK-DAG: comb.mux %cond, [[A]], [[B]] : i4
+  %0 = comb.mux %cond, %a, %b : i16
+  %1 = comb.extract %0 from 4 : (i16) -> i4
+  hw.output %1 : i4
+}
+
+// -----
+
+// Operands of a concat whose bits are never observed are replaced by zero.
+// CHECK-LABEL: hw.module @ConcatUnused
+hw.module @ConcatUnused(%a: i8, %b: i8) -> (out: i8) {
+  // CHECK-DAG: [[ZERO:%.+]] = hw.constant 0 : i8
+  // CHECK-DAG: [[CAT:%.+]] = comb.concat [[ZERO]], %b : i8, i8
+  // CHECK-NOT: comb.xor
+  // CHECK: comb.extract [[CAT]] from 0
+  %0 = comb.xor %a, %b : i8
+  %1 = comb.concat %0, %b : i8, i8
+  %2 = comb.extract %1 from 0 : (i16) -> i8
+  hw.output %2 : i8
+}
+
+// -----
+
+// Values observed outside of the combinational logic keep all of their bits.
+// CHECK-LABEL: hw.module @Observed
+hw.module @Observed(%a: i32, %b: i32) -> (out: i32, low: i8) {
+  // CHECK: [[ADD:%.+]] = comb.add %a, %b : i32
+  // CHECK: [[LOW:%.+]] = comb.extract [[ADD]] from 0 : (i32) -> i8
+  // CHECK: hw.output [[ADD]], [[LOW]]
+  %0 = comb.add %a, %b : i32
+  %1 = comb.extract %0 from 0 : (i32) -> i8
+  hw.output %0, %1 : i32, i8
+}
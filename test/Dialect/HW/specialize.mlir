@@ -168,3 +168,41 @@ module {
     hw.output %0 : i32
   }
 }
+
+// -----
+
+// Test that a specialization reached at different depths of the hierarchy is
+// only created once.
+
+module {
+  hw.module @leaf<V: i32>() -> (out: i32) {
+    %0 = hw.param.value i32 = #hw.param.decl.ref<"V">
+    hw.output %0 : i32
+  }
+
+  hw.module @inner<V: i32>() -> (out: i32) {
+    %0 = hw.instance "leaf" @leaf<V: i32 = #hw.param.decl.ref<"V">> () -> (out: i32)
+    hw.output %0 : i32
+  }
+
+  hw.module @outer<V: i32>() -> (out: i32) {
+    %0 = hw.instance "inner" @inner<V: i32 = #hw.param.decl.ref<"V">> () -> (out: i32)
+    hw.output %0 : i32
+  }
+
+  // CHECK-LABEL: hw.module @leaf_V_8() -> (out: i32) {
+  // CHECK-LABEL: hw.module @outer_V_8() -> (out: i32) {
+  // CHECK:         hw.instance "inner" @inner_V_8() -> (out: i32)
+  // CHECK-LABEL: hw.module @inner_V_8() -> (out: i32) {
+  // CHECK:         hw.instance "leaf" @leaf_V_8() -> (out: i32)
+  // CHECK-NOT:   hw.module @leaf_V_8_
+  // CHECK-LABEL: hw.module @top() -> (out1: i32, out2: i32) {
+  // CHECK:         hw.instance "leaf" @leaf_V_8() -> (out: i32)
+  // CHECK:         hw.instance "outer" @outer_V_8() -> (out: i32)
+
+  hw.module @top() -> (out1: i32, out2: i32) {
+    %0 = hw.instance "leaf" @leaf<V: i32 = 8> () -> (out: i32)
+    %1 = hw.instance "outer" @outer<V: i32 = 8> () -> (out: i32)
+    hw.output %0, %1 : i32, i32
+  }
+}
@@ -0,0 +1,39 @@
+// RUN: circt-opt --handshake-share-operators --split-input-file %s | FileCheck %s
+// RUN: echo '{"time": 10, "operations": [{"name": "arith.divsi", "location": "loc(\"first\")", "firings": 2}, {"name": "arith.divsi", "location": "loc(\"second\")", "firings": 2}]}' > %t.json
+// RUN: circt-opt --handshake-share-operators="profile=%t.json" --split-input-file %s | FileCheck %s --check-prefix=PROFILE
+
+// Operations outside of loops fire once per invocation and are shared.
+// CHECK-LABEL:   handshake.func @acyclic(
+// CHECK-SAME:                            %[[A:.*]]: i32, %[[B:.*]]: i32, %[[C:.*]]: i32,
+// CHECK-DAG:       %[[P0:.*]] = pack %[[A]], %[[B]] : tuple<i32, i32>
+// CHECK-DAG:       %[[P1:.*]] = pack %[[C]], %[[B]] : tuple<i32, i32>
+// CHECK:           %[[M:.*]], %{{.*}} = control_merge %[[P0]], %[[P1]]
+// CHECK:           %[[OPS:.*]]:2 = unpack %[[M]] : tuple<i32, i32>
+// CHECK:           %[[DIV:.*]] = arith.divsi %[[OPS]]#0, %[[OPS]]#1 : i32
+// CHECK-NOT:       arith.divsi
+// CHECK:           %[[R0:.*]], %[[R1:.*]] = cond_br %{{.*}}, %[[DIV]] : i32
+// CHECK-DAG:       %[[OUT0:.*]] = buffer [1] fifo %[[R0]] : i32
+// CHECK-DAG:       %[[OUT1:.*]] = buffer [1] fifo %[[R1]] : i32
+// CHECK:           return %[[OUT0]], %[[OUT1]], %{{.*}} : i32, i32, none
+handshake.func @acyclic(%a : i32, %b : i32, %c : i32, %ctrl : none) -> (i32, i32, none) {
+  %0 = arith.divsi %a, %b : i32
+  %1 = arith.divsi %c, %b : i32
+  return %0, %1, %ctrl : i32, i32, none
+}
+
+// -----
+
+// Operations within a loop are assumed to be fully utilized, unless the
+// profile shows otherwise.
+// CHECK-LABEL:   handshake.func @in_loop(
+// CHECK-NOT:       control_merge
+// PROFILE-LABEL: handshake.func @in_loop(
+// PROFILE:         control_merge
+// PROFILE-COUNT-1: arith.divsi
+// PROFILE-NOT:     arith.divsi
+handshake.func @in_loop(%a : i32, %b : i32, %sel : index, %ctrl : none) -> (i32, none) {
+  %0 = mux %sel [%a, %2] : index, i32
+  %1 = arith.divsi %0, %b : i32 loc("first")
+  %2 = arith.divsi %1, %b : i32 loc("second")
+  return %2, %ctrl : i32, none
+}
@@ -0,0 +1,61 @@
+// RUN: circt-opt --handshake-insert-buffers="strategy=throughput" --split-input-file --verify-diagnostics %s | FileCheck %s
+// RUN: circt-opt --handshake-insert-buffers="strategy=throughput target-ii=2" --split-input-file --verify-diagnostics %s | FileCheck %s --check-prefix=II2
+
+// The short path of the fork has to buffer the tokens for as long as the long
+// path delays them, and so does the control output.
+// CHECK-LABEL:   handshake.func @reconverge(
+// CHECK-SAME:                               %[[ARG0:.*]]: i32,
+// CHECK-SAME:                               %[[CTRL:.*]]: none, ...) -> (i32, none)
+// CHECK:           %[[CTRL_BUF:.*]] = buffer [3] fifo %[[CTRL]] : none
+// CHECK:           %[[FORK:.*]]:2 = fork [2] %[[ARG0]] : i32
+// CHECK:           %[[FIFO:.*]] = buffer [3] fifo %[[FORK]]#1 : i32
+// CHECK:           %[[SEQ:.*]] = buffer [3] seq %[[FORK]]#0 : i32
+// CHECK:           %[[ADD:.*]] = arith.addi %[[SEQ]], %[[FIFO]] : i32
+// CHECK:           return %[[ADD]], %[[CTRL_BUF]] : i32, none
+
+// At half the rate, half as many tokens are in flight.
+// II2-LABEL:     handshake.func @reconverge(
+// II2:             buffer [2] fifo %{{.*}} : none
+// II2:             buffer [2] fifo %{{.*}}#1 : i32
+// II2:             buffer [3] seq %{{.*}}#0 : i32
+handshake.func @reconverge(%arg0 : i32, %ctrl : none) -> (i32, none) {
+  %0:2 = fork [2] %arg0 : i32
+  %1 = buffer [3] seq %0#0 : i32
+  %2 = arith.addi %1, %0#1 : i32
+  return %2, %ctrl : i32, none
+}
+
+// -----
+
+// Only the combinational cycle gets a sequential buffer; the channels which
+// are already balanced are left unbuffered.
+// CHECK-LABEL:   handshake.func @loop(
+// CHECK-SAME:                         %[[ARG0:.*]]: i32,
+// CHECK-SAME:                         %[[CTRL:.*]]: none, ...) -> (i32, none)
+// CHECK:           %[[CTRL_BUF:.*]] = buffer [1] fifo %[[CTRL]] : none
+// CHECK:           %[[FORK:.*]]:2 = fork [2] %[[ARG0]] : i32
+// CHECK:           %[[MUX:.*]] = mux %[[FORK]]#0 {{\[}}%[[FORK]]#1, %[[BACK:[0-9]+]]#0] : i32, i32
+// CHECK:           %[[SEQ:.*]] = buffer [1] seq %[[MUX]] : i32
+// CHECK:           %[[BACK]]:2 = fork [2] %[[SEQ]] : i32
+// CHECK:           return %[[BACK]]#1, %[[CTRL_BUF]] : i32, none
+handshake.func @loop(%arg0 : i32, %ctrl : none) -> (i32, none) {
+  %0:2 = fork [2] %arg0 : i32
+  %1 = mux %0#0 [%0#1, %2#0] : i32, i32
+  %2:2 = fork [2] %1 : i32
+  return %2#1, %ctrl : i32, none
+}
+
+// -----
+
+// A cycle which is slower than the target II is reported, as no buffers can
+// make it any faster.
+// CHECK-LABEL:   handshake.func @slow_loop(
+// CHECK-NOT:       buffer [{{.*}}] fifo
+handshake.func @slow_loop(%arg0 : i32, %ctrl : none) -> (i32, none) {
+  %0:2 = fork [2] %arg0 : i32
+  // expected-warning @+1 {{cycle through this operation has a latency of 3 cycles}}
+  %1 = mux %0#0 [%0#1, %3] : i32, i32
+  %2:2 = fork [2] %1 : i32
+  %3 = buffer [3] seq %2#0 : i32
+  return %2#1, %ctrl : i32, none
+}
@@ -0,0 +1,36 @@
+// REQUIRES: llhd-sim
+// RUN: llhd-sim %s -n 10 -r Foo --trace-format=none --activity-file=%t.saif -shared-libs=%shlibdir/libcirct-llhd-signals-runtime-wrappers%shlibext
+// RUN: FileCheck %s < %t.saif
+
+// CHECK:      (SAIFILE
+// CHECK-NEXT: (SAIFVERSION "2.0")
+// CHECK-NEXT: (DIRECTION "backward")
+// CHECK-NEXT: (DESIGN "Foo")
+// CHECK-NEXT: (PROGRAM_NAME "llhd-sim")
+// CHECK-NEXT: (DIVIDER / )
+// CHECK-NEXT: (TIMESCALE 1 ps)
+// CHECK-NEXT: (DURATION 9000)
+// CHECK-NEXT: (INSTANCE Foo
+// CHECK-NEXT:   (NET
+// CHECK-NEXT:     (toggle (T0 5000) (T1 4000) (TX 0) (TC 9))
+// CHECK-NEXT:     (count\[0\] (T0 5000) (T1 4000) (TX 0) (TC 9))
+// CHECK-NEXT:     (count\[1\] (T0 5000) (T1 4000) (TX 0) (TC 4))
+// CHECK-NEXT:   )
+// CHECK-NEXT: )
+// CHECK-NEXT: )
+llhd.entity @Foo () -> () {
+  %0 = hw.constant 0 : i1
+  %toggle = llhd.sig "toggle" %0 : i1
+  %1 = llhd.prb %toggle : !llhd.sig<i1>
+  %allset = hw.constant 1 : i1
+  %2 = comb.xor %1, %allset : i1
+  %dt = llhd.constant_time #llhd.time<1ns, 0d, 0e>
+  llhd.drv %toggle, %2 after %dt : !llhd.sig<i1>
+
+  %c0 = hw.constant 0 : i2
+  %count = llhd.sig "count" %c0 : i2
+  %3 = llhd.prb %count : !llhd.sig<i2>
+  %c1 = hw.constant 1 : i2
+  %4 = comb.add %3, %c1 : i2
+  llhd.drv %count, %4 after %dt : !llhd.sig<i2>
+}
@@ -0,0 +1,41 @@
+// REQUIRES: llhd-sim
+// RUN: llhd-sim %s -T 3000 --trace-format=reduced --save-checkpoint=%t.ckpt -shared-libs=%shlibdir/libcirct-llhd-signals-runtime-wrappers%shlibext | FileCheck %s --check-prefix=SAVE
+// RUN: llhd-sim %s -T 6000 --trace-format=reduced --restore-checkpoint=%t.ckpt -shared-libs=%shlibdir/libcirct-llhd-signals-runtime-wrappers%shlibext | FileCheck %s --check-prefix=RESTORE
+
+// SAVE: 0ps 0d 0e  root/count  0xa0
+// SAVE-NEXT: 1000ps 0d 1e  root/count  0xa1
+// SAVE-NEXT: 2000ps 0d 1e  root/count  0xa2
+// SAVE-NEXT: 3000ps 0d 1e  root/count  0xa3
+// SAVE-NOT: root/count
+
+// The restored run starts from the values and the pending wakeup of the
+// process at the end of the first run.
+// RESTORE-NOT: 0ps 0d 0e
+// RESTORE: 3000ps 0d 1e  root/count  0xa3
+// RESTORE-NEXT: 4000ps 0d 1e  root/count  0xa4
+// RESTORE-NEXT: 5000ps 0d 1e  root/count  0xa5
+// RESTORE-NEXT: 6000ps 0d 1e  root/count  0xa6
+// RESTORE-NOT: root/count
+llhd.entity @root () -> () {
+  %0 = hw.constant 0xa0 : i8
+  %1 = llhd.sig "count" %0 : i8
+  llhd.inst "proc" @p () -> (%1) : () -> (!llhd.sig<i8>)
+}
+
+// The extracted signal is persisted in the process state, so it has to point
+// at the signal value of the restoring run.
+llhd.proc @p () -> (%a : !llhd.sig<i8>) {
+  %c0 = hw.constant 0 : i3
+  %low = llhd.sig.extract %a from %c0 : (!llhd.sig<i8>) -> !llhd.sig<i4>
+  cf.br ^wait
+^wait:
+  %wt = llhd.constant_time #llhd.time<1ns, 0d, 0e>
+  llhd.wait for %wt, ^drive
+^drive:
+  %1 = llhd.prb %low : !llhd.sig<i4>
+  %one = hw.constant 1 : i4
+  %2 = comb.add %1, %one : i4
+  %dt = llhd.constant_time #llhd.time<0ns, 0d, 1e>
+  llhd.drv %low, %2 after %dt : !llhd.sig<i4>
+  cf.br ^wait
+}
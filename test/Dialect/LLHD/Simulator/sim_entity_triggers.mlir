@@ -0,0 +1,37 @@
+// REQUIRES: llhd-sim
+// RUN: llhd-sim %s -T 2500 --print-stats -shared-libs=%shlibdir/libcirct-llhd-signals-runtime-wrappers%shlibext 2>&1 | FileCheck %s
+
+// Entities are only evaluated again when a signal they probe changes. The
+// changes of `b`, which `inc` only drives and `root` only passes on to its
+// child instances, do not trigger any evaluation: all three instances run at
+// 0ps, then `counter` and `inc` run once every nanosecond.
+// CHECK: instance-runs: 7
+llhd.entity @root () -> () {
+  %0 = hw.constant 0 : i8
+  %a = llhd.sig "a" %0 : i8
+  %b = llhd.sig "b" %0 : i8
+  llhd.inst "counter" @counter () -> (%a) : () -> (!llhd.sig<i8>)
+  llhd.inst "inc" @inc (%a) -> (%b) : (!llhd.sig<i8>) -> (!llhd.sig<i8>)
+}
+
+llhd.entity @inc (%x : !llhd.sig<i8>) -> (%z : !llhd.sig<i8>) {
+  %0 = llhd.prb %x : !llhd.sig<i8>
+  %1 = hw.constant 1 : i8
+  %2 = comb.add %0, %1 : i8
+  %t = llhd.constant_time #llhd.time<0ns, 1d, 0e>
+  llhd.drv %z, %2 after %t : !llhd.sig<i8>
+}
+
+llhd.proc @counter () -> (%a : !llhd.sig<i8>) {
+  cf.br ^wait
+^wait:
+  %wt = llhd.constant_time #llhd.time<1ns, 0d, 0e>
+  llhd.wait for %wt, ^drive
+^drive:
+  %0 = llhd.prb %a : !llhd.sig<i8>
+  %1 = hw.constant 1 : i8
+  %2 = comb.add %0, %1 : i8
+  %dt = llhd.constant_time #llhd.time<0ns, 0d, 1e>
+  llhd.drv %a, %2 after %dt : !llhd.sig<i8>
+  cf.br ^wait
+}
@@ -1,9 +1,11 @@
 // REQUIRES: llhd-sim
 // RUN: llhd-sim %s -T 5000 --trace-format=full -shared-libs=%shlibdir/libcirct-llhd-signals-runtime-wrappers%shlibext | FileCheck %s --check-prefix=FULL
+// RUN: llhd-sim %s -T 5000 --trace-format=full --parallel -shared-libs=%shlibdir/libcirct-llhd-signals-runtime-wrappers%shlibext | FileCheck %s --check-prefix=FULL
 // RUN: llhd-sim %s -T 5000 --trace-format=reduced -shared-libs=%shlibdir/libcirct-llhd-signals-runtime-wrappers%shlibext | FileCheck %s --check-prefix=REDUCED
 // RUN: llhd-sim %s -T 5000 --trace-format=merged -shared-libs=%shlibdir/libcirct-llhd-signals-runtime-wrappers%shlibext | FileCheck %s --check-prefix=MERGED
 // RUN: llhd-sim %s -T 5000 --trace-format=merged-reduce -shared-libs=%shlibdir/libcirct-llhd-signals-runtime-wrappers%shlibext | FileCheck %s --check-prefix=MERGEDRED
 // RUN: llhd-sim %s -T 5000 --trace-format=named-only -shared-libs=%shlibdir/libcirct-llhd-signals-runtime-wrappers%shlibext | FileCheck %s --check-prefix=NAMED
+// RUN: llhd-sim %s -T 5000 --trace-format=vcd -shared-libs=%shlibdir/libcirct-llhd-signals-runtime-wrappers%shlibext | FileCheck %s --check-prefix=VCD
 
 // FULL: 0ps 0d 0e  root/1  0x01
 // FULL: 0ps 0d 0e  root/foo/s  0x01
@@ -94,6 +96,29 @@
 // NAMED:   root/s  0xf3
 // NAMED: 5000ps
 // NAMED:   root/s  0xd9
+
+// VCD:      $timescale 1ps $end
+// VCD-NEXT: $scope module root $end
+// VCD-NEXT: $var wire 8 [[ONE:[^ ]+]] 1 $end
+// VCD-NEXT: $var wire 8 [[S:[^ ]+]] s $end
+// VCD-NEXT: $scope module foo $end
+// VCD-NEXT: $var wire 8 [[S]] s $end
+// VCD-NEXT: $upscope $end
+// VCD-NEXT: $upscope $end
+// VCD-NEXT: $enddefinitions $end
+// VCD-NEXT: #0
+// VCD-DAG:  b00000001 [[ONE]]
+// VCD-DAG:  b00000011 [[S]]
+// VCD:      #1000
+// VCD-NEXT: b00001001 [[S]]
+// VCD-NEXT: #2000
+// VCD-NEXT: b00011011 [[S]]
+// VCD-NEXT: #3000
+// VCD-NEXT: b01010001 [[S]]
+// VCD-NEXT: #4000
+// VCD-NEXT: b11110011 [[S]]
+// VCD-NEXT: #5000
+// VCD-NEXT: b11011001 [[S]]
 llhd.entity @root () -> () {
   %0 = hw.constant 1 : i8
   %s = llhd.sig "s" %0 : i8
@@ -0,0 +1,42 @@
+// REQUIRES: llhd-sim
+// RUN: llhd-sim %s -T 2500 --trace-format=reduced -shared-libs=%shlibdir/libcirct-llhd-signals-runtime-wrappers%shlibext | FileCheck %s
+// RUN: llhd-sim %s -T 2500 --trace-format=reduced --inline-entities -shared-libs=%shlibdir/libcirct-llhd-signals-runtime-wrappers%shlibext | FileCheck %s
+
+// Inlining the incrementer into the root does not change the simulation.
+// CHECK: 0ps 0d 0e  root/a  0x00
+// CHECK-NEXT: 0ps 0d 0e  root/b  0x00
+// CHECK-NEXT: 0ps 1d 0e  root/b  0x01
+// CHECK-NEXT: 1000ps 0d 1e  root/a  0x01
+// CHECK-NEXT: 1000ps 1d 1e  root/b  0x02
+// CHECK-NEXT: 2000ps 0d 1e  root/a  0x02
+// CHECK-NEXT: 2000ps 1d 1e  root/b  0x03
+// CHECK-NOT: root/
+llhd.entity @root () -> () {
+  %0 = hw.constant 0 : i8
+  %a = llhd.sig "a" %0 : i8
+  %b = llhd.sig "b" %0 : i8
+  llhd.inst "counter" @counter () -> (%a) : () -> (!llhd.sig<i8>)
+  llhd.inst "inc" @inc (%a) -> (%b) : (!llhd.sig<i8>) -> (!llhd.sig<i8>)
+}
+
+llhd.entity @inc (%x : !llhd.sig<i8>) -> (%z : !llhd.sig<i8>) {
+  %0 = llhd.prb %x : !llhd.sig<i8>
+  %1 = hw.constant 1 : i8
+  %2 = comb.add %0, %1 : i8
+  %t = llhd.constant_time #llhd.time<0ns, 1d, 0e>
+  llhd.drv %z, %2 after %t : !llhd.sig<i8>
+}
+
+llhd.proc @counter () -> (%a : !llhd.sig<i8>) {
+  cf.br ^wait
+^wait:
+  %wt = llhd.constant_time #llhd.time<1ns, 0d, 0e>
+  llhd.wait for %wt, ^drive
+^drive:
+  %0 = llhd.prb %a : !llhd.sig<i8>
+  %1 = hw.constant 1 : i8
+  %2 = comb.add %0, %1 : i8
+  %dt = llhd.constant_time #llhd.time<0ns, 0d, 1e>
+  llhd.drv %a, %2 after %dt : !llhd.sig<i8>
+  cf.br ^wait
+}
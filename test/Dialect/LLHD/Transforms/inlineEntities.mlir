@@ -0,0 +1,46 @@
+// RUN: circt-opt %s --llhd-inline-entities | FileCheck %s
+
+// CHECK-LABEL: llhd.entity @root
+llhd.entity @root () -> () {
+  %0 = hw.constant 0 : i8
+  %a = llhd.sig "a" %0 : i8
+  %b = llhd.sig "b" %0 : i8
+  %c = llhd.sig "c" %0 : i8
+  // CHECK-NOT: llhd.inst "adder"
+  // CHECK-NOT: llhd.inst "wrapper"
+  // CHECK-DAG: [[A:%.+]] = llhd.prb %a
+  // CHECK-DAG: [[B:%.+]] = llhd.prb %b
+  // CHECK-DAG: [[SUM:%.+]] = comb.add [[A]], [[B]]
+  // CHECK-DAG: llhd.drv %c, [[SUM]] after
+  llhd.inst "wrapper" @wrapper (%a, %b) -> (%c) : (!llhd.sig<i8>, !llhd.sig<i8>) -> (!llhd.sig<i8>)
+  // CHECK: llhd.inst "state" @state
+  llhd.inst "state" @state (%a) -> (%c) : (!llhd.sig<i8>) -> (!llhd.sig<i8>)
+  // CHECK: llhd.inst "proc" @proc
+  llhd.inst "proc" @proc (%a) -> (%c) : (!llhd.sig<i8>) -> (!llhd.sig<i8>)
+}
+
+// The wrapper becomes combinational once the adder is inlined into it.
+// CHECK-LABEL: llhd.entity @wrapper
+// CHECK-NOT: llhd.inst
+llhd.entity @wrapper (%x : !llhd.sig<i8>, %y : !llhd.sig<i8>) -> (%z : !llhd.sig<i8>) {
+  llhd.inst "adder" @adder (%x, %y) -> (%z) : (!llhd.sig<i8>, !llhd.sig<i8>) -> (!llhd.sig<i8>)
+}
+
+// Operations may be used before they are defined in an entity.
+llhd.entity @adder (%x : !llhd.sig<i8>, %y : !llhd.sig<i8>) -> (%z : !llhd.sig<i8>) {
+  %t = llhd.constant_time #llhd.time<0ns, 1d, 0e>
+  llhd.drv %z, %sum after %t : !llhd.sig<i8>
+  %sum = comb.add %xv, %yv : i8
+  %xv = llhd.prb %x : !llhd.sig<i8>
+  %yv = llhd.prb %y : !llhd.sig<i8>
+}
+
+// Entities owning signals are not inlined.
+llhd.entity @state (%x : !llhd.sig<i8>) -> (%z : !llhd.sig<i8>) {
+  %0 = hw.constant 0 : i8
+  %s = llhd.sig "s" %0 : i8
+}
+
+llhd.proc @proc (%x : !llhd.sig<i8>) -> (%z : !llhd.sig<i8>) {
+  llhd.halt
+}
@@ -0,0 +1,27 @@
+// RUN: circt-opt %s --msft-partition=budget=2 | FileCheck %s
+
+// CHECK-LABEL: msft.module @P1
+// CHECK-COUNT-2: seq.compreg {{.+}} {targetDesignPartition = @top::@p1}
+// CHECK-NOT:     seq.compreg
+// CHECK:         msft.output
+
+// CHECK-LABEL: msft.module @P2
+// CHECK-COUNT-2: seq.compreg {{.+}} {targetDesignPartition = @top::@p2}
+// CHECK-NOT:     seq.compreg
+// CHECK:         msft.output
+
+// CHECK-LABEL: msft.module @top
+// CHECK-DAG:     msft.instance @p1 @P1
+// CHECK-DAG:     msft.instance @p2 @P2
+// CHECK-DAG:     [[E:%.+]] = seq.compreg
+// CHECK:         msft.output [[E]]
+msft.module @top {} (%clk : i1, %in : i8) -> (out: i8) {
+  msft.partition @p1, "P1"
+  msft.partition @p2, "P2"
+  %a = seq.compreg %in, %clk : i8
+  %b = seq.compreg %a, %clk : i8
+  %c = seq.compreg %b, %clk : i8
+  %d = seq.compreg %c, %clk : i8
+  %e = seq.compreg %d, %clk : i8
+  msft.output %e : i8
+}
@@ -0,0 +1,78 @@
+// RUN: circt-opt %s -pass-pipeline='hw.module(pipeline.pipeline(pipeline-balance-stages))' | FileCheck %s
+
+// Half of the adder chain moves into the second stage.
+// CHECK-LABEL: hw.module @constants
+// CHECK:         %[[ADD0:.*]] = comb.add
+// CHECK-NEXT:    {{.*}} pipeline.stage when
+// CHECK-NOT:     comb.add
+// CHECK:         %[[ADD1:.*]] = comb.add %[[ADD0]],
+// CHECK-NEXT:    pipeline.return %[[ADD1]] valid
+hw.module @unbalanced
+// CHECK:         %[[ADD0:.*]] = comb.add %[[A0:.*]], %[[A0]] : i32
+// CHECK-NEXT:    %[[ADD1:.*]] = comb.add %[[ADD0]], %[[A0]] : i32
+// CHECK-NEXT:    %[[S0_VALID:.*]] = pipeline.stage when
+// CHECK-NEXT:    %[[ADD2:.*]] = comb.add %[[ADD1]], %[[A0]] : i32
+// CHECK-NEXT:    %[[ADD3:.*]] = comb.add %[[ADD2]], %[[A0]] : i32
+// CHECK-NEXT:    pipeline.return %[[ADD3]] valid %[[S0_VALID]] : i32
+hw.module @unbalanced(%arg0 : i32, %go : i1, %clk : i1, %rst : i1) -> (out: i32) {
+  %out = pipeline.pipeline(%arg0, %go) clock %clk reset %rst : (i32, i1) -> (i32) {
+    ^bb0(%a0 : i32, %g : i1):
+      %add0 = comb.add %a0, %a0 : i32
+      %add1 = comb.add %add0, %a0 : i32
+      %add2 = comb.add %add1, %a0 : i32
+      %add3 = comb.add %add2, %a0 : i32
+      %s0_valid = pipeline.stage when %g
+      pipeline.return %add3 valid %s0_valid : i32
+  }
+  hw.output %out : i32
+}
+
+// Constants do not count towards the stage delay.
+// CHECK-LABEL: hw.module @constants
+// CHECK:         %[[ADD0:.*]] = comb.add
+// CHECK-NEXT:    {{.*}} pipeline.stage when
+// CHECK-NOT:     comb.add
+// CHECK:         %[[ADD1:.*]] = comb.add %[[ADD0]],
+// CHECK-NEXT:    pipeline.return %[[ADD1]] valid
+hw.module @constants
+// CHECK:         %[[C1:.*]] = hw.constant 1 : i32
+// CHECK-NEXT:    %[[ADD0:.*]] = comb.add %[[A0:.*]], %[[C1]] : i32
+// CHECK-NEXT:    %[[S0_VALID:.*]] = pipeline.stage when
+// CHECK-NEXT:    %[[C2:.*]] = hw.constant 2 : i32
+// CHECK-NEXT:    %[[ADD1:.*]] = comb.add %[[ADD0]], %[[C2]] : i32
+// CHECK-NEXT:    pipeline.return %[[ADD1]] valid %[[S0_VALID]] : i32
+hw.module @constants(%arg0 : i32, %go : i1, %clk : i1, %rst : i1) -> (out: i32) {
+  %out = pipeline.pipeline(%arg0, %go) clock %clk reset %rst : (i32, i1) -> (i32) {
+    ^bb0(%a0 : i32, %g : i1):
+      %c1 = hw.constant 1 : i32
+      %add0 = comb.add %a0, %c1 : i32
+      %c2 = hw.constant 2 : i32
+      %add1 = comb.add %add0, %c2 : i32
+      %s0_valid = pipeline.stage when %g
+      pipeline.return %add1 valid %s0_valid : i32
+  }
+  hw.output %out : i32
+}
+
+// Already balanced pipelines are left alone.
+// CHECK-LABEL: hw.module @constants
+// CHECK:         %[[ADD0:.*]] = comb.add
+// CHECK-NEXT:    {{.*}} pipeline.stage when
+// CHECK-NOT:     comb.add
+// CHECK:         %[[ADD1:.*]] = comb.add %[[ADD0]],
+// CHECK-NEXT:    pipeline.return %[[ADD1]] valid
+hw.module @balanced
+// CHECK:         comb.add
+// CHECK-NEXT:    pipeline.stage when
+// CHECK-NEXT:    comb.add
+// CHECK-NEXT:    pipeline.return
+hw.module @balanced(%arg0 : i32, %go : i1, %clk : i1, %rst : i1) -> (out: i32) {
+  %out = pipeline.pipeline(%arg0, %go) clock %clk reset %rst : (i32, i1) -> (i32) {
+    ^bb0(%a0 : i32, %g : i1):
+      %add0 = comb.add %a0, %a0 : i32
+      %s0_valid = pipeline.stage when %g
+      %add1 = comb.add %add0, %a0 : i32
+      pipeline.return %add1 valid %s0_valid : i32
+  }
+  hw.output %out : i32
+}
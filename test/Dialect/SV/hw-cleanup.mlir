@@ -351,3 +351,65 @@ hw.module @sv_attributes() {
     sv.fwrite %fd, "B"
   } {sv.attributes = #sv.attribute<"dont merge">}
 }
+
+// CHECK-LABEL: hw.module @ifdef_nested(%arg0: i1) {
+// CHECK-NEXT:    %fd = hw.constant
+// CHECK-NEXT:    sv.ifdef "FOO" {
+// CHECK-NEXT:      sv.initial {
+// CHECK-NEXT:        sv.fwrite %fd, "A1"
+// CHECK-NEXT:        sv.fwrite %fd, "A2"
+// CHECK-NEXT:        sv.ifdef.procedural "BAR" {
+// CHECK-NEXT:          sv.fwrite %fd, "B1"
+// CHECK-NEXT:        }
+// CHECK-NEXT:      }
+// CHECK-NEXT:    } else {
+// CHECK-NEXT:      sv.initial {
+// CHECK-NEXT:        sv.fwrite %fd, "C2"
+// CHECK-NEXT:      }
+// CHECK-NEXT:    }
+// CHECK-NEXT:    hw.output
+// CHECK-NEXT:  }
+hw.module @ifdef_nested(%arg0: i1) {
+  %fd = hw.constant 0x80000002 : i32
+  sv.ifdef "FOO" {
+    sv.initial {
+      sv.ifdef.procedural "FOO" {
+        sv.fwrite %fd, "A1"
+        sv.ifdef.procedural "FOO" {
+          sv.fwrite %fd, "A2"
+        }
+      } else {
+        sv.fwrite %fd, "C1"
+      }
+      sv.ifdef.procedural "BAR" {
+        sv.fwrite %fd, "B1"
+      }
+    }
+  } else {
+    sv.initial {
+      sv.ifdef.procedural "FOO" {
+        sv.fwrite %fd, "A3"
+      } else {
+        sv.fwrite %fd, "C2"
+      }
+    }
+  }
+  hw.output
+}
+
+// A verbatim may define the macro, so the nested ifdef is kept.
+// CHECK-LABEL: hw.module @ifdef_nested_verbatim() {
+// CHECK:         sv.ifdef "FOO" {
+// CHECK-NEXT:    } else {
+// CHECK-NEXT:      sv.verbatim "`define FOO"
+// CHECK-NEXT:      sv.ifdef "FOO" {
+hw.module @ifdef_nested_verbatim() {
+  sv.ifdef "FOO" {
+  } else {
+    sv.verbatim "`define FOO"
+    sv.ifdef "FOO" {
+      sv.verbatim "// foo"
+    }
+  }
+  hw.output
+}
@@ -1,6 +1,7 @@
 // RUN: circt-opt %s -verify-diagnostics | circt-opt -verify-diagnostics | FileCheck %s
 // RUN: circt-opt %s -verify-diagnostics --lower-seq-to-sv | circt-opt -verify-diagnostics | FileCheck %s --check-prefix=SV
-hw.module @top(%clk: i1, %rst: i1, %i: i32, %s: !hw.struct<foo: i32>) {
+// RUN: circt-opt %s -verify-diagnostics --lower-seq-to-sv=merge-always-blocks=true | FileCheck %s --check-prefix=MERGE
+hw.module @top(%clk: i1, %rst: i1, %en: i1, %i: i32, %s: !hw.struct<foo: i32>) {
   %rv = hw.constant 0 : i32
 
   %r0 = seq.compreg %i, %clk, %rst, %rv : i32
@@ -45,4 +46,54 @@ hw.module @top(%clk: i1, %rst: i1, %i: i32, %s: !hw.struct<foo: i32>) {
 
   // SV: %bar = sv.reg sym @reg1
   // SV: sv.reg sym @reg2
+
+  %ce0 = seq.compreg.ce %i, %clk, %en, %rst, %rv : i32
+  %ce1 = seq.compreg.ce sym @reg3 %i, %clk, %en : i32
+  // CHECK: %ce0 = seq.compreg.ce %i, %clk, %en, %rst, %c0_i32  : i32
+  // CHECK: %ce1 = seq.compreg.ce sym @reg3 %i, %clk, %en : i32
+
+  // SV: %ce0 = sv.reg : !hw.inout<i32>
+  // SV: sv.alwaysff(posedge %clk) {
+  // SV:   sv.if %en {
+  // SV:     sv.passign %ce0, %i : i32
+  // SV:   }
+  // SV: }(syncreset : posedge %rst) {
+  // SV:   sv.passign %ce0, %c0_i32 : i32
+  // SV: }
+  // SV: %ce1 = sv.reg sym @reg3 : !hw.inout<i32>
+  // SV: sv.alwaysff(posedge %clk) {
+  // SV:   sv.if %en {
+  // SV:     sv.passign %ce1, %i : i32
+  // SV:   }
+  // SV: }
+}
+
+// MERGE-LABEL: hw.module @merge
+hw.module @merge(%clk: i1, %clk2: i1, %rst: i1, %en: i1, %i: i32) {
+  %rv = hw.constant 0 : i32
+  // MERGE:      %r0 = sv.reg
+  // MERGE:      sv.alwaysff(posedge %clk) {
+  // MERGE-NEXT:   sv.passign %r0, %i
+  // MERGE-NEXT:   sv.if %en {
+  // MERGE-NEXT:     sv.passign %r2, %i
+  // MERGE-NEXT:     sv.passign %r3, %i
+  // MERGE-NEXT:   }
+  // MERGE-NEXT: }
+  // MERGE:      sv.alwaysff(posedge %clk) {
+  // MERGE-NEXT:   sv.passign %r1, %i
+  // MERGE-NEXT:   sv.passign %r4, %i
+  // MERGE-NEXT: }(syncreset : posedge %rst) {
+  // MERGE-NEXT:   sv.passign %r1, %c0_i32
+  // MERGE-NEXT:   sv.passign %r4, %c0_i32
+  // MERGE-NEXT: }
+  // MERGE:      sv.alwaysff(posedge %clk2) {
+  // MERGE-NEXT:   sv.passign %r5, %i
+  // MERGE-NEXT: }
+  // MERGE-NOT:  sv.alwaysff
+  %r0 = seq.compreg %i, %clk : i32
+  %r1 = seq.compreg %i, %clk, %rst, %rv : i32
+  %r2 = seq.compreg.ce %i, %clk, %en : i32
+  %r3 = seq.compreg.ce %i, %clk, %en : i32
+  %r4 = seq.compreg %i, %clk, %rst, %rv : i32
+  %r5 = seq.compreg %i, %clk2 : i32
 }
@@ -1,7 +1,9 @@
 // RUN: circt-opt %s -verify-diagnostics --lower-seq-firrtl-to-sv | FileCheck %s --check-prefixes=CHECK,COMMON
 // RUN: circt-opt %s -verify-diagnostics --pass-pipeline="hw.module(lower-seq-firrtl-to-sv{disable-reg-randomization})" | FileCheck %s --check-prefix COMMON --implicit-check-not RANDOMIZE_REG
+// RUN: circt-opt %s -verify-diagnostics --pass-pipeline="hw.module(lower-seq-firrtl-to-sv{random-init-loop})" | FileCheck %s --check-prefix LOOP
 
 // COMMON-LABEL: hw.module @lowering
+// LOOP-LABEL: hw.module @lowering
 hw.module @lowering(%clk: i1, %rst: i1, %in: i32) -> (a: i32, b: i32, c: i32, d: i32, e: i32, f: i32) {
   %cst0 = hw.constant 0 : i32
 
@@ -70,6 +72,12 @@ hw.module @lowering(%clk: i1, %rst: i1, %in: i32) -> (a: i32, b: i32, c: i32, d:
   // CHECK-NEXT:       sv.ifdef.procedural "INIT_RANDOM_PROLOG_" {
   // CHECK-NEXT:         sv.verbatim "`INIT_RANDOM_PROLOG_"
   // CHECK-NEXT:       }
+  // LOOP:              sv.ifdef.procedural "RANDOMIZE_REG_INIT" {
+  // LOOP-NEXT:           %_RANDOM = sv.logic : !hw.inout<uarray<8xi32>>
+  // LOOP-NEXT{LITERAL}:  sv.verbatim "for (logic [3:0] i = 0; i < 8; i += 1) begin\0A  {{0}}[i] = `RANDOM;\0Aend"(%_RANDOM) : !hw.inout<uarray<8xi32>>
+  // LOOP-NEXT:           [[RANDOM_0:%.+]] = sv.array_index_inout %_RANDOM[%c0_i3]
+  // LOOP-NOT:            sv.macro.ref.se
+  // LOOP:                sv.read_inout [[RANDOM_0]]
   // CHECK-NEXT:       sv.ifdef.procedural  "RANDOMIZE_REG_INIT" {
   // CHECK-NEXT:          %_RANDOM_0 = sv.logic  : !hw.inout<i32>
   // CHECK-NEXT:          %RANDOM = sv.macro.ref.se< "RANDOM"> : i32
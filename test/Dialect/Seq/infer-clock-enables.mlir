@@ -0,0 +1,41 @@
+// RUN: circt-opt %s --pass-pipeline='hw.module(seq-infer-clock-enables)' | FileCheck %s
+// RUN: circt-opt %s --pass-pipeline='hw.module(seq-infer-clock-enables{group-registers=true})' | FileCheck %s --check-prefix=GROUP
+
+// CHECK-LABEL: hw.module @Feedback
+hw.module @Feedback(%clk: i1, %rst: i1, %en: i1, %a: i8, %b: i8) -> (x: i8, y: i8, z: i8) {
+  %c0_i8 = hw.constant 0 : i8
+
+  // CHECK-NEXT: %c0_i8 = hw.constant 0 : i8
+  // CHECK-NEXT: %x = seq.compreg.ce %a, %clk, %en : i8
+  %0 = comb.mux %en, %a, %x : i8
+  %x = seq.compreg %0, %clk : i8
+
+  // The register is kept when the condition of the mux holds.
+  // CHECK-NEXT: %true = hw.constant true
+  // CHECK-NEXT: [[NOT:%.+]] = comb.xor %en, %true : i1
+  // CHECK-NEXT: %y = seq.compreg.ce %b, %clk, [[NOT]], %rst, %c0_i8  : i8
+  %1 = comb.mux %en, %y, %b : i8
+  %y = seq.compreg %1, %clk, %rst, %c0_i8 : i8
+
+  // Registers without feedback are left alone.
+  // CHECK-NEXT: [[MUX:%.+]] = comb.mux %en, %a, %b : i8
+  // CHECK-NEXT: %z = seq.compreg [[MUX]], %clk : i8
+  %2 = comb.mux %en, %a, %b : i8
+  %z = seq.compreg %2, %clk : i8
+
+  hw.output %x, %y, %z : i8, i8, i8
+}
+
+// GROUP-LABEL: hw.module @Group
+hw.module @Group(%clk: i1, %en0: i1, %en1: i1, %a: i8) -> (x: i8, y: i8, z: i8) {
+  // GROUP:      %x = seq.compreg.ce %a, %clk, %en0 : i8
+  // GROUP-NEXT: %z = seq.compreg.ce %a, %clk, %en0 : i8
+  // GROUP-NEXT: %y = seq.compreg.ce %a, %clk, %en1 : i8
+  %0 = comb.mux %en0, %a, %x : i8
+  %x = seq.compreg %0, %clk : i8
+  %1 = comb.mux %en1, %a, %y : i8
+  %y = seq.compreg %1, %clk : i8
+  %2 = comb.mux %en0, %a, %z : i8
+  %z = seq.compreg %2, %clk : i8
+  hw.output %x, %y, %z : i8, i8, i8
+}
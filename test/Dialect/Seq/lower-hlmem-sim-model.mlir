@@ -0,0 +1,50 @@
+// RUN: circt-opt --lower-seq-hlmem %s | FileCheck %s
+// RUN: circt-opt --lower-seq-hlmem --hw-memory-sim %s | FileCheck %s --check-prefix=SIM
+
+module attributes {circt.loweringOptions = "lowerHLMemToSimModels"} {
+
+// CHECK-LABEL: hw.module @d1(%clk: i1, %rst: i1, %addr: i2, %en: i1, %data: i32) -> (out0: i32, out1: i32) {
+// CHECK-NEXT:    %true = hw.constant true
+// CHECK-NEXT:    %myMemory.R0_data, %myMemory.R1_data = hw.instance "myMemory" @myMemory_simModel(R0_addr: %addr: i2, R0_en: %en: i1, R0_clk: %clk: i1, R1_addr: %addr: i2, R1_en: %true: i1, R1_clk: %clk: i1, W0_addr: %addr: i2, W0_en: %en: i1, W0_clk: %clk: i1, W0_data: %data: i32) -> (R0_data: i32, R1_data: i32)
+// CHECK-NEXT:    hw.output %myMemory.R0_data, %myMemory.R1_data : i32, i32
+hw.module @d1(%clk: i1, %rst: i1, %addr: i2, %en: i1, %data: i32) -> (out0: i32, out1: i32) {
+  %myMemory = seq.hlmem @myMemory %clk, %rst : <4xi32>
+  seq.write %myMemory[%addr] %data wren %en { latency = 1 } : !seq.hlmem<4xi32>
+  %0 = seq.read %myMemory[%addr] rden %en { latency = 1 } : !seq.hlmem<4xi32>
+  %1 = seq.read %myMemory[%addr] { latency = 1 } : !seq.hlmem<4xi32>
+  hw.output %0, %1 : i32, i32
+}
+
+// Memories with the same configuration share the generated module.
+// CHECK-LABEL: hw.module @d2(
+// CHECK:         hw.instance "otherMemory" @myMemory_simModel(
+hw.module @d2(%clk: i1, %rst: i1, %addr: i2, %en: i1, %data: i32) -> (out0: i32, out1: i32) {
+  %otherMemory = seq.hlmem @otherMemory %clk, %rst : <4xi32>
+  seq.write %otherMemory[%addr] %data wren %en { latency = 1 } : !seq.hlmem<4xi32>
+  %0 = seq.read %otherMemory[%addr] rden %en { latency = 1 } : !seq.hlmem<4xi32>
+  %1 = seq.read %otherMemory[%addr] rden %en { latency = 1 } : !seq.hlmem<4xi32>
+  hw.output %0, %1 : i32, i32
+}
+
+// Read ports with different latencies fall back to the default lowering.
+// CHECK-LABEL: hw.module @d3(
+// CHECK:         sv.reg {{.*}}: !hw.inout<uarray<4xi32>>
+// CHECK-NOT:     hw.instance
+hw.module @d3(%clk: i1, %rst: i1, %addr: i2, %en: i1, %data: i32) -> (out0: i32, out1: i32) {
+  %mixedMemory = seq.hlmem @mixedMemory %clk, %rst : <4xi32>
+  seq.write %mixedMemory[%addr] %data wren %en { latency = 1 } : !seq.hlmem<4xi32>
+  %0 = seq.read %mixedMemory[%addr] rden %en { latency = 0 } : !seq.hlmem<4xi32>
+  %1 = seq.read %mixedMemory[%addr] rden %en { latency = 1 } : !seq.hlmem<4xi32>
+  hw.output %0, %1 : i32, i32
+}
+
+// CHECK: hw.generator.schema @FIRRTLMem, "FIRRTL_Memory"
+// CHECK: hw.module.generated @myMemory_simModel, @FIRRTLMem(
+// CHECK-SAME: -> (R0_data: i32, R1_data: i32)
+// CHECK-SAME: depth = 4 : i64, maskGran = 32 : ui32, numReadPorts = 2 : ui32, numReadWritePorts = 0 : ui32, numWritePorts = 1 : ui32, readLatency = 1 : ui32, readUnderWrite = 0 : ui32, width = 32 : ui32, writeClockIDs = [], writeLatency = 1 : ui32
+
+// SIM-LABEL: hw.module @myMemory_simModel(
+// SIM:         %Memory = sv.reg : !hw.inout<uarray<4xi32>>
+// SIM:         sv.always posedge %W0_clk {
+// SIM:           sv.passign
+}
@@ -10,12 +10,12 @@ hw.module @Foo (%x: i32) -> (y: i32) {
   // CHECK-NEXT:   [[V1:%.+]] = systemc.cpp.new() : () -> !emitc.ptr<!emitc.opaque<"VBar">>
   // CHECK-NEXT:   interop.return [[V1]] : !emitc.ptr<!emitc.opaque<"VBar">>
   // CHECK-NEXT: }
-  // CHECK-NEXT: {{%.+}} = interop.procedural.update cpp [[[STATE]]] (%x, %x) : [!emitc.ptr<!emitc.opaque<"VBar">>] (i32, i32) -> i32 {
-  // CHECK-NEXT: ^bb0(%arg0: !emitc.ptr<!emitc.opaque<"VBar">>, %arg1: i32, %arg2: i32):
+  // CHECK-NEXT: {{%.+}} = interop.procedural.update cpp [[[STATE]]] (%x) : [!emitc.ptr<!emitc.opaque<"VBar">>] (i32) -> i32 {
+  // CHECK-NEXT: ^bb0(%arg0: !emitc.ptr<!emitc.opaque<"VBar">>, %arg1: i32):
   // CHECK-NEXT:   [[V2:%.+]] = systemc.cpp.member_access %arg0 arrow "a" : (!emitc.ptr<!emitc.opaque<"VBar">>) -> i32
   // CHECK-NEXT:   systemc.cpp.assign [[V2]] = %arg1 : i32
   // CHECK-NEXT:   [[V3:%.+]] = systemc.cpp.member_access %arg0 arrow "b" : (!emitc.ptr<!emitc.opaque<"VBar">>) -> i32
-  // CHECK-NEXT:   systemc.cpp.assign [[V3]] = %arg2 : i32
+  // CHECK-NEXT:   systemc.cpp.assign [[V3]] = %arg1 : i32
   // CHECK-NEXT:   [[V4:%.+]] = systemc.cpp.member_access %arg0 arrow "eval" : (!emitc.ptr<!emitc.opaque<"VBar">>) -> (() -> ())
   // CHECK-NEXT:   func.call_indirect [[V4]]() : () -> ()
   // CHECK-NEXT:   [[V5:%.+]] = systemc.cpp.member_access %arg0 arrow "c" : (!emitc.ptr<!emitc.opaque<"VBar">>) -> i32
@@ -47,3 +47,24 @@ hw.module @Foo (%x: i32) -> (y: i32) {
   // CHECK-NEXT: hw.output {{%.+}} : i32
   hw.output %c : i32
 }
+
+// CHECK-LABEL: @ConstantAndUnusedPorts
+hw.module @ConstantAndUnusedPorts (%x: i32) -> () {
+  %c42_i32 = hw.constant 42 : i32
+  // CHECK:      interop.procedural.init cpp [[STATE:%.+]] : !emitc.ptr<!emitc.opaque<"VBar">> {
+  // CHECK-NEXT:   [[V0:%.+]] = systemc.cpp.new() : () -> !emitc.ptr<!emitc.opaque<"VBar">>
+  // CHECK-NEXT:   [[C:%.+]] = hw.constant 42 : i32
+  // CHECK-NEXT:   [[V1:%.+]] = systemc.cpp.member_access [[V0]] arrow "b" : (!emitc.ptr<!emitc.opaque<"VBar">>) -> i32
+  // CHECK-NEXT:   systemc.cpp.assign [[V1]] = [[C]] : i32
+  // CHECK-NEXT:   interop.return [[V0]] : !emitc.ptr<!emitc.opaque<"VBar">>
+  // CHECK-NEXT: }
+  // CHECK-NEXT: interop.procedural.update cpp [[[STATE]]] (%x) : [!emitc.ptr<!emitc.opaque<"VBar">>] (i32) -> () {
+  // CHECK-NEXT: ^bb0(%arg0: !emitc.ptr<!emitc.opaque<"VBar">>, %arg1: i32):
+  // CHECK-NEXT:   [[V2:%.+]] = systemc.cpp.member_access %arg0 arrow "a" : (!emitc.ptr<!emitc.opaque<"VBar">>) -> i32
+  // CHECK-NEXT:   systemc.cpp.assign [[V2]] = %arg1 : i32
+  // CHECK-NEXT:   [[V3:%.+]] = systemc.cpp.member_access %arg0 arrow "eval" : (!emitc.ptr<!emitc.opaque<"VBar">>) -> (() -> ())
+  // CHECK-NEXT:   func.call_indirect [[V3]]() : () -> ()
+  // CHECK-NEXT:   interop.return
+  // CHECK-NEXT: }
+  %c = systemc.interop.verilated "inst0" @Bar (a: %x: i32, b: %c42_i32: i32) -> (c: i32)
+}
@@ -1,7 +1,9 @@
 // RUN: circt-opt %s -test-chaining-problem -allow-unregistered-dialect
 // RUN: circt-opt %s -test-simplex-scheduler=with=ChainingProblem -allow-unregistered-dialect | FileCheck %s -check-prefix=SIMPLEX
+// RUN: circt-opt %s -test-list-scheduler=with=ChainingProblem -allow-unregistered-dialect | FileCheck %s -check-prefix=LIST
 
 // SIMPLEX-LABEL: adder_chain
+// LIST-LABEL: adder_chain
 func.func @adder_chain(%arg0 : i32, %arg1 : i32) -> i32 attributes {
   cycletime = 5.0, // only evaluated for scheduler test; ignored by the problem test!
   operatortypes = [
@@ -14,10 +16,13 @@ func.func @adder_chain(%arg0 : i32, %arg1 : i32) -> i32 attributes {
   %4 = arith.addi %3, %arg1 { opr = "add", problemStartTime = 1, problemStartTimeInCycle = 2.34 } : i32
   // SIMPLEX: return
   // SIMPLEX-SAME: simplexStartTime = 2
+  // LIST: return
+  // LIST-SAME: listStartTime = 2
   return { problemStartTime = 2, problemStartTimeInCycle = 0.0 } %4 : i32
 }
 
 // SIMPLEX-LABEL: multi_cycle
+// LIST-LABEL: multi_cycle
 func.func @multi_cycle(%arg0 : i32, %arg1 : i32) -> i32 attributes {
   cycletime = 5.0, // only evaluated for scheduler test; ignored by the problem test!
   operatortypes = [
@@ -31,10 +36,13 @@ func.func @multi_cycle(%arg0 : i32, %arg1 : i32) -> i32 attributes {
   %4 = arith.addi %3, %2 { opr = "add", problemStartTime = 3, problemStartTimeInCycle = 6.09 } : i32
   // SIMPLEX: return
   // SIMPLEX-SAME: simplexStartTime = 5
+  // LIST: return
+  // LIST-SAME: listStartTime = 5
   return { problemStartTime = 4, problemStartTimeInCycle = 0.0 } %4 : i32
 }
 
 // SIMPLEX-LABEL: mco_outgoing_delays
+// LIST-LABEL: mco_outgoing_delays
 func.func @mco_outgoing_delays(%arg0 : i32, %arg1 : i32) -> i32 attributes {
   cycletime = 5.0, // only evaluated for scheduler test; ignored by the problem test!
   operatortypes = [
@@ -58,5 +66,8 @@ func.func @mco_outgoing_delays(%arg0 : i32, %arg1 : i32) -> i32 attributes {
   // SIMPLEX: return
   // SIMPLEX-SAME: simplexStartTime = 8
   // SIMPLEX-SAME: simplexStartTimeInCycle = 1.000000e-01
+  // LIST: return
+  // LIST-SAME: listStartTime = 8
+  // LIST-SAME: listStartTimeInCycle = 1.000000e-01
   return { problemStartTime = 8, problemStartTimeInCycle = 0.1 } %2 : i32
 }
@@ -0,0 +1,47 @@
+// RUN: circt-opt %s -test-list-scheduler -allow-unregistered-dialect | FileCheck %s
+
+// CHECK-LABEL: full_load
+func.func @full_load(%a0 : i32, %a1 : i32, %a2 : i32, %a3 : i32, %a4 : i32, %a5 : i32) -> i32 attributes {
+  operatortypes = [
+    { name = "add", latency = 3, limit = 1 },
+    { name = "_0", latency = 0 }
+  ] } {
+  // CHECK: listStartTime = 0
+  %0 = arith.addi %a0, %a1 { opr = "add" } : i32
+  // CHECK: listStartTime = 1
+  %1 = arith.addi %a1, %a1 { opr = "add" } : i32
+  // CHECK: listStartTime = 2
+  %2 = arith.addi %a2, %a3 { opr = "add" } : i32
+  // CHECK: listStartTime = 3
+  %3 = arith.addi %a3, %a4 { opr = "add" } : i32
+  // CHECK: listStartTime = 4
+  %4 = arith.addi %a4, %a5 { opr = "add" } : i32
+  %5 = "barrier"(%0, %1, %2, %3, %4) { opr = "_0" } : (i32, i32, i32, i32, i32) -> i32
+  // CHECK: return
+  // CHECK-SAME: listStartTime = 7
+  return %5 : i32
+}
+
+// The slow additions are on longer paths, so they are placed first.
+// CHECK-LABEL: mobility
+func.func @mobility(%a0 : i32, %a1 : i32, %a2 : i32, %a3 : i32, %a4 : i32, %a5 : i32) -> i32 attributes {
+  operatortypes = [
+    { name = "slowAdd", latency = 3, limit = 2},
+    { name = "fastAdd", latency = 1, limit = 1},
+    { name = "_0", latency = 0 }
+  ] } {
+  // CHECK: listStartTime = 0
+  %0 = arith.addi %a0, %a1 { opr = "slowAdd" } : i32
+  // CHECK: listStartTime = 0
+  %1 = arith.addi %a1, %a1 { opr = "slowAdd" } : i32
+  // CHECK: listStartTime = 0
+  %2 = arith.addi %a2, %a3 { opr = "fastAdd" } : i32
+  // CHECK: listStartTime = 1
+  %3 = arith.addi %a3, %a4 { opr = "slowAdd" } : i32
+  // CHECK: listStartTime = 1
+  %4 = arith.addi %a4, %a5 { opr = "fastAdd" } : i32
+  %5 = "barrier"(%0, %1, %2, %3, %4) { opr = "_0" } : (i32, i32, i32, i32, i32) -> i32
+  // CHECK: return
+  // CHECK-SAME: listStartTime = 4
+  return %5 : i32
+}
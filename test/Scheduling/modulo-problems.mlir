@@ -1,5 +1,6 @@
 // RUN: circt-opt %s -test-modulo-problem -allow-unregistered-dialect
 // RUN: circt-opt %s -test-simplex-scheduler=with=ModuloProblem -allow-unregistered-dialect | FileCheck %s -check-prefix=SIMPLEX
+// RUN: circt-opt %s -test-simplex-scheduler="with=ModuloProblem ii-candidates=4" -allow-unregistered-dialect | FileCheck %s -check-prefix=SIMPLEX
 
 // SIMPLEX-LABEL: canis14_fig2
 // SIMPLEX-SAME: simplexInitiationInterval = 4
@@ -0,0 +1,21 @@
+// RUN: circt-opt %s -test-start-times-in-cycle -allow-unregistered-dialect | FileCheck %s
+
+// CHECK-LABEL: move_chain
+func.func @move_chain(%a0 : i32) -> i32 attributes {
+  operatortypes = [
+   { name = "add", latency = 0, incdelay = 2.0, outdelay = 2.0}
+  ] } {
+  // CHECK: startTimeInCycle = 0.000000e+00
+  %0 = arith.addi %a0, %a0 { opr = "add", problemStartTime = 0 } : i32
+  // Moving %1 to the next time step lets %2 chain onto it ...
+  // CHECK: startTimeInCycle = 0.000000e+00
+  %1 = arith.addi %0, %a0 { opr = "add", problemStartTime = 0, moveTo = 1 } : i32
+  // CHECK: startTimeInCycle = 2.000000e+00
+  %2 = arith.addi %1, %a0 { opr = "add", problemStartTime = 1 } : i32
+  // ... whereas moving %3 cuts it off from %2, but chains the return onto it.
+  // CHECK: startTimeInCycle = 0.000000e+00
+  %3 = arith.addi %2, %a0 { opr = "add", problemStartTime = 1, moveTo = 2 } : i32
+  // CHECK: return
+  // CHECK-SAME: startTimeInCycle = 2.000000e+00
+  return { problemStartTime = 2 } %3 : i32
+}
@@ -0,0 +1,63 @@
+// RUN: circt-translate %s --export-cpp-model --cpp-model-top=Counter | FileCheck %s
+
+// CHECK-LABEL: // Cycle-based model of the HW module 'Counter'.
+// CHECK: namespace circt_model {
+// CHECK: struct Counter {
+// CHECK-NEXT: // Inputs.
+// CHECK-NEXT: uint8_t clk = 0;
+// CHECK-NEXT: uint8_t rst = 0;
+// CHECK-NEXT: uint8_t en = 0;
+// CHECK-NEXT: uint32_t amount = 0;
+// CHECK-NEXT: // Outputs.
+// CHECK-NEXT: uint8_t count = 0;
+// CHECK-NEXT: uint8_t wrapped = 0;
+// CHECK-NEXT: uint64_t bits = 0;
+// CHECK-NEXT: // Registers.
+// CHECK-NEXT: uint8_t count_0 = 0;
+// CHECK-NEXT: uint32_t total = 0;
+
+// CHECK-LABEL: void eval() {
+// CHECK-NEXT: const uint64_t _v0 = (uint64_t(count_0) + UINT64_C(0x1)) & UINT64_C(0xff);
+// CHECK-NEXT: const uint64_t _v1 = (uint64_t(en) ? _v0 : uint64_t(count_0));
+// CHECK-NEXT: const uint64_t _v2 = uint64_t(uint64_t(count_0) == UINT64_C(0xff));
+// CHECK-NEXT: const uint64_t _v3 = (uint64_t(total) + uint64_t(amount)) & UINT64_C(0xffffffff);
+// CHECK-NEXT: const uint64_t _v4 = (uint64_t(total) >> 8) & UINT64_C(0xff);
+// CHECK-NEXT: const uint64_t _v5 = circt_model::shrs(_v4, UINT64_C(0x1), 8u);
+// CHECK-NEXT: const uint64_t _v6 = (uint64_t(count_0) << 0) | (uint64_t(count_0) << 8);
+// CHECK-NEXT: const uint64_t _v7 = (_v5 << 56) | (uint64_t(count_0) << 48) | (uint64_t(total) << 16) | (_v6 << 0);
+// CHECK-NEXT: count = uint64_t(count_0);
+// CHECK-NEXT: wrapped = _v2;
+// CHECK-NEXT: bits = _v7;
+// CHECK-NEXT: count_0_next = uint64_t(rst) ? UINT64_C(0x0) : _v1;
+// CHECK-NEXT: total_next = _v3;
+// CHECK-NEXT: }
+
+// CHECK-LABEL: void step() {
+// CHECK-NEXT: eval();
+// CHECK-NEXT: count_0 = count_0_next;
+// CHECK-NEXT: total = total_next;
+// CHECK-NEXT: eval();
+// CHECK-NEXT: }
+
+// CHECK: private:
+// CHECK-NEXT: uint8_t count_0_next = 0;
+// CHECK-NEXT: uint32_t total_next = 0;
+// CHECK-NEXT: };
+hw.module @Counter(%clk: i1, %rst: i1, %en: i1, %amount: i32) -> (count: i8, wrapped: i1, bits: i64) {
+  %c0_i8 = hw.constant 0 : i8
+  %c1_i8 = hw.constant 1 : i8
+  %c-1_i8 = hw.constant -1 : i8
+  %count = seq.compreg %next, %clk, %rst, %c0_i8 : i8
+  %total = seq.firreg %sum clock %clk : i32
+  %inc = comb.add %count, %c1_i8 : i8
+  %next = comb.mux %en, %inc, %count : i8
+  %wrapped = comb.icmp eq %count, %c-1_i8 : i8
+  %sum = comb.add %total, %amount : i32
+  %byte = comb.extract %total from 8 : (i32) -> i8
+  %half = comb.shrs %byte, %c1_i8 : i8
+  %twice = comb.replicate %count : (i8) -> i16
+  %bits = comb.concat %half, %count, %total, %twice : i8, i8, i32, i16
+  hw.output %count, %wrapped, %bits : i8, i1, i64
+}
+
+hw.module @Other() {}
@@ -0,0 +1,21 @@
+// RUN: circt-translate %s --export-cpp-model --cpp-model-top=Loop --split-input-file --verify-diagnostics
+
+hw.module @Loop(%a: i1) -> (b: i1) {
+  // expected-error @+1 {{combinational loop in cycle-based model}}
+  %0 = comb.xor %a, %1 : i1
+  %1 = comb.and %a, %0 : i1
+  hw.output %1 : i1
+}
+
+// -----
+
+// expected-error @+1 {{port 'a' of type i128 is not supported by the cycle-based model}}
+hw.module @Loop(%a: i128) {}
+
+// -----
+
+hw.module @Child() {}
+hw.module @Loop() {
+  // expected-error @+1 {{instances are not supported by the cycle-based model, flatten the design first}}
+  hw.instance "child" @Child() -> ()
+}
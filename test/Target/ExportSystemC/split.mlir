@@ -0,0 +1,30 @@
+// RUN: rm -rf %t
+// RUN: circt-translate %s --export-split-systemc --export-dir=%t
+// RUN: FileCheck %s --check-prefix=SUBMODULE --input-file=%t/submodule.h
+// RUN: FileCheck %s --check-prefix=TOP --input-file=%t/top.h
+
+// SUBMODULE: #ifndef {{.*}}SUBMODULE_H
+// SUBMODULE: #include <systemc.h>
+// SUBMODULE: SC_MODULE(submodule) {
+// SUBMODULE-NEXT: sc_in<sc_uint<32>> in0;
+// SUBMODULE-NEXT: sc_out<sc_uint<32>> out0;
+// SUBMODULE-NEXT: };
+// SUBMODULE-NOT: SC_MODULE
+// SUBMODULE: #endif
+
+// TOP: #ifndef {{.*}}TOP_H
+// TOP: #include <systemc.h>
+// TOP: SC_MODULE(top) {
+// TOP-NEXT: sc_in<bool> port0;
+// TOP-NEXT: submodule submoduleInstance;
+// TOP-NEXT: };
+// TOP-NOT: SC_MODULE
+// TOP: #endif
+
+emitc.include <"systemc.h">
+
+systemc.module @submodule (%in0: !systemc.in<!systemc.uint<32>>, %out0: !systemc.out<!systemc.uint<32>>) {}
+
+systemc.module @top (%port0: !systemc.in<i1>) {
+  %submoduleInstance = systemc.instance.decl @submodule : !systemc.module<submodule(in0: !systemc.in<!systemc.uint<32>>, out0: !systemc.out<!systemc.uint<32>>)>
+}
@@ -0,0 +1,69 @@
+// RUN: circt-opt -split-input-file --partition-memref %s | FileCheck %s
+// RUN: circt-opt -split-input-file --partition-memref="scheme=block factor=4" %s | FileCheck %s --check-prefix=BLOCK
+
+// The loop is unrolled by two, hence the even and odd elements are accessed by
+// separate loads, which are redirected to their own banks.
+
+// CHECK-LABEL: func @cyclic
+// CHECK:         %[[BANK0:.+]] = memref.alloc() : memref<4x4xi32>
+// CHECK-NEXT:    %[[BANK1:.+]] = memref.alloc() : memref<4x4xi32>
+// CHECK:         affine.for %[[I:.+]] = 0 to 8 step 2 {
+// CHECK-NEXT:      affine.load %[[BANK0]][%{{.+}}, %[[I]] floordiv 2]
+// CHECK-NEXT:      affine.load %[[BANK1]][%{{.+}}, (%[[I]] + 1) floordiv 2]
+// CHECK-NOT:     memref<4x8xi32>
+// BLOCK-LABEL: func @cyclic
+// BLOCK:         memref.alloc() : memref<4x8xi32>
+func.func @cyclic(%j : index) -> i32 {
+  %mem = memref.alloc() : memref<4x8xi32>
+  %c0 = arith.constant 0 : i32
+  %sum = affine.for %i = 0 to 8 step 2 iter_args(%acc = %c0) -> i32 {
+    %0 = affine.load %mem[%j, %i] : memref<4x8xi32>
+    %1 = affine.load %mem[%j, %i + 1] : memref<4x8xi32>
+    %2 = arith.addi %0, %1 : i32
+    %3 = arith.addi %acc, %2 : i32
+    affine.yield %3 : i32
+  }
+  return %sum : i32
+}
+
+// -----
+
+// The stores touch the first and the last quarter of the memory, hence a
+// cyclic partitioning does not apply, but a block partitioning does.
+
+// CHECK-LABEL: func @block
+// CHECK:         %[[BANK0:.+]] = memref.alloca() : memref<4xi32>
+// CHECK-NEXT:    %[[BANK1:.+]] = memref.alloca() : memref<4xi32>
+// CHECK:           affine.store %{{.+}}, %[[BANK0]][%{{.+}}]
+// CHECK-NEXT:      affine.store %{{.+}}, %[[BANK1]][%{{.+}} + 2]
+// BLOCK-LABEL: func @block
+// BLOCK:         %[[BANK0:.+]] = memref.alloca() : memref<2xi32>
+// BLOCK-NEXT:    memref.alloca() : memref<2xi32>
+// BLOCK-NEXT:    memref.alloca() : memref<2xi32>
+// BLOCK-NEXT:    %[[BANK3:.+]] = memref.alloca() : memref<2xi32>
+// BLOCK:         affine.for %[[I:.+]] = 0 to 2 {
+// BLOCK-NEXT:      affine.store %{{.+}}, %[[BANK0]][%[[I]]]
+// BLOCK-NEXT:      affine.store %{{.+}}, %[[BANK3]][%[[I]]]
+// BLOCK-NOT:     memref<8xi32>
+func.func @block(%v : i32) {
+  %mem = memref.alloca() : memref<8xi32>
+  affine.for %i = 0 to 2 {
+    affine.store %v, %mem[%i] : memref<8xi32>
+    affine.store %v, %mem[%i + 6] : memref<8xi32>
+  }
+  return
+}
+
+// -----
+
+// Memories with accesses to unknown banks are left untouched.
+
+// CHECK-LABEL: func @unknown
+// CHECK:         memref.alloc() : memref<8xi32>
+// CHECK-NOT:     memref.alloc
+func.func @unknown(%i : index) -> i32 {
+  %mem = memref.alloc() : memref<8xi32>
+  %0 = affine.load %mem[%i] : memref<8xi32>
+  memref.dealloc %mem : memref<8xi32>
+  return %0 : i32
+}
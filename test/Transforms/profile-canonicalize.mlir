@@ -0,0 +1,16 @@
+// RUN: circt-opt --profile-canonicalize %s | FileCheck %s
+// RUN: circt-opt --profile-canonicalize %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=REPORT
+
+// CHECK-LABEL: hw.module @Foo
+// CHECK-NEXT: %0 = comb.or %a, %b : i4
+// CHECK-NEXT: hw.output %0, %a
+hw.module @Foo(%a: i4, %b: i4) -> (x: i4, y: i4) {
+  %c0_i4 = hw.constant 0 : i4
+  %0 = comb.or %a, %b : i4
+  %1 = comb.or %a, %c0_i4 : i4
+  hw.output %0, %1 : i4, i4
+}
+
+// REPORT: Pattern Profiling Report
+// REPORT: Time (s) {{.*}} Attempts {{.*}} Successes {{.*}} Pattern (root)
+// REPORT: <anonymous> (comb.or)
@@ -0,0 +1,21 @@
+// RUN: circt-as %s -o - | circt-dis --module=Bar,Top | FileCheck %s
+// RUN: circt-as %s -o - | not circt-dis --module=Baz 2>&1 | FileCheck %s --check-prefix=ERROR
+
+// CHECK-NOT:   firrtl.circuit
+// CHECK-NOT:   @Foo
+// CHECK-LABEL: firrtl.module private @Bar(in %in: !firrtl.uint<8>) {
+// CHECK-NEXT:  }
+// CHECK-LABEL: firrtl.module @Top(in %in: !firrtl.uint<8>) {
+// CHECK-NEXT:    %bar_in = firrtl.instance bar @Bar(in in: !firrtl.uint<8>)
+// CHECK-NOT:   @Foo
+
+// ERROR: error: unknown module 'Baz'
+
+firrtl.circuit "Top" {
+  firrtl.module private @Foo(in %in : !firrtl.uint<8>) {}
+  firrtl.module private @Bar(in %in : !firrtl.uint<8>) {}
+  firrtl.module @Top(in %in : !firrtl.uint<8>) {
+    %bar_in = firrtl.instance bar @Bar(in in : !firrtl.uint<8>)
+    firrtl.strictconnect %bar_in, %in : !firrtl.uint<8>
+  }
+}
@@ -0,0 +1,20 @@
+// RUN: circt-reduce %s --test-pipeline='firrtl.circuit(firrtl-check-comb-cycles)' --test-match="detected combinational cycle" --keep-best=0 --include annotation-remover | FileCheck %s
+// RUN: not circt-reduce %s --test-pipeline='firrtl.circuit(firrtl-check-comb-cycles)' --test-match="some other error" --keep-best=0 2>&1 | FileCheck %s --check-prefix=NOMATCH
+
+// NOMATCH: error: input is not interesting
+
+// CHECK-LABEL: firrtl.module @Foo
+// CHECK-NEXT: %y = firrtl.wire : !firrtl.uint<1>
+// CHECK-NEXT: %z = firrtl.wire : !firrtl.uint<1>
+// CHECK-NEXT: firrtl.connect %z, %y
+// CHECK-NEXT: firrtl.connect %y, %z
+// CHECK-NEXT: firrtl.connect %d, %z
+firrtl.circuit "Foo" {
+  firrtl.module @Foo(out %d: !firrtl.uint<1>) {
+    %y = firrtl.wire {annotations = [{a}]} : !firrtl.uint<1>
+    %z = firrtl.wire {annotations = [{b}]} : !firrtl.uint<1>
+    firrtl.connect %z, %y : !firrtl.uint<1>, !firrtl.uint<1>
+    firrtl.connect %y, %z : !firrtl.uint<1>, !firrtl.uint<1>
+    firrtl.connect %d, %z : !firrtl.uint<1>, !firrtl.uint<1>
+  }
+}
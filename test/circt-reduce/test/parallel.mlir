@@ -0,0 +1,18 @@
+// UNSUPPORTED: system-windows
+//   See https://github.com/llvm/circt/issues/4129
+// RUN: circt-reduce %s --test %S.sh --test-arg cat --test-arg "%keptWire = firrtl.wire {annotations = \[{a}\]}" --keep-best=0 --include annotation-remover --min-chunks=4 -j 4 | FileCheck %s
+
+// Chunks tested concurrently still only remove the uninteresting annotations.
+firrtl.circuit "Foo" {
+  // CHECK-LABEL: firrtl.module @Foo
+  firrtl.module @Foo() {
+    // CHECK-NEXT: %wire0 = firrtl.wire : !firrtl.uint<1>
+    // CHECK-NEXT: %keptWire = firrtl.wire {annotations = [{a}]}
+    // CHECK-NEXT: %wire1 = firrtl.wire : !firrtl.uint<1>
+    // CHECK-NEXT: %wire2 = firrtl.wire : !firrtl.uint<1>
+    %wire0 = firrtl.wire {annotations = [{a}]} : !firrtl.uint<1>
+    %keptWire = firrtl.wire {annotations = [{a}]} : !firrtl.uint<1>
+    %wire1 = firrtl.wire {annotations = [{b}]} : !firrtl.uint<1>
+    %wire2 = firrtl.wire {annotations = [{c}]} : !firrtl.uint<1>
+  }
+}
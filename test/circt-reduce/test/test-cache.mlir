@@ -0,0 +1,15 @@
+// UNSUPPORTED: system-windows
+//   See https://github.com/llvm/circt/issues/4129
+// RUN: rm -f %t.cache
+// RUN: circt-reduce %s --test %S.sh --test-arg cat --test-arg "%anotherWire = firrtl.wire  :" --keep-best=0 --include annotation-remover --test-cache %t.cache 2>&1 | FileCheck %s --check-prefix=FIRST
+// RUN: circt-reduce %s --test %S.sh --test-arg cat --test-arg "%anotherWire = firrtl.wire  :" --keep-best=0 --include annotation-remover --test-cache %t.cache 2>&1 | FileCheck %s --check-prefix=SECOND
+
+// FIRST: Answered {{[0-9]+}} tests from the cache
+// SECOND-NOT: Answered 0 tests
+// SECOND: Answered {{[1-9][0-9]*}} tests from the cache
+firrtl.circuit "Foo" {
+  firrtl.module @Foo() {
+    %oneWire = firrtl.wire : !firrtl.uint<1>
+    %anotherWire = firrtl.wire {annotations = [{a}]} : !firrtl.uint<1>
+  }
+}
@@ -0,0 +1,79 @@
+// RUN: circt-schedule-bench %s | FileCheck %s
+// RUN: circt-schedule-bench %s -schedulers=simplex | FileCheck %s --check-prefix=SIMPLEX
+
+// CHECK:      "instance": "chain",
+// CHECK-NEXT: "problem": "Problem",
+// CHECK-NEXT: "operations": 3,
+// CHECK:      "scheduler": "asap",
+// CHECK-NEXT: "status": "ok",
+// CHECK-NEXT: "objective": 4,
+// CHECK:      "scheduler": "simplex",
+// CHECK-NEXT: "status": "ok",
+// CHECK-NEXT: "objective": 4,
+
+// SIMPLEX:     "instance": "chain",
+// SIMPLEX-NOT: "scheduler": "asap",
+// SIMPLEX:     "scheduler": "simplex",
+ssp.instance "chain" of "Problem" {
+  library {
+    operator_type @unit [latency<1>]
+    operator_type @_3 [latency<3>]
+  }
+  graph {
+    %0 = operation<@unit>()
+    %1 = operation<@_3>(%0)
+    operation<@unit>(%1)
+  }
+}
+
+// CHECK:      "instance": "full_load",
+// CHECK-NEXT: "problem": "SharedOperatorsProblem",
+// CHECK:      "scheduler": "list",
+// CHECK-NEXT: "status": "ok",
+// CHECK-NEXT: "objective": 7,
+// CHECK:      "scheduler": "simplex",
+// CHECK-NEXT: "status": "ok",
+// CHECK-NEXT: "objective": 7,
+
+// SIMPLEX:     "instance": "full_load",
+// SIMPLEX-NOT: "scheduler": "list",
+// SIMPLEX:     "scheduler": "simplex",
+ssp.instance "full_load" of "SharedOperatorsProblem" {
+  library {
+    operator_type @add [latency<3>, limit<1>]
+    operator_type @_0 [latency<0>]
+  }
+  graph {
+    %0 = operation<@add>()
+    %1 = operation<@add>()
+    %2 = operation<@add>()
+    %3 = operation<@add>()
+    %4 = operation<@add>()
+    operation<@_0>(%0, %1, %2, %3, %4)
+  }
+}
+
+// CHECK:      "instance": "canis14_fig2",
+// CHECK-NEXT: "problem": "ModuloProblem",
+// CHECK:      "scheduler": "simplex",
+// CHECK-NEXT: "status": "ok",
+// CHECK-NEXT: "objective": {{[0-9]+}},
+// CHECK-NEXT: "ii": 3,
+// CHECK:      "scheduler": "simplex-parallel",
+// CHECK-NEXT: "status": "ok",
+// CHECK-NEXT: "objective": {{[0-9]+}},
+// CHECK-NEXT: "ii": 3,
+ssp.instance "canis14_fig2" of "ModuloProblem" {
+  library {
+    operator_type @MemPort [latency<1>, limit<1>]
+    operator_type @Add [latency<1>]
+    operator_type @Implicit [latency<0>]
+  }
+  graph {
+    %0 = operation<@MemPort> @load_A(@store_A [dist<1>])
+    %1 = operation<@MemPort> @load_B()
+    %2 = operation<@Add> @add(%0, %1)
+    operation<@MemPort> @store_A(%2)
+    operation<@Implicit> @last(@store_A)
+  }
+}
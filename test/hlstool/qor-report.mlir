@@ -0,0 +1,18 @@
+// RUN: hlstool %s --dynamic-hw --buffering-strategy=all --buffer-size=2 --ir --qor-report 2>&1 >/dev/null | FileCheck %s
+
+// CHECK: hlstool quality-of-results report
+// CHECK: Handshake operations: {{[0-9]+}}
+// CHECK: Buffer slots: {{[1-9][0-9]*}}
+// CHECK: Critical cycle latency: {{[1-9][0-9]*}}
+// CHECK: HW modules: {{[1-9][0-9]*}}
+// CHECK: Execution time report
+
+func.func @sum(%arg0: memref<8xi32>) -> i32 {
+  %zero = arith.constant 0 : i32
+  %result = affine.for %i = 0 to 8 iter_args(%iter = %zero) -> (i32) {
+    %a = affine.load %arg0[%i] : memref<8xi32>
+    %add = arith.addi %iter, %a : i32
+    affine.yield %add : i32
+  }
+  return %result : i32
+}
@@ -0,0 +1,21 @@
+// RUN: hlstool %s --static --ir --ir-output-level=1 | FileCheck %s --check-prefix=PIPELINE
+// RUN: hlstool %s --static --ir --ir-output-level=2 | FileCheck %s --check-prefix=CALYX
+
+// PIPELINE-LABEL: func.func @dot
+// PIPELINE:         pipeline.while II = {{[0-9]+}} trip_count = 64
+// PIPELINE-NOT:     affine.for
+
+// CALYX:            calyx.component @dot
+// CALYX-NOT:        pipeline.while
+
+func.func @dot(%arg0: memref<64xi32>, %arg1: memref<64xi32>) -> i32 {
+  %zero = arith.constant 0 : i32
+  %result = affine.for %i = 0 to 64 iter_args(%iter = %zero) -> (i32) {
+    %a = affine.load %arg0[%i] : memref<64xi32>
+    %b = affine.load %arg1[%i] : memref<64xi32>
+    %mul = arith.muli %a, %b : i32
+    %add = arith.addi %iter, %mul : i32
+    affine.yield %add : i32
+  }
+  return %result : i32
+}
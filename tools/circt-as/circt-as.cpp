@@ -6,10 +6,13 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// Convert MLIR textual input to MLIR bytecode (MLIRBC).
+// Convert MLIR textual input to MLIR bytecode (MLIRBC).  FIRRTL input (.fir) is
+// also accepted, which allows a .fir file to be parsed once and handed to later
+// tools as bytecode.
 //
 //===----------------------------------------------------------------------===//
 
+#include "circt/Dialect/FIRRTL/FIRParser.h"
 #include "circt/InitAllDialects.h"
 #include "circt/Support/Version.h"
 #include "mlir/Bytecode/BytecodeWriter.h"
@@ -23,6 +26,7 @@
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Parser/Parser.h"
 #include "mlir/Support/FileUtilities.h"
+#include "mlir/Support/Timing.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/SourceMgr.h"
@@ -38,9 +42,9 @@ using namespace circt;
 static constexpr const char toolName[] = "circt-as";
 static cl::OptionCategory mainCategory("circt-as Options");
 
-static cl::opt<std::string> inputFilename(cl::Positional,
-                                          cl::desc("<input .mlir file>"),
-                                          cl::init("-"), cl::cat(mainCategory));
+static cl::opt<std::string>
+    inputFilename(cl::Positional, cl::desc("<input .mlir or .fir file>"),
+                  cl::init("-"), cl::cat(mainCategory));
 
 static cl::opt<std::string> outputFilename("o",
                                            cl::desc("Override output filename"),
@@ -86,7 +90,8 @@ static LogicalResult execute(MLIRContext &context) {
     if (input == "-")
       outputFilename = "-";
     else {
-      input.consume_back(".mlir");
+      if (!input.consume_back(".mlir"))
+        input.consume_back(".fir");
       outputFilename = (input + ".mlirbc").str();
     }
   }
@@ -104,14 +109,24 @@ static LogicalResult execute(MLIRContext &context) {
   SourceMgr srcMgr;
   SourceMgrDiagnosticHandler handler(srcMgr, &context);
 
-  LeakModule leakMod{
-      parseSourceFile<ModuleOp>(inputFilename, srcMgr, &context)};
+  LeakModule leakMod;
   auto &module = leakMod.module;
+  if (StringRef(inputFilename).endswith(".fir")) {
+    auto input = openInputFile(inputFilename, &err);
+    if (!input)
+      return emitError(err);
+    srcMgr.AddNewSourceBuffer(std::move(input), llvm::SMLoc());
+    mlir::TimingScope ts;
+    module = firrtl::importFIRFile(srcMgr, &context, ts);
+  } else {
+    module = parseSourceFile<ModuleOp>(inputFilename, srcMgr, &context);
+  }
   if (!module)
     return failure();
 
   // Write bytecode.
-  writeBytecodeToFile(*module, output->os());
+  writeBytecodeToFile(*module, output->os(),
+                      mlir::BytecodeWriterConfig(getCirctVersion()));
   output->keep();
 
   return success();
@@ -136,7 +151,8 @@ int main(int argc, char **argv) {
   // Hide default LLVM options, other than for this tool.
   cl::HideUnrelatedOptions({&mainCategory, &llvm::getColorCategory()});
 
-  cl::ParseCommandLineOptions(argc, argv, "CIRCT .mlir -> .mlirbc assembler\n");
+  cl::ParseCommandLineOptions(argc, argv,
+                              "CIRCT .mlir/.fir -> .mlirbc assembler\n");
 
   MLIRContext context(registry);
   exit(failed(execute(context)));
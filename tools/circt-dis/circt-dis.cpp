@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "circt/Dialect/FIRRTL/FIREmitter.h"
+#include "circt/Dialect/HW/HWOpInterfaces.h"
 #include "circt/InitAllDialects.h"
 #include "circt/Support/Version.h"
 #include "mlir/Bytecode/BytecodeReader.h"
@@ -23,6 +25,7 @@
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Parser/Parser.h"
 #include "mlir/Support/FileUtilities.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/SourceMgr.h"
@@ -47,6 +50,17 @@ static cl::opt<std::string> outputFilename("o",
                                            cl::value_desc("filename"),
                                            cl::cat(mainCategory));
 
+static cl::opt<bool>
+    emitFIR("emit-fir", cl::desc("Emit FIRRTL (.fir) instead of .mlir"),
+            cl::init(false), cl::cat(mainCategory));
+
+static cl::list<std::string>
+    moduleNames("module",
+                cl::desc("Only print the hw and firrtl modules with the given "
+                         "names"),
+                cl::CommaSeparated, cl::value_desc("name"),
+                cl::cat(mainCategory));
+
 /// Print error and return failure.
 static LogicalResult emitError(const Twine &err) {
   WithColor::error(errs(), toolName) << err << "\n";
@@ -69,10 +83,13 @@ static LogicalResult execute(MLIRContext &context) {
       outputFilename = "-";
     else {
       input.consume_back(".mlirbc");
-      outputFilename = (input + ".mlir").str();
+      outputFilename = (input + (emitFIR ? ".fir" : ".mlir")).str();
     }
   }
 
+  if (emitFIR && !moduleNames.empty())
+    return emitError("-module cannot be combined with -emit-fir");
+
   // Open output for writing, early error if problem.
   std::string err;
   auto output = openOutputFile(outputFilename, &err);
@@ -89,8 +106,31 @@ static LogicalResult execute(MLIRContext &context) {
   if (!module)
     return failure();
 
-  // Write MLIR.
-  module->print(output->os());
+  // Write only the requested modules, in the order in which they appear in the
+  // input. The bodies of the other modules are not printed.
+  if (!moduleNames.empty()) {
+    llvm::StringSet<> remainingNames;
+    for (auto &name : moduleNames)
+      remainingNames.insert(name);
+    module->walk<WalkOrder::PreOrder>([&](Operation *op) {
+      auto hwModule = dyn_cast<hw::HWModuleLike>(op);
+      if (!hwModule)
+        return WalkResult::advance();
+      if (remainingNames.erase(hwModule.moduleName())) {
+        hwModule->print(output->os());
+        output->os() << "\n";
+      }
+      return WalkResult::skip();
+    });
+    if (!remainingNames.empty())
+      return emitError("unknown module '" + remainingNames.begin()->getKey() +
+                       "'");
+  } else if (emitFIR) {
+    if (failed(firrtl::exportFIRFile(*module, output->os())))
+      return failure();
+  } else {
+    module->print(output->os());
+  }
   output->keep();
 
   return success();
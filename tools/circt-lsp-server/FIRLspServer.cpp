@@ -0,0 +1,483 @@
+//===- FIRLspServer.cpp - FIRRTL Language Server --------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a language server for `.fir` files, which provides
+// navigation between module definitions and instances. Like the FIRRTL parser,
+// which defers parsing module bodies, the server only scans module headers
+// when a document is opened and scans a module body on demand.
+//
+//===----------------------------------------------------------------------===//
+
+#include "FIRLspServer.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <iostream>
+
+using namespace llvm;
+using namespace mlir;
+using namespace circt;
+
+//===----------------------------------------------------------------------===//
+// Document Index
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// An instance within the body of a module.
+struct FIRInstance {
+  StringRef name;
+  StringRef moduleName;
+  unsigned line;
+  unsigned nameColumn;
+  unsigned moduleColumn;
+};
+
+/// A module of a document. The instances in its body are only collected the
+/// first time they are needed.
+struct FIRModule {
+  StringRef name;
+  StringRef keyword;
+  /// The position of the module name.
+  unsigned line;
+  unsigned column;
+  /// The byte offset of the header line, and the offset and line at which the
+  /// next module or the end of the document begins.
+  size_t begin;
+  size_t end;
+  unsigned endLine;
+  Optional<std::vector<FIRInstance>> instances;
+};
+
+/// An open `.fir` document.
+class FIRDocument {
+public:
+  explicit FIRDocument(std::string text) : contents(std::move(text)) {
+    scanHeaders();
+  }
+
+  MutableArrayRef<FIRModule> getModules() { return modules; }
+
+  /// Return the module with the given name, if any.
+  FIRModule *lookupModule(StringRef name) {
+    auto it = moduleIndices.find(name);
+    return it == moduleIndices.end() ? nullptr : &modules[it->second];
+  }
+
+  /// Return the instances in the body of `module`, scanning it if necessary.
+  ArrayRef<FIRInstance> getInstances(FIRModule &module);
+
+  /// Return the word at the given position and the column it starts at.
+  Optional<std::pair<StringRef, unsigned>> getWordAt(unsigned line,
+                                                     unsigned column);
+
+private:
+  void scanHeaders();
+  StringRef getLine(unsigned line);
+
+  std::string contents;
+  std::vector<FIRModule> modules;
+  StringMap<unsigned> moduleIndices;
+};
+
+} // namespace
+
+/// Return true if `c` may be part of a FIRRTL identifier.
+static bool isIdentifierChar(char c) {
+  return isAlnum(c) || c == '_' || c == '$' || c == '`';
+}
+
+/// Return the offset of the first character of `text` that is not a space or
+/// tab.
+static size_t getIndentation(StringRef text) {
+  return std::min(text.find_first_not_of(" \t"), text.size());
+}
+
+/// Split the next identifier off of `rest`, skipping leading whitespace.
+/// Returns the identifier and its offset within `line`.
+static std::pair<StringRef, size_t> lexIdentifier(StringRef line,
+                                                  StringRef &rest) {
+  rest = rest.ltrim(" \t");
+  size_t length = 0;
+  while (length < rest.size() && isIdentifierChar(rest[length]))
+    ++length;
+  StringRef ident = rest.take_front(length);
+  size_t offset = rest.data() - line.data();
+  rest = rest.drop_front(length);
+  return {ident, offset};
+}
+
+void FIRDocument::scanHeaders() {
+  // Modules are declared one per line, such that only the first word on every
+  // line has to be looked at. Everything following a module header up to the
+  // next one belongs to that module.
+  StringRef text = contents;
+  size_t offset = 0;
+  for (unsigned lineNo = 0; offset < text.size(); ++lineNo) {
+    size_t lineEnd = text.find('\n', offset);
+    if (lineEnd == StringRef::npos)
+      lineEnd = text.size();
+    StringRef line = text.slice(offset, lineEnd);
+    StringRef rest = line.drop_front(getIndentation(line));
+    StringRef keyword = rest.take_while([](char c) { return isAlpha(c); });
+    rest = rest.drop_front(keyword.size());
+    if ((keyword == "module" || keyword == "extmodule" ||
+         keyword == "intmodule") &&
+        !rest.empty() && isSpace(rest.front())) {
+      auto [name, column] = lexIdentifier(line, rest);
+      if (!name.empty()) {
+        if (!modules.empty())
+          modules.back().end = offset;
+        moduleIndices.try_emplace(name, modules.size());
+        modules.push_back({name, keyword, lineNo, unsigned(column), offset,
+                           text.size(), 0, None});
+      }
+    }
+    offset = lineEnd + 1;
+    if (!modules.empty())
+      modules.back().endLine = lineNo + 1;
+  }
+}
+
+ArrayRef<FIRInstance> FIRDocument::getInstances(FIRModule &module) {
+  if (module.instances)
+    return *module.instances;
+  module.instances.emplace();
+  StringRef body = StringRef(contents).slice(module.begin, module.end);
+  unsigned lineNo = module.line;
+  for (StringRef rest = body; !rest.empty(); ++lineNo) {
+    StringRef line;
+    std::tie(line, rest) = rest.split('\n');
+    StringRef tokens = line.drop_front(getIndentation(line));
+    if (!tokens.consume_front("inst") || tokens.empty() ||
+        !isSpace(tokens.front()))
+      continue;
+    auto [name, nameColumn] = lexIdentifier(line, tokens);
+    auto [of, ofColumn] = lexIdentifier(line, tokens);
+    auto [moduleName, moduleColumn] = lexIdentifier(line, tokens);
+    if (name.empty() || of != "of" || moduleName.empty())
+      continue;
+    module.instances->push_back({name, moduleName, lineNo,
+                                 unsigned(nameColumn), unsigned(moduleColumn)});
+  }
+  return *module.instances;
+}
+
+StringRef FIRDocument::getLine(unsigned line) {
+  // Start at the module containing the line, which bounds the number of lines
+  // to skip.
+  size_t offset = 0;
+  unsigned lineNo = 0;
+  auto it = llvm::upper_bound(modules, line, [](unsigned lineNo, auto &mod) {
+    return lineNo < mod.line;
+  });
+  if (it != modules.begin()) {
+    offset = std::prev(it)->begin;
+    lineNo = std::prev(it)->line;
+  }
+  StringRef text = contents;
+  for (; lineNo < line; ++lineNo) {
+    offset = text.find('\n', offset);
+    if (offset == StringRef::npos)
+      return {};
+    ++offset;
+  }
+  return text.drop_front(offset).split('\n').first;
+}
+
+Optional<std::pair<StringRef, unsigned>>
+FIRDocument::getWordAt(unsigned line, unsigned column) {
+  StringRef text = getLine(line);
+  if (column > text.size())
+    return None;
+  size_t begin = column, end = column;
+  while (begin > 0 && isIdentifierChar(text[begin - 1]))
+    --begin;
+  while (end < text.size() && isIdentifierChar(text[end]))
+    ++end;
+  if (begin == end)
+    return None;
+  return std::make_pair(text.slice(begin, end), unsigned(begin));
+}
+
+//===----------------------------------------------------------------------===//
+// Protocol
+//===----------------------------------------------------------------------===//
+
+/// Return an LSP range on a single line.
+static json::Object getRange(unsigned line, unsigned column, size_t length) {
+  return json::Object{
+      {"start", json::Object{{"line", line}, {"character", column}}},
+      {"end", json::Object{{"line", line}, {"character", column + length}}}};
+}
+
+/// Return an LSP location on a single line.
+static json::Object getLocation(StringRef uri, unsigned line, unsigned column,
+                                size_t length) {
+  return json::Object{{"uri", uri}, {"range", getRange(line, column, length)}};
+}
+
+namespace {
+/// The server state across all open documents.
+class FIRLspServer {
+public:
+  /// Handle a single message. Returns false once the client has exited.
+  bool handleMessage(const json::Object &message);
+
+  bool hasShutDown() const { return shutDown; }
+
+private:
+  void handleNotification(StringRef method, const json::Object *params);
+  Expected<json::Value> handleRequest(StringRef method,
+                                      const json::Object *params);
+
+  /// Return the document and the word under the cursor of a position request.
+  std::pair<FIRDocument *, Optional<std::pair<StringRef, unsigned>>>
+  getCursor(const json::Object *params, StringRef &uri);
+
+  json::Value getDefinition(const json::Object *params);
+  json::Value getReferences(const json::Object *params);
+  json::Value getDocumentSymbols(const json::Object *params);
+  json::Value getWorkspaceSymbols(const json::Object *params);
+
+  std::map<std::string, std::unique_ptr<FIRDocument>> documents;
+  bool shutDown = false;
+};
+} // namespace
+
+/// Write a message to the client.
+static void sendMessage(json::Value message) {
+  std::string body;
+  raw_string_ostream(body) << message;
+  outs() << "Content-Length: " << body.size() << "\r\n\r\n" << body;
+  outs().flush();
+}
+
+bool FIRLspServer::handleMessage(const json::Object &message) {
+  auto method = message.getString("method");
+  const auto *params = message.getObject("params");
+  const auto *id = message.get("id");
+  if (!method)
+    return true; // Responses to requests of the server are not expected.
+  if (*method == "exit")
+    return false;
+  if (!id) {
+    handleNotification(*method, params);
+    return true;
+  }
+
+  json::Object response{{"jsonrpc", "2.0"}, {"id", *id}};
+  auto result = handleRequest(*method, params);
+  if (result) {
+    response["result"] = std::move(*result);
+  } else {
+    response["error"] = json::Object{{"code", -32601},
+                                     {"message", toString(result.takeError())}};
+  }
+  sendMessage(std::move(response));
+  return true;
+}
+
+void FIRLspServer::handleNotification(StringRef method,
+                                      const json::Object *params) {
+  if (!params)
+    return;
+  const auto *textDocument = params->getObject("textDocument");
+  if (!textDocument)
+    return;
+  auto uri = textDocument->getString("uri");
+  if (!uri)
+    return;
+
+  if (method == "textDocument/didOpen") {
+    if (auto text = textDocument->getString("text"))
+      documents[uri->str()] = std::make_unique<FIRDocument>(text->str());
+  } else if (method == "textDocument/didChange") {
+    // Documents are synchronized in full, hence the last change holds the
+    // entire new contents.
+    const auto *changes = params->getArray("contentChanges");
+    if (!changes || changes->empty())
+      return;
+    if (const auto *change = changes->back().getAsObject())
+      if (auto text = change->getString("text"))
+        documents[uri->str()] = std::make_unique<FIRDocument>(text->str());
+  } else if (method == "textDocument/didClose") {
+    documents.erase(uri->str());
+  }
+}
+
+Expected<json::Value> FIRLspServer::handleRequest(StringRef method,
+                                                  const json::Object *params) {
+  if (method == "initialize")
+    return json::Object{
+        {"capabilities",
+         json::Object{{"textDocumentSync", 1},
+                      {"definitionProvider", true},
+                      {"referencesProvider", true},
+                      {"documentSymbolProvider", true},
+                      {"workspaceSymbolProvider", true}}},
+        {"serverInfo", json::Object{{"name", "circt-lsp-server (FIRRTL)"}}}};
+  if (method == "shutdown") {
+    shutDown = true;
+    return nullptr;
+  }
+  if (method == "textDocument/definition")
+    return getDefinition(params);
+  if (method == "textDocument/references")
+    return getReferences(params);
+  if (method == "textDocument/documentSymbol")
+    return getDocumentSymbols(params);
+  if (method == "workspace/symbol")
+    return getWorkspaceSymbols(params);
+  return createStringError(inconvertibleErrorCode(),
+                           "method not found: " + method);
+}
+
+std::pair<FIRDocument *, Optional<std::pair<StringRef, unsigned>>>
+FIRLspServer::getCursor(const json::Object *params, StringRef &uri) {
+  if (!params)
+    return {};
+  const auto *textDocument = params->getObject("textDocument");
+  const auto *position = params->getObject("position");
+  if (!textDocument || !position)
+    return {};
+  auto docUri = textDocument->getString("uri");
+  auto line = position->getInteger("line");
+  auto column = position->getInteger("character");
+  if (!docUri || !line || !column || *line < 0 || *column < 0)
+    return {};
+  auto it = documents.find(docUri->str());
+  if (it == documents.end())
+    return {};
+  uri = it->first;
+  return {it->second.get(), it->second->getWordAt(*line, *column)};
+}
+
+json::Value FIRLspServer::getDefinition(const json::Object *params) {
+  StringRef uri;
+  auto [doc, word] = getCursor(params, uri);
+  if (!doc || !word)
+    return nullptr;
+  // Every word naming a module, be it in a header, an instance or the circuit
+  // declaration, resolves to the module header without looking at any body.
+  auto *module = doc->lookupModule(word->first);
+  if (!module)
+    return nullptr;
+  return getLocation(uri, module->line, module->column, module->name.size());
+}
+
+json::Value FIRLspServer::getReferences(const json::Object *params) {
+  StringRef uri;
+  auto [doc, word] = getCursor(params, uri);
+  json::Array locations;
+  if (!doc || !word)
+    return std::move(locations);
+  auto *target = doc->lookupModule(word->first);
+  if (!target)
+    return std::move(locations);
+
+  const auto *context = params->getObject("context");
+  if (context && context->getBoolean("includeDeclaration").value_or(false))
+    locations.push_back(getLocation(uri, target->line, target->column,
+                                    target->name.size()));
+
+  // Finding all instances requires looking into every module body once.
+  for (auto &module : doc->getModules())
+    for (auto &inst : doc->getInstances(module))
+      if (inst.moduleName == target->name)
+        locations.push_back(getLocation(uri, inst.line, inst.moduleColumn,
+                                        inst.moduleName.size()));
+  return std::move(locations);
+}
+
+json::Value FIRLspServer::getDocumentSymbols(const json::Object *params) {
+  json::Array symbols;
+  const auto *textDocument =
+      params ? params->getObject("textDocument") : nullptr;
+  auto uri = textDocument ? textDocument->getString("uri") : None;
+  auto it = uri ? documents.find(uri->str()) : documents.end();
+  if (it == documents.end())
+    return std::move(symbols);
+
+  // Only the modules are listed, since listing their contents would require
+  // scanning every body.
+  for (auto &module : it->second->getModules()) {
+    auto range = json::Object{
+        {"start", json::Object{{"line", module.line}, {"character", 0}}},
+        {"end", json::Object{{"line", module.endLine}, {"character", 0}}}};
+    symbols.push_back(json::Object{
+        {"name", module.name},
+        {"detail", module.keyword},
+        {"kind", 2}, // Module
+        {"range", std::move(range)},
+        {"selectionRange",
+         getRange(module.line, module.column, module.name.size())}});
+  }
+  return std::move(symbols);
+}
+
+json::Value FIRLspServer::getWorkspaceSymbols(const json::Object *params) {
+  json::Array symbols;
+  auto query = params ? params->getString("query") : None;
+  for (auto &[uri, doc] : documents)
+    for (auto &module : doc->getModules())
+      if (!query || module.name.contains_insensitive(*query))
+        symbols.push_back(json::Object{
+            {"name", module.name},
+            {"kind", 2}, // Module
+            {"location", getLocation(uri, module.line, module.column,
+                                     module.name.size())}});
+  return std::move(symbols);
+}
+
+//===----------------------------------------------------------------------===//
+// Transport
+//===----------------------------------------------------------------------===//
+
+/// Read the next message from the client. Returns None at the end of the input.
+static Optional<std::string> readMessage() {
+  size_t length = 0;
+  std::string header;
+  while (std::getline(std::cin, header)) {
+    StringRef line = StringRef(header).rtrim("\r");
+    if (line.empty()) {
+      if (length == 0)
+        continue;
+      std::string body(length, '\0');
+      if (!std::cin.read(&body[0], length))
+        return None;
+      return body;
+    }
+    if (line.consume_front_insensitive("Content-Length:"))
+      (void)line.trim().getAsInteger(10, length);
+  }
+  return None;
+}
+
+LogicalResult circt::FIRLspServerMain() {
+  (void)sys::ChangeStdinToBinary();
+  (void)sys::ChangeStdoutToBinary();
+
+  FIRLspServer server;
+  while (auto message = readMessage()) {
+    auto value = json::parse(*message);
+    if (!value) {
+      errs() << "failed to parse message: " << toString(value.takeError())
+             << "\n";
+      continue;
+    }
+    const auto *object = value->getAsObject();
+    if (object && !server.handleMessage(*object))
+      return success(server.hasShutDown());
+  }
+  // The input ended without an exit notification.
+  return failure();
+}
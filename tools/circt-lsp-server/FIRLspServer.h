@@ -0,0 +1,28 @@
+//===- FIRLspServer.h - FIRRTL Language Server ------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the entry point of the language server for `.fir` files.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef CIRCT_LSP_SERVER_FIRLSPSERVER_H
+#define CIRCT_LSP_SERVER_FIRLSPSERVER_H
+
+#include "mlir/Support/LogicalResult.h"
+
+namespace circt {
+
+/// Serve `.fir` documents over the language server protocol on stdin and
+/// stdout until the client exits. Documents are indexed lazily: opening a
+/// document only scans the module headers, and module bodies are scanned for
+/// instances the first time a request needs them.
+mlir::LogicalResult FIRLspServerMain();
+
+} // namespace circt
+
+#endif // CIRCT_LSP_SERVER_FIRLSPSERVER_H
@@ -6,6 +6,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "FIRLspServer.h"
 #include "circt/InitAllDialects.h"
 #include "mlir/IR/Dialect.h"
 #include "mlir/IR/MLIRContext.h"
@@ -14,7 +15,16 @@
 
 using namespace mlir;
 
+// The document handling is entirely provided by `MlirLspServerMain`, which
+// re-parses and re-verifies a document as a whole on every change. Updating
+// only the edited top-level operation needs support from that server, as it
+// owns the parser state the language features are answered from.
 int main(int argc, char **argv) {
+  // `.fir` documents are served by a separate server, selected with `--fir`.
+  for (int i = 1; i < argc; ++i)
+    if (StringRef(argv[i]) == "--fir" || StringRef(argv[i]) == "-fir")
+      return failed(circt::FIRLspServerMain());
+
   DialectRegistry registry;
   registerAllDialects(registry);
   circt::registerAllDialects(registry);
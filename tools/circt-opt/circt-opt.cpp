@@ -14,6 +14,7 @@
 #include "circt/InitAllDialects.h"
 #include "circt/InitAllPasses.h"
 #include "circt/Support/LoweringOptions.h"
+#include "circt/Support/PatternProfiler.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
@@ -61,6 +62,12 @@ int main(int argc, char **argv) {
   circt::test::registerAnalysisTestPasses();
   circt::test::registerSchedulingTestPasses();
 
-  return mlir::failed(mlir::MlirOptMain(
-      argc, argv, "CIRCT modular optimizer driver", registry));
+  auto result = mlir::MlirOptMain(argc, argv, "CIRCT modular optimizer driver",
+                                  registry);
+
+  // Report the pattern statistics gathered by `profile-canonicalize`.
+  auto &profiler = circt::PatternProfiler::getGlobal();
+  if (!profiler.empty())
+    profiler.print(llvm::errs());
+  return mlir::failed(result);
 }
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "Reduction.h"
+#include "circt/Dialect/FIRRTL/FIRRTLInstanceGraph.h"
 #include "circt/Dialect/FIRRTL/FIRRTLOps.h"
 #include "circt/Dialect/FIRRTL/Passes.h"
 #include "circt/InitAllDialects.h"
@@ -24,8 +25,10 @@
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "mlir/Transforms/Passes.h"
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
 
 #define DEBUG_TYPE "circt-reduce"
 
@@ -79,47 +82,6 @@ findInstantiatedModule(firrtl::InstanceOp instOp, SymbolCache &symbols) {
                   : llvm::Optional<firrtl::FModuleOp>();
 }
 
-/// Compute the number of operations in a module. Recursively add the number of
-/// operations in instantiated modules.
-/// @param countMultipleInstantiations: If a module is instantiated multiple
-/// times and this flag is false, count it only once (to better represent code
-/// size reduction rather than area reduction of the actual hardware).
-/// @param countElsewhereInstantiated: If a module is also instantiated in
-/// another subtree of the design then don't count it if this flag is false.
-static uint64_t computeTransitiveModuleSize(
-    SmallVector<std::pair<firrtl::FModuleOp, uint64_t>> &modules,
-    SmallVector<Operation *> &instances, bool countMultipleInstantiations,
-    bool countElsewhereInstantiated) {
-  std::sort(instances.begin(), instances.end());
-  std::sort(modules.begin(), modules.end(),
-            [](auto a, auto b) { return a.first < b.first; });
-
-  auto *end = modules.end();
-  if (!countMultipleInstantiations)
-    end = std::unique(modules.begin(), modules.end(),
-                      [](auto a, auto b) { return a.first == b.first; });
-
-  uint64_t totalOperations = 0;
-
-  for (auto *iter = modules.begin(); iter != end; ++iter) {
-    auto moduleOp = iter->first;
-
-    auto allInstancesCovered = [&]() {
-      return llvm::all_of(
-          moduleOp.getSymbolUses(moduleOp->getParentOfType<ModuleOp>()).value(),
-          [&](auto symbolUse) {
-            return std::binary_search(instances.begin(), instances.end(),
-                                      symbolUse.getUser());
-          });
-    };
-
-    if (countElsewhereInstantiated || allInstancesCovered())
-      totalOperations += iter->second;
-  }
-
-  return totalOperations;
-}
-
 static LogicalResult collectInstantiatedModules(
     llvm::Optional<firrtl::FModuleOp> fmoduleOp, SymbolCache &symbols,
     SmallVector<std::pair<firrtl::FModuleOp, uint64_t>> &modules,
@@ -232,6 +194,101 @@ struct NLARemover {
   llvm::DenseSet<StringAttr> nlasToRemove;
 };
 
+/// Orders the modules of a FIRRTL circuit for reductions that remove or
+/// flatten entire subtrees of the instance hierarchy. Modules closer to the top
+/// come first, such that whole subtrees are tried before the subtrees nested in
+/// them, and larger subtrees come before smaller ones at the same level.
+///
+/// The order also learns from the test results: a subtree that was the only
+/// one reduced in a rejected attempt is necessary for the interesting
+/// behavior, and is tried last from then on. The learned subtrees can be
+/// shared between reductions.
+struct HierarchyOrder {
+  using NecessarySet = llvm::DenseSet<StringAttr>;
+
+  HierarchyOrder(std::shared_ptr<NecessarySet> necessary =
+                     std::make_shared<NecessarySet>())
+      : necessary(std::move(necessary)) {}
+
+  /// Compute the depth and subtree size of every module. Call this before
+  /// attempting a reduction.
+  void compute(mlir::ModuleOp module) {
+    depths.clear();
+    sizes.clear();
+    pending.clear();
+    auto circuits = module.getOps<firrtl::CircuitOp>();
+    if (circuits.empty())
+      return;
+    firrtl::InstanceGraph graph(*circuits.begin());
+
+    // Accumulate the subtree sizes bottom-up.
+    for (auto *node : llvm::post_order(&graph)) {
+      uint64_t size = 0;
+      node->getModule()->walk([&](Operation *) { ++size; });
+      for (auto *record : *node) {
+        auto childName = record->getTarget()->getModule().moduleNameAttr();
+        size = SaturatingAdd(size, sizes.lookup(childName));
+      }
+      sizes[node->getModule().moduleNameAttr()] = size;
+    }
+
+    // Determine the shortest distance of every module from the top.
+    SmallVector<firrtl::InstanceGraphNode *> worklist;
+    worklist.push_back(graph.getTopLevelNode());
+    depths[graph.getTopLevelNode()->getModule().moduleNameAttr()] = 0;
+    for (unsigned i = 0; i < worklist.size(); ++i) {
+      unsigned depth = depths.lookup(worklist[i]->getModule().moduleNameAttr());
+      for (auto *record : *worklist[i]) {
+        auto *child = record->getTarget();
+        if (depths.try_emplace(child->getModule().moduleNameAttr(), depth + 1)
+                .second)
+          worklist.push_back(child);
+      }
+    }
+  }
+
+  /// Return the benefit of reducing the subtree rooted at module `name`.
+  /// Modules outside of the hierarchy below the top count as being at the top.
+  uint64_t getBenefit(StringAttr name) const {
+    if (necessary->contains(name))
+      return 1;
+    constexpr unsigned sizeBits = 40;
+    constexpr unsigned maxDepth = (1 << 16) - 1;
+    uint64_t level = maxDepth - std::min(depths.lookup(name), maxDepth) + 1;
+    uint64_t size = std::min(sizes.lookup(name), (uint64_t(1) << sizeBits) - 1);
+    return (level << sizeBits) | size;
+  }
+
+  /// Record that the current attempt reduces the subtree rooted at `name`.
+  void noteRewrite(StringAttr name) { pending.push_back(name); }
+
+  /// Associate the subtrees reduced since `compute` with the resulting
+  /// `module`. Call this after applying a reduction.
+  void finishAttempt(mlir::ModuleOp module) {
+    attempts[module.getOperation()] = std::move(pending);
+    pending.clear();
+  }
+
+  /// Learn from whether the `module` produced by an attempt was accepted.
+  void noteResult(mlir::ModuleOp module, bool accepted) {
+    auto it = attempts.find(module.getOperation());
+    if (it == attempts.end())
+      return;
+    if (!accepted && it->second.size() == 1 &&
+        necessary->insert(it->second[0]).second)
+      LLVM_DEBUG(llvm::dbgs() << "- Subtree `" << it->second[0].getValue()
+                              << "` is necessary\n");
+    attempts.erase(it);
+  }
+
+private:
+  std::shared_ptr<NecessarySet> necessary;
+  DenseMap<StringAttr, unsigned> depths;
+  DenseMap<StringAttr, uint64_t> sizes;
+  SmallVector<StringAttr, 1> pending;
+  DenseMap<Operation *, SmallVector<StringAttr, 1>> attempts;
+};
+
 //===----------------------------------------------------------------------===//
 // Reduction
 //===----------------------------------------------------------------------===//
@@ -270,11 +327,21 @@ std::string PassReduction::getName() const { return passName.str(); }
 
 /// A sample reduction pattern that maps `firrtl.module` to `firrtl.extmodule`.
 struct ModuleExternalizer : public Reduction {
+  ModuleExternalizer(std::shared_ptr<HierarchyOrder::NecessarySet> necessary)
+      : order(std::move(necessary)) {}
+
   void beforeReduction(mlir::ModuleOp op) override {
     nlaRemover.clear();
     symbols.clear();
+    order.compute(op);
+  }
+  void afterReduction(mlir::ModuleOp op) override {
+    nlaRemover.remove(op);
+    order.finishAttempt(op);
+  }
+  void notifyResult(mlir::ModuleOp op, bool accepted) override {
+    order.noteResult(op, accepted);
   }
-  void afterReduction(mlir::ModuleOp op) override { nlaRemover.remove(op); }
 
   uint64_t match(Operation *op) override {
     if (auto fmoduleOp = dyn_cast<firrtl::FModuleOp>(op)) {
@@ -283,15 +350,14 @@ struct ModuleExternalizer : public Reduction {
       if (failed(collectInstantiatedModules(fmoduleOp, symbols, modules,
                                             instances)))
         return 0;
-      return computeTransitiveModuleSize(modules, instances,
-                                         /*countMultipleInstantiations=*/false,
-                                         /*countElsewhereInstantiated=*/true);
+      return order.getBenefit(fmoduleOp.getNameAttr());
     }
     return 0;
   }
 
   LogicalResult rewrite(Operation *op) override {
     auto module = cast<firrtl::FModuleOp>(op);
+    order.noteRewrite(module.getNameAttr());
     nlaRemover.markNLAsInOperation(op);
     OpBuilder builder(module);
     builder.create<firrtl::FExtModuleOp>(
@@ -306,6 +372,7 @@ struct ModuleExternalizer : public Reduction {
 
   SymbolCache symbols;
   NLARemover nlaRemover;
+  HierarchyOrder order;
 };
 
 /// Invalidate all the leaf fields of a value with a given flippedness by
@@ -420,11 +487,18 @@ static void reduceXor(ImplicitLocOpBuilder &builder, Value &into, Value value) {
 /// invalidated wires. This often shortcuts a long iterative process of connect
 /// invalidation, module externalization, and wire stripping
 struct InstanceStubber : public Reduction {
+  InstanceStubber(std::shared_ptr<HierarchyOrder::NecessarySet> necessary)
+      : order(std::move(necessary)) {}
+
   void beforeReduction(mlir::ModuleOp op) override {
     erasedInsts.clear();
     erasedModules.clear();
     symbols.clear();
     nlaRemover.clear();
+    order.compute(op);
+  }
+  void notifyResult(mlir::ModuleOp op, bool accepted) override {
+    order.noteResult(op, accepted);
   }
   void afterReduction(mlir::ModuleOp op) override {
     // Look into deleted modules to find additional instances that are no longer
@@ -456,6 +530,7 @@ struct InstanceStubber : public Reduction {
     for (auto *op : erasedModules)
       op->erase();
     nlaRemover.remove(op);
+    order.finishAttempt(op);
   }
 
   uint64_t match(Operation *op) override {
@@ -466,15 +541,14 @@ struct InstanceStubber : public Reduction {
       if (failed(collectInstantiatedModules(fmoduleOp, symbols, modules,
                                             instances)))
         return 0;
-      return computeTransitiveModuleSize(modules, instances,
-                                         /*countMultipleInstantiations=*/false,
-                                         /*countElsewhereInstantiated=*/false);
+      return order.getBenefit(instOp.getModuleNameAttr().getAttr());
     }
     return 0;
   }
 
   LogicalResult rewrite(Operation *op) override {
     auto instOp = cast<firrtl::InstanceOp>(op);
+    order.noteRewrite(instOp.getModuleNameAttr().getAttr());
     LLVM_DEBUG(llvm::dbgs()
                << "Stubbing instance `" << instOp.getName() << "`\n");
     ImplicitLocOpBuilder builder(instOp.getLoc(), instOp);
@@ -509,6 +583,7 @@ struct InstanceStubber : public Reduction {
 
   SymbolCache symbols;
   NLARemover nlaRemover;
+  HierarchyOrder order;
   llvm::DenseSet<Operation *> erasedInsts;
   llvm::DenseSet<Operation *> erasedModules;
 };
@@ -1034,6 +1109,7 @@ struct EagerInliner : public Reduction {
   void beforeReduction(mlir::ModuleOp op) override {
     symbols.clear();
     nlaRemover.clear();
+    order.compute(op);
   }
   void afterReduction(mlir::ModuleOp op) override { nlaRemover.remove(op); }
 
@@ -1045,7 +1121,9 @@ struct EagerInliner : public Reduction {
     auto moduleOp = instOp.getReferencedModule(symbols.getSymbolTable(tableOp));
     if (!isa<firrtl::FModuleOp>(moduleOp.getOperation()))
       return 0;
-    return symbols.getSymbolUserMap(tableOp).getUsers(moduleOp).size() == 1;
+    if (symbols.getSymbolUserMap(tableOp).getUsers(moduleOp).size() != 1)
+      return 0;
+    return order.getBenefit(moduleOp.moduleNameAttr());
   }
 
   LogicalResult rewrite(Operation *op) override {
@@ -1086,6 +1164,7 @@ struct EagerInliner : public Reduction {
 
   SymbolCache symbols;
   NLARemover nlaRemover;
+  HierarchyOrder order;
 };
 
 //===----------------------------------------------------------------------===//
@@ -1112,8 +1191,11 @@ void circt::createAllReductions(
                                       true, true));
   add(std::make_unique<PassReduction>(context, firrtl::createInferResetsPass(),
                                       true, true));
-  add(std::make_unique<ModuleExternalizer>());
-  add(std::make_unique<InstanceStubber>());
+  // Subtrees of the instance hierarchy found to be necessary by one of the
+  // reductions removing them are tried last by the other one as well.
+  auto necessarySubtrees = std::make_shared<HierarchyOrder::NecessarySet>();
+  add(std::make_unique<ModuleExternalizer>(necessarySubtrees));
+  add(std::make_unique<InstanceStubber>(necessarySubtrees));
   add(std::make_unique<MemoryStubber>());
   add(std::make_unique<EagerInliner>());
   add(std::make_unique<PassReduction>(
@@ -48,6 +48,12 @@ struct Reduction {
   /// reductions before the resulting module is tried for interestingness.
   virtual void afterReduction(mlir::ModuleOp) {}
 
+  /// Called once a module produced by this reduction has been tested, with
+  /// whether it was accepted as an improvement. Reductions may use this
+  /// callback to learn which parts of the input the interesting behavior
+  /// depends on.
+  virtual void notifyResult(mlir::ModuleOp, bool accepted) {}
+
   /// Check if the reduction can apply to a specific operation. Returns a
   /// benefit measure where a higher number means that applying the pattern
   /// leads to a bigger reduction and zero means that the patten does not
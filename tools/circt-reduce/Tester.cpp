@@ -11,7 +11,16 @@
 //===----------------------------------------------------------------------===//
 
 #include "Tester.h"
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/Verifier.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/SHA256.h"
 #include "llvm/Support/ToolOutputFile.h"
 
 using namespace llvm;
@@ -27,6 +36,25 @@ Tester::Tester(StringRef scriptName, ArrayRef<std::string> scriptArgs,
     : testScript(scriptName), testScriptArgs(scriptArgs),
       testMustFail(testMustFail) {}
 
+Tester::~Tester() = default;
+
+/// Check test cases by running the pass `pipeline` on them within this process
+/// rather than by running the test script.
+LogicalResult Tester::setPipeline(MLIRContext *context, StringRef pipeline,
+                                  StringRef match) {
+  auto pm = std::make_unique<PassManager>(context);
+  if (failed(parsePassPipeline(pipeline, *pm)))
+    return failure();
+  passManager = std::move(pm);
+  this->pipeline = pipeline.str();
+  this->match = match.str();
+
+  // Crashes can only be recovered from on the thread running the pipeline.
+  context->disableMultithreading();
+  CrashRecoveryContext::Enable();
+  return success();
+}
+
 std::pair<bool, size_t> Tester::isInteresting(ModuleOp module) const {
   auto test = get(module);
   return std::make_pair(test.isInteresting(), test.getSize());
@@ -58,6 +86,113 @@ bool Tester::isInteresting(StringRef testCase) const {
   return result == 0;
 }
 
+/// Return whether running the in-process pipeline on a copy of `module`
+/// exhibits the interesting behavior.
+bool Tester::isInterestingInProcess(ModuleOp module) const {
+  // The diagnostic and fatal error handlers are shared by all threads, hence
+  // only one test case may run at a time.
+  std::lock_guard<std::mutex> lock(pipelineMutex);
+  OwningOpRef<ModuleOp> clone = module.clone();
+
+  // Collect the diagnostics and fatal error messages of the pipeline.
+  std::string output;
+  ScopedDiagnosticHandler diagHandler(module.getContext(), [&](Diagnostic &d) {
+    output += d.str() + "\n";
+    for (auto &note : d.getNotes())
+      output += note.str() + "\n";
+    return success();
+  });
+  install_fatal_error_handler(
+      [](void *userData, const char *reason, bool genCrashDiag) {
+        auto &messages = *static_cast<std::string *>(userData);
+        messages += reason;
+        messages += "\n";
+        // Unwind to the crash recovery context rather than exiting.
+        sys::Process::Exit(1);
+      },
+      &output);
+
+  bool pipelineFailed = false;
+  CrashRecoveryContext crashContext;
+  if (!crashContext.RunSafely(
+          [&] { pipelineFailed = failed(passManager->run(*clone)); })) {
+    // The copy may be in an arbitrary state after a crash, hence leak it
+    // rather than trying to destroy it.
+    (void)clone.release();
+    pipelineFailed = true;
+  }
+  remove_fatal_error_handler();
+
+  if (!pipelineFailed)
+    return false;
+  return match.empty() || StringRef(output).contains(match);
+}
+
+/// Load the results of earlier runs from `path` and record all new results
+/// there, such that they carry over to subsequent runs.
+void Tester::setCacheFile(StringRef path) {
+  // Every line holds the key of a test case and its result. A missing file
+  // simply starts out with an empty cache.
+  if (auto buffer = MemoryBuffer::getFile(path)) {
+    SmallVector<StringRef> lines;
+    (*buffer)->getBuffer().split(lines, '\n', -1, false);
+    for (auto line : lines) {
+      auto [key, result] = line.split(' ');
+      if (!key.empty() && (result == "0" || result == "1"))
+        cache[key] = result == "1";
+    }
+  }
+
+  std::error_code ec;
+  cacheFile = std::make_unique<raw_fd_ostream>(path, ec, sys::fs::OF_Append);
+  if (ec)
+    report_fatal_error(Twine("Error opening test cache `") + path +
+                           "`: " + ec.message(),
+                       false);
+}
+
+/// Return a key identifying a test case with the given `contents` run under
+/// this tester's command and arguments.
+std::string Tester::getCacheKey(StringRef contents) const {
+  // Include the test command, such that a persisted cache is not confused by
+  // running a different test on the same input.
+  SHA256 hasher;
+  if (isInProcess()) {
+    hasher.update(pipeline);
+    hasher.update(StringRef("\0", 1));
+    hasher.update(match);
+  } else {
+    hasher.update(testScript);
+    for (auto &arg : testScriptArgs) {
+      hasher.update(StringRef("\0", 1));
+      hasher.update(arg);
+    }
+  }
+  hasher.update(StringRef("\0\0", 2));
+  hasher.update(contents);
+  return toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+/// Return the recorded result for the test case identified by `key`, if it has
+/// been tested before.
+Optional<bool> Tester::lookupResult(StringRef key) const {
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  auto it = cache.find(key);
+  if (it == cache.end())
+    return None;
+  ++numCacheHits;
+  return it->second;
+}
+
+/// Record the result for the test case identified by `key`.
+void Tester::recordResult(StringRef key, bool interesting) const {
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  if (!cache.try_emplace(key, interesting).second || !cacheFile)
+    return;
+  *cacheFile << key << ' ' << (interesting ? '1' : '0') << '\n';
+  cacheFile->flush();
+}
+
 /// Create a new test case for the given `module`.
 TestCase Tester::get(mlir::ModuleOp module) const {
   return TestCase(*this, module);
@@ -97,7 +232,7 @@ StringRef TestCase::getFilepath() {
 size_t TestCase::getSize() {
   if (!isValid())
     return 0;
-  ensureFileOnDisk();
+  ensureSize();
   return *size;
 }
 
@@ -107,12 +242,56 @@ size_t TestCase::getSize() {
 bool TestCase::isInteresting() {
   if (!isValid())
     return false;
-  ensureFileOnDisk();
-  if (!interesting)
-    interesting = tester.isInteresting(filepath);
+  ensureSize();
+  if (interesting)
+    return *interesting;
+
+  // Byte-identical test cases are only run once.
+  if (cacheKey.empty()) {
+    auto buffer = MemoryBuffer::getFile(filepath);
+    if (!buffer)
+      llvm::report_fatal_error(Twine("Error reading file `") + filepath +
+                                   "`: " + buffer.getError().message(),
+                               false);
+    cacheKey = tester.getCacheKey((*buffer)->getBuffer());
+  }
+  interesting = tester.lookupResult(cacheKey);
+  if (!interesting) {
+    if (tester.isInProcess()) {
+      if (!module)
+        llvm::report_fatal_error(
+            "In-process testing requires a module rather than a file", false);
+      interesting = tester.isInterestingInProcess(module);
+    } else {
+      interesting = tester.isInteresting(filepath);
+    }
+    tester.recordResult(cacheKey, *interesting);
+  }
   return *interesting;
 }
 
+/// Ensure `size` and `cacheKey` are populated. Only writes the test case to
+/// disk if it is checked by the test script.
+void TestCase::ensureSize() {
+  if (module && tester.isInProcess()) {
+    if (!size)
+      (void)printModule();
+    return;
+  }
+  ensureFileOnDisk();
+}
+
+/// Print the module and populate `size` and `cacheKey` from the result.
+std::string TestCase::printModule() {
+  std::string contents;
+  llvm::raw_string_ostream contentsStream(contents);
+  module.print(contentsStream);
+  contentsStream.flush();
+  size = contents.size();
+  cacheKey = tester.getCacheKey(contents);
+  return contents;
+}
+
 /// Ensure `filepath` and `size` are populated, and that the test case is in a
 /// file on disk.
 void TestCase::ensureFileOnDisk() {
@@ -129,17 +308,14 @@ void TestCase::ensureFileOnDisk() {
       llvm::report_fatal_error(
           Twine("Error making unique filename: ") + ec.message(), false);
 
-    // Write to the output.
+    // Write to the output. This also determines the size of the test case.
     file = std::make_unique<llvm::ToolOutputFile>(filepath, fd);
-    module.print(file->os());
+    file->os() << printModule();
     file->os().close();
     if (file->os().has_error())
       llvm::report_fatal_error(llvm::Twine("Error emitting the IR to file `") +
                                    filepath + "`",
                                false);
-
-    // Update the file size.
-    size = file->os().tell();
     return;
   }
 
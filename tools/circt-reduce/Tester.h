@@ -14,18 +14,25 @@
 #define CIRCT_REDUCE_TESTER_H
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include "mlir/IR/BuiltinOps.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/raw_ostream.h"
 
 namespace llvm {
 class ToolOutputFile;
 } // namespace llvm
 
+namespace mlir {
+class PassManager;
+} // namespace mlir
+
 namespace circt {
 
 class TestCase;
@@ -40,6 +47,19 @@ class Tester {
 public:
   Tester(llvm::StringRef testScript, llvm::ArrayRef<std::string> testScriptArgs,
          bool testMustFail);
+  ~Tester();
+
+  /// Check test cases by running the pass `pipeline` on them within this
+  /// process rather than by running the test script. A test case is
+  /// interesting if the pipeline fails or crashes, and its diagnostics or
+  /// fatal error message contain `match`. Fails if the pipeline cannot be
+  /// parsed.
+  mlir::LogicalResult setPipeline(mlir::MLIRContext *context,
+                                  llvm::StringRef pipeline,
+                                  llvm::StringRef match);
+
+  /// Return whether test cases are checked within this process.
+  bool isInProcess() const { return passManager != nullptr; }
 
   /// Runs the interestingness testing script on a MLIR test case file. Returns
   /// true if the interesting behavior is present in the test case or false
@@ -49,12 +69,34 @@ public:
   /// Return whether the file in the given path is interesting.
   bool isInteresting(llvm::StringRef testCase) const;
 
+  /// Return whether running the in-process pipeline on a copy of `module`
+  /// exhibits the interesting behavior.
+  bool isInterestingInProcess(mlir::ModuleOp module) const;
+
   /// Create a new test case for the given `module`.
   TestCase get(mlir::ModuleOp module) const;
 
   /// Create a new test case for the given file already on disk.
   TestCase get(llvm::Twine filepath) const;
 
+  /// Load the results of earlier runs from `path` and record all new results
+  /// there, such that they carry over to subsequent runs.
+  void setCacheFile(llvm::StringRef path);
+
+  /// Return a key identifying a test case with the given `contents` run under
+  /// this tester's command and arguments.
+  std::string getCacheKey(llvm::StringRef contents) const;
+
+  /// Return the recorded result for the test case identified by `key`, if it
+  /// has been tested before.
+  llvm::Optional<bool> lookupResult(llvm::StringRef key) const;
+
+  /// Record the result for the test case identified by `key`.
+  void recordResult(llvm::StringRef key, bool interesting) const;
+
+  /// Return the number of tests that have been answered from the cache.
+  unsigned getNumCacheHits() const { return numCacheHits; }
+
 private:
   /// The binary to execute in order to check a reduction attempt for
   /// interestingness.
@@ -66,6 +108,23 @@ private:
   /// Consider the testcase to be interesting if it fails rather than on exit
   /// code 0.
   bool testMustFail;
+
+  /// The results of all test cases run so far, keyed by `getCacheKey()`. Test
+  /// cases may run concurrently, hence the access is guarded by `cacheMutex`.
+  mutable llvm::StringMap<bool> cache;
+  mutable std::mutex cacheMutex;
+  mutable unsigned numCacheHits = 0;
+
+  /// The pass pipeline run on test cases in-process, and the text its
+  /// diagnostics have to contain for a test case to be interesting. Only one
+  /// test case runs in-process at a time.
+  std::unique_ptr<mlir::PassManager> passManager;
+  std::string pipeline;
+  std::string match;
+  mutable std::mutex pipelineMutex;
+
+  /// The file new results are appended to, if any.
+  std::unique_ptr<llvm::raw_fd_ostream> cacheFile;
 };
 
 /// A single test case to be run by a tester.
@@ -112,12 +171,22 @@ private:
   /// file on disk.
   void ensureFileOnDisk();
 
+  /// Ensure `size` and `cacheKey` are populated. Only writes the test case to
+  /// disk if it is checked by the test script.
+  void ensureSize();
+
+  /// Print the module and populate `size` and `cacheKey` from the result.
+  std::string printModule();
+
   /// The tester that is used to run this test case.
   const Tester &tester;
   /// The module to be tested.
   mlir::ModuleOp module;
   /// The path on disk where the test case is located.
   llvm::SmallString<32> filepath;
+  /// The key of the test case in the tester's result cache. Computed when the
+  /// module is written to disk, or when the test is first run otherwise.
+  std::string cacheKey;
 
   /// In case this test case has created a temporary file on disk, this is the
   /// `ToolOutputFile` that did the writing. Keeping this class around ensures
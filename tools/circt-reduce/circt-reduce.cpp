@@ -21,6 +21,8 @@
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/ToolOutputFile.h"
 
+#include <thread>
+
 #define DEBUG_TYPE "circt-reduce"
 #define VERBOSE(X)                                                             \
   do {                                                                         \
@@ -74,8 +76,7 @@ static cl::list<std::string>
                       cl::cat(mainCategory));
 
 static cl::opt<std::string> testerCommand(
-    "test", cl::Required,
-    cl::desc("A command or script to check if output is interesting"),
+    "test", cl::desc("A command or script to check if output is interesting"),
     cl::cat(mainCategory));
 
 static cl::list<std::string>
@@ -111,6 +112,28 @@ static cl::opt<unsigned>
                           "ops per chunk (granularity upper bound)"),
                  cl::cat(granularityCategory));
 
+static cl::opt<unsigned>
+    numJobs("j", cl::init(1),
+            cl::desc("Number of reduction candidates to test concurrently"),
+            cl::cat(mainCategory));
+
+static cl::opt<std::string> testPipeline(
+    "test-pipeline",
+    cl::desc("A pass pipeline to run in-process instead of the test command; "
+             "output is interesting if the pipeline fails or crashes"),
+    cl::cat(mainCategory));
+
+static cl::opt<std::string> testMatch(
+    "test-match",
+    cl::desc("Text that the diagnostics or fatal error of the in-process "
+             "pipeline must contain for output to be interesting"),
+    cl::cat(mainCategory));
+
+static cl::opt<std::string> testCache(
+    "test-cache", cl::init(""),
+    cl::desc("File in which to remember test results across runs"),
+    cl::cat(mainCategory));
+
 static cl::opt<bool> testMustFail(
     "test-must-fail", cl::init(false),
     cl::desc("Consider an input to be interesting on non-zero exit status."),
@@ -167,6 +190,13 @@ static LogicalResult execute(MLIRContext &context) {
     return success();
   }
 
+  if (testerCommand.empty() == testPipeline.empty()) {
+    mlir::emitError(UnknownLoc::get(&context),
+                    "exactly one of `--test` or `--test-pipeline` must be "
+                    "given");
+    return failure();
+  }
+
   // Parse the input file.
   VERBOSE(llvm::errs() << "Reading input\n");
   mlir::OwningOpRef<mlir::ModuleOp> module =
@@ -176,11 +206,20 @@ static LogicalResult execute(MLIRContext &context) {
 
   // Evaluate the unreduced input.
   VERBOSE({
-    llvm::errs() << "Testing input with `" << testerCommand << "`\n";
-    for (auto &arg : testerArgs)
-      llvm::errs() << "  with argument `" << arg << "`\n";
+    if (!testPipeline.empty()) {
+      llvm::errs() << "Testing input with pipeline `" << testPipeline << "`\n";
+    } else {
+      llvm::errs() << "Testing input with `" << testerCommand << "`\n";
+      for (auto &arg : testerArgs)
+        llvm::errs() << "  with argument `" << arg << "`\n";
+    }
   });
   Tester tester(testerCommand, testerArgs, testMustFail);
+  if (!testPipeline.empty() &&
+      failed(tester.setPipeline(&context, testPipeline, testMatch)))
+    return failure();
+  if (!testCache.empty())
+    tester.setCacheFile(testCache);
   auto initialTest = tester.get(module.get());
   if (!skipInitial && !initialTest.isInteresting()) {
     mlir::emitError(UnknownLoc::get(&context), "input is not interesting");
@@ -227,28 +266,38 @@ static LogicalResult execute(MLIRContext &context) {
       if (maxChunkSize > 0)
         rangeLength = std::min<size_t>(rangeLength, maxChunkSize);
 
-      // Apply the pattern to the subset of operations selected by `rangeBase`
-      // and `rangeLength`.
-      size_t opIdx = 0;
-      mlir::OwningOpRef<mlir::ModuleOp> newModule = module->clone();
-      pattern.beforeReduction(*newModule);
-      SmallVector<std::pair<Operation *, uint64_t>, 16> opBenefits;
-      newModule->walk([&](Operation *op) {
-        uint64_t benefit = pattern.match(op);
-        if (benefit > 0) {
-          opIdx++;
-          opBenefits.push_back(std::make_pair(op, benefit));
+      // Apply the pattern to the subset of operations selected by `base` and
+      // `length` in a fresh copy of the module. Returns the number of
+      // operations the pattern applies to.
+      auto applyPattern = [&](size_t base, size_t length,
+                              mlir::OwningOpRef<mlir::ModuleOp> &newModule) {
+        size_t numOps = 0;
+        newModule = module->clone();
+        pattern.beforeReduction(*newModule);
+        SmallVector<std::pair<Operation *, uint64_t>, 16> opBenefits;
+        newModule->walk([&](Operation *op) {
+          uint64_t benefit = pattern.match(op);
+          if (benefit > 0) {
+            numOps++;
+            opBenefits.push_back(std::make_pair(op, benefit));
+          }
+        });
+        std::sort(opBenefits.begin(), opBenefits.end(),
+                  [](auto a, auto b) { return a.second > b.second; });
+        for (size_t i = base; i < base + length && i < opBenefits.size();
+             i++) {
+          auto *op = opBenefits[i].first;
+          if (pattern.match(op))
+            (void)pattern.rewrite(op);
         }
-      });
-      std::sort(opBenefits.begin(), opBenefits.end(),
-                [](auto a, auto b) { return a.second > b.second; });
-      for (size_t i = rangeBase;
-           i < rangeBase + rangeLength && i < opBenefits.size(); i++) {
-        auto *op = opBenefits[i].first;
-        if (pattern.match(op))
-          (void)pattern.rewrite(op);
-      }
-      pattern.afterReduction(*newModule);
+        pattern.afterReduction(*newModule);
+        return numOps;
+      };
+
+      SmallVector<mlir::OwningOpRef<mlir::ModuleOp>> newModules(1);
+      SmallVector<size_t> chunkBases;
+      chunkBases.push_back(rangeBase);
+      size_t opIdx = applyPattern(rangeBase, rangeLength, newModules[0]);
       if (opIdx == 0) {
         VERBOSE({
           clearSummary();
@@ -276,36 +325,72 @@ static LogicalResult execute(MLIRContext &context) {
         errsPosAfterLastSummary = llvm::errs().tell();
       });
 
-      // Check if this reduced module is still interesting, and its overall size
-      // is smaller than what we had before.
-      auto shouldAccept = [&](TestCase &test) {
+      // Prepare the chunks that would be tried next if this one is rejected,
+      // such that their tests can run concurrently.
+      while (newModules.size() < std::max<unsigned>(numJobs, 1) &&
+             rangeLength < opIdx - chunkBases.back()) {
+        chunkBases.push_back(chunkBases.back() + rangeLength);
+        newModules.emplace_back();
+        (void)applyPattern(chunkBases.back(), rangeLength, newModules.back());
+      }
+
+      // Check if the reduced modules are still interesting, and their overall
+      // size is smaller than what we had before. The size and validity checks
+      // run upfront, since they need to write the test cases to disk.
+      SmallVector<TestCase> tests;
+      SmallVector<bool> interesting(newModules.size(), false);
+      SmallVector<unsigned> testsToRun;
+      for (auto &newModule : newModules) {
+        tests.push_back(tester.get(newModule.get()));
+        auto &test = tests.back();
         if (!test.isValid())
-          return false; // don't write to disk if module is busted
+          continue; // don't write to disk if module is busted
         if (test.getSize() >= bestSize && !pattern.acceptSizeIncrease())
-          return false; // don't run test if size already bad
-        return test.isInteresting();
-      };
-      auto test = tester.get(newModule.get());
-      if (shouldAccept(test)) {
+          continue; // don't run test if size already bad
+        testsToRun.push_back(tests.size() - 1);
+      }
+      if (testsToRun.size() == 1) {
+        interesting[testsToRun[0]] = tests[testsToRun[0]].isInteresting();
+      } else {
+        std::vector<std::thread> threads;
+        for (auto idx : testsToRun)
+          threads.emplace_back(
+              [&, idx] { interesting[idx] = tests[idx].isInteresting(); });
+        for (auto &thread : threads)
+          thread.join();
+      }
+
+      for (auto [newModule, isInteresting] :
+           llvm::zip(newModules, interesting))
+        pattern.notifyResult(newModule.get(), isInteresting);
+
+      // Pick the first interesting chunk, which is the one the chunks would
+      // have been accepted at had they been tested one after another. All
+      // chunks before it have been rejected.
+      unsigned winner = llvm::find(interesting, true) - interesting.begin();
+      if (winner > 0)
+        allDidReduce = false;
+      if (winner < tests.size()) {
         // Make this reduced module the new baseline and reset our search
         // strategy to start again from the beginning, since this reduction may
         // have created additional opportunities.
+        rangeBase = chunkBases[winner];
         patternDidReduce = true;
-        bestSize = test.getSize();
+        bestSize = tests[winner].getSize();
         VERBOSE({
           clearSummary();
           llvm::errs() << "- Accepting module of size " << bestSize << "\n";
         });
-        module = std::move(newModule);
-
-        // We leave `rangeBase` and `rangeLength` untouched in this case. This
-        // causes the next iteration of the loop to try the same pattern again
-        // at the same offset. If the pattern has reached a fixed point, nothing
-        // changes and we proceed. If the pattern has removed an operation, this
-        // will already operate on the next batch of operations which have
-        // likely moved to this point. The only exception are operations that
-        // are marked as "one shot", which explicitly ask to not be re-applied
-        // at the same location.
+        module = std::move(newModules[winner]);
+
+        // We leave `rangeBase` at the accepted chunk and `rangeLength`
+        // untouched in this case. This causes the next iteration of the loop
+        // to try the same pattern again at the same offset. If the pattern has
+        // reached a fixed point, nothing changes and we proceed. If the pattern
+        // has removed an operation, this will already operate on the next batch
+        // of operations which have likely moved to this point. The only
+        // exception are operations that are marked as "one shot", which
+        // explicitly ask to not be re-applied at the same location.
         if (pattern.isOneShot())
           rangeBase += rangeLength;
 
@@ -314,9 +399,8 @@ static LogicalResult execute(MLIRContext &context) {
           if (failed(writeOutput(module.get())))
             return failure();
       } else {
-        allDidReduce = false;
         // Try the pattern on the next `rangeLength` number of operations.
-        rangeBase += rangeLength;
+        rangeBase = chunkBases.back() + rangeLength;
       }
 
       // If we have gone past the end of the input, reduce the size of the chunk
@@ -376,6 +460,8 @@ static LogicalResult execute(MLIRContext &context) {
   // Write the reduced test case to the output.
   clearSummary();
   VERBOSE(llvm::errs() << "All reduction strategies exhausted\n");
+  VERBOSE(llvm::errs() << "Answered " << tester.getNumCacheHits()
+                       << " tests from the cache\n");
   VERBOSE(llvm::errs() << "Final size: " << bestSize << " ("
                        << (100 - bestSize * 100 / initialTest.getSize())
                        << "% reduction)\n");
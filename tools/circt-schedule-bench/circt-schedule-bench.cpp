@@ -0,0 +1,344 @@
+//===- circt-schedule-bench.cpp - Benchmark the scheduling algorithms -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements 'circt-schedule-bench', which loads scheduling problems
+// stored as SSP instances, solves each of them with every applicable scheduler,
+// and reports the solve time, objective value and memory use as JSON.
+//
+//===----------------------------------------------------------------------===//
+
+#include "circt/Dialect/SSP/SSPDialect.h"
+#include "circt/Dialect/SSP/SSPOps.h"
+#include "circt/Dialect/SSP/Utilities.h"
+#include "circt/Scheduling/Algorithms.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/FileUtilities.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/ToolOutputFile.h"
+
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+#ifdef LLVM_ON_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace llvm;
+using namespace mlir;
+using namespace circt;
+using namespace circt::scheduling;
+using namespace circt::ssp;
+
+static cl::OptionCategory mainCategory("circt-schedule-bench Options");
+
+static cl::list<std::string>
+    inputPaths(cl::Positional, cl::OneOrMore,
+               cl::desc("<input files or directories of SSP instances>"),
+               cl::cat(mainCategory));
+
+static cl::opt<std::string> outputFilename("o", cl::init("-"),
+                                           cl::desc("Output filename"),
+                                           cl::value_desc("filename"),
+                                           cl::cat(mainCategory));
+
+static cl::list<std::string>
+    schedulerNames("schedulers", cl::CommaSeparated,
+                   cl::desc("Only run the given schedulers (default: all)"),
+                   cl::cat(mainCategory));
+
+static cl::opt<unsigned>
+    repetitions("repeat", cl::init(1),
+                cl::desc("Solve each instance this many times and report the "
+                         "fastest run"),
+                cl::cat(mainCategory));
+
+static cl::opt<unsigned> iiCandidates(
+    "ii-candidates", cl::init(4),
+    cl::desc("Number of concurrent candidate IIs for 'simplex-parallel'"),
+    cl::cat(mainCategory));
+
+/// Return the peak resident set size of this process in kilobytes, or 0 if the
+/// platform does not track it.
+static int64_t getPeakRSS() {
+#ifdef LLVM_ON_UNIX
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+  }
+#endif
+  return 0;
+}
+
+namespace {
+/// A named scheduling algorithm applicable to instances of `ProblemT`.
+template <typename ProblemT>
+struct Scheduler {
+  StringRef name;
+  std::function<LogicalResult(ProblemT &, Operation *)> run;
+};
+} // namespace
+
+template <typename ProblemT>
+static SmallVector<Scheduler<ProblemT>> getSchedulers();
+
+template <>
+SmallVector<Scheduler<Problem>> getSchedulers() {
+  SmallVector<Scheduler<Problem>> schedulers = {
+      {"asap", [](Problem &prob, Operation *) { return scheduleASAP(prob); }},
+      {"simplex", [](Problem &prob, Operation *lastOp) {
+         return scheduleSimplex(prob, lastOp);
+       }}};
+#ifdef SCHEDULING_OR_TOOLS
+  schedulers.push_back({"lp", [](Problem &prob, Operation *lastOp) {
+                          return scheduleLP(prob, lastOp);
+                        }});
+#endif
+  return schedulers;
+}
+
+template <>
+SmallVector<Scheduler<CyclicProblem>> getSchedulers() {
+  SmallVector<Scheduler<CyclicProblem>> schedulers = {
+      {"simplex", [](CyclicProblem &prob, Operation *lastOp) {
+         return scheduleSimplex(prob, lastOp);
+       }}};
+#ifdef SCHEDULING_OR_TOOLS
+  schedulers.push_back({"lp", [](CyclicProblem &prob, Operation *lastOp) {
+                          return scheduleLP(prob, lastOp);
+                        }});
+#endif
+  return schedulers;
+}
+
+template <>
+SmallVector<Scheduler<SharedOperatorsProblem>> getSchedulers() {
+  SmallVector<Scheduler<SharedOperatorsProblem>> schedulers = {
+      {"list",
+       [](SharedOperatorsProblem &prob, Operation *) {
+         return scheduleList(prob);
+       }},
+      {"simplex", [](SharedOperatorsProblem &prob, Operation *lastOp) {
+         return scheduleSimplex(prob, lastOp);
+       }}};
+#ifdef SCHEDULING_OR_TOOLS
+  schedulers.push_back(
+      {"cpsat", [](SharedOperatorsProblem &prob, Operation *lastOp) {
+         return scheduleCPSAT(prob, lastOp);
+       }});
+#endif
+  return schedulers;
+}
+
+template <>
+SmallVector<Scheduler<ModuloProblem>> getSchedulers() {
+  return {{"simplex",
+           [](ModuloProblem &prob, Operation *lastOp) {
+             return scheduleSimplex(prob, lastOp);
+           }},
+          {"simplex-parallel", [](ModuloProblem &prob, Operation *lastOp) {
+             return scheduleSimplex(prob, lastOp, iiCandidates);
+           }}};
+}
+
+/// Solve `instOp` with each of the schedulers for `ProblemT` selected on the
+/// command line, and append the results to `json`. Returns failure if any of
+/// the schedulers failed or produced an invalid schedule.
+template <typename ProblemT>
+static LogicalResult benchmark(InstanceOp instOp, json::OStream &json) {
+  StringSet<> selected;
+  selected.insert(schedulerNames.begin(), schedulerNames.end());
+
+  // The objective of the schedulers is to minimize the start time of the last
+  // operation in the dependence graph.
+  Block *graph = instOp.getDependenceGraph().getBodyBlock();
+  Operation *lastOp = graph->empty() ? nullptr : &graph->back();
+  json.attribute("operations", (int64_t)graph->getOperations().size());
+
+  bool allSucceeded = true;
+  json.attributeArray("results", [&] {
+    for (auto &scheduler : getSchedulers<ProblemT>()) {
+      if (!selected.empty() && !selected.contains(scheduler.name))
+        continue;
+
+      Optional<std::string> error;
+      Optional<ProblemT> solved;
+      double bestTime = std::numeric_limits<double>::infinity();
+      for (unsigned i = 0; i < std::max(1u, (unsigned)repetitions); ++i) {
+        // Every run starts from a freshly loaded problem, such that none of
+        // the schedulers can benefit from a previous solution.
+        auto prob = loadProblem<ProblemT>(instOp);
+        if (!lastOp || failed(prob.check())) {
+          error = "invalid problem";
+          break;
+        }
+
+        // Capture the first error instead of printing it, such that it ends
+        // up next to the scheduler's other results.
+        Optional<std::string> diagnostic;
+        auto captureError = [&](Diagnostic &diag) {
+          if (diag.getSeverity() == DiagnosticSeverity::Error && !diagnostic)
+            diagnostic = diag.str();
+          return success();
+        };
+        ScopedDiagnosticHandler handler(instOp.getContext(), captureError);
+
+        auto start = std::chrono::steady_clock::now();
+        LogicalResult result = scheduler.run(prob, lastOp);
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        if (failed(result)) {
+          error = diagnostic.value_or("scheduling failed");
+          break;
+        }
+        if (failed(prob.verify())) {
+          error = diagnostic.value_or("schedule verification failed");
+          break;
+        }
+        bestTime = std::min(bestTime, elapsed.count());
+        solved.emplace(std::move(prob));
+      }
+
+      json.object([&] {
+        json.attribute("scheduler", scheduler.name);
+        if (error || !solved) {
+          allSucceeded = false;
+          json.attribute("status", "failed");
+          json.attribute("error", error.value_or("no solution"));
+          return;
+        }
+        json.attribute("status", "ok");
+        json.attribute("objective", (int64_t)*solved->getStartTime(lastOp));
+        if constexpr (std::is_base_of_v<CyclicProblem, ProblemT>)
+          json.attribute("ii", (int64_t)*solved->getInitiationInterval());
+        json.attribute("time_s", bestTime);
+        // The operating system only reports the high-water mark of the whole
+        // process, hence pass a single instance to isolate its peak.
+        json.attribute("peak_rss_kb", getPeakRSS());
+      });
+    }
+  });
+  return success(allSucceeded);
+}
+
+/// Collect the `.mlir` files in `path` if it is a directory, or `path` itself
+/// otherwise, in a deterministic order.
+static LogicalResult collectInputs(StringRef path,
+                                   SmallVectorImpl<std::string> &files) {
+  if (!sys::fs::is_directory(path)) {
+    files.push_back(path.str());
+    return success();
+  }
+
+  SmallVector<std::string> found;
+  std::error_code ec;
+  for (sys::fs::recursive_directory_iterator it(path, ec), end;
+       it != end && !ec; it.increment(ec))
+    if (sys::path::extension(it->path()) == ".mlir" &&
+        !sys::fs::is_directory(it->path()))
+      found.push_back(it->path());
+  if (ec) {
+    errs() << "error: cannot read directory '" << path << "': " << ec.message()
+           << "\n";
+    return failure();
+  }
+  llvm::sort(found);
+  files.append(found.begin(), found.end());
+  return success();
+}
+
+static LogicalResult executeScheduleBench(MLIRContext &context) {
+  SmallVector<std::string> files;
+  for (auto &path : inputPaths)
+    if (failed(collectInputs(path, files)))
+      return failure();
+
+  std::string errorMessage;
+  auto output = openOutputFile(outputFilename, &errorMessage);
+  if (!output) {
+    errs() << errorMessage << "\n";
+    return failure();
+  }
+
+  bool allSucceeded = true;
+  {
+    json::OStream json(output->os(), /*IndentSize=*/2);
+    json.object([&] {
+      json.attributeArray("instances", [&] {
+        for (auto &file : files) {
+          OwningOpRef<ModuleOp> module =
+              parseSourceFile<ModuleOp>(file, &context);
+          if (!module) {
+            allSucceeded = false;
+            continue;
+          }
+
+          SmallVector<InstanceOp> instOps;
+          module->walk([&](InstanceOp op) { instOps.push_back(op); });
+          for (auto instOp : instOps) {
+            StringRef probName = instOp.getProblemName();
+            json.object([&] {
+              json.attribute("file", file);
+              json.attribute("instance", instOp.getInstanceName());
+              json.attribute("problem", probName);
+
+              LogicalResult result = success();
+              if (probName.equals("Problem"))
+                result = benchmark<Problem>(instOp, json);
+              else if (probName.equals("CyclicProblem"))
+                result = benchmark<CyclicProblem>(instOp, json);
+              else if (probName.equals("SharedOperatorsProblem"))
+                result = benchmark<SharedOperatorsProblem>(instOp, json);
+              else if (probName.equals("ModuloProblem"))
+                result = benchmark<ModuloProblem>(instOp, json);
+              else {
+                instOp->emitWarning() << "unsupported problem '" << probName
+                                      << "', skipping instance";
+                json.attribute("status", "unsupported");
+              }
+              if (failed(result))
+                allSucceeded = false;
+            });
+          }
+        }
+      });
+    });
+  }
+  output->os() << "\n";
+  output->keep();
+  return success(allSucceeded);
+}
+
+int main(int argc, char **argv) {
+  InitLLVM y(argc, argv);
+
+  cl::HideUnrelatedOptions(mainCategory);
+  cl::ParseCommandLineOptions(
+      argc, argv,
+      "CIRCT scheduling benchmark\n\n"
+      "Solves every SSP instance in the given files and directories with each "
+      "applicable scheduler.\n");
+
+  DialectRegistry registry;
+  registry.insert<SSPDialect>();
+  MLIRContext context(registry);
+
+  return failed(executeScheduleBench(context));
+}
@@ -27,6 +27,7 @@
 #include "circt/Dialect/Seq/SeqPasses.h"
 #include "circt/Support/LoweringOptions.h"
 #include "circt/Support/LoweringOptionsParser.h"
+#include "circt/Support/PatternProfiler.h"
 #include "circt/Support/Version.h"
 #include "circt/Transforms/Passes.h"
 #include "mlir/Bytecode/BytecodeReader.h"
@@ -34,6 +35,7 @@
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/AsmState.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Verifier.h"
 #include "mlir/Parser/Parser.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassInstrumentation.h"
@@ -43,11 +45,15 @@
 #include "mlir/Support/ToolUtilities.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "mlir/Transforms/Passes.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Chrono.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/SHA256.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/ToolOutputFile.h"
 
@@ -78,6 +84,13 @@ static cl::opt<std::string> outputFilename(
     "o", cl::desc("Output filename, or directory for split output"),
     cl::value_desc("filename"), cl::init("-"), cl::cat(mainCategory));
 
+static cl::opt<std::string> batchFilename(
+    "batch",
+    cl::desc("Compile every input listed in the specified file in one process. "
+             "Each line holds an input file and an output file or directory, "
+             "separated by whitespace"),
+    cl::value_desc("filename"), cl::init(""), cl::cat(mainCategory));
+
 static cl::opt<bool>
     splitInputFile("split-input-file",
                    cl::desc("Split the input file into pieces and process each "
@@ -94,6 +107,17 @@ static cl::opt<bool> disableOptimization("disable-opt",
                                          cl::desc("Disable optimizations"),
                                          cl::cat(mainCategory));
 
+static cl::opt<bool> earlyModuleCleanup(
+    "early-module-cleanup",
+    cl::desc("Run module-local cleanups on each module as soon as its body is "
+             "parsed, overlapping them with parsing the remaining modules"),
+    cl::init(false), cl::cat(mainCategory));
+
+static cl::opt<bool> profilePatterns(
+    "profile-patterns",
+    cl::desc("Report the time spent in every canonicalization pattern"),
+    cl::init(false), cl::cat(mainCategory));
+
 static cl::opt<bool> disableInliner("disable-inliner",
                                     cl::desc("Disable the Inliner pass"),
                                     cl::init(false), cl::Hidden,
@@ -219,6 +243,24 @@ static cl::opt<bool>
                        cl::desc("Ignore the @info locations in the .fir file"),
                        cl::init(false), cl::cat(mainCategory));
 
+static cl::opt<bool> compactFIRLocations(
+    "compact-fir-locators",
+    cl::desc("Only keep the file and line of the first location of each @info "
+             "locator in the .fir file"),
+    cl::init(false), cl::cat(mainCategory));
+
+static cl::opt<unsigned> dedupMaxMergedLocs(
+    "dedup-max-merged-locs",
+    cl::desc("Maximum number of locations fused into the location of an "
+             "operation merged by deduplication (0 means no limit)"),
+    cl::init(0), cl::cat(mainCategory));
+
+static cl::opt<bool> dedupFastHash(
+    "dedup-fast-hash",
+    cl::desc("Deduplicate modules using a fast non-cryptographic hash instead "
+             "of SHA256"),
+    cl::init(false), cl::cat(mainCategory));
+
 static cl::opt<bool>
     disableLowerChirrtl("disable-lower-chirrtl",
                         cl::desc("Disable the LowerCHIRRTL pass"),
@@ -242,7 +284,7 @@ static cl::opt<bool>
 static cl::opt<bool> exportChiselInterface(
     "export-chisel-interface",
     cl::desc("Generate a Scala Chisel interface to the top level "
-             "module of the firrtl circuit"),
+             "module and the other public modules of the firrtl circuit"),
     cl::init(false), cl::cat(mainCategory));
 
 static cl::opt<std::string> chiselInterfaceOutDirectory(
@@ -266,6 +308,12 @@ static cl::opt<bool>
                          cl::desc("Disable the MemToRegOfVec pass"),
                          cl::init(false), cl::Hidden, cl::cat(mainCategory));
 
+static cl::opt<uint64_t> memToRegOfVecMaxSize(
+    "mem-to-reg-of-vec-max-size",
+    cl::desc("Keep memories with more bits as memories in MemToRegOfVec, "
+             "or 0 for no limit"),
+    cl::init(0), cl::cat(mainCategory));
+
 static cl::opt<bool>
     disablePrefixModules("disable-prefix-modules",
                          cl::desc("Disable the PrefixModules pass"),
@@ -338,6 +386,11 @@ static bool isRandomEnabled(RandomKind kind) {
   return disableRandom != RandomKind::All && disableRandom != kind;
 }
 
+static cl::opt<bool> regRandomInitLoop(
+    "reg-random-init-loop",
+    cl::desc("Fill the random values of register randomization in one loop"),
+    cl::init(false), cl::cat(mainCategory));
+
 enum OutputFormatKind {
   OutputParseOnly,
   OutputIRFir,
@@ -372,10 +425,27 @@ static cl::opt<bool>
                  cl::desc("Run the verifier after each transformation pass"),
                  cl::init(true), cl::cat(mainCategory));
 
+static cl::opt<bool> verifyBoundaries(
+    "verify-boundaries",
+    cl::desc("Only run the verifier at pipeline boundaries, i.e. after "
+             "parsing, after lowering to HW, and before export, instead of "
+             "after each transformation pass"),
+    cl::init(false), cl::cat(mainCategory));
+
 static cl::list<std::string> inputAnnotationFilenames(
     "annotation-file", cl::desc("Optional input annotation file"),
     cl::CommaSeparated, cl::value_desc("filename"), cl::cat(mainCategory));
 
+static cl::opt<std::string> partitionRoot(
+    "partition-root",
+    cl::desc("Only compile the modules instantiated underneath this module"),
+    cl::value_desc("module"), cl::init(""), cl::cat(mainCategory));
+
+static cl::list<std::string> partitionBlackBoxes(
+    "partition-black-box",
+    cl::desc("Modules compiled as separate partitions, emitted as black boxes"),
+    cl::CommaSeparated, cl::value_desc("module"), cl::cat(mainCategory));
+
 static cl::opt<std::string> outputAnnotationFilename(
     "output-annotation-file", cl::desc("Optional output annotation file"),
     cl::CommaSeparated, cl::value_desc("filename"), cl::cat(mainCategory));
@@ -408,16 +478,63 @@ static cl::opt<std::string> blackBoxRootPath(
     cl::desc("Optional path to use as the root of black box annotations"),
     cl::value_desc("path"), cl::init(""), cl::cat(mainCategory));
 
+static cl::opt<bool> blackBoxReferenceFiles(
+    "blackbox-reference-files",
+    cl::desc("Copy black box source files into the output when emitting "
+             "Verilog, instead of loading them into the IR"),
+    cl::init(false), cl::cat(mainCategory));
+
 static cl::opt<bool>
     verbosePassExecutions("verbose-pass-executions",
                           cl::desc("Log executions of toplevel module passes"),
                           cl::init(false), cl::cat(mainCategory));
 
+static cl::opt<std::string> passMemoryReport(
+    "pass-memory-report",
+    cl::desc("Write the heap usage and number of operations before and after "
+             "each top-level pass to the specified file as JSON"),
+    cl::value_desc("filename"), cl::init(""), cl::cat(mainCategory));
+
+static cl::opt<std::string> moduleFingerprints(
+    "module-fingerprints",
+    cl::desc("Write a stable content hash of every module, combined with the "
+             "compiler version and options, to the specified file as JSON"),
+    cl::value_desc("filename"), cl::init(""), cl::cat(mainCategory));
+
+static cl::opt<std::string> dedupCache(
+    "dedup-cache",
+    cl::desc("Cache the deduplication decisions in the specified file and "
+             "reuse them when recompiling identical inputs"),
+    cl::value_desc("filename"), cl::init(""), cl::cat(mainCategory));
+
+/// The compiler version and command line options, excluding the input file,
+/// which are folded into every module fingerprint and dedup cache key.
+static std::string fingerprintSalt;
+
+/// Compute the key under which the dedup decisions for the inputs loaded into
+/// the source manager are cached.
+static std::string getDedupCacheKey(llvm::SourceMgr &sourceMgr) {
+  llvm::SHA256 hasher;
+  hasher.update(fingerprintSalt);
+  for (unsigned i = 1, e = sourceMgr.getNumBuffers(); i <= e; ++i) {
+    auto buffer = sourceMgr.getMemoryBuffer(i)->getBuffer();
+    hasher.update(std::to_string(buffer.size()));
+    hasher.update(buffer);
+  }
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
 static cl::opt<bool> stripFirDebugInfo(
     "strip-fir-debug-info",
     cl::desc("Disable source fir locator information in output Verilog"),
     cl::init(true), cl::cat(mainCategory));
 
+static cl::opt<bool> skipUnchangedFiles(
+    "skip-unchanged-files",
+    cl::desc("With split-verilog output, do not rewrite files whose contents "
+             "did not change"),
+    cl::init(false), cl::cat(mainCategory));
+
 static cl::opt<bool> stripDebugInfo(
     "strip-debug-info",
     cl::desc("Disable source locator information in output Verilog"),
@@ -450,6 +567,8 @@ static std::unique_ptr<Pass> createSimpleCanonicalizerPass() {
   mlir::GreedyRewriteConfig config;
   config.useTopDownTraversal = true;
   config.enableRegionSimplification = false;
+  if (profilePatterns)
+    return circt::createProfileCanonicalizePass(config);
   return mlir::createCanonicalizerPass(config);
 }
 
@@ -493,6 +612,117 @@ public:
   }
 };
 
+namespace {
+/// Run the verifier at a pipeline boundary. This is used with
+/// `--verify-boundaries`, in which case the pass managers do not verify the IR
+/// after each pass.
+struct VerifyBoundaryPass
+    : public PassWrapper<VerifyBoundaryPass, OperationPass<mlir::ModuleOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(VerifyBoundaryPass)
+
+  StringRef getArgument() const override { return "firtool-verify-boundary"; }
+  StringRef getDescription() const override {
+    return "Verify the IR at a pipeline boundary";
+  }
+
+  void runOnOperation() override {
+    if (failed(mlir::verify(getOperation())))
+      return signalPassFailure();
+    markAllAnalysesPreserved();
+  }
+};
+} // namespace
+
+/// Add a verification of the IR at a pipeline boundary to `pm`, if the IR is
+/// not verified after each pass anyway.
+static void addBoundaryVerification(PassManager &pm) {
+  if (verifyBoundaries)
+    pm.addPass(std::make_unique<VerifyBoundaryPass>());
+}
+
+/// The memory usage recorded for a single pass execution.
+struct PassMemoryRecord {
+  std::string pass;
+  StringRef opName;
+  size_t heapBefore, heapAfter;
+  size_t opsBefore, opsAfter;
+};
+
+// This class records the heap usage and the number of operations in the IR
+// before and after each pass, which helps to find the passes responsible for
+// memory growth.  Like FirtoolPassInstrumentation, this assumes that passes
+// are not parallelized for firrtl::CircuitOp and mlir::ModuleOp.
+class PassMemoryInstrumentation : public mlir::PassInstrumentation {
+  SmallVectorImpl<PassMemoryRecord> &records;
+  SmallVector<std::pair<size_t, size_t>> startPoints;
+
+  static size_t countOps(Operation *op) {
+    size_t count = 0;
+    op->walk([&](Operation *) { ++count; });
+    return count;
+  }
+
+  void record(Pass *pass, Operation *op) {
+    auto [heapBefore, opsBefore] = startPoints.pop_back_val();
+    std::string passName;
+    llvm::raw_string_ostream os(passName);
+    pass->printAsTextualPipeline(os);
+    records.push_back({std::move(passName), op->getName().getStringRef(),
+                       heapBefore, llvm::sys::Process::GetMallocUsage(),
+                       opsBefore, countOps(op)});
+  }
+
+public:
+  PassMemoryInstrumentation(SmallVectorImpl<PassMemoryRecord> &records)
+      : records(records) {}
+
+  void runBeforePass(Pass *pass, Operation *op) override {
+    if (isa<firrtl::CircuitOp, mlir::ModuleOp>(op))
+      startPoints.push_back(
+          {llvm::sys::Process::GetMallocUsage(), countOps(op)});
+  }
+
+  void runAfterPass(Pass *pass, Operation *op) override {
+    if (isa<firrtl::CircuitOp, mlir::ModuleOp>(op))
+      record(pass, op);
+  }
+
+  void runAfterPassFailed(Pass *pass, Operation *op) override {
+    if (isa<firrtl::CircuitOp, mlir::ModuleOp>(op))
+      record(pass, op);
+  }
+};
+
+/// Write the recorded pass memory usage to the file requested by the user.
+static LogicalResult
+writePassMemoryReport(ArrayRef<PassMemoryRecord> records) {
+  std::string errorMessage;
+  auto output = openOutputFile(passMemoryReport, &errorMessage);
+  if (!output) {
+    llvm::errs() << errorMessage << "\n";
+    return failure();
+  }
+
+  llvm::json::OStream json(output->os(), 2);
+  json.array([&] {
+    for (auto &record : records) {
+      json.object([&] {
+        json.attribute("pass", record.pass);
+        json.attribute("op", record.opName);
+        json.attribute("heapBefore", int64_t(record.heapBefore));
+        json.attribute("heapAfter", int64_t(record.heapAfter));
+        json.attribute("heapDelta",
+                       int64_t(record.heapAfter) - int64_t(record.heapBefore));
+        json.attribute("opsBefore", int64_t(record.opsBefore));
+        json.attribute("opsAfter", int64_t(record.opsAfter));
+      });
+    }
+  });
+  output->os() << "\n";
+  output->keep();
+  return success();
+}
+
 /// Check output stream before writing bytecode to it.
 /// Warn and return true if output is known to be displayed.
 static bool checkBytecodeOutputToConsole(raw_ostream &os) {
@@ -557,7 +787,17 @@ processBuffer(MLIRContext &context, TimingScope &ts, llvm::SourceMgr &sourceMgr,
     auto parserTimer = ts.nest("FIR Parser");
     firrtl::FIRParserOptions options;
     options.ignoreInfoLocators = ignoreFIRLocations;
+    options.compactInfoLocators = compactFIRLocations;
     options.numAnnotationFiles = numAnnotationFiles;
+    // Annotations have not been lowered at this point, so only passes that do
+    // not depend on them may be scheduled here.
+    if (earlyModuleCleanup && !disableOptimization)
+      options.moduleBodyCallback = [&](firrtl::FModuleOp module) {
+        auto modulePM = PassManager::on<firrtl::FModuleOp>(&context);
+        modulePM.enableVerifier(verifyPasses && !verifyBoundaries);
+        modulePM.addPass(createCSEPass());
+        return modulePM.run(module);
+      };
     module = importFIRFile(sourceMgr, &context, parserTimer, options);
   } else {
     auto parserTimer = ts.nest("MLIR Parser");
@@ -577,21 +817,31 @@ processBuffer(MLIRContext &context, TimingScope &ts, llvm::SourceMgr &sourceMgr,
 
   // Apply any pass manager command line options.
   PassManager pm(&context);
-  pm.enableVerifier(verifyPasses);
+  pm.enableVerifier(verifyPasses && !verifyBoundaries);
   pm.enableTiming(ts);
   if (verbosePassExecutions)
     pm.addInstrumentation(std::make_unique<FirtoolPassInstrumentation>());
+  SmallVector<PassMemoryRecord> memoryRecords;
+  if (!passMemoryReport.empty())
+    pm.addInstrumentation(
+        std::make_unique<PassMemoryInstrumentation>(memoryRecords));
   applyPassManagerCLOptions(pm);
 
   pm.nest<firrtl::CircuitOp>().addPass(firrtl::createLowerFIRRTLAnnotationsPass(
       disableAnnotationsUnknown, disableAnnotationsClassless));
 
+  if (!moduleFingerprints.empty())
+    pm.nest<firrtl::CircuitOp>().addPass(firrtl::createModuleFingerprintsPass(
+        moduleFingerprints, fingerprintSalt));
+
   // If the user asked for --parse-only, stop after running LowerAnnotations.
   if (outputFormat == OutputParseOnly) {
     if (failed(pm.run(module.get())))
       return failure();
     auto outputTimer = ts.nest("Print .mlir output");
     printOp(*module, outputFile.value()->os());
+    if (!passMemoryReport.empty())
+      return writePassMemoryReport(memoryRecords);
     return success();
   }
 
@@ -599,7 +849,9 @@ processBuffer(MLIRContext &context, TimingScope &ts, llvm::SourceMgr &sourceMgr,
   pm.nest<firrtl::CircuitOp>().nest<firrtl::FModuleOp>().addPass(
       firrtl::createDropNamesPass(preserveMode));
 
-  if (!disableOptimization)
+  // Skip CSE if it already ran on each module right after it was parsed.
+  bool ranEarlyCleanup = earlyModuleCleanup && inputFormat == InputFIRFile;
+  if (!disableOptimization && !ranEarlyCleanup)
     pm.nest<firrtl::CircuitOp>().nest<firrtl::FModuleOp>().addPass(
         createCSEPass());
 
@@ -617,11 +869,18 @@ processBuffer(MLIRContext &context, TimingScope &ts, llvm::SourceMgr &sourceMgr,
 
   if (!disableMemToRegOfVec)
     pm.nest<firrtl::CircuitOp>().addPass(
-        firrtl::createMemToRegOfVecPass(replSeqMem, ignoreReadEnableMem));
+        firrtl::createMemToRegOfVecPass(replSeqMem, ignoreReadEnableMem,
+                                        memToRegOfVecMaxSize));
 
   if (!disableInferResets)
     pm.nest<firrtl::CircuitOp>().addPass(firrtl::createInferResetsPass());
 
+  // Reduce the circuit to a single partition once the types of the ports on
+  // the partition boundaries are known.
+  if (!partitionRoot.empty() || !partitionBlackBoxes.empty())
+    pm.nest<firrtl::CircuitOp>().addPass(firrtl::createExtractPartitionPass(
+        partitionRoot, partitionBlackBoxes));
+
   if (exportChiselInterface) {
     if (chiselInterfaceOutDirectory.empty()) {
       pm.nest<firrtl::CircuitOp>().addPass(createExportChiselInterfacePass());
@@ -632,7 +891,9 @@ processBuffer(MLIRContext &context, TimingScope &ts, llvm::SourceMgr &sourceMgr,
   }
 
   if (!disableOptimization && dedup)
-    pm.nest<firrtl::CircuitOp>().addPass(firrtl::createDedupPass());
+    pm.nest<firrtl::CircuitOp>().addPass(firrtl::createDedupPass(
+        dedupCache, dedupCache.empty() ? "" : getDedupCacheKey(sourceMgr),
+        dedupMaxMergedLocs, dedupFastHash));
 
   if (!disableWireDFT)
     pm.nest<firrtl::CircuitOp>().addPass(firrtl::createWireDFTPass());
@@ -725,7 +986,7 @@ processBuffer(MLIRContext &context, TimingScope &ts, llvm::SourceMgr &sourceMgr,
                                ? llvm::sys::path::parent_path(inputFilename)
                                : blackBoxRootPath;
   pm.nest<firrtl::CircuitOp>().addPass(
-      firrtl::createBlackBoxReaderPass(blackBoxRoot));
+      firrtl::createBlackBoxReaderPass(blackBoxRoot, blackBoxReferenceFiles));
 
   pm.nest<firrtl::CircuitOp>().nest<firrtl::FModuleOp>().addPass(
       firrtl::createDropNamesPass(preserveMode));
@@ -770,6 +1031,7 @@ processBuffer(MLIRContext &context, TimingScope &ts, llvm::SourceMgr &sourceMgr,
         enableAnnotationWarning.getValue(), emitChiselAssertsAsSVA.getValue(),
         stripMuxPragmas.getValue(), !isRandomEnabled(RandomKind::Mem),
         !isRandomEnabled(RandomKind::Reg)));
+    addBoundaryVerification(pm);
 
     if (outputFormat == OutputIRHW) {
       if (!disableOptimization) {
@@ -786,8 +1048,8 @@ processBuffer(MLIRContext &context, TimingScope &ts, llvm::SourceMgr &sourceMgr,
         modulePM.addPass(createCSEPass());
       }
 
-      pm.nest<hw::HWModuleOp>().addPass(
-          seq::createSeqFIRRTLLowerToSVPass(!isRandomEnabled(RandomKind::Reg)));
+      pm.nest<hw::HWModuleOp>().addPass(seq::createSeqFIRRTLLowerToSVPass(
+          !isRandomEnabled(RandomKind::Reg), regRandomInitLoop));
       pm.addPass(sv::createHWMemSimImplPass(replSeqMem, ignoreReadEnableMem,
                                             stripMuxPragmas,
                                             !isRandomEnabled(RandomKind::Mem),
@@ -813,26 +1075,36 @@ processBuffer(MLIRContext &context, TimingScope &ts, llvm::SourceMgr &sourceMgr,
   if (loweringOptions.getNumOccurrences())
     loweringOptions.setAsAttribute(module.get());
 
+  // Verify IR that is printed as is. IR that is exported to Verilog is
+  // verified by the export pipeline.
+  bool emitsVerilog = outputFormat == OutputVerilog ||
+                      outputFormat == OutputSplitVerilog ||
+                      outputFormat == OutputIRVerilog;
+  if (!emitsVerilog)
+    addBoundaryVerification(pm);
+
   if (failed(pm.run(module.get())))
     return failure();
 
   // Add passes specific to Verilog emission if we're going there.
-  if (outputFormat == OutputVerilog || outputFormat == OutputSplitVerilog ||
-      outputFormat == OutputIRVerilog) {
+  if (emitsVerilog) {
     PassManager exportPm(&context);
+    exportPm.enableVerifier(!verifyBoundaries);
     exportPm.enableTiming(ts);
     applyPassManagerCLOptions(exportPm);
     if (verbosePassExecutions)
       exportPm.addInstrumentation(
           std::make_unique<FirtoolPassInstrumentation>());
-    // Legalize unsupported operations within the modules.
-    exportPm.nest<hw::HWModuleOp>().addPass(sv::createHWLegalizeModulesPass());
-
-    // Tidy up the IR to improve verilog emission quality.
-    if (!disableOptimization) {
-      auto &modulePM = exportPm.nest<hw::HWModuleOp>();
+    if (!passMemoryReport.empty())
+      exportPm.addInstrumentation(
+          std::make_unique<PassMemoryInstrumentation>(memoryRecords));
+    // Legalize unsupported operations within the modules, and tidy up the IR
+    // to improve verilog emission quality.  Both are module-local and run as a
+    // single parallel sweep over the modules.
+    auto &modulePM = exportPm.nest<hw::HWModuleOp>();
+    modulePM.addPass(sv::createHWLegalizeModulesPass());
+    if (!disableOptimization)
       modulePM.addPass(sv::createPrettifyVerilogPass());
-    }
 
     if (stripFirDebugInfo)
       exportPm.addPass(
@@ -845,6 +1117,8 @@ processBuffer(MLIRContext &context, TimingScope &ts, llvm::SourceMgr &sourceMgr,
     if (stripDebugInfo)
       exportPm.addPass(mlir::createStripDebugInfoPass());
 
+    addBoundaryVerification(exportPm);
+
     // Emit a single file or multiple files depending on the output format.
     switch (outputFormat) {
     default:
@@ -853,7 +1127,8 @@ processBuffer(MLIRContext &context, TimingScope &ts, llvm::SourceMgr &sourceMgr,
       exportPm.addPass(createExportVerilogPass(outputFile.value()->os()));
       break;
     case OutputSplitVerilog:
-      exportPm.addPass(createExportSplitVerilogPass(outputFilename));
+      exportPm.addPass(
+          createExportSplitVerilogPass(outputFilename, skipUnchangedFiles));
       break;
     case OutputIRVerilog:
       // Run the ExportVerilog pass to get its lowering, but discard the output.
@@ -889,10 +1164,15 @@ processBuffer(MLIRContext &context, TimingScope &ts, llvm::SourceMgr &sourceMgr,
     mlirFile->keep();
   }
 
+  if (!passMemoryReport.empty() &&
+      failed(writePassMemoryReport(memoryRecords)))
+    return failure();
+
   // We intentionally "leak" the Module into the MLIRContext instead of
   // deallocating it.  There is no need to deallocate it right before process
-  // exit.
-  (void)module.release();
+  // exit.  In batch mode the context outlives this input, so free it.
+  if (batchFilename.empty())
+    (void)module.release();
   return success();
 }
 
@@ -946,15 +1226,10 @@ processInput(MLIRContext &context, TimingScope &ts,
       llvm::outs());
 }
 
-/// This implements the top-level logic for the firtool command, invoked once
-/// command line options are parsed and LLVM/MLIR are all set up and ready to
-/// go.
-static LogicalResult executeFirtool(MLIRContext &context) {
-  // Create the timing manager we use to sample execution times.
-  DefaultTimingManager tm;
-  applyDefaultTimingManagerCLOptions(tm);
-  auto ts = tm.getRootScope();
-
+/// Compile the input file named by the `inputFilename` option into the
+/// `outputFilename` option.
+static LogicalResult executeFirtoolInput(MLIRContext &context,
+                                         TimingScope &ts) {
   // Set up the input file.
   std::string errorMessage;
   auto input = openInputFile(inputFilename, &errorMessage);
@@ -1001,11 +1276,6 @@ static LogicalResult executeFirtool(MLIRContext &context) {
     }
   }
 
-  // Register our dialects.
-  context.loadDialect<chirrtl::CHIRRTLDialect, firrtl::FIRRTLDialect,
-                      hw::HWDialect, comb::CombDialect, seq::SeqDialect,
-                      sv::SVDialect>();
-
   // Process the input.
   if (failed(processInput(context, ts, std::move(input), outputFile)))
     return failure();
@@ -1017,6 +1287,68 @@ static LogicalResult executeFirtool(MLIRContext &context) {
   return success();
 }
 
+/// Compile every input listed in the batch file, one after the other, reusing
+/// the MLIRContext, its loaded dialects, and its thread pool.  Each input is
+/// compiled with the same options and uses the thread pool internally.  All
+/// inputs are attempted even if some fail.
+static LogicalResult executeFirtoolBatch(MLIRContext &context,
+                                         TimingScope &ts) {
+  std::string errorMessage;
+  auto batchFile = openInputFile(batchFilename, &errorMessage);
+  if (!batchFile) {
+    llvm::errs() << errorMessage << "\n";
+    return failure();
+  }
+
+  // Each input detects its own format unless one was given explicitly.
+  auto format = inputFormat.getValue();
+  bool anyFailed = false;
+  SmallVector<StringRef> lines;
+  batchFile->getBuffer().split(lines, '\n');
+  for (auto &it : llvm::enumerate(lines)) {
+    auto line = it.value().trim();
+    if (line.empty() || line.startswith("#"))
+      continue;
+    auto [input, output] = getToken(line);
+    output = output.trim();
+    if (output.empty()) {
+      llvm::errs() << batchFilename << ":" << it.index() + 1
+                   << ": expected an input and an output\n";
+      anyFailed = true;
+      continue;
+    }
+    inputFilename = input.str();
+    outputFilename = output.str();
+    inputFormat = format;
+    if (failed(executeFirtoolInput(context, ts))) {
+      llvm::errs() << "[firtool] failed to compile '" << input << "'\n";
+      anyFailed = true;
+    }
+  }
+  return failure(anyFailed);
+}
+
+/// This implements the top-level logic for the firtool command, invoked once
+/// command line options are parsed and LLVM/MLIR are all set up and ready to
+/// go.
+static LogicalResult executeFirtool(MLIRContext &context) {
+  // Create the timing manager we use to sample execution times.
+  DefaultTimingManager tm;
+  applyDefaultTimingManagerCLOptions(tm);
+  auto ts = tm.getRootScope();
+
+  // Register our dialects.
+  context.loadDialect<chirrtl::CHIRRTLDialect, firrtl::FIRRTLDialect,
+                      hw::HWDialect, comb::CombDialect, seq::SeqDialect,
+                      sv::SVDialect>();
+
+  auto result = batchFilename.empty() ? executeFirtoolInput(context, ts)
+                                      : executeFirtoolBatch(context, ts);
+  if (profilePatterns)
+    PatternProfiler::getGlobal().print(llvm::errs());
+  return result;
+}
+
 /// Main driver for firtool command.  This sets up LLVM and MLIR, and parses
 /// command line options before passing off to 'executeFirtool'.  This is set up
 /// so we can `exit(0)` at the end of the program to avoid teardown of the
@@ -1059,6 +1391,13 @@ int main(int argc, char **argv) {
   // Parse pass names in main to ensure static initialization completed.
   cl::ParseCommandLineOptions(argc, argv, "MLIR-based FIRRTL compiler\n");
 
+  if (!moduleFingerprints.empty() || !dedupCache.empty()) {
+    fingerprintSalt = getCirctVersion();
+    for (int i = 1; i < argc; ++i)
+      if (argv[i] != inputFilename)
+        (fingerprintSalt += '\0') += argv[i];
+  }
+
   MLIRContext context;
 
   // Do the guts of the firtool process.
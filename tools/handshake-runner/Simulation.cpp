@@ -11,7 +11,9 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include <list>
+#include <atomic>
+#include <cmath>
+#include <deque>
 
 #include "circt/Dialect/Handshake/HandshakeOps.h"
 #include "circt/Dialect/Handshake/Simulation.h"
@@ -20,9 +22,15 @@
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Threading.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/TypeSwitch.h"
+#include "llvm/ADT/bit.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MathExtras.h"
 
 #define DEBUG_TYPE "runner"
 
@@ -158,14 +166,45 @@ void printAnyValueWithType(llvm::raw_ostream &out, mlir::Type type,
   }
 }
 
-void scheduleIfNeeded(std::list<mlir::Operation *> &readyList,
+namespace {
+/// A FIFO of operations which might be ready to execute. Every operation is
+/// in the queue at most once, which is checked in constant time.
+class ReadyQueue {
+public:
+  /// Add `op` to the back of the queue, unless it is queued already.
+  void push(mlir::Operation *op) {
+    if (enqueued.insert(op).second)
+      queue.push_back(op);
+  }
+
+  /// Remove the operation at the front of the queue and return it.
+  mlir::Operation *pop() {
+    auto *op = queue.front();
+    queue.pop_front();
+    enqueued.erase(op);
+    return op;
+  }
+
+  size_t size() const { return queue.size(); }
+  std::deque<mlir::Operation *>::const_iterator begin() const {
+    return queue.begin();
+  }
+  std::deque<mlir::Operation *>::const_iterator end() const {
+    return queue.end();
+  }
+
+private:
+  std::deque<mlir::Operation *> queue;
+  llvm::DenseSet<mlir::Operation *> enqueued;
+};
+} // namespace
+
+void scheduleIfNeeded(ReadyQueue &readyList,
                       llvm::DenseMap<mlir::Value, Any> & /*valueMap*/,
                       mlir::Operation *op) {
-  if (std::find(readyList.begin(), readyList.end(), op) == readyList.end()) {
-    readyList.push_back(op);
-  }
+  readyList.push(op);
 }
-void scheduleUses(std::list<mlir::Operation *> &readyList,
+void scheduleUses(ReadyQueue &readyList,
                   llvm::DenseMap<mlir::Value, Any> &valueMap,
                   mlir::Value value) {
   for (auto &use : value.getUses()) {
@@ -177,7 +216,7 @@ void scheduleUses(std::list<mlir::Operation *> &readyList,
 // given store.  Return the pseudo-pointer to the new matrix in the
 // store (i.e. the first dimension index).
 unsigned allocateMemRef(mlir::MemRefType type, std::vector<Any> &in,
-                        std::vector<std::vector<Any>> &store,
+                        std::vector<SimMemory> &store,
                         std::vector<double> &storeTimes) {
   ArrayRef<int64_t> shape = type.getShape();
   int64_t allocationSize = 1;
@@ -190,25 +229,137 @@ unsigned allocateMemRef(mlir::MemRefType type, std::vector<Any> &in,
       allocationSize *= any_cast<APInt>(in[count++]).getSExtValue();
     }
   }
-  unsigned ptr = store.size();
-  store.resize(ptr + 1);
-  storeTimes.resize(ptr + 1);
-  store[ptr].resize(allocationSize);
-  storeTimes[ptr] = 0.0;
   mlir::Type elementType = type.getElementType();
-  int64_t width = elementType.getIntOrFloatBitWidth();
-  for (int i = 0; i < allocationSize; ++i) {
-    if (elementType.isa<mlir::IntegerType>()) {
-      store[ptr][i] = APInt(width, 0);
-    } else if (elementType.isa<mlir::FloatType>()) {
-      store[ptr][i] = APFloat(0.0);
-    } else {
-      fatalValueError("Unknown result type!\n", elementType);
-    }
-  }
+  if (!elementType.isa<mlir::IntegerType, mlir::FloatType>())
+    fatalValueError("Unknown result type!\n", elementType);
+  unsigned ptr = store.size();
+  store.emplace_back(elementType, allocationSize);
+  storeTimes.push_back(0.0);
   return ptr;
 }
 
+//===----------------------------------------------------------------------===//
+// Simulation profile
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// Token-level statistics of a handshake simulation, meant to guide where
+/// buffers are inserted.  A channel is the value carrying the tokens.
+struct SimulationProfile {
+  struct OperationProfile {
+    /// The number of times the operation executed.
+    uint64_t firings = 0;
+    /// The number of times the operation was tried but was not ready.
+    uint64_t retries = 0;
+    /// The total time between the arrival of the first and the last input
+    /// token consumed by a firing.
+    double stallTime = 0.0;
+  };
+
+  struct ChannelProfile {
+    /// The number of tokens consumed from the channel.
+    uint64_t tokens = 0;
+    /// The total and maximum time tokens waited on the channel until they
+    /// were consumed.
+    double waitTime = 0.0;
+    double maxWaitTime = 0.0;
+  };
+
+  /// Record that `op` was tried to execute, consuming `consumed` tokens which
+  /// arrived at the given times.
+  void record(mlir::Operation *op, bool executed,
+              ArrayRef<std::pair<mlir::Value, double>> consumed);
+
+  /// Write the profile as JSON.  The average occupancy of a channel follows
+  /// from its total wait time over the simulated time.
+  void write(raw_ostream &os, double simulatedTime) const;
+
+  llvm::MapVector<mlir::Operation *, OperationProfile> operations;
+  llvm::MapVector<mlir::Value, ChannelProfile> channels;
+};
+} // namespace
+
+void SimulationProfile::record(
+    mlir::Operation *op, bool executed,
+    ArrayRef<std::pair<mlir::Value, double>> consumed) {
+  auto &opProfile = operations[op];
+  if (!executed)
+    ++opProfile.retries;
+  if (consumed.empty()) {
+    opProfile.firings += executed;
+    return;
+  }
+
+  // The firing happens once the last of the consumed tokens arrived.
+  double firstArrival = consumed.front().second;
+  double fireTime = firstArrival;
+  for (auto [value, arrival] : consumed) {
+    firstArrival = std::min(firstArrival, arrival);
+    fireTime = std::max(fireTime, arrival);
+  }
+  if (executed) {
+    ++opProfile.firings;
+    opProfile.stallTime += fireTime - firstArrival;
+  }
+  for (auto [value, arrival] : consumed) {
+    auto &channel = channels[value];
+    ++channel.tokens;
+    channel.waitTime += fireTime - arrival;
+    channel.maxWaitTime = std::max(channel.maxWaitTime, fireTime - arrival);
+  }
+}
+
+void SimulationProfile::write(raw_ostream &os, double simulatedTime) const {
+  auto locationString = [](Location loc) {
+    std::string str;
+    llvm::raw_string_ostream(str) << loc;
+    return str;
+  };
+
+  llvm::json::OStream json(os, 2);
+  json.object([&] {
+    json.attribute("time", simulatedTime);
+    json.attributeArray("operations", [&] {
+      for (auto &entry : operations)
+        json.object([&] {
+          auto *op = entry.first;
+          auto &opProfile = entry.second;
+          json.attribute("name", op->getName().getStringRef());
+          json.attribute("location", locationString(op->getLoc()));
+          json.attribute("firings", int64_t(opProfile.firings));
+          json.attribute("retries", int64_t(opProfile.retries));
+          json.attribute("stallTime", opProfile.stallTime);
+        });
+    });
+    json.attributeArray("channels", [&] {
+      for (auto &entry : channels)
+        json.object([&] {
+          auto value = entry.first;
+          auto &channel = entry.second;
+          if (auto arg = value.dyn_cast<BlockArgument>()) {
+            json.attribute("producer", "argument");
+            json.attribute("index", int64_t(arg.getArgNumber()));
+            json.attribute("location", locationString(arg.getLoc()));
+          } else {
+            auto result = value.cast<OpResult>();
+            json.attribute("producer",
+                           result.getOwner()->getName().getStringRef());
+            json.attribute("index", int64_t(result.getResultNumber()));
+            json.attribute("location",
+                           locationString(result.getOwner()->getLoc()));
+          }
+          json.attribute("tokens", int64_t(channel.tokens));
+          json.attribute("waitTime", channel.waitTime);
+          json.attribute("maxWaitTime", channel.maxWaitTime);
+          json.attribute("averageOccupancy",
+                         simulatedTime > 0 ? channel.waitTime / simulatedTime
+                                           : 0.0);
+        });
+    });
+  });
+  os << "\n";
+}
+
 //===----------------------------------------------------------------------===//
 // Handshake executer
 //===----------------------------------------------------------------------===//
@@ -220,7 +371,7 @@ public:
                     llvm::DenseMap<mlir::Value, Any> &valueMap,
                     llvm::DenseMap<mlir::Value, double> &timeMap,
                     std::vector<Any> &results, std::vector<double> &resultTimes,
-                    std::vector<std::vector<Any>> &store,
+                    std::vector<SimMemory> &store,
                     std::vector<double> &storeTimes);
 
   /// Entry point for handshake::FuncOp top-level functions
@@ -228,9 +379,10 @@ public:
                     llvm::DenseMap<mlir::Value, Any> &valueMap,
                     llvm::DenseMap<mlir::Value, double> &timeMap,
                     std::vector<Any> &results, std::vector<double> &resultTimes,
-                    std::vector<std::vector<Any>> &store,
+                    std::vector<SimMemory> &store,
                     std::vector<double> &storeTimes,
-                    mlir::OwningOpRef<mlir::ModuleOp> &module);
+                    mlir::OwningOpRef<mlir::ModuleOp> &module,
+                    SimulationProfile *profile = nullptr);
 
   bool succeeded() const { return successFlag; }
 
@@ -294,10 +446,11 @@ private:
   llvm::DenseMap<mlir::Value, double> &timeMap;
   std::vector<Any> &results;
   std::vector<double> &resultTimes;
-  std::vector<std::vector<Any>> &store;
+  std::vector<SimMemory> &store;
   std::vector<double> &storeTimes;
   double time;
   mlir::OwningOpRef<mlir::ModuleOp> *module = nullptr;
+  SimulationProfile *profile = nullptr;
 
   /// Flag indicating whether execution was successful.
   bool successFlag = true;
@@ -373,7 +526,7 @@ LogicalResult HandshakeExecuter::execute(mlir::arith::SubIOp,
 LogicalResult HandshakeExecuter::execute(mlir::arith::SubFOp,
                                          std::vector<Any> &in,
                                          std::vector<Any> &out) {
-  out[0] = any_cast<APFloat>(in[0]) + any_cast<APFloat>(in[1]);
+  out[0] = any_cast<APFloat>(in[0]) - any_cast<APFloat>(in[1]);
   return success();
 }
 
@@ -471,8 +624,7 @@ LogicalResult HandshakeExecuter::execute(mlir::memref::LoadOp op,
            << "Out-of-bounds access to memory '" << ptr << "'. Memory has "
            << ref.size() << " elements but requested element " << address;
 
-  Any result = ref[address];
-  out[0] = result;
+  out[0] = ref.load(address);
 
   double storeTime = storeTimes[ptr];
   LLVM_DEBUG(dbgs() << "STORE: " << storeTime << "\n");
@@ -498,7 +650,7 @@ LogicalResult HandshakeExecuter::execute(mlir::memref::StoreOp op,
     return op.emitOpError()
            << "Out-of-bounds access to memory '" << ptr << "'. Memory has "
            << ref.size() << " elements but requested element " << address;
-  ref[address] = in[0];
+  ref.store(address, in[0]);
 
   double storeTime = storeTimes[ptr];
   LLVM_DEBUG(dbgs() << "STORE: " << storeTime << "\n");
@@ -596,7 +748,7 @@ LogicalResult HandshakeExecuter::execute(mlir::CallOpInterface callOp,
     llvm::DenseMap<mlir::Value, double> newTimeMap;
     std::vector<Any> results(outputs);
     std::vector<double> resultTimes(outputs);
-    std::vector<std::vector<Any>> store;
+    std::vector<SimMemory> store;
     std::vector<double> storeTimes;
     mlir::Block &entryBlock = funcOp.getBody().front();
     mlir::Block::BlockArgListType blockArgs = entryBlock.getArguments();
@@ -661,7 +813,7 @@ LogicalResult HandshakeExecuter::execute(handshake::InstanceOp instanceOp,
 
       // Go execute!
       HandshakeExecuter(func, scopeValueMap, scopeTimeMap, nestedResults,
-                        nestedResTimes, store, storeTimes, *module);
+                        nestedResTimes, store, storeTimes, *module, profile);
 
       // Place the output arguments in the caller scope.
       for (auto nestedRes : enumerate(nestedResults)) {
@@ -693,7 +845,7 @@ enum ExecuteStrategy { Default = 1 << 0, Continue = 1 << 1, Return = 1 << 2 };
 HandshakeExecuter::HandshakeExecuter(
     mlir::func::FuncOp &toplevel, llvm::DenseMap<mlir::Value, Any> &valueMap,
     llvm::DenseMap<mlir::Value, double> &timeMap, std::vector<Any> &results,
-    std::vector<double> &resultTimes, std::vector<std::vector<Any>> &store,
+    std::vector<double> &resultTimes, std::vector<SimMemory> &store,
     std::vector<double> &storeTimes)
     : valueMap(valueMap), timeMap(timeMap), results(results),
       resultTimes(resultTimes), store(store), storeTimes(storeTimes) {
@@ -767,17 +919,18 @@ HandshakeExecuter::HandshakeExecuter(
 HandshakeExecuter::HandshakeExecuter(
     handshake::FuncOp &func, llvm::DenseMap<mlir::Value, Any> &valueMap,
     llvm::DenseMap<mlir::Value, double> &timeMap, std::vector<Any> &results,
-    std::vector<double> &resultTimes, std::vector<std::vector<Any>> &store,
-    std::vector<double> &storeTimes, mlir::OwningOpRef<mlir::ModuleOp> &module)
+    std::vector<double> &resultTimes, std::vector<SimMemory> &store,
+    std::vector<double> &storeTimes, mlir::OwningOpRef<mlir::ModuleOp> &module,
+    SimulationProfile *profile)
     : valueMap(valueMap), timeMap(timeMap), results(results),
       resultTimes(resultTimes), store(store), storeTimes(storeTimes),
-      module(&module) {
+      module(&module), profile(profile) {
   successFlag = true;
   mlir::Block &entryBlock = func.getBody().front();
   // The arguments of the entry block.
   mlir::Block::BlockArgListType blockArgs = entryBlock.getArguments();
   // A list of operations which might be ready to execute.
-  std::list<mlir::Operation *> readyList;
+  ReadyQueue readyList;
   // A map of memory ops
   llvm::DenseMap<unsigned, unsigned> memoryMap;
 
@@ -817,15 +970,29 @@ HandshakeExecuter::HandshakeExecuter(
 #endif
     assert(readyList.size() > 0 &&
            "Expected some instruction to be ready for execution");
-    mlir::Operation &op = *readyList.front();
-    readyList.pop_front();
+    mlir::Operation &op = *readyList.pop();
 
     // Execute handshake ops through ExecutableOpInterface
     if (auto handshakeOp = dyn_cast<handshake::ExecutableOpInterface>(op)) {
+      // The tokens available before the execution which are gone afterwards
+      // were consumed by it.
+      SmallVector<std::pair<mlir::Value, double>> available;
+      if (profile)
+        for (mlir::Value in : op.getOperands())
+          if (valueMap.count(in))
+            available.push_back({in, timeMap[in]});
+
       std::vector<mlir::Value> scheduleList;
-      if (!handshakeOp.tryExecute(valueMap, memoryMap, timeMap, store,
-                                  scheduleList))
-        readyList.push_back(&op);
+      bool executed = handshakeOp.tryExecute(valueMap, memoryMap, timeMap,
+                                             store, scheduleList);
+      if (profile) {
+        llvm::erase_if(available, [&](auto &token) {
+          return valueMap.count(token.first);
+        });
+        profile->record(&op, executed, available);
+      }
+      if (!executed)
+        readyList.push(&op);
       else {
         LLVM_DEBUG({
           dbgs() << "EXECUTED: " << op << "\n";
@@ -860,10 +1027,18 @@ HandshakeExecuter::HandshakeExecuter(
     }
     if (reschedule) {
       LLVM_DEBUG(dbgs() << "Rescheduling data...\n");
-      readyList.push_back(&op);
+      if (profile)
+        profile->record(&op, false, {});
+      readyList.push(&op);
       continue;
     }
     // Consume the inputs.
+    if (profile) {
+      SmallVector<std::pair<mlir::Value, double>> consumed;
+      for (mlir::Value in : op.getOperands())
+        consumed.push_back({in, timeMap[in]});
+      profile->record(&op, true, consumed);
+    }
     for (mlir::Value in : op.getOperands())
       valueMap.erase(in);
 
@@ -909,16 +1084,649 @@ HandshakeExecuter::HandshakeExecuter(
   }
 }
 
+//===----------------------------------------------------------------------===//
+// Compiled executer
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// The operations understood by the compiled executer.
+enum class Opcode : uint8_t {
+  Constant,
+  AddI,
+  SubI,
+  MulI,
+  XorI,
+  DivSI,
+  DivUI,
+  CmpI,
+  ExtSI,
+  ExtUI,
+  IndexCast,
+  AddF,
+  SubF,
+  MulF,
+  DivF,
+  CmpF,
+  Alloc,
+  Load,
+  Store,
+  Br,
+  CondBr,
+  Return
+};
+
+/// A decoded operation.  Values live in a dense array of slots, and every
+/// instruction refers to the slots of its operands and its result.
+struct Instruction {
+  Opcode opcode;
+  /// The bit width of the result.
+  unsigned width;
+  /// The bit width of the first operand.
+  unsigned operandWidth;
+  /// The constant value, the comparison predicate or the first successor.
+  int64_t immediate;
+  /// The slot of the result, if any.
+  unsigned result;
+  /// The range of the operand slots in `CompiledFunction::operandSlots`.
+  unsigned firstOperand;
+  unsigned numOperands;
+  /// The operation this was decoded from, for diagnostics.
+  mlir::Operation *op;
+};
+
+/// The destination of a branch.  The operands forwarded to the destination
+/// are stored in `CompiledFunction::operandSlots`, and the arguments of the
+/// destination block occupy consecutive slots.
+struct Successor {
+  unsigned pc;
+  unsigned firstOperand;
+  unsigned numOperands;
+  unsigned firstArgument;
+};
+
+/// A func::FuncOp compiled into a flat instruction stream.  Integers are kept
+/// as zero-extended uint64_t and floats as the bits of a double, such that
+/// the executer works on native values rather than boxed APInts and
+/// APFloats.  Functions which use anything else, such as calls, tuples or
+/// integers wider than 64 bits, are left to the HandshakeExecuter.
+class CompiledFunction {
+public:
+  /// Compile `func`, or return null if it is not supported.
+  static std::unique_ptr<CompiledFunction> compile(mlir::func::FuncOp func);
+
+  /// Execute the function on the arguments in `valueMap` and `timeMap`, with
+  /// the same semantics as the HandshakeExecuter.
+  LogicalResult run(llvm::DenseMap<mlir::Value, Any> &valueMap,
+                    llvm::DenseMap<mlir::Value, double> &timeMap,
+                    std::vector<Any> &results, std::vector<double> &resultTimes,
+                    std::vector<SimMemory> &store,
+                    std::vector<double> &storeTimes);
+
+private:
+  mlir::func::FuncOp func;
+  std::vector<Instruction> instructions;
+  std::vector<Successor> successors;
+  std::vector<unsigned> operandSlots;
+  unsigned numSlots = 0;
+};
+} // namespace
+
+/// Return the bit width of an integer, index or float type.
+static unsigned getSlotWidth(mlir::Type type) {
+  if (type.isIndex())
+    return INDEX_WIDTH;
+  return type.getIntOrFloatBitWidth();
+}
+
+/// Return whether values of `type` fit into a slot.
+static bool isSupportedSlotType(mlir::Type type) {
+  if (auto intType = type.dyn_cast<mlir::IntegerType>())
+    return intType.getWidth() > 0 && intType.getWidth() <= 64;
+  if (auto memrefType = type.dyn_cast<mlir::MemRefType>()) {
+    auto elementType = memrefType.getElementType();
+    return !elementType.isa<mlir::MemRefType, mlir::IndexType>() &&
+           isSupportedSlotType(elementType);
+  }
+  return type.isIndex() || type.isF32() || type.isF64();
+}
+
+static uint64_t truncateToWidth(uint64_t value, unsigned width) {
+  return width >= 64 ? value : value & ((uint64_t(1) << width) - 1);
+}
+
+static uint64_t unboxSlot(const Any &value) {
+  if (any_isa<APInt>(value))
+    return any_cast<APInt>(value).getZExtValue();
+  if (any_isa<APFloat>(value))
+    return llvm::bit_cast<uint64_t>(any_cast<APFloat>(value).convertToDouble());
+  if (any_isa<unsigned>(value))
+    return any_cast<unsigned>(value);
+  return 0;
+}
+
+static Any boxSlot(mlir::Type type, uint64_t value) {
+  if (type.isF32())
+    return APFloat(float(llvm::bit_cast<double>(value)));
+  if (type.isF64())
+    return APFloat(llvm::bit_cast<double>(value));
+  if (type.isa<mlir::MemRefType>())
+    return unsigned(value);
+  return APInt(getSlotWidth(type), value);
+}
+
+/// Return an element of `memory` as the value of a slot.
+static uint64_t loadSlot(const SimMemory &memory, size_t index) {
+  uint64_t bits = memory.loadBits(index);
+  if (memory.getElementType().isF32())
+    return llvm::bit_cast<uint64_t>(
+        double(llvm::bit_cast<float>(uint32_t(bits))));
+  return bits;
+}
+
+/// Set an element of `memory` to the value of a slot.
+static void storeSlot(SimMemory &memory, size_t index, uint64_t value) {
+  if (memory.getElementType().isF32())
+    value = llvm::bit_cast<uint32_t>(float(llvm::bit_cast<double>(value)));
+  memory.storeBits(index, value);
+}
+
+static bool compareFloats(mlir::arith::CmpFPredicate predicate, double lhs,
+                          double rhs) {
+  using mlir::arith::CmpFPredicate;
+  bool unordered = std::isnan(lhs) || std::isnan(rhs);
+  switch (predicate) {
+  case CmpFPredicate::AlwaysFalse:
+    return false;
+  case CmpFPredicate::OEQ:
+    return !unordered && lhs == rhs;
+  case CmpFPredicate::OGT:
+    return !unordered && lhs > rhs;
+  case CmpFPredicate::OGE:
+    return !unordered && lhs >= rhs;
+  case CmpFPredicate::OLT:
+    return !unordered && lhs < rhs;
+  case CmpFPredicate::OLE:
+    return !unordered && lhs <= rhs;
+  case CmpFPredicate::ONE:
+    return !unordered && lhs != rhs;
+  case CmpFPredicate::ORD:
+    return !unordered;
+  case CmpFPredicate::UEQ:
+    return unordered || lhs == rhs;
+  case CmpFPredicate::UGT:
+    return unordered || lhs > rhs;
+  case CmpFPredicate::UGE:
+    return unordered || lhs >= rhs;
+  case CmpFPredicate::ULT:
+    return unordered || lhs < rhs;
+  case CmpFPredicate::ULE:
+    return unordered || lhs <= rhs;
+  case CmpFPredicate::UNE:
+    return unordered || lhs != rhs;
+  case CmpFPredicate::UNO:
+    return unordered;
+  case CmpFPredicate::AlwaysTrue:
+    return true;
+  }
+  llvm_unreachable("unknown float comparison predicate");
+}
+
+static bool compareInts(mlir::arith::CmpIPredicate predicate, uint64_t lhs,
+                        uint64_t rhs, unsigned width) {
+  using mlir::arith::CmpIPredicate;
+  int64_t slhs = SignExtend64(lhs, width);
+  int64_t srhs = SignExtend64(rhs, width);
+  switch (predicate) {
+  case CmpIPredicate::eq:
+    return lhs == rhs;
+  case CmpIPredicate::ne:
+    return lhs != rhs;
+  case CmpIPredicate::slt:
+    return slhs < srhs;
+  case CmpIPredicate::sle:
+    return slhs <= srhs;
+  case CmpIPredicate::sgt:
+    return slhs > srhs;
+  case CmpIPredicate::sge:
+    return slhs >= srhs;
+  case CmpIPredicate::ult:
+    return lhs < rhs;
+  case CmpIPredicate::ule:
+    return lhs <= rhs;
+  case CmpIPredicate::ugt:
+    return lhs > rhs;
+  case CmpIPredicate::uge:
+    return lhs >= rhs;
+  }
+  llvm_unreachable("unknown integer comparison predicate");
+}
+
+/// Apply a binary float operation in the precision of `width`.
+template <typename OpTy>
+static uint64_t applyFloatOp(uint64_t lhs, uint64_t rhs, unsigned width,
+                             OpTy op) {
+  double lhsValue = llvm::bit_cast<double>(lhs);
+  double rhsValue = llvm::bit_cast<double>(rhs);
+  if (width == 32)
+    return llvm::bit_cast<uint64_t>(
+        double(op(float(lhsValue), float(rhsValue))));
+  return llvm::bit_cast<uint64_t>(op(lhsValue, rhsValue));
+}
+
+std::unique_ptr<CompiledFunction>
+CompiledFunction::compile(mlir::func::FuncOp func) {
+  auto compiled = std::make_unique<CompiledFunction>();
+  compiled->func = func;
+
+  // Number the values defined in the function and find the first instruction
+  // of every block.
+  llvm::DenseMap<mlir::Value, unsigned> slots;
+  llvm::DenseMap<mlir::Block *, unsigned> blockPCs;
+  unsigned pc = 0;
+  auto addSlots = [&](auto values) {
+    for (mlir::Value value : values) {
+      if (!isSupportedSlotType(value.getType()))
+        return false;
+      slots[value] = compiled->numSlots++;
+    }
+    return true;
+  };
+  for (mlir::Block &block : func.getBody()) {
+    blockPCs[&block] = pc;
+    if (!addSlots(block.getArguments()))
+      return nullptr;
+    for (mlir::Operation &op : block) {
+      if (op.getNumRegions() || !addSlots(op.getResults()))
+        return nullptr;
+      ++pc;
+    }
+  }
+
+  auto addOperands = [&](mlir::OperandRange operands) {
+    for (mlir::Value operand : operands)
+      compiled->operandSlots.push_back(slots.lookup(operand));
+  };
+  auto addSuccessor = [&](mlir::Block *dest, mlir::OperandRange operands) {
+    Successor successor{blockPCs.lookup(dest),
+                        unsigned(compiled->operandSlots.size()),
+                        unsigned(operands.size()), 0};
+    if (dest->getNumArguments())
+      successor.firstArgument = slots.lookup(dest->getArgument(0));
+    addOperands(operands);
+    compiled->successors.push_back(successor);
+  };
+
+  for (mlir::Block &block : func.getBody()) {
+    for (mlir::Operation &op : block) {
+      Instruction inst{Opcode::Return, 0, 0, 0, 0, 0, 0, &op};
+      if (op.getNumResults())
+        inst.result = slots.lookup(op.getResult(0));
+      if (op.getNumResults() && !op.getResult(0).getType().isa<MemRefType>())
+        inst.width = getSlotWidth(op.getResult(0).getType());
+      if (op.getNumOperands() &&
+          !op.getOperand(0).getType().isa<MemRefType>())
+        inst.operandWidth = getSlotWidth(op.getOperand(0).getType());
+
+      Optional<Opcode> opcode =
+          llvm::TypeSwitch<Operation *, Optional<Opcode>>(&op)
+              .Case<mlir::arith::ConstantIndexOp, mlir::arith::ConstantIntOp>(
+                  [](auto) { return Opcode::Constant; })
+              .Case<mlir::arith::AddIOp>([](auto) { return Opcode::AddI; })
+              .Case<mlir::arith::SubIOp>([](auto) { return Opcode::SubI; })
+              .Case<mlir::arith::MulIOp>([](auto) { return Opcode::MulI; })
+              .Case<mlir::arith::XOrIOp>([](auto) { return Opcode::XorI; })
+              .Case<mlir::arith::DivSIOp>([](auto) { return Opcode::DivSI; })
+              .Case<mlir::arith::DivUIOp>([](auto) { return Opcode::DivUI; })
+              .Case<mlir::arith::CmpIOp>([](auto) { return Opcode::CmpI; })
+              .Case<mlir::arith::ExtSIOp>([](auto) { return Opcode::ExtSI; })
+              .Case<mlir::arith::ExtUIOp>([](auto) { return Opcode::ExtUI; })
+              .Case<mlir::arith::IndexCastOp>(
+                  [](auto) { return Opcode::IndexCast; })
+              .Case<mlir::arith::AddFOp>([](auto) { return Opcode::AddF; })
+              .Case<mlir::arith::SubFOp>([](auto) { return Opcode::SubF; })
+              .Case<mlir::arith::MulFOp>([](auto) { return Opcode::MulF; })
+              .Case<mlir::arith::DivFOp>([](auto) { return Opcode::DivF; })
+              .Case<mlir::arith::CmpFOp>([](auto) { return Opcode::CmpF; })
+              .Case<memref::AllocOp>([](auto) { return Opcode::Alloc; })
+              .Case<memref::LoadOp>([](auto) { return Opcode::Load; })
+              .Case<memref::StoreOp>([](auto) { return Opcode::Store; })
+              .Case<mlir::cf::BranchOp>([](auto) { return Opcode::Br; })
+              .Case<mlir::cf::CondBranchOp>([](auto) { return Opcode::CondBr; })
+              .Case<func::ReturnOp>([](auto) { return Opcode::Return; })
+              .Default([](auto) { return llvm::None; });
+      if (!opcode)
+        return nullptr;
+      inst.opcode = *opcode;
+
+      if (auto constant = dyn_cast<mlir::arith::ConstantIndexOp>(op)) {
+        auto attr = constant->getAttrOfType<mlir::IntegerAttr>("value");
+        inst.immediate =
+            attr.getValue().sextOrTrunc(INDEX_WIDTH).getZExtValue();
+      } else if (auto constant = dyn_cast<mlir::arith::ConstantIntOp>(op)) {
+        auto attr = constant->getAttrOfType<mlir::IntegerAttr>("value");
+        inst.immediate = attr.getValue().getZExtValue();
+      } else if (auto cmpOp = dyn_cast<mlir::arith::CmpIOp>(op)) {
+        inst.immediate = int64_t(cmpOp.getPredicate());
+      } else if (auto cmpOp = dyn_cast<mlir::arith::CmpFOp>(op)) {
+        inst.immediate = int64_t(cmpOp.getPredicate());
+      } else if (auto branchOp = dyn_cast<mlir::cf::BranchOp>(op)) {
+        inst.immediate = compiled->successors.size();
+        addSuccessor(branchOp.getDest(), branchOp.getDestOperands());
+      } else if (auto condBranchOp = dyn_cast<mlir::cf::CondBranchOp>(op)) {
+        inst.immediate = compiled->successors.size();
+        addSuccessor(condBranchOp.getTrueDest(),
+                     condBranchOp.getTrueOperands());
+        addSuccessor(condBranchOp.getFalseDest(),
+                     condBranchOp.getFalseOperands());
+      }
+
+      // Branches only read their condition directly.
+      inst.firstOperand = compiled->operandSlots.size();
+      if (inst.opcode == Opcode::CondBr) {
+        compiled->operandSlots.push_back(slots.lookup(op.getOperand(0)));
+        inst.numOperands = 1;
+      } else if (inst.opcode != Opcode::Br) {
+        addOperands(op.getOperands());
+        inst.numOperands = op.getNumOperands();
+      }
+      compiled->instructions.push_back(inst);
+    }
+  }
+  return compiled;
+}
+
+LogicalResult CompiledFunction::run(
+    llvm::DenseMap<mlir::Value, Any> &valueMap,
+    llvm::DenseMap<mlir::Value, double> &timeMap, std::vector<Any> &results,
+    std::vector<double> &resultTimes, std::vector<SimMemory> &store,
+    std::vector<double> &storeTimes) {
+  std::vector<uint64_t> values(numSlots);
+  std::vector<double> times(numSlots);
+  mlir::Block &entryBlock = func.getBody().front();
+  for (auto arg : entryBlock.getArguments()) {
+    values[arg.getArgNumber()] = unboxSlot(valueMap[arg]);
+    times[arg.getArgNumber()] = timeMap[arg];
+  }
+
+  // Compute the address of a load or store from its index operands.
+  auto getAddress = [&](mlir::MemRefType type, ArrayRef<unsigned> indices) {
+    ArrayRef<int64_t> shape = type.getShape();
+    unsigned address = 0;
+    for (unsigned i = 0; i < shape.size(); ++i)
+      address = address * shape[i] + values[indices[i]];
+    return address;
+  };
+  auto checkAccess = [&](Instruction &inst, uint64_t ptr, unsigned address) {
+    if (ptr >= store.size())
+      return inst.op->emitOpError()
+             << "Unknown memory identified by pointer '" << ptr << "'";
+    if (address >= store[ptr].size())
+      return inst.op->emitOpError()
+             << "Out-of-bounds access to memory '" << ptr << "'. Memory has "
+             << store[ptr].size() << " elements but requested element "
+             << address;
+    return success();
+  };
+
+  unsigned pc = 0;
+  while (true) {
+    Instruction &inst = instructions[pc];
+    ArrayRef<unsigned> operands(operandSlots.data() + inst.firstOperand,
+                                inst.numOperands);
+    LLVM_DEBUG(dbgs() << "OP:  " << inst.op->getName() << "\n");
+    double time = 0.0;
+    for (unsigned slot : operands)
+      time = std::max(time, times[slot]);
+    auto lhs = [&] { return values[operands[0]]; };
+    auto rhs = [&] { return values[operands[1]]; };
+
+    uint64_t result = 0;
+    switch (inst.opcode) {
+    case Opcode::Constant:
+      result = inst.immediate;
+      break;
+    case Opcode::AddI:
+      result = lhs() + rhs();
+      break;
+    case Opcode::SubI:
+      result = lhs() - rhs();
+      break;
+    case Opcode::MulI:
+      result = lhs() * rhs();
+      break;
+    case Opcode::XorI:
+      result = lhs() ^ rhs();
+      break;
+    case Opcode::DivSI: {
+      if (!rhs())
+        return inst.op->emitOpError() << "Division By Zero!";
+      int64_t dividend = SignExtend64(lhs(), inst.width);
+      int64_t divisor = SignExtend64(rhs(), inst.width);
+      // The only overflowing division wraps around, as it does for APInt.
+      if (divisor == -1)
+        result = 0 - uint64_t(dividend);
+      else
+        result = dividend / divisor;
+      break;
+    }
+    case Opcode::DivUI:
+      if (!rhs())
+        return inst.op->emitOpError() << "Division By Zero!";
+      result = lhs() / rhs();
+      break;
+    case Opcode::CmpI:
+      result = compareInts(mlir::arith::CmpIPredicate(inst.immediate), lhs(),
+                           rhs(), inst.operandWidth);
+      break;
+    case Opcode::ExtSI:
+      result = SignExtend64(lhs(), inst.operandWidth);
+      break;
+    case Opcode::ExtUI:
+    case Opcode::IndexCast:
+      result = lhs();
+      break;
+    case Opcode::AddF:
+      result = applyFloatOp(lhs(), rhs(), inst.width,
+                            [](auto a, auto b) { return a + b; });
+      break;
+    case Opcode::SubF:
+      result = applyFloatOp(lhs(), rhs(), inst.width,
+                            [](auto a, auto b) { return a - b; });
+      break;
+    case Opcode::MulF:
+      result = applyFloatOp(lhs(), rhs(), inst.width,
+                            [](auto a, auto b) { return a * b; });
+      break;
+    case Opcode::DivF:
+      result = applyFloatOp(lhs(), rhs(), inst.width,
+                            [](auto a, auto b) { return a / b; });
+      break;
+    case Opcode::CmpF:
+      result = compareFloats(mlir::arith::CmpFPredicate(inst.immediate),
+                             llvm::bit_cast<double>(lhs()),
+                             llvm::bit_cast<double>(rhs()));
+      break;
+    case Opcode::Alloc: {
+      auto type = cast<memref::AllocOp>(inst.op).getType();
+      int64_t size = 1;
+      unsigned dynamicSize = 0;
+      for (int64_t dim : type.getShape())
+        size *= dim > 0 ? dim
+                        : SignExtend64(values[operands[dynamicSize++]],
+                                       INDEX_WIDTH);
+      result = store.size();
+      store.emplace_back(type.getElementType(), size);
+      storeTimes.push_back(time);
+      break;
+    }
+    case Opcode::Load: {
+      auto load = cast<memref::LoadOp>(inst.op);
+      uint64_t ptr = lhs();
+      unsigned address =
+          getAddress(load.getMemRefType(), operands.drop_front());
+      if (failed(checkAccess(inst, ptr, address)))
+        return failure();
+      result = loadSlot(store[ptr], address);
+      time = std::max(time, storeTimes[ptr]);
+      storeTimes[ptr] = time;
+      break;
+    }
+    case Opcode::Store: {
+      auto storeOp = cast<memref::StoreOp>(inst.op);
+      uint64_t ptr = rhs();
+      unsigned address =
+          getAddress(storeOp.getMemRefType(), operands.drop_front(2));
+      if (failed(checkAccess(inst, ptr, address)))
+        return failure();
+      storeSlot(store[ptr], address, lhs());
+      time = std::max(time, storeTimes[ptr]);
+      storeTimes[ptr] = time;
+      break;
+    }
+    case Opcode::Br:
+    case Opcode::CondBr: {
+      unsigned index = inst.immediate;
+      if (inst.opcode == Opcode::CondBr && !lhs())
+        ++index;
+      Successor &successor = successors[index];
+      // Block arguments are available as soon as the forwarded operands are.
+      ArrayRef<unsigned> forwarded(operandSlots.data() + successor.firstOperand,
+                                   successor.numOperands);
+      double argTime = 0.0;
+      for (unsigned slot : forwarded)
+        argTime = std::max(argTime, times[slot]);
+      // Copy through a temporary, as a block may forward its own arguments.
+      SmallVector<uint64_t> forwardedValues;
+      for (unsigned slot : forwarded)
+        forwardedValues.push_back(values[slot]);
+      for (auto value : llvm::enumerate(forwardedValues)) {
+        values[successor.firstArgument + value.index()] = value.value();
+        times[successor.firstArgument + value.index()] = argTime;
+      }
+      pc = successor.pc;
+      continue;
+    }
+    case Opcode::Return:
+      for (unsigned i = 0; i < results.size(); ++i) {
+        results[i] =
+            boxSlot(func.getFunctionType().getResult(i), values[operands[i]]);
+        resultTimes[i] = times[operands[i]];
+      }
+      return success();
+    }
+
+    if (inst.op->getNumResults()) {
+      if (!inst.op->getResult(0).getType().isa<MemRefType>())
+        result = truncateToWidth(result, inst.width);
+      values[inst.result] = result;
+      times[inst.result] = time + 1;
+    }
+    ++pc;
+    ++instructionsExecuted;
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // Simulator entry point
 //===----------------------------------------------------------------------===//
 
-bool simulate(StringRef toplevelFunction, ArrayRef<std::string> inputArgs,
-              mlir::OwningOpRef<mlir::ModuleOp> &module, mlir::MLIRContext &) {
+/// Print the elements of `memory` as a comma-separated list.
+static void printMemory(raw_ostream &os, mlir::MemRefType type,
+                        const SimMemory &memory) {
+  auto elementType = type.getElementType();
+  for (int j = 0; j < type.getNumElements(); ++j) {
+    if (j != 0)
+      os << ",";
+    Any element = memory.load(j);
+    printAnyValueWithType(os, elementType, element);
+  }
+}
+
+/// Write `value` in the binary output format: integers and floats take their
+/// bit width rounded up to whole bytes in little-endian order, index values
+/// take 64 bits, and tuples are written element by element.
+static void writeBinaryValue(raw_ostream &os, mlir::Type type, Any &value) {
+  if (auto tupleType = type.dyn_cast<mlir::TupleType>()) {
+    auto &values = *any_cast<std::vector<Any>>(&value);
+    for (auto [elementType, element] : llvm::zip(tupleType.getTypes(), values))
+      writeBinaryValue(os, elementType, element);
+    return;
+  }
+  if (type.isa<mlir::NoneType>())
+    return;
+
+  APInt bits;
+  if (auto floatType = type.dyn_cast<mlir::FloatType>()) {
+    APFloat floatValue = any_cast<APFloat>(value);
+    bool losesInfo;
+    floatValue.convert(floatType.getFloatSemantics(),
+                       APFloat::rmNearestTiesToEven, &losesInfo);
+    bits = floatValue.bitcastToAPInt();
+  } else if (type.isIndex()) {
+    bits = any_cast<APInt>(value).sext(64);
+  } else {
+    bits = any_cast<APInt>(value).zextOrTrunc(type.getIntOrFloatBitWidth());
+  }
+  for (unsigned i = 0, e = llvm::divideCeil(bits.getBitWidth(), 8); i < e; ++i)
+    os << char(bits.extractBitsAsZExtValue(
+        std::min(8u, bits.getBitWidth() - 8 * i), 8 * i));
+}
+
+/// Write the results and final memref contents of one simulation in the given
+/// format.
+static void
+writeResults(raw_ostream &os, OutputFormat format, size_t vectorIndex,
+             ArrayRef<mlir::Type> resultTypes, std::vector<Any> &results,
+             ArrayRef<std::pair<mlir::MemRefType, const SimMemory *>> memrefs) {
+  switch (format) {
+  case OutputFormat::Text:
+    for (unsigned i = 0; i < results.size(); ++i) {
+      printAnyValueWithType(os, resultTypes[i], results[i]);
+      os << " ";
+    }
+    for (auto [type, memory] : memrefs) {
+      printMemory(os, type, *memory);
+      os << " ";
+    }
+    os << "\n";
+    return;
+  case OutputFormat::CSV:
+    // Memrefs are lists of values themselves, so they are quoted.
+    os << vectorIndex;
+    for (unsigned i = 0; i < results.size(); ++i) {
+      os << ",";
+      printAnyValueWithType(os, resultTypes[i], results[i]);
+    }
+    for (auto [type, memory] : memrefs) {
+      os << ",\"";
+      printMemory(os, type, *memory);
+      os << "\"";
+    }
+    os << "\n";
+    return;
+  case OutputFormat::Binary:
+    for (unsigned i = 0; i < results.size(); ++i)
+      writeBinaryValue(os, resultTypes[i], results[i]);
+    for (auto [type, memory] : memrefs) {
+      auto data = memory->getData();
+      os.write(reinterpret_cast<const char *>(data.data()), data.size());
+    }
+    return;
+  }
+}
+
+/// Simulate `toplevelFunction` on one vector of input arguments and write the
+/// results to `os`.  Returns true on failure.
+static bool simulateVector(StringRef toplevelFunction,
+                           ArrayRef<std::string> inputArgs,
+                           mlir::OwningOpRef<mlir::ModuleOp> &module,
+                           raw_ostream &os, OutputFormat format,
+                           size_t vectorIndex, StringRef memrefDumpPrefix,
+                           StringRef profileFile) {
   // The store associates each allocation in the program
   // (represented by a int) with a vector of values which can be
   // accessed by it.  Currently values are assumed to be an integer.
-  std::vector<std::vector<Any>> store;
+  std::vector<SimMemory> store;
   std::vector<double> storeTimes;
 
   // The valueMap associates each SSA statement in the program
@@ -1000,11 +1808,21 @@ bool simulate(StringRef toplevelFunction, ArrayRef<std::string> inputArgs,
       unsigned buffer = allocateMemRef(memreftype, nothing, store, storeTimes);
       valueMap[blockArgs[i]] = buffer;
       timeMap[blockArgs[i]] = 0.0;
+      // Large memories are read from binary files given as `@<path>`.
+      if (StringRef(inputArgs[i]).startswith("@")) {
+        if (auto error = store[buffer].readFromFile(
+                StringRef(inputArgs[i]).drop_front())) {
+          errs() << toString(std::move(error)) << "\n";
+          return 1;
+        }
+        continue;
+      }
       int64_t i = 0;
       std::stringstream arg(inputArgs[i]);
       while (!arg.eof()) {
         getline(arg, x, ',');
-        store[buffer][i++] = readValueWithType(memreftype.getElementType(), x);
+        store[buffer].store(i++,
+                            readValueWithType(memreftype.getElementType(), x));
       }
     } else {
       Any value = readValueWithType(type, inputArgs[i]);
@@ -1018,48 +1836,105 @@ bool simulate(StringRef toplevelFunction, ArrayRef<std::string> inputArgs,
   bool succeeded = false;
   if (mlir::func::FuncOp toplevel =
           module->lookupSymbol<mlir::func::FuncOp>(toplevelFunction)) {
-    succeeded = HandshakeExecuter(toplevel, valueMap, timeMap, results,
-                                  resultTimes, store, storeTimes)
-                    .succeeded();
+    if (auto compiled = CompiledFunction::compile(toplevel))
+      succeeded = compiled
+                      ->run(valueMap, timeMap, results, resultTimes, store,
+                            storeTimes)
+                      .succeeded();
+    else
+      succeeded = HandshakeExecuter(toplevel, valueMap, timeMap, results,
+                                    resultTimes, store, storeTimes)
+                      .succeeded();
   } else if (handshake::FuncOp toplevel =
                  module->lookupSymbol<handshake::FuncOp>(toplevelFunction)) {
+    SimulationProfile profile;
     succeeded = HandshakeExecuter(toplevel, valueMap, timeMap, results,
-                                  resultTimes, store, storeTimes, module)
+                                  resultTimes, store, storeTimes, module,
+                                  profileFile.empty() ? nullptr : &profile)
                     .succeeded();
+    if (succeeded && !profileFile.empty()) {
+      double time = 0.0;
+      for (double resultTime : resultTimes)
+        time = std::max(time, resultTime);
+      std::error_code error;
+      llvm::raw_fd_ostream profileOS(profileFile, error);
+      if (error) {
+        errs() << "could not open profile file '" << profileFile
+               << "': " << error.message() << "\n";
+        return 1;
+      }
+      profile.write(profileOS, time);
+    }
+  } else if (!profileFile.empty()) {
+    errs() << "Profiles are only available for handshake functions.\n";
   }
 
   if (!succeeded)
     return 1;
 
   double time = 0.0;
-  for (unsigned i = 0; i < results.size(); ++i) {
-    mlir::Type t = ftype.getResult(i);
-    printAnyValueWithType(outs(), t, results[i]);
-    outs() << " ";
+  for (unsigned i = 0; i < results.size(); ++i)
     time = std::max(resultTimes[i], time);
-  }
-  // Go back through the arguments and output any memrefs.
+  // Go back through the arguments and collect any memrefs.
+  SmallVector<std::pair<mlir::MemRefType, const SimMemory *>> memrefs;
   for (unsigned i = 0; i < realInputs; ++i) {
     mlir::Type type = ftype.getInput(i);
     if (type.isa<mlir::MemRefType>()) {
       // We require this memref type to be fully specified.
       auto memreftype = type.dyn_cast<mlir::MemRefType>();
       unsigned buffer = any_cast<unsigned>(valueMap[blockArgs[i]]);
-      auto elementType = memreftype.getElementType();
-      for (int j = 0; j < memreftype.getNumElements(); ++j) {
-        if (j != 0)
-          outs() << ",";
-        printAnyValueWithType(outs(), elementType, store[buffer][j]);
+      if (!memrefDumpPrefix.empty()) {
+        std::string path = (Twine(memrefDumpPrefix) + Twine(i) + ".bin").str();
+        if (auto error = store[buffer].writeToFile(path)) {
+          errs() << toString(std::move(error)) << "\n";
+          return 1;
+        }
+        continue;
       }
-      outs() << " ";
+      memrefs.push_back({memreftype, &store[buffer]});
     }
   }
-  outs() << "\n";
+  writeResults(os, format, vectorIndex, ftype.getResults(), results, memrefs);
 
   simulatedTime += (int)time;
 
   return 0;
 }
 
+bool simulate(StringRef toplevelFunction, ArrayRef<std::string> inputArgs,
+              mlir::OwningOpRef<mlir::ModuleOp> &module, mlir::MLIRContext &,
+              StringRef memrefDumpPrefix, StringRef profileFile) {
+  return simulateVector(toplevelFunction, inputArgs, module, outs(),
+                        OutputFormat::Text, 0, memrefDumpPrefix, profileFile);
+}
+
+bool simulateBatch(StringRef toplevelFunction,
+                   ArrayRef<std::vector<std::string>> inputVectors,
+                   mlir::OwningOpRef<mlir::ModuleOp> &module,
+                   mlir::MLIRContext &context, raw_ostream &os,
+                   OutputFormat format, bool parallel) {
+  // Every vector writes to its own buffer, such that the output is in the
+  // order of the vectors even if they are simulated in parallel.
+  std::vector<std::string> outputs(inputVectors.size());
+  std::atomic<bool> failed(false);
+  auto runVector = [&](size_t i) {
+    llvm::raw_string_ostream vectorOS(outputs[i]);
+    if (simulateVector(toplevelFunction, inputVectors[i], module, vectorOS,
+                       format, i, {}, {})) {
+      errs() << "Simulation of input vector " << i << " failed.\n";
+      failed = true;
+    }
+  };
+  if (parallel)
+    mlir::parallelFor(&context, 0, inputVectors.size(), runVector);
+  else
+    for (size_t i = 0; i < inputVectors.size(); ++i)
+      runVector(i);
+
+  for (auto &output : outputs)
+    os << output;
+  return failed;
+}
+
 } // namespace handshake
 } // namespace circt
@@ -17,8 +17,11 @@
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/Parser/Parser.h"
+#include "mlir/Support/FileUtilities.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ToolOutputFile.h"
 
 #include "circt/Dialect/Handshake/HandshakeOps.h"
 #include "circt/Dialect/Handshake/Simulation.h"
@@ -41,6 +44,62 @@ static cl::opt<std::string>
                      cl::desc("The top-level function to execute"),
                      cl::init("main"), cl::cat(mainCategory));
 
+static cl::opt<std::string> memrefDumpPrefix(
+    "dump-memrefs", cl::Optional,
+    cl::desc("Write the final contents of every memref argument to "
+             "<prefix><argument index>.bin instead of printing them"),
+    cl::value_desc("prefix"), cl::cat(mainCategory));
+
+static cl::opt<std::string> profileFileName(
+    "profile", cl::Optional,
+    cl::desc("Write a JSON profile of the tokens processed by every operation "
+             "and waiting on every channel of a handshake function"),
+    cl::value_desc("filename"), cl::cat(mainCategory));
+
+static cl::opt<std::string> inputVectorsFileName(
+    "input-vectors", cl::Optional,
+    cl::desc("Execute the function once for every line of this file, each "
+             "holding a whitespace-separated vector of input args"),
+    cl::value_desc("filename"), cl::cat(mainCategory));
+
+static cl::opt<handshake::OutputFormat> outputFormat(
+    "output-format", cl::desc("The format of the results of --input-vectors"),
+    cl::init(handshake::OutputFormat::Text),
+    cl::values(clEnumValN(handshake::OutputFormat::Text, "text",
+                          "space-separated values, one line per vector"),
+               clEnumValN(handshake::OutputFormat::CSV, "csv",
+                          "comma-separated values, one line per vector"),
+               clEnumValN(handshake::OutputFormat::Binary, "binary",
+                          "raw little-endian values")),
+    cl::cat(mainCategory));
+
+static cl::opt<std::string> outputFileName(
+    "o", cl::desc("Output filename for the results of --input-vectors"),
+    cl::value_desc("filename"), cl::init("-"), cl::cat(mainCategory));
+
+static cl::opt<bool>
+    parallel("parallel",
+             cl::desc("Execute the vectors of --input-vectors in parallel"),
+             cl::init(false), cl::cat(mainCategory));
+
+/// Read the input vectors from `buffer`, skipping empty lines and comments
+/// starting with `#`.
+static std::vector<std::vector<std::string>>
+readInputVectors(const MemoryBuffer &buffer) {
+  std::vector<std::vector<std::string>> vectors;
+  SmallVector<StringRef> lines, args;
+  buffer.getBuffer().split(lines, '\n');
+  for (StringRef line : lines) {
+    line = line.trim();
+    if (line.empty() || line.startswith("#"))
+      continue;
+    args.clear();
+    SplitString(line, args);
+    vectors.emplace_back(args.begin(), args.end());
+  }
+  return vectors;
+}
+
 int main(int argc, char **argv) {
   InitLLVM y(argc, argv);
   cl::ParseCommandLineOptions(
@@ -49,7 +108,8 @@ int main(int argc, char **argv) {
       "This application executes a function in the given MLIR module\n"
       "Arguments to the function are passed on the command line and\n"
       "results are returned on stdout.\n"
-      "Memref types are specified as a comma-separated list of values.\n");
+      "Memref types are specified as a comma-separated list of values,\n"
+      "or as @<file> to read their contents from a binary file.\n");
 
   auto file_or_err = MemoryBuffer::getFileOrSTDIN(inputFileName.c_str());
   if (std::error_code error = file_or_err.getError()) {
@@ -83,5 +143,30 @@ int main(int argc, char **argv) {
     return 1;
   }
 
-  return handshake::simulate(toplevelFunction, inputArgs, module, context);
+  if (inputVectorsFileName.empty())
+    return handshake::simulate(toplevelFunction, inputArgs, module, context,
+                               memrefDumpPrefix, profileFileName);
+
+  if (!inputArgs.empty()) {
+    errs() << argv[0] << ": input args cannot be combined with "
+           << "--input-vectors\n";
+    return 1;
+  }
+  auto vectorsOrErr = MemoryBuffer::getFile(inputVectorsFileName);
+  if (std::error_code error = vectorsOrErr.getError()) {
+    errs() << argv[0] << ": could not open input vectors '"
+           << inputVectorsFileName << "': " << error.message() << "\n";
+    return 1;
+  }
+  std::string errorMessage;
+  auto output = mlir::openOutputFile(outputFileName, &errorMessage);
+  if (!output) {
+    errs() << errorMessage << "\n";
+    return 1;
+  }
+  bool failed = handshake::simulateBatch(
+      toplevelFunction, readInputVectors(**vectorsOrErr), module, context,
+      output->os(), outputFormat, parallel);
+  output->keep();
+  return failed;
 }
@@ -41,11 +41,15 @@
 
 #include "circt/Conversion/ExportVerilog.h"
 #include "circt/Conversion/Passes.h"
+#include "circt/Dialect/Calyx/CalyxDialect.h"
+#include "circt/Dialect/Calyx/CalyxOps.h"
+#include "circt/Dialect/Calyx/CalyxPasses.h"
 #include "circt/Dialect/ESI/ESIDialect.h"
 #include "circt/Dialect/ESI/ESIPasses.h"
 #include "circt/Dialect/FIRRTL/FIRRTLDialect.h"
 #include "circt/Dialect/FIRRTL/FIRRTLOps.h"
 #include "circt/Dialect/FIRRTL/Passes.h"
+#include "circt/Dialect/Pipeline/Pipeline.h"
 #include "circt/Dialect/SV/SVDialect.h"
 #include "circt/Dialect/SV/SVPasses.h"
 #include "circt/Dialect/Seq/SeqPasses.h"
@@ -93,6 +97,12 @@ static cl::opt<bool>
                           cl::desc("Log executions of toplevel module passes"),
                           cl::init(false), cl::cat(mainCategory));
 
+static cl::opt<bool>
+    qorReport("qor-report",
+              cl::desc("Print pass timings and a quality-of-results summary "
+                       "of the generated design"),
+              cl::init(false), cl::cat(mainCategory));
+
 static cl::opt<bool>
     verifyPasses("verify-each",
                  cl::desc("Run the verifier after each transformation pass"),
@@ -104,14 +114,16 @@ static cl::opt<bool>
                               cl::init(false), cl::Hidden,
                               cl::cat(mainCategory));
 
-enum HLSFlow { HLSFlowDynamicFIRRTL, HLSFlowDynamicHW };
+enum HLSFlow { HLSFlowDynamicFIRRTL, HLSFlowDynamicHW, HLSFlowStatic };
 
 static cl::opt<HLSFlow>
     hlsFlow(cl::desc("HLS flow"),
             cl::values(clEnumValN(HLSFlowDynamicFIRRTL, "dynamic-firrtl",
                                   "Dynamically scheduled (FIRRTL path)"),
                        clEnumValN(HLSFlowDynamicHW, "dynamic-hw",
-                                  "Dynamically scheduled (HW path)")),
+                                  "Dynamically scheduled (HW path)"),
+                       clEnumValN(HLSFlowStatic, "static",
+                                  "Statically scheduled (Calyx path)")),
             cl::cat(mainCategory));
 
 enum DynamicParallelismKind {
@@ -167,19 +179,109 @@ static cl::opt<bool>
 static cl::opt<std::string>
     bufferingStrategy("buffering-strategy",
                       cl::desc("Strategy to apply. Possible values are: "
-                               "cycles, allFIFO, all (default)"),
+                               "cycles, allFIFO, throughput, all (default)"),
                       cl::init("all"), cl::cat(mainCategory));
 
 static cl::opt<unsigned> bufferSize("buffer-size",
                                     cl::desc("Number of slots in each buffer"),
                                     cl::init(2), cl::cat(mainCategory));
 
+static cl::opt<unsigned>
+    targetII("target-ii",
+             cl::desc("Initiation interval targeted by the throughput "
+                      "buffering strategy"),
+             cl::init(1), cl::cat(mainCategory));
+
 static cl::opt<bool> withESI("with-esi",
                              cl::desc("Create ESI compatible modules"),
                              cl::init(false), cl::cat(mainCategory));
 
 static LoweringOptionsOption loweringOptions(mainCategory);
 
+// --------------------------------------------------------------------------
+// Quality-of-results report
+// --------------------------------------------------------------------------
+
+namespace {
+/// Metrics of the design which allow comparing the outcome of different flow
+/// options. Metrics of IR levels the flow never runs through stay unset.
+struct QoRReport {
+  Optional<unsigned> numHandshakeOps;
+  Optional<unsigned> numBufferSlots;
+  Optional<unsigned> criticalCycleLatency;
+  Optional<unsigned> numHWModules;
+
+  void print(raw_ostream &os) const;
+};
+
+/// Hands the module to a callback at a fixed point of the pipeline, such that
+/// the report can sample the IR before it is lowered further.
+struct QoRSnapshotPass
+    : public PassWrapper<QoRSnapshotPass, OperationPass<ModuleOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(QoRSnapshotPass)
+
+  QoRSnapshotPass(std::function<void(ModuleOp)> callback)
+      : callback(std::move(callback)) {}
+  StringRef getArgument() const override { return "hlstool-qor-snapshot"; }
+  void runOnOperation() override {
+    callback(getOperation());
+    markAllAnalysesPreserved();
+  }
+
+  std::function<void(ModuleOp)> callback;
+};
+} // namespace
+
+void QoRReport::print(raw_ostream &os) const {
+  auto printMetric = [&](StringRef name, Optional<unsigned> value) {
+    if (value)
+      os << "  " << name << ": " << *value << "\n";
+  };
+  os << "===" << std::string(73, '-') << "===\n"
+     << "  hlstool quality-of-results report\n"
+     << "===" << std::string(73, '-') << "===\n";
+  printMetric("Handshake operations", numHandshakeOps);
+  printMetric("Buffer slots", numBufferSlots);
+  printMetric("Critical cycle latency", criticalCycleLatency);
+  printMetric("HW modules", numHWModules);
+}
+
+/// The report of the input currently being processed.
+static QoRReport qor;
+
+/// Adds a pass to 'pm' which records the metrics of the handshake IR.
+static void addHandshakeQoRSnapshot(OpPassManager &pm) {
+  pm.addPass(std::make_unique<QoRSnapshotPass>([](ModuleOp module) {
+    unsigned numOps = 0, numSlots = 0, criticalLatency = 0;
+    for (auto funcOp : module.getOps<handshake::FuncOp>()) {
+      funcOp.walk([&](Operation *op) {
+        if (op == funcOp)
+          return;
+        ++numOps;
+        if (auto bufferOp = dyn_cast<handshake::BufferOp>(op))
+          numSlots += bufferOp.getNumSlots();
+      });
+      if (!funcOp.isExternal())
+        criticalLatency = std::max(
+            criticalLatency,
+            handshake::getCriticalCycleLatency(funcOp.getBody()));
+    }
+    qor.numHandshakeOps = numOps;
+    qor.numBufferSlots = numSlots;
+    qor.criticalCycleLatency = criticalLatency;
+  }));
+}
+
+/// Adds a pass to 'pm' which records the metrics of the HW IR, if the flow
+/// reached it.
+static void addHWQoRSnapshot(OpPassManager &pm) {
+  pm.addPass(std::make_unique<QoRSnapshotPass>([](ModuleOp module) {
+    auto modules = module.getOps<hw::HWModuleOp>();
+    if (!modules.empty())
+      qor.numHWModules = std::distance(modules.begin(), modules.end());
+  }));
+}
+
 // --------------------------------------------------------------------------
 // (Configurable) pass pipelines
 // --------------------------------------------------------------------------
@@ -226,7 +328,7 @@ static void loadHandshakeTransformsPipeline(OpPassManager &pm) {
   pm.nest<handshake::FuncOp>().addPass(createSimpleCanonicalizerPass());
   pm.nest<handshake::FuncOp>().addPass(
       handshake::createHandshakeInsertBuffersPass(bufferingStrategy,
-                                                  bufferSize));
+                                                  bufferSize, targetII));
   pm.nest<handshake::FuncOp>().addPass(createSimpleCanonicalizerPass());
 }
 
@@ -265,7 +367,7 @@ static void loadFIRRTLLoweringPipeline(OpPassManager &pm) {
 
 static void loadHWLoweringPipeline(OpPassManager &pm) {
   pm.addPass(createSimpleCanonicalizerPass());
-  pm.nest<hw::HWModuleOp>().addPass(circt::seq::createLowerSeqHLMemPass());
+  pm.addPass(circt::seq::createLowerSeqHLMemPass());
   pm.nest<hw::HWModuleOp>().addPass(seq::createSeqFIRRTLLowerToSVPass());
   pm.addPass(sv::createHWMemSimImplPass(false, false));
   pm.addPass(seq::createSeqLowerToSVPass());
@@ -280,10 +382,60 @@ static void loadHWLoweringPipeline(OpPassManager &pm) {
   modulePM.addPass(sv::createPrettifyVerilogPass());
 }
 
+static void loadSHLSPipeline(OpPassManager &pm) {
+  // Schedule the loops and turn them into pipelines. Whatever could not be
+  // pipelined is lowered to plain control flow.
+  pm.nest<func::FuncOp>().addPass(circt::createAffineToPipeline());
+  pm.addPass(mlir::createLowerAffinePass());
+  pm.nest<func::FuncOp>().addPass(createSimpleCanonicalizerPass());
+}
+
+static void loadCalyxLoweringPipeline(OpPassManager &pm) {
+  auto &componentPM = pm.nest<calyx::ComponentOp>();
+  componentPM.addPass(calyx::createRegisterSharingPass());
+  componentPM.addPass(calyx::createCellSharingPass());
+  componentPM.addPass(calyx::createGoInsertionPass());
+  componentPM.addPass(calyx::createCompileControlPass());
+  componentPM.addPass(createSimpleCanonicalizerPass());
+  componentPM.addPass(calyx::createRemoveGroupsPass());
+  componentPM.addPass(createSimpleCanonicalizerPass());
+}
+
 // --------------------------------------------------------------------------
 // Tool driver code
 // --------------------------------------------------------------------------
 
+/// Add the output passes to 'pm', run it on 'module', and print the result
+/// if IR output is requested.
+static LogicalResult
+runFlow(PassManager &pm, ModuleOp module,
+        Optional<std::unique_ptr<llvm::ToolOutputFile>> &outputFile) {
+  if (qorReport)
+    addHWQoRSnapshot(pm);
+
+  if (traceIVerilog)
+    pm.addPass(circt::sv::createSVTraceIVerilogPass());
+
+  if (outputFormat == OutputVerilog) {
+    if (loweringOptions.getNumOccurrences())
+      loweringOptions.setAsAttribute(module);
+    pm.addPass(createExportVerilogPass(outputFile.value()->os()));
+  }
+
+  // Go execute!
+  qor = {};
+  if (failed(pm.run(module)))
+    return failure();
+
+  if (outputFormat == OutputIR)
+    module->print(outputFile.value()->os());
+
+  if (qorReport)
+    qor.print(llvm::errs());
+
+  return success();
+}
+
 enum HLSFlowDynamicIRLevel {
   High = 0,
   Handshake = 1,
@@ -345,8 +497,11 @@ doHLSFlowDynamic(PassManager &pm, ModuleOp module,
   };
 
   addIRLevel(HLSFlowDynamicIRLevel::High, [&]() { loadDHLSPipeline(pm); });
-  addIRLevel(HLSFlowDynamicIRLevel::Handshake,
-             [&]() { loadHandshakeTransformsPipeline(pm); });
+  addIRLevel(HLSFlowDynamicIRLevel::Handshake, [&]() {
+    loadHandshakeTransformsPipeline(pm);
+    if (qorReport)
+      addHandshakeQoRSnapshot(pm);
+  });
 
   if (hlsFlow == HLSFlowDynamicFIRRTL) {
     // FIRRTL path.
@@ -372,23 +527,75 @@ doHLSFlowDynamic(PassManager &pm, ModuleOp module,
 
   addIRLevel(HLSFlowDynamicIRLevel::Sv, [&]() { loadHWLoweringPipeline(pm); });
 
-  if (traceIVerilog)
-    pm.addPass(circt::sv::createSVTraceIVerilogPass());
+  return runFlow(pm, module, outputFile);
+}
 
-  if (outputFormat == OutputVerilog) {
-    if (loweringOptions.getNumOccurrences())
-      loweringOptions.setAsAttribute(module);
-    pm.addPass(createExportVerilogPass(outputFile.value()->os()));
+struct HLSFlowStaticIRLevel {
+  enum Level {
+    High = 0,
+    Pipeline = 1,
+    Calyx = 2,
+    Rtl = 3,
+    Sv = 4,
+  };
+};
+
+static void printHLSFlowStatic() {
+  llvm::errs() << "Valid levels are:\n";
+  llvm::errs() << HLSFlowStaticIRLevel::High << ": 'affine' level IR\n";
+  llvm::errs() << HLSFlowStaticIRLevel::Pipeline << ": 'pipeline' IR\n";
+  llvm::errs() << HLSFlowStaticIRLevel::Calyx << ": 'calyx' IR\n";
+  llvm::errs() << HLSFlowStaticIRLevel::Rtl << ": 'hw/comb/seq' IR\n";
+  llvm::errs() << HLSFlowStaticIRLevel::Sv << ": 'hw/comb/sv' IR\n";
+}
+
+static LogicalResult
+doHLSFlowStatic(PassManager &pm, ModuleOp module,
+                Optional<std::unique_ptr<llvm::ToolOutputFile>> &outputFile) {
+  if (irInputLevel < 0)
+    irInputLevel = HLSFlowStaticIRLevel::High; // Default to highest level
+
+  if (irOutputLevel < 0)
+    irOutputLevel = HLSFlowStaticIRLevel::Sv; // Default to lowest level
+
+  if (irInputLevel > HLSFlowStaticIRLevel::Sv) {
+    llvm::errs() << "Invalid IR input level: " << irInputLevel << "\n";
+    printHLSFlowStatic();
+    return failure();
   }
 
-  // Go execute!
-  if (failed(pm.run(module)))
+  if (outputFormat == OutputIR && (irOutputLevel > HLSFlowStaticIRLevel::Sv)) {
+    llvm::errs() << "Invalid IR output level: " << irOutputLevel << "\n";
+    printHLSFlowStatic();
     return failure();
+  }
 
-  if (outputFormat == OutputIR)
-    module->print(outputFile.value()->os());
+  bool suppressLaterPasses = false;
+  auto addIRLevel = [&](int level, llvm::function_ref<void()> passAdder) {
+    if (suppressLaterPasses)
+      return;
+    // Add the pass if the input IR level is at least the current abstraction.
+    if (irInputLevel <= level)
+      passAdder();
+    // Suppresses later passes if we're emitting IR and the output IR level is
+    // the current level.
+    if (outputFormat == OutputIR && irOutputLevel == level)
+      suppressLaterPasses = true;
+  };
 
-  return success();
+  // The loops are modulo scheduled by AffineToPipeline, which picks the
+  // scheduler for the cyclic problems it builds itself.
+  addIRLevel(HLSFlowStaticIRLevel::High, [&]() { loadSHLSPipeline(pm); });
+  addIRLevel(HLSFlowStaticIRLevel::Pipeline,
+             [&]() { pm.addPass(circt::createPipelineToCalyxPass()); });
+  addIRLevel(HLSFlowStaticIRLevel::Calyx, [&]() {
+    loadCalyxLoweringPipeline(pm);
+    pm.addPass(circt::createCalyxToHWPass());
+    pm.addPass(createSimpleCanonicalizerPass());
+  });
+  addIRLevel(HLSFlowStaticIRLevel::Rtl, [&]() { loadHWLoweringPipeline(pm); });
+
+  return runFlow(pm, module, outputFile);
 }
 
 /// Process a single buffer of the input.
@@ -426,6 +633,9 @@ processBuffer(MLIRContext &context, TimingScope &ts, llvm::SourceMgr &sourceMgr,
       hlsFlow == HLSFlow::HLSFlowDynamicHW) {
     if (failed(doHLSFlowDynamic(pm, module.get(), outputFile)))
       return failure();
+  } else if (hlsFlow == HLSFlow::HLSFlowStatic) {
+    if (failed(doHLSFlowStatic(pm, module.get(), outputFile)))
+      return failure();
   }
 
   // We intentionally "leak" the Module into the MLIRContext instead of
@@ -479,6 +689,8 @@ static LogicalResult executeHlstool(MLIRContext &context) {
   // Create the timing manager we use to sample execution times.
   DefaultTimingManager tm;
   applyDefaultTimingManagerCLOptions(tm);
+  if (qorReport)
+    tm.setEnabled(true);
   auto ts = tm.getRootScope();
 
   // Set up the input file.
@@ -545,7 +757,8 @@ int main(int argc, char **argv) {
   // Register CIRCT dialects.
   registry.insert<firrtl::FIRRTLDialect, hw::HWDialect, comb::CombDialect,
                   seq::SeqDialect, sv::SVDialect, handshake::HandshakeDialect,
-                  esi::ESIDialect>();
+                  esi::ESIDialect, calyx::CalyxDialect,
+                  pipeline::PipelineDialect>();
 
   // Do the guts of the hlstool process.
   MLIRContext context(registry);
@@ -16,6 +16,7 @@
 #include "circt/Dialect/LLHD/IR/LLHDDialect.h"
 #include "circt/Dialect/LLHD/Simulator/Engine.h"
 #include "circt/Dialect/LLHD/Simulator/Trace.h"
+#include "circt/Dialect/LLHD/Transforms/Passes.h"
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
@@ -27,10 +28,14 @@
 #include "mlir/Target/LLVMIR/Export.h"
 #include "mlir/Transforms/Passes.h"
 
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/xxhash.h"
 
 using namespace llvm;
 using namespace mlir;
@@ -75,6 +80,47 @@ static cl::opt<bool> dumpLayout("dump-layout",
                                 cl::desc("Dump the gathered instance layout"),
                                 cl::cat(mainCategory));
 
+static cl::opt<bool> parallel(
+    "parallel",
+    cl::desc("Evaluate the instances woken up at the same step in parallel"),
+    cl::init(false), cl::cat(mainCategory));
+
+static cl::opt<bool> inlineEntities(
+    "inline-entities",
+    cl::desc("Inline the instances of combinational entities into their "
+             "parents before compiling the design"),
+    cl::init(false), cl::cat(mainCategory));
+
+static cl::opt<bool> printStats(
+    "print-stats",
+    cl::desc("Print the number of delta cycles, events and instance "
+             "evaluations, and the time spent simulating"),
+    cl::init(false), cl::cat(mainCategory));
+
+static cl::opt<std::string> objectCacheDir(
+    "object-cache-dir",
+    cl::desc("Directory in which to keep the compiled designs, such that later "
+             "runs of the same design do not compile it again"),
+    cl::value_desc("directory"), cl::init(""), cl::cat(mainCategory));
+
+static cl::opt<std::string> checkpointIn(
+    "restore-checkpoint",
+    cl::desc("Resume the simulation from a checkpoint written by an earlier "
+             "run"),
+    cl::value_desc("filename"), cl::init(""), cl::cat(mainCategory));
+
+static cl::opt<std::string> checkpointOut(
+    "save-checkpoint",
+    cl::desc("Write a checkpoint of the state the simulation stops in"),
+    cl::value_desc("filename"), cl::init(""), cl::cat(mainCategory));
+
+static cl::opt<std::string> activityFile(
+    "activity-file",
+    cl::desc("Count the toggles of every signal bit and write them to the "
+             "given file in SAIF format. Combine with --trace-format=none to "
+             "skip producing a trace"),
+    cl::value_desc("filename"), cl::init(""), cl::cat(mainCategory));
+
 static cl::opt<std::string> root(
     "root",
     cl::desc("Specify the name of the entity to use as root of the design"),
@@ -111,6 +157,9 @@ static cl::opt<TraceMode> traceMode(
             TraceMode::NamedOnly, "named-only",
             "Only dump changes for real-time steps, only for top-level "
             "instance and signals not having the default name '(sig)?[0-9]*'"),
+        clEnumValN(TraceMode::VCD, "vcd",
+                   "Dump a VCD waveform of the real-time steps, for all "
+                   "instances"),
         clEnumValN(TraceMode::None, "none", "Don't dump a signal trace")),
     cl::cat(mainCategory));
 
@@ -192,6 +241,15 @@ int main(int argc, char **argv) {
   mlir::OwningOpRef<mlir::ModuleOp> module(
       parseSourceFile<ModuleOp>(mgr, &context));
 
+  // Inline before the engine builds the instance layout, such that the
+  // layout matches the compiled design.
+  if (inlineEntities && module) {
+    PassManager pm(&context);
+    pm.addPass(llhd::createInlineEntitiesPass());
+    if (failed(pm.run(*module)))
+      return 1;
+  }
+
   if (dumpMLIR) {
     module->dump();
     llvm::errs() << "\n";
@@ -201,10 +259,28 @@ int main(int argc, char **argv) {
   SmallVector<StringRef, 1> sharedLibPaths(sharedLibs.begin(),
                                            sharedLibs.end());
 
+  // Key the cached object file by everything that determines the compiled
+  // code. The LLVM dumps need the lowered module, so they always compile.
+  SmallString<128> objectFile;
+  if (!objectCacheDir.empty() && !dumpLLVMDialect && !dumpLLVMIR) {
+    std::string key;
+    llvm::raw_string_ostream keyStream(key);
+    module->print(keyStream);
+    keyStream << root << static_cast<int>(optimizationLevel.getValue());
+    if (auto ec = llvm::sys::fs::create_directories(objectCacheDir)) {
+      llvm::errs() << "cannot create " << objectCacheDir << ": "
+                   << ec.message() << "\n";
+      return 1;
+    }
+    objectFile = objectCacheDir;
+    llvm::sys::path::append(
+        objectFile, "llhd-sim-" + llvm::utohexstr(llvm::xxHash64(key)) + ".o");
+  }
+
   llhd::sim::Engine engine(
       output->os(), *module, &applyMLIRPasses,
       makeOptimizingTransformer(optimizationLevel, 0, nullptr), root, traceMode,
-      sharedLibPaths);
+      sharedLibPaths, objectFile);
 
   if (dumpLLVMDialect || dumpLLVMIR) {
     return dumpLLVM(engine.getModule(), context);
@@ -216,7 +292,17 @@ int main(int argc, char **argv) {
     return 0;
   }
 
-  engine.simulate(nSteps, maxTime);
+  if (engine.simulate(nSteps, maxTime, parallel, checkpointIn, checkpointOut,
+                      activityFile))
+    return 1;
+
+  if (printStats) {
+    auto &stats = engine.getStatistics();
+    llvm::errs() << "delta-cycles: " << stats.deltaCycles << "\n"
+                 << "events: " << stats.events << "\n"
+                 << "instance-runs: " << stats.instanceRuns << "\n"
+                 << "simulation-time-s: " << stats.seconds << "\n";
+  }
 
   output->keep();
   return 0;
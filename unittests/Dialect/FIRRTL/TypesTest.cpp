@@ -22,4 +22,33 @@ TEST(TypesTest, AnalogContainsAnalog) {
   ASSERT_TRUE(AnalogType::get(&context).containsAnalog());
 }
 
+TEST(TypesTest, FieldIDs) {
+  MLIRContext context;
+  context.loadDialect<FIRRTLDialect>();
+  auto uint = UIntType::get(&context, 1);
+  auto vector = FVectorType::get(uint, 2);
+  auto name = [&](StringRef name) { return StringAttr::get(&context, name); };
+  auto inner = BundleType::get(
+      {{name("c"), false, uint}, {name("d"), false, vector}}, &context);
+  auto outer = BundleType::get({{name("a"), false, uint},
+                                {name("b"), false, inner},
+                                {name("e"), false, uint}},
+                               &context);
+
+  // a = 1, b = 2, b.c = 3, b.d = 4, b.d[0] = 5, b.d[1] = 6, e = 7.
+  EXPECT_EQ(outer.getMaxFieldID(), 7u);
+  EXPECT_EQ(vector.getMaxFieldID(), 2u);
+  unsigned expectedIndices[] = {0, 1, 1, 1, 1, 1, 2};
+  for (unsigned fieldID = 1; fieldID <= 7; ++fieldID)
+    EXPECT_EQ(outer.getIndexForFieldID(fieldID), expectedIndices[fieldID - 1]);
+  EXPECT_EQ(outer.getFieldID(2), 7u);
+  EXPECT_EQ(vector.getIndexForFieldID(2), 1u);
+
+  auto [subType, subID] = outer.getSubTypeByFieldID(5);
+  EXPECT_EQ(subType, inner);
+  EXPECT_EQ(subID, 3u);
+  EXPECT_EQ(outer.getFinalTypeByFieldID(6), uint);
+  EXPECT_EQ(outer.getFinalTypeByFieldID(4), vector);
+}
+
 } // namespace
@@ -75,4 +75,29 @@ TEST(HWModuleOpTest, AddOutputs) {
   EXPECT_EQ(output->getOperand(3), wireD.getResult());
 }
 
+TEST(HWModuleOpTest, PortLookup) {
+  MLIRContext context;
+  context.loadDialect<HWDialect>();
+  LocationAttr loc = UnknownLoc::get(&context);
+  auto module = ModuleOp::create(loc);
+  auto builder = ImplicitLocOpBuilder::atBlockEnd(loc, module.getBody());
+  auto i1 = builder.getI1Type();
+  auto a = builder.getStringAttr("a");
+  auto b = builder.getStringAttr("b");
+  auto c = builder.getStringAttr("c");
+  PortInfo ports[] = {{a, PortDirection::INPUT, i1, 0},
+                      {b, PortDirection::INPUT, i1, 1},
+                      {c, PortDirection::OUTPUT, i1, 0}};
+  auto top = builder.create<HWModuleExternOp>(builder.getStringAttr("Top"),
+                                              ports);
+
+  ModulePortLookupInfo info(top);
+  EXPECT_EQ(info.getPorts().inputs.size(), 2u);
+  EXPECT_EQ(*info.getInputPortIndex(b), 1u);
+  EXPECT_EQ(*info.getOutputPortIndex(c), 0u);
+  EXPECT_EQ(info.getOutputPort(c)->type, i1);
+  EXPECT_TRUE(failed(info.getInputPortIndex(c)));
+  EXPECT_TRUE(failed(info.getOutputPort(a)));
+}
+
 } // namespace
@@ -13,6 +13,8 @@
 #include "llvm/ADT/PostOrderIterator.h"
 #include "gtest/gtest.h"
 
+#include <atomic>
+
 using namespace mlir;
 using namespace circt;
 using namespace hw;
@@ -77,4 +79,153 @@ TEST(InstanceGraphTest, PostOrderTraversal) {
   ASSERT_EQ(range.end(), it);
 }
 
+TEST(InstanceGraphTest, IncrementalUpdate) {
+  MLIRContext context;
+  context.loadDialect<HWDialect>();
+
+  // Start from:
+  // hw.module @Top() {
+  //   hw.instance "child" @Child() -> ()
+  // }
+  // hw.module private @Child() { }
+  LocationAttr loc = UnknownLoc::get(&context);
+  auto module = ModuleOp::create(loc);
+  auto builder = ImplicitLocOpBuilder::atBlockEnd(loc, module.getBody());
+
+  auto top = builder.create<HWModuleOp>(StringAttr::get(&context, "Top"),
+                                        ArrayRef<PortInfo>{});
+  auto child = builder.create<HWModuleOp>(StringAttr::get(&context, "Child"),
+                                          ArrayRef<PortInfo>{});
+  child.setPrivate();
+
+  builder.setInsertionPointToStart(top.getBodyBlock());
+  auto childInst =
+      builder.create<InstanceOp>(child, "child", ArrayRef<Value>{});
+
+  InstanceGraph graph(module);
+
+  // Wrap the child instance in a new module:
+  // hw.module @Top() {
+  //   hw.instance "wrapper" @Wrapper() -> ()
+  // }
+  // hw.module private @Wrapper() {
+  //   hw.instance "child" @Child() -> ()
+  // }
+  builder.setInsertionPointToEnd(module.getBody());
+  auto wrapper = builder.create<HWModuleOp>(
+      StringAttr::get(&context, "Wrapper"), ArrayRef<PortInfo>{});
+  wrapper.setPrivate();
+  auto *wrapperNode = graph.addModule(wrapper);
+
+  builder.setInsertionPointToStart(top.getBodyBlock());
+  auto wrapperInst =
+      builder.create<InstanceOp>(wrapper, "wrapper", ArrayRef<Value>{});
+  graph.addInstance(wrapperInst);
+
+  graph.eraseInstance(childInst);
+  childInst->remove();
+  wrapper.getBodyBlock()->push_front(childInst);
+  graph.addInstance(childInst);
+
+  auto *topNode = graph.lookup(top);
+  auto *childNode = graph.lookup(child);
+  ASSERT_EQ(1, std::distance(topNode->begin(), topNode->end()));
+  ASSERT_EQ(wrapperNode, (*topNode->begin())->getTarget());
+  ASSERT_TRUE(wrapperNode->hasOneUse());
+  ASSERT_EQ(topNode, (*wrapperNode->usesBegin())->getParent());
+  ASSERT_TRUE(childNode->hasOneUse());
+  ASSERT_EQ(wrapperNode, (*childNode->usesBegin())->getParent());
+  ASSERT_TRUE(graph.isAncestor(child, top));
+
+  // The graph must match one built from scratch.
+  InstanceGraph rebuilt(module);
+  auto range = llvm::post_order(&rebuilt);
+  auto it = range.begin();
+  ASSERT_EQ("Child", it->getModule().moduleName());
+  ++it;
+  ASSERT_EQ("Wrapper", it->getModule().moduleName());
+  ++it;
+  ASSERT_EQ("Top", it->getModule().moduleName());
+  auto incremental = llvm::post_order(&graph);
+  ASSERT_TRUE(std::equal(
+      incremental.begin(), incremental.end(), range.begin(), range.end(),
+      [](InstanceGraphNode *a, InstanceGraphNode *b) {
+        return a->getModule() == b->getModule();
+      }));
+}
+
+TEST(InstanceGraphTest, Levels) {
+  MLIRContext context;
+  context.loadDialect<HWDialect>();
+
+  // Build the following graph:
+  // hw.module @Top() {
+  //   hw.instance "a" @A() -> ()
+  //   hw.instance "b" @B() -> ()
+  // }
+  // hw.module private @A() {
+  //   hw.instance "leaf" @Leaf() -> ()
+  // }
+  // hw.module private @B() {
+  //   hw.instance "leaf" @Leaf() -> ()
+  // }
+  // hw.module private @Leaf() { }
+  LocationAttr loc = UnknownLoc::get(&context);
+  auto module = ModuleOp::create(loc);
+  auto builder = ImplicitLocOpBuilder::atBlockEnd(loc, module.getBody());
+
+  auto top = builder.create<HWModuleOp>(StringAttr::get(&context, "Top"),
+                                        ArrayRef<PortInfo>{});
+  auto a = builder.create<HWModuleOp>(StringAttr::get(&context, "A"),
+                                      ArrayRef<PortInfo>{});
+  auto b = builder.create<HWModuleOp>(StringAttr::get(&context, "B"),
+                                      ArrayRef<PortInfo>{});
+  auto leaf = builder.create<HWModuleOp>(StringAttr::get(&context, "Leaf"),
+                                         ArrayRef<PortInfo>{});
+  a.setPrivate();
+  b.setPrivate();
+  leaf.setPrivate();
+
+  builder.setInsertionPointToStart(top.getBodyBlock());
+  builder.create<InstanceOp>(a, "a", ArrayRef<Value>{});
+  builder.create<InstanceOp>(b, "b", ArrayRef<Value>{});
+
+  builder.setInsertionPointToStart(a.getBodyBlock());
+  builder.create<InstanceOp>(leaf, "leaf", ArrayRef<Value>{});
+
+  builder.setInsertionPointToStart(b.getBodyBlock());
+  builder.create<InstanceOp>(leaf, "leaf", ArrayRef<Value>{});
+
+  InstanceGraph graph(module);
+  auto names = [](ArrayRef<InstanceGraphNode *> level) {
+    SmallVector<StringRef> result;
+    for (auto *node : level)
+      result.push_back(node->getModule().moduleName());
+    return result;
+  };
+
+  // The artificial top-level node is not part of any level.
+  auto bottomUp = graph.getLevels(/*bottomUp=*/true);
+  ASSERT_EQ(3u, bottomUp.size());
+  ASSERT_EQ(SmallVector<StringRef>({"Leaf"}), names(bottomUp[0]));
+  ASSERT_EQ(SmallVector<StringRef>({"A", "B"}), names(bottomUp[1]));
+  ASSERT_EQ(SmallVector<StringRef>({"Top"}), names(bottomUp[2]));
+
+  auto topDown = graph.getLevels(/*bottomUp=*/false);
+  ASSERT_EQ(3u, topDown.size());
+  ASSERT_EQ(SmallVector<StringRef>({"Top"}), names(topDown[0]));
+  ASSERT_EQ(SmallVector<StringRef>({"A", "B"}), names(topDown[1]));
+  ASSERT_EQ(SmallVector<StringRef>({"Leaf"}), names(topDown[2]));
+
+  // All modules are visited, even if one of them fails.
+  std::atomic<unsigned> numVisited(0);
+  auto result = graph.failableParallelForEachModule(
+      /*bottomUp=*/true, [&](InstanceGraphNode *node) {
+        ++numVisited;
+        return failure(node->getModule().moduleName() == "A");
+      });
+  ASSERT_TRUE(failed(result));
+  ASSERT_EQ(4u, numVisited.load());
+}
+
 } // namespace
@@ -259,6 +259,37 @@ TEST(TypesTest, Resolution) {
   ASSERT_EQ(r1.fullyResolved().toString(), "bit [1:0][2:0] $ [*][4]");
 }
 
+TEST(TypesTest, NestedTypeProperties) {
+  MLIRContext context;
+  context.loadDialect<MooreDialect>();
+
+  auto loc = UnknownLoc::get(&context);
+  auto t0 = IntType::get(&context, IntType::Logic, Sign::Signed);
+  auto t1 = PackedNamedType::get(t0, "foo", loc);
+  auto t2 = PackedRangeDim::get(t1, 4);
+  auto t3 = PackedRefType::get(t2, loc);
+  auto t4 = PackedRangeDim::get(t3, 3);
+  auto t5 = UnpackedArrayDim::get(t4, 2);
+  auto t6 = UnpackedNamedType::get(t5, "bar", loc);
+  auto t7 = UnpackedQueueDim::get(t6);
+
+  ASSERT_EQ(t3.getDomain(), Domain::FourValued);
+  ASSERT_EQ(t3.getSign(), Sign::Signed);
+  ASSERT_EQ(t3.getBitSize(), 4u);
+  ASSERT_EQ(t3.fullyResolved().toString(), "logic signed [3:0]");
+  ASSERT_EQ(t3.getSimpleBitVector().size, 4u);
+
+  ASSERT_EQ(t6.getDomain(), Domain::FourValued);
+  ASSERT_EQ(t6.getSign(), Sign::Signed);
+  ASSERT_EQ(t6.getBitSize(), 24u);
+  ASSERT_EQ(t6.fullyResolved().toString(), "logic signed [2:0][3:0] $ [2]");
+  ASSERT_FALSE(t6.isSimpleBitVector());
+
+  ASSERT_EQ(t7.getDomain(), Domain::FourValued);
+  ASSERT_EQ(t7.getSign(), Sign::Signed);
+  ASSERT_EQ(t7.getBitSize(), llvm::None);
+}
+
 TEST(TypesTest, NamedStructFormatting) {
   MLIRContext context;
   context.loadDialect<MooreDialect>();